@@ -114,6 +114,11 @@ std::string cast::mgr::device_name_or_ip () const
   return name_or_ip_;
 }
 
+int cast::mgr::socket_fd () const
+{
+  return p_ops_ ? p_ops_->socket_fd () : -1;
+}
+
 //
 // Private methods
 //
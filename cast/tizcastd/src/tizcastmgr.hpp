@@ -129,6 +129,15 @@ namespace tiz
        */
       std::string device_name_or_ip () const;
 
+      /**
+       * Retrieve the file descriptor of the socket connected to the
+       * Chromecast device. The manager needs to be polled when it becomes
+       * readable.
+       *
+       * @return The socket's file descriptor, or -1 if not connected.
+       */
+      int socket_fd () const;
+
     private:
       OMX_ERRORTYPE start_fsm ();
 
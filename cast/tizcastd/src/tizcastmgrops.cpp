@@ -276,3 +276,8 @@ std::string cast::ops::internal_error_msg () const
 {
   return error_msg_;
 }
+
+int cast::ops::socket_fd () const
+{
+  return p_cc_ ? tiz_chromecast_socket_fd (p_cc_) : -1;
+}
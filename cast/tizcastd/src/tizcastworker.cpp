@@ -52,6 +52,9 @@
 
 #define TIZ_CAST_WORKER_QUEUE_MAX_ITEMS 30
 
+// Period of the fallback poll of all the managers, in seconds
+#define TIZ_CAST_WORKER_FALLBACK_POLL_PERIOD 1.0
+
 namespace cast = tiz::cast;
 
 namespace
@@ -66,12 +69,12 @@ namespace
 void *cast::thread_func (void *p_arg)
 {
   worker *p_worker = static_cast< worker * > (p_arg);
-  void *p_data = NULL;
   bool done = false;
-  int poll_time_ms = 100;  // ms
-  // Pre-allocated poll command
+  // Pre-allocated poll command. The managers are only polled when their
+  // sockets have something to read, or by the fallback timer, so there is
+  // no need to wait on the sockets.
   uuid_t null_uuid;
-  cast::cmd cmd (null_uuid, cast::poll_evt (poll_time_ms));
+  cast::cmd cmd (null_uuid, cast::poll_evt (0));
 
   assert (p_worker);
 
@@ -80,18 +83,14 @@ void *cast::thread_func (void *p_arg)
 
   while (!done)
   {
-    tiz_queue_timed_receive (p_worker->p_queue_, &p_data, poll_time_ms);
+    // Sleep until a command is posted, a socket becomes readable or the
+    // fallback timer expires
+    tiz_event_loop_run_once (p_worker->p_loop_);
 
     // Dispatch events from the command queue
-    if (p_data)
-    {
-      cast::cmd *p_cmd = static_cast< cast::cmd * > (p_data);
-      done = cast::worker::dispatch_cmd (p_worker, p_cmd);
-      delete p_cmd;
-      p_data = NULL;
-    }
+    done = cast::worker::dispatch_cmds (p_worker);
 
-    // This is to poll the chromecast sockets periodically
+    // Poll the managers that have something to read
     if (!done)
     {
       cast::worker::poll_mgrs (p_worker, &cmd);
@@ -104,6 +103,25 @@ void *cast::thread_func (void *p_arg)
   return NULL;
 }
 
+void cast::socket_readable_cback (void *ap_arg0, tiz_event_io_t *ap_ev_io,
+                                  void *ap_arg1, const uint32_t a_id,
+                                  int a_fd, int a_events)
+{
+  worker *p_worker = static_cast< worker * > (ap_arg0);
+  assert (p_worker);
+  // The id is used instead of a pointer to the client, as the event may
+  // arrive after the client has been removed
+  p_worker->readable_.insert (a_id);
+}
+
+void cast::poll_timer_cback (void *ap_arg0, tiz_event_timer_t *ap_ev_timer,
+                             void *ap_arg1, const uint32_t a_id)
+{
+  worker *p_worker = static_cast< worker * > (ap_arg0);
+  assert (p_worker);
+  p_worker->poll_all_ = true;
+}
+
 //
 // worker
 //
@@ -117,7 +135,12 @@ cast::worker::worker (cast_status_cback_t cast_cb,
     thread_ (),
     mutex_ (),
     sem_ (),
-    p_queue_ (NULL)
+    p_queue_ (NULL),
+    p_loop_ (NULL),
+    p_poll_timer_ (NULL),
+    poll_all_ (false),
+    readable_ (),
+    last_id_ (0)
 {
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Constructing...");
   int rc = tiz_chromecast_ctx_init (&(p_cc_ctx_));
@@ -130,9 +153,11 @@ cast::worker::~worker ()
   BOOST_FOREACH (const clients_pair_t &client, clients_)
   {
     cast::mgr *p_mgr = client.second.p_cast_mgr_;
+    tiz_event_io_destroy (client.second.p_ev_io_);
     p_mgr->deinit ();
     delete p_mgr;
   }
+  destroy_reactor ();
   tiz_chromecast_ctx_destroy (&(p_cc_ctx_));
 }
 
@@ -142,6 +167,9 @@ cast::worker::init ()
   // Init command queue infrastructure
   tiz_check_omx_ret_oom (create_cmd_queue ());
 
+  // Init the event loop that will be run by the worker's thread
+  tiz_check_omx_ret_oom (create_reactor ());
+
   // Create the worker's thread
   tiz_check_omx_ret_oom (tiz_mutex_lock (&mutex_));
   tiz_check_omx_ret_oom (tiz_thread_create (&thread_, 0, 0, thread_func, this));
@@ -261,6 +289,33 @@ void cast::worker::destroy_cmd_queue ()
   tiz_queue_destroy (p_queue_);
 }
 
+OMX_ERRORTYPE
+cast::worker::create_reactor ()
+{
+  // The watchers whose affinity is this worker are served by this loop
+  tiz_check_omx_ret_oom (tiz_event_loop_bind (this, &p_loop_));
+  tiz_check_omx_ret_oom (
+      tiz_event_timer_init (&p_poll_timer_, this, poll_timer_cback, NULL));
+  tiz_event_timer_set (p_poll_timer_, TIZ_CAST_WORKER_FALLBACK_POLL_PERIOD,
+                       TIZ_CAST_WORKER_FALLBACK_POLL_PERIOD);
+  tiz_check_omx_ret_oom (tiz_event_timer_start (p_poll_timer_, 0));
+  return OMX_ErrorNone;
+}
+
+void cast::worker::destroy_reactor ()
+{
+  if (p_poll_timer_)
+  {
+    tiz_event_timer_destroy (p_poll_timer_);
+    p_poll_timer_ = NULL;
+  }
+  if (p_loop_)
+  {
+    tiz_event_loop_unbind (p_loop_);
+    p_loop_ = NULL;
+  }
+}
+
 OMX_ERRORTYPE
 cast::worker::post_cmd (cast::cmd *p_cmd)
 {
@@ -271,12 +326,57 @@ cast::worker::post_cmd (cast::cmd *p_cmd)
   tiz_check_omx_ret_oom (tiz_queue_send (p_queue_, p_cmd));
   tiz_check_omx_ret_oom (tiz_mutex_unlock (&mutex_));
 
+  // Let the worker's thread know there is a command to process
+  tiz_event_loop_wakeup (p_loop_);
+
   return OMX_ErrorNone;
 }
 
+void cast::worker::watch_socket (const uuid_t &uuid)
+{
+  clients_map_t::iterator it = clients_.find (uuid);
+  if (it != clients_.end ())
+  {
+    client_info &info = it->second;
+    const int fd = info.p_cast_mgr_->socket_fd ();
+    if (fd != info.fd_)
+    {
+      // The socket has changed (e.g. the connection has just been
+      // established, or it has been re-established)
+      unwatch_socket (uuid);
+      if (fd > 0
+          && OMX_ErrorNone
+                 == tiz_event_io_init (&(info.p_ev_io_), this,
+                                       socket_readable_cback, NULL))
+      {
+        info.id_ = ++last_id_;
+        tiz_event_io_set (info.p_ev_io_, fd, TIZ_EVENT_READ, false);
+        if (OMX_ErrorNone == tiz_event_io_start (info.p_ev_io_, info.id_))
+        {
+          info.fd_ = fd;
+        }
+      }
+    }
+  }
+}
+
+void cast::worker::unwatch_socket (const uuid_t &uuid)
+{
+  clients_map_t::iterator it = clients_.find (uuid);
+  if (it != clients_.end ())
+  {
+    client_info &info = it->second;
+    // Destroying the watcher also stops it
+    tiz_event_io_destroy (info.p_ev_io_);
+    info.p_ev_io_ = NULL;
+    info.fd_ = -1;
+  }
+}
+
 void cast::worker::remove_client (const uuid_t &uuid, cast::mgr *p_mgr)
 {
   assert (p_mgr);
+  unwatch_socket (uuid);
   p_mgr->deinit ();
   clients_.erase (uuid);
   delete p_mgr;
@@ -312,6 +412,23 @@ void cast::worker::purge_old_clients (const std::string &device_name_or_ip)
   }
 }
 
+bool cast::worker::dispatch_cmds (cast::worker *p_worker)
+{
+  bool done = false;
+  void *p_data = NULL;
+  assert (p_worker);
+
+  while (!done && tiz_queue_length (p_worker->p_queue_) > 0
+         && OMX_ErrorNone == tiz_queue_receive (p_worker->p_queue_, &p_data))
+  {
+    cast::cmd *p_cmd = static_cast< cast::cmd * > (p_data);
+    done = cast::worker::dispatch_cmd (p_worker, p_cmd);
+    delete p_cmd;
+    p_data = NULL;
+  }
+  return done;
+}
+
 bool cast::worker::dispatch_cmd (cast::worker *p_worker, const cast::cmd *p_cmd)
 {
   cast::mgr *p_mgr = NULL;
@@ -370,14 +487,19 @@ bool cast::worker::dispatch_cmd (cast::worker *p_worker, const cast::cmd *p_cmd)
     // The manager has terminated
     p_worker->remove_client (uuid, p_mgr);
   }
+  else if (p_mgr)
+  {
+    p_worker->watch_socket (uuid);
+  }
 
-  return false;
+  return is_type< quit_evt > (p_cmd->evt ());
 }
 
 void cast::worker::poll_mgrs (cast::worker *p_worker, const cast::cmd *p_cmd)
 {
   int i = 0;
   std::vector< clients_pair_t > finished_clients;
+  std::vector< uuid_t > polled_clients;
   assert (p_worker);
   assert (p_cmd);
 
@@ -387,15 +509,25 @@ void cast::worker::poll_mgrs (cast::worker *p_worker, const cast::cmd *p_cmd)
   {
     cast::mgr *p_mgr = clnt.second.p_cast_mgr_;
     assert (p_mgr);
-    if (!p_mgr->terminated ())
+    if (p_mgr->terminated ())
     {
-      (void)p_mgr->dispatch_cmd (p_cmd);
+      finished_clients.push_back (clnt);
     }
-    else
+    else if (p_worker->poll_all_
+             || p_worker->readable_.count (clnt.second.id_) > 0)
     {
-      finished_clients.push_back (clnt);
+      (void)p_mgr->dispatch_cmd (p_cmd);
+      polled_clients.push_back (clnt.first);
+      ++i;
     }
-    ++i;
+  }
+
+  p_worker->poll_all_ = false;
+  p_worker->readable_.clear ();
+
+  BOOST_FOREACH (const uuid_t &uuid, polled_clients)
+  {
+    p_worker->watch_socket (uuid);
   }
 
   BOOST_FOREACH (const clients_pair_t &clnt, finished_clients)
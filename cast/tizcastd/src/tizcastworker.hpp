@@ -30,6 +30,7 @@
 #define TIZCASTWORKER_HPP
 
 #include <map>
+#include <set>
 #include <string>
 
 #include <boost/function.hpp>
@@ -48,6 +49,10 @@ namespace tiz
 
     // Forward declarations
     void *thread_func (void *p_arg);
+    void socket_readable_cback (void *, tiz_event_io_t *, void *,
+                                const uint32_t, int, int);
+    void poll_timer_cback (void *, tiz_event_timer_t *, void *,
+                           const uint32_t);
     class mgr;
     class cmd;
     class vector;
@@ -59,11 +64,20 @@ namespace tiz
      *  A worker class that instantiates its own thread, event loop and
      *  associated command queue, to communicate with Chromecast devices and
      *  cast audio to them.
+     *
+     *  The worker's thread sleeps in its event loop until a command is posted
+     *  or the socket of one of the managers becomes readable. Only the
+     *  managers with readable sockets are polled; the rest are polled at a low
+     *  frequency, as a fallback (e.g. while connecting).
      */
     class worker
     {
 
       friend void *thread_func (void *);
+      friend void socket_readable_cback (void *, tiz_event_io_t *, void *,
+                                         const uint32_t, int, int);
+      friend void poll_timer_cback (void *, tiz_event_timer_t *, void *,
+                                    const uint32_t);
       friend class ops;
 
     public:
@@ -217,12 +231,22 @@ namespace tiz
 
       void destroy_cmd_queue ();
 
+      OMX_ERRORTYPE create_reactor ();
+
+      void destroy_reactor ();
+
       OMX_ERRORTYPE post_cmd (cmd *p_cmd);
 
+      void watch_socket (const uuid_t &uuid);
+
+      void unwatch_socket (const uuid_t &uuid);
+
       void remove_client (const uuid_t &uuid, tiz::cast::mgr *p_mgr);
 
       void purge_old_clients (const std::string &device_name_or_ip);
 
+      static bool dispatch_cmds (worker *p_worker);
+
       static bool dispatch_cmd (worker *p_worker, const cmd *p_cmd);
 
       static void poll_mgrs (worker *p_worker, const cmd *p_cmd);
@@ -230,13 +254,18 @@ namespace tiz
     private:
       struct client_info
       {
-        client_info () : uuid_ (), p_cast_mgr_ (NULL)
+        client_info ()
+          : uuid_ (), p_cast_mgr_ (NULL), p_ev_io_ (NULL), fd_ (-1), id_ (0)
         {
         }
 
         client_info (std::vector< unsigned char > client_uuid,
                      tiz::cast::mgr *p_cast_mgr)
-          : uuid_ (client_uuid), p_cast_mgr_ (p_cast_mgr)
+          : uuid_ (client_uuid),
+            p_cast_mgr_ (p_cast_mgr),
+            p_ev_io_ (NULL),
+            fd_ (-1),
+            id_ (0)
         {
         }
 
@@ -253,6 +282,9 @@ namespace tiz
         // Data members
         uuid_t uuid_;
         tiz::cast::mgr *p_cast_mgr_;  // Not owned
+        tiz_event_io_t *p_ev_io_;     // Watches the manager's socket
+        int fd_;
+        uint32_t id_;                 // Identifies p_ev_io_'s events
       };
 
     private:
@@ -269,6 +301,11 @@ namespace tiz
       tiz_mutex_t mutex_;
       tiz_sem_t sem_;
       tiz_queue_t *p_queue_;
+      tiz_event_loop_t *p_loop_;
+      tiz_event_timer_t *p_poll_timer_;
+      bool poll_all_;
+      std::set< uint32_t > readable_;
+      uint32_t last_id_;
     };
 
     typedef boost::shared_ptr< worker > worker_ptr_t;
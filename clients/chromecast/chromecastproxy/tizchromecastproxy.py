@@ -252,6 +252,18 @@ class tizchromecastproxy(object):
             exc_type, value, traceback = sys.exc_info()
             print_exception(exc_type, value, traceback)
 
+    def socket_fd(self):
+        """Return the file descriptor of the socket connected to the device, or
+        -1 if there is none. A client can watch it for readability and call
+        poll_socket() only when there is data to be read.
+
+        """
+        if self.cast:
+            sock = self.cast.socket_client.get_socket()
+            if sock:
+                return sock.fileno()
+        return -1
+
     def poll_socket(self, polltime_ms):
         print_nfo(
             "[Chromecast] [{0}] [poll_socket start]".format(to_ascii(self.ip_addr))
@@ -259,9 +271,8 @@ class tizchromecastproxy(object):
         polltime_s = polltime_ms / 1000
         sock = self.cast.socket_client.get_socket()
         if sock and sock.fileno() != -1:
-            can_read, _, _ = select.select([sock], [], [], 0.1)
-            # can_read = True
-            if can_read:
+            can_read, _, _ = select.select([sock], [], [], polltime_s)
+            while can_read:
                 print_nfo(
                     "[Chromecast] [{0}] [poll_socket can_read]".format(
                         to_ascii(self.ip_addr)
@@ -276,7 +287,10 @@ class tizchromecastproxy(object):
                         )
                     )
                 except Exception as exception:
-                    pass
+                    break
+                # Records already decrypted by the SSL layer won't make the
+                # socket readable again, so consume them now
+                can_read = hasattr(sock, "pending") and sock.pending() > 0
         print_wrn("[Chromecast] [{0}] [poll_socket end]".format(to_ascii(self.ip_addr)))
 
     def media_load(
@@ -146,6 +146,19 @@ tiz_chromecast_error_t tizchromecast::poll_socket (int a_poll_time_ms)
   return rc;
 }
 
+int tizchromecast::socket_fd ()
+{
+  tiz_chromecast_error_t rc = ETizCcErrorNoError;
+  int fd = -1;
+  if (cc_ctx_.cc_proxy_exists (name_or_ip_))
+    {
+      try_catch_wrapper (
+          fd = bp::extract< int > (
+              cc_ctx_.get_cc_proxy (name_or_ip_).attr ("socket_fd") ()));
+    }
+  return (ETizCcErrorNoError == rc) ? fd : -1;
+}
+
 tiz_chromecast_error_t tizchromecast::media_load (
     const std::string &url, const std::string &content_type,
     const std::string &title, const std::string &album_art)
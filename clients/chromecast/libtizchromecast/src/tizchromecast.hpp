@@ -84,6 +84,7 @@ public:
   void deinit ();
 
   tiz_chromecast_error_t poll_socket (int a_poll_time_ms);
+  int socket_fd ();
 
   tiz_chromecast_error_t media_load (const std::string &url,
                                      const std::string &content_type,
@@ -130,6 +130,13 @@ extern "C" tiz_chromecast_error_t tiz_chromecast_poll (
   return ap_chromecast->p_proxy_->poll_socket (a_poll_time_ms);
 }
 
+extern "C" int tiz_chromecast_socket_fd (tiz_chromecast_t *ap_chromecast)
+{
+  assert (ap_chromecast);
+  assert (ap_chromecast->p_proxy_);
+  return ap_chromecast->p_proxy_->socket_fd ();
+}
+
 extern "C" tiz_chromecast_error_t tiz_chromecast_load_url (
     tiz_chromecast_t *ap_chromecast, const char *ap_url,
     const char *ap_content_type, const char *ap_title, const char *ap_album_art)
@@ -74,7 +74,8 @@ tiz_chromecast_error_t tiz_chromecast_init (
 
 /**
  * Poll to read any events received on the chromecast socket. This function
- * needs to be called periodically (e.g. from the client's event loop).
+ * needs to be called periodically (e.g. from the client's event loop), or
+ * whenever the socket returned by tiz_chromecast_socket_fd becomes readable.
  *
  * @ingroup libtizchromecast
  *
@@ -86,6 +87,21 @@ tiz_chromecast_error_t tiz_chromecast_init (
 tiz_chromecast_error_t tiz_chromecast_poll (tiz_chromecast_t *ap_chromecast,
                                             int a_poll_time_ms);
 
+/**
+ * Retrieve the file descriptor of the socket connected to the Chromecast
+ * device. A client may watch it for readability and only call
+ * tiz_chromecast_poll when there is data to be read. The descriptor may change
+ * when the connection is re-established, and is not available until the
+ * connection has been made.
+ *
+ * @ingroup libtizchromecast
+ *
+ * @param ap_chromecast The Tizonia Chromecast handle.
+ *
+ * @return The socket's file descriptor, or -1 if not connected.
+ */
+int tiz_chromecast_socket_fd (tiz_chromecast_t *ap_chromecast);
+
 /**
  * Load a new audio stream URL on the Chromecast device's default media
  * application.
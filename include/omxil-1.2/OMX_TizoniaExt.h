@@ -78,6 +78,9 @@
 #define OMX_TizoniaIndexParamAudioPlexSession        OMX_IndexVendorStartUnused + 22 /**< reference: OMX_TIZONIA_AUDIO_PARAM_PLEXSESSIONTYPE */
 #define OMX_TizoniaIndexParamAudioPlexPlaylist       OMX_IndexVendorStartUnused + 23 /**< reference: OMX_TIZONIA_AUDIO_PARAM_PLEXPLAYLISTTYPE */
 #define OMX_TizoniaIndexParamStreamingBuffer         OMX_IndexVendorStartUnused + 24 /**< reference: OMX_TIZONIA_STREAMINGBUFFERTYPE */
+#define OMX_TizoniaIndexConfigPerfCounters           OMX_IndexVendorStartUnused + 25 /**< reference: OMX_TIZONIA_PERFCOUNTERSTYPE */
+#define OMX_TizoniaIndexConfigStreamingBufferStatus  OMX_IndexVendorStartUnused + 26 /**< reference: OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE */
+#define OMX_TizoniaIndexParamComponentReset          OMX_IndexVendorStartUnused + 27 /**< reference: OMX_TIZONIA_PARAM_COMPONENTRESETTYPE */
 
 /**
  * OMX_AUDIO_CODINGTYPE extensions
@@ -110,6 +113,52 @@ typedef struct OMX_TIZONIA_PARAM_BUFFER_PREANNOUNCEMENTSMODETYPE
   OMX_BOOL bEnabled;
 } OMX_TIZONIA_PARAM_BUFFER_PREANNOUNCEMENTSMODETYPE;
 
+/**
+ * The name of the component reset extension.
+ */
+#define OMX_TIZONIA_INDEX_PARAM_COMPONENTRESET     \
+  "OMX.Tizonia.index.param.componentreset"
+
+/**
+ * Puts a component in OMX_StateLoaded back to the configuration it had right
+ * after it was instantiated: default role, default port settings and
+ * cleared performance counters.
+ */
+typedef struct OMX_TIZONIA_PARAM_COMPONENTRESETTYPE
+{
+  OMX_U32 nSize;
+  OMX_VERSIONTYPE nVersion;
+} OMX_TIZONIA_PARAM_COMPONENTRESETTYPE;
+
+/**
+ * The name of the performance counters extension.
+ */
+#define OMX_TIZONIA_INDEX_CONFIG_PERFCOUNTERS     \
+  "OMX.Tizonia.index.config.perfcounters"
+
+/**
+ * Run-time performance counters, accumulated since the component was
+ * instantiated. With nPortIndex set to OMX_ALL, the port counters are added up
+ * across all ports. Times are in microseconds.
+ */
+typedef struct OMX_TIZONIA_PERFCOUNTERSTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_U64 nBuffers;               /**< Buffers returned by the port(s). */
+    OMX_U64 nBytes;                 /**< Payload bytes in the buffers returned. */
+    OMX_U32 nQueueHighWaterMark;    /**< Max. buffers queued at a port. */
+    OMX_U32 nUnderruns;             /**< Times the processor was left waiting
+                                         on an empty port while executing. */
+    OMX_U64 nBuffersReadyCalls;     /**< Calls to the processor's buffers_ready. */
+    OMX_U64 nBuffersReadyTime;      /**< Total time spent in buffers_ready. */
+    OMX_U32 nBuffersReadyMaxTime;   /**< Longest buffers_ready call. */
+    OMX_U32 nMsgQueueHighWaterMark; /**< Max. messages queued at the component. */
+    OMX_U64 nMessages;              /**< Messages dispatched by the component. */
+    OMX_U64 nDispatchLatency;       /**< Total time messages spent queued. */
+    OMX_U32 nDispatchLatencyMax;    /**< Longest time a message spent queued. */
+} OMX_TIZONIA_PERFCOUNTERSTYPE;
+
 /**
  * Extension to jump to another track in a playlist.
  */
@@ -132,6 +181,24 @@ typedef struct OMX_TIZONIA_STREAMINGBUFFERTYPE {
     OMX_U32 nHighWaterMark;      /**< A percentage of the total capacity, in the range 0-100. */
 } OMX_TIZONIA_STREAMINGBUFFERTYPE;
 
+/**
+ * Run-time status of a media streaming buffer (read-only). Data is only
+ * delivered once the buffer holds nTargetLevel bytes (pre-roll, also after
+ * running dry). The target adapts to the jitter measured in the arrival of
+ * the data, between nLowWaterMark and nHighWaterMark of the capacity; the
+ * transfer is paused above nHighWaterMark.
+ */
+typedef struct OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_U32 nCapacity;           /**< Bytes held before the transfer is paused. */
+    OMX_U32 nFillLevel;          /**< Bytes held now. */
+    OMX_U32 nTargetLevel;        /**< Bytes held before data is delivered. */
+    OMX_U32 nUnderruns;          /**< Times the buffer has run dry. */
+    OMX_BOOL bBuffering;         /**< OMX_TRUE while pre-rolling. */
+} OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE;
+
 /**
  * Icecast-like audio renderer components
  */
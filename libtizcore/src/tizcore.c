@@ -42,10 +42,12 @@
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
+#include <stdio.h>
 
 #include <OMX_Core.h>
 #include <OMX_Component.h>
 #include <OMX_Types.h>
+#include <OMX_TizoniaExt.h>
 
 #include <tizrmproxy_c.h>
 #include <tizplatform.h>
@@ -68,6 +70,8 @@
 #define TIZ_IL_CORE_RM_NAME "OMX.Aratelia.ilcore"
 #define TIZ_DEFAULT_COMP_ENTRY_POINT_NAME "OMX_ComponentInit"
 #define TIZ_CORE_QUEUE_MAX_ITEMS 30
+#define TIZ_CORE_REGISTRY_CACHE_MAGIC "tizonia-ilcore-registry 1"
+#define TIZ_CORE_INSTANCE_POOL_DEFAULT_SIZE 0
 
 typedef struct role_list_item role_list_item_t;
 typedef role_list_item_t * role_list_t;
@@ -214,6 +218,16 @@ static const tiz_core_msg_dispatch_f tiz_core_msg_to_fnt_tbl[] = {
   NULL,                             /* ETIZCoreMsgFreeCoreInterface */
 };
 
+/* A component instance that has been released with OMX_FreeHandle while in
+   OMX_StateLoaded, and is kept for reuse by the next OMX_GetHandle */
+typedef struct tiz_core_pool_item tiz_core_pool_item_t;
+struct tiz_core_pool_item
+{
+  OMX_HANDLETYPE p_hdl;
+  OMX_PTR p_dl_hdl;
+  tiz_core_pool_item_t * p_next;
+};
+
 typedef struct tiz_core_registry_item tiz_core_registry_item_t;
 typedef tiz_core_registry_item_t * tiz_core_registry_t;
 struct tiz_core_registry_item
@@ -225,6 +239,8 @@ struct tiz_core_registry_item
   OMX_PTR p_dl_hdl;
   OMX_HANDLETYPE p_hdl;
   role_list_t p_roles;
+  tiz_core_pool_item_t * p_pool;
+  OMX_U32 pool_len;
   tiz_core_registry_item_t * p_next;
 };
 
@@ -434,6 +450,32 @@ get_component_roles (OMX_COMPONENTTYPE * ap_hdl, role_list_t * app_role_list)
   return rc;
 }
 
+static void
+append_to_registry (tiz_core_registry_item_t * ap_reg_item)
+{
+  tiz_core_t * p_core = get_core ();
+  tiz_core_registry_item_t * p_registry_last = NULL;
+
+  assert (p_core);
+  assert (ap_reg_item);
+
+  if (NULL == (p_core->p_registry))
+    {
+      /* First entry in the registry */
+      p_core->p_registry = ap_reg_item;
+    }
+  else
+    {
+      /* Find the last entry in the registry */
+      p_registry_last = p_core->p_registry;
+      while (p_registry_last->p_next)
+        {
+          p_registry_last = p_registry_last->p_next;
+        }
+      p_registry_last->p_next = ap_reg_item;
+    }
+}
+
 static OMX_ERRORTYPE
 add_to_comp_registry (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
                       OMX_PTR ap_entry_point, OMX_PTR ap_dl_hdl,
@@ -529,31 +571,7 @@ add_to_comp_registry (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
     {
 
       /* Add to registry */
-      if (NULL == (p_core->p_registry))
-        {
-          /* First entry in the registry */
-          TIZ_LOG (TIZ_PRIORITY_TRACE, "Component added (first component) [%s]",
-                   comp_name);
-
-          p_core->p_registry = p_registry_new;
-        }
-      else
-        {
-          /* Find the last entry in the registry */
-          p_registry_last = p_core->p_registry;
-          while (true)
-            {
-              if (p_registry_last->p_next)
-                {
-                  p_registry_last = p_registry_last->p_next;
-                }
-              else
-                {
-                  break;
-                }
-            }
-          p_registry_last->p_next = p_registry_new;
-        }
+      append_to_registry (p_registry_new);
 
       /* Finish filling the registry entry... */
       p_registry_new->p_comp_name
@@ -583,6 +601,46 @@ add_to_comp_registry (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
   return rc;
 }
 
+static void
+close_comp_lib (OMX_PTR ap_dl_hdl)
+{
+  /* Queued log records may still point to the library's strings */
+  tiz_log_flush ();
+  dlclose (ap_dl_hdl);
+}
+
+static void
+destroy_comp_instance (OMX_HANDLETYPE ap_hdl, OMX_PTR ap_dl_hdl)
+{
+  OMX_COMPONENTTYPE * p_hdl = (OMX_COMPONENTTYPE *) ap_hdl;
+  assert (p_hdl);
+
+  /* Unload the component */
+  if (OMX_ErrorNone != p_hdl->ComponentDeInit ((OMX_HANDLETYPE) p_hdl))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "Call to ComponentDeinit point failed");
+    }
+
+  /*  Deallocate the component hdl */
+  tiz_mem_free (p_hdl);
+  close_comp_lib (ap_dl_hdl);
+}
+
+static void
+drain_instance_pool (tiz_core_registry_item_t * ap_reg_item)
+{
+  tiz_core_pool_item_t * p_item = NULL;
+  assert (ap_reg_item);
+
+  while ((p_item = ap_reg_item->p_pool))
+    {
+      ap_reg_item->p_pool = p_item->p_next;
+      destroy_comp_instance (p_item->p_hdl, p_item->p_dl_hdl);
+      tiz_mem_free (p_item);
+    }
+  ap_reg_item->pool_len = 0;
+}
+
 static void
 delete_registry (void)
 {
@@ -598,6 +656,7 @@ delete_registry (void)
   p_registry_last = p_core->p_registry;
   while (p_registry_last)
     {
+      drain_instance_pool (p_registry_last);
       tiz_mem_free (p_registry_last->p_comp_name);
       tiz_mem_free (p_registry_last->p_dl_name);
       tiz_mem_free (p_registry_last->p_dl_path);
@@ -662,16 +721,17 @@ instantiate_comp_lib (const OMX_STRING ap_path, const OMX_STRING ap_name,
                "[OMX_ErrorUndefined] : "
                "Default entry point [%s] not found in [%s]",
                ap_entry_point_name, ap_name);
-      dlclose (*app_dl_hdl);
+      close_comp_lib (*app_dl_hdl);
       *app_dl_hdl = NULL;
-      return OMX_ErrorUndefined;
+      return OMX_ErrorComponentNotFound;
     }
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-cache_comp_info (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name)
+cache_comp_info (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
+                 tiz_core_registry_item_t ** app_reg_item)
 {
   OMX_PTR p_dl_hdl = NULL;
   OMX_PTR p_entry_point = NULL;
@@ -681,6 +741,9 @@ cache_comp_info (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name)
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "dl_name [%s]", ap_dl_name);
 
+  assert (app_reg_item);
+  *app_reg_item = NULL;
+
   rc = instantiate_comp_lib (
     ap_dl_path, ap_dl_name,
     (const OMX_STRING) TIZ_DEFAULT_COMP_ENTRY_POINT_NAME, &p_dl_hdl,
@@ -707,6 +770,7 @@ cache_comp_info (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name)
               TIZ_LOG (TIZ_PRIORITY_TRACE, "component [%s] : info cached",
                        p_reg_item->p_comp_name);
               p_reg_item->p_hdl = NULL;
+              *app_reg_item = p_reg_item;
             }
 
           /* delete the comp hadle */
@@ -714,7 +778,7 @@ cache_comp_info (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name)
           tiz_mem_free (p_hdl);
         }
 
-      dlclose (p_dl_hdl);
+      close_comp_lib (p_dl_hdl);
     }
 
   if (OMX_ErrorNoMore == rc)
@@ -767,14 +831,542 @@ free_paths (char ** pp_paths, unsigned long npaths)
   tiz_mem_free (pp_paths);
 }
 
+/*
+ * On-disk registry cache
+ *
+ * One line per plugin library found during the last scan: the library's
+ * folder, file name, modification time and size, followed by the name and
+ * roles of the component it contains (if any), all separated by tabs. On
+ * OMX_Init, the libraries that have not changed since the last scan are
+ * registered from the cache without being loaded; only new or modified
+ * libraries are dlopen'ed and instantiated.
+ */
+
+typedef struct tiz_core_cache_item tiz_core_cache_item_t;
+struct tiz_core_cache_item
+{
+  char * p_dl_path;
+  char * p_dl_name;
+  long long mtime_sec;
+  long long mtime_nsec;
+  long long size;
+  /* NULL if the library does not contain an IL component */
+  char * p_comp_name;
+  role_list_t p_roles;
+  tiz_core_cache_item_t * p_next;
+};
+
+static char *
+registry_cache_file (void)
+{
+  const char * p_fmt = "%s";
+  const char * p_base = NULL;
+  char * p_file = NULL;
+  int len = 0;
+
+  if ((p_base = tiz_rcfile_get_value ("ilcore", "registry-cache")))
+    {
+      if (0 == strlen (p_base) || 0 == strncmp (p_base, "none", 5))
+        {
+          return NULL;
+        }
+    }
+  else if ((p_base = getenv ("XDG_CACHE_HOME")) && strlen (p_base) > 0)
+    {
+      p_fmt = "%s/tizonia/ilcore-registry.cache";
+    }
+  else if ((p_base = getenv ("HOME")) && strlen (p_base) > 0)
+    {
+      p_fmt = "%s/.cache/tizonia/ilcore-registry.cache";
+    }
+  else
+    {
+      return NULL;
+    }
+
+  /* NOTE: Path buffers are kept off the stack here; this runs in the IL Core
+     thread, which has a minimal stack */
+  if (NULL == (p_file = tiz_mem_alloc (PATH_MAX)))
+    {
+      return NULL;
+    }
+
+  len = snprintf (p_file, PATH_MAX, p_fmt, p_base);
+  if (len <= 0 || len >= PATH_MAX)
+    {
+      tiz_mem_free (p_file);
+      p_file = NULL;
+    }
+
+  return p_file;
+}
+
+static void
+free_cache_items (tiz_core_cache_item_t * ap_item)
+{
+  tiz_core_cache_item_t * p_next = NULL;
+
+  while (ap_item)
+    {
+      p_next = ap_item->p_next;
+      tiz_mem_free (ap_item->p_dl_path);
+      tiz_mem_free (ap_item->p_dl_name);
+      tiz_mem_free (ap_item->p_comp_name);
+      free_roles (ap_item->p_roles);
+      tiz_mem_free (ap_item);
+      ap_item = p_next;
+    }
+}
+
+static role_list_t
+dup_roles (const role_list_item_t * ap_roles, bool * ap_ok)
+{
+  role_list_item_t * p_first = NULL;
+  role_list_item_t * p_last = NULL;
+  role_list_item_t * p_role = NULL;
+
+  assert (ap_ok);
+  *ap_ok = true;
+
+  for (; ap_roles; ap_roles = ap_roles->p_next)
+    {
+      if (NULL
+          == (p_role = (role_list_item_t *) tiz_mem_calloc (
+                1, sizeof (role_list_item_t))))
+        {
+          free_roles (p_first);
+          *ap_ok = false;
+          return NULL;
+        }
+      memcpy (p_role->role, ap_roles->role, OMX_MAX_STRINGNAME_SIZE);
+      if (p_last)
+        {
+          p_last->p_next = p_role;
+        }
+      else
+        {
+          p_first = p_role;
+        }
+      p_last = p_role;
+    }
+
+  return p_first;
+}
+
+static tiz_core_cache_item_t *
+new_cache_item (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
+                const struct stat * ap_stat,
+                const tiz_core_registry_item_t * ap_reg_item)
+{
+  tiz_core_cache_item_t * p_item = NULL;
+  bool roles_ok = true;
+
+  assert (ap_dl_path);
+  assert (ap_dl_name);
+  assert (ap_stat);
+
+  if (NULL == (p_item = (tiz_core_cache_item_t *) tiz_mem_calloc (
+                 1, sizeof (tiz_core_cache_item_t))))
+    {
+      return NULL;
+    }
+
+  p_item->p_dl_path = strndup (ap_dl_path, PATH_MAX);
+  p_item->p_dl_name = strndup (ap_dl_name, NAME_MAX);
+  p_item->mtime_sec = ap_stat->st_mtim.tv_sec;
+  p_item->mtime_nsec = ap_stat->st_mtim.tv_nsec;
+  p_item->size = ap_stat->st_size;
+  if (ap_reg_item)
+    {
+      p_item->p_comp_name
+        = strndup (ap_reg_item->p_comp_name, OMX_MAX_STRINGNAME_SIZE);
+      p_item->p_roles = dup_roles (ap_reg_item->p_roles, &roles_ok);
+    }
+
+  if (!p_item->p_dl_path || !p_item->p_dl_name
+      || (ap_reg_item && (!p_item->p_comp_name || !roles_ok)))
+    {
+      free_cache_items (p_item);
+      p_item = NULL;
+    }
+
+  return p_item;
+}
+
+static tiz_core_cache_item_t *
+parse_cache_line (char * ap_line)
+{
+  tiz_core_cache_item_t * p_item = NULL;
+  role_list_item_t * p_last = NULL;
+  char * p_save = NULL;
+  char * p_field[6];
+  char * p_tok = NULL;
+  bool has_comp = true;
+  int i = 0;
+
+  assert (ap_line);
+
+  ap_line[strcspn (ap_line, "\n")] = '\0';
+
+  /* Folder, file name, mtime (secs, nsecs), size, and component name */
+  for (i = 0; i < 6; ++i)
+    {
+      if (NULL == (p_field[i] = strtok_r (i == 0 ? ap_line : NULL, "\t",
+                                          &p_save)))
+        {
+          /* A library without a component has no component name */
+          if (5 == i)
+            {
+              has_comp = false;
+              break;
+            }
+          return NULL;
+        }
+    }
+
+  if (NULL == (p_item = (tiz_core_cache_item_t *) tiz_mem_calloc (
+                 1, sizeof (tiz_core_cache_item_t))))
+    {
+      return NULL;
+    }
+
+  p_item->p_dl_path = strndup (p_field[0], PATH_MAX);
+  p_item->p_dl_name = strndup (p_field[1], NAME_MAX);
+  p_item->mtime_sec = strtoll (p_field[2], NULL, 10);
+  p_item->mtime_nsec = strtoll (p_field[3], NULL, 10);
+  p_item->size = strtoll (p_field[4], NULL, 10);
+  if (has_comp)
+    {
+      p_item->p_comp_name = strndup (p_field[5], OMX_MAX_STRINGNAME_SIZE);
+      while ((p_tok = strtok_r (NULL, "\t", &p_save)))
+        {
+          role_list_item_t * p_role = (role_list_item_t *) tiz_mem_calloc (
+            1, sizeof (role_list_item_t));
+          if (!p_role)
+            {
+              free_cache_items (p_item);
+              return NULL;
+            }
+          strncpy ((char *) p_role->role, p_tok, OMX_MAX_STRINGNAME_SIZE - 1);
+          if (p_last)
+            {
+              p_last->p_next = p_role;
+            }
+          else
+            {
+              p_item->p_roles = p_role;
+            }
+          p_last = p_role;
+        }
+    }
+
+  if (!p_item->p_dl_path || !p_item->p_dl_name
+      || (has_comp && (!p_item->p_comp_name || !p_item->p_roles)))
+    {
+      free_cache_items (p_item);
+      p_item = NULL;
+    }
+
+  return p_item;
+}
+
+static tiz_core_cache_item_t *
+load_registry_cache (const char * ap_file)
+{
+  tiz_core_cache_item_t * p_first = NULL;
+  tiz_core_cache_item_t * p_item = NULL;
+  FILE * p_file = NULL;
+  char * p_line = NULL;
+  size_t line_len = 0;
+
+  assert (ap_file);
+
+  if (NULL == (p_file = fopen (ap_file, "r")))
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "No registry cache at [%s]", ap_file);
+      return NULL;
+    }
+
+  if (getline (&p_line, &line_len, p_file) > 0
+      && 0 == strncmp (p_line, TIZ_CORE_REGISTRY_CACHE_MAGIC,
+                       strlen (TIZ_CORE_REGISTRY_CACHE_MAGIC)))
+    {
+      while (getline (&p_line, &line_len, p_file) > 0)
+        {
+          if ((p_item = parse_cache_line (p_line)))
+            {
+              p_item->p_next = p_first;
+              p_first = p_item;
+            }
+        }
+    }
+
+  free (p_line);
+  (void) fclose (p_file);
+
+  return p_first;
+}
+
+static bool
+cache_field_ok (const char * ap_str)
+{
+  return ap_str && strlen (ap_str) > 0 && NULL == strpbrk (ap_str, "\t\n");
+}
+
+static void
+make_parent_dirs (const char * ap_file)
+{
+  char * p_dir = NULL;
+  char * p_sep = NULL;
+
+  assert (ap_file);
+
+  if (NULL == (p_dir = strndup (ap_file, PATH_MAX)))
+    {
+      return;
+    }
+
+  for (p_sep = strchr (p_dir + 1, '/'); p_sep; p_sep = strchr (p_sep + 1, '/'))
+    {
+      *p_sep = '\0';
+      (void) mkdir (p_dir, 0755);
+      *p_sep = '/';
+    }
+
+  tiz_mem_free (p_dir);
+}
+
+static void
+save_registry_cache (const char * ap_file,
+                     const tiz_core_cache_item_t * ap_items)
+{
+  char * p_tmp_file = NULL;
+  FILE * p_file = NULL;
+  int fd = -1;
+  int len = 0;
+
+  assert (ap_file);
+
+  if (NULL == (p_tmp_file = tiz_mem_alloc (PATH_MAX)))
+    {
+      return;
+    }
+
+  len = snprintf (p_tmp_file, PATH_MAX, "%s.XXXXXX", ap_file);
+  if (len <= 0 || len >= PATH_MAX)
+    {
+      tiz_mem_free (p_tmp_file);
+      return;
+    }
+
+  make_parent_dirs (ap_file);
+
+  /* Write a private copy, and then replace the cache in one go, so that
+     concurrent OMX_Init calls never see a partially written file */
+  if ((fd = mkstemp (p_tmp_file)) < 0
+      || NULL == (p_file = fdopen (fd, "w")))
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to write registry cache [%s] - [%s]",
+               ap_file, strerror (errno));
+      if (fd >= 0)
+        {
+          (void) close (fd);
+          (void) unlink (p_tmp_file);
+        }
+      tiz_mem_free (p_tmp_file);
+      return;
+    }
+
+  (void) fchmod (fd, 0644);
+  fprintf (p_file, "%s\n", TIZ_CORE_REGISTRY_CACHE_MAGIC);
+  for (; ap_items; ap_items = ap_items->p_next)
+    {
+      const role_list_item_t * p_role = ap_items->p_roles;
+      if (!cache_field_ok (ap_items->p_dl_path)
+          || !cache_field_ok (ap_items->p_dl_name))
+        {
+          continue;
+        }
+      fprintf (p_file, "%s\t%s\t%lld\t%lld\t%lld", ap_items->p_dl_path,
+               ap_items->p_dl_name, ap_items->mtime_sec, ap_items->mtime_nsec,
+               ap_items->size);
+      if (ap_items->p_comp_name)
+        {
+          fprintf (p_file, "\t%s", ap_items->p_comp_name);
+          for (; p_role; p_role = p_role->p_next)
+            {
+              fprintf (p_file, "\t%s", (const char *) p_role->role);
+            }
+        }
+      fprintf (p_file, "\n");
+    }
+
+  if (0 != fclose (p_file) || 0 != rename (p_tmp_file, ap_file))
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to write registry cache [%s] - [%s]",
+               ap_file, strerror (errno));
+      (void) unlink (p_tmp_file);
+    }
+
+  tiz_mem_free (p_tmp_file);
+}
+
+static tiz_core_cache_item_t *
+take_cache_item (tiz_core_cache_item_t ** app_items,
+                 const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
+                 const struct stat * ap_stat)
+{
+  tiz_core_cache_item_t ** pp_item = NULL;
+
+  assert (app_items);
+  assert (ap_stat);
+
+  for (pp_item = app_items; *pp_item; pp_item = &((*pp_item)->p_next))
+    {
+      tiz_core_cache_item_t * p_item = *pp_item;
+      if (p_item->mtime_sec == ap_stat->st_mtim.tv_sec
+          && p_item->mtime_nsec == ap_stat->st_mtim.tv_nsec
+          && p_item->size == ap_stat->st_size
+          && 0 == strncmp (p_item->p_dl_name, ap_dl_name, NAME_MAX)
+          && 0 == strncmp (p_item->p_dl_path, ap_dl_path, PATH_MAX))
+        {
+          *pp_item = p_item->p_next;
+          p_item->p_next = NULL;
+          return p_item;
+        }
+    }
+
+  return NULL;
+}
+
+static OMX_ERRORTYPE
+add_cached_comp_to_registry (const tiz_core_cache_item_t * ap_item)
+{
+  tiz_core_registry_item_t * p_registry_new = NULL;
+  bool roles_ok = true;
+
+  assert (ap_item);
+  assert (ap_item->p_comp_name);
+
+  if (find_comp_in_registry (ap_item->p_comp_name))
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "Component already in registry [%s]",
+               ap_item->p_comp_name);
+      return OMX_ErrorNone;
+    }
+
+  if (NULL == (p_registry_new = (tiz_core_registry_item_t *) tiz_mem_calloc (
+                 1, sizeof (tiz_core_registry_item_t))))
+    {
+      return OMX_ErrorInsufficientResources;
+    }
+
+  p_registry_new->p_comp_name
+    = strndup (ap_item->p_comp_name, OMX_MAX_STRINGNAME_SIZE);
+  p_registry_new->p_dl_name = strndup (ap_item->p_dl_name, NAME_MAX);
+  p_registry_new->p_dl_path = strndup (ap_item->p_dl_path, PATH_MAX);
+  p_registry_new->p_roles = dup_roles (ap_item->p_roles, &roles_ok);
+
+  if (!p_registry_new->p_comp_name || !p_registry_new->p_dl_name
+      || !p_registry_new->p_dl_path || !roles_ok)
+    {
+      tiz_mem_free (p_registry_new->p_comp_name);
+      tiz_mem_free (p_registry_new->p_dl_name);
+      tiz_mem_free (p_registry_new->p_dl_path);
+      free_roles (p_registry_new->p_roles);
+      tiz_mem_free (p_registry_new);
+      return OMX_ErrorInsufficientResources;
+    }
+
+  append_to_registry (p_registry_new);
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "Component [%s] added from cache.",
+           p_registry_new->p_comp_name);
+
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+register_comp_lib (const OMX_STRING ap_dl_path, const OMX_STRING ap_dl_name,
+                   tiz_core_cache_item_t ** app_cached,
+                   tiz_core_cache_item_t ** app_scanned, bool * ap_changed)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  tiz_core_registry_item_t * p_reg_item = NULL;
+  tiz_core_cache_item_t * p_item = NULL;
+  char * p_full_name = NULL;
+  struct stat st;
+  int stat_rc = -1;
+
+  assert (ap_dl_path);
+  assert (ap_dl_name);
+  assert (app_cached);
+  assert (app_scanned);
+  assert (ap_changed);
+
+  if ((p_full_name
+       = tiz_mem_alloc (strlen (ap_dl_path) + strlen (ap_dl_name) + 2)))
+    {
+      sprintf (p_full_name, "%s/%s", ap_dl_path, ap_dl_name);
+      stat_rc = stat (p_full_name, &st);
+      tiz_mem_free (p_full_name);
+    }
+
+  if (0 != stat_rc)
+    {
+      return cache_comp_info (ap_dl_path, ap_dl_name, &p_reg_item);
+    }
+
+  if ((p_item = take_cache_item (app_cached, ap_dl_path, ap_dl_name, &st)))
+    {
+      /* Unchanged since the last scan */
+      if (p_item->p_comp_name)
+        {
+          rc = add_cached_comp_to_registry (p_item);
+        }
+    }
+  else
+    {
+      /* New or modified library */
+      rc = cache_comp_info (ap_dl_path, ap_dl_name, &p_reg_item);
+      if (OMX_ErrorNone == rc && p_reg_item)
+        {
+          p_item = new_cache_item (ap_dl_path, ap_dl_name, &st, p_reg_item);
+        }
+      else if (OMX_ErrorComponentNotFound == rc)
+        {
+          /* A loadable library that is not an IL component; remember that
+             too. Libraries that fail to load for other reasons are not
+             recorded, so that they are retried next time. */
+          p_item = new_cache_item (ap_dl_path, ap_dl_name, &st, NULL);
+          rc = OMX_ErrorNone;
+        }
+      *ap_changed = *ap_changed || p_item;
+    }
+
+  if (p_item)
+    {
+      p_item->p_next = *app_scanned;
+      *app_scanned = p_item;
+    }
+
+  return rc;
+}
+
 static OMX_ERRORTYPE
 scan_component_folders (void)
 {
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
   DIR * p_dir;
   int i = 0;
   char ** pp_paths;
   unsigned long npaths = 0;
   struct dirent * p_dir_entry = NULL;
+  char * p_cache_file = NULL;
+  bool changed = false;
+  tiz_core_cache_item_t * p_cached = NULL;
+  tiz_core_cache_item_t * p_scanned = NULL;
+  tiz_core_registry_item_t * p_reg_item = NULL;
 
   if (NULL == (pp_paths = find_component_paths (&npaths)))
     {
@@ -782,7 +1374,12 @@ scan_component_folders (void)
       return OMX_ErrorInsufficientResources;
     }
 
-  for (i = 0; i < (int) npaths; i++)
+  if ((p_cache_file = registry_cache_file ()))
+    {
+      p_cached = load_registry_cache (p_cache_file);
+    }
+
+  for (i = 0; i < (int) npaths && OMX_ErrorInsufficientResources != rc; i++)
     {
       TIZ_LOG (TIZ_PRIORITY_TRACE, "Looking for component plugins : %s",
                pp_paths[i]);
@@ -796,7 +1393,8 @@ scan_component_folders (void)
         }
       else
         {
-          while ((p_dir_entry = readdir (p_dir)))
+          while (OMX_ErrorInsufficientResources != rc
+                 && (p_dir_entry = readdir (p_dir)))
             {
               if (p_dir_entry->d_name[0] != '.'
                   && p_dir_entry->d_name[strlen (p_dir_entry->d_name) - 1]
@@ -805,13 +1403,14 @@ scan_component_folders (void)
                   TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s]", p_dir_entry->d_name);
                   if (p_dir_entry->d_type == DT_REG)
                     {
-                      if (OMX_ErrorInsufficientResources
-                          == cache_comp_info (pp_paths[i], p_dir_entry->d_name))
-                        {
-                          (void) closedir (p_dir);
-                          free_paths (pp_paths, npaths);
-                          return OMX_ErrorInsufficientResources;
-                        }
+                      rc = p_cache_file
+                             ? register_comp_lib (pp_paths[i],
+                                                  p_dir_entry->d_name,
+                                                  &p_cached, &p_scanned,
+                                                  &changed)
+                             : cache_comp_info (pp_paths[i],
+                                                p_dir_entry->d_name,
+                                                &p_reg_item);
                     }
                 }
             } /* while */
@@ -820,9 +1419,19 @@ scan_component_folders (void)
         }
     }
 
+  /* Anything left over in the cache was removed since the last scan */
+  if (p_cache_file && OMX_ErrorInsufficientResources != rc
+      && (changed || p_cached))
+    {
+      save_registry_cache (p_cache_file, p_scanned);
+    }
+
+  tiz_mem_free (p_cache_file);
+  free_cache_items (p_cached);
+  free_cache_items (p_scanned);
   free_paths (pp_paths, npaths);
 
-  return OMX_ErrorNone;
+  return OMX_ErrorInsufficientResources == rc ? rc : OMX_ErrorNone;
 }
 
 static tiz_core_registry_item_t *
@@ -931,6 +1540,161 @@ find_hdl_in_registry (OMX_HANDLETYPE ap_hdl)
   return p_registry;
 }
 
+static OMX_U32
+instance_pool_size (const tiz_core_registry_item_t * ap_reg_item)
+{
+  /* A component-specific size, e.g.
+     'instance-pool-size.OMX.Aratelia.audio_decoder.mp3 = 2', takes precedence
+     over the global one */
+  char key[OMX_MAX_STRINGNAME_SIZE + 32];
+  const char * p_value = NULL;
+
+  assert (ap_reg_item);
+
+  if (snprintf (key, sizeof (key), "instance-pool-size.%s",
+                ap_reg_item->p_comp_name) < (int) sizeof (key))
+    {
+      p_value = tiz_rcfile_get_value ("ilcore", key);
+    }
+
+  if (!p_value)
+    {
+      p_value = tiz_rcfile_get_value ("ilcore", "instance-pool-size");
+    }
+
+  return p_value ? (OMX_U32) strtoul (p_value, NULL, 10)
+                 : TIZ_CORE_INSTANCE_POOL_DEFAULT_SIZE;
+}
+
+static OMX_ERRORTYPE
+pooled_event_handler (OMX_HANDLETYPE ap_hdl, OMX_PTR ap_app_data,
+                      OMX_EVENTTYPE a_event, OMX_U32 a_data1, OMX_U32 a_data2,
+                      OMX_PTR ap_event_data)
+{
+  (void) ap_app_data;
+  (void) a_data2;
+  (void) ap_event_data;
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "Pooled hdl [%p] : event [%s] data1 [%u]",
+           ap_hdl, tiz_evt_to_str (a_event), a_data1);
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+pooled_buffer_done (OMX_HANDLETYPE ap_hdl, OMX_PTR ap_app_data,
+                    OMX_BUFFERHEADERTYPE * ap_hdr)
+{
+  (void) ap_hdl;
+  (void) ap_app_data;
+  (void) ap_hdr;
+  return OMX_ErrorNone;
+}
+
+/* The callbacks of the instances in the pool. The IL client that released
+   them may be gone already */
+static OMX_CALLBACKTYPE pooled_callbacks = {
+  pooled_event_handler, pooled_buffer_done, pooled_buffer_done
+};
+
+static OMX_ERRORTYPE
+reset_comp_instance (OMX_COMPONENTTYPE * ap_hdl)
+{
+  OMX_TIZONIA_PARAM_COMPONENTRESETTYPE reset;
+  assert (ap_hdl);
+
+  /* The component re-creates its ports and processor and clears its
+     counters, which leaves the instance in the same state as a new one, minus
+     the thread and the rest of the component infrastructure. Components that
+     don't support this extension are not pooled. */
+  TIZ_INIT_OMX_STRUCT (reset);
+  return ap_hdl->SetParameter ((OMX_HANDLETYPE) ap_hdl,
+                               OMX_TizoniaIndexParamComponentReset, &reset);
+}
+
+static bool
+park_comp_instance (tiz_core_registry_item_t * ap_reg_item)
+{
+  OMX_COMPONENTTYPE * p_hdl = NULL;
+  OMX_STATETYPE state = OMX_StateMax;
+  tiz_core_pool_item_t * p_item = NULL;
+
+  assert (ap_reg_item);
+  p_hdl = (OMX_COMPONENTTYPE *) ap_reg_item->p_hdl;
+  assert (p_hdl);
+
+  if (ap_reg_item->pool_len >= instance_pool_size (ap_reg_item))
+    {
+      return false;
+    }
+
+  /* Only an instance that is in OMX_StateLoaded and that could be put back to
+     its initial configuration can be handed out again as if it had just been
+     created */
+  if (OMX_ErrorNone != p_hdl->GetState ((OMX_HANDLETYPE) p_hdl, &state)
+      || OMX_StateLoaded != state
+      || OMX_ErrorNone
+           != p_hdl->SetCallbacks ((OMX_HANDLETYPE) p_hdl, &pooled_callbacks,
+                                   NULL)
+      || OMX_ErrorNone != reset_comp_instance (p_hdl))
+    {
+      return false;
+    }
+
+  if (NULL == (p_item = (tiz_core_pool_item_t *) tiz_mem_calloc (
+                 1, sizeof (tiz_core_pool_item_t))))
+    {
+      return false;
+    }
+
+  p_item->p_hdl = p_hdl;
+  p_item->p_dl_hdl = ap_reg_item->p_dl_hdl;
+  p_item->p_next = ap_reg_item->p_pool;
+  ap_reg_item->p_pool = p_item;
+  ap_reg_item->pool_len++;
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s] : hdl [%p] pooled (%u in pool)",
+           ap_reg_item->p_comp_name, p_hdl, ap_reg_item->pool_len);
+  return true;
+}
+
+static bool
+reuse_comp_instance (tiz_core_registry_item_t * ap_reg_item,
+                     tiz_core_msg_gethandle_t * ap_msg)
+{
+  tiz_core_pool_item_t * p_item = NULL;
+
+  assert (ap_reg_item);
+  assert (ap_msg);
+
+  while ((p_item = ap_reg_item->p_pool))
+    {
+      OMX_COMPONENTTYPE * p_hdl = (OMX_COMPONENTTYPE *) p_item->p_hdl;
+      OMX_PTR p_dl_hdl = p_item->p_dl_hdl;
+
+      ap_reg_item->p_pool = p_item->p_next;
+      ap_reg_item->pool_len--;
+      tiz_mem_free (p_item);
+
+      /* The instance was reset when it was parked */
+      if (OMX_ErrorNone
+          == p_hdl->SetCallbacks ((OMX_HANDLETYPE) p_hdl, ap_msg->p_callbacks,
+                                  ap_msg->p_app_data))
+        {
+          TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s] : reusing hdl [%p]",
+                   ap_reg_item->p_comp_name, p_hdl);
+          *(ap_msg->pp_hdl) = p_hdl;
+          ap_reg_item->p_hdl = p_hdl;
+          ap_reg_item->p_dl_hdl = p_dl_hdl;
+          return true;
+        }
+
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "[%s] : unable to reuse hdl [%p]",
+               ap_reg_item->p_comp_name, p_hdl);
+      destroy_comp_instance (p_hdl, p_dl_hdl);
+    }
+
+  return false;
+}
+
 static inline OMX_ERRORTYPE
 instantiate_component (tiz_core_msg_gethandle_t * ap_msg)
 {
@@ -948,6 +1712,11 @@ instantiate_component (tiz_core_msg_gethandle_t * ap_msg)
 
   if ((p_reg_item = find_comp_in_registry (ap_msg->p_comp_name)))
     {
+      if (reuse_comp_instance (p_reg_item, ap_msg))
+        {
+          return OMX_ErrorNone;
+        }
+
       if (OMX_ErrorNone
           == (rc = instantiate_comp_lib (
                 p_reg_item->p_dl_path, p_reg_item->p_dl_name,
@@ -964,7 +1733,7 @@ instantiate_component (tiz_core_msg_gethandle_t * ap_msg)
               TIZ_LOG (TIZ_PRIORITY_ERROR,
                        "[OMX_ErrorInsufficientResources] : "
                        "Could not allocate memory for component handle");
-              dlclose (p_dl_hdl);
+              close_comp_lib (p_dl_hdl);
               return OMX_ErrorInsufficientResources;
             }
 
@@ -977,7 +1746,7 @@ instantiate_component (tiz_core_msg_gethandle_t * ap_msg)
                        "failed",
                        tiz_err_to_str (rc));
               tiz_mem_free (p_hdl);
-              dlclose (p_dl_hdl);
+              close_comp_lib (p_dl_hdl);
               return rc;
             }
 
@@ -990,7 +1759,7 @@ instantiate_component (tiz_core_msg_gethandle_t * ap_msg)
               TIZ_LOG (TIZ_PRIORITY_ERROR, "[%s] : Call to SetCallbacks failed",
                        tiz_err_to_str (rc));
               tiz_mem_free (p_hdl);
-              dlclose (p_dl_hdl);
+              close_comp_lib (p_dl_hdl);
               return rc;
             }
 
@@ -1014,7 +1783,6 @@ instantiate_component (tiz_core_msg_gethandle_t * ap_msg)
 static OMX_ERRORTYPE
 remove_comp_instance (tiz_core_msg_freehandle_t * ap_msg)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
   OMX_COMPONENTTYPE * p_hdl = NULL;
   tiz_core_registry_item_t * p_reg_item = NULL;
 
@@ -1026,22 +1794,15 @@ remove_comp_instance (tiz_core_msg_freehandle_t * ap_msg)
       p_hdl = (OMX_COMPONENTTYPE *) p_reg_item->p_hdl;
       assert (p_hdl);
 
-      /* Unload the component */
-      if (OMX_ErrorNone
-          != (rc = p_hdl->ComponentDeInit ((OMX_HANDLETYPE) p_hdl)))
-        {
-          TIZ_LOG (TIZ_PRIORITY_ERROR, "Call to ComponentDeinit point failed");
-        }
-      else
+      /* Keep the instance for the next OMX_GetHandle, if the pool allows */
+      if (!park_comp_instance (p_reg_item))
         {
+          destroy_comp_instance (p_hdl, p_reg_item->p_dl_hdl);
           TIZ_LOG (TIZ_PRIORITY_TRACE, "Success - [%s] deleted ",
                    p_reg_item->p_comp_name);
         }
 
-      /*  Deallocate the component hdl */
-      tiz_mem_free (p_hdl);
       p_reg_item->p_hdl = NULL;
-      dlclose (p_reg_item->p_dl_hdl);
       p_reg_item->p_dl_hdl = NULL;
     }
   else
@@ -30,11 +30,14 @@
 
 
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "OMX_Core.h"
 #include "OMX_Component.h"
 #include "OMX_Types.h"
+#include "OMX_TizoniaExt.h"
 
 #include "tizplatform.h"
 
@@ -45,9 +48,39 @@
 
 #define TIZ_CORE_TEST_COMPONENT_ROLE "default"
 #define TIZ_CORE_TEST_COMPONENT_NAME "OMX.Aratelia.ilcore.test_component"
+#define TIZ_CORE_TEST_COMPONENT_BUFFER_COUNT 2
+
+/* Instances created and destroyed. Kept in the environment, so that they
+   survive this library being unloaded, and can be read by the test program */
+#define TIZ_CORE_TEST_COMPONENT_CREATED_ENV "TIZ_CORE_TEST_COMPONENT_CREATED"
+#define TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV "TIZ_CORE_TEST_COMPONENT_DESTROYED"
+
+typedef struct tc_prv tc_prv_t;
+struct tc_prv
+{
+  OMX_STATETYPE state;
+  OMX_U32 buffer_count;
+};
 
 static OMX_VERSIONTYPE tc_comp_version = { {1, 0, 0, 0} };
 
+static void
+count_instance (const char * ap_env_var)
+{
+  char count[32];
+  const char * p_count = getenv (ap_env_var);
+  snprintf (count, sizeof (count), "%ld",
+            (p_count ? strtol (p_count, NULL, 10) : 0) + 1);
+  setenv (ap_env_var, count, 1);
+}
+
+static tc_prv_t *
+get_prv (OMX_HANDLETYPE ap_hdl)
+{
+  assert (ap_hdl);
+  return ((OMX_COMPONENTTYPE *) ap_hdl)->pComponentPrivate;
+}
+
 static OMX_ERRORTYPE
 GetComponentVersion (OMX_HANDLETYPE ap_hdl,
                      OMX_STRING ap_comp_name,
@@ -82,18 +115,43 @@ static OMX_ERRORTYPE
 SendCommand (OMX_HANDLETYPE ap_hdl,
              OMX_COMMANDTYPE a_cmd, OMX_U32 a_param1, OMX_PTR ap_cmd_data)
 {
+  /* State transitions complete immediately */
+  if (OMX_CommandStateSet == a_cmd)
+    {
+      get_prv (ap_hdl)->state = (OMX_STATETYPE) a_param1;
+    }
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
 GetParameter (OMX_HANDLETYPE ap_hdl, OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
 {
+  if (OMX_IndexParamPortDefinition == a_index)
+    {
+      OMX_PARAM_PORTDEFINITIONTYPE *p_def = ap_struct;
+      p_def->nBufferCountActual = get_prv (ap_hdl)->buffer_count;
+    }
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
 SetParameter (OMX_HANDLETYPE ap_hdl, OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
 {
+  tc_prv_t *p_prv = get_prv (ap_hdl);
+
+  if (OMX_IndexParamPortDefinition == a_index)
+    {
+      const OMX_PARAM_PORTDEFINITIONTYPE *p_def = ap_struct;
+      p_prv->buffer_count = p_def->nBufferCountActual;
+    }
+  else if (OMX_TizoniaIndexParamComponentReset == a_index)
+    {
+      if (OMX_StateLoaded != p_prv->state)
+        {
+          return OMX_ErrorIncorrectStateOperation;
+        }
+      p_prv->buffer_count = TIZ_CORE_TEST_COMPONENT_BUFFER_COUNT;
+    }
   return OMX_ErrorNone;
 }
 
@@ -119,6 +177,7 @@ GetExtensionIndex (OMX_HANDLETYPE ap_hdl,
 static OMX_ERRORTYPE
 GetState (OMX_HANDLETYPE ap_hdl, OMX_STATETYPE * ap_state)
 {
+  *ap_state = get_prv (ap_hdl)->state;
   return OMX_ErrorNone;
 }
 
@@ -180,6 +239,9 @@ static OMX_ERRORTYPE
 ComponentDeInit (OMX_HANDLETYPE ap_hdl)
 {
   TIZ_LOG (TIZ_PRIORITY_TRACE, "ComponentDeInit");
+  tiz_mem_free (get_prv (ap_hdl));
+  ((OMX_COMPONENTTYPE *) ap_hdl)->pComponentPrivate = NULL;
+  count_instance (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV);
   return OMX_ErrorNone;
 }
 
@@ -224,18 +286,26 @@ OMX_ComponentInit (OMX_HANDLETYPE ap_hdl)
 {
 
   OMX_COMPONENTTYPE *p_hdl = (OMX_COMPONENTTYPE *) ap_hdl;
+  tc_prv_t *p_prv = NULL;
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "OMX_ComponentInit: "
            "Inititializing the test component's hdl");
 
   assert (p_hdl);
 
+  if (!(p_prv = tiz_mem_calloc (1, sizeof (tc_prv_t))))
+    {
+      return OMX_ErrorInsufficientResources;
+    }
+  p_prv->state = OMX_StateLoaded;
+  p_prv->buffer_count = TIZ_CORE_TEST_COMPONENT_BUFFER_COUNT;
+
   /* Fill in the component hdl */
   p_hdl->nVersion.s.nVersionMajor = 1;
   p_hdl->nVersion.s.nVersionMinor = 0;
   p_hdl->nVersion.s.nRevision = 0;
   p_hdl->nVersion.s.nStep = 0;
-  p_hdl->pComponentPrivate = 0;
+  p_hdl->pComponentPrivate = p_prv;
   p_hdl->pApplicationPrivate = 0;
   p_hdl->GetComponentVersion = GetComponentVersion;
   p_hdl->SendCommand = SendCommand;
@@ -256,6 +326,8 @@ OMX_ComponentInit (OMX_HANDLETYPE ap_hdl)
   p_hdl->UseEGLImage = UseEGLImage;
   p_hdl->ComponentRoleEnum = ComponentRoleEnum;
 
+  count_instance (TIZ_CORE_TEST_COMPONENT_CREATED_ENV);
+
   return OMX_ErrorNone;
 
 }
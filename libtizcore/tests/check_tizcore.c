@@ -40,6 +40,7 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <limits.h>
+#include <sys/stat.h>
 
 #include <tizplatform.h>
 
@@ -52,6 +53,9 @@
 
 #define TIZ_CORE_TEST_COMPONENT_NAME "OMX.Aratelia.ilcore.test_component"
 #define TIZ_CORE_TEST_COMPONENT_ROLE "default"
+#define TIZ_CORE_TEST_COMPONENT_BUFFER_COUNT 2
+#define TIZ_CORE_TEST_COMPONENT_CREATED_ENV "TIZ_CORE_TEST_COMPONENT_CREATED"
+#define TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV "TIZ_CORE_TEST_COMPONENT_DESTROYED"
 #define AUDIO_RENDERER "OMX.Aratelia.audio_renderer.alsa.pcm"
 #define FILE_READER "OMX.Aratelia.file_reader.binary"
 
@@ -112,6 +116,13 @@ refresh_rm_db (void)
   return rv;
 }
 
+static long
+test_component_count (const char * ap_env_var)
+{
+  const char * p_count = getenv (ap_env_var);
+  return p_count ? strtol (p_count, NULL, 10) : 0;
+}
+
 static void
 setup (void)
 {
@@ -284,7 +295,171 @@ START_TEST (test_ilcore_role_of_comp_enum)
   fail_if (error != OMX_ErrorNone);
 }
 
-END_TEST Suite * tizcore_suite (void)
+END_TEST
+
+START_TEST (test_ilcore_registry_cache)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = NULL;
+  OMX_U32 appData;
+  OMX_CALLBACKTYPE callBacks;
+  OMX_U32 index = 0;
+  OMX_S8 comp_name[OMX_MAX_STRINGNAME_SIZE];
+  struct stat cache_stat;
+
+  (void) unlink (TIZ_CORE_TEST_REGISTRY_CACHE);
+
+  /* The first scan creates the cache */
+  error = OMX_Init ();
+  fail_if (error != OMX_ErrorNone);
+  error = OMX_Deinit ();
+  fail_if (error != OMX_ErrorNone);
+  fail_if (0 != stat (TIZ_CORE_TEST_REGISTRY_CACHE, &cache_stat));
+  fail_if (0 == cache_stat.st_size);
+
+  /* The registry is now populated from the cache, and components are only
+     loaded on demand */
+  error = OMX_Init ();
+  fail_if (error != OMX_ErrorNone);
+
+  do
+    {
+      error = OMX_ComponentOfRoleEnum ((OMX_STRING) comp_name,
+                                       TIZ_CORE_TEST_COMPONENT_ROLE, index++);
+    } while (OMX_ErrorNone == error);
+  fail_if (OMX_ErrorNoMore != error);
+  fail_if (index != 2);
+
+  error = OMX_GetHandle (&p_hdl,
+                         TIZ_CORE_TEST_COMPONENT_NAME,
+                         (OMX_PTR *) (&appData), &callBacks);
+  fail_if (error != OMX_ErrorNone);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (error != OMX_ErrorNone);
+
+  error = OMX_Deinit ();
+  fail_if (error != OMX_ErrorNone);
+}
+END_TEST
+
+START_TEST (test_ilcore_instance_pool_reuse)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl1 = NULL;
+  OMX_HANDLETYPE p_hdl2 = NULL;
+  OMX_U32 appData;
+  OMX_CALLBACKTYPE callBacks;
+  OMX_STATETYPE state = OMX_StateMax;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  long created = 0;
+  long destroyed = 0;
+
+  error = OMX_Init ();
+  fail_if (error != OMX_ErrorNone);
+
+  created = test_component_count (TIZ_CORE_TEST_COMPONENT_CREATED_ENV);
+  destroyed = test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV);
+
+  error = OMX_GetHandle (&p_hdl1,
+                         TIZ_CORE_TEST_COMPONENT_NAME,
+                         (OMX_PTR *) (&appData), &callBacks);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (created + 1
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_CREATED_ENV));
+
+  /* Leave some non-default state behind */
+  TIZ_INIT_OMX_PORT_STRUCT (port_def, 0);
+  port_def.nBufferCountActual = TIZ_CORE_TEST_COMPONENT_BUFFER_COUNT + 5;
+  error = OMX_SetParameter (p_hdl1, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (error != OMX_ErrorNone);
+
+  /* The instance is kept in the pool */
+  error = OMX_FreeHandle (p_hdl1);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (destroyed
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV));
+
+  /* ... and handed out again, as if it was a new one */
+  error = OMX_GetHandle (&p_hdl2,
+                         TIZ_CORE_TEST_COMPONENT_NAME,
+                         (OMX_PTR *) (&appData), &callBacks);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (p_hdl2 != p_hdl1);
+  fail_if (created + 1
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_CREATED_ENV));
+
+  error = OMX_GetState (p_hdl2, &state);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (OMX_StateLoaded != state);
+
+  TIZ_INIT_OMX_PORT_STRUCT (port_def, 0);
+  error = OMX_GetParameter (p_hdl2, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (TIZ_CORE_TEST_COMPONENT_BUFFER_COUNT != port_def.nBufferCountActual);
+
+  error = OMX_FreeHandle (p_hdl2);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (destroyed
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV));
+
+  /* OMX_Deinit destroys the pooled instance */
+  error = OMX_Deinit ();
+  fail_if (error != OMX_ErrorNone);
+  fail_if (destroyed + 1
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV));
+}
+END_TEST
+
+START_TEST (test_ilcore_instance_pool_skips_non_loaded)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = NULL;
+  OMX_U32 appData;
+  OMX_CALLBACKTYPE callBacks;
+  long created = 0;
+  long destroyed = 0;
+
+  error = OMX_Init ();
+  fail_if (error != OMX_ErrorNone);
+
+  created = test_component_count (TIZ_CORE_TEST_COMPONENT_CREATED_ENV);
+  destroyed = test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV);
+
+  error = OMX_GetHandle (&p_hdl,
+                         TIZ_CORE_TEST_COMPONENT_NAME,
+                         (OMX_PTR *) (&appData), &callBacks);
+  fail_if (error != OMX_ErrorNone);
+
+  error = OMX_SendCommand (p_hdl, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  fail_if (error != OMX_ErrorNone);
+
+  /* An instance that is not in OMX_StateLoaded is destroyed right away */
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (destroyed + 1
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV));
+
+  /* So the next handle is a new instance */
+  error = OMX_GetHandle (&p_hdl,
+                         TIZ_CORE_TEST_COMPONENT_NAME,
+                         (OMX_PTR *) (&appData), &callBacks);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (created + 2
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_CREATED_ENV));
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (error != OMX_ErrorNone);
+
+  error = OMX_Deinit ();
+  fail_if (error != OMX_ErrorNone);
+  fail_if (destroyed + 2
+           != test_component_count (TIZ_CORE_TEST_COMPONENT_DESTROYED_ENV));
+}
+END_TEST
+
+Suite *
+tizcore_suite (void)
 {
   TCase *tc_ilcore;
   Suite *s = suite_create ("libtizcore");
@@ -302,6 +477,9 @@ END_TEST Suite * tizcore_suite (void)
   /*   tcase_add_test (tc_ilcore, test_ilcore_setup_tunnel_tear_down_tunnel); */
   tcase_add_test (tc_ilcore, test_ilcore_comp_of_role_enum);
   tcase_add_test (tc_ilcore, test_ilcore_role_of_comp_enum);
+  tcase_add_test (tc_ilcore, test_ilcore_registry_cache);
+  tcase_add_test (tc_ilcore, test_ilcore_instance_pool_reuse);
+  tcase_add_test (tc_ilcore, test_ilcore_instance_pool_skips_non_loaded);
 
   /* TODO: Negative case for OMX_ErrorPortsNotConnected error */
 
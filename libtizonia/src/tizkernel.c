@@ -130,6 +130,8 @@ init_ports_and_lists (void * ap_obj)
     tiz_vector_init (&(p_obj->p_ingress_), sizeof (tiz_vector_t *)));
   tiz_check_omx_ret_oom (
     tiz_vector_init (&(p_obj->p_egress_), sizeof (tiz_vector_t *)));
+  tiz_check_omx_ret_oom (
+    tiz_vector_init (&(p_obj->p_perf_), sizeof (tiz_krn_perf_t)));
 
   p_obj->p_cport_ = NULL;
   p_obj->p_proc_ = NULL;
@@ -193,6 +195,10 @@ deinit_ports_and_lists (void * ap_obj)
     }
   tiz_vector_destroy (p_obj->p_egress_);
   p_obj->p_egress_ = NULL;
+
+  tiz_vector_clear (p_obj->p_perf_);
+  tiz_vector_destroy (p_obj->p_perf_);
+  p_obj->p_perf_ = NULL;
 }
 
 static OMX_ERRORTYPE
@@ -245,6 +251,52 @@ apply_slaving_behaviour (const tiz_krn_t * ap_krn, OMX_HANDLETYPE ap_hdl,
   return rc;
 }
 
+static OMX_ERRORTYPE
+get_perf_counters (const tiz_krn_t * ap_krn, OMX_PTR ap_struct)
+{
+  OMX_TIZONIA_PERFCOUNTERSTYPE * p_counters = ap_struct;
+  OMX_S32 nports = 0;
+  OMX_S32 i = 0;
+
+  assert (ap_krn);
+  nports = tiz_vector_length (ap_krn->p_ports_);
+
+  if (!p_counters)
+    {
+      return OMX_ErrorBadParameter;
+    }
+
+  if (OMX_ALL != p_counters->nPortIndex
+      && OMX_ErrorNone != check_pid (ap_krn, p_counters->nPortIndex))
+    {
+      return OMX_ErrorBadPortIndex;
+    }
+
+  /* The component-wide counters are filled in by the scheduler */
+  p_counters->nBuffers = 0;
+  p_counters->nBytes = 0;
+  p_counters->nQueueHighWaterMark = 0;
+  p_counters->nUnderruns = 0;
+
+  for (i = 0; i < nports; ++i)
+    {
+      const tiz_krn_perf_t * p_perf = get_perf (ap_krn, i);
+      if (OMX_ALL == p_counters->nPortIndex
+          || (OMX_U32) i == p_counters->nPortIndex)
+        {
+          p_counters->nBuffers += p_perf->buffers;
+          p_counters->nBytes += p_perf->bytes;
+          p_counters->nUnderruns += p_perf->underruns;
+          if (p_perf->queue_hwm > p_counters->nQueueHighWaterMark)
+            {
+              p_counters->nQueueHighWaterMark = p_perf->queue_hwm;
+            }
+        }
+    }
+
+  return OMX_ErrorNone;
+}
+
 /*
  * tiz_krn construction / destruction
  */
@@ -425,6 +477,12 @@ krn_GetConfig (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
 
   TIZ_TRACE (ap_hdl, "[%s]...", tiz_idx_to_str (a_index));
 
+  if (OMX_TizoniaIndexConfigPerfCounters == a_index)
+    {
+      /* The kernel itself keeps these */
+      return get_perf_counters (p_obj, ap_struct);
+    }
+
   /* Find the port that holds the data */
   if (OMX_ErrorNone
       == (rc = tiz_krn_find_managing_port (p_obj, a_index, ap_struct, &p_port)))
@@ -554,6 +612,24 @@ krn_GetExtensionIndex (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                                       ap_index_type);
     }
 
+  if (OMX_ErrorUnsupportedIndex == rc
+      && 0
+           == strncmp (ap_param_name, OMX_TIZONIA_INDEX_CONFIG_PERFCOUNTERS,
+                       strlen (OMX_TIZONIA_INDEX_CONFIG_PERFCOUNTERS)))
+    {
+      *ap_index_type = OMX_TizoniaIndexConfigPerfCounters;
+      rc = OMX_ErrorNone;
+    }
+
+  if (OMX_ErrorUnsupportedIndex == rc
+      && 0
+           == strncmp (ap_param_name, OMX_TIZONIA_INDEX_PARAM_COMPONENTRESET,
+                       strlen (OMX_TIZONIA_INDEX_PARAM_COMPONENTRESET)))
+    {
+      *ap_index_type = OMX_TizoniaIndexParamComponentReset;
+      rc = OMX_ErrorNone;
+    }
+
   return rc;
 }
 
@@ -1304,6 +1380,10 @@ krn_register_port (void * ap_obj, OMX_PTR ap_port, const bool ais_config)
     assert (p_out_list);
     tiz_check_omx (tiz_vector_push_back (p_obj->p_ingress_, &p_in_list));
     tiz_check_omx (tiz_vector_push_back (p_obj->p_egress_, &p_out_list));
+    {
+      const tiz_krn_perf_t perf = {0, 0, 0, 0, OMX_FALSE};
+      tiz_check_omx (tiz_vector_push_back (p_obj->p_perf_, (OMX_PTR) &perf));
+    }
 
     pid = tiz_vector_length (p_obj->p_ports_);
     tiz_port_set_index (ap_port, pid);
@@ -1403,7 +1483,7 @@ krn_get_port (const void * ap_obj, const OMX_U32 a_pid)
 void *
 tiz_krn_get_port (const void * ap_obj, const OMX_U32 a_pid)
 {
-  const tiz_krn_class_t * class = classOf (ap_obj);
+  const tiz_krn_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->get_port);
   return class->get_port (ap_obj, a_pid);
 }
@@ -1728,6 +1808,22 @@ krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid, const OMX_U32 a_pos,
             }
         }
     }
+  else
+    {
+      /* The processor is left waiting when the port has none of its buffers
+         at hand, and none is claimed either. The claim that ends a batch
+         usually finds the port empty too, so this is only counted once
+         until a buffer arrives. */
+      tiz_krn_perf_t * p_perf = get_perf (p_obj, a_pid);
+      if (!p_perf->starved && TIZ_PORT_IS_POPULATED (p_port)
+          && 0 == TIZ_PORT_GET_CLAIMED_COUNT (p_port)
+          && EStateExecuting
+               == tiz_fsm_get_substate (tiz_get_fsm (handleOf (p_obj))))
+        {
+          p_perf->starved = OMX_TRUE;
+          p_perf->underruns++;
+        }
+    }
 
   *app_hdr = p_hdr;
 
@@ -1743,7 +1839,7 @@ OMX_ERRORTYPE
 tiz_krn_claim_buffer (const void * ap_obj, const OMX_U32 a_pid,
                       const OMX_U32 a_pos, OMX_BUFFERHEADERTYPE ** app_hdr)
 {
-  const tiz_krn_class_t * class = classOf (ap_obj);
+  const tiz_krn_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->claim_buffer);
   return class->claim_buffer (ap_obj, a_pid, a_pos, app_hdr);
 }
@@ -1790,6 +1886,12 @@ krn_release_buffer (const void * ap_obj, const OMX_U32 a_pid,
 
   assert (tiz_vector_length (p_list) < tiz_port_buffer_count (p_port));
 
+  {
+    tiz_krn_perf_t * p_perf = get_perf (p_obj, a_pid);
+    p_perf->buffers++;
+    p_perf->bytes += ap_hdr->nFilledLen;
+  }
+
   return enqueue_callback_msg (p_obj, ap_hdr, a_pid, tiz_port_dir (p_port));
 }
 
@@ -1797,7 +1899,7 @@ OMX_ERRORTYPE
 tiz_krn_release_buffer (const void * ap_obj, const OMX_U32 a_pid,
                         OMX_BUFFERHEADERTYPE * ap_hdr)
 {
-  const tiz_krn_class_t * class = classOf (ap_obj);
+  const tiz_krn_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->release_buffer);
   return class->release_buffer (ap_obj, a_pid, ap_hdr);
 }
@@ -105,6 +105,17 @@ struct tiz_krn_msg_str
   OMX_STRING str;
 };
 
+/* Per-port run-time counters (see OMX_TIZONIA_PERFCOUNTERSTYPE) */
+typedef struct tiz_krn_perf tiz_krn_perf_t;
+struct tiz_krn_perf
+{
+  OMX_U64 buffers;
+  OMX_U64 bytes;
+  OMX_U32 queue_hwm;
+  OMX_U32 underruns;
+  OMX_BOOL starved; /* The processor is waiting for a buffer on this port */
+};
+
 typedef struct tiz_krn tiz_krn_t;
 struct tiz_krn
 {
@@ -113,6 +124,7 @@ struct tiz_krn
   tiz_vector_t * p_ports_;
   tiz_vector_t * p_ingress_;
   tiz_vector_t * p_egress_;
+  tiz_vector_t * p_perf_;
   OMX_PTR p_cport_;
   OMX_PTR p_proc_;
   bool eos_;
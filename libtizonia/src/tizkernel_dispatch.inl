@@ -815,6 +815,15 @@ static OMX_ERRORTYPE dispatch_efb (void *ap_obj, OMX_PTR ap_msg,
 
   TIZ_TRACE (p_hdl, "ingress list length [%d]", nbufs);
 
+  {
+    tiz_krn_perf_t * p_perf = get_perf (p_obj, pid);
+    if ((OMX_U32) nbufs > p_perf->queue_hwm)
+      {
+        p_perf->queue_hwm = nbufs;
+      }
+    p_perf->starved = OMX_FALSE;
+  }
+
   if (TIZ_PORT_IS_BEING_DISABLED (p_port))
     {
       return dispatch_efb_port_disable_in_progress (ap_obj, p_port, pid, nbufs);
@@ -126,6 +126,16 @@ static inline OMX_PTR get_port (const tiz_krn_t *ap_obj, const OMX_U32 a_pid)
   return *pp_port;
 }
 
+static inline tiz_krn_perf_t *get_perf (const tiz_krn_t *ap_obj,
+                                        const OMX_U32 a_pid)
+{
+  tiz_krn_perf_t *p_perf = NULL;
+  assert (ap_obj);
+  p_perf = tiz_vector_at (ap_obj->p_perf_, a_pid);
+  assert (p_perf);
+  return p_perf;
+}
+
 static inline OMX_BUFFERHEADERTYPE *get_header (const tiz_vector_t *ap_list,
                                                 OMX_U32 a_index)
 {
@@ -749,6 +759,10 @@ static OMX_ERRORTYPE complete_port_enable (void *ap_obj, OMX_PTR ap_port,
   /* Set enabled flag */
   TIZ_PORT_SET_ENABLED (ap_port);
 
+  /* A re-enabled port may carry a new stream, whose EOS must be reported
+     too */
+  p_obj->eos_ = false;
+
   /* Now it is time to notify the processor servant that a port is being
      enabled (telling the processor should be the last thing we do during the
      port enable sequence). */
@@ -900,6 +914,7 @@ static OMX_BOOL process_efb_from_servant_queue (OMX_PTR ap_elem,
           /* Add this buffer to the ingress hdr list */
           if (0 < add_to_buflst (p_obj, p_obj->p_ingress_, p_hdr, p_port))
             {
+              get_perf (p_obj, pid)->starved = OMX_FALSE;
               rc = OMX_TRUE;
             }
           else
@@ -54,6 +54,12 @@ struct tiz_class
   void * (*dtor) (void * p_obj);
 };
 
+/* The class of an object, without going through classOf. The class structs
+   carry their full, already inherited, set of methods, so this is all the
+   selectors on the buffer processing paths need before calling through. */
+#define TIZ_CLASS_OF(ap_obj) \
+  ((const void *) ((const tiz_object_t *) (ap_obj))->class)
+
 void *
 super_ctor (const void * class, void * p_obj, va_list * app);
 void *
@@ -86,11 +86,27 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.tizonia.objsys"
 #endif
 
+/* Size of the type index (a power of two, and comfortably larger than the
+   number of types a component registers) */
+#define TIZ_OS_INDEX_SIZE 128
+
+typedef struct tiz_os_slot tiz_os_slot_t;
+struct tiz_os_slot
+{
+  OMX_U32 hash;
+  const char * p_name;
+  void * p_type;
+};
+
 struct tiz_os
 {
   tiz_map_t * p_map;
   OMX_HANDLETYPE p_hdl;
   tiz_soa_t * p_soa;
+  /* Open-addressed index of the registered types, filled in at registration
+     time. Every super_* and typeOf call resolves its class here, instead of
+     walking the map. */
+  tiz_os_slot_t * p_index;
 };
 
 typedef enum tiz_os_type tiz_os_type_t;
@@ -415,6 +431,64 @@ os_map_free_func (OMX_PTR ap_key, OMX_PTR ap_value)
   tiz_mem_free (ap_value);
 }
 
+static inline OMX_U32
+os_hash (const char * a_name)
+{
+  /* FNV-1a */
+  OMX_U32 hash = 2166136261u;
+  while (*a_name)
+    {
+      hash ^= (unsigned char) *a_name++;
+      hash *= 16777619u;
+    }
+  return hash;
+}
+
+static void
+os_index_insert (tiz_os_t * ap_os, const char * a_name, void * ap_type)
+{
+  const OMX_U32 hash = os_hash (a_name);
+  OMX_U32 i = 0;
+
+  assert (ap_os);
+
+  for (i = 0; i < TIZ_OS_INDEX_SIZE; ++i)
+    {
+      tiz_os_slot_t * p_slot
+        = &(ap_os->p_index[(hash + i) & (TIZ_OS_INDEX_SIZE - 1)]);
+      if (!p_slot->p_name)
+        {
+          p_slot->hash = hash;
+          p_slot->p_name = a_name;
+          p_slot->p_type = ap_type;
+          return;
+        }
+    }
+  /* The index is full; this type will be found in the map */
+}
+
+static inline void *
+os_index_find (const tiz_os_t * ap_os, const char * a_name)
+{
+  const OMX_U32 hash = os_hash (a_name);
+  OMX_U32 i = 0;
+
+  for (i = 0; i < TIZ_OS_INDEX_SIZE; ++i)
+    {
+      const tiz_os_slot_t * p_slot
+        = &(ap_os->p_index[(hash + i) & (TIZ_OS_INDEX_SIZE - 1)]);
+      if (!p_slot->p_name)
+        {
+          break;
+        }
+      if (p_slot->hash == hash && 0 == strcmp (p_slot->p_name, a_name))
+        {
+          return p_slot->p_type;
+        }
+    }
+  return NULL;
+}
+
 #ifdef _DEBUG
 static OMX_S32
 print_function (OMX_PTR ap_key, OMX_PTR ap_value, OMX_PTR ap_arg)
@@ -442,6 +516,7 @@ os_register_type (tiz_os_t * ap_os, const tiz_os_type_init_f a_type_init_f,
 {
   OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
   void * p_obj = NULL;
+  char * p_name = NULL;
 
   assert (ap_os);
   assert (ap_os->p_map);
@@ -461,9 +536,14 @@ os_register_type (tiz_os_t * ap_os, const tiz_os_type_init_f a_type_init_f,
                  "Registering type #[%d] : [%s] -> [%p] "
                  "nameOf [%s]",
                  a_type_id, a_type_name, p_obj, nameOf (p_obj));
-      rc = tiz_map_insert (ap_os->p_map, os_strndup (ap_os->p_soa, a_type_name,
-                                                     OMX_MAX_STRINGNAME_SIZE),
-                           p_obj, (OMX_U32 *) (&a_type_id));
+      p_name
+        = os_strndup (ap_os->p_soa, a_type_name, OMX_MAX_STRINGNAME_SIZE);
+      rc = tiz_map_insert (ap_os->p_map, p_name, p_obj,
+                           (OMX_U32 *) (&a_type_id));
+      if (OMX_ErrorNone == rc)
+        {
+          os_index_insert (ap_os, p_name, p_obj);
+        }
     }
 
   /*   print_types (ap_os); */
@@ -520,6 +600,15 @@ tiz_os_init (tiz_os_t ** app_os, const OMX_HANDLETYPE ap_hdl,
       return OMX_ErrorInsufficientResources;
     }
 
+  if (NULL == (p_os->p_index = (tiz_os_slot_t *) tiz_mem_calloc (
+                 TIZ_OS_INDEX_SIZE, sizeof (tiz_os_slot_t))))
+    {
+      tiz_map_destroy (p_os->p_map);
+      os_free (ap_soa, p_os);
+      p_os = NULL;
+      return OMX_ErrorInsufficientResources;
+    }
+
   p_os->p_hdl = ap_hdl;
   p_os->p_soa = ap_soa;
 
@@ -538,6 +627,7 @@ tiz_os_destroy (tiz_os_t * ap_os)
           tiz_map_erase_at (ap_os->p_map, 0);
         };
       tiz_map_destroy (ap_os->p_map);
+      tiz_mem_free (ap_os->p_index);
       os_free (ap_os->p_soa, ap_os);
     }
 }
@@ -590,6 +680,10 @@ tiz_os_get_type (const tiz_os_t * ap_os, const char * a_type_name)
   assert (ap_os);
   assert (ap_os->p_map);
   assert (a_type_name);
+  if ((res = os_index_find (ap_os, a_type_name)))
+    {
+      return res;
+    }
   res = tiz_map_find (ap_os->p_map, (OMX_PTR) a_type_name);
   TIZ_TRACE (ap_os->p_hdl, "Get type [%s]->[%p] - total types [%d]",
              a_type_name, res, tiz_map_size (ap_os->p_map));
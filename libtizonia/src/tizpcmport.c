@@ -48,6 +48,7 @@ pcmport_SetParameter_common (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                              OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
 {
   tiz_pcmport_t * p_obj = (tiz_pcmport_t *) ap_obj;
+  tiz_port_t * p_base = (tiz_port_t *) ap_obj;
 
   assert (ap_obj);
 
@@ -92,6 +93,7 @@ pcmport_SetParameter_common (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
             {
               case 8:
               case 16:
+              case 24:
               case 32:
                 {
                   break;
@@ -108,6 +110,22 @@ pcmport_SetParameter_common (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
                 }
             };
 
+          /* An output port's buffers must keep holding the same number of
+             frames when the sample size changes, as the decoders convert
+             their output to it */
+          if (OMX_DirOutput == p_base->portdef_.eDir
+              && p_pcmmode->nBitPerSample != p_obj->pcmmode_.nBitPerSample
+              && p_obj->pcmmode_.nBitPerSample >= 8)
+            {
+              const OMX_U32 nsamples = p_base->portdef_.nBufferSize
+                                       / (p_obj->pcmmode_.nBitPerSample / 8);
+              p_base->portdef_.nBufferSize
+                = MAX (nsamples * (p_pcmmode->nBitPerSample / 8),
+                       p_base->opts_.min_buf_size);
+              TIZ_TRACE (ap_hdl, "PORT [%d] nBufferSize [%d]",
+                         tiz_port_dir (p_obj), p_base->portdef_.nBufferSize);
+            }
+
           /* Apply the new default values */
           p_obj->pcmmode_.nChannels = p_pcmmode->nChannels;
           p_obj->pcmmode_.eNumData = p_pcmmode->eNumData;
@@ -261,26 +279,32 @@ pcmport_SetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
       case OMX_IndexParamAudioPcm:
         {
           const tiz_port_t * p_base = ap_obj;
+          const OMX_AUDIO_PARAM_PCMMODETYPE * p_pcmmode = ap_struct;
 
-          /* Do now allow changes to sampling rate, num of channels or bits per
-         * sample if this is a slave output port */
+          /* Do now allow changes to sampling rate or num of channels if this
+           * is a slave output port. The sample format (bits per sample,
+           * endianness) may still be selected by the client, as the decoders
+           * convert their output to it */
 
           if ((OMX_DirOutput == p_base->portdef_.eDir)
               && (p_base->opts_.mos_port != (OMX_U32) -1)
-              && (p_base->opts_.mos_port != p_base->portdef_.nPortIndex))
+              && (p_base->opts_.mos_port != p_base->portdef_.nPortIndex)
+              && (p_pcmmode->nSamplingRate != p_obj->pcmmode_.nSamplingRate
+                  || p_pcmmode->nChannels != p_obj->pcmmode_.nChannels))
             {
               TIZ_ERROR (
                 ap_hdl,
                 "[OMX_ErrorBadParameter] : PORT [%d] "
                 "SetParameter [OMX_IndexParamAudioPcm]... "
                 "Slave port, cannot allow external updates of port properties "
-                "like sample rate, bits per sample or number of channels",
+                "like sample rate or number of channels",
                 tiz_port_dir (p_obj));
               rc = OMX_ErrorBadParameter;
             }
           else
             {
-              pcmport_SetParameter_common (ap_obj, ap_hdl, a_index, ap_struct);
+              rc = pcmport_SetParameter_common (ap_obj, ap_hdl, a_index,
+                                                ap_struct);
             }
         }
         break;
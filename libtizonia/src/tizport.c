@@ -33,6 +33,9 @@
 #include <assert.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include <OMX_Types.h>
 #include <OMX_TizoniaExt.h>
@@ -53,6 +56,10 @@
 
 #define TIZ_HDR_NOT_FOUND -1
 
+/* Alignment of the buffers allocated by the default hooks */
+#define TIZ_PORT_BUF_CACHE_LINE 64
+#define TIZ_PORT_BUF_HUGE_PAGE (2 * 1024 * 1024)
+
 #define TIZ_LOG_PORT_DEFINITION(hdl, pd)                                      \
   do                                                                          \
     {                                                                         \
@@ -135,6 +142,15 @@ struct tiz_port_buf_props
                                    with OMX_UseEGLBuffer */
 };
 
+typedef struct tiz_port_pooled_buf tiz_port_pooled_buf_t;
+
+struct tiz_port_pooled_buf
+{
+  OMX_U8 * p_buf;
+  OMX_U32 size;
+  bool in_use;
+};
+
 typedef struct tiz_port_mark_info tiz_port_mark_info_t;
 
 struct tiz_port_mark_info
@@ -164,21 +180,161 @@ get_mark_info (const tiz_port_t * ap_obj, OMX_U32 a_mark_idx)
   return *pp_mi;
 }
 
+/* Buffers are not zeroed; they are aligned to a cache line, or to a page if
+   they are at least one page long. Very large (e.g. video) buffers are
+   aligned to, and backed by, huge pages where the system supports it. */
+/*@null@*/ /*@only@*/ /*@out@*/
+static OMX_U8 *
+alloc_aligned_buffer (const size_t a_size)
+{
+  void * p = NULL;
+  size_t align = TIZ_PORT_BUF_CACHE_LINE;
+  const long page_size = sysconf (_SC_PAGESIZE);
+
+  if (a_size >= TIZ_PORT_BUF_HUGE_PAGE)
+    {
+      align = TIZ_PORT_BUF_HUGE_PAGE;
+    }
+  else if (page_size > 0 && a_size >= (size_t) page_size)
+    {
+      align = (size_t) page_size;
+    }
+
+  if (0 != posix_memalign (&p, align, a_size))
+    {
+      return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+  if (TIZ_PORT_BUF_HUGE_PAGE == align)
+    {
+      (void) madvise (p, a_size & ~((size_t) TIZ_PORT_BUF_HUGE_PAGE - 1),
+                      MADV_HUGEPAGE);
+    }
+#endif
+
+  return p;
+}
+
+static inline tiz_port_pooled_buf_t *
+get_pooled_buffer (const tiz_port_t * ap_obj, const OMX_S32 a_pos)
+{
+  tiz_port_pooled_buf_t * p_pb = NULL;
+  assert (ap_obj);
+  p_pb = tiz_vector_at (ap_obj->p_buf_pool_, a_pos);
+  assert (p_pb);
+  return p_pb;
+}
+
+/* Release the pooled buffers that are not in use, except those of the given
+   size (0 releases all of them) */
+static void
+purge_buffer_pool (tiz_port_t * ap_obj, const OMX_U32 a_keep_size)
+{
+  OMX_S32 i = 0;
+  assert (ap_obj);
+  while (i < tiz_vector_length (ap_obj->p_buf_pool_))
+    {
+      tiz_port_pooled_buf_t * p_pb = get_pooled_buffer (ap_obj, i);
+      if (!p_pb->in_use && p_pb->size != a_keep_size)
+        {
+          free (p_pb->p_buf);
+          tiz_vector_erase (ap_obj->p_buf_pool_, i, 1);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+/* The default hooks receive the port as their argument. Freed buffers are
+   kept in the port's pool, so that a port that is depopulated and then
+   populated again with buffers of the same size (e.g. on Loaded->Idle after
+   Idle->Loaded, or on port re-enablement) does not go back to the system
+   allocator. */
 /*@null@*/ /*@only@*/ /*@out@*/
 static OMX_U8 *
 default_alloc_hook (OMX_U32 * ap_size, OMX_PTR * app_port_priv, void * ap_args)
 {
-  OMX_U8 * p = NULL;
+  tiz_port_t * p_obj = ap_args;
+  tiz_port_pooled_buf_t pb;
+  OMX_S32 i = 0;
+
   assert (ap_size && *ap_size > 0);
-  p = tiz_mem_calloc ((size_t) *ap_size, sizeof (OMX_U8));
-  return p;
+
+  if (!p_obj)
+    {
+      return alloc_aligned_buffer ((size_t) *ap_size);
+    }
+
+  /* Buffers of a different size are of no use any more */
+  purge_buffer_pool (p_obj, *ap_size);
+
+  for (i = 0; i < tiz_vector_length (p_obj->p_buf_pool_); ++i)
+    {
+      tiz_port_pooled_buf_t * p_pb = get_pooled_buffer (p_obj, i);
+      if (!p_pb->in_use)
+        {
+          p_pb->in_use = true;
+          return p_pb->p_buf;
+        }
+    }
+
+  pb.size = *ap_size;
+  pb.in_use = true;
+  if (!(pb.p_buf = alloc_aligned_buffer ((size_t) *ap_size)))
+    {
+      return NULL;
+    }
+  if (OMX_ErrorNone != tiz_vector_push_back (p_obj->p_buf_pool_, &pb))
+    {
+      free (pb.p_buf);
+      return NULL;
+    }
+  return pb.p_buf;
 }
 
 static void
 default_free_hook (OMX_PTR ap_buf, OMX_PTR ap_port_priv, void * ap_args)
 {
+  tiz_port_t * p_obj = ap_args;
+  OMX_S32 i = 0;
+  OMX_S32 idle = 0;
+  OMX_S32 pos = -1;
+
   assert (ap_buf);
-  tiz_mem_free (ap_buf);
+
+  if (p_obj)
+    {
+      for (i = 0; i < tiz_vector_length (p_obj->p_buf_pool_); ++i)
+        {
+          tiz_port_pooled_buf_t * p_pb = get_pooled_buffer (p_obj, i);
+          if (p_pb->p_buf == ap_buf)
+            {
+              pos = i;
+            }
+          else if (!p_pb->in_use)
+            {
+              ++idle;
+            }
+        }
+    }
+
+  if (pos < 0)
+    {
+      /* Not one of ours */
+      free (ap_buf);
+    }
+  else if (idle < (OMX_S32) p_obj->portdef_.nBufferCountActual)
+    {
+      get_pooled_buffer (p_obj, pos)->in_use = false;
+    }
+  else
+    {
+      free (ap_buf);
+      tiz_vector_erase (p_obj->p_buf_pool_, pos, 1);
+    }
 }
 
 static OMX_ERRORTYPE
@@ -236,7 +392,7 @@ register_header (const void * ap_obj, OMX_BUFFERHEADERTYPE * ap_hdr,
 {
   tiz_port_t * p_obj = (tiz_port_t *) ap_obj;
   tiz_port_buf_props_t * p_bps
-    = tiz_mem_calloc (1, sizeof (tiz_port_buf_props_t));
+    = tiz_slab_calloc (sizeof (tiz_port_buf_props_t));
 
   if (NULL == p_bps)
     {
@@ -250,7 +406,7 @@ register_header (const void * ap_obj, OMX_BUFFERHEADERTYPE * ap_hdr,
 
   if (OMX_ErrorNone != tiz_vector_push_back (p_obj->p_hdrs_info_, &p_bps))
     {
-      tiz_mem_free (p_bps);
+      tiz_slab_free (p_bps);
       return OMX_ErrorInsufficientResources;
     }
 
@@ -295,7 +451,7 @@ unregister_header (const void * ap_obj, OMX_S32 hdr_pos)
   if (p_bps)
     {
       p_hdr = p_bps->p_hdr;
-      tiz_mem_free (p_bps);
+      tiz_slab_free (p_bps);
       tiz_vector_erase (p_obj->p_hdrs_info_, hdr_pos, 1);
     }
   return p_hdr;
@@ -336,6 +492,10 @@ port_ctor (void * ap_obj, va_list * app)
   tiz_check_omx_ret_null (
     tiz_vector_init (&(p_obj->p_marks_), sizeof (tiz_port_mark_info_t *)));
 
+  /* Init the pool of buffers used by the default allocation hooks */
+  tiz_check_omx_ret_null (
+    tiz_vector_init (&(p_obj->p_buf_pool_), sizeof (tiz_port_pooled_buf_t)));
+
   /* Initialize the port options structure */
   if ((p_opts = va_arg (*app, tiz_port_options_t *)))
     {
@@ -349,7 +509,7 @@ port_ctor (void * ap_obj, va_list * app)
       /* Use default hooks */
       p_obj->opts_.mem_hooks.pf_alloc = default_alloc_hook;
       p_obj->opts_.mem_hooks.pf_free = default_free_hook;
-      p_obj->opts_.mem_hooks.p_args = NULL;
+      p_obj->opts_.mem_hooks.p_args = p_obj;
     }
 
   /* Init the OMX_PARAM_PORTDEFINITIONTYPE structure */
@@ -434,6 +594,10 @@ port_dtor (void * ap_obj)
   tiz_vector_clear (p_obj->p_marks_);
   tiz_vector_destroy (p_obj->p_marks_);
 
+  purge_buffer_pool (p_obj, 0);
+  tiz_vector_clear (p_obj->p_buf_pool_);
+  tiz_vector_destroy (p_obj->p_buf_pool_);
+
   return super_dtor (typeOf (ap_obj, "tizport"), ap_obj);
 }
 
@@ -866,7 +1030,7 @@ port_UseBuffer (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   assert (a_pid == p_obj->portdef_.nPortIndex);
 
   /* Allocate the buffer header... */
-  p_hdr = tiz_mem_calloc (1, sizeof (OMX_BUFFERHEADERTYPE));
+  p_hdr = tiz_slab_calloc (sizeof (OMX_BUFFERHEADERTYPE));
   if (!p_hdr)
     {
       TIZ_ERROR (ap_hdl,
@@ -908,7 +1072,7 @@ port_UseBuffer (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   /* register this buffer header... */
   if (OMX_ErrorNone != register_header (p_obj, p_hdr, OMX_FALSE, NULL))
     {
-      tiz_mem_free (p_hdr);
+      tiz_slab_free (p_hdr);
       TIZ_ERROR (ap_hdl,
                  "[OMX_ErrorInsufficientResources] : "
                  "While registering the OMX header on PORT [%d]",
@@ -982,7 +1146,7 @@ port_UseEGLImage (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
     }
 
   /* Allocate the buffer header... */
-  p_hdr = tiz_mem_calloc (1, sizeof (OMX_BUFFERHEADERTYPE));
+  p_hdr = tiz_slab_calloc (sizeof (OMX_BUFFERHEADERTYPE));
   if (!p_hdr)
     {
       TIZ_ERROR (ap_hdl,
@@ -1029,7 +1193,7 @@ port_UseEGLImage (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   /* register this buffer header... */
   if (OMX_ErrorNone != register_header (p_obj, p_hdr, OMX_FALSE, ap_eglimage))
     {
-      tiz_mem_free (p_hdr);
+      tiz_slab_free (p_hdr);
       TIZ_ERROR (ap_hdl,
                  "[OMX_ErrorInsufficientResources] : "
                  "While registering the OMX headeron PORT [%d]",
@@ -1083,7 +1247,7 @@ port_AllocateBuffer (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   assert (a_pid == p_obj->portdef_.nPortIndex);
 
   /* Allocate the buffer header... */
-  if (NULL == (p_hdr = tiz_mem_calloc (1, sizeof (OMX_BUFFERHEADERTYPE))))
+  if (NULL == (p_hdr = tiz_slab_calloc (sizeof (OMX_BUFFERHEADERTYPE))))
     {
       TIZ_ERROR (ap_hdl,
                  "[OMX_ErrorInsufficientResources] : "
@@ -1096,7 +1260,7 @@ port_AllocateBuffer (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   if (OMX_ErrorNone
       != (rc = alloc_buffer (p_obj, &buf_size, &p_buf, &p_port_priv)))
     {
-      tiz_mem_free (p_hdr);
+      tiz_slab_free (p_hdr);
       p_hdr = NULL;
       return rc;
     }
@@ -1137,7 +1301,7 @@ port_AllocateBuffer (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   if (OMX_ErrorNone != register_header (p_obj, p_hdr, OMX_TRUE, NULL))
     {
       free_buffer (p_obj, p_buf, p_port_priv);
-      tiz_mem_free (p_hdr);
+      tiz_slab_free (p_hdr);
       return OMX_ErrorInsufficientResources;
     }
 
@@ -1192,7 +1356,7 @@ port_FreeBuffer (const void * ap_obj, OMX_HANDLETYPE ap_hdl, OMX_U32 a_pid,
 
   p_unreg_hdr = unregister_header (p_obj, hdr_pos);
   assert (p_unreg_hdr == ap_hdr);
-  tiz_mem_free (ap_hdr);
+  tiz_slab_free (ap_hdr);
   p_unreg_hdr = NULL;
 
   hdr_count = tiz_vector_length (p_obj->p_hdrs_info_);
@@ -1272,7 +1436,7 @@ port_index (const void * ap_obj)
 OMX_U32
 tiz_port_index (const void * ap_obj)
 {
-  const tiz_port_class_t * class = classOf (ap_obj);
+  const tiz_port_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->index);
   return class->index (ap_obj);
 }
@@ -1329,7 +1493,7 @@ port_buffer_count (const void * ap_obj)
 OMX_S32
 tiz_port_buffer_count (const void * ap_obj)
 {
-  const tiz_port_class_t * class = classOf (ap_obj);
+  const tiz_port_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->buffer_count);
   return class->buffer_count (ap_obj);
 }
@@ -1344,7 +1508,7 @@ port_dir (const void * ap_obj)
 OMX_DIRTYPE
 tiz_port_dir (const void * ap_obj)
 {
-  const tiz_port_class_t * class = classOf (ap_obj);
+  const tiz_port_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->dir);
   return class->dir (ap_obj);
 }
@@ -1359,7 +1523,7 @@ port_domain (const void * ap_obj)
 OMX_PORTDOMAINTYPE
 tiz_port_domain (const void * ap_obj)
 {
-  const tiz_port_class_t * class = classOf (ap_obj);
+  const tiz_port_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->domain);
   return class->domain (ap_obj);
 }
@@ -1891,7 +2055,7 @@ port_update_claimed_count (void * ap_obj, OMX_S32 a_offset)
 OMX_S32
 tiz_port_update_claimed_count (void * ap_obj, OMX_S32 a_offset)
 {
-  tiz_port_class_t * class = (tiz_port_class_t *) classOf (ap_obj);
+  tiz_port_class_t * class = (tiz_port_class_t *) TIZ_CLASS_OF (ap_obj);
   assert (class->update_claimed_count);
   return class->update_claimed_count (ap_obj, a_offset);
 }
@@ -48,6 +48,8 @@ struct tiz_port
   tiz_vector_t * p_hdrs_info_;
   tiz_vector_t * p_hdrs_;
   tiz_vector_t * p_marks_;
+  tiz_vector_t * p_buf_pool_; /* Buffers allocated by the default allocation
+                                 hooks, in use or retained for reuse */
   OMX_U32 pid_;
   OMX_U32 tpid_;
   OMX_S32 claimed_count_;
@@ -299,8 +299,10 @@ dispatch_br (void * ap_obj, OMX_PTR ap_msg)
       && ESubStatePauseToIdle != now && !TIZ_PORT_IS_DISABLED (p_port)
       && !TIZ_PORT_IS_BEING_DISABLED (p_port))
     {
+      const OMX_U64 start = tiz_time_now_us ();
       TIZ_TRACE (p_msg->p_hdl, "p_msg_br->p_buffer [%p] ", p_msg_br->p_buffer);
       rc = tiz_prc_buffers_ready (p_obj);
+      tiz_comp_perf_buffers_ready (p_msg->p_hdl, tiz_time_now_us () - start);
     }
 
   return rc;
@@ -717,7 +719,7 @@ prc_buffers_ready (const void * ap_obj)
 OMX_ERRORTYPE
 tiz_prc_buffers_ready (const void * ap_obj)
 {
-  const tiz_prc_class_t * class = classOf (ap_obj);
+  const tiz_prc_class_t * class = TIZ_CLASS_OF (ap_obj);
   assert (class->buffers_ready);
   return class->buffers_ready (ap_obj);
 }
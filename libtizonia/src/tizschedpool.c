@@ -0,0 +1,559 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizschedpool.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia OpenMAX IL - Scheduler worker pool
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <tizplatform.h>
+
+#include "tizschedpool.h"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.tizonia.schedpool"
+#endif
+
+#define SCHED_POOL_MAX_THREADS 64
+
+/* Actor states. An actor is linked into a worker's run list if and only if it
+   is in the 'queued' state. */
+enum
+{
+  ETIZSchedActorIdle = 0,
+  ETIZSchedActorQueued,
+  ETIZSchedActorRunning,
+  ETIZSchedActorTerminated
+};
+
+typedef struct tiz_sched_pool tiz_sched_pool_t;
+
+typedef struct tiz_sched_worker tiz_sched_worker_t;
+struct tiz_sched_worker
+{
+  tiz_sched_pool_t * p_pool;
+  tiz_thread_t thread;
+  OMX_U32 index;
+  tiz_mutex_t mutex; /* Guards the run list */
+  tiz_sched_actor_t * p_head;
+  tiz_sched_actor_t * p_tail;
+};
+
+struct tiz_sched_pool
+{
+  tiz_sched_worker_t * p_workers;
+  OMX_U32 nworkers;
+  OMX_U32 next; /* Round-robin placement for non-worker threads */
+  OMX_S32 nqueued;
+  OMX_S32 nsleeping;
+  bool stopping; /* Only set if the pool could not be started */
+  tiz_mutex_t mutex; /* Used to park idle workers */
+  tiz_cond_t cond;
+  OMX_S32 nwaiters;
+  tiz_mutex_t wait_mutex; /* Used by threads waiting on an actor */
+  tiz_cond_t wait_cond;
+};
+
+static pthread_once_t g_sched_pool_once = PTHREAD_ONCE_INIT;
+static tiz_sched_pool_t * gp_sched_pool = NULL;
+static OMX_U32 g_sched_pool_nthreads = 0;
+static __thread tiz_sched_worker_t * tp_worker = NULL;
+static __thread tiz_sched_actor_t * tp_current = NULL;
+
+static void
+link_actor (tiz_sched_worker_t * ap_w, tiz_sched_actor_t * ap_actor)
+{
+  ap_actor->p_next = NULL;
+  ap_actor->p_prev = ap_w->p_tail;
+  if (ap_w->p_tail)
+    {
+      ap_w->p_tail->p_next = ap_actor;
+    }
+  else
+    {
+      ap_w->p_head = ap_actor;
+    }
+  ap_w->p_tail = ap_actor;
+  __atomic_store_n (&(ap_actor->p_worker), ap_w, __ATOMIC_SEQ_CST);
+}
+
+static void
+unlink_actor (tiz_sched_worker_t * ap_w, tiz_sched_actor_t * ap_actor)
+{
+  if (ap_actor->p_prev)
+    {
+      ap_actor->p_prev->p_next = ap_actor->p_next;
+    }
+  else
+    {
+      ap_w->p_head = ap_actor->p_next;
+    }
+  if (ap_actor->p_next)
+    {
+      ap_actor->p_next->p_prev = ap_actor->p_prev;
+    }
+  else
+    {
+      ap_w->p_tail = ap_actor->p_prev;
+    }
+  ap_actor->p_next = ap_actor->p_prev = NULL;
+  __atomic_store_n (&(ap_actor->p_worker), NULL, __ATOMIC_RELAXED);
+  __atomic_store_n (&(ap_actor->state), ETIZSchedActorRunning,
+                    __ATOMIC_SEQ_CST);
+  __atomic_sub_fetch (&(ap_w->p_pool->nqueued), 1, __ATOMIC_SEQ_CST);
+}
+
+/* Pops the actor at the head of a worker's run list */
+static tiz_sched_actor_t *
+pop_actor (tiz_sched_worker_t * ap_w)
+{
+  tiz_sched_actor_t * p_actor = NULL;
+  (void) tiz_mutex_lock (&(ap_w->mutex));
+  if ((p_actor = ap_w->p_head))
+    {
+      assert (ETIZSchedActorQueued
+              == __atomic_load_n (&(p_actor->state), __ATOMIC_RELAXED));
+      unlink_actor (ap_w, p_actor);
+    }
+  (void) tiz_mutex_unlock (&(ap_w->mutex));
+  return p_actor;
+}
+
+static tiz_sched_actor_t *
+find_work (tiz_sched_worker_t * ap_w)
+{
+  tiz_sched_pool_t * p_pool = ap_w->p_pool;
+  tiz_sched_actor_t * p_actor = NULL;
+  OMX_U32 i = 0;
+
+  if (!(p_actor = pop_actor (ap_w)))
+    {
+      /* Steal from the other workers */
+      for (i = 1; !p_actor && i < p_pool->nworkers; ++i)
+        {
+          p_actor
+            = pop_actor (&(p_pool->p_workers[(ap_w->index + i)
+                                             % p_pool->nworkers]));
+        }
+    }
+  return p_actor;
+}
+
+/* Wakes up the threads blocked in wait_until. Must be called after any change
+   that may make a waiter's condition true. */
+static void
+notify_waiters (tiz_sched_pool_t * ap_pool)
+{
+  assert (ap_pool);
+  if (__atomic_load_n (&(ap_pool->nwaiters), __ATOMIC_SEQ_CST) > 0)
+    {
+      (void) tiz_mutex_lock (&(ap_pool->wait_mutex));
+      (void) tiz_cond_broadcast (&(ap_pool->wait_cond));
+      (void) tiz_mutex_unlock (&(ap_pool->wait_mutex));
+    }
+}
+
+static bool
+is_claimable (tiz_sched_actor_t * ap_actor)
+{
+  return (ETIZSchedActorQueued
+            == __atomic_load_n (&(ap_actor->state), __ATOMIC_SEQ_CST)
+          && NULL != __atomic_load_n (&(ap_actor->p_worker), __ATOMIC_SEQ_CST));
+}
+
+static bool
+is_linked_or_not_queued (tiz_sched_actor_t * ap_actor)
+{
+  return (ETIZSchedActorQueued
+            != __atomic_load_n (&(ap_actor->state), __ATOMIC_SEQ_CST)
+          || NULL != __atomic_load_n (&(ap_actor->p_worker), __ATOMIC_SEQ_CST));
+}
+
+static bool
+is_terminated (tiz_sched_actor_t * ap_actor)
+{
+  return (ETIZSchedActorTerminated
+          == __atomic_load_n (&(ap_actor->state), __ATOMIC_SEQ_CST));
+}
+
+/* Blocks until a_pf_actor_cond (on the actor) or a_pf_done (on ap_arg) is
+   true */
+static void
+wait_until (tiz_sched_actor_t * ap_actor,
+            bool (*a_pf_actor_cond) (tiz_sched_actor_t *),
+            tiz_sched_pool_done_f a_pf_done, void * ap_arg)
+{
+  tiz_sched_pool_t * p_pool = gp_sched_pool;
+  assert (p_pool);
+  (void) tiz_mutex_lock (&(p_pool->wait_mutex));
+  __atomic_add_fetch (&(p_pool->nwaiters), 1, __ATOMIC_SEQ_CST);
+  while (!a_pf_actor_cond (ap_actor) && !(a_pf_done && a_pf_done (ap_arg)))
+    {
+      (void) tiz_cond_wait (&(p_pool->wait_cond), &(p_pool->wait_mutex));
+    }
+  __atomic_sub_fetch (&(p_pool->nwaiters), 1, __ATOMIC_SEQ_CST);
+  (void) tiz_mutex_unlock (&(p_pool->wait_mutex));
+}
+
+static void
+run_actor (tiz_sched_actor_t * ap_actor)
+{
+  tiz_sched_actor_t * p_prev = tp_current;
+  bool terminated = false;
+
+  assert (ETIZSchedActorRunning
+          == __atomic_load_n (&(ap_actor->state), __ATOMIC_RELAXED));
+
+  tp_current = ap_actor;
+  terminated = ap_actor->pf_run (ap_actor);
+  tp_current = p_prev;
+
+  if (terminated)
+    {
+      /* Last access to the actor; it may be deleted right after this */
+      __atomic_store_n (&(ap_actor->state), ETIZSchedActorTerminated,
+                        __ATOMIC_SEQ_CST);
+      notify_waiters (gp_sched_pool);
+      return;
+    }
+
+  __atomic_store_n (&(ap_actor->state), ETIZSchedActorIdle, __ATOMIC_SEQ_CST);
+  if (ap_actor->pf_pending (ap_actor))
+    {
+      tiz_sched_pool_schedule (ap_actor);
+    }
+  else
+    {
+      /* The actor's queues may have room again */
+      notify_waiters (gp_sched_pool);
+    }
+}
+
+static void *
+worker_thread_func (void * p_arg)
+{
+  tiz_sched_worker_t * p_w = (tiz_sched_worker_t *) p_arg;
+  tiz_sched_pool_t * p_pool = NULL;
+  tiz_sched_actor_t * p_actor = NULL;
+  char name[16];
+
+  assert (p_w);
+  p_pool = p_w->p_pool;
+  tp_worker = p_w;
+
+  (void) snprintf (name, sizeof (name), "schedpool%u", (unsigned) p_w->index);
+  (void) tiz_thread_setname (&(p_w->thread), name);
+
+  for (;;)
+    {
+      if ((p_actor = find_work (p_w)))
+        {
+          run_actor (p_actor);
+          continue;
+        }
+
+      /* Nothing to do: park */
+      (void) tiz_mutex_lock (&(p_pool->mutex));
+      __atomic_add_fetch (&(p_pool->nsleeping), 1, __ATOMIC_SEQ_CST);
+      while (0 == __atomic_load_n (&(p_pool->nqueued), __ATOMIC_SEQ_CST)
+             && !p_pool->stopping)
+        {
+          (void) tiz_cond_wait (&(p_pool->cond), &(p_pool->mutex));
+        }
+      __atomic_sub_fetch (&(p_pool->nsleeping), 1, __ATOMIC_SEQ_CST);
+      if (p_pool->stopping)
+        {
+          (void) tiz_mutex_unlock (&(p_pool->mutex));
+          break;
+        }
+      (void) tiz_mutex_unlock (&(p_pool->mutex));
+    }
+
+  return NULL;
+}
+
+/* Stops and joins the first a_nstarted workers, and deletes the pool. The
+   pool is zero-initialised, and destroying a mutex or condition variable that
+   was never initialised is a no-op. */
+static void
+destroy_sched_pool (tiz_sched_pool_t * ap_pool, const OMX_U32 a_nstarted)
+{
+  OMX_PTR p_result = NULL;
+  OMX_U32 i = 0;
+
+  assert (ap_pool);
+
+  if (a_nstarted > 0)
+    {
+      (void) tiz_mutex_lock (&(ap_pool->mutex));
+      ap_pool->stopping = true;
+      (void) tiz_cond_broadcast (&(ap_pool->cond));
+      (void) tiz_mutex_unlock (&(ap_pool->mutex));
+      for (i = 0; i < a_nstarted; ++i)
+        {
+          (void) tiz_thread_join (&(ap_pool->p_workers[i].thread), &p_result);
+        }
+    }
+
+  for (i = 0; i < ap_pool->nworkers; ++i)
+    {
+      (void) tiz_mutex_destroy (&(ap_pool->p_workers[i].mutex));
+    }
+
+  (void) tiz_cond_destroy (&(ap_pool->wait_cond));
+  (void) tiz_mutex_destroy (&(ap_pool->wait_mutex));
+  (void) tiz_cond_destroy (&(ap_pool->cond));
+  (void) tiz_mutex_destroy (&(ap_pool->mutex));
+  tiz_mem_free (ap_pool->p_workers);
+  tiz_mem_free (ap_pool);
+}
+
+static void
+init_sched_pool_once (void)
+{
+  tiz_sched_pool_t * p_pool = NULL;
+  OMX_U32 nworkers = g_sched_pool_nthreads;
+  OMX_U32 i = 0;
+
+  if (0 == nworkers)
+    {
+      long ncores = sysconf (_SC_NPROCESSORS_ONLN);
+      nworkers = ncores > 0 ? (OMX_U32) ncores : 1;
+    }
+  nworkers = MIN (nworkers, SCHED_POOL_MAX_THREADS);
+
+  p_pool = (tiz_sched_pool_t *) tiz_mem_calloc (1, sizeof (tiz_sched_pool_t));
+  tiz_check_true_ret_void (p_pool);
+  p_pool->p_workers = (tiz_sched_worker_t *) tiz_mem_calloc (
+    nworkers, sizeof (tiz_sched_worker_t));
+  if (!p_pool->p_workers)
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "[OMX_ErrorInsufficientResources]");
+      tiz_mem_free (p_pool);
+      return;
+    }
+
+  if (OMX_ErrorNone != tiz_mutex_init (&(p_pool->mutex))
+      || OMX_ErrorNone != tiz_cond_init (&(p_pool->cond))
+      || OMX_ErrorNone != tiz_mutex_init (&(p_pool->wait_mutex))
+      || OMX_ErrorNone != tiz_cond_init (&(p_pool->wait_cond)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "[OMX_ErrorInsufficientResources]");
+      destroy_sched_pool (p_pool, 0);
+      return;
+    }
+
+  p_pool->nworkers = nworkers;
+  for (i = 0; i < nworkers; ++i)
+    {
+      tiz_sched_worker_t * p_w = &(p_pool->p_workers[i]);
+      p_w->p_pool = p_pool;
+      p_w->index = i;
+      if (OMX_ErrorNone != tiz_mutex_init (&(p_w->mutex)))
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR, "[OMX_ErrorInsufficientResources]");
+          destroy_sched_pool (p_pool, 0);
+          return;
+        }
+    }
+
+  /* Nothing can be scheduled until the pool is published below, so the
+     workers only see each other's (empty) run lists until then */
+  for (i = 0; i < nworkers; ++i)
+    {
+      tiz_sched_worker_t * p_w = &(p_pool->p_workers[i]);
+      if (OMX_ErrorNone
+          != tiz_thread_create (&(p_w->thread), 0, 0, worker_thread_func, p_w))
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR, "Could not create pool worker [%u]", i);
+          destroy_sched_pool (p_pool, i);
+          return;
+        }
+    }
+
+  gp_sched_pool = p_pool;
+
+  TIZ_LOG (TIZ_PRIORITY_NOTICE, "Scheduler pool started with [%u] workers",
+           nworkers);
+}
+
+OMX_ERRORTYPE
+tiz_sched_pool_init (OMX_U32 a_nthreads)
+{
+  g_sched_pool_nthreads = a_nthreads;
+  (void) pthread_once (&g_sched_pool_once, init_sched_pool_once);
+  return gp_sched_pool ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+}
+
+void
+tiz_sched_pool_actor_init (tiz_sched_actor_t * ap_actor,
+                           tiz_sched_actor_run_f a_pf_run,
+                           tiz_sched_actor_pending_f a_pf_pending,
+                           void * ap_data)
+{
+  assert (ap_actor);
+  assert (a_pf_run);
+  assert (a_pf_pending);
+  ap_actor->pf_run = a_pf_run;
+  ap_actor->pf_pending = a_pf_pending;
+  ap_actor->p_data = ap_data;
+  ap_actor->state = ETIZSchedActorIdle;
+  ap_actor->p_worker = NULL;
+  ap_actor->p_next = NULL;
+  ap_actor->p_prev = NULL;
+}
+
+void
+tiz_sched_pool_schedule (tiz_sched_actor_t * ap_actor)
+{
+  tiz_sched_pool_t * p_pool = gp_sched_pool;
+  tiz_sched_worker_t * p_w = NULL;
+  OMX_S32 expected = ETIZSchedActorIdle;
+
+  assert (ap_actor);
+  assert (p_pool);
+
+  if (!__atomic_compare_exchange_n (&(ap_actor->state), &expected,
+                                    ETIZSchedActorQueued, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+      /* Already queued or running; the worker will notice the new work when
+         it releases the actor. */
+      return;
+    }
+
+  /* Prefer the current worker's list, for cache locality */
+  p_w = tp_worker;
+  if (!p_w)
+    {
+      const OMX_U32 next
+        = __atomic_fetch_add (&(p_pool->next), 1, __ATOMIC_RELAXED);
+      p_w = &(p_pool->p_workers[next % p_pool->nworkers]);
+    }
+
+  (void) tiz_mutex_lock (&(p_w->mutex));
+  link_actor (p_w, ap_actor);
+  __atomic_add_fetch (&(p_pool->nqueued), 1, __ATOMIC_SEQ_CST);
+  (void) tiz_mutex_unlock (&(p_w->mutex));
+
+  /* The actor can now be claimed */
+  notify_waiters (p_pool);
+
+  if (__atomic_load_n (&(p_pool->nsleeping), __ATOMIC_SEQ_CST) > 0)
+    {
+      (void) tiz_mutex_lock (&(p_pool->mutex));
+      (void) tiz_cond_signal (&(p_pool->cond));
+      (void) tiz_mutex_unlock (&(p_pool->mutex));
+    }
+}
+
+bool
+tiz_sched_pool_claim (tiz_sched_actor_t * ap_actor)
+{
+  assert (ap_actor);
+
+  for (;;)
+    {
+      tiz_sched_worker_t * p_w = NULL;
+      bool claimed = false;
+
+      if (ETIZSchedActorQueued
+          != __atomic_load_n (&(ap_actor->state), __ATOMIC_SEQ_CST))
+        {
+          return false;
+        }
+
+      if (!(p_w = __atomic_load_n (&(ap_actor->p_worker), __ATOMIC_SEQ_CST)))
+        {
+          /* The actor is being linked into a run list */
+          wait_until (ap_actor, is_linked_or_not_queued, NULL, NULL);
+          continue;
+        }
+
+      (void) tiz_mutex_lock (&(p_w->mutex));
+      if (p_w == ap_actor->p_worker)
+        {
+          unlink_actor (p_w, ap_actor);
+          claimed = true;
+        }
+      (void) tiz_mutex_unlock (&(p_w->mutex));
+
+      if (claimed)
+        {
+          return true;
+        }
+    }
+}
+
+void
+tiz_sched_pool_run_claimed (tiz_sched_actor_t * ap_actor)
+{
+  run_actor (ap_actor);
+}
+
+void
+tiz_sched_pool_wait (tiz_sched_actor_t * ap_actor,
+                     tiz_sched_pool_done_f a_pf_done, void * ap_arg)
+{
+  assert (ap_actor);
+  assert (a_pf_done);
+  wait_until (ap_actor, is_claimable, a_pf_done, ap_arg);
+}
+
+void
+tiz_sched_pool_notify (void)
+{
+  if (gp_sched_pool)
+    {
+      notify_waiters (gp_sched_pool);
+    }
+}
+
+void
+tiz_sched_pool_wait_terminated (tiz_sched_actor_t * ap_actor)
+{
+  assert (ap_actor);
+  wait_until (ap_actor, is_terminated, NULL, NULL);
+}
+
+bool
+tiz_sched_pool_is_worker (void)
+{
+  return (NULL != tp_worker);
+}
+
+tiz_sched_actor_t *
+tiz_sched_pool_current (void)
+{
+  return tp_current;
+}
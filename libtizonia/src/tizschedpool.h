@@ -0,0 +1,119 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizschedpool.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia OpenMAX IL - Scheduler worker pool
+ *
+ * A fixed-size, work-stealing pool of threads that multiplexes component
+ * schedulers ('actors'). An actor is run by at most one worker at any given
+ * time, so the order in which an actor processes its messages is preserved.
+ *
+ */
+
+#ifndef TIZSCHEDPOOL_H
+#define TIZSCHEDPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+
+typedef struct tiz_sched_actor tiz_sched_actor_t;
+
+/* Runs one batch of the actor's work. Called on a pool worker thread (or on a
+   thread that has claimed the actor with tiz_sched_pool_claim). Returns true if
+   the actor has terminated and must not be scheduled again. */
+typedef bool (*tiz_sched_actor_run_f) (tiz_sched_actor_t * ap_actor);
+
+/* Whether the actor has work pending (e.g. messages in its queue). */
+typedef bool (*tiz_sched_actor_pending_f) (tiz_sched_actor_t * ap_actor);
+
+struct tiz_sched_actor
+{
+  tiz_sched_actor_run_f pf_run;
+  tiz_sched_actor_pending_f pf_pending;
+  void * p_data;
+  OMX_S32 state;
+  void * p_worker;
+  tiz_sched_actor_t * p_next;
+  tiz_sched_actor_t * p_prev;
+};
+
+/* Creates the process-wide pool on first use. a_nthreads == 0 means one
+   thread per online core. Subsequent calls return the existing pool. */
+OMX_ERRORTYPE
+tiz_sched_pool_init (OMX_U32 a_nthreads);
+
+void
+tiz_sched_pool_actor_init (tiz_sched_actor_t * ap_actor,
+                           tiz_sched_actor_run_f a_pf_run,
+                           tiz_sched_actor_pending_f a_pf_pending,
+                           void * ap_data);
+
+/* Makes the actor runnable, if it is not already queued or running. */
+void
+tiz_sched_pool_schedule (tiz_sched_actor_t * ap_actor);
+
+/* Takes ownership of a queued (not running) actor so that the calling thread
+   can run it in place. Used by workers that would otherwise block waiting on
+   the actor. Must be followed by tiz_sched_pool_run_claimed. */
+bool
+tiz_sched_pool_claim (tiz_sched_actor_t * ap_actor);
+
+void
+tiz_sched_pool_run_claimed (tiz_sched_actor_t * ap_actor);
+
+/* Whether whatever a thread is waiting for in tiz_sched_pool_wait has
+   happened. */
+typedef bool (*tiz_sched_pool_done_f) (void * ap_arg);
+
+/* Blocks until the actor can be claimed or a_pf_done returns true. Threads
+   that make a_pf_done true must call tiz_sched_pool_notify afterwards. */
+void
+tiz_sched_pool_wait (tiz_sched_actor_t * ap_actor,
+                     tiz_sched_pool_done_f a_pf_done, void * ap_arg);
+
+/* Wakes up the threads blocked in tiz_sched_pool_wait. */
+void
+tiz_sched_pool_notify (void);
+
+/* Waits until a terminated actor has been released by its worker. */
+void
+tiz_sched_pool_wait_terminated (tiz_sched_actor_t * ap_actor);
+
+/* Whether the calling thread is a pool worker. */
+bool
+tiz_sched_pool_is_worker (void);
+
+/* The actor currently running on the calling thread, or NULL. */
+tiz_sched_actor_t *
+tiz_sched_pool_current (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZSCHEDPOOL_H */
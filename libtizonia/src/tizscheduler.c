@@ -31,6 +31,8 @@
 #endif
 
 #include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <OMX_Core.h>
@@ -46,6 +48,7 @@
 #include "tizprc.h"
 #include "tizport.h"
 #include "tizobjsys.h"
+#include "tizschedpool.h"
 #include "tizscheduler.h"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
@@ -55,6 +58,10 @@
 
 #define SCHED_OMX_DEFAULT_ROLE "default"
 #define SCHED_QUEUE_MAX_ITEMS 30
+#define SCHED_POOL_MSG_BUDGET 16
+#define SCHED_MBOX_MAX_ITEMS 64
+/* Headers are at least word-aligned; the low bit tags FillThisBuffer items */
+#define SCHED_MBOX_FTB_TAG ((uintptr_t) 1)
 
 #ifndef S_SPLINT_S
 #define TIZ_COMP_INIT_MSG(hdl, msg, msgtype)         \
@@ -122,6 +129,20 @@ struct tiz_srv_group
   OMX_COMPONENTTYPE * p_hdl;
 };
 
+/* Component-wide run-time counters (see OMX_TIZONIA_PERFCOUNTERSTYPE). Only
+   updated from the component's own context. */
+typedef struct tiz_sched_perf tiz_sched_perf_t;
+struct tiz_sched_perf
+{
+  OMX_U64 messages;
+  OMX_U64 latency_us;
+  OMX_U32 latency_max_us;
+  OMX_U32 queue_hwm;
+  OMX_U64 br_calls;
+  OMX_U64 br_us;
+  OMX_U32 br_max_us;
+};
+
 typedef struct tiz_scheduler tiz_scheduler_t;
 struct tiz_scheduler
 {
@@ -138,6 +159,15 @@ struct tiz_scheduler
   OMX_S32 error;
   tiz_srv_group_t child;
   tiz_sched_state_t state;
+  bool pooled; /* Whether this scheduler runs on the shared worker pool */
+  tiz_sched_actor_t actor;
+  tiz_queue_t * p_mbox; /* Buffer headers handed over by tunneled peers */
+  struct tiz_sched_msg * p_mbox_msg; /* Pre-allocated mailbox notification */
+  bool mbox_notified;
+  bool inline_evloop; /* Whether watchers are served by the scheduler thread */
+  tiz_event_loop_t * p_evloop;
+  tiz_sched_perf_t perf;
+  bool hooks_overridden; /* Whether hooks were registered after SetCallbacks */
   OMX_PTR
   appdata; /* For use during setting of the component callbacks, not owned */
   OMX_CALLBACKTYPE *
@@ -175,6 +205,7 @@ enum tiz_sched_msg_class
   ETIZSchedMsgEvIo,
   ETIZSchedMsgEvTimer,
   ETIZSchedMsgEvStat,
+  ETIZSchedMsgBufferMailbox,
   ETIZSchedMsgMax,
 };
 
@@ -356,6 +387,7 @@ struct tiz_sched_msg
   OMX_BOOL will_block;
   OMX_BOOL may_block;
   tiz_sched_msg_class_t class;
+  OMX_U64 sent_us; /* When the message was queued, zero if it wasn't */
   union
   {
     tiz_sched_msg_getcomponentversion_t gcv;
@@ -440,6 +472,8 @@ static OMX_ERRORTYPE
 do_etmr (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
 static OMX_ERRORTYPE
 do_estat (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
+static OMX_ERRORTYPE
+do_mbox (tiz_scheduler_t *, tiz_sched_state_t *, tiz_sched_msg_t *);
 
 static OMX_ERRORTYPE
 init_servants (tiz_scheduler_t *, tiz_sched_msg_t *);
@@ -466,6 +500,7 @@ static const tiz_sched_msg_dispatch_f tiz_sched_msg_to_fnt_tbl[] = {
   do_sconfig, do_gei,    do_gs,    do_tr,   do_ub,     do_ab,     do_fb,
   do_etb,     do_ftb,    do_scbs,  do_uei,  do_cre,    do_plgevt, do_rr,
   do_rt,      do_rph,    do_reh,   do_rreh, do_eio,    do_etmr,   do_estat,
+  do_mbox,
 };
 
 static OMX_BOOL
@@ -509,6 +544,7 @@ static tiz_sched_msg_str_t tiz_sched_msg_to_str_tbl[] = {
   {ETIZSchedMsgEvIo, "{ETIZSchedMsgEvIo,"},
   {ETIZSchedMsgEvTimer, "ETIZSchedMsgEvTimer"},
   {ETIZSchedMsgEvStat, "ETIZSchedMsgEvStat"},
+  {ETIZSchedMsgBufferMailbox, "ETIZSchedMsgBufferMailbox"},
   {ETIZSchedMsgMax, "ETIZSchedMsgMax"},
 };
 
@@ -569,6 +605,7 @@ static OMX_BOOL tiz_sched_blocking_apis_tbl[] = {
   OMX_FALSE,    /* ETIZSchedMsgEvIo */
   OMX_FALSE,    /* ETIZSchedMsgEvTimer */
   OMX_FALSE,    /* ETIZSchedMsgEvStat */
+  OMX_FALSE,    /* ETIZSchedMsgBufferMailbox */
   OMX_BOOL_MAX, /* ETIZSchedMsgMax */
 };
 
@@ -765,14 +802,145 @@ store_hooks (tiz_map_t ** app_map, OMX_U32 a_pid, const void * ap_hooks,
   return rc;
 }
 
+static bool
+is_reply_ready (void * ap_arg)
+{
+  tiz_scheduler_t * p_sched = ap_arg;
+  OMX_S32 value = 0;
+  assert (p_sched);
+  (void) tiz_sem_getvalue (&(p_sched->sem), &value);
+  return (value > 0);
+}
+
+static bool
+has_queue_room (void * ap_arg)
+{
+  tiz_scheduler_t * p_sched = ap_arg;
+  assert (p_sched);
+  return (tiz_queue_length (p_sched->p_queue) < SCHED_QUEUE_MAX_ITEMS);
+}
+
+static bool
+has_mbox_room (void * ap_arg)
+{
+  tiz_scheduler_t * p_sched = ap_arg;
+  assert (p_sched);
+  return (tiz_queue_length (p_sched->p_mbox) < SCHED_MBOX_MAX_ITEMS);
+}
+
+/* Lets a blocking caller know that its call has completed */
+static inline void
+signal_caller (tiz_scheduler_t * ap_sched)
+{
+  assert (ap_sched);
+  (void) tiz_sem_post (&(ap_sched->sem));
+  if (ap_sched->pooled)
+    {
+      /* The caller may be a pool worker waiting in wait_for_reply */
+      tiz_sched_pool_notify ();
+    }
+}
+
+static OMX_ERRORTYPE
+wait_for_reply (tiz_scheduler_t * ap_sched)
+{
+  tiz_sched_actor_t * p_self = NULL;
+  tiz_scheduler_t * p_caller = NULL;
+  OMX_S32 caller_tid = 0;
+
+  assert (ap_sched);
+
+  if (!ap_sched->pooled || !tiz_sched_pool_is_worker ())
+    {
+      return tiz_sem_wait (&(ap_sched->sem));
+    }
+
+  /* A pool worker must not just block here: the target may be queued behind
+     this very worker. Instead, run the target in place whenever it is not
+     already running somewhere else. While it is running on another worker,
+     sleep until it either replies or is queued again (e.g. when it has made a
+     nested blocking call itself). */
+  if ((p_self = tiz_sched_pool_current ()))
+    {
+      /* While we wait, messages for the caller must go through its queue */
+      p_caller = (tiz_scheduler_t *) p_self->p_data;
+      caller_tid = p_caller->thread_id;
+      p_caller->thread_id = 0;
+    }
+
+  for (;;)
+    {
+      if (tiz_sched_pool_claim (&(ap_sched->actor)))
+        {
+          tiz_sched_pool_run_claimed (&(ap_sched->actor));
+        }
+      if (is_reply_ready (ap_sched))
+        {
+          (void) tiz_sem_wait (&(ap_sched->sem));
+          break;
+        }
+      tiz_sched_pool_wait (&(ap_sched->actor), is_reply_ready, ap_sched);
+    }
+
+  if (p_caller)
+    {
+      p_caller->thread_id = caller_tid;
+    }
+
+  return OMX_ErrorNone;
+}
+
+static void
+make_room (tiz_scheduler_t * ap_sched)
+{
+  assert (ap_sched);
+
+  /* Same as above: a pool worker should not block on a full queue whose
+     consumer might be queued behind it. */
+  if (ap_sched->pooled && tiz_sched_pool_is_worker ())
+    {
+      while (!has_queue_room (ap_sched))
+        {
+          if (tiz_sched_pool_claim (&(ap_sched->actor)))
+            {
+              tiz_sched_pool_run_claimed (&(ap_sched->actor));
+            }
+          else
+            {
+              tiz_sched_pool_wait (&(ap_sched->actor), has_queue_room,
+                                   ap_sched);
+            }
+        }
+    }
+}
+
+/* Lets the consumer of the scheduler's queue know that there is work */
+static inline void
+notify_scheduler (tiz_scheduler_t * ap_sched)
+{
+  assert (ap_sched);
+  if (ap_sched->pooled)
+    {
+      tiz_sched_pool_schedule (&(ap_sched->actor));
+    }
+  else if (ap_sched->p_evloop)
+    {
+      /* The scheduler thread may be waiting in its event loop */
+      tiz_event_loop_wakeup (ap_sched->p_evloop);
+    }
+}
+
 static inline OMX_ERRORTYPE
 send_msg_blocking (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
 {
   assert (ap_msg);
   assert (ap_sched);
   ap_msg->will_block = OMX_TRUE;
+  make_room (ap_sched);
+  ap_msg->sent_us = tiz_time_now_us ();
   tiz_check_omx_ret_oom (tiz_queue_send (ap_sched->p_queue, ap_msg));
-  tiz_check_omx_ret_oom (tiz_sem_wait (&(ap_sched->sem)));
+  notify_scheduler (ap_sched);
+  tiz_check_omx_ret_oom (wait_for_reply (ap_sched));
   return ap_sched->error;
 }
 
@@ -782,7 +950,11 @@ send_msg_non_blocking (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
   assert (ap_msg);
   assert (ap_sched);
   ap_msg->will_block = OMX_FALSE;
-  return tiz_queue_send (ap_sched->p_queue, ap_msg);
+  make_room (ap_sched);
+  ap_msg->sent_us = tiz_time_now_us ();
+  tiz_check_omx (tiz_queue_send (ap_sched->p_queue, ap_msg));
+  notify_scheduler (ap_sched);
+  return OMX_ErrorNone;
 }
 
 static inline OMX_ERRORTYPE
@@ -901,6 +1073,40 @@ do_gparam (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
   return rc;
 }
 
+static OMX_ERRORTYPE
+reset_role (tiz_scheduler_t * ap_sched, const OMX_U32 a_role_pos)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_sched);
+  assert (a_role_pos < ap_sched->child.nroles);
+
+  /* Deregister the current role */
+
+  /* First, delete the processor */
+  factory_delete (ap_sched->child.p_prc);
+  ap_sched->child.p_prc = NULL;
+
+  /* This also resets the kernel's per-port counters */
+  tiz_krn_deregister_all_ports (ap_sched->child.p_ker);
+
+  /* Populate defaults according to the new role */
+  rc = init_and_register_role (ap_sched, a_role_pos);
+
+  if (OMX_ErrorNone == rc)
+    {
+      /* Restore any previously registered hooks, if any */
+      rc = restore_hooks (ap_sched, a_role_pos);
+    }
+
+  /* Now, make sure the new role's processor has access to the IL
+     client's callback information */
+  tiz_srv_set_callbacks (ap_sched->child.p_prc, ap_sched->appdata,
+                         ap_sched->cbacks);
+
+  return rc;
+}
+
 static OMX_ERRORTYPE
 do_set_component_role (tiz_scheduler_t * ap_sched,
                        const OMX_PARAM_COMPONENTROLETYPE * ap_role)
@@ -951,27 +1157,7 @@ do_set_component_role (tiz_scheduler_t * ap_sched,
 
       if (role_pos < nroles)
         {
-          /* Deregister the current role */
-
-          /* First, delete the processor */
-          factory_delete (ap_sched->child.p_prc);
-          ap_sched->child.p_prc = NULL;
-
-          tiz_krn_deregister_all_ports (ap_sched->child.p_ker);
-
-          /* Populate defaults according to the new role */
-          rc = init_and_register_role (ap_sched, role_pos);
-
-          if (OMX_ErrorNone == rc)
-            {
-              /* Restore any previously registered hooks, if any */
-              rc = restore_hooks (ap_sched, role_pos);
-            }
-
-          /* Now, make sure the new role's processor has access to the IL
-             client's callback information */
-          tiz_srv_set_callbacks (ap_sched->child.p_prc, ap_sched->appdata,
-                                 ap_sched->cbacks);
+          rc = reset_role (ap_sched, role_pos);
         }
       else
         {
@@ -982,6 +1168,29 @@ do_set_component_role (tiz_scheduler_t * ap_sched,
   return rc;
 }
 
+static OMX_ERRORTYPE
+do_reset_component (tiz_scheduler_t * ap_sched)
+{
+  assert (ap_sched);
+
+  TIZ_COMP_CHECK_LOADED_STATE (ap_sched);
+
+  /* Hooks registered after the component was handed to the IL client are
+     not part of its initial configuration, and can't be told apart from the
+     ones registered by the component itself */
+  if (ap_sched->hooks_overridden)
+    {
+      TIZ_DEBUG (ap_sched->child.p_hdl,
+                 "[OMX_ErrorNotReady] : hooks have been overridden");
+      return OMX_ErrorNotReady;
+    }
+
+  tiz_check_omx (reset_role (ap_sched, 0));
+  memset (&(ap_sched->perf), 0, sizeof (ap_sched->perf));
+
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 do_sparam (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
            tiz_sched_msg_t * ap_msg)
@@ -999,6 +1208,10 @@ do_sparam (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
     {
       rc = do_set_component_role (ap_sched, p_msg_gparam->p_struct);
     }
+  else if (OMX_TizoniaIndexParamComponentReset == p_msg_gparam->index)
+    {
+      rc = do_reset_component (ap_sched);
+    }
   else
     {
       rc = tiz_api_SetParameter (ap_sched->child.p_fsm, ap_msg->p_hdl,
@@ -1013,6 +1226,7 @@ do_gconfig (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
             tiz_sched_msg_t * ap_msg)
 {
   tiz_sched_msg_setget_paramconfig_t * p_msg_gconfig = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
 
   assert (ap_sched);
   assert (ap_msg);
@@ -1020,8 +1234,25 @@ do_gconfig (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
   p_msg_gconfig = &(ap_msg->sgpc);
   assert (p_msg_gconfig);
 
-  return tiz_api_GetConfig (ap_sched->child.p_fsm, ap_msg->p_hdl,
-                            p_msg_gconfig->index, p_msg_gconfig->p_struct);
+  rc = tiz_api_GetConfig (ap_sched->child.p_fsm, ap_msg->p_hdl,
+                          p_msg_gconfig->index, p_msg_gconfig->p_struct);
+
+  if (OMX_ErrorNone == rc
+      && OMX_TizoniaIndexConfigPerfCounters == p_msg_gconfig->index)
+    {
+      /* The kernel has filled in the port counters */
+      OMX_TIZONIA_PERFCOUNTERSTYPE * p_counters = p_msg_gconfig->p_struct;
+      const tiz_sched_perf_t * p_perf = &(ap_sched->perf);
+      p_counters->nBuffersReadyCalls = p_perf->br_calls;
+      p_counters->nBuffersReadyTime = p_perf->br_us;
+      p_counters->nBuffersReadyMaxTime = p_perf->br_max_us;
+      p_counters->nMsgQueueHighWaterMark = p_perf->queue_hwm;
+      p_counters->nMessages = p_perf->messages;
+      p_counters->nDispatchLatency = p_perf->latency_us;
+      p_counters->nDispatchLatencyMax = p_perf->latency_max_us;
+    }
+
+  return rc;
 }
 
 static OMX_ERRORTYPE
@@ -1044,7 +1275,7 @@ do_sconfig (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
      non-blocking */
   if (OMX_FALSE == tiz_sched_blocking_apis_tbl[ETIZSchedMsgSetConfig])
     {
-      tiz_mem_free (p_msg_sconfig->p_struct);
+      tiz_slab_free (p_msg_sconfig->p_struct);
       p_msg_sconfig->p_struct = NULL;
     }
 
@@ -1447,6 +1678,11 @@ do_rph (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
       }
   }
 
+  if (OMX_ErrorNone == rc && ap_sched->cbacks)
+    {
+      ap_sched->hooks_overridden = true;
+    }
+
   return rc;
 }
 
@@ -1506,6 +1742,11 @@ do_reh (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
       }
   }
 
+  if (OMX_ErrorNone == rc && ap_sched->cbacks)
+    {
+      ap_sched->hooks_overridden = true;
+    }
+
   return rc;
 }
 
@@ -1603,6 +1844,11 @@ do_rreh (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
                       sizeof (tiz_eglimage_hook_t), eglimage_hook_copy);
   }
 
+  if (OMX_ErrorNone == rc && ap_sched->cbacks)
+    {
+      ap_sched->hooks_overridden = true;
+    }
+
   return rc;
 }
 
@@ -1657,6 +1903,57 @@ do_estat (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
                              p_msg_estat->id, p_msg_estat->events);
 }
 
+static void
+drain_mbox (tiz_scheduler_t * ap_sched)
+{
+  OMX_PTR p_item = NULL;
+  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_sched);
+
+  while (tiz_queue_length (ap_sched->p_mbox) > 0
+         && OMX_ErrorNone == tiz_queue_receive (ap_sched->p_mbox, &p_item))
+    {
+      assert (p_item);
+      p_hdr = (OMX_BUFFERHEADERTYPE *) ((uintptr_t) p_item
+                                        & ~SCHED_MBOX_FTB_TAG);
+      if ((uintptr_t) p_item & SCHED_MBOX_FTB_TAG)
+        {
+          rc = tiz_api_FillThisBuffer (ap_sched->child.p_fsm,
+                                       ap_sched->child.p_hdl, p_hdr);
+        }
+      else
+        {
+          rc = tiz_api_EmptyThisBuffer (ap_sched->child.p_fsm,
+                                        ap_sched->child.p_hdl, p_hdr);
+        }
+
+      if (OMX_ErrorNone != rc)
+        {
+          TIZ_ERROR (ap_sched->child.p_hdl,
+                     "[%s] : While processing tunneled buffer header [%p]",
+                     tiz_err_to_str (rc), p_hdr);
+        }
+    }
+}
+
+static OMX_ERRORTYPE
+do_mbox (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
+         tiz_sched_msg_t * ap_msg)
+{
+  assert (ap_sched);
+  assert (ap_msg);
+  assert (ap_state && ETIZSchedStateStarted == *ap_state);
+
+  /* Re-arm the notification before draining; a producer that finds it
+     cleared will post a new one */
+  __atomic_store_n (&(ap_sched->mbox_notified), false, __ATOMIC_SEQ_CST);
+  drain_mbox (ap_sched);
+
+  return OMX_ErrorNone;
+}
+
 /* NOTE: Start ignoring splint warnings in this section of code */
 /*@ignore@*/
 static inline tiz_sched_msg_t *
@@ -1669,7 +1966,7 @@ init_scheduler_message (OMX_HANDLETYPE ap_hdl,
   assert (a_msg_class < ETIZSchedMsgMax);
 
   if (!(p_msg
-        = (tiz_sched_msg_t *) tiz_mem_calloc (1, sizeof (tiz_sched_msg_t))))
+        = (tiz_sched_msg_t *) tiz_slab_calloc (sizeof (tiz_sched_msg_t))))
     {
       TIZ_ERROR (ap_hdl,
                  "[OMX_ErrorInsufficientResources] : "
@@ -1946,9 +2243,9 @@ sched_SetConfig (OMX_HANDLETYPE ap_hdl, OMX_INDEXTYPE a_index,
   if (OMX_FALSE == tiz_sched_blocking_apis_tbl[ETIZSchedMsgSetConfig])
     {
       if (!(p_msg_sconf->p_struct
-            = tiz_mem_calloc (1, (*(OMX_U32 *) ap_struct))))
+            = tiz_slab_calloc ((*(OMX_U32 *) ap_struct))))
         {
-          tiz_mem_free (p_msg);
+          tiz_slab_free (p_msg);
           TIZ_ERROR (ap_hdl,
                      "[OMX_ErrorInsufficientResources] : "
                      "(While allocating memory for config struct)");
@@ -2302,6 +2599,27 @@ sched_ComponentRoleEnum (OMX_HANDLETYPE ap_hdl, OMX_U8 * ap_role,
   return send_msg (p_sched, p_msg);
 }
 
+static void
+update_dispatch_perf (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
+{
+  tiz_sched_perf_t * p_perf = &(ap_sched->perf);
+  /* Including the message that has just been received */
+  const OMX_U32 depth = tiz_queue_length (ap_sched->p_queue) + 1;
+  const OMX_U64 latency = tiz_time_now_us () - ap_msg->sent_us;
+
+  p_perf->messages++;
+  p_perf->latency_us += latency;
+  if (latency > p_perf->latency_max_us)
+    {
+      p_perf->latency_max_us = latency;
+    }
+  if (depth > p_perf->queue_hwm)
+    {
+      p_perf->queue_hwm = depth;
+    }
+  ap_msg->sent_us = 0;
+}
+
 static OMX_BOOL
 dispatch_msg (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
               tiz_sched_msg_t * ap_msg)
@@ -2319,12 +2637,20 @@ dispatch_msg (tiz_scheduler_t * ap_sched, tiz_sched_state_t * ap_state,
 
   signal_client = ap_msg->will_block;
 
+  if (ap_msg->sent_us > 0)
+    {
+      update_dispatch_perf (ap_sched, ap_msg);
+    }
+
   rc = tiz_sched_msg_to_fnt_tbl[ap_msg->class](ap_sched, ap_state, ap_msg);
 
   /* Return error to client */
   ap_sched->error = rc;
 
-  tiz_mem_free (ap_msg);
+  if (ap_msg != ap_sched->p_mbox_msg)
+    {
+      tiz_slab_free (ap_msg);
+    }
 
   return signal_client;
 }
@@ -2399,15 +2725,39 @@ il_sched_thread_func (void * p_arg)
   assert (p_sched);
 
   p_sched->thread_id = tiz_thread_id ();
+  if (p_sched->inline_evloop
+      && OMX_ErrorNone
+           != tiz_event_loop_bind (p_sched->child.p_hdl, &(p_sched->p_evloop)))
+    {
+      TIZ_WARN (p_sched->child.p_hdl,
+                "Unable to bind an event loop; using the shared loops");
+      p_sched->p_evloop = NULL;
+    }
   tiz_check_omx_ret_null (tiz_sem_post (&(p_sched->sem)));
 
   for (;;)
     {
+      if (p_sched->p_evloop && 0 == tiz_queue_length (p_sched->p_queue))
+        {
+          /* Nothing queued: serve the component's watchers from this thread
+             until there is something to do. Watcher callbacks are dispatched
+             in place (see send_msg). */
+          tiz_event_loop_batch_begin ();
+          tiz_event_loop_run_once (p_sched->p_evloop);
+          schedule_servants (p_sched, p_sched->state);
+          (void) tiz_event_loop_batch_commit ();
+          continue;
+        }
+
       tiz_check_omx_ret_null (tiz_queue_receive (p_sched->p_queue, &p_data));
 
       assert (p_data);
+      /* Watcher commands issued while handling the message are handed over to
+         the event loop(s) in one go, before the client is signalled */
+      tiz_event_loop_batch_begin ();
       signal_client
         = dispatch_msg (p_sched, &(p_sched->state), (tiz_sched_msg_t *) p_data);
+      (void) tiz_event_loop_batch_commit ();
 
       if (OMX_TRUE == signal_client)
         {
@@ -2419,17 +2769,91 @@ il_sched_thread_func (void * p_arg)
           break;
         }
 
+      tiz_event_loop_batch_begin ();
       schedule_servants (p_sched, p_sched->state);
+      (void) tiz_event_loop_batch_commit ();
+    }
+
+  if (p_sched->p_evloop)
+    {
+      tiz_event_loop_unbind (p_sched->p_evloop);
+      p_sched->p_evloop = NULL;
     }
 
   return NULL;
 }
 
+static bool
+sched_actor_pending (tiz_sched_actor_t * ap_actor)
+{
+  tiz_scheduler_t * p_sched = (tiz_scheduler_t *) ap_actor->p_data;
+  assert (p_sched);
+  return (tiz_queue_length (p_sched->p_queue) > 0);
+}
+
+/* Pool mode counterpart of il_sched_thread_func. Processes a bounded number of
+   messages and then gives the worker back to the pool. */
+static bool
+sched_actor_run (tiz_sched_actor_t * ap_actor)
+{
+  tiz_scheduler_t * p_sched = (tiz_scheduler_t *) ap_actor->p_data;
+  OMX_PTR p_data = NULL;
+  OMX_BOOL signal_client = OMX_FALSE;
+  int i = 0;
+
+  assert (p_sched);
+
+  p_sched->thread_id = tiz_thread_id ();
+
+  for (i = 0; i < SCHED_POOL_MSG_BUDGET && sched_actor_pending (ap_actor);
+       ++i)
+    {
+      if (OMX_ErrorNone != tiz_queue_receive (p_sched->p_queue, &p_data))
+        {
+          break;
+        }
+
+      assert (p_data);
+      tiz_event_loop_batch_begin ();
+      signal_client
+        = dispatch_msg (p_sched, &(p_sched->state), (tiz_sched_msg_t *) p_data);
+      (void) tiz_event_loop_batch_commit ();
+
+      if (ETIZSchedStateStopped == p_sched->state)
+        {
+          p_sched->thread_id = 0;
+          if (OMX_TRUE == signal_client)
+            {
+              signal_caller (p_sched);
+            }
+          return true;
+        }
+
+      if (OMX_TRUE == signal_client)
+        {
+          signal_caller (p_sched);
+        }
+
+      tiz_event_loop_batch_begin ();
+      schedule_servants (p_sched, p_sched->state);
+      (void) tiz_event_loop_batch_commit ();
+    }
+
+  p_sched->thread_id = 0;
+  return false;
+}
+
 static OMX_ERRORTYPE
 start_scheduler (tiz_scheduler_t * ap_sched)
 {
   assert (ap_sched);
 
+  if (ap_sched->pooled)
+    {
+      /* Nothing to start; the actor runs when it receives messages */
+      return OMX_ErrorNone;
+    }
+
   /* Create scheduler thread */
   tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_sched->mutex)));
   tiz_check_omx_ret_oom (tiz_thread_create (&(ap_sched->thread), 0, 0,
@@ -2446,7 +2870,14 @@ delete_scheduler (tiz_scheduler_t * ap_sched)
 {
   OMX_PTR p_result = NULL;
   assert (ap_sched);
-  (void) tiz_thread_join (&(ap_sched->thread), &p_result);
+  if (ap_sched->pooled)
+    {
+      tiz_sched_pool_wait_terminated (&(ap_sched->actor));
+    }
+  else
+    {
+      (void) tiz_thread_join (&(ap_sched->thread), &p_result);
+    }
   delete_roles (ap_sched);
   delete_hooks (ap_sched, ap_sched->child.p_alloc_hooks_map);
   ap_sched->child.p_alloc_hooks_map = NULL;
@@ -2456,9 +2887,40 @@ delete_scheduler (tiz_scheduler_t * ap_sched)
   (void) tiz_sem_destroy (&(ap_sched->sem));
   tiz_queue_destroy (ap_sched->p_queue);
   ap_sched->p_queue = NULL;
+  tiz_queue_destroy (ap_sched->p_mbox);
+  ap_sched->p_mbox = NULL;
+  tiz_slab_free (ap_sched->p_mbox_msg);
+  ap_sched->p_mbox_msg = NULL;
   tiz_mem_free (ap_sched);
 }
 
+static bool
+use_sched_pool (void)
+{
+  const char * p_nthreads = NULL;
+  OMX_U32 nthreads = 0;
+
+  if (0 != tiz_rcfile_compare_value ("ilcore", "scheduler-mode", "pool"))
+    {
+      return false;
+    }
+
+  if ((p_nthreads = tiz_rcfile_get_value ("ilcore", "scheduler-pool-threads")))
+    {
+      nthreads = strtoul (p_nthreads, NULL, 10);
+    }
+
+  if (OMX_ErrorNone != tiz_sched_pool_init (nthreads))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR,
+               "Unable to start the scheduler pool; "
+               "falling back to one thread per component");
+      return false;
+    }
+
+  return true;
+}
+
 static tiz_scheduler_t *
 instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
 {
@@ -2475,10 +2937,33 @@ instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
       return NULL;
     }
 
-  tiz_check_omx_ret_null (tiz_mutex_init (&(p_sched->mutex)));
-  tiz_check_omx_ret_null (tiz_sem_init (&(p_sched->sem), 0));
-  tiz_check_omx_ret_null (
-    tiz_queue_init (&(p_sched->p_queue), SCHED_QUEUE_MAX_ITEMS));
+  if (OMX_ErrorNone != tiz_mutex_init (&(p_sched->mutex)))
+    {
+      goto mutex_failed;
+    }
+  if (OMX_ErrorNone != tiz_sem_init (&(p_sched->sem), 0))
+    {
+      goto sem_failed;
+    }
+  /* The scheduler thread is the queue's only consumer */
+  if (OMX_ErrorNone
+      != tiz_queue_init_with_type (&(p_sched->p_queue), SCHED_QUEUE_MAX_ITEMS,
+                                   ETIZQueueTypeLockFree))
+    {
+      goto queue_failed;
+    }
+  /* Tunneled peers hand buffer headers over through this mailbox */
+  if (OMX_ErrorNone
+      != tiz_queue_init_with_type (&(p_sched->p_mbox), SCHED_MBOX_MAX_ITEMS,
+                                   ETIZQueueTypeLockFree))
+    {
+      goto mbox_failed;
+    }
+  if (!(p_sched->p_mbox_msg
+        = init_scheduler_message (ap_hdl, ETIZSchedMsgBufferMailbox)))
+    {
+      goto mbox_msg_failed;
+    }
 
   p_sched->child.p_fsm = NULL;
   p_sched->child.p_ker = NULL;
@@ -2492,6 +2977,15 @@ instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
   p_sched->state = ETIZSchedStateStarting;
   p_sched->appdata = NULL;
   p_sched->cbacks = NULL;
+  p_sched->pooled = use_sched_pool ();
+  /* An actor can't block in an event loop; pool mode uses the shared loops */
+  p_sched->inline_evloop
+    = !p_sched->pooled
+      && (0 == tiz_rcfile_compare_value ("ilcore", "event-loop-mode", "inline"));
+  p_sched->p_evloop = NULL;
+  p_sched->mbox_notified = false;
+  tiz_sched_pool_actor_init (&(p_sched->actor), sched_actor_run,
+                             sched_actor_pending, p_sched);
 
   len = strnlen (ap_cname, OMX_MAX_STRINGNAME_SIZE - 1);
   strncpy (p_sched->cname, ap_cname, len);
@@ -2500,6 +2994,22 @@ instantiate_scheduler (OMX_HANDLETYPE ap_hdl, const char * ap_cname)
   ((OMX_COMPONENTTYPE *) ap_hdl)->pComponentPrivate = p_sched;
 
   return p_sched;
+
+  /* Release whatever was set up before the failure */
+mbox_msg_failed:
+  tiz_queue_destroy (p_sched->p_mbox);
+mbox_failed:
+  tiz_queue_destroy (p_sched->p_queue);
+queue_failed:
+  (void) tiz_sem_destroy (&(p_sched->sem));
+sem_failed:
+  (void) tiz_mutex_destroy (&(p_sched->mutex));
+mutex_failed:
+  TIZ_LOG (TIZ_PRIORITY_ERROR,
+           "[OMX_ErrorInsufficientResources] : "
+           "(Could not initialise the scheduler)");
+  tiz_mem_free (p_sched);
+  return NULL;
 }
 
 static OMX_ERRORTYPE
@@ -2550,7 +3060,10 @@ init_servants (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
   assert (ap_sched);
   assert (ap_msg);
 
-  tiz_check_omx_ret_oom (set_thread_name (ap_sched));
+  if (!ap_sched->pooled)
+    {
+      tiz_check_omx_ret_oom (set_thread_name (ap_sched));
+    }
 
   p_hdl = ap_sched->child.p_hdl;
 
@@ -2610,11 +3123,10 @@ init_servants (tiz_scheduler_t * ap_sched, tiz_sched_msg_t * ap_msg)
       return OMX_ErrorInsufficientResources;
     }
 
-  /* All servants will use the same small object allocator */
-  tiz_check_omx_ret_oom (
-    tiz_srv_set_allocator (ap_sched->child.p_fsm, ap_sched->p_soa));
-  tiz_check_omx_ret_oom (
-    tiz_srv_set_allocator (ap_sched->child.p_ker, ap_sched->p_soa));
+  /* The servants' messages and watchers come from the process-wide slab;
+     the small object allocator is only used by the object system */
+  tiz_check_omx_ret_oom (tiz_srv_set_allocator (ap_sched->child.p_fsm, NULL));
+  tiz_check_omx_ret_oom (tiz_srv_set_allocator (ap_sched->child.p_ker, NULL));
 
   return OMX_ErrorNone;
 }
@@ -2692,8 +3204,8 @@ init_and_register_role (tiz_scheduler_t * ap_sched, const OMX_U32 a_role_pos)
       assert (!ap_sched->child.p_prc);
       ap_sched->child.p_prc = p_proc;
 
-      /* All servants will use the same object allocator */
-      tiz_check_omx_ret_oom (tiz_srv_set_allocator (p_proc, ap_sched->p_soa));
+      /* Like the other servants, allocate from the slab */
+      tiz_check_omx_ret_oom (tiz_srv_set_allocator (p_proc, NULL));
     }
 
   return rc;
@@ -3047,6 +3559,89 @@ tiz_comp_event_queue_unused_spaces (const OMX_HANDLETYPE ap_hdl)
   return SCHED_QUEUE_MAX_ITEMS - tiz_queue_length (p_sched->p_queue);
 }
 
+void
+tiz_comp_perf_buffers_ready (const OMX_HANDLETYPE ap_hdl,
+                             const OMX_U64 a_elapsed_us)
+{
+  tiz_scheduler_t * p_sched = get_sched (ap_hdl);
+  tiz_sched_perf_t * p_perf = NULL;
+  assert (p_sched);
+  p_perf = &(p_sched->perf);
+  p_perf->br_calls++;
+  p_perf->br_us += a_elapsed_us;
+  if (a_elapsed_us > p_perf->br_max_us)
+    {
+      p_perf->br_max_us = a_elapsed_us;
+    }
+}
+
+OMX_ERRORTYPE
+tiz_comp_tunneled_buffer (const OMX_HANDLETYPE ap_peer_hdl,
+                          OMX_BUFFERHEADERTYPE * ap_hdr, const OMX_DIRTYPE a_dir)
+{
+  OMX_COMPONENTTYPE * p_peer = (OMX_COMPONENTTYPE *) ap_peer_hdl;
+  tiz_scheduler_t * p_sched = NULL;
+  uintptr_t item = 0;
+
+  assert (ap_peer_hdl);
+  assert (ap_hdr);
+  assert (0 == ((uintptr_t) ap_hdr & SCHED_MBOX_FTB_TAG));
+
+  /* Only Tizonia components in this process have a mailbox */
+  if (p_peer->EmptyThisBuffer != sched_EmptyThisBuffer
+      || p_peer->FillThisBuffer != sched_FillThisBuffer)
+    {
+      return (OMX_DirInput == a_dir ? OMX_FillThisBuffer (ap_peer_hdl, ap_hdr)
+                                    : OMX_EmptyThisBuffer (ap_peer_hdl, ap_hdr));
+    }
+
+  p_sched = get_sched (ap_peer_hdl);
+  assert (p_sched);
+
+  item = (uintptr_t) ap_hdr;
+  if (OMX_DirInput == a_dir)
+    {
+      item |= SCHED_MBOX_FTB_TAG;
+    }
+
+  if (p_sched->pooled && tiz_sched_pool_is_worker ())
+    {
+      /* Do not block on a full mailbox whose consumer might be queued behind
+         this worker */
+      while (!has_mbox_room (p_sched))
+        {
+          if (tiz_sched_pool_claim (&(p_sched->actor)))
+            {
+              tiz_sched_pool_run_claimed (&(p_sched->actor));
+            }
+          else
+            {
+              tiz_sched_pool_wait (&(p_sched->actor), has_mbox_room, p_sched);
+            }
+        }
+    }
+
+  tiz_check_omx (tiz_queue_send (p_sched->p_mbox, (OMX_PTR) item));
+
+  if (tiz_thread_id () == p_sched->thread_id)
+    {
+      /* Called from the peer's own context (e.g. from an IL callback) */
+      drain_mbox (p_sched);
+      return OMX_ErrorNone;
+    }
+
+  /* Only one notification needs to be in flight at any given time */
+  if (!__atomic_exchange_n (&(p_sched->mbox_notified), true, __ATOMIC_SEQ_CST))
+    {
+      make_room (p_sched);
+      p_sched->p_mbox_msg->sent_us = tiz_time_now_us ();
+      tiz_check_omx (tiz_queue_send (p_sched->p_queue, p_sched->p_mbox_msg));
+      notify_scheduler (p_sched);
+    }
+
+  return OMX_ErrorNone;
+}
+
 void *
 tiz_get_sched (const OMX_HANDLETYPE ap_hdl)
 {
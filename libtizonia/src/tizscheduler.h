@@ -412,6 +412,36 @@ tiz_comp_event_stat (const OMX_HANDLETYPE ap_hdl, tiz_event_stat_t * ap_ev_stat,
 size_t
 tiz_comp_event_queue_unused_spaces (const OMX_HANDLETYPE ap_hdl);
 
+/**
+ * Account for a call to the processor's buffers_ready method, in the
+ * component's performance counters (see OMX_TizoniaIndexConfigPerfCounters).
+ * Must be called from the component's own context.
+ * @ingroup tizscheduler
+ * @param ap_hdl The OpenMAX IL handle.
+ * @param a_elapsed_us The time spent in the call, in micro seconds.
+ */
+void
+tiz_comp_perf_buffers_ready (const OMX_HANDLETYPE ap_hdl,
+                             const OMX_U64 a_elapsed_us);
+
+/**
+ * Hand a buffer header over to a tunneled component. When the peer is a
+ * Tizonia component living in the same process, the header is placed directly
+ * in the peer's buffer mailbox, bypassing the allocation and queueing of a
+ * scheduler message. Otherwise, this is equivalent to calling
+ * OMX_EmptyThisBuffer (OMX_DirOutput) or OMX_FillThisBuffer (OMX_DirInput) on
+ * the peer.
+ *
+ * @ingroup tizscheduler
+ * @param ap_peer_hdl The tunneled component's OpenMAX IL handle.
+ * @param ap_hdr The buffer header.
+ * @param a_dir The direction of the local port that owns the header.
+ * @return OMX_ErrorNone on success, other OMX_ERRORTYPE on error.
+ */
+OMX_ERRORTYPE
+tiz_comp_tunneled_buffer (const OMX_HANDLETYPE ap_peer_hdl,
+                          OMX_BUFFERHEADERTYPE * ap_hdr, const OMX_DIRTYPE a_dir);
+
 /* Utility functions */
 
 /**
@@ -48,6 +48,30 @@ struct tiz_srv_watcher_id
   uint32_t id;
 };
 
+/* Messages and watcher ids come from the servant's small object allocator,
+   if one was set, or from the process-wide slab otherwise */
+static inline void *
+srv_calloc (const tiz_srv_t * ap_srv, const size_t a_size)
+{
+  assert (ap_srv);
+  return ap_srv->p_soa_ ? tiz_soa_calloc (ap_srv->p_soa_, a_size)
+                        : tiz_slab_calloc (a_size);
+}
+
+static inline void
+srv_free (const tiz_srv_t * ap_srv, void * ap_addr)
+{
+  assert (ap_srv);
+  if (ap_srv->p_soa_)
+    {
+      tiz_soa_free (ap_srv->p_soa_, ap_addr);
+    }
+  else
+    {
+      tiz_slab_free (ap_addr);
+    }
+}
+
 static OMX_S32
 pqueue_cmp (OMX_PTR ap_left, OMX_PTR ap_right)
 {
@@ -73,7 +97,7 @@ watchers_map_free_func (OMX_PTR ap_key, OMX_PTR ap_value)
   assert (p_id);
   assert (p_srv);
   TIZ_TRACE (handleOf (p_srv), "Deleting watcher id [%d]", id);
-  tiz_soa_free (p_srv->p_soa_, p_id);
+  srv_free (p_srv, p_id);
 }
 
 static void
@@ -162,7 +186,7 @@ srv_dtor (void * ap_obj)
               break;
             }
           assert (p_msg);
-          tiz_soa_free (p_srv->p_soa_, p_msg);
+          srv_free (p_srv, p_msg);
         }
 
       tiz_pqueue_destroy (p_srv->p_pq_);
@@ -176,7 +200,7 @@ srv_set_allocator (void * ap_obj, tiz_soa_t * p_soa)
 {
   tiz_srv_t * p_srv = ap_obj;
   assert (ap_obj);
-  assert (p_soa);
+  /* With no tiz_soa, the slab is used */
   p_srv->p_soa_ = p_soa;
   return tiz_pqueue_init (&p_srv->p_pq_, 5, &pqueue_cmp, p_soa,
                           nameOf (ap_obj));
@@ -242,7 +266,7 @@ srv_tick (const void * ap_obj)
 end:
 
   /* We are done with this message */
-  tiz_soa_free (p_srv->p_soa_, p_msg);
+  srv_free (p_srv, p_msg);
 
   if (OMX_ErrorNone != rc && OMX_ErrorNoMore != rc)
     {
@@ -273,8 +297,7 @@ srv_init_msg (void * ap_obj, size_t msg_sz)
 {
   tiz_srv_t * p_srv = ap_obj;
   assert (p_srv);
-  assert (p_srv->p_soa_);
-  return tiz_soa_calloc (p_srv->p_soa_, msg_sz);
+  return srv_calloc (p_srv, msg_sz);
 }
 
 OMX_PTR
@@ -619,7 +642,7 @@ srv_issue_buf_callback (const void * ap_obj, OMX_BUFFERHEADERTYPE * p_hdr,
                      "HEADER [%p] BUFFER [%p] [F(%d):A(%d)] [w:%d] [%s]",
                      p_hdr, p_hdr->pBuffer, p_hdr->nFilledLen, p_hdr->nAllocLen,
                      watcher_count (ap_obj), TIZ_CNAME (ap_tcomp));
-          (void) OMX_FillThisBuffer (ap_tcomp, p_hdr);
+          (void) tiz_comp_tunneled_buffer (ap_tcomp, p_hdr, dir);
         }
       else
         {
@@ -628,7 +651,7 @@ srv_issue_buf_callback (const void * ap_obj, OMX_BUFFERHEADERTYPE * p_hdr,
                      "HEADER [%p] BUFFER [%p] [F(%d):A(%d)] [w:%d] [%s]",
                      p_hdr, p_hdr->pBuffer, p_hdr->nFilledLen, p_hdr->nAllocLen,
                      watcher_count (ap_obj), TIZ_CNAME (ap_tcomp));
-          (void) OMX_EmptyThisBuffer (ap_tcomp, p_hdr);
+          (void) tiz_comp_tunneled_buffer (ap_tcomp, p_hdr, dir);
         }
     }
 
@@ -677,7 +700,7 @@ srv_soa_calloc (void * ap_obj, size_t a_size)
 {
   tiz_srv_t * p_srv = ap_obj;
   assert (p_srv);
-  return tiz_soa_calloc (p_srv->p_soa_, a_size);
+  return srv_calloc (p_srv, a_size);
 }
 
 void *
@@ -693,7 +716,7 @@ srv_soa_free (void * ap_obj, void * ap_addr)
 {
   tiz_srv_t * p_srv = ap_obj;
   assert (p_srv);
-  tiz_soa_free (p_srv->p_soa_, ap_addr);
+  srv_free (p_srv, ap_addr);
 }
 
 void
@@ -750,7 +773,7 @@ srv_io_watcher_start (void * ap_obj, tiz_event_io_t * ap_ev_io)
   if (!is_watcher_active (p_srv, ap_ev_io, &id))
     {
       tiz_srv_watcher_id_t * p_id
-        = tiz_soa_calloc (p_srv->p_soa_, sizeof (tiz_srv_watcher_id_t));
+        = srv_calloc (p_srv, sizeof (tiz_srv_watcher_id_t));
       if (p_id)
         {
           OMX_U32 index = 0;
@@ -874,7 +897,7 @@ srv_timer_watcher_start (void * ap_obj, tiz_event_timer_t * ap_ev_timer,
   if (!is_watcher_active (p_srv, ap_ev_timer, &id))
     {
       tiz_srv_watcher_id_t * p_id
-        = tiz_soa_calloc (p_srv->p_soa_, sizeof (tiz_srv_watcher_id_t));
+        = srv_calloc (p_srv, sizeof (tiz_srv_watcher_id_t));
       if (p_id)
         {
           OMX_U32 index = 0;
@@ -920,7 +943,7 @@ srv_timer_watcher_restart (void * ap_obj, tiz_event_timer_t * ap_ev_timer)
       tiz_map_erase (p_srv->p_watchers_, ap_ev_timer);
     }
 
-  p_id = tiz_soa_calloc (p_srv->p_soa_, sizeof (tiz_srv_watcher_id_t));
+  p_id = srv_calloc (p_srv, sizeof (tiz_srv_watcher_id_t));
   if (p_id)
     {
       OMX_U32 index = 0;
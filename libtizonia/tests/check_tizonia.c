@@ -49,6 +49,7 @@
 #include "tizscheduler.h"
 #include "tizfsm.h"
 #include "tizkernel.h"
+#include "tizport.h"
 
 #include "check_tizonia.h"
 
@@ -71,6 +72,9 @@ pid_t g_rmd_pid;
 /* duration of event timeout in msec when we don't expect event to be set */
 #define TIMEOUT_EXPECTING_FAILURE 2000
 
+#define HANDOFF_BENCH_BUFFERS 5000
+#define DISPATCH_BENCH_CALLS 1000000
+
 typedef void *cc_ctx_t;
 typedef struct check_common_context check_common_context_t;
 struct check_common_context
@@ -762,6 +766,80 @@ START_TEST (test_tizonia_preannouncements_extension)
 }
 END_TEST
 
+START_TEST (test_tizonia_component_reset_extension)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  OMX_U32 appData;
+  OMX_CALLBACKTYPE callBacks;
+  OMX_INDEXTYPE ext_index = OMX_IndexComponentStartUnused;
+  OMX_INDEXTYPE perf_index = OMX_IndexComponentStartUnused;
+  OMX_TIZONIA_PARAM_COMPONENTRESETTYPE reset;
+  OMX_TIZONIA_PERFCOUNTERSTYPE perf;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  OMX_U32 bufferCountActual = 0;
+  OMX_U64 messages = 0;
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetHandle (&p_hdl,
+                         COMPONENT_NAME, (OMX_PTR *) (&appData), &callBacks);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetExtensionIndex (p_hdl, OMX_TIZONIA_INDEX_PARAM_COMPONENTRESET,
+                                 &ext_index);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "OMX_GetExtensionIndex error  [%s] index [%s]",
+           tiz_err_to_str (error), tiz_idx_to_str (ext_index));
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TizoniaIndexParamComponentReset != ext_index);
+
+  error = OMX_GetExtensionIndex (p_hdl, OMX_TIZONIA_INDEX_CONFIG_PERFCOUNTERS,
+                                 &perf_index);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Change a port setting */
+  TIZ_INIT_OMX_PORT_STRUCT (port_def, 0);
+  error = OMX_GetParameter (p_hdl, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+  bufferCountActual = port_def.nBufferCountActual;
+  port_def.nBufferCountActual = bufferCountActual + 3;
+  error = OMX_SetParameter (p_hdl, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+
+  TIZ_INIT_OMX_PORT_STRUCT (perf, OMX_ALL);
+  error = OMX_GetConfig (p_hdl, perf_index, &perf);
+  fail_if (OMX_ErrorNone != error);
+  messages = perf.nMessages;
+  fail_if (0 == messages);
+
+  /* Reset the component */
+  TIZ_INIT_OMX_STRUCT (reset);
+  error = OMX_SetParameter (p_hdl, ext_index, &reset);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "OMX_SetParameter [%s]",
+           tiz_err_to_str (error));
+  fail_if (OMX_ErrorNone != error);
+
+  /* The port setting is back to its default value... */
+  TIZ_INIT_OMX_PORT_STRUCT (port_def, 0);
+  error = OMX_GetParameter (p_hdl, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (bufferCountActual != port_def.nBufferCountActual);
+
+  /* ... and the counters have been cleared */
+  TIZ_INIT_OMX_PORT_STRUCT (perf, OMX_ALL);
+  error = OMX_GetConfig (p_hdl, perf_index, &perf);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (perf.nMessages >= messages);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+}
+END_TEST
+
 START_TEST (test_tizonia_move_to_exe_and_transfer_with_allocbuffer)
 {
   OMX_ERRORTYPE error = OMX_ErrorNone;
@@ -905,6 +983,270 @@ START_TEST (test_tizonia_move_to_exe_and_transfer_with_allocbuffer)
 }
 END_TEST
 
+static double
+transfer_buffers (OMX_HANDLETYPE ap_hdl, cc_ctx_t * ap_ctx,
+                  OMX_BUFFERHEADERTYPE * ap_hdr, OMX_U32 a_nbufs,
+                  OMX_BOOL a_tunneled)
+{
+  check_common_context_t *p_ctx = *ap_ctx;
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_BOOL timedout = OMX_FALSE;
+  struct timeval start, end;
+  double secs = 0;
+  OMX_U32 i;
+
+  gettimeofday (&start, NULL);
+  for (i = 0; i < a_nbufs; ++i)
+    {
+      error = _ctx_reset (ap_ctx);
+      ap_hdr->nFilledLen = ap_hdr->nAllocLen;
+      error = (OMX_TRUE == a_tunneled
+               ? tiz_comp_tunneled_buffer (ap_hdl, ap_hdr, OMX_DirOutput)
+               : OMX_EmptyThisBuffer (ap_hdl, ap_hdr));
+      fail_if (OMX_ErrorNone != error);
+
+      /* Await BufferDone callback */
+      error = _ctx_wait (ap_ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+      fail_if (OMX_ErrorNone != error);
+      fail_if (OMX_TRUE == timedout);
+      fail_if (p_ctx->p_hdr != ap_hdr);
+    }
+  gettimeofday (&end, NULL);
+
+  secs = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+  return secs > 0 ? a_nbufs / secs : 0;
+}
+
+START_TEST (test_tizonia_tunneled_buffer_handoff_throughput)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  OMX_COMMANDTYPE cmd = OMX_CommandStateSet;
+  OMX_STATETYPE state = OMX_StateIdle;
+  cc_ctx_t ctx;
+  check_common_context_t *p_ctx = NULL;
+  OMX_BOOL timedout = OMX_FALSE;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  OMX_INDEXTYPE index = OMX_IndexParamPortDefinition;
+  OMX_BUFFERHEADERTYPE **p_hdrs = NULL;
+  OMX_INDEXTYPE perf_index = OMX_IndexComponentStartUnused;
+  OMX_TIZONIA_PERFCOUNTERSTYPE perf;
+  double msg_rate = 0;
+  double mbox_rate = 0;
+  OMX_U32 i;
+
+  error = _ctx_init (&ctx);
+  fail_if (OMX_ErrorNone != error);
+
+  p_ctx = (check_common_context_t *) (ctx);
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  /* Instantiate the component */
+  error = OMX_GetHandle (&p_hdl, COMPONENT_NAME, (OMX_PTR *) (&ctx),
+                         &_check_cbacks);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Obtain the port def params for port #0 */
+  port_def.nSize = sizeof (OMX_PARAM_PORTDEFINITIONTYPE);
+  port_def.nVersion.nVersion = OMX_VERSION;
+  port_def.nPortIndex = 0;
+  error = OMX_GetParameter (p_hdl, index, &port_def);
+  fail_if (OMX_ErrorNone != error);
+
+  p_hdrs = tiz_mem_calloc (port_def.nBufferCountActual,
+                           sizeof (OMX_BUFFERHEADERTYPE *));
+  fail_if (NULL == p_hdrs);
+
+  /* Initiate transition to IDLE */
+  error = OMX_SendCommand (p_hdl, cmd, state, NULL);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Allocate buffers */
+  for (i = 0; i < port_def.nBufferCountActual; ++i)
+    {
+      error = OMX_AllocateBuffer (p_hdl, &p_hdrs[i], 0, /* input port */
+                                  0, port_def.nBufferSize);
+      fail_if (OMX_ErrorNone != error);
+    }
+
+  /* Await transition callback */
+  error = _ctx_wait (&ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_StateIdle != p_ctx->state);
+
+  /* Initiate transition to EXE */
+  error = _ctx_reset (&ctx);
+  state = OMX_StateExecuting;
+  error = OMX_SendCommand (p_hdl, cmd, state, NULL);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Await transition callback */
+  error = _ctx_wait (&ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_StateExecuting != p_ctx->state);
+
+  /* Same header, same component: scheduler message path vs. the mailbox used
+     for tunneled hand-offs */
+  msg_rate = transfer_buffers (p_hdl, &ctx, p_hdrs[0],
+                               HANDOFF_BENCH_BUFFERS, OMX_FALSE);
+  mbox_rate = transfer_buffers (p_hdl, &ctx, p_hdrs[0],
+                                HANDOFF_BENCH_BUFFERS, OMX_TRUE);
+
+  fprintf (stderr,
+           "Buffer hand-off (%d buffers): "
+           "message path %.0f buffers/s, mailbox %.0f buffers/s\n",
+           HANDOFF_BENCH_BUFFERS, msg_rate, mbox_rate);
+
+  /* Both paths are accounted for in the component's counters */
+  error = OMX_GetExtensionIndex (p_hdl, OMX_TIZONIA_INDEX_CONFIG_PERFCOUNTERS,
+                                 &perf_index);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TizoniaIndexConfigPerfCounters != perf_index);
+
+  perf.nSize = sizeof (OMX_TIZONIA_PERFCOUNTERSTYPE);
+  perf.nVersion.nVersion = OMX_VERSION;
+  perf.nPortIndex = OMX_ALL;
+  error = OMX_GetConfig (p_hdl, perf_index, &perf);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (perf.nBuffers < 2 * HANDOFF_BENCH_BUFFERS);
+  fail_if (perf.nBytes < perf.nBuffers * port_def.nBufferSize);
+  fail_if (perf.nBuffersReadyCalls < 2 * HANDOFF_BENCH_BUFFERS);
+  fail_if (perf.nMessages < HANDOFF_BENCH_BUFFERS);
+  fail_if (0 == perf.nQueueHighWaterMark || 0 == perf.nMsgQueueHighWaterMark);
+
+  fprintf (stderr,
+           "Counters: %llu buffers, %llu buffers_ready calls (%llu us), "
+           "%llu messages (avg latency %.1f us, max %u us)\n",
+           (unsigned long long) perf.nBuffers,
+           (unsigned long long) perf.nBuffersReadyCalls,
+           (unsigned long long) perf.nBuffersReadyTime,
+           (unsigned long long) perf.nMessages,
+           (double) perf.nDispatchLatency / perf.nMessages,
+           (unsigned) perf.nDispatchLatencyMax);
+
+  perf.nPortIndex = 1000;
+  error = OMX_GetConfig (p_hdl, perf_index, &perf);
+  fail_if (OMX_ErrorBadPortIndex != error);
+
+  /* Initiate transition to IDLE */
+  error = _ctx_reset (&ctx);
+  state = OMX_StateIdle;
+  error = OMX_SendCommand (p_hdl, cmd, state, NULL);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Await transition callback */
+  error = _ctx_wait (&ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_StateIdle != p_ctx->state);
+
+  /* Initiate transition to LOADED */
+  error = _ctx_reset (&ctx);
+  state = OMX_StateLoaded;
+  error = OMX_SendCommand (p_hdl, cmd, state, NULL);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Deallocate buffers */
+  for (i = 0; i < port_def.nBufferCountActual; ++i)
+    {
+      error = OMX_FreeBuffer (p_hdl, 0, /* input port */
+                              p_hdrs[i]);
+      fail_if (OMX_ErrorNone != error);
+    }
+
+  /* Await transition callback */
+  error = _ctx_wait (&ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_StateLoaded != p_ctx->state);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+
+  tiz_mem_free (p_hdrs);
+  _ctx_destroy(&ctx);
+}
+END_TEST
+
+static double
+elapsed_ns (const struct timeval * ap_start, OMX_U32 a_ncalls)
+{
+  struct timeval end;
+  gettimeofday (&end, NULL);
+  return ((end.tv_sec - ap_start->tv_sec) * 1e9
+          + (end.tv_usec - ap_start->tv_usec) * 1e3)
+         / a_ncalls;
+}
+
+START_TEST (test_tizonia_selector_dispatch)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  cc_ctx_t ctx;
+  void *p_krn = NULL;
+  void *p_port = NULL;
+  struct timeval start;
+  volatile OMX_U32 sink = 0;
+  double selector_ns = 0;
+  double type_ns = 0;
+  OMX_U32 i;
+
+  error = _ctx_init (&ctx);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  /* Instantiate the component */
+  error = OMX_GetHandle (&p_hdl, COMPONENT_NAME, (OMX_PTR *) (&ctx),
+                         &_check_cbacks);
+  fail_if (OMX_ErrorNone != error);
+
+  p_krn = tiz_get_krn (p_hdl);
+  fail_if (NULL == p_krn);
+  p_port = tiz_krn_get_port (p_krn, 0);
+  fail_if (NULL == p_port);
+
+  /* Kernel and port selectors, as called once or more per buffer */
+  gettimeofday (&start, NULL);
+  for (i = 0; i < DISPATCH_BENCH_CALLS; ++i)
+    {
+      p_port = tiz_krn_get_port (p_krn, 0);
+      sink += tiz_port_index (p_port) + tiz_port_buffer_count (p_port)
+              + tiz_port_dir (p_port);
+    }
+  selector_ns = elapsed_ns (&start, DISPATCH_BENCH_CALLS);
+
+  /* Class lookup by name, as done by every super_* call */
+  gettimeofday (&start, NULL);
+  for (i = 0; i < DISPATCH_BENCH_CALLS; ++i)
+    {
+      sink += (NULL != tiz_get_type (p_hdl, "tizport"));
+    }
+  type_ns = elapsed_ns (&start, DISPATCH_BENCH_CALLS);
+
+  fprintf (stderr,
+           "Selector dispatch (%d calls): "
+           "get_port+index+buffer_count+dir %.1f ns, type lookup %.1f ns\n",
+           DISPATCH_BENCH_CALLS, selector_ns, type_ns);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+
+  _ctx_destroy(&ctx);
+}
+END_TEST
+
 START_TEST (test_tizonia_command_cancellation_loaded_to_idle_no_buffers)
 {
   OMX_ERRORTYPE error = OMX_ErrorNone;
@@ -2021,6 +2363,213 @@ START_TEST (test_tizonia_command_cancellation_disabled_to_enabled_with_tunneled_
 }
 END_TEST
 
+typedef struct check_nested_context check_nested_context_t;
+struct check_nested_context
+{
+  cc_ctx_t ctx;
+  OMX_HANDLETYPE p_peer;
+  OMX_ERRORTYPE peer_error;
+  OMX_STATETYPE peer_state;
+  OMX_U32 peer_buffer_count;
+};
+
+static OMX_ERRORTYPE
+check_nested_EventHandler (OMX_HANDLETYPE ap_hdl,
+                           OMX_PTR ap_app_data,
+                           OMX_EVENTTYPE eEvent,
+                           OMX_U32 nData1, OMX_U32 nData2, OMX_PTR pEventData)
+{
+  check_nested_context_t *p_nested = ap_app_data;
+  check_common_context_t *p_ctx = NULL;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+
+  assert (p_nested);
+  p_ctx = p_nested->ctx;
+
+  fail_if (OMX_EventCmdComplete != eEvent);
+  fail_if (OMX_CommandPortDisable != (OMX_COMMANDTYPE) (nData1)
+           && OMX_CommandPortEnable != (OMX_COMMANDTYPE) (nData1));
+
+  /* This runs on the (single) pool worker. The peer component can only
+     answer if the worker runs it in place while this callback blocks. */
+  p_nested->peer_error = OMX_GetState (p_nested->p_peer,
+                                       &(p_nested->peer_state));
+  if (OMX_ErrorNone == p_nested->peer_error)
+    {
+      port_def.nSize = sizeof (OMX_PARAM_PORTDEFINITIONTYPE);
+      port_def.nVersion.nVersion = OMX_VERSION;
+      port_def.nPortIndex = 0;
+      p_nested->peer_error = OMX_GetParameter (
+        p_nested->p_peer, OMX_IndexParamPortDefinition, &port_def);
+      p_nested->peer_buffer_count = port_def.nBufferCountActual;
+    }
+
+  p_ctx->port = nData2;
+  p_ctx->error = (OMX_ERRORTYPE) (pEventData);
+  _ctx_signal (&(p_nested->ctx));
+
+  return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE _check_nested_cbacks = {
+  check_nested_EventHandler,
+  check_EmptyBufferDone,
+  check_FillBufferDone
+};
+
+START_TEST (test_tizonia_pool_scheduler_blocking_calls)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  OMX_STATETYPE state = OMX_StateMax;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  cc_ctx_t ctx;
+  check_common_context_t *p_ctx = NULL;
+  OMX_BOOL timedout = OMX_FALSE;
+  OMX_U32 i;
+
+  /* This test runs in its own process; the platform re-reads its
+     configuration there, so every scheduler below is a pooled one */
+  putenv (TIZ_PLATFORM_POOL_RC_FILE_ENV);
+
+  error = _ctx_init (&ctx);
+  fail_if (OMX_ErrorNone != error);
+
+  p_ctx = (check_common_context_t *) (ctx);
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetHandle (&p_hdl, COMPONENT_NAME, (OMX_PTR *) (&ctx),
+                         &_check_cbacks);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetState (p_hdl, &state);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_StateLoaded != state);
+
+  port_def.nSize = sizeof (OMX_PARAM_PORTDEFINITIONTYPE);
+  port_def.nVersion.nVersion = OMX_VERSION;
+  port_def.nPortIndex = 0;
+  error = OMX_GetParameter (p_hdl, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+
+  /* Commands complete on the pool worker while this thread keeps on making
+     blocking calls on the same component */
+  for (i = 0; i < 100; ++i)
+    {
+      error = _ctx_reset (&ctx);
+      error = OMX_SendCommand (p_hdl, OMX_CommandPortDisable, 0, NULL);
+      fail_if (OMX_ErrorNone != error);
+      error = OMX_GetState (p_hdl, &state);
+      fail_if (OMX_ErrorNone != error);
+      fail_if (OMX_StateLoaded != state);
+      error = _ctx_wait (&ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+      fail_if (OMX_ErrorNone != error);
+      fail_if (OMX_TRUE == timedout);
+      fail_if (0 != p_ctx->port);
+      fail_if (OMX_ErrorNone != p_ctx->error);
+
+      error = _ctx_reset (&ctx);
+      error = OMX_SendCommand (p_hdl, OMX_CommandPortEnable, 0, NULL);
+      fail_if (OMX_ErrorNone != error);
+      error = _ctx_wait (&ctx, TIMEOUT_EXPECTING_SUCCESS, &timedout);
+      fail_if (OMX_ErrorNone != error);
+      fail_if (OMX_TRUE == timedout);
+      fail_if (0 != p_ctx->port);
+      fail_if (OMX_ErrorNone != p_ctx->error);
+    }
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+
+  _ctx_destroy(&ctx);
+}
+END_TEST
+
+START_TEST (test_tizonia_pool_scheduler_nested_blocking_call)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  OMX_HANDLETYPE p_hdl = 0;
+  OMX_HANDLETYPE p_peer = 0;
+  OMX_PARAM_PORTDEFINITIONTYPE port_def;
+  check_nested_context_t nested;
+  check_common_context_t *p_ctx = NULL;
+  cc_ctx_t peer_ctx;
+  OMX_BOOL timedout = OMX_FALSE;
+
+  putenv (TIZ_PLATFORM_POOL_RC_FILE_ENV);
+
+  error = _ctx_init (&(nested.ctx));
+  fail_if (OMX_ErrorNone != error);
+  error = _ctx_init (&peer_ctx);
+  fail_if (OMX_ErrorNone != error);
+
+  p_ctx = (check_common_context_t *) (nested.ctx);
+
+  error = OMX_Init ();
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_GetHandle (&p_peer, COMPONENT_NAME, (OMX_PTR *) (&peer_ctx),
+                         &_check_cbacks);
+  fail_if (OMX_ErrorNone != error);
+
+  nested.p_peer = p_peer;
+  nested.peer_error = OMX_ErrorMax;
+  nested.peer_state = OMX_StateMax;
+  nested.peer_buffer_count = 0;
+  error = OMX_GetHandle (&p_hdl, COMPONENT_NAME, (OMX_PTR) (&nested),
+                         &_check_nested_cbacks);
+  fail_if (OMX_ErrorNone != error);
+
+  port_def.nSize = sizeof (OMX_PARAM_PORTDEFINITIONTYPE);
+  port_def.nVersion.nVersion = OMX_VERSION;
+  port_def.nPortIndex = 0;
+  error = OMX_GetParameter (p_peer, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+
+  /* The command completes on the pool worker, whose callback calls into the
+     peer before returning */
+  error = OMX_SendCommand (p_hdl, OMX_CommandPortDisable, 0, NULL);
+  fail_if (OMX_ErrorNone != error);
+  error = _ctx_wait (&(nested.ctx), TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_ErrorNone != p_ctx->error);
+  fail_if (OMX_ErrorNone != nested.peer_error);
+  fail_if (OMX_StateLoaded != nested.peer_state);
+  fail_if (port_def.nBufferCountActual != nested.peer_buffer_count);
+
+  /* Once more, this time while this thread is also calling into the peer */
+  error = _ctx_reset (&(nested.ctx));
+  nested.peer_error = OMX_ErrorMax;
+  error = OMX_SendCommand (p_hdl, OMX_CommandPortEnable, 0, NULL);
+  fail_if (OMX_ErrorNone != error);
+  error = OMX_GetParameter (p_peer, OMX_IndexParamPortDefinition, &port_def);
+  fail_if (OMX_ErrorNone != error);
+  error = _ctx_wait (&(nested.ctx), TIMEOUT_EXPECTING_SUCCESS, &timedout);
+  fail_if (OMX_ErrorNone != error);
+  fail_if (OMX_TRUE == timedout);
+  fail_if (OMX_ErrorNone != p_ctx->error);
+  fail_if (OMX_ErrorNone != nested.peer_error);
+
+  error = OMX_FreeHandle (p_hdl);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_FreeHandle (p_peer);
+  fail_if (OMX_ErrorNone != error);
+
+  error = OMX_Deinit ();
+  fail_if (OMX_ErrorNone != error);
+
+  _ctx_destroy(&peer_ctx);
+  _ctx_destroy(&(nested.ctx));
+}
+END_TEST
+
 Suite *
 tiz_suite (void)
 {
@@ -2051,11 +2600,18 @@ tiz_suite (void)
   tcase_add_test (tc_tizonia, test_tizonia_getparameter);
   tcase_add_test (tc_tizonia, test_tizonia_roles);
   tcase_add_test (tc_tizonia, test_tizonia_preannouncements_extension);
+  tcase_add_test (tc_tizonia, test_tizonia_component_reset_extension);
   /* TEST DISABLED */
 /*   tcase_add_test (tc_tizonia, */
 /*                   test_tizonia_move_to_exe_and_transfer_with_allocbuffer); */
   tcase_add_test (tc_tizonia,
                   test_tizonia_command_cancellation_loaded_to_idle_no_buffers);
+  tcase_add_test (tc_tizonia,
+                  test_tizonia_tunneled_buffer_handoff_throughput);
+  tcase_add_test (tc_tizonia, test_tizonia_selector_dispatch);
+  tcase_add_test (tc_tizonia, test_tizonia_pool_scheduler_blocking_calls);
+  tcase_add_test (tc_tizonia,
+                  test_tizonia_pool_scheduler_nested_blocking_call);
   /* TEST DISABLED */
   /*   tcase_add_test (tc_tizonia, */
   /*                   test_tizonia_command_cancellation_loaded_to_idle_with_tunneled_supplied_buffers); */
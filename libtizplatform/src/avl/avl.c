@@ -36,12 +36,13 @@
 #include <stdlib.h>
 
 #include "avl.h"
+#include "../tizslab.h"
 
 avl_node *
 avl_new_avl_node (void *            key,
                   avl_node *        parent)
 {
-  avl_node * node = (avl_node *) malloc (sizeof (avl_node));
+  avl_node * node = (avl_node *) tiz_slab_alloc (sizeof (avl_node));
 
   if (!node) {
     return NULL;
@@ -61,14 +62,14 @@ avl_tree *
 avl_new_avl_tree (avl_key_compare_fun_type compare_fun,
                   void * compare_arg)
 {
-  avl_tree * t = (avl_tree *) malloc (sizeof (avl_tree));
+  avl_tree * t = (avl_tree *) tiz_slab_alloc (sizeof (avl_tree));
 
   if (!t) {
     return NULL;
   } else {
     avl_node * root = avl_new_avl_node((void *)NULL, (avl_node *) NULL);
     if (!root) {
-      free (t);
+      tiz_slab_free (t);
       return NULL;
     } else {
       t->root = root;
@@ -94,7 +95,7 @@ free_avl_tree_helper (avl_node * node, avl_free_key_fun_type free_key_fun)
   if (node->right) {
     free_avl_tree_helper (node->right, free_key_fun);
   }
-  free (node);
+  tiz_slab_free (node);
 }
 
 void
@@ -104,9 +105,9 @@ avl_free_avl_tree (avl_tree * tree, avl_free_key_fun_type free_key_fun)
     free_avl_tree_helper (tree->root->right, free_key_fun);
   }
   if (tree->root) {
-    free (tree->root);
+    tiz_slab_free (tree->root);
   }
-  free (tree);
+  tiz_slab_free (tree);
 }
 
 int
@@ -455,7 +456,7 @@ avl_remove_by_key (avl_tree * tree,
   if (free_key_fun) {
     free_key_fun (x->key);
   }
-  free (x);
+  tiz_slab_free (x);
 
   while (shorter && p->parent) {
 
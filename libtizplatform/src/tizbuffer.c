@@ -31,9 +31,13 @@
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 
 #include "tizmem.h"
 #include "tizlog.h"
@@ -52,6 +56,7 @@ struct tiz_buffer
   int filled_len;
   int offset;
   int seek_mode;
+  tiz_buffer_type_t type;
 };
 
 static long
@@ -61,23 +66,100 @@ abs_of (const long v)
   return (v + mask) ^ mask;
 }
 
+static inline bool
+store_ok (const tiz_buffer_t * ap_buf)
+{
+  /* In a ring, the data may extend into the mirror */
+  return (ETIZBufferTypeRing == ap_buf->type
+            ? (ap_buf->offset < ap_buf->alloc_len
+               && ap_buf->filled_len <= ap_buf->alloc_len)
+            : (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len)));
+}
+
+/* Maps the same pages twice, back to back. Returns NULL if not possible. */
+static unsigned char *
+map_ring (const size_t a_len)
+{
+  unsigned char * p_ring = NULL;
+#ifdef SYS_memfd_create
+  int fd = syscall (SYS_memfd_create, "tizbuffer", 0);
+  void * p_addr = MAP_FAILED;
+
+  if (fd < 0)
+    {
+      return NULL;
+    }
+
+  if (0 == ftruncate (fd, a_len)
+      && MAP_FAILED
+           != (p_addr = mmap (NULL, 2 * a_len, PROT_NONE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)))
+    {
+      unsigned char * p_lo = p_addr;
+      if (MAP_FAILED
+            != mmap (p_lo, a_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                     fd, 0)
+          && MAP_FAILED
+               != mmap (p_lo + a_len, a_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, fd, 0))
+        {
+          p_ring = p_lo;
+        }
+      else
+        {
+          (void) munmap (p_addr, 2 * a_len);
+        }
+    }
+  (void) close (fd);
+#else
+  (void) a_len;
+#endif
+  return p_ring;
+}
+
+static inline size_t
+ring_len (const size_t a_nbytes)
+{
+  const size_t page = sysconf (_SC_PAGESIZE);
+  size_t len = ((a_nbytes + page - 1) / page) * page;
+  return len > 0 ? len : page;
+}
+
 static inline void *
 alloc_data_store (tiz_buffer_t * ap_buf, const size_t nbytes)
 {
   assert (ap_buf);
   assert (NULL == ap_buf->p_store);
 
-  if (nbytes > 0)
+  if (ETIZBufferTypeRing == ap_buf->type)
     {
-      ap_buf->p_store = tiz_mem_calloc (1, nbytes);
-      if (ap_buf->p_store)
+      const size_t len = ring_len (nbytes);
+      if ((ap_buf->p_store = map_ring (len)))
+        {
+          ap_buf->alloc_len = len;
+        }
+      else
+        {
+          TIZ_LOG (TIZ_PRIORITY_NOTICE,
+                   "Unable to map a ring; using a heap store instead");
+          ap_buf->type = ETIZBufferTypeHeap;
+        }
+    }
+
+  if (ETIZBufferTypeHeap == ap_buf->type && nbytes > 0)
+    {
+      if ((ap_buf->p_store = tiz_mem_calloc (1, nbytes)))
         {
           ap_buf->alloc_len = nbytes;
-          ap_buf->filled_len = 0;
-          ap_buf->offset = 0;
-          ap_buf->seek_mode = TIZ_BUFFER_NON_SEEKABLE;
         }
     }
+
+  if (ap_buf->p_store)
+    {
+      ap_buf->filled_len = 0;
+      ap_buf->offset = 0;
+      ap_buf->seek_mode = TIZ_BUFFER_NON_SEEKABLE;
+    }
   return ap_buf->p_store;
 }
 
@@ -89,7 +171,17 @@ dealloc_data_store (
 {
   if (ap_buf)
     {
-      tiz_mem_free (ap_buf->p_store);
+      if (ETIZBufferTypeRing == ap_buf->type)
+        {
+          if (ap_buf->p_store)
+            {
+              (void) munmap (ap_buf->p_store, 2 * ap_buf->alloc_len);
+            }
+        }
+      else
+        {
+          tiz_mem_free (ap_buf->p_store);
+        }
       ap_buf->p_store = NULL;
       ap_buf->alloc_len = 0;
       ap_buf->filled_len = 0;
@@ -98,20 +190,90 @@ dealloc_data_store (
     }
 }
 
+/* Makes room for at least a_nbytes at the back of a ring. The data is only
+   copied when the ring needs to grow. */
+static bool
+make_ring_room (tiz_buffer_t * ap_buf, const size_t a_nbytes)
+{
+  size_t need = ap_buf->filled_len + a_nbytes;
+  unsigned char * p_new_ring = NULL;
+  size_t new_len = 0;
+
+  if (need <= (size_t) ap_buf->alloc_len)
+    {
+      return true;
+    }
+
+  new_len = ring_len (MAX (need, (size_t) ap_buf->alloc_len * 2));
+  if (new_len > INT_MAX || !(p_new_ring = map_ring (new_len)))
+    {
+      return false;
+    }
+
+  memcpy (p_new_ring, ap_buf->p_store + ap_buf->offset, ap_buf->filled_len);
+  (void) munmap (ap_buf->p_store, 2 * ap_buf->alloc_len);
+  ap_buf->p_store = p_new_ring;
+  ap_buf->alloc_len = new_len;
+  ap_buf->offset = 0;
+  return true;
+}
+
+/* Makes room for at least a_nbytes at the back of a heap store. */
+static bool
+make_heap_room (tiz_buffer_t * ap_buf, const size_t a_nbytes)
+{
+  size_t avail = ap_buf->alloc_len - (ap_buf->offset + ap_buf->filled_len);
+
+  if (a_nbytes > avail && ap_buf->seek_mode == TIZ_BUFFER_NON_SEEKABLE
+      && ap_buf->offset > 0)
+    {
+      memmove (ap_buf->p_store, (ap_buf->p_store + ap_buf->offset),
+               ap_buf->filled_len);
+      ap_buf->offset = 0;
+      avail = ap_buf->alloc_len - ap_buf->filled_len;
+    }
+
+  if (a_nbytes > avail)
+    {
+      OMX_U8 * p_new_store = NULL;
+      size_t need = MAX ((size_t) ap_buf->alloc_len * 2,
+                         ap_buf->offset + ap_buf->filled_len + a_nbytes);
+      if (!(p_new_store = tiz_mem_realloc (ap_buf->p_store, need)))
+        {
+          return false;
+        }
+      ap_buf->p_store = p_new_store;
+      ap_buf->alloc_len = need;
+    }
+  return true;
+}
+
+static inline size_t
+writable (const tiz_buffer_t * ap_buf)
+{
+  return (ETIZBufferTypeRing == ap_buf->type
+            ? ap_buf->alloc_len - ap_buf->filled_len
+            : ap_buf->alloc_len - (ap_buf->offset + ap_buf->filled_len));
+}
+
 OMX_ERRORTYPE
-tiz_buffer_init (/*@null@ */ tiz_buffer_ptr_t * app_buf, const size_t a_nbytes)
+tiz_buffer_init_with_type (/*@null@ */ tiz_buffer_ptr_t * app_buf,
+                           const size_t a_nbytes,
+                           const tiz_buffer_type_t a_type)
 {
   OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
   tiz_buffer_t * p_buf = NULL;
   void * p_store = NULL;
 
   assert (app_buf);
+  assert (a_type < ETIZBufferTypeMax);
 
   if (!(p_buf = tiz_mem_calloc (1, sizeof (tiz_buffer_t))))
     {
       goto end;
     }
 
+  p_buf->type = a_type;
   if (!(p_store = alloc_data_store (p_buf, a_nbytes)))
     {
       goto end;
@@ -135,6 +297,12 @@ end:
   return rc;
 }
 
+OMX_ERRORTYPE
+tiz_buffer_init (/*@null@ */ tiz_buffer_ptr_t * app_buf, const size_t a_nbytes)
+{
+  return tiz_buffer_init_with_type (app_buf, a_nbytes, ETIZBufferTypeHeap);
+}
+
 void
 tiz_buffer_destroy (tiz_buffer_t * ap_buf)
 {
@@ -145,6 +313,13 @@ tiz_buffer_destroy (tiz_buffer_t * ap_buf)
     }
 }
 
+tiz_buffer_type_t
+tiz_buffer_type (const tiz_buffer_t * ap_buf)
+{
+  assert (ap_buf);
+  return ap_buf->type;
+}
+
 int
 tiz_buffer_seek_mode (tiz_buffer_t * ap_buf, const int a_seek_mode)
 {
@@ -153,6 +328,12 @@ tiz_buffer_seek_mode (tiz_buffer_t * ap_buf, const int a_seek_mode)
       || a_seek_mode == TIZ_BUFFER_NON_SEEKABLE)
     {
       assert (ap_buf);
+      if (ETIZBufferTypeRing == ap_buf->type
+          && a_seek_mode == TIZ_BUFFER_SEEKABLE)
+        {
+          /* A ring only keeps the data that has not been consumed */
+          return -1;
+        }
       old_val = ap_buf->seek_mode;
       ap_buf->seek_mode = a_seek_mode;
     }
@@ -166,47 +347,83 @@ tiz_buffer_push (tiz_buffer_t * ap_buf, const void * ap_data,
   OMX_U32 nbytes_to_copy = 0;
 
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (store_ok (ap_buf));
 
   if (ap_data && a_nbytes > 0)
     {
-      size_t avail = 0;
-
-      if (ap_buf->seek_mode == TIZ_BUFFER_NON_SEEKABLE
-          && ap_buf->offset > 0)
+      if (ETIZBufferTypeRing == ap_buf->type)
         {
-          memmove (ap_buf->p_store, (ap_buf->p_store + ap_buf->offset),
-                   ap_buf->filled_len);
-          ap_buf->offset = 0;
+          (void) make_ring_room (ap_buf, a_nbytes);
         }
-
-      avail = ap_buf->alloc_len - (ap_buf->offset + ap_buf->filled_len);
-
-      if (a_nbytes > avail)
+      else
         {
-          /* need to re-alloc */
-          OMX_U8 * p_new_store = NULL;
-          size_t need = ap_buf->alloc_len * 2;
-          p_new_store = tiz_mem_realloc (ap_buf->p_store, need);
-          if (p_new_store)
-            {
-              ap_buf->p_store = p_new_store;
-              ap_buf->alloc_len = need;
-              avail = ap_buf->alloc_len - (ap_buf->offset + ap_buf->filled_len);
-            }
+          (void) make_heap_room (ap_buf, a_nbytes);
         }
-      nbytes_to_copy = MIN (avail, a_nbytes);
-      memcpy (ap_buf->p_store + ap_buf->offset + ap_buf->filled_len, ap_data, nbytes_to_copy);
+      nbytes_to_copy = MIN (writable (ap_buf), a_nbytes);
+      memcpy (ap_buf->p_store + ap_buf->offset + ap_buf->filled_len, ap_data,
+              nbytes_to_copy);
       ap_buf->filled_len += nbytes_to_copy;
     }
   return nbytes_to_copy;
 }
 
+void *
+tiz_buffer_reserve (tiz_buffer_t * ap_buf, const size_t a_nbytes)
+{
+  bool room = false;
+
+  assert (ap_buf);
+  assert (store_ok (ap_buf));
+
+  if (ETIZBufferTypeRing == ap_buf->type)
+    {
+      room = make_ring_room (ap_buf, a_nbytes);
+    }
+  else
+    {
+      room = make_heap_room (ap_buf, a_nbytes);
+    }
+
+  return room ? ap_buf->p_store + ap_buf->offset + ap_buf->filled_len : NULL;
+}
+
+int
+tiz_buffer_commit (tiz_buffer_t * ap_buf, const size_t a_nbytes)
+{
+  int nbytes = 0;
+
+  assert (ap_buf);
+  assert (store_ok (ap_buf));
+
+  nbytes = MIN (writable (ap_buf), a_nbytes);
+  ap_buf->filled_len += nbytes;
+  return nbytes;
+}
+
+int
+tiz_buffer_peek (const tiz_buffer_t * ap_buf, const size_t a_offset,
+                 void ** app_span)
+{
+  assert (ap_buf);
+  assert (app_span);
+  assert (store_ok (ap_buf));
+
+  if (a_offset >= (size_t) ap_buf->filled_len)
+    {
+      *app_span = NULL;
+      return 0;
+    }
+
+  /* Both store types keep the data available contiguous */
+  *app_span = ap_buf->p_store + ap_buf->offset + a_offset;
+  return ap_buf->filled_len - a_offset;
+}
+
 int
 tiz_buffer_available (const tiz_buffer_t * ap_buf)
 {
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (store_ok (ap_buf));
   return ap_buf->filled_len;
 }
 
@@ -214,7 +431,7 @@ int
 tiz_buffer_offset (const tiz_buffer_t * ap_buf)
 {
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (store_ok (ap_buf));
   return ap_buf->offset;
 }
 
@@ -222,7 +439,7 @@ void *
 tiz_buffer_get (const tiz_buffer_t * ap_buf)
 {
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (store_ok (ap_buf));
   return (ap_buf->p_store + ap_buf->offset);
 }
 
@@ -236,16 +453,47 @@ tiz_buffer_advance (tiz_buffer_t * ap_buf, const int nbytes)
       min_nbytes = MIN (nbytes, tiz_buffer_available (ap_buf));
       ap_buf->offset += min_nbytes;
       ap_buf->filled_len -= min_nbytes;
+      if (ETIZBufferTypeRing == ap_buf->type
+          && ap_buf->offset >= ap_buf->alloc_len)
+        {
+          ap_buf->offset -= ap_buf->alloc_len;
+        }
     }
   return min_nbytes;
 }
 
+static int
+ring_seek (tiz_buffer_t * ap_buf, const long offset, const int whence)
+{
+  /* Only the data that has not been consumed yet is reachable */
+  if (whence == TIZ_BUFFER_SEEK_CUR && offset >= 0)
+    {
+      (void) tiz_buffer_advance (ap_buf, MIN (offset, ap_buf->filled_len));
+      return 0;
+    }
+  else if (whence == TIZ_BUFFER_SEEK_END && offset < 0)
+    {
+      const long r = abs_of (offset);
+      if (r < ap_buf->filled_len)
+        {
+          (void) tiz_buffer_advance (ap_buf, ap_buf->filled_len - r);
+        }
+      return 0;
+    }
+  return -1;
+}
+
 int
 tiz_buffer_seek (tiz_buffer_t * ap_buf, const long offset, const int whence)
 {
   int rc = -1;
   assert (ap_buf);
-  assert (ap_buf->alloc_len >= (ap_buf->offset + ap_buf->filled_len));
+  assert (store_ok (ap_buf));
+
+  if (ETIZBufferTypeRing == ap_buf->type)
+    {
+      return ring_seek (ap_buf, offset, whence);
+    }
 
   int total = ap_buf->offset + ap_buf->filled_len;
   if (whence == TIZ_BUFFER_SEEK_SET)
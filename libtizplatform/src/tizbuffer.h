@@ -66,6 +66,22 @@ extern "C" {
 typedef struct tiz_buffer tiz_buffer_t;
 typedef /*@null@ */ tiz_buffer_t * tiz_buffer_ptr_t;
 
+/**
+ * The data store implementations.
+ * @ingroup tizbuffer
+ */
+typedef enum tiz_buffer_type {
+  ETIZBufferTypeHeap, /**< A heap block. Consumed data is discarded by moving
+                         the remaining data to the front of the store. */
+  ETIZBufferTypeRing, /**< A ring mapped twice in consecutive virtual
+                         addresses, so that the data available is always
+                         contiguous and is never moved. Only
+                         TIZ_BUFFER_NON_SEEKABLE mode is supported. Falls back
+                         to ETIZBufferTypeHeap where the mirroring is not
+                         possible. */
+  ETIZBufferTypeMax
+} tiz_buffer_type_t;
+
 /**
  * Create a new dynamic buffer object.
  *
@@ -77,6 +93,31 @@ typedef /*@null@ */ tiz_buffer_t * tiz_buffer_ptr_t;
 OMX_ERRORTYPE
 tiz_buffer_init (/*@null@ */ tiz_buffer_ptr_t * app_buf, const size_t a_nbytes);
 
+/**
+ * Create a new dynamic buffer object with the specified type of data store.
+ *
+ * @ingroup tizbuffer
+ * @param app_buf A dynamic buffer handle to be initialised.
+ * @param a_nbytes Initial size of the data store (rounded up to a multiple of
+ * the page size with ETIZBufferTypeRing).
+ * @param a_type The data store implementation to use.
+ * @return OMX_ErrorNone if success, OMX_ErrorUndefined otherwise.
+ */
+OMX_ERRORTYPE
+tiz_buffer_init_with_type (/*@null@ */ tiz_buffer_ptr_t * app_buf,
+                           const size_t a_nbytes,
+                           const tiz_buffer_type_t a_type);
+
+/**
+ * Retrieve the type of the data store in use.
+ *
+ * @ingroup tizbuffer
+ * @param ap_buf The dynamic buffer handle.
+ * @return The data store type.
+ */
+tiz_buffer_type_t
+tiz_buffer_type (const tiz_buffer_t * ap_buf);
+
 /**
  * Destroy a dynamic buffer object.
  *
@@ -111,6 +152,48 @@ int
 tiz_buffer_push (tiz_buffer_t * ap_buf, const void * ap_data,
                  const size_t a_nbytes);
 
+/**
+ * @brief Obtain space at the back of the buffer to write into directly.
+ *
+ * The data store is grown if needed. The space becomes part of the data
+ * available once tiz_buffer_commit is called. Any other operation on the
+ * buffer invalidates the pointer returned.
+ *
+ * @ingroup tizbuffer
+ * @param ap_buf The dynamic buffer handle.
+ * @param a_nbytes The minimum number of contiguous bytes needed.
+ * @return The pointer to the first writable byte, or NULL if the space could
+ * not be made available.
+ */
+void *
+tiz_buffer_reserve (tiz_buffer_t * ap_buf, const size_t a_nbytes);
+
+/**
+ * @brief Append data previously written into the space returned by
+ * tiz_buffer_reserve.
+ *
+ * @ingroup tizbuffer
+ * @param ap_buf The dynamic buffer handle.
+ * @param a_nbytes The number of bytes written.
+ * @return The number of bytes actually appended.
+ */
+int
+tiz_buffer_commit (tiz_buffer_t * ap_buf, const size_t a_nbytes);
+
+/**
+ * @brief Access the data available without consuming it.
+ *
+ * @ingroup tizbuffer
+ * @param ap_buf The dynamic buffer handle.
+ * @param a_offset Offset from the current position.
+ * @param app_span On return, the pointer to the data at the offset.
+ * @return The number of contiguous bytes available from the offset (zero if
+ * the offset is beyond the data available).
+ */
+int
+tiz_buffer_peek (const tiz_buffer_t * ap_buf, const size_t a_offset,
+                 void ** app_span);
+
 /**
  * @brief Reset the position marker.
  *
@@ -35,6 +35,7 @@
 #include <string.h>
 #include <assert.h>
 #include <pthread.h>
+#include <unistd.h>
 
 #include "tizplatform.h"
 #include "tizplatform_internal.h"
@@ -66,6 +67,8 @@
 #endif
 
 #define TIZ_EVENT_LOOP_THREAD_NAME "evloop"
+#define TIZ_EVENT_LOOP_MAX_THREADS 64
+#define TIZ_EVENT_BATCH_MAX_CMDS 32
 
 struct tiz_event_io
 {
@@ -77,6 +80,7 @@ struct tiz_event_io
   uint32_t id;
   int fd;
   bool started;
+  tiz_event_loop_t * p_lp;
 };
 
 struct tiz_event_timer
@@ -88,6 +92,7 @@ struct tiz_event_timer
   bool once;
   uint32_t id;
   bool started;
+  tiz_event_loop_t * p_lp;
 };
 
 struct tiz_event_stat
@@ -98,6 +103,7 @@ struct tiz_event_stat
   void * p_arg1;
   uint32_t id;
   bool started;
+  tiz_event_loop_t * p_lp;
 };
 
 typedef enum tiz_event_loop_state tiz_event_loop_state_t;
@@ -110,22 +116,37 @@ enum tiz_event_loop_state
   ETIZEventLoopStateStopped
 };
 
-typedef struct tiz_event_loop tiz_event_loop_t;
 struct tiz_event_loop
 {
   tiz_thread_t thread;
   tiz_mutex_t mutex;
   tiz_sem_t sem;
   tiz_pqueue_t * p_pq;
-  tiz_soa_t * p_soa;
   ev_async * p_async_watcher;
   struct ev_loop * p_loop;
   tiz_event_loop_state_t state;
+  const void * p_affinity; /* Set when bound to a client thread */
+  uint64_t next_seq;
+  tiz_event_loop_t * p_next;
+};
+
+/* The set of event loops in the process. Watchers are assigned to a loop when
+   they are initialised, according to the affinity key passed as 'arg0'
+   (normally the component handle). Keys that have been bound to a loop with
+   tiz_event_loop_bind are served by that loop; the rest are spread across the
+   pool of loop threads. */
+typedef struct tiz_event_reactor tiz_event_reactor_t;
+struct tiz_event_reactor
+{
+  tiz_event_loop_t ** pp_loops;
+  OMX_U32 nloops;
+  tiz_mutex_t mutex; /* Protects the list of bound loops */
+  tiz_event_loop_t * p_bound;
   tiz_rcfile_t * p_rcfile;
 };
 
 static pthread_once_t g_event_loop_once = PTHREAD_ONCE_INIT;
-static tiz_event_loop_t * gp_event_loop = NULL;
+static tiz_event_reactor_t * gp_reactor = NULL;
 
 typedef enum tiz_event_loop_msg_class tiz_event_loop_msg_class_t;
 enum tiz_event_loop_msg_class
@@ -172,6 +193,7 @@ struct tiz_event_loop_msg
 {
   tiz_event_loop_msg_class_t class;
   OMX_S32 priority;
+  uint64_t seq; /* Submission order within the loop */
   union
   {
     tiz_event_loop_msg_io_t io;
@@ -180,30 +202,51 @@ struct tiz_event_loop_msg
   };
 };
 
+/* A watcher command that has been issued inside a batch but not yet posted to
+   its loop */
+typedef struct tiz_event_batch_cmd tiz_event_batch_cmd_t;
+struct tiz_event_batch_cmd
+{
+  tiz_event_loop_t * p_lp; /* NULL once posted or coalesced away */
+  tiz_event_loop_msg_class_t class;
+  void * p_watcher;
+  uint32_t id;
+};
+
+typedef struct tiz_event_batch tiz_event_batch_t;
+struct tiz_event_batch
+{
+  int depth;
+  size_t count;
+  tiz_event_batch_cmd_t cmds[TIZ_EVENT_BATCH_MAX_CMDS];
+};
+
+static __thread tiz_event_batch_t g_batch;
+
 /* Forward declarations */
 static OMX_ERRORTYPE
-do_io_start (tiz_event_loop_msg_t *);
+do_io_start (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_io_stop (tiz_event_loop_msg_t *);
+do_io_stop (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_io_destroy (tiz_event_loop_msg_t *);
+do_io_destroy (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_timer_start (tiz_event_loop_msg_t *);
+do_timer_start (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_timer_restart (tiz_event_loop_msg_t *);
+do_timer_restart (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_timer_stop (tiz_event_loop_msg_t *);
+do_timer_stop (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_timer_destroy (tiz_event_loop_msg_t *);
+do_timer_destroy (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_stat_start (tiz_event_loop_msg_t *);
+do_stat_start (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_stat_stop (tiz_event_loop_msg_t *);
+do_stat_stop (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 static OMX_ERRORTYPE
-do_stat_destroy (tiz_event_loop_msg_t *);
+do_stat_destroy (tiz_event_loop_t *, tiz_event_loop_msg_t *);
 
 typedef OMX_ERRORTYPE (*tiz_event_loop_msg_dispatch_f) (
-  tiz_event_loop_msg_t * ap_msg);
+  tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg);
 static const tiz_event_loop_msg_dispatch_f tiz_event_loop_msg_to_fnt_tbl[] = {
   do_io_start,
   do_io_stop,
@@ -221,7 +264,7 @@ static const tiz_event_loop_msg_dispatch_f tiz_event_loop_msg_to_fnt_tbl[] = {
 };
 
 static void
-dispatch_msg (tiz_event_loop_msg_t * ap_msg);
+dispatch_msg (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg);
 
 typedef struct tiz_event_loop_msg_str tiz_event_loop_msg_str_t;
 struct tiz_event_loop_msg_str
@@ -276,8 +319,8 @@ init_event_loop_msg (tiz_event_loop_t * ap_event_loop,
   assert (ap_event_loop);
   assert (a_msg_class < ETIZEventLoopMsgMax);
 
-  if (!(p_msg = (tiz_event_loop_msg_t *) tiz_soa_calloc (
-          ap_event_loop->p_soa, sizeof (tiz_event_loop_msg_t))))
+  if (!(p_msg = (tiz_event_loop_msg_t *) tiz_slab_calloc (
+          sizeof (tiz_event_loop_msg_t))))
     {
       TIZ_LOG (TIZ_PRIORITY_ERROR,
                "[OMX_ErrorInsufficientResources] : "
@@ -327,136 +370,228 @@ init_event_loop_msg (tiz_event_loop_t * ap_event_loop,
 /*@end@*/
 /* NOTE: Stop ignoring splint warnings in this section  */
 
+/* Allocates and queues a command. Must be called with the loop's mutex
+   held. */
 static OMX_ERRORTYPE
-enqueue_io_msg (tiz_event_io_t * ap_ev_io, const uint32_t a_id,
-                const tiz_event_loop_msg_class_t a_class)
+post_msg (tiz_event_loop_t * ap_lp, const tiz_event_loop_msg_class_t a_class,
+          void * ap_watcher, const uint32_t a_id)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorUndefined;
   tiz_event_loop_msg_t * p_msg = NULL;
-  tiz_event_loop_msg_io_t * p_msg_io = NULL;
-
-  assert (ap_ev_io);
-  assert (ETIZEventLoopMsgIoStart == a_class
-          || ETIZEventLoopMsgIoStop == a_class
-          || ETIZEventLoopMsgIoDestroy == a_class);
-
-  tiz_check_omx (tiz_mutex_lock (&(gp_event_loop->mutex)));
-  tiz_goto_end_on_null (
-    (p_msg = init_event_loop_msg (gp_event_loop, (a_class))),
-    "Failed to initialise the event loop");
-
-  assert (p_msg);
-  p_msg_io = &(p_msg->io);
-  p_msg_io->p_ev_io = ap_ev_io;
-  p_msg_io->id = a_id;
-  tiz_goto_end_on_omx_err (
-    (rc = tiz_pqueue_send (gp_event_loop->p_pq, p_msg, p_msg->priority)),
-    "Failed to insert into the queue");
-  tiz_check_omx (tiz_mutex_unlock (&(gp_event_loop->mutex)));
-  ev_async_send (gp_event_loop->p_loop, gp_event_loop->p_async_watcher);
 
-  /* All good */
-  rc = OMX_ErrorNone;
+  assert (ap_lp);
+  assert (ap_watcher);
 
- end:
+  tiz_check_null_ret_oom ((p_msg = init_event_loop_msg (ap_lp, a_class)));
 
-  if (OMX_ErrorNone != rc)
+  if (a_class < ETIZEventLoopMsgIoAny)
+    {
+      p_msg->io.p_ev_io = ap_watcher;
+      p_msg->io.id = a_id;
+    }
+  else if (a_class < ETIZEventLoopMsgTimerAny)
+    {
+      p_msg->timer.p_ev_timer = ap_watcher;
+      p_msg->timer.id = a_id;
+    }
+  else
     {
-      tiz_check_omx (tiz_mutex_unlock (&(gp_event_loop->mutex)));
+      p_msg->stat.p_ev_stat = ap_watcher;
+      p_msg->stat.id = a_id;
     }
+  p_msg->seq = ap_lp->next_seq++;
 
-  return OMX_ErrorNone;
+  return tiz_pqueue_send (ap_lp->p_pq, p_msg, p_msg->priority);
 }
 
-static OMX_ERRORTYPE
-enqueue_timer_msg (tiz_event_timer_t * ap_ev_timer, const uint32_t a_id,
-                   const tiz_event_loop_msg_class_t a_class)
+static inline bool
+is_start_class (const tiz_event_loop_msg_class_t a_class)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorUndefined;
-  tiz_event_loop_msg_t * p_msg = NULL;
-  tiz_event_loop_msg_timer_t * p_msg_timer = NULL;
-
-  assert (ap_ev_timer);
-  assert (ETIZEventLoopMsgTimerStart == a_class
-          || ETIZEventLoopMsgTimerStop == a_class
+  return (ETIZEventLoopMsgIoStart == a_class
+          || ETIZEventLoopMsgTimerStart == a_class
           || ETIZEventLoopMsgTimerRestart == a_class
-          || ETIZEventLoopMsgTimerDestroy == a_class);
+          || ETIZEventLoopMsgStatStart == a_class);
+}
 
-  tiz_check_omx (tiz_mutex_lock (&(gp_event_loop->mutex)));
-  tiz_goto_end_on_null (
-    (p_msg = init_event_loop_msg (gp_event_loop, (a_class))),
-    "Failed to initialise the event loop");
+static inline bool
+is_stop_class (const tiz_event_loop_msg_class_t a_class)
+{
+  return (ETIZEventLoopMsgIoStop == a_class
+          || ETIZEventLoopMsgTimerStop == a_class
+          || ETIZEventLoopMsgStatStop == a_class);
+}
 
-  assert (p_msg);
-  p_msg_timer = &(p_msg->timer);
-  p_msg_timer->p_ev_timer = ap_ev_timer;
-  p_msg_timer->id = a_id;
-  tiz_goto_end_on_omx_err (
-    (rc = tiz_pqueue_send (gp_event_loop->p_pq, p_msg, p_msg->priority)),
-    "Failed to insert into the queue");
-  tiz_check_omx (tiz_mutex_unlock (&(gp_event_loop->mutex)));
-  ev_async_send (gp_event_loop->p_loop, gp_event_loop->p_async_watcher);
+static inline bool
+is_destroy_class (const tiz_event_loop_msg_class_t a_class)
+{
+  return (ETIZEventLoopMsgIoDestroy == a_class
+          || ETIZEventLoopMsgTimerDestroy == a_class
+          || ETIZEventLoopMsgStatDestroy == a_class);
+}
 
-  /* All good */
-  rc = OMX_ErrorNone;
+static OMX_ERRORTYPE
+flush_batch (tiz_event_batch_t * ap_batch)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  tiz_event_loop_t * p_lp = NULL;
+  size_t i = 0;
+  size_t j = 0;
 
- end:
+  assert (ap_batch);
 
-  if (OMX_ErrorNone != rc)
+  /* One lock and one wake-up per loop, instead of one per command */
+  for (i = 0; i < ap_batch->count; ++i)
     {
-      tiz_check_omx (tiz_mutex_unlock (&(gp_event_loop->mutex)));
+      if (!(p_lp = ap_batch->cmds[i].p_lp))
+        {
+          /* Already posted, or coalesced away */
+          continue;
+        }
+
+      (void) tiz_mutex_lock (&(p_lp->mutex));
+      for (j = i; j < ap_batch->count; ++j)
+        {
+          tiz_event_batch_cmd_t * p_cmd = &(ap_batch->cmds[j]);
+          if (p_cmd->p_lp == p_lp)
+            {
+              if (OMX_ErrorNone == rc)
+                {
+                  rc = post_msg (p_lp, p_cmd->class, p_cmd->p_watcher,
+                                 p_cmd->id);
+                }
+              p_cmd->p_lp = NULL;
+            }
+        }
+      (void) tiz_mutex_unlock (&(p_lp->mutex));
+      ev_async_send (p_lp->p_loop, p_lp->p_async_watcher);
     }
 
+  ap_batch->count = 0;
   return rc;
 }
 
+/* Adds a command to the calling thread's open batch, dropping the commands
+   it makes redundant */
 static OMX_ERRORTYPE
-enqueue_stat_msg (tiz_event_stat_t * ap_ev_stat, const uint32_t a_id,
-                  const tiz_event_loop_msg_class_t a_class)
+add_to_batch (tiz_event_batch_t * ap_batch, tiz_event_loop_t * ap_lp,
+              const tiz_event_loop_msg_class_t a_class, void * ap_watcher,
+              const uint32_t a_id)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorUndefined;
-  tiz_event_loop_msg_t * p_msg = NULL;
-  tiz_event_loop_msg_stat_t * p_msg_stat = NULL;
+  tiz_event_batch_cmd_t * p_cmd = NULL;
+  size_t i = 0;
 
-  assert (ap_ev_stat);
-  assert (ETIZEventLoopMsgStatStart == a_class
-          || ETIZEventLoopMsgStatStop == a_class
-          || ETIZEventLoopMsgStatDestroy == a_class);
+  assert (ap_batch);
+
+  for (i = 0; i < ap_batch->count; ++i)
+    {
+      p_cmd = &(ap_batch->cmds[i]);
+      if (p_cmd->p_lp && p_cmd->p_watcher == ap_watcher)
+        {
+          if (is_destroy_class (a_class)
+              || (is_stop_class (a_class) && is_start_class (p_cmd->class)))
+            {
+              /* The watcher will not run; forget the earlier start (or any
+                 earlier command, in the case of a destroy) */
+              p_cmd->p_lp = NULL;
+            }
+        }
+    }
 
-  tiz_check_omx (tiz_mutex_lock (&(gp_event_loop->mutex)));
-  tiz_goto_end_on_null ((p_msg = init_event_loop_msg (gp_event_loop, (a_class))),
-                        "Failed to initialise the event loop");
+  /* A stop right after another stop is a no-op */
+  if (is_stop_class (a_class) && ap_batch->count > 0)
+    {
+      p_cmd = &(ap_batch->cmds[ap_batch->count - 1]);
+      if (p_cmd->p_lp && p_cmd->p_watcher == ap_watcher
+          && p_cmd->class == a_class)
+        {
+          return OMX_ErrorNone;
+        }
+    }
 
-  assert (p_msg);
-  p_msg_stat = &(p_msg->stat);
-  p_msg_stat->p_ev_stat = ap_ev_stat;
-  p_msg_stat->id = a_id;
-  tiz_goto_end_on_omx_err (
-    (rc = tiz_pqueue_send (gp_event_loop->p_pq, p_msg, p_msg->priority)),
-    "Failed to insert into the queue");
-  tiz_check_omx (tiz_mutex_unlock (&(gp_event_loop->mutex)));
-  ev_async_send (gp_event_loop->p_loop, gp_event_loop->p_async_watcher);
+  if (ap_batch->count >= TIZ_EVENT_BATCH_MAX_CMDS)
+    {
+      tiz_check_omx (flush_batch (ap_batch));
+    }
 
-  /* All good */
-  rc = OMX_ErrorNone;
+  p_cmd = &(ap_batch->cmds[ap_batch->count++]);
+  p_cmd->p_lp = ap_lp;
+  p_cmd->class = a_class;
+  p_cmd->p_watcher = ap_watcher;
+  p_cmd->id = a_id;
+
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+enqueue_msg (tiz_event_loop_t * ap_lp, const tiz_event_loop_msg_class_t a_class,
+             void * ap_watcher, const uint32_t a_id)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_lp);
+  assert (ap_watcher);
+
+  if (g_batch.depth > 0)
+    {
+      return add_to_batch (&g_batch, ap_lp, a_class, ap_watcher, a_id);
+    }
 
- end:
+  tiz_check_omx (tiz_mutex_lock (&(ap_lp->mutex)));
+  rc = post_msg (ap_lp, a_class, ap_watcher, a_id);
+  tiz_check_omx (tiz_mutex_unlock (&(ap_lp->mutex)));
 
   if (OMX_ErrorNone != rc)
     {
-      tiz_check_omx (tiz_mutex_unlock (&(gp_event_loop->mutex)));
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "[%s] : Failed to insert into the queue",
+               tiz_err_to_str (rc));
+      return rc;
     }
 
+  ev_async_send (ap_lp->p_loop, ap_lp->p_async_watcher);
   return OMX_ErrorNone;
 }
 
+static OMX_ERRORTYPE
+enqueue_io_msg (tiz_event_io_t * ap_ev_io, const uint32_t a_id,
+                const tiz_event_loop_msg_class_t a_class)
+{
+  assert (ap_ev_io);
+  assert (ETIZEventLoopMsgIoStart == a_class
+          || ETIZEventLoopMsgIoStop == a_class
+          || ETIZEventLoopMsgIoDestroy == a_class);
+  return enqueue_msg (ap_ev_io->p_lp, a_class, ap_ev_io, a_id);
+}
+
+static OMX_ERRORTYPE
+enqueue_timer_msg (tiz_event_timer_t * ap_ev_timer, const uint32_t a_id,
+                   const tiz_event_loop_msg_class_t a_class)
+{
+  assert (ap_ev_timer);
+  assert (ETIZEventLoopMsgTimerStart == a_class
+          || ETIZEventLoopMsgTimerStop == a_class
+          || ETIZEventLoopMsgTimerRestart == a_class
+          || ETIZEventLoopMsgTimerDestroy == a_class);
+  return enqueue_msg (ap_ev_timer->p_lp, a_class, ap_ev_timer, a_id);
+}
+
+static OMX_ERRORTYPE
+enqueue_stat_msg (tiz_event_stat_t * ap_ev_stat, const uint32_t a_id,
+                  const tiz_event_loop_msg_class_t a_class)
+{
+  assert (ap_ev_stat);
+  assert (ETIZEventLoopMsgStatStart == a_class
+          || ETIZEventLoopMsgStatStop == a_class
+          || ETIZEventLoopMsgStatDestroy == a_class);
+  return enqueue_msg (ap_ev_stat->p_lp, a_class, ap_ev_stat, a_id);
+}
+
 static void
-dispatch_msg (tiz_event_loop_msg_t * ap_msg)
+dispatch_msg (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
+  assert (ap_lp);
   assert (ap_msg);
   assert (ap_msg->class < ETIZEventLoopMsgMax);
 
-  (void) tiz_event_loop_msg_to_fnt_tbl[ap_msg->class](ap_msg);
+  (void) tiz_event_loop_msg_to_fnt_tbl[ap_msg->class](ap_lp, ap_msg);
 }
 
 static OMX_S32
@@ -598,15 +733,58 @@ ev_stat_msg_dequeue (void * ap_elem, OMX_S32 a_data1, void * ap_data2)
   return rc;
 }
 
+static void *
+msg_watcher (const tiz_event_loop_msg_t * ap_msg)
+{
+  assert (ap_msg);
+  if (ap_msg->class < ETIZEventLoopMsgIoAny)
+    {
+      return ap_msg->io.p_ev_io;
+    }
+  else if (ap_msg->class < ETIZEventLoopMsgTimerAny)
+    {
+      return ap_msg->timer.p_ev_timer;
+    }
+  return ap_msg->stat.p_ev_stat;
+}
+
+static OMX_BOOL
+ev_msg_superseded (void * ap_elem, OMX_S32 a_data1, void * ap_data2)
+{
+  tiz_event_loop_msg_t * p_msg = ap_elem;
+  tiz_event_loop_msg_t * p_stop_msg = ap_data2;
+  (void) a_data1;
+
+  assert (p_msg);
+  assert (p_stop_msg);
+
+  /* A start that was requested before this stop (but that, due to its lower
+     priority, is still in the queue) must not run */
+  if (is_start_class (p_msg->class) && p_msg->seq < p_stop_msg->seq
+      && msg_watcher (p_msg) == msg_watcher (p_stop_msg))
+    {
+      tiz_slab_free (p_msg);
+      return OMX_TRUE;
+    }
+  return OMX_FALSE;
+}
+
+static void
+remove_superseded_starts (tiz_event_loop_t * ap_lp,
+                          tiz_event_loop_msg_t * ap_stop_msg)
+{
+  tiz_pqueue_remove_func (ap_lp->p_pq, ev_msg_superseded, 0, ap_stop_msg);
+}
+
 static OMX_ERRORTYPE
-do_io_start (tiz_event_loop_msg_t * ap_msg)
+do_io_start (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_io_t * p_msg_io = NULL;
   tiz_event_io_t * p_ev_io = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_io = &(ap_msg->io);
   assert (p_msg_io);
@@ -624,20 +802,20 @@ do_io_start (tiz_event_loop_msg_t * ap_msg)
       assert (!p_ev_io->started);
     }
   p_ev_io->started = true;
-  ev_io_start (gp_event_loop->p_loop, (ev_io *) (p_ev_io));
+  ev_io_start (ap_lp->p_loop, (ev_io *) (p_ev_io));
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_io_stop (tiz_event_loop_msg_t * ap_msg)
+do_io_stop (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_io_t * p_msg_io = NULL;
   tiz_event_io_t * p_ev_io = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_io = &(ap_msg->io);
   assert (p_msg_io);
@@ -646,30 +824,24 @@ do_io_stop (tiz_event_loop_msg_t * ap_msg)
   if (p_ev_io->started)
     {
       /* The io watcher has been started, let's stop it */
-      ev_io_stop (gp_event_loop->p_loop, (ev_io *) (p_ev_io));
+      ev_io_stop (ap_lp->p_loop, (ev_io *) (p_ev_io));
       p_ev_io->started = false;
     }
-  else
-    {
-      /* This io watcher hasn't been started, let's make sure there are no
-         start requests left behind in the queue */
-      const tiz_event_loop_msg_class_t class_to_be_deleted
-        = ETIZEventLoopMsgIoStart;
-      tiz_pqueue_remove_func (gp_event_loop->p_pq, ev_io_msg_dequeue,
-                              (OMX_S32) class_to_be_deleted, p_ev_io);
-    }
+  /* Make sure there are no earlier start requests left behind in the queue
+     (regardless of the id they were issued with) */
+  remove_superseded_starts (ap_lp, ap_msg);
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_io_destroy (tiz_event_loop_msg_t * ap_msg)
+do_io_destroy (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_io_t * p_msg_io = NULL;
   tiz_event_io_t * p_ev_io = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_io = &(ap_msg->io);
   assert (p_msg_io);
@@ -678,33 +850,33 @@ do_io_destroy (tiz_event_loop_msg_t * ap_msg)
   if (p_ev_io->started)
     {
       /* The io watcher has been started, let's stop it */
-      ev_io_stop (gp_event_loop->p_loop, (ev_io *) (p_ev_io));
+      ev_io_stop (ap_lp->p_loop, (ev_io *) (p_ev_io));
     }
 
   {
     /* Now remove any references to this watcher that might be present in the
        queue */
     tiz_event_loop_msg_class_t class_to_be_deleted = ETIZEventLoopMsgIoAny;
-    tiz_pqueue_remove_func (gp_event_loop->p_pq, ev_io_msg_dequeue,
+    tiz_pqueue_remove_func (ap_lp->p_pq, ev_io_msg_dequeue,
                             (OMX_S32) class_to_be_deleted, p_ev_io);
   }
 
   /* And now it should be safe to delete the io event */
-  tiz_mem_free (p_ev_io);
+  tiz_slab_free (p_ev_io);
   p_msg_io->p_ev_io = NULL;
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_timer_start (tiz_event_loop_msg_t * ap_msg)
+do_timer_start (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_timer_t * p_msg_timer = NULL;
   tiz_event_timer_t * p_ev_timer = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_timer = &(ap_msg->timer);
   assert (p_msg_timer);
@@ -717,20 +889,20 @@ do_timer_start (tiz_event_loop_msg_t * ap_msg)
     }
   p_ev_timer->id = p_msg_timer->id;
   p_ev_timer->started = true;
-  ev_timer_start (gp_event_loop->p_loop, (ev_timer *) (p_ev_timer));
+  ev_timer_start (ap_lp->p_loop, (ev_timer *) (p_ev_timer));
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_timer_restart (tiz_event_loop_msg_t * ap_msg)
+do_timer_restart (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_timer_t * p_msg_timer = NULL;
   tiz_event_timer_t * p_ev_timer = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_timer = &(ap_msg->timer);
   assert (p_msg_timer);
@@ -743,20 +915,20 @@ do_timer_restart (tiz_event_loop_msg_t * ap_msg)
     }
   p_ev_timer->id = p_msg_timer->id;
   p_ev_timer->started = true;
-  ev_timer_again (gp_event_loop->p_loop, (ev_timer *) (p_ev_timer));
+  ev_timer_again (ap_lp->p_loop, (ev_timer *) (p_ev_timer));
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_timer_stop (tiz_event_loop_msg_t * ap_msg)
+do_timer_stop (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_timer_t * p_msg_timer = NULL;
   tiz_event_timer_t * p_ev_timer = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_timer = &(ap_msg->timer);
   assert (p_msg_timer);
@@ -765,32 +937,25 @@ do_timer_stop (tiz_event_loop_msg_t * ap_msg)
   if (p_ev_timer->started)
     {
       /* The timer watcher has been started, let's stop it */
-      ev_timer_stop (gp_event_loop->p_loop, (ev_timer *) (p_ev_timer));
+      ev_timer_stop (ap_lp->p_loop, (ev_timer *) (p_ev_timer));
       p_ev_timer->started = false;
     }
-  else
-    {
-      /* The timer watcher hasn't been started, let's make sure there are no
-         start
-         requests in the queue */
-      const tiz_event_loop_msg_class_t class_to_be_deleted
-        = ETIZEventLoopMsgTimerStart;
-      tiz_pqueue_remove_func (gp_event_loop->p_pq, ev_timer_msg_dequeue,
-                              (OMX_S32) class_to_be_deleted, p_ev_timer);
-    }
+  /* Make sure there are no earlier start requests left behind in the queue
+     (regardless of the id they were issued with) */
+  remove_superseded_starts (ap_lp, ap_msg);
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_timer_destroy (tiz_event_loop_msg_t * ap_msg)
+do_timer_destroy (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_timer_t * p_msg_timer = NULL;
   tiz_event_timer_t * p_ev_timer = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_timer = &(ap_msg->timer);
   assert (p_msg_timer);
@@ -799,32 +964,32 @@ do_timer_destroy (tiz_event_loop_msg_t * ap_msg)
   if (p_ev_timer->started)
     {
       /* The timer watcher has been started, let's stop it */
-      ev_timer_stop (gp_event_loop->p_loop, (ev_timer *) (p_ev_timer));
+      ev_timer_stop (ap_lp->p_loop, (ev_timer *) (p_ev_timer));
     }
   {
     /* Now remove any references to this watcher that might be present in the
        queue */
     tiz_event_loop_msg_class_t class_to_be_deleted = ETIZEventLoopMsgTimerAny;
-    tiz_pqueue_remove_func (gp_event_loop->p_pq, ev_timer_msg_dequeue,
+    tiz_pqueue_remove_func (ap_lp->p_pq, ev_timer_msg_dequeue,
                             (OMX_S32) class_to_be_deleted, p_ev_timer);
   }
 
   /* And now it should be safe to delete the timer event */
-  tiz_mem_free (p_ev_timer);
+  tiz_slab_free (p_ev_timer);
   p_msg_timer->p_ev_timer = NULL;
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_stat_start (tiz_event_loop_msg_t * ap_msg)
+do_stat_start (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_stat_t * p_msg_stat = NULL;
   tiz_event_stat_t * p_ev_stat = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_stat = &(ap_msg->stat);
   assert (p_msg_stat);
@@ -842,20 +1007,20 @@ do_stat_start (tiz_event_loop_msg_t * ap_msg)
       assert (!p_ev_stat->started);
     }
   p_ev_stat->started = true;
-  ev_stat_start (gp_event_loop->p_loop, (ev_stat *) (p_ev_stat));
+  ev_stat_start (ap_lp->p_loop, (ev_stat *) (p_ev_stat));
 
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_stat_stop (tiz_event_loop_msg_t * ap_msg)
+do_stat_stop (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_stat_t * p_msg_stat = NULL;
   tiz_event_stat_t * p_ev_stat = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_stat = &(ap_msg->stat);
   assert (p_msg_stat);
@@ -864,31 +1029,24 @@ do_stat_stop (tiz_event_loop_msg_t * ap_msg)
   if (p_ev_stat->started)
     {
       /* The stat watcher has been started, let's stop it */
-      ev_stat_stop (gp_event_loop->p_loop, (ev_stat *) (p_ev_stat));
+      ev_stat_stop (ap_lp->p_loop, (ev_stat *) (p_ev_stat));
       p_ev_stat->started = false;
     }
-  else
-    {
-      /* The stat watcher hasn't been started, let's make sure there are no
-         start
-         requests in the queue */
-      const tiz_event_loop_msg_class_t class_to_be_deleted
-        = ETIZEventLoopMsgStatStart;
-      tiz_pqueue_remove_func (gp_event_loop->p_pq, ev_stat_msg_dequeue,
-                              (OMX_S32) class_to_be_deleted, p_ev_stat);
-    }
+  /* Make sure there are no earlier start requests left behind in the queue
+     (regardless of the id they were issued with) */
+  remove_superseded_starts (ap_lp, ap_msg);
   return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-do_stat_destroy (tiz_event_loop_msg_t * ap_msg)
+do_stat_destroy (tiz_event_loop_t * ap_lp, tiz_event_loop_msg_t * ap_msg)
 {
   tiz_event_loop_msg_stat_t * p_msg_stat = NULL;
   tiz_event_stat_t * p_ev_stat = NULL;
 
-  assert (gp_event_loop);
+  assert (ap_lp);
   assert (ap_msg);
-  assert (ETIZEventLoopStateStarted == gp_event_loop->state);
+  assert (ETIZEventLoopStateStarted == ap_lp->state);
 
   p_msg_stat = &(ap_msg->stat);
   assert (p_msg_stat);
@@ -897,56 +1055,62 @@ do_stat_destroy (tiz_event_loop_msg_t * ap_msg)
   if (p_ev_stat->started)
     {
       /* The stat watcher has been started, let's stop it */
-      ev_stat_stop (gp_event_loop->p_loop, (ev_stat *) (p_ev_stat));
+      ev_stat_stop (ap_lp->p_loop, (ev_stat *) (p_ev_stat));
     }
 
   {
     /* Now remove any references to this watcher that might be present in the
        queue */
     tiz_event_loop_msg_class_t class_to_be_deleted = ETIZEventLoopMsgStatAny;
-    tiz_pqueue_remove_func (gp_event_loop->p_pq, ev_stat_msg_dequeue,
+    tiz_pqueue_remove_func (ap_lp->p_pq, ev_stat_msg_dequeue,
                             (OMX_S32) class_to_be_deleted, p_ev_stat);
   }
 
   /* And now it should be safe to delete the stat event */
-  tiz_mem_free (p_msg_stat->p_ev_stat);
+  tiz_slab_free (p_msg_stat->p_ev_stat);
   p_msg_stat->p_ev_stat = NULL;
   return OMX_ErrorNone;
 }
 
+static void
+process_msgs (tiz_event_loop_t * ap_lp)
+{
+  void * p_msg = NULL;
+
+  assert (ap_lp);
+
+  /* Process all items from the queue */
+  (void) tiz_mutex_lock (&(ap_lp->mutex));
+  while (0 < tiz_pqueue_length (ap_lp->p_pq))
+    {
+      if (OMX_ErrorNone != tiz_pqueue_receive (ap_lp->p_pq, &p_msg))
+        {
+          break;
+        }
+      /* Process the message */
+      dispatch_msg (ap_lp, p_msg);
+      /* Delete the message */
+      tiz_slab_free (p_msg);
+    }
+  (void) tiz_mutex_unlock (&(ap_lp->mutex));
+}
+
 static void
 async_watcher_cback (struct ev_loop * ap_loop, ev_async * ap_watcher,
                      int a_revents)
 {
-  (void) ap_loop;
-  (void) ap_watcher;
+  tiz_event_loop_t * p_lp = ap_watcher->data;
   (void) a_revents;
 
-  if (gp_event_loop)
+  if (p_lp)
     {
-      if (ETIZEventLoopStateStopping == gp_event_loop->state)
+      if (ETIZEventLoopStateStopping == p_lp->state)
         {
-          ev_break (gp_event_loop->p_loop, EVBREAK_ONE);
+          ev_break (ap_loop, EVBREAK_ONE);
         }
-      else if (ETIZEventLoopStateStarted == gp_event_loop->state)
+      else if (ETIZEventLoopStateStarted == p_lp->state)
         {
-          void * p_msg = NULL;
-
-          /* Process all items from the queue */
-          (void) tiz_mutex_lock (&(gp_event_loop->mutex));
-          while (0 < tiz_pqueue_length (gp_event_loop->p_pq))
-            {
-              if (OMX_ErrorNone
-                  != tiz_pqueue_receive (gp_event_loop->p_pq, &p_msg))
-                {
-                  break;
-                }
-              /* Process the message */
-              dispatch_msg (p_msg);
-              /* Delete the message */
-              tiz_soa_free (gp_event_loop->p_soa, p_msg);
-            }
-          (void) tiz_mutex_unlock (&(gp_event_loop->mutex));
+          process_msgs (p_lp);
         }
     }
 }
@@ -955,9 +1119,8 @@ static void
 io_watcher_cback (struct ev_loop * ap_loop, ev_io * ap_watcher, int a_revents)
 {
   tiz_event_io_t * p_io_event = (tiz_event_io_t *) ap_watcher;
-  (void) ap_loop;
 
-  if (gp_event_loop)
+  if (gp_reactor)
     {
       assert (p_io_event);
       assert (p_io_event->pf_cback);
@@ -965,7 +1128,7 @@ io_watcher_cback (struct ev_loop * ap_loop, ev_io * ap_watcher, int a_revents)
       if (p_io_event->once)
         {
           p_io_event->started = false;
-          ev_io_stop (gp_event_loop->p_loop, (ev_io *) p_io_event);
+          ev_io_stop (ap_loop, (ev_io *) p_io_event);
         }
       p_io_event->pf_cback (p_io_event->p_arg0, p_io_event, p_io_event->p_arg1,
                             p_io_event->id, ((ev_io *) p_io_event)->fd,
@@ -980,7 +1143,7 @@ timer_watcher_cback (struct ev_loop * ap_loop, ev_timer * ap_watcher,
   (void) ap_loop;
   (void) a_revents;
 
-  if (gp_event_loop)
+  if (gp_reactor)
     {
       tiz_event_timer_t * p_timer_event = (tiz_event_timer_t *) ap_watcher;
       assert (p_timer_event);
@@ -996,7 +1159,7 @@ stat_watcher_cback (struct ev_loop * ap_loop, ev_stat * ap_watcher,
 {
   (void) ap_loop;
 
-  if (gp_event_loop)
+  if (gp_reactor)
     {
       tiz_event_stat_t * p_stat_event = (tiz_event_stat_t *) ap_watcher;
       assert (p_stat_event);
@@ -1012,14 +1175,31 @@ event_loop_thread_func (void * p_arg)
 {
   tiz_event_loop_t * p_event_loop = p_arg;
   struct ev_loop * p_loop = NULL;
+  char name[16];
 
   assert (p_event_loop);
 
   p_loop = p_event_loop->p_loop;
   assert (p_loop);
 
-  (void) tiz_thread_setname (&(p_event_loop->thread),
-                             (const OMX_STRING) TIZ_EVENT_LOOP_THREAD_NAME);
+  if (gp_reactor && gp_reactor->nloops > 1)
+    {
+      OMX_U32 i = 0;
+      for (i = 0; i < gp_reactor->nloops; ++i)
+        {
+          if (gp_reactor->pp_loops[i] == p_event_loop)
+            {
+              break;
+            }
+        }
+      snprintf (name, sizeof (name), "%s%u", TIZ_EVENT_LOOP_THREAD_NAME,
+                (unsigned int) i);
+    }
+  else
+    {
+      snprintf (name, sizeof (name), "%s", TIZ_EVENT_LOOP_THREAD_NAME);
+    }
+  (void) tiz_thread_setname (&(p_event_loop->thread), (const OMX_STRING) name);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Entering the dispatcher...");
   tiz_sem_post (&(p_event_loop->sem));
@@ -1032,7 +1212,7 @@ event_loop_thread_func (void * p_arg)
 }
 
 static inline void
-clean_up_thread_data (tiz_event_loop_t * ap_lp)
+clean_up_loop_data (tiz_event_loop_t * ap_lp)
 {
   if (ap_lp)
     {
@@ -1066,15 +1246,122 @@ clean_up_thread_data (tiz_event_loop_t * ap_lp)
           ap_lp->p_pq = NULL;
         }
 
-      if (ap_lp->p_soa)
+      tiz_mem_free (ap_lp);
+    }
+}
+
+static tiz_event_loop_t *
+create_loop (void)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
+  tiz_event_loop_t * p_lp = NULL;
+
+  tiz_goto_end_on_null (
+    (p_lp = (tiz_event_loop_t *) tiz_mem_calloc (1, sizeof (tiz_event_loop_t))),
+    "Error allocating loop data struct.");
+
+  p_lp->state = ETIZEventLoopStateStarting;
+
+  tiz_goto_end_on_null ((p_lp->p_loop = ev_loop_new (EVFLAG_AUTO)),
+                        "Error instantiating ev_loop.");
+
+  tiz_goto_end_on_null (
+    (p_lp->p_async_watcher = (ev_async *) tiz_mem_calloc (1, sizeof (ev_async))),
+    "Error initializing async watcher.");
+
+  tiz_goto_end_on_omx_err (tiz_mutex_init (&(p_lp->mutex)),
+                           "Error initializing mutex.");
+
+  tiz_goto_end_on_omx_err (tiz_sem_init (&(p_lp->sem), 0),
+                           "Error initializing sem.");
+
+  /* Init the priority queue */
+  tiz_goto_end_on_omx_err (tiz_pqueue_init (&p_lp->p_pq, 2, &pqueue_cmp,
+                                            NULL,
+                                            TIZ_EVENT_LOOP_THREAD_NAME),
+                           "Error initializing pqueue.");
+
+  /* All good */
+  rc = OMX_ErrorNone;
+
+  ev_async_init (p_lp->p_async_watcher, async_watcher_cback);
+  p_lp->p_async_watcher->data = p_lp;
+  ev_async_start (p_lp->p_loop, p_lp->p_async_watcher);
+
+end:
+
+  if (OMX_ErrorNone != rc)
+    {
+      clean_up_loop_data (p_lp);
+      p_lp = NULL;
+    }
+
+  return p_lp;
+}
+
+static OMX_ERRORTYPE
+start_loop_thread (tiz_event_loop_t * ap_lp)
+{
+  assert (ap_lp);
+
+  ap_lp->state = ETIZEventLoopStateStarted;
+  /* Create event loop thread */
+  tiz_check_omx (
+    tiz_thread_create (&(ap_lp->thread), 0, 0, event_loop_thread_func, ap_lp));
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "Now in ETIZEventLoopStateStarted state...");
+
+  (void) tiz_mutex_lock (&(ap_lp->mutex));
+  /* This is to prevent the event loop from exiting when there are no
+   * more active events */
+  ev_ref (ap_lp->p_loop);
+  (void) tiz_mutex_unlock (&(ap_lp->mutex));
+  tiz_sem_wait (&(ap_lp->sem));
+
+  return OMX_ErrorNone;
+}
+
+static void
+stop_loop_thread (tiz_event_loop_t * ap_lp)
+{
+  OMX_PTR p_result = NULL;
+
+  assert (ap_lp);
+
+  (void) tiz_mutex_lock (&(ap_lp->mutex));
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "destroying event loop thread [%p].", ap_lp);
+  ap_lp->state = ETIZEventLoopStateStopping;
+  ev_unref (ap_lp->p_loop);
+  ev_async_send (ap_lp->p_loop, ap_lp->p_async_watcher);
+  (void) tiz_mutex_unlock (&(ap_lp->mutex));
+
+  tiz_thread_join (&(ap_lp->thread), &p_result);
+}
+
+static OMX_U32
+configured_loop_count (const tiz_rcfile_t * ap_rc)
+{
+  long nloops = 0;
+  keyval_t * p_kv = NULL;
+
+  /* NOTE: tiz_rcfile_get_value can't be used here; it would re-enter the
+     initialisation of the reactor */
+  for (p_kv = ap_rc ? ap_rc->p_keyvals : NULL; p_kv && p_kv->p_key;
+       p_kv = p_kv->p_next)
+    {
+      if (0 == strcmp (p_kv->p_key, "event-loop-threads") && p_kv->p_value_list
+          && p_kv->p_value_list->p_value)
         {
-          tiz_soa_destroy (ap_lp->p_soa);
-          ap_lp->p_soa = NULL;
+          nloops = strtol (p_kv->p_value_list->p_value, NULL, 10);
+          break;
         }
+    }
 
-      tiz_mem_free (gp_event_loop);
-      gp_event_loop = NULL;
+  if (nloops <= 0)
+    {
+      nloops = sysconf (_SC_NPROCESSORS_ONLN);
     }
+
+  return (OMX_U32) MAX (1, MIN (nloops, TIZ_EVENT_LOOP_MAX_THREADS));
 }
 
 static void
@@ -1083,129 +1370,241 @@ child_event_loop_reset (void)
   /* Reset the once control */
   pthread_once_t once = PTHREAD_ONCE_INIT;
   memcpy (&g_event_loop_once, &once, sizeof (g_event_loop_once));
-  gp_event_loop = NULL;
+  gp_reactor = NULL;
+}
+
+static void
+destroy_reactor (tiz_event_reactor_t * ap_reactor)
+{
+  OMX_U32 i = 0;
+
+  if (ap_reactor)
+    {
+      for (i = 0; ap_reactor->pp_loops && i < ap_reactor->nloops; ++i)
+        {
+          clean_up_loop_data (ap_reactor->pp_loops[i]);
+        }
+      tiz_mem_free (ap_reactor->pp_loops);
+      if (ap_reactor->mutex)
+        {
+          (void) tiz_mutex_destroy (&(ap_reactor->mutex));
+        }
+      tiz_mem_free (ap_reactor);
+    }
 }
 
 static void
-init_event_loop_thread (void)
+init_event_reactor (void)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
+  tiz_event_reactor_t * p_reactor = NULL;
+  OMX_U32 i = 0;
 
-  if (!gp_event_loop)
+  if (!gp_reactor)
     {
       /* Let's return OOM error if something goes wrong */
       rc = OMX_ErrorInsufficientResources;
 
       /* Register a handler to reset the pthread_once_t global variable to try
          to cope with the scenario of a process forking without exec. The idea
-         is to make sure that the loop thread is re-created in the child
+         is to make sure that the loop threads are re-created in the child
          process */
       pthread_atfork (NULL, NULL, child_event_loop_reset);
 
-      tiz_goto_end_on_null (
-        (gp_event_loop
-         = (tiz_event_loop_t *) tiz_mem_calloc (1, sizeof (tiz_event_loop_t))),
-        "Error allocating thread data struct.");
+      tiz_goto_end_on_null ((p_reactor = (tiz_event_reactor_t *) tiz_mem_calloc (
+                               1, sizeof (tiz_event_reactor_t))),
+                            "Error allocating reactor data struct.");
 
-      gp_event_loop->state = ETIZEventLoopStateStarting;
+      tiz_goto_end_on_omx_err (tiz_rcfile_init (&(p_reactor->p_rcfile)),
+                               "Error opening configuration file.");
 
-      tiz_goto_end_on_omx_err (tiz_rcfile_init (&(gp_event_loop->p_rcfile)),
-                           "Error opening configuration file.");
+      tiz_goto_end_on_omx_err (tiz_mutex_init (&(p_reactor->mutex)),
+                               "Error initializing mutex.");
 
-      tiz_goto_end_on_null ((gp_event_loop->p_loop = ev_loop_new (EVFLAG_AUTO)),
-                            "Error instantiating ev_loop.");
-
-      tiz_goto_end_on_null ((gp_event_loop->p_async_watcher
-                            = (ev_async *) tiz_mem_calloc (1, sizeof (ev_async))),
-                           "Error initializing async watcher.");
-
-      tiz_goto_end_on_omx_err (tiz_mutex_init (&(gp_event_loop->mutex)),
-                           "Error initializing mutex.");
-
-      tiz_goto_end_on_omx_err (tiz_sem_init (&(gp_event_loop->sem), 0),
-                           "Error initializing sem.");
-
-      /* Init the small object allocator */
-      tiz_goto_end_on_omx_err (tiz_soa_init (&(gp_event_loop->p_soa)),
-                           "Error initializing the small object allocator.");
+      p_reactor->nloops = configured_loop_count (p_reactor->p_rcfile);
+      tiz_goto_end_on_null (
+        (p_reactor->pp_loops = (tiz_event_loop_t **) tiz_mem_calloc (
+           p_reactor->nloops, sizeof (tiz_event_loop_t *))),
+        "Error allocating the loop table.");
 
-      /* Init the priority queue */
-      tiz_goto_end_on_omx_err (
-        tiz_pqueue_init (&gp_event_loop->p_pq, 2, &pqueue_cmp,
-                         gp_event_loop->p_soa, TIZ_EVENT_LOOP_THREAD_NAME),
-        "Error initializing pqueue.");
+      for (i = 0; i < p_reactor->nloops; ++i)
+        {
+          tiz_goto_end_on_null ((p_reactor->pp_loops[i] = create_loop ()),
+                                "Error creating event loop.");
+        }
 
       /* All good */
       rc = OMX_ErrorNone;
-
-      ev_async_init (gp_event_loop->p_async_watcher, async_watcher_cback);
-      ev_async_start (gp_event_loop->p_loop, gp_event_loop->p_async_watcher);
-
-      assert (gp_event_loop);
+      gp_reactor = p_reactor;
     }
 
 end:
 
   if (OMX_ErrorNone == rc)
     {
-      tiz_event_loop_t * p_lp = gp_event_loop;
-      p_lp->state = ETIZEventLoopStateStarted;
-      /* Create event loop thread */
-      tiz_thread_create (&(p_lp->thread), 0, 0, event_loop_thread_func, p_lp);
-      TIZ_LOG (TIZ_PRIORITY_TRACE, "Now in ETIZEventLoopStateStarted state...");
-
-      (void) tiz_mutex_lock (&(p_lp->mutex));
-      /* This is to prevent the event loop from exiting when there are no
-       * more active events */
-      ev_ref (p_lp->p_loop);
-      (void) tiz_mutex_unlock (&(p_lp->mutex));
-      tiz_sem_wait (&(p_lp->sem));
+      for (i = 0; i < gp_reactor->nloops; ++i)
+        {
+          (void) start_loop_thread (gp_reactor->pp_loops[i]);
+        }
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "Started [%u] event loop(s)",
+               gp_reactor->nloops);
     }
   else
     {
-      clean_up_thread_data (gp_event_loop);
-      tiz_mem_free (gp_event_loop);
-      gp_event_loop = NULL;
+      destroy_reactor (p_reactor);
+      gp_reactor = NULL;
     }
 }
 
-static inline tiz_event_loop_t *
-get_event_loop (void)
+static inline tiz_event_reactor_t *
+get_reactor (void)
 {
-  (void) pthread_once (&g_event_loop_once, init_event_loop_thread);
-  return gp_event_loop;
+  (void) pthread_once (&g_event_loop_once, init_event_reactor);
+  return gp_reactor;
+}
+
+/* Returns the loop that serves watchers with the given affinity key */
+static tiz_event_loop_t *
+get_event_loop (const void * ap_affinity)
+{
+  tiz_event_reactor_t * p_reactor = get_reactor ();
+  tiz_event_loop_t * p_lp = NULL;
+  uint32_t hash = 0;
+
+  if (!p_reactor)
+    {
+      return NULL;
+    }
+
+  if (ap_affinity)
+    {
+      (void) tiz_mutex_lock (&(p_reactor->mutex));
+      for (p_lp = p_reactor->p_bound; p_lp; p_lp = p_lp->p_next)
+        {
+          if (p_lp->p_affinity == ap_affinity)
+            {
+              break;
+            }
+        }
+      (void) tiz_mutex_unlock (&(p_reactor->mutex));
+    }
+
+  if (!p_lp)
+    {
+      /* Fibonacci hashing of the key; all the watchers that share a key end up
+         in the same loop */
+      hash = (uint32_t) (((uintptr_t) ap_affinity >> 4) * 2654435761u);
+      p_lp = p_reactor->pp_loops[hash % p_reactor->nloops];
+    }
+
+  return p_lp;
 }
 
 OMX_ERRORTYPE
 tiz_event_loop_init (void)
 {
-  return get_event_loop () ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+  return get_reactor () ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
 }
 
 void
 tiz_event_loop_destroy (void)
 {
-  /* NOTE: If the thread is destroyed, it can't be recreated in the same
-     process as it's been instantiated with pthread_once. */
+  /* NOTE: If the threads are destroyed, they can't be recreated in the same
+     process as they've been instantiated with pthread_once. */
+  OMX_U32 i = 0;
 
-  if (gp_event_loop)
+  if (gp_reactor)
+    {
+      for (i = 0; i < gp_reactor->nloops; ++i)
+        {
+          stop_loop_thread (gp_reactor->pp_loops[i]);
+        }
+      destroy_reactor (gp_reactor);
+      gp_reactor = NULL;
+    }
+}
+
+OMX_ERRORTYPE
+tiz_event_loop_bind (const void * ap_affinity, tiz_event_loop_t ** app_lp)
+{
+  tiz_event_reactor_t * p_reactor = get_reactor ();
+  tiz_event_loop_t * p_lp = NULL;
+
+  assert (ap_affinity);
+  assert (app_lp);
+
+  tiz_check_null_ret_oom (p_reactor);
+  tiz_check_null_ret_oom ((p_lp = create_loop ()));
+
+  p_lp->p_affinity = ap_affinity;
+  p_lp->state = ETIZEventLoopStateStarted;
+
+  (void) tiz_mutex_lock (&(p_reactor->mutex));
+  p_lp->p_next = p_reactor->p_bound;
+  p_reactor->p_bound = p_lp;
+  (void) tiz_mutex_unlock (&(p_reactor->mutex));
+
+  *app_lp = p_lp;
+
+  return OMX_ErrorNone;
+}
+
+void
+tiz_event_loop_run_once (tiz_event_loop_t * ap_lp)
+{
+  assert (ap_lp);
+  assert (ap_lp->p_affinity);
+  (void) ev_run (ap_lp->p_loop, EVRUN_ONCE);
+}
+
+void
+tiz_event_loop_wakeup (tiz_event_loop_t * ap_lp)
+{
+  assert (ap_lp);
+  ev_async_send (ap_lp->p_loop, ap_lp->p_async_watcher);
+}
+
+void
+tiz_event_loop_unbind (tiz_event_loop_t * ap_lp)
+{
+  tiz_event_loop_t ** pp_lp = NULL;
+
+  if (ap_lp && gp_reactor)
+    {
+      assert (ap_lp->p_affinity);
+
+      (void) tiz_mutex_lock (&(gp_reactor->mutex));
+      for (pp_lp = &(gp_reactor->p_bound); *pp_lp; pp_lp = &((*pp_lp)->p_next))
+        {
+          if (*pp_lp == ap_lp)
+            {
+              *pp_lp = ap_lp->p_next;
+              break;
+            }
+        }
+      (void) tiz_mutex_unlock (&(gp_reactor->mutex));
+
+      /* Flush any pending watcher commands (e.g. destroy requests) */
+      process_msgs (ap_lp);
+      clean_up_loop_data (ap_lp);
+    }
+}
+
+void
+tiz_event_loop_batch_begin (void)
+{
+  ++g_batch.depth;
+}
+
+OMX_ERRORTYPE
+tiz_event_loop_batch_commit (void)
+{
+  assert (g_batch.depth > 0);
+  if (--g_batch.depth > 0)
     {
-      (void) tiz_mutex_lock (&(gp_event_loop->mutex));
-      TIZ_LOG (TIZ_PRIORITY_TRACE, "destroying event loop thread [%p].",
-               gp_event_loop);
-      gp_event_loop->state = ETIZEventLoopStateStopping;
-      ev_unref (gp_event_loop->p_loop);
-      ev_async_send (gp_event_loop->p_loop, gp_event_loop->p_async_watcher);
-      (void) tiz_mutex_unlock (&(gp_event_loop->mutex));
-
-      {
-        OMX_PTR p_result = NULL;
-        tiz_thread_join (&(gp_event_loop->thread), &p_result);
-        clean_up_thread_data (gp_event_loop);
-        tiz_mem_free (gp_event_loop);
-        gp_event_loop = NULL;
-      }
+      return OMX_ErrorNone;
     }
+  return flush_batch (&g_batch);
 }
 
 /*
@@ -1218,13 +1617,14 @@ tiz_event_io_init (tiz_event_io_t ** app_ev_io, void * ap_arg0,
 {
   OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
   tiz_event_io_t * p_ev_io = NULL;
+  tiz_event_loop_t * p_lp = NULL;
 
   assert (app_ev_io);
   assert (ap_cback);
-  (void) get_event_loop ();
 
-  if ((p_ev_io
-       = (tiz_event_io_t *) tiz_mem_calloc (1, sizeof (tiz_event_io_t))))
+  if ((p_lp = get_event_loop (ap_arg0))
+      && (p_ev_io
+          = (tiz_event_io_t *) tiz_slab_calloc (sizeof (tiz_event_io_t))))
     {
       p_ev_io->pf_cback = ap_cback;
       p_ev_io->p_arg0 = ap_arg0;
@@ -1233,6 +1633,7 @@ tiz_event_io_init (tiz_event_io_t ** app_ev_io, void * ap_arg0,
       p_ev_io->id = 0;
       p_ev_io->fd = -1;
       p_ev_io->started = false;
+      p_ev_io->p_lp = p_lp;
       ev_init ((ev_io *) p_ev_io, io_watcher_cback);
       rc = OMX_ErrorNone;
     }
@@ -1246,7 +1647,7 @@ void
 tiz_event_io_set (tiz_event_io_t * ap_ev_io, int a_fd,
                   tiz_event_io_event_t a_event, bool only_once)
 {
-  (void) get_event_loop ();
+  (void) get_reactor ();
   assert (ap_ev_io);
   assert (a_fd > 0);
   assert (a_event < TIZ_EVENT_MAX);
@@ -1259,7 +1660,7 @@ OMX_ERRORTYPE
 tiz_event_io_start (tiz_event_io_t * ap_ev_io, const uint32_t a_id)
 {
   assert (ap_ev_io);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_io_msg (ap_ev_io, a_id, ETIZEventLoopMsgIoStart);
 }
 
@@ -1267,7 +1668,7 @@ OMX_ERRORTYPE
 tiz_event_io_stop (tiz_event_io_t * ap_ev_io)
 {
   assert (ap_ev_io);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_io_msg (ap_ev_io, ap_ev_io->id, ETIZEventLoopMsgIoStop);
 }
 
@@ -1283,7 +1684,7 @@ tiz_event_io_destroy (tiz_event_io_t * ap_ev_io)
 {
   if (ap_ev_io)
     {
-      (void) get_event_loop ();
+      (void) get_reactor ();
       (void) enqueue_io_msg (ap_ev_io, ap_ev_io->id, ETIZEventLoopMsgIoDestroy);
     }
 }
@@ -1298,13 +1699,14 @@ tiz_event_timer_init (tiz_event_timer_t ** app_ev_timer, void * ap_arg0,
 {
   OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
   tiz_event_timer_t * p_ev_timer = NULL;
+  tiz_event_loop_t * p_lp = NULL;
 
   assert (app_ev_timer);
   assert (ap_cback);
-  (void) get_event_loop ();
 
-  if ((p_ev_timer
-       = (tiz_event_timer_t *) tiz_mem_calloc (1, sizeof (tiz_event_timer_t))))
+  if ((p_lp = get_event_loop (ap_arg0))
+      && (p_ev_timer
+          = (tiz_event_timer_t *) tiz_slab_calloc (sizeof (tiz_event_timer_t))))
     {
       p_ev_timer->pf_cback = ap_cback;
       p_ev_timer->p_arg0 = ap_arg0;
@@ -1312,6 +1714,7 @@ tiz_event_timer_init (tiz_event_timer_t ** app_ev_timer, void * ap_arg0,
       p_ev_timer->once = false;
       p_ev_timer->id = 0;
       p_ev_timer->started = false;
+      p_ev_timer->p_lp = p_lp;
       ev_init ((ev_timer *) p_ev_timer, timer_watcher_cback);
       rc = OMX_ErrorNone;
     }
@@ -1326,7 +1729,7 @@ tiz_event_timer_set (tiz_event_timer_t * ap_ev_timer, double a_after,
                      double a_repeat)
 {
   assert (ap_ev_timer);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   ap_ev_timer->once = a_repeat ? false : true;
   ev_timer_set ((ev_timer *) ap_ev_timer, a_after, a_repeat);
 }
@@ -1335,7 +1738,7 @@ OMX_ERRORTYPE
 tiz_event_timer_start (tiz_event_timer_t * ap_ev_timer, const uint32_t a_id)
 {
   assert (ap_ev_timer);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_timer_msg (ap_ev_timer, a_id, ETIZEventLoopMsgTimerStart);
 }
 
@@ -1343,7 +1746,7 @@ OMX_ERRORTYPE
 tiz_event_timer_restart (tiz_event_timer_t * ap_ev_timer, const uint32_t a_id)
 {
   assert (ap_ev_timer);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_timer_msg (ap_ev_timer, a_id, ETIZEventLoopMsgTimerRestart);
 }
 
@@ -1351,7 +1754,7 @@ OMX_ERRORTYPE
 tiz_event_timer_stop (tiz_event_timer_t * ap_ev_timer)
 {
   assert (ap_ev_timer);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_timer_msg (ap_ev_timer, ap_ev_timer->id,
                             ETIZEventLoopMsgTimerStop);
 }
@@ -1368,7 +1771,7 @@ tiz_event_timer_destroy (tiz_event_timer_t * ap_ev_timer)
 {
   if (ap_ev_timer)
     {
-      (void) get_event_loop ();
+      (void) get_reactor ();
       (void) enqueue_timer_msg (ap_ev_timer, ap_ev_timer->id,
                                 ETIZEventLoopMsgTimerDestroy);
     }
@@ -1384,19 +1787,21 @@ tiz_event_stat_init (tiz_event_stat_t ** app_ev_stat, void * ap_arg0,
 {
   OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
   tiz_event_stat_t * p_ev_stat = NULL;
+  tiz_event_loop_t * p_lp = NULL;
 
   assert (app_ev_stat);
   assert (ap_cback);
-  (void) get_event_loop ();
 
-  if ((p_ev_stat
-       = (tiz_event_stat_t *) tiz_mem_calloc (1, sizeof (tiz_event_stat_t))))
+  if ((p_lp = get_event_loop (ap_arg0))
+      && (p_ev_stat
+          = (tiz_event_stat_t *) tiz_slab_calloc (sizeof (tiz_event_stat_t))))
     {
       p_ev_stat->pf_cback = ap_cback;
       p_ev_stat->p_arg0 = ap_arg0;
       p_ev_stat->p_arg1 = ap_arg1;
       p_ev_stat->id = 0;
       p_ev_stat->started = false;
+      p_ev_stat->p_lp = p_lp;
       ev_init ((ev_stat *) p_ev_stat, stat_watcher_cback);
       rc = OMX_ErrorNone;
     }
@@ -1409,7 +1814,7 @@ tiz_event_stat_init (tiz_event_stat_t ** app_ev_stat, void * ap_arg0,
 void
 tiz_event_stat_set (tiz_event_stat_t * ap_ev_stat, const char * ap_path)
 {
-  (void) get_event_loop ();
+  (void) get_reactor ();
   assert (ap_ev_stat);
   ev_stat_set ((ev_stat *) ap_ev_stat, ap_path, 0);
 }
@@ -1418,7 +1823,7 @@ OMX_ERRORTYPE
 tiz_event_stat_start (tiz_event_stat_t * ap_ev_stat, const uint32_t a_id)
 {
   assert (ap_ev_stat);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_stat_msg (ap_ev_stat, a_id, ETIZEventLoopMsgStatStart);
 }
 
@@ -1426,7 +1831,7 @@ OMX_ERRORTYPE
 tiz_event_stat_stop (tiz_event_stat_t * ap_ev_stat)
 {
   assert (ap_ev_stat);
-  (void) get_event_loop ();
+  (void) get_reactor ();
   return enqueue_stat_msg (ap_ev_stat, ap_ev_stat->id,
                            ETIZEventLoopMsgStatStop);
 }
@@ -1436,7 +1841,7 @@ tiz_event_stat_destroy (tiz_event_stat_t * ap_ev_stat)
 {
   if (ap_ev_stat)
     {
-      (void) get_event_loop ();
+      (void) get_reactor ();
       (void) enqueue_stat_msg (ap_ev_stat, ap_ev_stat->id,
                                ETIZEventLoopMsgStatDestroy);
     }
@@ -1445,7 +1850,6 @@ tiz_event_stat_destroy (tiz_event_stat_t * ap_ev_stat)
 tiz_rcfile_t *
 tiz_rcfile_get_handle (void)
 {
-  tiz_event_loop_t * p_event_loop = get_event_loop ();
-  return (p_event_loop && p_event_loop->p_rcfile) ? p_event_loop->p_rcfile
-                                                  : NULL;
+  tiz_event_reactor_t * p_reactor = get_reactor ();
+  return (p_reactor && p_reactor->p_rcfile) ? p_reactor->p_rcfile : NULL;
 }
@@ -47,6 +47,12 @@ extern "C" {
 #include <OMX_Core.h>
 #include <OMX_Types.h>
 
+/**
+ * Handle to an event loop
+ * @ingroup tizevent
+ */
+typedef struct tiz_event_loop tiz_event_loop_t;
+
 /**
  * Handle to an io event
  * @ingroup tizevent
@@ -97,13 +103,18 @@ typedef enum tiz_event_io_event {
 } tiz_event_io_event_t;
 
 /**
- * Explicit initialisation of the global event loop. The loop is hosted in
- * its own thread which is spawned the first time this function or any other
- * function in this module are called. Therefore it is not mandatory to call
- * this function in order to instantiate the global event loop. This is only
- * useful if for some reason the initialization cannot be done at the same
+ * Explicit initialisation of the global event loops. Each loop is hosted in
+ * its own thread; the threads are spawned the first time this function or any
+ * other function in this module are called. Therefore it is not mandatory to
+ * call this function in order to instantiate the global event loops. This is
+ * only useful if for some reason the initialization cannot be done at the same
  * time as the first use.
  *
+ * The number of loops is read from the 'event-loop-threads' configuration
+ * key (default: one per online core). A watcher is assigned to a loop when it
+ * is initialised, based on its 'arg0' parameter, so all the watchers of a
+ * component are served by the same loop.
+ *
  * @ingroup tizevent
  *
  * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources
@@ -125,6 +136,72 @@ tiz_event_loop_init (void);
 void
 tiz_event_loop_destroy (void);
 
+/**
+ * Create a private event loop for the watchers whose 'arg0' is
+ * ap_affinity. The loop has no thread of its own; it is run by the caller
+ * with tiz_event_loop_run_once. This allows a component to serve its watchers
+ * in its own thread. Only watchers initialised after this call are affected.
+ *
+ * @ingroup tizevent
+ *
+ * @param ap_affinity The affinity key (e.g. the component handle).
+ * @param app_lp The new loop (output).
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources
+ * otherwise.
+ */
+OMX_ERRORTYPE
+tiz_event_loop_bind (const void * ap_affinity, tiz_event_loop_t ** app_lp);
+
+/**
+ * Run a bound loop until at least one event has been processed or
+ * tiz_event_loop_wakeup is called.
+ *
+ * @ingroup tizevent
+ */
+void
+tiz_event_loop_run_once (tiz_event_loop_t * ap_lp);
+
+/**
+ * Make tiz_event_loop_run_once return. May be called from any thread.
+ *
+ * @ingroup tizevent
+ */
+void
+tiz_event_loop_wakeup (tiz_event_loop_t * ap_lp);
+
+/**
+ * Destroy a bound loop. Pending watcher commands are processed first. All
+ * the watchers served by the loop must have been destroyed by then.
+ *
+ * @ingroup tizevent
+ */
+void
+tiz_event_loop_unbind (tiz_event_loop_t * ap_lp);
+
+/**
+ * Open a batch of watcher commands on the calling thread. Until the matching
+ * tiz_event_loop_batch_commit, the start/stop/destroy requests made by this
+ * thread are collected (and redundant ones, like a start followed by a stop
+ * of the same watcher, are dropped) and then handed over to the event loops
+ * with a single lock and wake-up per loop. Batches may be nested; only the
+ * outermost commit flushes.
+ *
+ * @ingroup tizevent
+ */
+void
+tiz_event_loop_batch_begin (void);
+
+/**
+ * Close the calling thread's batch of watcher commands.
+ *
+ * @ingroup tizevent
+ *
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources
+ * otherwise.
+ */
+OMX_ERRORTYPE
+tiz_event_loop_batch_commit (void);
+
 OMX_ERRORTYPE
 tiz_event_io_init (tiz_event_io_t ** app_ev_io, void * ap_arg0,
                    tiz_event_io_cb_f ap_cback, void * ap_arg1);
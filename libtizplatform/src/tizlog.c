@@ -26,18 +26,26 @@
  *
  */
 
+
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <time.h>
+#include <sched.h>
 #include <alloca.h>
 
 #include <log4c.h>
@@ -47,6 +55,15 @@
 
 #include "tizlog.h"
 
+/* TODO: 4096 - this value should be obtained at config time */
+#define TIZ_LOG_MSG_MAX_LEN 4096
+
+/* Asynchronous backend: records per thread ring, and record sizes */
+#define TIZ_LOG_RING_SLOTS 256
+#define TIZ_LOG_CNAME_MAX_LEN 64
+#define TIZ_LOG_ARGS_MAX_LEN 320
+#define TIZ_LOG_WRITER_IDLE_NSEC (5 * 1000 * 1000)
+
 typedef struct user_locinfo user_locinfo_t;
 struct user_locinfo
 {
@@ -54,13 +71,813 @@ struct user_locinfo
   int tid;
   const char * cname;
   char * cbuf;
+  /* Time of the call, when the record was written asynchronously */
+  const struct timeval * p_timestamp;
+};
+
+/* A log call, with its arguments serialised as the format describes them
+   (or the formatted message, if the format could not be deferred) */
+typedef struct log_record log_record_t;
+struct log_record
+{
+  const log4c_category_t * p_category;
+  const char * p_file;
+  const char * p_func;
+  const char * p_format;
+  int line;
+  int priority;
+  int tid;
+  bool preformatted;
+  bool has_cname;
+  struct timeval timestamp;
+  char cname[TIZ_LOG_CNAME_MAX_LEN];
+  unsigned char args[TIZ_LOG_ARGS_MAX_LEN];
+};
+
+/* Single-producer, single-consumer ring owned by one logging thread and
+   drained by the writer thread */
+typedef struct log_ring log_ring_t;
+struct log_ring
+{
+  log_record_t records[TIZ_LOG_RING_SLOTS];
+  unsigned int head; /* written by the owner thread */
+  unsigned int tail; /* written by the writer thread */
+  int orphaned;
+  int tid;
+  log_ring_t * p_next;
+};
+
+typedef enum log_len log_len_t;
+enum log_len
+{
+  log_len_none,
+  log_len_hh,
+  log_len_h,
+  log_len_l,
+  log_len_ll,
+  log_len_j,
+  log_len_z,
+  log_len_ptrdiff,
+  log_len_L
+};
+
+/* A printf conversion specification */
+typedef struct log_spec log_spec_t;
+struct log_spec
+{
+  size_t opts_len; /* flags, width and precision */
+  int nstars;
+  bool prec_star;
+  int precision;
+  log_len_t len;
+  char conv;
+  const char * p_end;
 };
 
+/* Starts above the value that unused sites hold */
+int tiz_log_generation = 1;
+static log_ring_t * gp_rings = NULL;
+static pthread_mutex_t g_rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_ring_key;
+static pthread_once_t g_ring_key_once = PTHREAD_ONCE_INIT;
+static pthread_t g_writer;
+static int g_async_running = 0;
+static unsigned int g_writer_passes = 0;
+static __thread log_ring_t * tp_ring = NULL;
+static __thread int t_tid = 0;
+
+static inline int
+thread_id (void)
+{
+  if (0 == t_tid)
+    {
+      t_tid = syscall (SYS_gettid);
+    }
+  return t_tid;
+}
+
+
+static bool
+parse_spec (const char * ap_pct, log_spec_t * ap_spec)
+{
+  const char * p = ap_pct + 1;
+  assert (ap_pct);
+  assert (ap_spec);
+
+  ap_spec->nstars = 0;
+  ap_spec->prec_star = false;
+  ap_spec->precision = -1;
+  ap_spec->len = log_len_none;
+
+  while (*p && strchr ("-+ #0'", *p))
+    {
+      ++p;
+    }
+  if ('*' == *p)
+    {
+      ++(ap_spec->nstars);
+      ++p;
+    }
+  while (*p >= '0' && *p <= '9')
+    {
+      ++p;
+    }
+  if ('.' == *p)
+    {
+      ++p;
+      if ('*' == *p)
+        {
+          ++(ap_spec->nstars);
+          ap_spec->prec_star = true;
+          ++p;
+        }
+      else
+        {
+          ap_spec->precision = 0;
+          while (*p >= '0' && *p <= '9')
+            {
+              ap_spec->precision = ap_spec->precision * 10 + (*p++ - '0');
+            }
+        }
+    }
+  ap_spec->opts_len = p - (ap_pct + 1);
+
+  switch (*p)
+    {
+      case 'h':
+        {
+          ap_spec->len = ('h' == p[1]) ? log_len_hh : log_len_h;
+          p += ('h' == p[1]) ? 2 : 1;
+        }
+        break;
+      case 'l':
+        {
+          ap_spec->len = ('l' == p[1]) ? log_len_ll : log_len_l;
+          p += ('l' == p[1]) ? 2 : 1;
+        }
+        break;
+      case 'q':
+        {
+          ap_spec->len = log_len_ll;
+          ++p;
+        }
+        break;
+      case 'j':
+        {
+          ap_spec->len = log_len_j;
+          ++p;
+        }
+        break;
+      case 'z':
+        {
+          ap_spec->len = log_len_z;
+          ++p;
+        }
+        break;
+      case 't':
+        {
+          ap_spec->len = log_len_ptrdiff;
+          ++p;
+        }
+        break;
+      case 'L':
+        {
+          ap_spec->len = log_len_L;
+          ++p;
+        }
+        break;
+      default:
+        break;
+    };
+
+  ap_spec->conv = *p;
+  ap_spec->p_end = p + 1;
+
+  /* Positional arguments, wide characters, long doubles, %n and %m are
+     formatted on the calling thread */
+  return ('\0' != *p && strchr ("diouxXcsfFeEgGaAp", *p)
+          && log_len_L != ap_spec->len
+          && !(log_len_l == ap_spec->len && ('c' == *p || 's' == *p))
+          && ap_spec->opts_len < 16);
+}
+
+#define LOG_PUT_ARG(v)                            \
+  do                                              \
+    {                                             \
+      if (pos + sizeof (v) > a_cap)               \
+        {                                         \
+          return false;                           \
+        }                                         \
+      memcpy (ap_buf + pos, &(v), sizeof (v));    \
+      pos += sizeof (v);                          \
+    }                                             \
+  while (0)
+
+static bool
+encode_args (const char * ap_format, va_list a_va, unsigned char * ap_buf,
+             const size_t a_cap)
+{
+  const char * p = ap_format;
+  size_t pos = 0;
+
+  while ((p = strchr (p, '%')))
+    {
+      log_spec_t spec;
+      int stars[2] = {0, 0};
+      int i = 0;
+
+      if ('%' == p[1])
+        {
+          p += 2;
+          continue;
+        }
+
+      if (!parse_spec (p, &spec))
+        {
+          return false;
+        }
+
+      for (i = 0; i < spec.nstars; ++i)
+        {
+          stars[i] = va_arg (a_va, int);
+          LOG_PUT_ARG (stars[i]);
+        }
+
+      switch (spec.conv)
+        {
+          case 'd':
+          case 'i':
+            {
+              int64_t v = 0;
+              switch (spec.len)
+                {
+                  case log_len_hh:
+                    v = (signed char) va_arg (a_va, int);
+                    break;
+                  case log_len_h:
+                    v = (short) va_arg (a_va, int);
+                    break;
+                  case log_len_l:
+                    v = va_arg (a_va, long);
+                    break;
+                  case log_len_ll:
+                    v = va_arg (a_va, long long);
+                    break;
+                  case log_len_j:
+                    v = va_arg (a_va, intmax_t);
+                    break;
+                  case log_len_z:
+                    v = va_arg (a_va, ssize_t);
+                    break;
+                  case log_len_ptrdiff:
+                    v = va_arg (a_va, ptrdiff_t);
+                    break;
+                  default:
+                    v = va_arg (a_va, int);
+                    break;
+                };
+              LOG_PUT_ARG (v);
+            }
+            break;
+          case 'o':
+          case 'u':
+          case 'x':
+          case 'X':
+            {
+              uint64_t v = 0;
+              switch (spec.len)
+                {
+                  case log_len_hh:
+                    v = (unsigned char) va_arg (a_va, unsigned int);
+                    break;
+                  case log_len_h:
+                    v = (unsigned short) va_arg (a_va, unsigned int);
+                    break;
+                  case log_len_l:
+                    v = va_arg (a_va, unsigned long);
+                    break;
+                  case log_len_ll:
+                    v = va_arg (a_va, unsigned long long);
+                    break;
+                  case log_len_j:
+                    v = va_arg (a_va, uintmax_t);
+                    break;
+                  case log_len_z:
+                    v = va_arg (a_va, size_t);
+                    break;
+                  case log_len_ptrdiff:
+                    v = va_arg (a_va, ptrdiff_t);
+                    break;
+                  default:
+                    v = va_arg (a_va, unsigned int);
+                    break;
+                };
+              LOG_PUT_ARG (v);
+            }
+            break;
+          case 'c':
+            {
+              int v = va_arg (a_va, int);
+              LOG_PUT_ARG (v);
+            }
+            break;
+          case 'p':
+            {
+              void * v = va_arg (a_va, void *);
+              LOG_PUT_ARG (v);
+            }
+            break;
+          case 's':
+            {
+              /* The string is copied, as it may not outlive the call */
+              const char * s = va_arg (a_va, const char *);
+              size_t max_len = 0;
+              size_t len = 0;
+              int precision = spec.prec_star ? stars[spec.nstars - 1]
+                                             : spec.precision;
+              if (pos >= a_cap)
+                {
+                  return false;
+                }
+              s = s ? s : "(null)";
+              max_len = a_cap - pos - 1;
+              if (precision >= 0 && (size_t) precision < max_len)
+                {
+                  max_len = precision;
+                }
+              len = strnlen (s, max_len);
+              if (len == max_len
+                  && (precision < 0 || len < (size_t) precision)
+                  && '\0' != s[len])
+                {
+                  /* Does not fit; the record is formatted by the caller */
+                  return false;
+                }
+              memcpy (ap_buf + pos, s, len);
+              ap_buf[pos + len] = '\0';
+              pos += len + 1;
+            }
+            break;
+          default:
+            {
+              /* Floating point conversions */
+              double v = va_arg (a_va, double);
+              LOG_PUT_ARG (v);
+            }
+            break;
+        };
+
+      p = spec.p_end;
+    }
+
+  return true;
+}
+
+#define LOG_GET_ARG(v)                          \
+  do                                            \
+    {                                           \
+      memcpy (&(v), p_arg, sizeof (v));         \
+      p_arg += sizeof (v);                      \
+    }                                           \
+  while (0)
+
+#define LOG_SNPRINTF(v)                                                     \
+  (0 == spec.nstars                                                         \
+     ? snprintf (ap_out + out, a_cap - out, conv_spec, v)                   \
+     : 1 == spec.nstars                                                     \
+         ? snprintf (ap_out + out, a_cap - out, conv_spec, stars[0], v)     \
+         : snprintf (ap_out + out, a_cap - out, conv_spec, stars[0],        \
+                     stars[1], v))
+
+/* Formats a record on the writer thread */
+static void
+format_record (const log_record_t * ap_rec, char * ap_out, const size_t a_cap)
+{
+  const unsigned char * p_arg = ap_rec->args;
+  const char * p = ap_rec->p_format;
+  size_t out = 0;
+
+  assert (ap_rec);
+  assert (ap_out);
+  assert (a_cap > 0);
+
+  if (ap_rec->preformatted)
+    {
+      snprintf (ap_out, a_cap, "%s", (const char *) ap_rec->args);
+      return;
+    }
+
+  while (*p && out < a_cap - 1)
+    {
+      const char * p_pct = strchr (p, '%');
+      const size_t lit_len = p_pct ? (size_t) (p_pct - p) : strlen (p);
+      const size_t copy_len
+        = (lit_len < a_cap - 1 - out) ? lit_len : a_cap - 1 - out;
+      log_spec_t spec;
+      char conv_spec[32];
+      int stars[2] = {0, 0};
+      int i = 0;
+      int n = 0;
+
+      memcpy (ap_out + out, p, copy_len);
+      out += copy_len;
+      if (!p_pct || out >= a_cap - 1)
+        {
+          break;
+        }
+
+      if ('%' == p_pct[1])
+        {
+          ap_out[out++] = '%';
+          p = p_pct + 2;
+          continue;
+        }
+
+      /* The format was parsed successfully when the record was written */
+      (void) parse_spec (p_pct, &spec);
+      for (i = 0; i < spec.nstars; ++i)
+        {
+          LOG_GET_ARG (stars[i]);
+        }
+
+      /* Integers were widened to 64 bits when the record was written */
+      snprintf (conv_spec, sizeof (conv_spec), "%%%.*s%s%c",
+                (int) spec.opts_len, p_pct + 1,
+                strchr ("diouxX", spec.conv) ? "ll" : "", spec.conv);
+
+      switch (spec.conv)
+        {
+          case 'd':
+          case 'i':
+            {
+              int64_t v = 0;
+              LOG_GET_ARG (v);
+              n = LOG_SNPRINTF ((long long) v);
+            }
+            break;
+          case 'o':
+          case 'u':
+          case 'x':
+          case 'X':
+            {
+              uint64_t v = 0;
+              LOG_GET_ARG (v);
+              n = LOG_SNPRINTF ((unsigned long long) v);
+            }
+            break;
+          case 'c':
+            {
+              int v = 0;
+              LOG_GET_ARG (v);
+              n = LOG_SNPRINTF (v);
+            }
+            break;
+          case 'p':
+            {
+              void * v = NULL;
+              LOG_GET_ARG (v);
+              n = LOG_SNPRINTF (v);
+            }
+            break;
+          case 's':
+            {
+              const char * v = (const char *) p_arg;
+              p_arg += strlen (v) + 1;
+              n = LOG_SNPRINTF (v);
+            }
+            break;
+          default:
+            {
+              double v = 0;
+              LOG_GET_ARG (v);
+              n = LOG_SNPRINTF (v);
+            }
+            break;
+        };
+
+      if (n > 0)
+        {
+          out += ((size_t) n < a_cap - 1 - out) ? (size_t) n : a_cap - 1 - out;
+        }
+      p = spec.p_end;
+    }
+
+  ap_out[out] = '\0';
+}
+
+static void
+on_thread_exit (void * ap_ring)
+{
+  log_ring_t * p_ring = ap_ring;
+  assert (p_ring);
+
+  pthread_mutex_lock (&g_rings_mutex);
+  if (__atomic_load_n (&g_async_running, __ATOMIC_ACQUIRE))
+    {
+      /* The writer drains the ring and releases it */
+      __atomic_store_n (&(p_ring->orphaned), 1, __ATOMIC_RELEASE);
+    }
+  else
+    {
+      log_ring_t ** pp_ring = &gp_rings;
+      while (*pp_ring && *pp_ring != p_ring)
+        {
+          pp_ring = &((*pp_ring)->p_next);
+        }
+      if (*pp_ring)
+        {
+          *pp_ring = p_ring->p_next;
+        }
+      free (p_ring);
+    }
+  pthread_mutex_unlock (&g_rings_mutex);
+}
+
+static void
+create_ring_key (void)
+{
+  (void) pthread_key_create (&g_ring_key, on_thread_exit);
+}
+
+static log_ring_t *
+thread_ring (void)
+{
+  if (!tp_ring)
+    {
+      log_ring_t * p_ring = calloc (1, sizeof (log_ring_t));
+      if (p_ring)
+        {
+          p_ring->tid = thread_id ();
+          pthread_mutex_lock (&g_rings_mutex);
+          p_ring->p_next = gp_rings;
+          gp_rings = p_ring;
+          pthread_mutex_unlock (&g_rings_mutex);
+          (void) pthread_setspecific (g_ring_key, p_ring);
+          tp_ring = p_ring;
+        }
+    }
+  return tp_ring;
+}
+
+/* Wait until a_slots slots of the ring are free. Returns false if the
+   writer has stopped. */
+static bool
+wait_ring (const log_ring_t * ap_ring, const unsigned int a_slots)
+{
+  assert (ap_ring);
+  while (ap_ring->head - __atomic_load_n (&(ap_ring->tail), __ATOMIC_ACQUIRE)
+         > TIZ_LOG_RING_SLOTS - a_slots)
+    {
+      if (!__atomic_load_n (&g_async_running, __ATOMIC_ACQUIRE))
+        {
+          return false;
+        }
+      sched_yield ();
+    }
+  return true;
+}
+
+static bool
+enqueue_record (const log4c_category_t * ap_category, const char * ap_file,
+                const int a_line, const char * ap_func, const int a_priority,
+                const char * ap_cname, const char * ap_format, va_list a_va)
+{
+  log_ring_t * p_ring = thread_ring ();
+  log_record_t * p_rec = NULL;
+  unsigned int head = 0;
+  va_list va;
+
+  if (!p_ring)
+    {
+      return false;
+    }
+
+  /* The ring is full; wait for the writer rather than lose the record */
+  head = p_ring->head;
+  if (!wait_ring (p_ring, 1))
+    {
+      return false;
+    }
+
+  p_rec = &(p_ring->records[head % TIZ_LOG_RING_SLOTS]);
+  p_rec->p_category = ap_category;
+  p_rec->p_file = ap_file;
+  p_rec->p_func = ap_func;
+  p_rec->p_format = ap_format;
+  p_rec->line = a_line;
+  p_rec->priority = a_priority;
+  p_rec->tid = p_ring->tid;
+  gettimeofday (&(p_rec->timestamp), NULL);
+  p_rec->has_cname = (NULL != ap_cname);
+  if (ap_cname)
+    {
+      snprintf (p_rec->cname, sizeof (p_rec->cname), "%s", ap_cname);
+    }
+
+  va_copy (va, a_va);
+  p_rec->preformatted
+    = !encode_args (ap_format, va, p_rec->args, sizeof (p_rec->args));
+  va_end (va);
+  if (p_rec->preformatted)
+    {
+      int len = 0;
+      va_copy (va, a_va);
+      len = vsnprintf ((char *) p_rec->args, sizeof (p_rec->args), ap_format,
+                       va);
+      va_end (va);
+      if (len < 0 || len >= (int) sizeof (p_rec->args))
+        {
+          /* Too long for a record; let the caller log it synchronously, once
+             the records queued before it have been written */
+          (void) wait_ring (p_ring, TIZ_LOG_RING_SLOTS);
+          return false;
+        }
+    }
+
+  __atomic_store_n (&(p_ring->head), head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void
+write_record (const log_record_t * ap_rec)
+{
+  static char msg[TIZ_LOG_MSG_MAX_LEN];
+  static char cbuf[TIZ_LOG_MSG_MAX_LEN];
+  log4c_location_info_t locinfo;
+  user_locinfo_t user_locinfo;
+
+  assert (ap_rec);
+
+  user_locinfo.pid = getpid ();
+  user_locinfo.tid = ap_rec->tid;
+  user_locinfo.cname = ap_rec->has_cname ? ap_rec->cname : NULL;
+  user_locinfo.cbuf = cbuf;
+  user_locinfo.p_timestamp = &(ap_rec->timestamp);
+  locinfo.loc_file = ap_rec->p_file;
+  locinfo.loc_line = ap_rec->line;
+  locinfo.loc_function = ap_rec->p_func;
+  locinfo.loc_data = &user_locinfo;
+
+  format_record (ap_rec, msg, sizeof (msg));
+  log4c_category_log_locinfo (ap_rec->p_category, &locinfo, ap_rec->priority,
+                              "%s", msg);
+}
+
+static unsigned int
+drain_ring (log_ring_t * ap_ring)
+{
+  unsigned int first = 0;
+  unsigned int tail = 0;
+  unsigned int head = 0;
+  assert (ap_ring);
+
+  first = tail = ap_ring->tail;
+  head = __atomic_load_n (&(ap_ring->head), __ATOMIC_ACQUIRE);
+  for (; tail != head; ++tail)
+    {
+      write_record (&(ap_ring->records[tail % TIZ_LOG_RING_SLOTS]));
+      __atomic_store_n (&(ap_ring->tail), tail + 1, __ATOMIC_RELEASE);
+    }
+
+  return head - first;
+}
+
+static void *
+log_writer (void * ap_arg)
+{
+  bool running = true;
+  (void) ap_arg;
+
+  while (running)
+    {
+      unsigned int n = 0;
+      log_ring_t ** pp_ring = NULL;
+
+      /* Read the flag first, so that the last pass drains everything */
+      running = __atomic_load_n (&g_async_running, __ATOMIC_ACQUIRE);
+
+      pthread_mutex_lock (&g_rings_mutex);
+      pp_ring = &gp_rings;
+      while (*pp_ring)
+        {
+          log_ring_t * p_ring = *pp_ring;
+          n += drain_ring (p_ring);
+          if (__atomic_load_n (&(p_ring->orphaned), __ATOMIC_ACQUIRE)
+              && p_ring->tail == __atomic_load_n (&(p_ring->head),
+                                                  __ATOMIC_ACQUIRE))
+            {
+              *pp_ring = p_ring->p_next;
+              free (p_ring);
+            }
+          else
+            {
+              pp_ring = &(p_ring->p_next);
+            }
+        }
+      pthread_mutex_unlock (&g_rings_mutex);
+      (void) __atomic_add_fetch (&g_writer_passes, 1, __ATOMIC_RELEASE);
+
+      if (0 == n && running)
+        {
+          const struct timespec idle = {0, TIZ_LOG_WRITER_IDLE_NSEC};
+          nanosleep (&idle, NULL);
+        }
+    }
+  return NULL;
+}
+
+static void
+start_async (void)
+{
+  if (!__atomic_load_n (&g_async_running, __ATOMIC_ACQUIRE))
+    {
+      (void) pthread_once (&g_ring_key_once, create_ring_key);
+      __atomic_store_n (&g_async_running, 1, __ATOMIC_RELEASE);
+      if (0 != pthread_create (&g_writer, NULL, log_writer, NULL))
+        {
+          __atomic_store_n (&g_async_running, 0, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+static void
+stop_async (void)
+{
+  if (__atomic_load_n (&g_async_running, __ATOMIC_ACQUIRE))
+    {
+      __atomic_store_n (&g_async_running, 0, __ATOMIC_RELEASE);
+      (void) pthread_join (g_writer, NULL);
+    }
+}
+
+static void
+invalidate_sites (void)
+{
+  (void) __atomic_add_fetch (&tiz_log_generation, 1, __ATOMIC_RELEASE);
+}
+
+static const log4c_category_t *
+resolve_site (tiz_log_site_t * ap_site)
+{
+  const int generation
+    = __atomic_load_n (&tiz_log_generation, __ATOMIC_ACQUIRE);
+  void * p_category = NULL;
+  assert (ap_site);
+
+  if (generation == __atomic_load_n (&(ap_site->generation), __ATOMIC_ACQUIRE))
+    {
+      p_category = __atomic_load_n (&(ap_site->p_category), __ATOMIC_RELAXED);
+    }
+  if (!p_category)
+    {
+      p_category = log4c_category_get (ap_site->p_cat_name);
+      __atomic_store_n (&(ap_site->p_category), p_category, __ATOMIC_RELAXED);
+      __atomic_store_n (&(ap_site->max_priority),
+                        log4c_category_get_chainedpriority (p_category),
+                        __ATOMIC_RELAXED);
+      __atomic_store_n (&(ap_site->generation), generation, __ATOMIC_RELEASE);
+    }
+  return p_category;
+}
+
+static void
+log_event (const log4c_category_t * ap_category, const char * ap_file,
+           const int a_line, const char * ap_func, const int a_priority,
+           const char * ap_cname, char * ap_cbuf, const char * ap_format,
+           va_list a_va)
+{
+  log4c_location_info_t locinfo;
+  user_locinfo_t user_locinfo;
+  char * buffer = NULL;
+
+  ap_format = ap_format ? ap_format : "";
+  if (__atomic_load_n (&g_async_running, __ATOMIC_RELAXED)
+      && enqueue_record (ap_category, ap_file, a_line, ap_func, a_priority,
+                         ap_cname, ap_format, a_va))
+    {
+      return;
+    }
+
+  buffer = alloca (TIZ_LOG_MSG_MAX_LEN);
+  user_locinfo.pid = getpid ();
+  user_locinfo.tid = thread_id ();
+  user_locinfo.cname = ap_cname;
+  user_locinfo.cbuf = ap_cbuf;
+  user_locinfo.p_timestamp = NULL;
+  locinfo.loc_file = ap_file;
+  locinfo.loc_line = a_line;
+  locinfo.loc_function = ap_func;
+  locinfo.loc_data = &user_locinfo;
+
+  vsnprintf (buffer, TIZ_LOG_MSG_MAX_LEN, ap_format, a_va);
+  log4c_category_log_locinfo (ap_category, &locinfo, a_priority, "%s", buffer);
+}
+
 static const char *
 log_layout_format (const log4c_layout_t * a_layout,
                    const log4c_logging_event_t * a_event)
 {
-  static char buffer[4096];
+  static char buffer[TIZ_LOG_MSG_MAX_LEN];
   user_locinfo_t * uloc = NULL;
   (void) a_layout;
 
@@ -70,8 +887,10 @@ log_layout_format (const log4c_layout_t * a_layout,
   if (a_event->evt_loc->loc_data)
     {
       struct tm tm;
-      gmtime_r (&a_event->evt_timestamp.tv_sec, &tm);
+      const struct timeval * p_ts = NULL;
       uloc = (user_locinfo_t *) a_event->evt_loc->loc_data;
+      p_ts = uloc->p_timestamp ? uloc->p_timestamp : &a_event->evt_timestamp;
+      gmtime_r (&p_ts->tv_sec, &tm);
 
       if (NULL == uloc->cname)
         {
@@ -79,7 +898,7 @@ log_layout_format (const log4c_layout_t * a_layout,
                     "%02d-%02d-%04d %02d:%02d:%02d.%03ld - "
                     "[PID:%i][TID:%i] [%s] [%s] [%s:%s:%i] --- %s\n",
                     tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour,
-                    tm.tm_min, tm.tm_sec, a_event->evt_timestamp.tv_usec / 1000,
+                    tm.tm_min, tm.tm_sec, p_ts->tv_usec / 1000,
                     uloc->pid, uloc->tid,
                     log4c_priority_to_string (a_event->evt_priority),
                     a_event->evt_category, a_event->evt_loc->loc_file,
@@ -88,13 +907,11 @@ log_layout_format (const log4c_layout_t * a_layout,
         }
       else
         {
-          /* TODO: 4096 - this value needs be learnt at project configuration
-           * time */
-          snprintf (uloc->cbuf, 4096,
+          snprintf (uloc->cbuf, TIZ_LOG_MSG_MAX_LEN,
                     "%02d-%02d-%04d %02d:%02d:%02d.%03ld - "
                     "[PID:%i][TID:%i] [%s] [%s] [%s:%s:%i] --- %s\n",
                     tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour,
-                    tm.tm_min, tm.tm_sec, a_event->evt_timestamp.tv_usec / 1000,
+                    tm.tm_min, tm.tm_sec, p_ts->tv_usec / 1000,
                     uloc->pid, uloc->tid,
                     log4c_priority_to_string (a_event->evt_priority),
                     uloc->cname, a_event->evt_loc->loc_file,
@@ -143,8 +960,16 @@ int
 tiz_log_init (void)
 {
 #ifndef WITHOUT_LOG4C
+  int rc = 0;
   log_formatters_init ();
-  return log4c_init ();
+  rc = log4c_init ();
+  /* The configuration may have changed the categories' priorities */
+  invalidate_sites ();
+  if (getenv ("TIZONIA_LOG_ASYNC"))
+    {
+      start_async ();
+    }
+  return rc;
 #else
   return 0;
 #endif
@@ -197,42 +1022,75 @@ int
 tiz_log_deinit (void)
 {
 #ifndef WITHOUT_LOG4C
-  return log4c_fini ();
+  int rc = 0;
+  /* Write the queued records while the categories are still valid */
+  stop_async ();
+  rc = log4c_fini ();
+  invalidate_sites ();
+  return rc;
 #else
   return 0;
 #endif
 }
 
+void
+tiz_log_flush (void)
+{
+  /* The pass under way may have gone past the caller's ring already, but
+     the one after it starts after this call */
+  const unsigned int target
+    = __atomic_load_n (&g_writer_passes, __ATOMIC_ACQUIRE) + 2;
+  while (__atomic_load_n (&g_async_running, __ATOMIC_ACQUIRE)
+         && (int) (target - __atomic_load_n (&g_writer_passes,
+                                             __ATOMIC_ACQUIRE))
+              > 0)
+    {
+      const struct timespec idle = {0, TIZ_LOG_WRITER_IDLE_NSEC};
+      nanosleep (&idle, NULL);
+    }
+}
+
 void
 tiz_log (const char * ap_file, int a_line, const char * ap_func,
          const char * ap_cat_name, int a_priority, const char * ap_cname,
          char * ap_cbuf, const char * ap_format, ...)
 {
 #ifndef WITHOUT_LOG4C
-  log4c_location_info_t locinfo;
-  user_locinfo_t user_locinfo;
-
   const log4c_category_t * p_category = log4c_category_get (ap_cat_name);
   if (log4c_category_is_priority_enabled (p_category, a_priority))
     {
-      /* TODO: 4096 - this value should be obtained at config time */
-      char * buffer = alloca (4096);
-      user_locinfo.pid = getpid ();
-      user_locinfo.tid = syscall (SYS_gettid);
-      user_locinfo.cname = ap_cname;
-      user_locinfo.cbuf = ap_cbuf;
-      locinfo.loc_file = ap_file;
-      locinfo.loc_line = a_line;
-      locinfo.loc_function = ap_func;
-      /*          locinfo.loc_data = NULL; */
-      locinfo.loc_data = &user_locinfo;
+      va_list va;
+      va_start (va, ap_format);
+      log_event (p_category, ap_file, a_line, ap_func, a_priority, ap_cname,
+                 ap_cbuf, ap_format, va);
+      va_end (va);
+    }
+#else
+
+  va_list va;
+  va_start (va, ap_format);
+  vprintf (ap_format, va);
+  va_end (va);
+  printf ("\n");
 
+#endif
+}
+
+void
+tiz_log_site (tiz_log_site_t * ap_site, const char * ap_file, int a_line,
+              const char * ap_func, int a_priority, const char * ap_cname,
+              char * ap_cbuf, const char * ap_format, ...)
+{
+#ifndef WITHOUT_LOG4C
+  const log4c_category_t * p_category = resolve_site (ap_site);
+  if (a_priority
+      <= __atomic_load_n (&(ap_site->max_priority), __ATOMIC_RELAXED))
+    {
       va_list va;
       va_start (va, ap_format);
-      vsprintf (buffer, ap_format, va);
+      log_event (p_category, ap_file, a_line, ap_func, a_priority, ap_cname,
+                 ap_cbuf, ap_format, va);
       va_end (va);
-      log4c_category_log_locinfo (p_category, &locinfo, a_priority, "%s",
-                                  buffer);
     }
 #else
 
@@ -33,6 +33,8 @@
 extern "C" {
 #endif
 
+#include <limits.h>
+
 #include <log4c.h>
 
 #ifndef TIZ_LOG_CATEGORY_NAME
@@ -41,9 +43,45 @@ extern "C" {
 
 /* #define WITHOUT_LOG4C 1 */
 
-#define TIZ_LOG(priority, format, args...)                                    \
-  tiz_log (__FILE__, __LINE__, __FUNCTION__, TIZ_LOG_CATEGORY_NAME, priority, \
-           NULL, NULL, format, ##args);
+/**
+ * Per call site logging state. The category is looked up on the first call
+ * and its priority is cached, so that a disabled call site costs two
+ * comparisons. tiz_log_init and tiz_log_deinit invalidate the cached values
+ * by moving tiz_log_generation on. Sites are never tracked, so they may live
+ * in a library that gets unloaded.
+ */
+typedef struct tiz_log_site tiz_log_site_t;
+struct tiz_log_site
+{
+  int max_priority;
+  int generation; /* tiz_log_generation when the site was resolved */
+  const char * p_cat_name;
+  void * p_category;
+};
+
+#define TIZ_LOG_SITE_UNRESOLVED INT_MAX
+
+extern int tiz_log_generation;
+
+#define TIZ_LOG_AT(priority, cat_name, cname, cbuf, format, args...)          \
+  do                                                                          \
+    {                                                                         \
+      static tiz_log_site_t tiz_log_site__                                    \
+        = {TIZ_LOG_SITE_UNRESOLVED, 0, cat_name, NULL};                       \
+      if ((priority)                                                          \
+            <= __atomic_load_n (&tiz_log_site__.max_priority,                 \
+                                __ATOMIC_RELAXED)                             \
+          || __atomic_load_n (&tiz_log_site__.generation, __ATOMIC_RELAXED)   \
+               != __atomic_load_n (&tiz_log_generation, __ATOMIC_RELAXED))    \
+        {                                                                     \
+          tiz_log_site (&tiz_log_site__, __FILE__, __LINE__, __FUNCTION__,    \
+                        priority, cname, cbuf, format, ##args);               \
+        }                                                                     \
+    }                                                                         \
+  while (0)
+
+#define TIZ_LOG(priority, format, args...) \
+  TIZ_LOG_AT (priority, TIZ_LOG_CATEGORY_NAME, NULL, NULL, format, ##args);
 
 #ifndef WITHOUT_LOG4C
 #define TIZ_PRIORITY_ERROR LOG4C_PRIORITY_ERROR
@@ -59,6 +97,11 @@ extern "C" {
 #define TIZ_PRIORITY_TRACE 5
 #endif
 
+/**
+ * Initialise log4c. When the TIZONIA_LOG_ASYNC environment variable is set,
+ * log records are queued in per-thread lock-free rings and formatted and
+ * written by a dedicated writer thread, instead of on the calling thread.
+ */
 int
 tiz_log_init (void);
 void
@@ -66,12 +109,27 @@ tiz_log_set_unique_rolling_file (const char * ap_logdir,
                                  const char * ap_file_prefix);
 int
 tiz_log_deinit (void);
+
+/**
+ * Wait until the asynchronous writer, if running, has written every record
+ * queued before this call. Records refer to their call site's file, function
+ * and format strings, so this must be called before unloading a library that
+ * logs.
+ */
+void
+tiz_log_flush (void);
 void
 tiz_log (const char * __p_file, int __line, const char * __p_func,
          const char * __p_cat_name, int __priority,
          /*@null@ */ const char * __p_cname,
          /*@null@ */ char * __p_cbuf,
          /*@null@ */ const char * __p_format, ...);
+void
+tiz_log_site (tiz_log_site_t * __p_site, const char * __p_file, int __line,
+              const char * __p_func, int __priority,
+              /*@null@ */ const char * __p_cname,
+              /*@null@ */ char * __p_cbuf,
+              /*@null@ */ const char * __p_format, ...);
 
 #ifdef __cplusplus
 }
@@ -659,6 +659,12 @@ static const tiz_idx_str_t tiz_idx_to_str_tbl[] = {
    (const OMX_STRING) "OMX_TizoniaIndexParamAudioPlexSession"},
   {OMX_TizoniaIndexParamAudioPlexPlaylist,
    (const OMX_STRING) "OMX_TizoniaIndexParamAudioPlexPlaylist"},
+  {OMX_TizoniaIndexConfigPerfCounters,
+   (const OMX_STRING) "OMX_TizoniaIndexConfigPerfCounters"},
+  {OMX_TizoniaIndexConfigStreamingBufferStatus,
+   (const OMX_STRING) "OMX_TizoniaIndexConfigStreamingBufferStatus"},
+  {OMX_TizoniaIndexParamComponentReset,
+   (const OMX_STRING) "OMX_TizoniaIndexParamComponentReset"},
   {OMX_IndexKhronosExtensions, (const OMX_STRING) "OMX_IndexKhronosExtensions"},
   {OMX_IndexVendorStartUnused, (const OMX_STRING) "OMX_IndexVendorStartUnused"},
   {OMX_IndexMax, (const OMX_STRING) "OMX_IndexMax"}};
@@ -0,0 +1,1620 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizpcm.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia Platform - PCM sample processing kernels
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "tizplatform.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCM_HAVE_X86 1
+#include <immintrin.h>
+#define PCM_TARGET_SSE2 __attribute__ ((target ("sse2")))
+#define PCM_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define PCM_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.platform.pcm"
+#endif
+
+#define PCM_S16_MIN -32768.f
+#define PCM_S16_MAX 32767.f
+#define PCM_S24_MIN -8388608.f
+#define PCM_S24_MAX 8388607.f
+#define PCM_S32_MIN -2147483648.
+#define PCM_S32_MAX 2147483647.
+#define PCM_S16_SCALE 32768.f
+#define PCM_S24_SCALE 8388608.
+#define PCM_S32_SCALE 2147483648.
+#define PCM_DITHER_SCALE (1.f / 16777216.f)
+
+/* Gain and ramps share the same kernels: sample i of frame f is multiplied
+   by a_from + a_step * f (a gain is a ramp with a zero step). The vector
+   kernels require the number of channels to divide the number of float
+   lanes, so that every vector starts at a frame boundary. */
+typedef void (*pcm_scale_f) (void * ap_buf, const size_t a_nsamples,
+                             const size_t a_channels, const float a_from,
+                             const float a_step);
+typedef void (*pcm_swap_f) (void * ap_buf, const size_t a_nsamples);
+
+/* The vector conversion kernels handle one or two planes; any other layout
+   is converted by the scalar code */
+typedef void (*pcm_fixed_s16_f) (int16_t * ap_dst,
+                                 const int32_t * const * app_planes,
+                                 const size_t a_nplanes,
+                                 const size_t a_nsamples,
+                                 const unsigned int a_fracbits);
+typedef void (*pcm_float_s16_f) (int16_t * ap_dst,
+                                 const float * const * app_planes,
+                                 const size_t a_nplanes,
+                                 const size_t a_nsamples,
+                                 tiz_pcm_dither_t * ap_dither);
+/* Interleaves two planes */
+typedef void (*pcm_float_flt_f) (float * ap_dst,
+                                 const float * const * app_planes,
+                                 const size_t a_nsamples);
+
+typedef struct pcm_kernels pcm_kernels_t;
+struct pcm_kernels
+{
+  tiz_pcm_isa_t isa;
+  size_t lanes;
+  pcm_scale_f scale[ETIZPcmFormatMax];
+  pcm_swap_f swap16;
+  pcm_swap_f swap32;
+  pcm_fixed_s16_f fixed_s16;
+  pcm_float_s16_f float_s16;
+  pcm_float_flt_f float_flt;
+};
+
+static const char * pcm_isa_names[] = {"scalar", "sse2", "avx2", "neon"};
+
+static pthread_once_t g_pcm_once = PTHREAD_ONCE_INIT;
+static const pcm_kernels_t * gp_pcm_kernels = NULL;
+
+/*
+ * Scalar kernels. The vector kernels use these for the samples that do not
+ * fill a whole vector.
+ */
+
+static inline int32_t
+s24_load (const uint8_t * ap_sample)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  int32_t v = (ap_sample[0] << 16) | (ap_sample[1] << 8) | ap_sample[2];
+#else
+  int32_t v = (ap_sample[2] << 16) | (ap_sample[1] << 8) | ap_sample[0];
+#endif
+  return (v ^ 0x800000) - 0x800000;
+}
+
+static inline void
+s24_store (uint8_t * ap_sample, const int32_t a_value)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  ap_sample[0] = (uint8_t) (a_value >> 16);
+  ap_sample[1] = (uint8_t) (a_value >> 8);
+  ap_sample[2] = (uint8_t) a_value;
+#else
+  ap_sample[0] = (uint8_t) a_value;
+  ap_sample[1] = (uint8_t) (a_value >> 8);
+  ap_sample[2] = (uint8_t) (a_value >> 16);
+#endif
+}
+
+static inline float
+clampf (const float a_value, const float a_min, const float a_max)
+{
+  return a_value < a_min ? a_min : (a_value > a_max ? a_max : a_value);
+}
+
+static inline double
+clampd (const double a_value, const double a_min, const double a_max)
+{
+  return a_value < a_min ? a_min : (a_value > a_max ? a_max : a_value);
+}
+
+static void
+scalar_s16_from (int16_t * ap_buf, size_t a_first, const size_t a_nsamples,
+                 const size_t a_channels, const float a_from,
+                 const float a_step)
+{
+  size_t frame = a_first / a_channels;
+  while (a_first < a_nsamples)
+    {
+      const float gain = a_from + a_step * (float) frame++;
+      const size_t end = a_first + a_channels;
+      for (; a_first < end && a_first < a_nsamples; ++a_first)
+        {
+          ap_buf[a_first] = (int16_t) clampf (ap_buf[a_first] * gain,
+                                              PCM_S16_MIN, PCM_S16_MAX);
+        }
+    }
+}
+
+static void
+scalar_s24_from (uint8_t * ap_buf, size_t a_first, const size_t a_nsamples,
+                 const size_t a_channels, const float a_from,
+                 const float a_step)
+{
+  size_t frame = a_first / a_channels;
+  while (a_first < a_nsamples)
+    {
+      const float gain = a_from + a_step * (float) frame++;
+      const size_t end = a_first + a_channels;
+      for (; a_first < end && a_first < a_nsamples; ++a_first)
+        {
+          uint8_t * p_sample = ap_buf + a_first * 3;
+          s24_store (p_sample,
+                     (int32_t) clampf (s24_load (p_sample) * gain,
+                                       PCM_S24_MIN, PCM_S24_MAX));
+        }
+    }
+}
+
+static void
+scalar_s32_from (int32_t * ap_buf, size_t a_first, const size_t a_nsamples,
+                 const size_t a_channels, const float a_from,
+                 const float a_step)
+{
+  size_t frame = a_first / a_channels;
+  while (a_first < a_nsamples)
+    {
+      const float gain = a_from + a_step * (float) frame++;
+      const size_t end = a_first + a_channels;
+      for (; a_first < end && a_first < a_nsamples; ++a_first)
+        {
+          /* A float does not hold 32 bits of precision */
+          ap_buf[a_first]
+            = (int32_t) clampd ((double) ap_buf[a_first] * (double) gain,
+                                PCM_S32_MIN, PCM_S32_MAX);
+        }
+    }
+}
+
+static void
+scalar_flt_from (float * ap_buf, size_t a_first, const size_t a_nsamples,
+                 const size_t a_channels, const float a_from,
+                 const float a_step)
+{
+  size_t frame = a_first / a_channels;
+  while (a_first < a_nsamples)
+    {
+      const float gain = a_from + a_step * (float) frame++;
+      const size_t end = a_first + a_channels;
+      for (; a_first < end && a_first < a_nsamples; ++a_first)
+        {
+          ap_buf[a_first] = clampf (ap_buf[a_first] * gain, -1.f, 1.f);
+        }
+    }
+}
+
+static void
+scalar_s16 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+            const float a_from, const float a_step)
+{
+  scalar_s16_from (ap_buf, 0, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+scalar_s24 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+            const float a_from, const float a_step)
+{
+  scalar_s24_from (ap_buf, 0, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+scalar_s32 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+            const float a_from, const float a_step)
+{
+  scalar_s32_from (ap_buf, 0, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+scalar_flt (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+            const float a_from, const float a_step)
+{
+  scalar_flt_from (ap_buf, 0, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+scalar_swap16_from (uint16_t * ap_buf, size_t a_first,
+                    const size_t a_nsamples)
+{
+  for (; a_first < a_nsamples; ++a_first)
+    {
+      ap_buf[a_first] = (uint16_t) ((ap_buf[a_first] << 8)
+                                    | (ap_buf[a_first] >> 8));
+    }
+}
+
+static void
+scalar_swap32_from (uint32_t * ap_buf, size_t a_first,
+                    const size_t a_nsamples)
+{
+  for (; a_first < a_nsamples; ++a_first)
+    {
+      const uint32_t v = ap_buf[a_first];
+      ap_buf[a_first] = (v << 24) | ((v << 8) & 0x00FF0000)
+                        | ((v >> 8) & 0x0000FF00) | (v >> 24);
+    }
+}
+
+static void
+scalar_swap16 (void * ap_buf, const size_t a_nsamples)
+{
+  scalar_swap16_from (ap_buf, 0, a_nsamples);
+}
+
+static void
+scalar_swap32 (void * ap_buf, const size_t a_nsamples)
+{
+  scalar_swap32_from (ap_buf, 0, a_nsamples);
+}
+
+static void
+scalar_swap24 (void * ap_buf, const size_t a_nsamples)
+{
+  uint8_t * p_sample = ap_buf;
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i, p_sample += 3)
+    {
+      const uint8_t b = p_sample[0];
+      p_sample[0] = p_sample[2];
+      p_sample[2] = b;
+    }
+}
+
+/* Rounds to the nearest (halves away from zero) and saturates to a_bits */
+static inline int32_t
+fixed_round (const int32_t a_value, const unsigned int a_fracbits,
+             const unsigned int a_bits)
+{
+  const int shift = (int) a_fracbits - (int) (a_bits - 1);
+  const int64_t max = ((int64_t) 1 << (a_bits - 1)) - 1;
+  int64_t v = a_value;
+  if (shift > 0)
+    {
+      v = ((v >> (shift - 1)) + 1) >> 1;
+    }
+  else
+    {
+      v *= (int64_t) 1 << -shift;
+    }
+  return (int32_t) (v > max ? max : (v < -max - 1 ? -max - 1 : v));
+}
+
+/* NaNs end up at the minimum */
+static inline int32_t
+float_round (float a_value, const float a_min, const float a_max)
+{
+  a_value = a_value >= a_max ? a_max : (a_value > a_min ? a_value : a_min);
+  return (int32_t) (a_value + copysignf (0.5f, a_value));
+}
+
+static inline int32_t
+double_round (double a_value, const double a_min, const double a_max)
+{
+  a_value = a_value >= a_max ? a_max : (a_value > a_min ? a_value : a_min);
+  return (int32_t) (a_value + copysign (0.5, a_value));
+}
+
+/* A xorshift generator; returns a uniform value in [0, 1) */
+static inline float
+dither_uniform (uint32_t * ap_state)
+{
+  uint32_t x = *ap_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *ap_state = x;
+  return (float) (x >> 8) * PCM_DITHER_SCALE;
+}
+
+static inline float
+dither_tpdf (tiz_pcm_dither_t * ap_dither)
+{
+  float u1 = 0.f;
+  float u2 = 0.f;
+  if (!ap_dither)
+    {
+      return 0.f;
+    }
+  u1 = dither_uniform (&ap_dither->state[0]);
+  u2 = dither_uniform (&ap_dither->state[0]);
+  return u1 - u2;
+}
+
+static void
+scalar_fixed_from (void * ap_dst, const tiz_pcm_format_t a_fmt,
+                   const int32_t * const * app_planes, const size_t a_nplanes,
+                   const size_t a_first, const size_t a_nsamples,
+                   const unsigned int a_fracbits)
+{
+  const float scale = 1.f / (float) ((uint32_t) 1 << a_fracbits);
+  size_t p = 0;
+  for (p = 0; p < a_nplanes; ++p)
+    {
+      const int32_t * p_src = app_planes[p];
+      size_t i = a_first;
+      size_t j = a_first * a_nplanes + p;
+      switch (a_fmt)
+        {
+          case ETIZPcmFormatS16:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                ((int16_t *) ap_dst)[j]
+                  = (int16_t) fixed_round (p_src[i], a_fracbits, 16);
+              }
+            break;
+          case ETIZPcmFormatS24:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                s24_store ((uint8_t *) ap_dst + j * 3,
+                           fixed_round (p_src[i], a_fracbits, 24));
+              }
+            break;
+          case ETIZPcmFormatS32:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                ((int32_t *) ap_dst)[j] = fixed_round (p_src[i], a_fracbits, 32);
+              }
+            break;
+          case ETIZPcmFormatFloat:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                ((float *) ap_dst)[j]
+                  = clampf ((float) p_src[i] * scale, -1.f, 1.f);
+              }
+            break;
+          default:
+            assert (0);
+            break;
+        };
+    }
+}
+
+static void
+scalar_float_from (void * ap_dst, const tiz_pcm_format_t a_fmt,
+                   const float * const * app_planes, const size_t a_nplanes,
+                   const size_t a_first, const size_t a_nsamples,
+                   tiz_pcm_dither_t * ap_dither)
+{
+  size_t p = 0;
+  for (p = 0; p < a_nplanes; ++p)
+    {
+      const float * p_src = app_planes[p];
+      size_t i = a_first;
+      size_t j = a_first * a_nplanes + p;
+      switch (a_fmt)
+        {
+          case ETIZPcmFormatS16:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                ((int16_t *) ap_dst)[j] = (int16_t) float_round (
+                  p_src[i] * PCM_S16_SCALE + dither_tpdf (ap_dither),
+                  PCM_S16_MIN, PCM_S16_MAX);
+              }
+            break;
+          case ETIZPcmFormatS24:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                s24_store ((uint8_t *) ap_dst + j * 3,
+                           double_round (p_src[i] * PCM_S24_SCALE
+                                           + dither_tpdf (ap_dither),
+                                         PCM_S24_MIN, PCM_S24_MAX));
+              }
+            break;
+          case ETIZPcmFormatS32:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                ((int32_t *) ap_dst)[j] = double_round (
+                  p_src[i] * PCM_S32_SCALE + dither_tpdf (ap_dither),
+                  PCM_S32_MIN, PCM_S32_MAX);
+              }
+            break;
+          case ETIZPcmFormatFloat:
+            for (; i < a_nsamples; ++i, j += a_nplanes)
+              {
+                ((float *) ap_dst)[j] = p_src[i];
+              }
+            break;
+          default:
+            assert (0);
+            break;
+        };
+    }
+}
+
+static void
+scalar_fixed_s16 (int16_t * ap_dst, const int32_t * const * app_planes,
+                  const size_t a_nplanes, const size_t a_nsamples,
+                  const unsigned int a_fracbits)
+{
+  scalar_fixed_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, 0,
+                     a_nsamples, a_fracbits);
+}
+
+static void
+scalar_float_s16 (int16_t * ap_dst, const float * const * app_planes,
+                  const size_t a_nplanes, const size_t a_nsamples,
+                  tiz_pcm_dither_t * ap_dither)
+{
+  scalar_float_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, 0,
+                     a_nsamples, ap_dither);
+}
+
+static void
+scalar_float_flt (float * ap_dst, const float * const * app_planes,
+                  const size_t a_nsamples)
+{
+  scalar_float_from (ap_dst, ETIZPcmFormatFloat, app_planes, 2, 0, a_nsamples,
+                     NULL);
+}
+
+static const pcm_kernels_t scalar_kernels = {
+  ETIZPcmIsaScalar,
+  1,
+  {scalar_s16, scalar_s24, scalar_s32, scalar_flt},
+  scalar_swap16,
+  scalar_swap32,
+  scalar_fixed_s16,
+  scalar_float_s16,
+  scalar_float_flt};
+
+#ifdef PCM_HAVE_X86
+
+/*
+ * SSE2 kernels
+ */
+
+PCM_TARGET_SSE2 static inline __m128
+sse2_gain (const __m128 a_from, const __m128 a_step, __m128i * ap_frame,
+           const __m128i a_frame_inc)
+{
+  const __m128 gain
+    = _mm_add_ps (a_from, _mm_mul_ps (a_step, _mm_cvtepi32_ps (*ap_frame)));
+  *ap_frame = _mm_add_epi32 (*ap_frame, a_frame_inc);
+  return gain;
+}
+
+PCM_TARGET_SSE2 static void
+sse2_s16 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  int16_t * p_buf = ap_buf;
+  const __m128 from = _mm_set1_ps (a_from);
+  const __m128 step = _mm_set1_ps (a_step);
+  const __m128 min = _mm_set1_ps (PCM_S16_MIN);
+  const __m128 max = _mm_set1_ps (PCM_S16_MAX);
+  const int ch = (int) a_channels;
+  const __m128i frame_inc = _mm_set1_epi32 (4 / ch);
+  __m128i frame = _mm_setr_epi32 (0, 1 / ch, 2 / ch, 3 / ch);
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i x = _mm_loadu_si128 ((const __m128i *) (p_buf + i));
+      const __m128 g0 = sse2_gain (from, step, &frame, frame_inc);
+      const __m128 g1 = sse2_gain (from, step, &frame, frame_inc);
+      __m128 f0 = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpacklo_epi16 (x, x), 16));
+      __m128 f1 = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpackhi_epi16 (x, x), 16));
+      f0 = _mm_max_ps (_mm_min_ps (_mm_mul_ps (f0, g0), max), min);
+      f1 = _mm_max_ps (_mm_min_ps (_mm_mul_ps (f1, g1), max), min);
+      _mm_storeu_si128 ((__m128i *) (p_buf + i),
+                        _mm_packs_epi32 (_mm_cvttps_epi32 (f0),
+                                         _mm_cvttps_epi32 (f1)));
+    }
+  scalar_s16_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+PCM_TARGET_SSE2 static void
+sse2_s32 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  int32_t * p_buf = ap_buf;
+  const __m128 from = _mm_set1_ps (a_from);
+  const __m128 step = _mm_set1_ps (a_step);
+  const __m128d min = _mm_set1_pd (PCM_S32_MIN);
+  const __m128d max = _mm_set1_pd (PCM_S32_MAX);
+  const int ch = (int) a_channels;
+  const __m128i frame_inc = _mm_set1_epi32 (4 / ch);
+  __m128i frame = _mm_setr_epi32 (0, 1 / ch, 2 / ch, 3 / ch);
+  size_t i = 0;
+
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      const __m128i x = _mm_loadu_si128 ((const __m128i *) (p_buf + i));
+      const __m128 g = sse2_gain (from, step, &frame, frame_inc);
+      __m128d d0 = _mm_cvtepi32_pd (x);
+      __m128d d1 = _mm_cvtepi32_pd (_mm_srli_si128 (x, 8));
+      d0 = _mm_mul_pd (d0, _mm_cvtps_pd (g));
+      d1 = _mm_mul_pd (d1, _mm_cvtps_pd (_mm_movehl_ps (g, g)));
+      d0 = _mm_max_pd (_mm_min_pd (d0, max), min);
+      d1 = _mm_max_pd (_mm_min_pd (d1, max), min);
+      _mm_storeu_si128 ((__m128i *) (p_buf + i),
+                        _mm_unpacklo_epi64 (_mm_cvttpd_epi32 (d0),
+                                            _mm_cvttpd_epi32 (d1)));
+    }
+  scalar_s32_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+PCM_TARGET_SSE2 static void
+sse2_flt (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  float * p_buf = ap_buf;
+  const __m128 from = _mm_set1_ps (a_from);
+  const __m128 step = _mm_set1_ps (a_step);
+  const __m128 min = _mm_set1_ps (-1.f);
+  const __m128 max = _mm_set1_ps (1.f);
+  const int ch = (int) a_channels;
+  const __m128i frame_inc = _mm_set1_epi32 (4 / ch);
+  __m128i frame = _mm_setr_epi32 (0, 1 / ch, 2 / ch, 3 / ch);
+  size_t i = 0;
+
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      const __m128 g = sse2_gain (from, step, &frame, frame_inc);
+      const __m128 f = _mm_mul_ps (_mm_loadu_ps (p_buf + i), g);
+      _mm_storeu_ps (p_buf + i, _mm_max_ps (_mm_min_ps (f, max), min));
+    }
+  scalar_flt_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+PCM_TARGET_SSE2 static void
+sse2_swap16 (void * ap_buf, const size_t a_nsamples)
+{
+  uint16_t * p_buf = ap_buf;
+  size_t i = 0;
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i x = _mm_loadu_si128 ((const __m128i *) (p_buf + i));
+      _mm_storeu_si128 ((__m128i *) (p_buf + i),
+                        _mm_or_si128 (_mm_slli_epi16 (x, 8),
+                                      _mm_srli_epi16 (x, 8)));
+    }
+  scalar_swap16_from (p_buf, i, a_nsamples);
+}
+
+PCM_TARGET_SSE2 static void
+sse2_swap32 (void * ap_buf, const size_t a_nsamples)
+{
+  uint32_t * p_buf = ap_buf;
+  size_t i = 0;
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      __m128i x = _mm_loadu_si128 ((const __m128i *) (p_buf + i));
+      /* Swap the 16-bit halves, then the bytes in each half */
+      x = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (x, 0xB1), 0xB1);
+      _mm_storeu_si128 ((__m128i *) (p_buf + i),
+                        _mm_or_si128 (_mm_slli_epi16 (x, 8),
+                                      _mm_srli_epi16 (x, 8)));
+    }
+  scalar_swap32_from (p_buf, i, a_nsamples);
+}
+
+PCM_TARGET_SSE2 static inline __m128
+sse2_dither_uniform (__m128i * ap_state)
+{
+  __m128i x = *ap_state;
+  x = _mm_xor_si128 (x, _mm_slli_epi32 (x, 13));
+  x = _mm_xor_si128 (x, _mm_srli_epi32 (x, 17));
+  x = _mm_xor_si128 (x, _mm_slli_epi32 (x, 5));
+  *ap_state = x;
+  return _mm_mul_ps (_mm_cvtepi32_ps (_mm_srli_epi32 (x, 8)),
+                     _mm_set1_ps (PCM_DITHER_SCALE));
+}
+
+/* a_count holds the shift minus one */
+PCM_TARGET_SSE2 static inline __m128i
+sse2_load_fixed (const int32_t * ap_src, const int a_shift,
+                 const __m128i a_count)
+{
+  __m128i x = _mm_loadu_si128 ((const __m128i *) ap_src);
+  if (a_shift > 0)
+    {
+      x = _mm_srai_epi32 (
+        _mm_add_epi32 (_mm_sra_epi32 (x, a_count), _mm_set1_epi32 (1)), 1);
+    }
+  return x;
+}
+
+PCM_TARGET_SSE2 static inline __m128i
+sse2_load_float_s16 (const float * ap_src, __m128i * ap_state)
+{
+  __m128 v = _mm_mul_ps (_mm_loadu_ps (ap_src), _mm_set1_ps (PCM_S16_SCALE));
+  if (ap_state)
+    {
+      const __m128 u1 = sse2_dither_uniform (ap_state);
+      const __m128 u2 = sse2_dither_uniform (ap_state);
+      v = _mm_add_ps (v, _mm_sub_ps (u1, u2));
+    }
+  v = _mm_max_ps (_mm_min_ps (v, _mm_set1_ps (PCM_S16_MAX)),
+                  _mm_set1_ps (PCM_S16_MIN));
+  /* Round halves away from zero, as the scalar code does */
+  v = _mm_add_ps (v, _mm_or_ps (_mm_set1_ps (0.5f),
+                                _mm_and_ps (v, _mm_set1_ps (-0.f))));
+  return _mm_cvttps_epi32 (v);
+}
+
+PCM_TARGET_SSE2 static inline void
+sse2_store_s16 (int16_t * ap_dst, const size_t a_nplanes, const __m128i a_l,
+                const __m128i a_r)
+{
+  if (1 == a_nplanes)
+    {
+      _mm_storeu_si128 ((__m128i *) ap_dst, a_l);
+    }
+  else
+    {
+      _mm_storeu_si128 ((__m128i *) ap_dst, _mm_unpacklo_epi16 (a_l, a_r));
+      _mm_storeu_si128 ((__m128i *) (ap_dst + 8),
+                        _mm_unpackhi_epi16 (a_l, a_r));
+    }
+}
+
+PCM_TARGET_SSE2 static void
+sse2_fixed_s16 (int16_t * ap_dst, const int32_t * const * app_planes,
+                const size_t a_nplanes, const size_t a_nsamples,
+                const unsigned int a_fracbits)
+{
+  const int shift = (int) a_fracbits - 15;
+  const __m128i count = _mm_cvtsi32_si128 (shift - 1);
+  const int32_t * p_l = app_planes[0];
+  const int32_t * p_r = app_planes[a_nplanes - 1];
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i l = _mm_packs_epi32 (sse2_load_fixed (p_l + i, shift, count),
+                                         sse2_load_fixed (p_l + i + 4, shift, count));
+      const __m128i r
+        = (1 == a_nplanes)
+            ? l
+            : _mm_packs_epi32 (sse2_load_fixed (p_r + i, shift, count),
+                               sse2_load_fixed (p_r + i + 4, shift, count));
+      sse2_store_s16 (ap_dst + i * a_nplanes, a_nplanes, l, r);
+    }
+  scalar_fixed_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, i,
+                     a_nsamples, a_fracbits);
+}
+
+PCM_TARGET_SSE2 static void
+sse2_float_s16 (int16_t * ap_dst, const float * const * app_planes,
+                const size_t a_nplanes, const size_t a_nsamples,
+                tiz_pcm_dither_t * ap_dither)
+{
+  const float * p_l = app_planes[0];
+  const float * p_r = app_planes[a_nplanes - 1];
+  __m128i state = ap_dither
+                    ? _mm_loadu_si128 ((const __m128i *) ap_dither->state)
+                    : _mm_setzero_si128 ();
+  __m128i * p_state = ap_dither ? &state : NULL;
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m128i l0 = sse2_load_float_s16 (p_l + i, p_state);
+      const __m128i l1 = sse2_load_float_s16 (p_l + i + 4, p_state);
+      __m128i r0 = l0;
+      __m128i r1 = l1;
+      if (2 == a_nplanes)
+        {
+          r0 = sse2_load_float_s16 (p_r + i, p_state);
+          r1 = sse2_load_float_s16 (p_r + i + 4, p_state);
+        }
+      sse2_store_s16 (ap_dst + i * a_nplanes, a_nplanes,
+                      _mm_packs_epi32 (l0, l1), _mm_packs_epi32 (r0, r1));
+    }
+  if (ap_dither)
+    {
+      _mm_storeu_si128 ((__m128i *) ap_dither->state, state);
+    }
+  scalar_float_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, i,
+                     a_nsamples, ap_dither);
+}
+
+PCM_TARGET_SSE2 static void
+sse2_float_flt (float * ap_dst, const float * const * app_planes,
+                const size_t a_nsamples)
+{
+  const float * p_l = app_planes[0];
+  const float * p_r = app_planes[1];
+  size_t i = 0;
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      const __m128 l = _mm_loadu_ps (p_l + i);
+      const __m128 r = _mm_loadu_ps (p_r + i);
+      _mm_storeu_ps (ap_dst + i * 2, _mm_unpacklo_ps (l, r));
+      _mm_storeu_ps (ap_dst + i * 2 + 4, _mm_unpackhi_ps (l, r));
+    }
+  scalar_float_from (ap_dst, ETIZPcmFormatFloat, app_planes, 2, i, a_nsamples,
+                     NULL);
+}
+
+static const pcm_kernels_t sse2_kernels = {
+  ETIZPcmIsaSse2,
+  4,
+  {sse2_s16, scalar_s24, sse2_s32, sse2_flt},
+  sse2_swap16,
+  sse2_swap32,
+  sse2_fixed_s16,
+  sse2_float_s16,
+  sse2_float_flt};
+
+/*
+ * AVX2 kernels
+ */
+
+PCM_TARGET_AVX2 static inline __m256
+avx2_gain (const __m256 a_from, const __m256 a_step, __m256i * ap_frame,
+           const __m256i a_frame_inc)
+{
+  const __m256 gain = _mm256_add_ps (
+    a_from, _mm256_mul_ps (a_step, _mm256_cvtepi32_ps (*ap_frame)));
+  *ap_frame = _mm256_add_epi32 (*ap_frame, a_frame_inc);
+  return gain;
+}
+
+PCM_TARGET_AVX2 static inline __m256i
+avx2_first_frames (const int a_channels)
+{
+  return _mm256_setr_epi32 (0, 1 / a_channels, 2 / a_channels,
+                            3 / a_channels, 4 / a_channels, 5 / a_channels,
+                            6 / a_channels, 7 / a_channels);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_s16 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  int16_t * p_buf = ap_buf;
+  const __m256 from = _mm256_set1_ps (a_from);
+  const __m256 step = _mm256_set1_ps (a_step);
+  const __m256 min = _mm256_set1_ps (PCM_S16_MIN);
+  const __m256 max = _mm256_set1_ps (PCM_S16_MAX);
+  const __m256i frame_inc = _mm256_set1_epi32 (8 / (int) a_channels);
+  __m256i frame = avx2_first_frames ((int) a_channels);
+  size_t i = 0;
+
+  for (; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m256i x = _mm256_loadu_si256 ((const __m256i *) (p_buf + i));
+      const __m256 g0 = avx2_gain (from, step, &frame, frame_inc);
+      const __m256 g1 = avx2_gain (from, step, &frame, frame_inc);
+      __m256 f0 = _mm256_cvtepi32_ps (
+        _mm256_cvtepi16_epi32 (_mm256_castsi256_si128 (x)));
+      __m256 f1 = _mm256_cvtepi32_ps (
+        _mm256_cvtepi16_epi32 (_mm256_extracti128_si256 (x, 1)));
+      f0 = _mm256_max_ps (_mm256_min_ps (_mm256_mul_ps (f0, g0), max), min);
+      f1 = _mm256_max_ps (_mm256_min_ps (_mm256_mul_ps (f1, g1), max), min);
+      /* The pack works within each 128-bit lane; put the halves back in
+         order */
+      _mm256_storeu_si256 (
+        (__m256i *) (p_buf + i),
+        _mm256_permute4x64_epi64 (_mm256_packs_epi32 (_mm256_cvttps_epi32 (f0),
+                                                      _mm256_cvttps_epi32 (f1)),
+                                  0xD8));
+    }
+  scalar_s16_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_s32 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  int32_t * p_buf = ap_buf;
+  const __m256 from = _mm256_set1_ps (a_from);
+  const __m256 step = _mm256_set1_ps (a_step);
+  const __m256d min = _mm256_set1_pd (PCM_S32_MIN);
+  const __m256d max = _mm256_set1_pd (PCM_S32_MAX);
+  const __m256i frame_inc = _mm256_set1_epi32 (8 / (int) a_channels);
+  __m256i frame = avx2_first_frames ((int) a_channels);
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m256 g = avx2_gain (from, step, &frame, frame_inc);
+      __m256d d0 = _mm256_cvtepi32_pd (
+        _mm_loadu_si128 ((const __m128i *) (p_buf + i)));
+      __m256d d1 = _mm256_cvtepi32_pd (
+        _mm_loadu_si128 ((const __m128i *) (p_buf + i + 4)));
+      d0 = _mm256_mul_pd (d0, _mm256_cvtps_pd (_mm256_castps256_ps128 (g)));
+      d1 = _mm256_mul_pd (d1, _mm256_cvtps_pd (_mm256_extractf128_ps (g, 1)));
+      d0 = _mm256_max_pd (_mm256_min_pd (d0, max), min);
+      d1 = _mm256_max_pd (_mm256_min_pd (d1, max), min);
+      _mm_storeu_si128 ((__m128i *) (p_buf + i), _mm256_cvttpd_epi32 (d0));
+      _mm_storeu_si128 ((__m128i *) (p_buf + i + 4), _mm256_cvttpd_epi32 (d1));
+    }
+  scalar_s32_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_flt (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  float * p_buf = ap_buf;
+  const __m256 from = _mm256_set1_ps (a_from);
+  const __m256 step = _mm256_set1_ps (a_step);
+  const __m256 min = _mm256_set1_ps (-1.f);
+  const __m256 max = _mm256_set1_ps (1.f);
+  const __m256i frame_inc = _mm256_set1_epi32 (8 / (int) a_channels);
+  __m256i frame = avx2_first_frames ((int) a_channels);
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m256 g = avx2_gain (from, step, &frame, frame_inc);
+      const __m256 f = _mm256_mul_ps (_mm256_loadu_ps (p_buf + i), g);
+      _mm256_storeu_ps (p_buf + i,
+                        _mm256_max_ps (_mm256_min_ps (f, max), min));
+    }
+  scalar_flt_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_swap (void * ap_buf, const size_t a_nbytes, const __m256i a_mask)
+{
+  uint8_t * p_buf = ap_buf;
+  size_t i = 0;
+  for (; i + 32 <= a_nbytes; i += 32)
+    {
+      const __m256i x = _mm256_loadu_si256 ((const __m256i *) (p_buf + i));
+      _mm256_storeu_si256 ((__m256i *) (p_buf + i),
+                           _mm256_shuffle_epi8 (x, a_mask));
+    }
+}
+
+PCM_TARGET_AVX2 static void
+avx2_swap16 (void * ap_buf, const size_t a_nsamples)
+{
+  const __m256i mask = _mm256_setr_epi8 (
+    1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7,
+    6, 9, 8, 11, 10, 13, 12, 15, 14);
+  avx2_swap (ap_buf, a_nsamples * 2, mask);
+  scalar_swap16_from (ap_buf, a_nsamples & ~((size_t) 15), a_nsamples);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_swap32 (void * ap_buf, const size_t a_nsamples)
+{
+  const __m256i mask = _mm256_setr_epi8 (
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5,
+    4, 11, 10, 9, 8, 15, 14, 13, 12);
+  avx2_swap (ap_buf, a_nsamples * 4, mask);
+  scalar_swap32_from (ap_buf, a_nsamples & ~((size_t) 7), a_nsamples);
+}
+
+PCM_TARGET_AVX2 static inline __m256
+avx2_dither_uniform (__m256i * ap_state)
+{
+  __m256i x = *ap_state;
+  x = _mm256_xor_si256 (x, _mm256_slli_epi32 (x, 13));
+  x = _mm256_xor_si256 (x, _mm256_srli_epi32 (x, 17));
+  x = _mm256_xor_si256 (x, _mm256_slli_epi32 (x, 5));
+  *ap_state = x;
+  return _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_srli_epi32 (x, 8)),
+                        _mm256_set1_ps (PCM_DITHER_SCALE));
+}
+
+PCM_TARGET_AVX2 static inline __m256i
+avx2_load_fixed (const int32_t * ap_src, const int a_shift,
+                 const __m128i a_count)
+{
+  __m256i x = _mm256_loadu_si256 ((const __m256i *) ap_src);
+  if (a_shift > 0)
+    {
+      x = _mm256_srai_epi32 (
+        _mm256_add_epi32 (_mm256_sra_epi32 (x, a_count), _mm256_set1_epi32 (1)),
+        1);
+    }
+  return x;
+}
+
+PCM_TARGET_AVX2 static inline __m256i
+avx2_load_float_s16 (const float * ap_src, __m256i * ap_state)
+{
+  __m256 v = _mm256_mul_ps (_mm256_loadu_ps (ap_src),
+                            _mm256_set1_ps (PCM_S16_SCALE));
+  if (ap_state)
+    {
+      const __m256 u1 = avx2_dither_uniform (ap_state);
+      const __m256 u2 = avx2_dither_uniform (ap_state);
+      v = _mm256_add_ps (v, _mm256_sub_ps (u1, u2));
+    }
+  v = _mm256_max_ps (_mm256_min_ps (v, _mm256_set1_ps (PCM_S16_MAX)),
+                     _mm256_set1_ps (PCM_S16_MIN));
+  v = _mm256_add_ps (v, _mm256_or_ps (_mm256_set1_ps (0.5f),
+                                      _mm256_and_ps (v, _mm256_set1_ps (-0.f))));
+  return _mm256_cvttps_epi32 (v);
+}
+
+/* Packs 16 samples of each plane, in order */
+PCM_TARGET_AVX2 static inline void
+avx2_store_s16 (int16_t * ap_dst, const size_t a_nplanes, const __m256i a_l0,
+                const __m256i a_l1, const __m256i a_r0, const __m256i a_r1)
+{
+  const __m256i l
+    = _mm256_permute4x64_epi64 (_mm256_packs_epi32 (a_l0, a_l1), 0xD8);
+  if (1 == a_nplanes)
+    {
+      _mm256_storeu_si256 ((__m256i *) ap_dst, l);
+    }
+  else
+    {
+      const __m256i r
+        = _mm256_permute4x64_epi64 (_mm256_packs_epi32 (a_r0, a_r1), 0xD8);
+      const __m256i lo = _mm256_unpacklo_epi16 (l, r);
+      const __m256i hi = _mm256_unpackhi_epi16 (l, r);
+      _mm256_storeu_si256 ((__m256i *) ap_dst,
+                           _mm256_permute2x128_si256 (lo, hi, 0x20));
+      _mm256_storeu_si256 ((__m256i *) (ap_dst + 16),
+                           _mm256_permute2x128_si256 (lo, hi, 0x31));
+    }
+}
+
+PCM_TARGET_AVX2 static void
+avx2_fixed_s16 (int16_t * ap_dst, const int32_t * const * app_planes,
+                const size_t a_nplanes, const size_t a_nsamples,
+                const unsigned int a_fracbits)
+{
+  const int shift = (int) a_fracbits - 15;
+  const __m128i count = _mm_cvtsi32_si128 (shift - 1);
+  const int32_t * p_l = app_planes[0];
+  const int32_t * p_r = app_planes[a_nplanes - 1];
+  size_t i = 0;
+
+  for (; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m256i l0 = avx2_load_fixed (p_l + i, shift, count);
+      const __m256i l1 = avx2_load_fixed (p_l + i + 8, shift, count);
+      __m256i r0 = l0;
+      __m256i r1 = l1;
+      if (2 == a_nplanes)
+        {
+          r0 = avx2_load_fixed (p_r + i, shift, count);
+          r1 = avx2_load_fixed (p_r + i + 8, shift, count);
+        }
+      avx2_store_s16 (ap_dst + i * a_nplanes, a_nplanes, l0, l1, r0, r1);
+    }
+  scalar_fixed_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, i,
+                     a_nsamples, a_fracbits);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_float_s16 (int16_t * ap_dst, const float * const * app_planes,
+                const size_t a_nplanes, const size_t a_nsamples,
+                tiz_pcm_dither_t * ap_dither)
+{
+  const float * p_l = app_planes[0];
+  const float * p_r = app_planes[a_nplanes - 1];
+  __m256i state = ap_dither
+                    ? _mm256_loadu_si256 ((const __m256i *) ap_dither->state)
+                    : _mm256_setzero_si256 ();
+  __m256i * p_state = ap_dither ? &state : NULL;
+  size_t i = 0;
+
+  for (; i + 16 <= a_nsamples; i += 16)
+    {
+      const __m256i l0 = avx2_load_float_s16 (p_l + i, p_state);
+      const __m256i l1 = avx2_load_float_s16 (p_l + i + 8, p_state);
+      __m256i r0 = l0;
+      __m256i r1 = l1;
+      if (2 == a_nplanes)
+        {
+          r0 = avx2_load_float_s16 (p_r + i, p_state);
+          r1 = avx2_load_float_s16 (p_r + i + 8, p_state);
+        }
+      avx2_store_s16 (ap_dst + i * a_nplanes, a_nplanes, l0, l1, r0, r1);
+    }
+  if (ap_dither)
+    {
+      _mm256_storeu_si256 ((__m256i *) ap_dither->state, state);
+    }
+  scalar_float_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, i,
+                     a_nsamples, ap_dither);
+}
+
+PCM_TARGET_AVX2 static void
+avx2_float_flt (float * ap_dst, const float * const * app_planes,
+                const size_t a_nsamples)
+{
+  const float * p_l = app_planes[0];
+  const float * p_r = app_planes[1];
+  size_t i = 0;
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const __m256 l = _mm256_loadu_ps (p_l + i);
+      const __m256 r = _mm256_loadu_ps (p_r + i);
+      const __m256 lo = _mm256_unpacklo_ps (l, r);
+      const __m256 hi = _mm256_unpackhi_ps (l, r);
+      _mm256_storeu_ps (ap_dst + i * 2, _mm256_permute2f128_ps (lo, hi, 0x20));
+      _mm256_storeu_ps (ap_dst + i * 2 + 8,
+                        _mm256_permute2f128_ps (lo, hi, 0x31));
+    }
+  scalar_float_from (ap_dst, ETIZPcmFormatFloat, app_planes, 2, i, a_nsamples,
+                     NULL);
+}
+
+static const pcm_kernels_t avx2_kernels = {
+  ETIZPcmIsaAvx2,
+  8,
+  {avx2_s16, scalar_s24, avx2_s32, avx2_flt},
+  avx2_swap16,
+  avx2_swap32,
+  avx2_fixed_s16,
+  avx2_float_s16,
+  avx2_float_flt};
+
+#endif /* PCM_HAVE_X86 */
+
+#ifdef PCM_HAVE_NEON
+
+/*
+ * NEON kernels
+ */
+
+static inline float32x4_t
+neon_gain (const float32x4_t a_from, const float32x4_t a_step,
+           int32x4_t * ap_frame, const int32x4_t a_frame_inc)
+{
+  /* Keep the multiply and the add apart, as the scalar code does */
+  const float32x4_t scaled = vmulq_f32 (a_step, vcvtq_f32_s32 (*ap_frame));
+  *ap_frame = vaddq_s32 (*ap_frame, a_frame_inc);
+  return vaddq_f32 (a_from, scaled);
+}
+
+static inline int32x4_t
+neon_first_frames (const int a_channels)
+{
+  const int32_t frames[4]
+    = {0, 1 / a_channels, 2 / a_channels, 3 / a_channels};
+  return vld1q_s32 (frames);
+}
+
+static void
+neon_s16 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  int16_t * p_buf = ap_buf;
+  const float32x4_t from = vdupq_n_f32 (a_from);
+  const float32x4_t step = vdupq_n_f32 (a_step);
+  const float32x4_t min = vdupq_n_f32 (PCM_S16_MIN);
+  const float32x4_t max = vdupq_n_f32 (PCM_S16_MAX);
+  const int32x4_t frame_inc = vdupq_n_s32 (4 / (int) a_channels);
+  int32x4_t frame = neon_first_frames ((int) a_channels);
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const int16x8_t x = vld1q_s16 (p_buf + i);
+      const float32x4_t g0 = neon_gain (from, step, &frame, frame_inc);
+      const float32x4_t g1 = neon_gain (from, step, &frame, frame_inc);
+      float32x4_t f0 = vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (x)));
+      float32x4_t f1 = vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (x)));
+      f0 = vmaxq_f32 (vminq_f32 (vmulq_f32 (f0, g0), max), min);
+      f1 = vmaxq_f32 (vminq_f32 (vmulq_f32 (f1, g1), max), min);
+      vst1q_s16 (p_buf + i, vcombine_s16 (vmovn_s32 (vcvtq_s32_f32 (f0)),
+                                          vmovn_s32 (vcvtq_s32_f32 (f1))));
+    }
+  scalar_s16_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+neon_s32 (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  int32_t * p_buf = ap_buf;
+  const float32x4_t from = vdupq_n_f32 (a_from);
+  const float32x4_t step = vdupq_n_f32 (a_step);
+  const float64x2_t min = vdupq_n_f64 (PCM_S32_MIN);
+  const float64x2_t max = vdupq_n_f64 (PCM_S32_MAX);
+  const int32x4_t frame_inc = vdupq_n_s32 (4 / (int) a_channels);
+  int32x4_t frame = neon_first_frames ((int) a_channels);
+  size_t i = 0;
+
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      const int32x4_t x = vld1q_s32 (p_buf + i);
+      const float32x4_t g = neon_gain (from, step, &frame, frame_inc);
+      float64x2_t d0 = vcvtq_f64_s64 (vmovl_s32 (vget_low_s32 (x)));
+      float64x2_t d1 = vcvtq_f64_s64 (vmovl_s32 (vget_high_s32 (x)));
+      d0 = vmulq_f64 (d0, vcvt_f64_f32 (vget_low_f32 (g)));
+      d1 = vmulq_f64 (d1, vcvt_f64_f32 (vget_high_f32 (g)));
+      d0 = vmaxq_f64 (vminq_f64 (d0, max), min);
+      d1 = vmaxq_f64 (vminq_f64 (d1, max), min);
+      vst1q_s32 (p_buf + i, vcombine_s32 (vmovn_s64 (vcvtq_s64_f64 (d0)),
+                                          vmovn_s64 (vcvtq_s64_f64 (d1))));
+    }
+  scalar_s32_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+neon_flt (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+          const float a_from, const float a_step)
+{
+  float * p_buf = ap_buf;
+  const float32x4_t from = vdupq_n_f32 (a_from);
+  const float32x4_t step = vdupq_n_f32 (a_step);
+  const float32x4_t min = vdupq_n_f32 (-1.f);
+  const float32x4_t max = vdupq_n_f32 (1.f);
+  const int32x4_t frame_inc = vdupq_n_s32 (4 / (int) a_channels);
+  int32x4_t frame = neon_first_frames ((int) a_channels);
+  size_t i = 0;
+
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      const float32x4_t g = neon_gain (from, step, &frame, frame_inc);
+      const float32x4_t f = vmulq_f32 (vld1q_f32 (p_buf + i), g);
+      vst1q_f32 (p_buf + i, vmaxq_f32 (vminq_f32 (f, max), min));
+    }
+  scalar_flt_from (p_buf, i, a_nsamples, a_channels, a_from, a_step);
+}
+
+static void
+neon_swap16 (void * ap_buf, const size_t a_nsamples)
+{
+  uint8_t * p_buf = ap_buf;
+  size_t i = 0;
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      vst1q_u8 (p_buf + i * 2, vrev16q_u8 (vld1q_u8 (p_buf + i * 2)));
+    }
+  scalar_swap16_from (ap_buf, i, a_nsamples);
+}
+
+static void
+neon_swap32 (void * ap_buf, const size_t a_nsamples)
+{
+  uint8_t * p_buf = ap_buf;
+  size_t i = 0;
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      vst1q_u8 (p_buf + i * 4, vrev32q_u8 (vld1q_u8 (p_buf + i * 4)));
+    }
+  scalar_swap32_from (ap_buf, i, a_nsamples);
+}
+
+static inline float32x4_t
+neon_dither_uniform (uint32x4_t * ap_state)
+{
+  uint32x4_t x = *ap_state;
+  x = veorq_u32 (x, vshlq_n_u32 (x, 13));
+  x = veorq_u32 (x, vshrq_n_u32 (x, 17));
+  x = veorq_u32 (x, vshlq_n_u32 (x, 5));
+  *ap_state = x;
+  return vmulq_f32 (vcvtq_f32_u32 (vshrq_n_u32 (x, 8)),
+                    vdupq_n_f32 (PCM_DITHER_SCALE));
+}
+
+/* a_count holds minus the shift plus one, i.e. a right shift */
+static inline int16x4_t
+neon_load_fixed (const int32_t * ap_src, const int a_shift,
+                 const int32x4_t a_count)
+{
+  int32x4_t x = vld1q_s32 (ap_src);
+  if (a_shift > 0)
+    {
+      x = vshrq_n_s32 (vaddq_s32 (vshlq_s32 (x, a_count), vdupq_n_s32 (1)), 1);
+    }
+  return vqmovn_s32 (x);
+}
+
+static inline int16x4_t
+neon_load_float_s16 (const float * ap_src, uint32x4_t * ap_state)
+{
+  const uint32x4_t sign = vdupq_n_u32 (0x80000000);
+  float32x4_t v = vmulq_f32 (vld1q_f32 (ap_src), vdupq_n_f32 (PCM_S16_SCALE));
+  if (ap_state)
+    {
+      const float32x4_t u1 = neon_dither_uniform (ap_state);
+      const float32x4_t u2 = neon_dither_uniform (ap_state);
+      v = vaddq_f32 (v, vsubq_f32 (u1, u2));
+    }
+  v = vmaxq_f32 (vminq_f32 (v, vdupq_n_f32 (PCM_S16_MAX)),
+                 vdupq_n_f32 (PCM_S16_MIN));
+  v = vaddq_f32 (v, vreinterpretq_f32_u32 (vorrq_u32 (
+                      vreinterpretq_u32_f32 (vdupq_n_f32 (0.5f)),
+                      vandq_u32 (vreinterpretq_u32_f32 (v), sign))));
+  return vmovn_s32 (vcvtq_s32_f32 (v));
+}
+
+static inline void
+neon_store_s16 (int16_t * ap_dst, const size_t a_nplanes, const int16x8_t a_l,
+                const int16x8_t a_r)
+{
+  if (1 == a_nplanes)
+    {
+      vst1q_s16 (ap_dst, a_l);
+    }
+  else
+    {
+      int16x8x2_t lr;
+      lr.val[0] = a_l;
+      lr.val[1] = a_r;
+      vst2q_s16 (ap_dst, lr);
+    }
+}
+
+static void
+neon_fixed_s16 (int16_t * ap_dst, const int32_t * const * app_planes,
+                const size_t a_nplanes, const size_t a_nsamples,
+                const unsigned int a_fracbits)
+{
+  const int shift = (int) a_fracbits - 15;
+  const int32x4_t count = vdupq_n_s32 (1 - shift);
+  const int32_t * p_l = app_planes[0];
+  const int32_t * p_r = app_planes[a_nplanes - 1];
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const int16x8_t l = vcombine_s16 (neon_load_fixed (p_l + i, shift, count),
+                                        neon_load_fixed (p_l + i + 4, shift, count));
+      const int16x8_t r
+        = (1 == a_nplanes)
+            ? l
+            : vcombine_s16 (neon_load_fixed (p_r + i, shift, count),
+                            neon_load_fixed (p_r + i + 4, shift, count));
+      neon_store_s16 (ap_dst + i * a_nplanes, a_nplanes, l, r);
+    }
+  scalar_fixed_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, i,
+                     a_nsamples, a_fracbits);
+}
+
+static void
+neon_float_s16 (int16_t * ap_dst, const float * const * app_planes,
+                const size_t a_nplanes, const size_t a_nsamples,
+                tiz_pcm_dither_t * ap_dither)
+{
+  const float * p_l = app_planes[0];
+  const float * p_r = app_planes[a_nplanes - 1];
+  uint32x4_t state = ap_dither ? vld1q_u32 (ap_dither->state) : vdupq_n_u32 (0);
+  uint32x4_t * p_state = ap_dither ? &state : NULL;
+  size_t i = 0;
+
+  for (; i + 8 <= a_nsamples; i += 8)
+    {
+      const int16x4_t l0 = neon_load_float_s16 (p_l + i, p_state);
+      const int16x4_t l1 = neon_load_float_s16 (p_l + i + 4, p_state);
+      int16x4_t r0 = l0;
+      int16x4_t r1 = l1;
+      if (2 == a_nplanes)
+        {
+          r0 = neon_load_float_s16 (p_r + i, p_state);
+          r1 = neon_load_float_s16 (p_r + i + 4, p_state);
+        }
+      neon_store_s16 (ap_dst + i * a_nplanes, a_nplanes, vcombine_s16 (l0, l1),
+                      vcombine_s16 (r0, r1));
+    }
+  if (ap_dither)
+    {
+      vst1q_u32 (ap_dither->state, state);
+    }
+  scalar_float_from (ap_dst, ETIZPcmFormatS16, app_planes, a_nplanes, i,
+                     a_nsamples, ap_dither);
+}
+
+static void
+neon_float_flt (float * ap_dst, const float * const * app_planes,
+                const size_t a_nsamples)
+{
+  size_t i = 0;
+  for (; i + 4 <= a_nsamples; i += 4)
+    {
+      float32x4x2_t lr;
+      lr.val[0] = vld1q_f32 (app_planes[0] + i);
+      lr.val[1] = vld1q_f32 (app_planes[1] + i);
+      vst2q_f32 (ap_dst + i * 2, lr);
+    }
+  scalar_float_from (ap_dst, ETIZPcmFormatFloat, app_planes, 2, i, a_nsamples,
+                     NULL);
+}
+
+static const pcm_kernels_t neon_kernels = {
+  ETIZPcmIsaNeon,
+  4,
+  {neon_s16, scalar_s24, neon_s32, neon_flt},
+  neon_swap16,
+  neon_swap32,
+  neon_fixed_s16,
+  neon_float_s16,
+  neon_float_flt};
+
+#endif /* PCM_HAVE_NEON */
+
+static const pcm_kernels_t *
+find_kernels (const tiz_pcm_isa_t a_isa)
+{
+  switch (a_isa)
+    {
+      case ETIZPcmIsaScalar:
+        return &scalar_kernels;
+#ifdef PCM_HAVE_X86
+      case ETIZPcmIsaSse2:
+        __builtin_cpu_init ();
+        return __builtin_cpu_supports ("sse2") ? &sse2_kernels : NULL;
+      case ETIZPcmIsaAvx2:
+        __builtin_cpu_init ();
+        return __builtin_cpu_supports ("avx2") ? &avx2_kernels : NULL;
+#endif
+#ifdef PCM_HAVE_NEON
+      case ETIZPcmIsaNeon:
+        /* NEON is mandatory on AArch64 */
+        return &neon_kernels;
+#endif
+      default:
+        break;
+    };
+  return NULL;
+}
+
+static void
+select_kernels (void)
+{
+  int isa = ETIZPcmIsaMax;
+  const pcm_kernels_t * p_kernels = NULL;
+  /* The instruction sets are listed in order of preference */
+  while (!p_kernels && --isa >= ETIZPcmIsaScalar)
+    {
+      p_kernels = find_kernels (isa);
+    }
+  assert (p_kernels);
+  gp_pcm_kernels = p_kernels;
+}
+
+static inline const pcm_kernels_t *
+get_kernels (void)
+{
+  (void) pthread_once (&g_pcm_once, select_kernels);
+  assert (gp_pcm_kernels);
+  return gp_pcm_kernels;
+}
+
+static void
+scale (void * ap_buf, const size_t a_nsamples, const size_t a_channels,
+       const tiz_pcm_format_t a_fmt, const float a_from, const float a_step)
+{
+  const pcm_kernels_t * p_kernels = get_kernels ();
+  assert (a_fmt < ETIZPcmFormatMax);
+  assert (a_channels > 0);
+  if (0 != p_kernels->lanes % a_channels)
+    {
+      /* e.g. 5.1 or 7.1 audio */
+      p_kernels = &scalar_kernels;
+    }
+  p_kernels->scale[a_fmt](ap_buf, a_nsamples, a_channels, a_from, a_step);
+}
+
+tiz_pcm_isa_t
+tiz_pcm_isa (void)
+{
+  return get_kernels ()->isa;
+}
+
+OMX_ERRORTYPE
+tiz_pcm_set_isa (const tiz_pcm_isa_t a_isa)
+{
+  const pcm_kernels_t * p_kernels = NULL;
+  (void) get_kernels ();
+  if (!(p_kernels = find_kernels (a_isa)))
+    {
+      return OMX_ErrorUnsupportedSetting;
+    }
+  gp_pcm_kernels = p_kernels;
+  return OMX_ErrorNone;
+}
+
+const char *
+tiz_pcm_isa_to_str (const tiz_pcm_isa_t a_isa)
+{
+  return (a_isa < ETIZPcmIsaMax) ? pcm_isa_names[a_isa] : "unknown";
+}
+
+OMX_ERRORTYPE
+tiz_pcm_format_from_pcmmode (const OMX_AUDIO_PARAM_PCMMODETYPE * ap_pcmmode,
+                             tiz_pcm_format_t * ap_fmt)
+{
+  assert (ap_pcmmode);
+  assert (ap_fmt);
+  switch (ap_pcmmode->nBitPerSample)
+    {
+      case 16:
+        *ap_fmt = ETIZPcmFormatS16;
+        break;
+      case 24:
+        *ap_fmt = ETIZPcmFormatS24;
+        break;
+      case 32:
+        *ap_fmt = ETIZPcmFormatFloat;
+        break;
+      default:
+        return OMX_ErrorBadParameter;
+    };
+  return OMX_ErrorNone;
+}
+
+OMX_BOOL
+tiz_pcm_needs_swap (const OMX_AUDIO_PARAM_PCMMODETYPE * ap_pcmmode)
+{
+  assert (ap_pcmmode);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return (OMX_EndianLittle == ap_pcmmode->eEndian) ? OMX_TRUE : OMX_FALSE;
+#else
+  return (OMX_EndianBig == ap_pcmmode->eEndian) ? OMX_TRUE : OMX_FALSE;
+#endif
+}
+
+size_t
+tiz_pcm_sample_size (const tiz_pcm_format_t a_fmt)
+{
+  switch (a_fmt)
+    {
+      case ETIZPcmFormatS16:
+        return 2;
+      case ETIZPcmFormatS24:
+        return 3;
+      case ETIZPcmFormatS32:
+      case ETIZPcmFormatFloat:
+        return 4;
+      default:
+        break;
+    };
+  return 0;
+}
+
+void
+tiz_pcm_gain (void * ap_buf, const size_t a_nsamples,
+              const tiz_pcm_format_t a_fmt, const float a_gain)
+{
+  assert (ap_buf || 0 == a_nsamples);
+  if (1.f != a_gain && a_nsamples > 0)
+    {
+      scale (ap_buf, a_nsamples, 1, a_fmt, a_gain, 0.f);
+    }
+}
+
+void
+tiz_pcm_ramp (void * ap_buf, const size_t a_nframes, const size_t a_channels,
+              const tiz_pcm_format_t a_fmt, const float a_from,
+              const float a_to)
+{
+  assert (ap_buf || 0 == a_nframes);
+  if (a_nframes > 0 && a_channels > 0)
+    {
+      scale (ap_buf, a_nframes * a_channels, a_channels, a_fmt, a_from,
+             (a_to - a_from) / (float) a_nframes);
+    }
+}
+
+void
+tiz_pcm_swap (void * ap_buf, const size_t a_nsamples,
+              const size_t a_sample_size)
+{
+  assert (ap_buf || 0 == a_nsamples);
+  switch (a_sample_size)
+    {
+      case 2:
+        get_kernels ()->swap16 (ap_buf, a_nsamples);
+        break;
+      case 3:
+        scalar_swap24 (ap_buf, a_nsamples);
+        break;
+      case 4:
+        get_kernels ()->swap32 (ap_buf, a_nsamples);
+        break;
+      default:
+        break;
+    };
+}
+
+void
+tiz_pcm_dither_init (tiz_pcm_dither_t * ap_dither, const uint32_t a_seed)
+{
+  uint32_t x = a_seed;
+  size_t i = 0;
+  assert (ap_dither);
+  for (i = 0; i < sizeof (ap_dither->state) / sizeof (ap_dither->state[0]);
+       ++i)
+    {
+      /* A xorshift generator must not start at zero */
+      x = x * 1664525 + 1013904223;
+      ap_dither->state[i] = x ? x : 1;
+    }
+}
+
+void
+tiz_pcm_from_fixed (void * ap_dst, const tiz_pcm_format_t a_dst_fmt,
+                    const int32_t * const * app_planes, const size_t a_nplanes,
+                    const size_t a_nsamples, const unsigned int a_fracbits)
+{
+  assert (ap_dst || 0 == a_nsamples);
+  assert (app_planes);
+  assert (a_nplanes > 0);
+  assert (a_dst_fmt < ETIZPcmFormatMax);
+  assert (a_fracbits < 32);
+  /* The vector kernels round with 32-bit arithmetic; a shift of one could
+     overflow, and left shifts are rare enough to leave to the scalar code */
+  if (ETIZPcmFormatS16 == a_dst_fmt && a_nplanes <= 2
+      && (15 == a_fracbits || a_fracbits > 16))
+    {
+      get_kernels ()->fixed_s16 (ap_dst, app_planes, a_nplanes, a_nsamples,
+                                 a_fracbits);
+    }
+  else
+    {
+      scalar_fixed_from (ap_dst, a_dst_fmt, app_planes, a_nplanes, 0,
+                         a_nsamples, a_fracbits);
+    }
+}
+
+void
+tiz_pcm_from_float (void * ap_dst, const tiz_pcm_format_t a_dst_fmt,
+                    const float * const * app_planes, const size_t a_nplanes,
+                    const size_t a_nsamples, tiz_pcm_dither_t * ap_dither)
+{
+  assert (ap_dst || 0 == a_nsamples);
+  assert (app_planes);
+  assert (a_nplanes > 0);
+  assert (a_dst_fmt < ETIZPcmFormatMax);
+  if (ETIZPcmFormatS16 == a_dst_fmt && a_nplanes <= 2)
+    {
+      get_kernels ()->float_s16 (ap_dst, app_planes, a_nplanes, a_nsamples,
+                                 ap_dither);
+    }
+  else if (ETIZPcmFormatFloat == a_dst_fmt && 1 == a_nplanes)
+    {
+      if (ap_dst != app_planes[0])
+        {
+          memmove (ap_dst, app_planes[0], a_nsamples * sizeof (float));
+        }
+    }
+  else if (ETIZPcmFormatFloat == a_dst_fmt && 2 == a_nplanes)
+    {
+      get_kernels ()->float_flt (ap_dst, app_planes, a_nsamples);
+    }
+  else
+    {
+      scalar_float_from (ap_dst, a_dst_fmt, app_planes, a_nplanes, 0,
+                         a_nsamples, ap_dither);
+    }
+}
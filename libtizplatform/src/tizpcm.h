@@ -0,0 +1,254 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizpcm.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia Platform - PCM sample processing kernels
+ *
+ *
+ */
+
+#ifndef TIZPCM_H
+#define TIZPCM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @defgroup tizpcm PCM processing kernels
+ *
+ * Gain, volume ramp and byte order conversion of interleaved PCM sample
+ * buffers, and conversion of decoder output (fixed-point or float, planar
+ * or interleaved) to interleaved PCM. Samples are in host byte order. Each
+ * kernel is implemented for the widest instruction set available at run
+ * time (AVX2 or SSE2 on x86, NEON on AArch64), with a scalar fallback. All
+ * implementations produce the same results, save for rounding differences
+ * of one unit in the last place in the ramps.
+ *
+ * @ingroup libtizplatform
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+#include <OMX_Audio.h>
+
+/**
+ * The sample formats supported.
+ * @ingroup tizpcm
+ */
+typedef enum tiz_pcm_format {
+  ETIZPcmFormatS16, /**< Signed 16-bit. */
+  ETIZPcmFormatS24, /**< Signed 24-bit, packed in 3 bytes. */
+  ETIZPcmFormatS32, /**< Signed 32-bit. */
+  ETIZPcmFormatFloat, /**< 32-bit float, nominal range [-1.0, 1.0]. */
+  ETIZPcmFormatMax
+} tiz_pcm_format_t;
+
+/**
+ * The instruction sets that the kernels may use.
+ * @ingroup tizpcm
+ */
+typedef enum tiz_pcm_isa {
+  ETIZPcmIsaScalar,
+  ETIZPcmIsaSse2,
+  ETIZPcmIsaAvx2,
+  ETIZPcmIsaNeon,
+  ETIZPcmIsaMax
+} tiz_pcm_isa_t;
+
+/**
+ * The state of the TPDF dither generator.
+ * @ingroup tizpcm
+ */
+typedef struct tiz_pcm_dither tiz_pcm_dither_t;
+struct tiz_pcm_dither
+{
+  /* One generator per vector lane */
+  uint32_t state[8];
+};
+
+/**
+ * Return the instruction set currently in use. This is the best one
+ * supported by the processor, unless overridden with tiz_pcm_set_isa.
+ *
+ * @ingroup tizpcm
+ */
+tiz_pcm_isa_t
+tiz_pcm_isa (void);
+
+/**
+ * Select the instruction set to be used by the kernels. This is meant for
+ * testing and benchmarking.
+ *
+ * @ingroup tizpcm
+ *
+ * @return OMX_ErrorNone on success, or OMX_ErrorUnsupportedSetting if the
+ * instruction set is not supported by this build or this processor.
+ */
+OMX_ERRORTYPE
+tiz_pcm_set_isa (const tiz_pcm_isa_t a_isa);
+
+/**
+ * Return the name of an instruction set.
+ *
+ * @ingroup tizpcm
+ */
+const char *
+tiz_pcm_isa_to_str (const tiz_pcm_isa_t a_isa);
+
+/**
+ * Return the size in bytes of a sample in the given format.
+ *
+ * @ingroup tizpcm
+ */
+size_t
+tiz_pcm_sample_size (const tiz_pcm_format_t a_fmt);
+
+/**
+ * Find the sample format described by a PCM mode structure. By convention,
+ * 32 bits per sample means float samples.
+ *
+ * @ingroup tizpcm
+ *
+ * @return OMX_ErrorNone on success, or OMX_ErrorBadParameter if the sample
+ * format is not supported.
+ */
+OMX_ERRORTYPE
+tiz_pcm_format_from_pcmmode (const OMX_AUDIO_PARAM_PCMMODETYPE * ap_pcmmode,
+                             tiz_pcm_format_t * ap_fmt);
+
+/**
+ * Find whether the byte order described by a PCM mode structure differs
+ * from the host's, i.e. whether samples need to be swapped with
+ * tiz_pcm_swap.
+ *
+ * @ingroup tizpcm
+ */
+OMX_BOOL
+tiz_pcm_needs_swap (const OMX_AUDIO_PARAM_PCMMODETYPE * ap_pcmmode);
+
+/**
+ * Multiply every sample by a constant gain. Integer results are truncated
+ * towards zero and saturated to the range of the format; float results are
+ * clipped to [-1.0, 1.0]. A gain of 1.0 leaves the samples untouched.
+ *
+ * @ingroup tizpcm
+ *
+ * @param ap_buf The samples.
+ * @param a_nsamples The number of samples (i.e. frames x channels).
+ * @param a_fmt The sample format.
+ * @param a_gain The linear gain factor.
+ */
+void
+tiz_pcm_gain (void * ap_buf, const size_t a_nsamples,
+              const tiz_pcm_format_t a_fmt, const float a_gain);
+
+/**
+ * Apply a linear gain ramp. All the samples of frame i are multiplied by
+ * a_from + (a_to - a_from) * i / a_nframes, so a ramp split across
+ * consecutive buffers continues seamlessly when each call starts at the
+ * gain where the previous one ended. Results are truncated and saturated as
+ * in tiz_pcm_gain.
+ *
+ * @ingroup tizpcm
+ *
+ * @param ap_buf The interleaved samples.
+ * @param a_nframes The number of frames.
+ * @param a_channels The number of channels (any number greater than zero).
+ * @param a_fmt The sample format.
+ * @param a_from The gain applied to the first frame.
+ * @param a_to The gain that the ramp reaches after the last frame.
+ */
+void
+tiz_pcm_ramp (void * ap_buf, const size_t a_nframes, const size_t a_channels,
+              const tiz_pcm_format_t a_fmt, const float a_from,
+              const float a_to);
+
+/**
+ * Reverse the byte order of every sample.
+ *
+ * @ingroup tizpcm
+ *
+ * @param ap_buf The samples.
+ * @param a_nsamples The number of samples (i.e. frames x channels).
+ * @param a_sample_size The size in bytes of a sample (2, 3 or 4; other
+ * sizes are left untouched).
+ */
+void
+tiz_pcm_swap (void * ap_buf, const size_t a_nsamples,
+              const size_t a_sample_size);
+
+/**
+ * Initialise a TPDF dither generator.
+ *
+ * @ingroup tizpcm
+ */
+void
+tiz_pcm_dither_init (tiz_pcm_dither_t * ap_dither, const uint32_t a_seed);
+
+/**
+ * Convert fixed-point samples (e.g. libmad's, or libFLAC's integer samples
+ * with a_fracbits = bits per sample - 1) to interleaved samples. Sample i of
+ * plane p is written to position i * a_nplanes + p; interleaved input is
+ * converted by passing it as a single plane. The same plane may be passed
+ * more than once (e.g. to output mono as stereo). Values are rounded to the
+ * nearest and saturated at [-1.0, 1.0).
+ *
+ * @ingroup tizpcm
+ *
+ * @param ap_dst The destination.
+ * @param a_dst_fmt The destination format.
+ * @param app_planes The source planes.
+ * @param a_nplanes The number of planes.
+ * @param a_nsamples The number of samples in each plane.
+ * @param a_fracbits The number of fractional bits in the source samples
+ * (0 to 31).
+ */
+void
+tiz_pcm_from_fixed (void * ap_dst, const tiz_pcm_format_t a_dst_fmt,
+                    const int32_t * const * app_planes, const size_t a_nplanes,
+                    const size_t a_nsamples, const unsigned int a_fracbits);
+
+/**
+ * Convert float samples (nominal range [-1.0, 1.0]) to interleaved samples,
+ * with the same plane layout as tiz_pcm_from_fixed. Integer results are
+ * rounded to the nearest and saturated; optionally, triangular (TPDF)
+ * dither of +/- 1 LSB is added before rounding. Float to float conversion is
+ * a plain copy.
+ *
+ * @ingroup tizpcm
+ *
+ * @param ap_dither The dither generator, or NULL for no dither.
+ */
+void
+tiz_pcm_from_float (void * ap_dst, const tiz_pcm_format_t a_dst_fmt,
+                    const float * const * app_planes, const size_t a_nplanes,
+                    const size_t a_nsamples, tiz_pcm_dither_t * ap_dither);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZPCM_H */
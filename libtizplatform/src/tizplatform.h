@@ -49,12 +49,15 @@
 #include "tizomxutils.h"
 #include "tizrc.h"
 #include "tizsoa.h"
+#include "tizslab.h"
+#include "tizpcm.h"
 #include "tizev.h"
 #include "tizhttp.h"
 #include "tizmap.h"
 #include "tizlimits.h"
 #include "tizprintf.h"
 #include "tizshufflelst.h"
+#include "tizurlcache.h"
 #include "tizurltransfer.h"
 
 /** @} */
@@ -63,6 +63,8 @@
     }                                                                       \
   while (0)
 
+#define TIZ_Q_CACHE_LINE_SIZE 64
+
 typedef struct tiz_queue_item tiz_queue_item_t;
 struct tiz_queue_item
 {
@@ -70,8 +72,18 @@ struct tiz_queue_item
   tiz_queue_item_t * p_next;
 };
 
+/* A slot in the lock-free ring. 'seq' tells producers and the consumer who
+   owns the slot at any given time (see D. Vyukov's bounded MPMC queue). */
+typedef struct tiz_queue_cell tiz_queue_cell_t;
+struct tiz_queue_cell
+{
+  size_t seq;
+  OMX_PTR p_data;
+};
+
 struct tiz_queue
 {
+  tiz_queue_type_t type;
   /*@null@ */ tiz_queue_item_t * p_first;
   /*@null@ */ tiz_queue_item_t * p_last;
   OMX_S32 capacity;
@@ -79,6 +91,18 @@ struct tiz_queue
   tiz_mutex_t mutex;
   tiz_cond_t cond_full;
   tiz_cond_t cond_empty;
+  /* Lock-free ring (ETIZQueueTypeLockFree only). The mutex and the condition
+     variables above are only used to park the consumer when the ring is empty,
+     and producers when the queue is full. */
+  /*@null@ */ tiz_queue_cell_t * p_cells;
+  size_t mask;
+  OMX_S32 consumer_waiting;
+  OMX_S32 producers_waiting;
+  char pad0[TIZ_Q_CACHE_LINE_SIZE];
+  size_t enq_pos; /* Shared by all producers */
+  char pad1[TIZ_Q_CACHE_LINE_SIZE];
+  size_t deq_pos; /* Owned by the consumer */
+  char pad2[TIZ_Q_CACHE_LINE_SIZE];
 };
 
 static inline void
@@ -87,10 +111,11 @@ deinit_queue_struct (/*@null@ */ tiz_queue_t * ap_q)
   /* Clean-up */
   if (ap_q)
     {
+      tiz_mem_free (ap_q->p_cells);
       (void) tiz_cond_destroy (&(ap_q->cond_empty));
       (void) tiz_cond_destroy (&(ap_q->cond_full));
       (void) tiz_mutex_destroy (&(ap_q->mutex));
-      tiz_mem_free (ap_q);
+      tiz_slab_free (ap_q);
     }
 }
 
@@ -98,14 +123,14 @@ deinit_queue_struct (/*@null@ */ tiz_queue_t * ap_q)
 init_queue_struct (void)
 {
   bool init_ok = false;
-  tiz_queue_t * p_q = (tiz_queue_t *) tiz_mem_calloc (1, sizeof (tiz_queue_t));
+  tiz_queue_t * p_q = (tiz_queue_t *) tiz_slab_calloc (sizeof (tiz_queue_t));
 
   TIZ_Q_GOTO_END_ON_NULL (p_q);
   TIZ_Q_GOTO_END_ON_ERROR (tiz_mutex_init (&(p_q->mutex)));
   TIZ_Q_GOTO_END_ON_ERROR (tiz_cond_init (&(p_q->cond_full)));
   TIZ_Q_GOTO_END_ON_ERROR (tiz_cond_init (&(p_q->cond_empty)));
   p_q->p_first
-    = (tiz_queue_item_t *) tiz_mem_calloc (1, sizeof (tiz_queue_item_t));
+    = (tiz_queue_item_t *) tiz_slab_calloc (sizeof (tiz_queue_item_t));
   TIZ_Q_GOTO_END_ON_NULL (p_q->p_first);
 
   /* All OK */
@@ -122,8 +147,203 @@ end:
   return p_q;
 }
 
+
+/*
+ * Lock-free ring buffer implementation
+ */
+
+static inline size_t
+lf_ring_size (OMX_S32 a_capacity)
+{
+  size_t size = 1;
+  while (size < (size_t) a_capacity)
+    {
+      size <<= 1;
+    }
+  return size;
+}
+
+static OMX_ERRORTYPE
+lf_init (tiz_queue_t * ap_q, OMX_S32 a_capacity)
+{
+  const size_t size = lf_ring_size (a_capacity);
+  size_t i = 0;
+
+  assert (ap_q);
+
+  /* The linked list is not needed */
+  tiz_slab_free (ap_q->p_first);
+  ap_q->p_first = ap_q->p_last = NULL;
+
+  ap_q->p_cells
+    = (tiz_queue_cell_t *) tiz_mem_calloc (size, sizeof (tiz_queue_cell_t));
+  tiz_check_null_ret_oom (ap_q->p_cells);
+
+  for (i = 0; i < size; ++i)
+    {
+      ap_q->p_cells[i].seq = i;
+    }
+
+  ap_q->mask = size - 1;
+  ap_q->enq_pos = 0;
+  ap_q->deq_pos = 0;
+  ap_q->consumer_waiting = 0;
+  ap_q->producers_waiting = 0;
+
+  return OMX_ErrorNone;
+}
+
+/* Reserve one of the 'capacity' slots; blocks while the queue is full */
+static OMX_ERRORTYPE
+lf_reserve (tiz_queue_t * ap_q)
+{
+  OMX_S32 len = __atomic_load_n (&(ap_q->length), __ATOMIC_RELAXED);
+  for (;;)
+    {
+      while (len < ap_q->capacity)
+        {
+          if (__atomic_compare_exchange_n (&(ap_q->length), &len, len + 1,
+                                           true, __ATOMIC_SEQ_CST,
+                                           __ATOMIC_RELAXED))
+            {
+              return OMX_ErrorNone;
+            }
+        }
+
+      /* Full: park until the consumer frees a slot */
+      tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_q->mutex)));
+      __atomic_add_fetch (&(ap_q->producers_waiting), 1, __ATOMIC_SEQ_CST);
+      while (__atomic_load_n (&(ap_q->length), __ATOMIC_SEQ_CST)
+             >= ap_q->capacity)
+        {
+          (void) tiz_cond_wait (&(ap_q->cond_full), &(ap_q->mutex));
+        }
+      __atomic_sub_fetch (&(ap_q->producers_waiting), 1, __ATOMIC_SEQ_CST);
+      tiz_check_omx_ret_oom (tiz_mutex_unlock (&(ap_q->mutex)));
+      len = __atomic_load_n (&(ap_q->length), __ATOMIC_RELAXED);
+    }
+}
+
+static OMX_ERRORTYPE
+lf_send (tiz_queue_t * ap_q, OMX_PTR ap_data)
+{
+  tiz_queue_cell_t * p_cell = NULL;
+  size_t pos = 0;
+
+  assert (ap_q);
+  assert (ap_data);
+
+  tiz_check_omx (lf_reserve (ap_q));
+
+  /* The ring is at least 'capacity' cells long, so once a slot has been
+     reserved the cell is either free or just about to be released by the
+     consumer. */
+  pos = __atomic_fetch_add (&(ap_q->enq_pos), 1, __ATOMIC_RELAXED);
+  p_cell = &(ap_q->p_cells[pos & ap_q->mask]);
+  while (__atomic_load_n (&(p_cell->seq), __ATOMIC_ACQUIRE) != pos)
+    {
+      /* spin */
+    }
+  p_cell->p_data = ap_data;
+  __atomic_store_n (&(p_cell->seq), pos + 1, __ATOMIC_RELEASE);
+
+  /* Only wake up the consumer if it is parked */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&(ap_q->consumer_waiting), __ATOMIC_RELAXED))
+    {
+      tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_q->mutex)));
+      tiz_check_omx_ret_oom (tiz_cond_signal (&(ap_q->cond_empty)));
+      tiz_check_omx_ret_oom (tiz_mutex_unlock (&(ap_q->mutex)));
+    }
+
+  return OMX_ErrorNone;
+}
+
+static inline bool
+lf_ready (tiz_queue_t * ap_q)
+{
+  const size_t pos = ap_q->deq_pos;
+  return (__atomic_load_n (&(ap_q->p_cells[pos & ap_q->mask].seq),
+                           __ATOMIC_ACQUIRE)
+          == pos + 1);
+}
+
+static OMX_ERRORTYPE
+lf_pop (tiz_queue_t * ap_q, OMX_PTR * app_data)
+{
+  const size_t pos = ap_q->deq_pos;
+  tiz_queue_cell_t * p_cell = &(ap_q->p_cells[pos & ap_q->mask]);
+
+  assert (p_cell->p_data);
+  *app_data = p_cell->p_data;
+  p_cell->p_data = NULL;
+  __atomic_store_n (&(p_cell->seq), pos + ap_q->mask + 1, __ATOMIC_RELEASE);
+  ap_q->deq_pos = pos + 1;
+  __atomic_sub_fetch (&(ap_q->length), 1, __ATOMIC_SEQ_CST);
+
+  /* Only wake up producers if there are any waiting for a free slot */
+  if (__atomic_load_n (&(ap_q->producers_waiting), __ATOMIC_SEQ_CST))
+    {
+      tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_q->mutex)));
+      tiz_check_omx_ret_oom (tiz_cond_broadcast (&(ap_q->cond_full)));
+      tiz_check_omx_ret_oom (tiz_mutex_unlock (&(ap_q->mutex)));
+    }
+
+  return OMX_ErrorNone;
+}
+
+/* a_millis == 0 means wait forever */
+static OMX_ERRORTYPE
+lf_receive (tiz_queue_t * ap_q, OMX_PTR * app_data, OMX_U32 a_millis)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_q);
+  assert (app_data);
+
+  if (!lf_ready (ap_q))
+    {
+      /* Empty (or a producer is still publishing): park */
+      tiz_check_omx_ret_oom (tiz_mutex_lock (&(ap_q->mutex)));
+      __atomic_store_n (&(ap_q->consumer_waiting), 1, __ATOMIC_SEQ_CST);
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      while (!lf_ready (ap_q))
+        {
+          if (a_millis > 0)
+            {
+              rc = tiz_cond_timedwait (&(ap_q->cond_empty), &(ap_q->mutex),
+                                       a_millis);
+              if (OMX_ErrorTimeout == rc)
+                {
+                  break;
+                }
+            }
+          else
+            {
+              rc = tiz_cond_wait (&(ap_q->cond_empty), &(ap_q->mutex));
+            }
+        }
+      __atomic_store_n (&(ap_q->consumer_waiting), 0, __ATOMIC_RELAXED);
+      tiz_check_omx_ret_oom (tiz_mutex_unlock (&(ap_q->mutex)));
+    }
+
+  if (lf_ready (ap_q))
+    {
+      tiz_check_omx (lf_pop (ap_q, app_data));
+    }
+
+  return rc;
+}
+
 OMX_ERRORTYPE
 tiz_queue_init (tiz_queue_ptr_t * app_q, OMX_S32 a_capacity)
+{
+  return tiz_queue_init_with_type (app_q, a_capacity, ETIZQueueTypeMutex);
+}
+
+OMX_ERRORTYPE
+tiz_queue_init_with_type (tiz_queue_ptr_t * app_q, OMX_S32 a_capacity,
+                          tiz_queue_type_t a_type)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   tiz_queue_item_t * p_new_item = NULL;
@@ -132,13 +352,23 @@ tiz_queue_init (tiz_queue_ptr_t * app_q, OMX_S32 a_capacity)
 
   assert (app_q);
 
-  TIZ_LOG (TIZ_PRIORITY_TRACE, "queue capacity [%d]", a_capacity);
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "queue capacity [%d] type [%d]", a_capacity,
+           a_type);
 
   assert (a_capacity > 0);
+  assert (a_type < ETIZQueueTypeMax);
 
-  if ((p_q = init_queue_struct ()))
+  if ((p_q = init_queue_struct ()) && ETIZQueueTypeLockFree == a_type)
+    {
+      p_q->type = a_type;
+      p_q->capacity = a_capacity;
+      p_q->length = 0;
+      rc = lf_init (p_q, a_capacity);
+    }
+  else if (p_q)
     {
       int i = 0;
+      p_q->type = a_type;
       p_q->capacity = a_capacity;
       p_q->length = 0;
 
@@ -147,8 +377,8 @@ tiz_queue_init (tiz_queue_ptr_t * app_q, OMX_S32 a_capacity)
 
       for (i = 0; i < (a_capacity - 1); ++i)
         {
-          if ((p_new_item = (tiz_queue_item_t *) tiz_mem_calloc (
-                 1, sizeof (tiz_queue_item_t))))
+          if ((p_new_item = (tiz_queue_item_t *) tiz_slab_calloc (
+                 sizeof (tiz_queue_item_t))))
             {
               p_cur_item->p_next = p_new_item;
               p_cur_item = p_new_item;
@@ -164,7 +394,7 @@ tiz_queue_init (tiz_queue_ptr_t * app_q, OMX_S32 a_capacity)
               while (p_q->p_first)
                 {
                   p_cur_item = p_q->p_first->p_next;
-                  tiz_mem_free ((OMX_PTR) p_q->p_first);
+                  tiz_slab_free ((OMX_PTR) p_q->p_first);
                   p_q->p_first = p_cur_item;
                 }
               /* end loop  */
@@ -211,7 +441,7 @@ tiz_queue_destroy (/*@null@ */ tiz_queue_t * p_q)
       for (i = 0; p_q->p_first && i < (p_q->capacity - 1); ++i)
         {
           p_cur_item = p_q->p_first->p_next;
-          tiz_mem_free (p_q->p_first);
+          tiz_slab_free (p_q->p_first);
           p_q->p_first = p_cur_item;
         }
 
@@ -226,10 +456,14 @@ tiz_queue_send (tiz_queue_t * p_q, OMX_PTR ap_data)
 
   assert (p_q);
 
+  if (ETIZQueueTypeLockFree == p_q->type)
+    {
+      return lf_send (p_q, ap_data);
+    }
+
   tiz_check_omx_ret_oom (tiz_mutex_lock (&(p_q->mutex)));
 
   assert (p_q->p_last);
-  assert (NULL == (p_q->p_last->p_data));
   assert (p_q->length <= p_q->capacity);
 
   while (p_q->length == p_q->capacity)
@@ -239,6 +473,7 @@ tiz_queue_send (tiz_queue_t * p_q, OMX_PTR ap_data)
 
   if (OMX_ErrorNone == rc)
     {
+      assert (NULL == (p_q->p_last->p_data));
       p_q->p_last->p_data = ap_data;
       p_q->p_last = p_q->p_last->p_next;
       p_q->length++;
@@ -258,6 +493,11 @@ tiz_queue_receive (tiz_queue_t * p_q, OMX_PTR * app_data)
   assert (p_q);
   assert (app_data);
 
+  if (ETIZQueueTypeLockFree == p_q->type)
+    {
+      return lf_receive (p_q, app_data, 0);
+    }
+
   tiz_check_omx_ret_oom (tiz_mutex_lock (&(p_q->mutex)));
 
   assert (!(p_q->length < 0));
@@ -292,6 +532,12 @@ tiz_queue_timed_receive (tiz_queue_t * p_q, OMX_PTR * app_data,
   assert (p_q);
   assert (app_data);
 
+  if (ETIZQueueTypeLockFree == p_q->type)
+    {
+      /* A zero timeout means 'wait forever' for lf_receive */
+      return lf_receive (p_q, app_data, MAX (a_millis, 1));
+    }
+
   tiz_check_omx_ret_oom (tiz_mutex_lock (&(p_q->mutex)));
 
   assert (!(p_q->length < 0));
@@ -328,6 +574,11 @@ tiz_queue_capacity (tiz_queue_t * p_q)
 
   assert (p_q);
 
+  if (ETIZQueueTypeLockFree == p_q->type)
+    {
+      return p_q->capacity;
+    }
+
   tiz_check_omx_ret_oom (tiz_mutex_lock (&(p_q->mutex)));
 
   capacity = p_q->capacity;
@@ -344,6 +595,11 @@ tiz_queue_length (tiz_queue_t * p_q)
 
   assert (p_q);
 
+  if (ETIZQueueTypeLockFree == p_q->type)
+    {
+      return __atomic_load_n (&(p_q->length), __ATOMIC_RELAXED);
+    }
+
   tiz_check_omx_ret_oom (tiz_mutex_lock (&(p_q->mutex)));
 
   length = p_q->length;
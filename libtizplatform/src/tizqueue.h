@@ -54,7 +54,21 @@ typedef struct tiz_queue tiz_queue_t;
 typedef /*@null@ */ tiz_queue_t * tiz_queue_ptr_t;
 
 /**
- * Initialize a new empty queue.
+ * Queue implementation types.
+ * @ingroup tizqueue
+ */
+typedef enum tiz_queue_type {
+  ETIZQueueTypeMutex, /**< Linked list guarded by a mutex and two condition
+                         variables. Any number of producers and consumers. */
+  ETIZQueueTypeLockFree, /**< Bounded lock-free ring buffer. Any number of
+                            producers, but only one consumer at any given
+                            time. The consumer only parks when the ring is
+                            empty. */
+  ETIZQueueTypeMax
+} tiz_queue_type_t;
+
+/**
+ * Initialize a new empty queue (of type ETIZQueueTypeMutex).
  *
  * @ingroup tizqueue
  *
@@ -65,6 +79,23 @@ typedef /*@null@ */ tiz_queue_t * tiz_queue_ptr_t;
 OMX_ERRORTYPE
 tiz_queue_init (/*@out@*/ tiz_queue_ptr_t * app_q, OMX_S32 a_capacity);
 
+/**
+ * Initialize a new empty queue of the specified type. Both queue types share
+ * the rest of the API. NOTE: With ETIZQueueTypeLockFree, tiz_queue_receive
+ * and tiz_queue_timed_receive must not be called concurrently from more than
+ * one thread.
+ *
+ * @ingroup tizqueue
+ *
+ * @param a_capacity Maximum number of items that can be send into the queue.
+ * @param a_type The queue implementation to use.
+ *
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_queue_init_with_type (/*@out@*/ tiz_queue_ptr_t * app_q,
+                          OMX_S32 a_capacity, tiz_queue_type_t a_type);
+
 /**
  * Destroy a queue. If ap_q is NULL, or the queue has already been detroyed
  * before, no operation is performed.
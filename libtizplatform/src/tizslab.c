@@ -0,0 +1,576 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizslab.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia Platform - Thread-caching slab allocator
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "tizplatform.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.platform.slab"
+#endif
+
+#define SLAB_ALIGN 16
+#define SLAB_HDR_SZ SLAB_ALIGN
+#define SLAB_CHUNK_SZ (64 * 1024)
+/* Capacity of a thread's cache, per size class */
+#define SLAB_CACHE_SZ 32
+/* Number of objects moved between a thread cache and the chunks at once */
+#define SLAB_CACHE_BATCH (SLAB_CACHE_SZ / 2)
+
+static const size_t default_sizes_tbl[] = {
+  16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072,
+  4096
+};
+
+typedef struct slab_chunk slab_chunk_t;
+
+/* Precedes every object handed out */
+typedef struct slab_hdr slab_hdr_t;
+struct slab_hdr
+{
+  slab_chunk_t * p_chunk; /* NULL for blocks larger than the largest class */
+  size_t size;
+};
+
+/* The free list link is stored in the object itself */
+typedef struct slab_obj slab_obj_t;
+struct slab_obj
+{
+  slab_obj_t * p_next;
+};
+
+struct slab_chunk
+{
+  slab_chunk_t * p_next;
+  slab_chunk_t * p_prev;
+  slab_obj_t * p_free;
+  int32_t class;
+  int32_t n_used;
+  int32_t n_slices;
+};
+
+typedef struct slab_class slab_class_t;
+struct slab_class
+{
+  tiz_mutex_t mutex;
+  size_t size;
+  size_t stride;
+  /* Chunks that have both used and free objects */
+  slab_chunk_t * p_partial;
+  /* One empty chunk, kept to avoid thrashing */
+  slab_chunk_t * p_spare;
+  int32_t n_chunks;
+  /* Objects handed out to thread caches or users */
+  int32_t n_out;
+  /* Objects sitting in thread caches (updated atomically) */
+  int32_t n_cached;
+};
+
+typedef struct slab slab_t;
+struct slab
+{
+  tiz_mutex_t mutex;
+  bool in_use;
+  size_t n_classes;
+  slab_class_t classes[TIZ_SLAB_MAX_CLASSES];
+  uint8_t class_tbl[TIZ_SLAB_MAX_CLASS_SIZE / SLAB_ALIGN + 1];
+  pthread_key_t key;
+  /* These are updated atomically */
+  int64_t sys_allocs;
+  int64_t chunk_releases;
+  int64_t large_objects;
+};
+
+typedef struct slab_cache slab_cache_t;
+struct slab_cache
+{
+  bool registered;
+  int32_t counts[TIZ_SLAB_MAX_CLASSES];
+  void * objs[TIZ_SLAB_MAX_CLASSES][SLAB_CACHE_SZ];
+};
+
+static slab_t g_slab;
+static pthread_once_t g_slab_once = PTHREAD_ONCE_INIT;
+static __thread slab_cache_t g_cache;
+
+static inline void *
+get_usr_ptr (slab_hdr_t * ap_hdr)
+{
+  return (uint8_t *) ap_hdr + SLAB_HDR_SZ;
+}
+
+static inline slab_hdr_t *
+get_hdr_ptr (void * ap_usr)
+{
+  return (slab_hdr_t *) ((uint8_t *) ap_usr - SLAB_HDR_SZ);
+}
+
+static void
+set_classes (const size_t * ap_sizes, const size_t a_nsizes)
+{
+  size_t i = 0;
+  size_t cls = 0;
+
+  g_slab.n_classes = a_nsizes;
+  for (i = 0; i < a_nsizes; ++i)
+    {
+      g_slab.classes[i].size = ap_sizes[i];
+      g_slab.classes[i].stride = ap_sizes[i] + SLAB_HDR_SZ;
+    }
+
+  /* Map every size (in SLAB_ALIGN units) to the smallest class that fits */
+  for (i = 0; i <= ap_sizes[a_nsizes - 1] / SLAB_ALIGN; ++i)
+    {
+      while (ap_sizes[cls] < i * SLAB_ALIGN)
+        {
+          ++cls;
+        }
+      g_slab.class_tbl[i] = (uint8_t) cls;
+    }
+}
+
+static void flush_thread_cache (void * ap_cache);
+
+static void
+init_slab (void)
+{
+  size_t i = 0;
+
+  assert (sizeof (slab_hdr_t) <= SLAB_HDR_SZ);
+
+  (void) tiz_mutex_init (&(g_slab.mutex));
+  for (i = 0; i < TIZ_SLAB_MAX_CLASSES; ++i)
+    {
+      (void) tiz_mutex_init (&(g_slab.classes[i].mutex));
+    }
+  (void) pthread_key_create (&(g_slab.key), flush_thread_cache);
+  set_classes (default_sizes_tbl,
+               sizeof (default_sizes_tbl) / sizeof (default_sizes_tbl[0]));
+}
+
+static inline void
+list_add (slab_chunk_t ** app_head, slab_chunk_t * ap_chunk)
+{
+  ap_chunk->p_prev = NULL;
+  ap_chunk->p_next = *app_head;
+  if (*app_head)
+    {
+      (*app_head)->p_prev = ap_chunk;
+    }
+  *app_head = ap_chunk;
+}
+
+static inline void
+list_del (slab_chunk_t ** app_head, slab_chunk_t * ap_chunk)
+{
+  if (ap_chunk->p_prev)
+    {
+      ap_chunk->p_prev->p_next = ap_chunk->p_next;
+    }
+  else
+    {
+      *app_head = ap_chunk->p_next;
+    }
+  if (ap_chunk->p_next)
+    {
+      ap_chunk->p_next->p_prev = ap_chunk->p_prev;
+    }
+  ap_chunk->p_next = ap_chunk->p_prev = NULL;
+}
+
+/* Called with the class mutex held */
+static slab_chunk_t *
+alloc_chunk (slab_class_t * ap_cls, const int32_t a_class)
+{
+  slab_chunk_t * p_chunk = NULL;
+  uint8_t * p_end = NULL;
+  uint8_t * p_slice = NULL;
+  slab_obj_t ** pp_link = NULL;
+
+  if (!(p_chunk = tiz_mem_alloc (SLAB_CHUNK_SZ)))
+    {
+      return NULL;
+    }
+  (void) __atomic_add_fetch (&(g_slab.sys_allocs), 1, __ATOMIC_RELAXED);
+
+  p_chunk->p_next = p_chunk->p_prev = NULL;
+  p_chunk->class = a_class;
+  p_chunk->n_used = 0;
+  p_chunk->n_slices = 0;
+
+  p_end = (uint8_t *) p_chunk + SLAB_CHUNK_SZ;
+  p_slice = (uint8_t *) (((uintptr_t) (p_chunk + 1) + SLAB_ALIGN - 1)
+                         & ~((uintptr_t) SLAB_ALIGN - 1));
+  pp_link = &(p_chunk->p_free);
+  for (; p_slice + ap_cls->stride <= p_end; p_slice += ap_cls->stride)
+    {
+      slab_hdr_t * p_hdr = (slab_hdr_t *) p_slice;
+      slab_obj_t * p_obj = get_usr_ptr (p_hdr);
+      p_hdr->p_chunk = p_chunk;
+      p_hdr->size = ap_cls->size;
+      *pp_link = p_obj;
+      pp_link = &(p_obj->p_next);
+      ++p_chunk->n_slices;
+    }
+  *pp_link = NULL;
+  assert (p_chunk->n_slices > 0);
+
+  ap_cls->n_chunks++;
+  return p_chunk;
+}
+
+/* Called with the class mutex held */
+static void *
+take_obj (slab_class_t * ap_cls, const int32_t a_class)
+{
+  slab_chunk_t * p_chunk = ap_cls->p_partial;
+  slab_obj_t * p_obj = NULL;
+
+  if (!p_chunk)
+    {
+      if ((p_chunk = ap_cls->p_spare))
+        {
+          ap_cls->p_spare = NULL;
+        }
+      else if (!(p_chunk = alloc_chunk (ap_cls, a_class)))
+        {
+          return NULL;
+        }
+      list_add (&(ap_cls->p_partial), p_chunk);
+    }
+
+  p_obj = p_chunk->p_free;
+  assert (p_obj);
+  p_chunk->p_free = p_obj->p_next;
+  if (++p_chunk->n_used == p_chunk->n_slices)
+    {
+      list_del (&(ap_cls->p_partial), p_chunk);
+    }
+  return p_obj;
+}
+
+/* Called with the class mutex held */
+static void
+put_obj (slab_class_t * ap_cls, void * ap_obj)
+{
+  slab_chunk_t * p_chunk = get_hdr_ptr (ap_obj)->p_chunk;
+  slab_obj_t * p_obj = ap_obj;
+  bool was_full = false;
+
+  assert (p_chunk);
+  assert (p_chunk->n_used > 0);
+
+  was_full = (p_chunk->n_used == p_chunk->n_slices);
+
+  p_obj->p_next = p_chunk->p_free;
+  p_chunk->p_free = p_obj;
+  --p_chunk->n_used;
+
+  if (0 == p_chunk->n_used)
+    {
+      if (!was_full)
+        {
+          list_del (&(ap_cls->p_partial), p_chunk);
+        }
+      if (!ap_cls->p_spare)
+        {
+          ap_cls->p_spare = p_chunk;
+        }
+      else
+        {
+          /* Reclaim */
+          tiz_mem_free (p_chunk);
+          ap_cls->n_chunks--;
+          (void) __atomic_add_fetch (&(g_slab.chunk_releases), 1,
+                                     __ATOMIC_RELAXED);
+        }
+    }
+  else if (was_full)
+    {
+      list_add (&(ap_cls->p_partial), p_chunk);
+    }
+}
+
+static void
+register_thread_cache (void)
+{
+  if (!g_cache.registered)
+    {
+      g_cache.registered = true;
+      (void) pthread_setspecific (g_slab.key, &g_cache);
+    }
+}
+
+static bool
+refill (slab_cache_t * ap_cache, const int32_t a_class)
+{
+  slab_class_t * p_cls = &(g_slab.classes[a_class]);
+  void ** pp_objs = ap_cache->objs[a_class];
+  int32_t n = 0;
+
+  register_thread_cache ();
+
+  (void) tiz_mutex_lock (&(p_cls->mutex));
+  __atomic_store_n (&(g_slab.in_use), true, __ATOMIC_RELAXED);
+  for (n = 0; n < SLAB_CACHE_BATCH; ++n)
+    {
+      if (!(pp_objs[n] = take_obj (p_cls, a_class)))
+        {
+          break;
+        }
+    }
+  p_cls->n_out += n;
+  (void) tiz_mutex_unlock (&(p_cls->mutex));
+
+  ap_cache->counts[a_class] = n;
+  (void) __atomic_add_fetch (&(p_cls->n_cached), n, __ATOMIC_RELAXED);
+  return (n > 0);
+}
+
+static void
+flush (slab_cache_t * ap_cache, const int32_t a_class, int32_t a_count)
+{
+  slab_class_t * p_cls = &(g_slab.classes[a_class]);
+  void ** pp_objs = ap_cache->objs[a_class];
+  int32_t i = 0;
+
+  assert (a_count <= ap_cache->counts[a_class]);
+
+  if (a_count > 0)
+    {
+      (void) tiz_mutex_lock (&(p_cls->mutex));
+      for (i = 0; i < a_count; ++i)
+        {
+          put_obj (p_cls, pp_objs[--ap_cache->counts[a_class]]);
+        }
+      p_cls->n_out -= a_count;
+      (void) tiz_mutex_unlock (&(p_cls->mutex));
+      (void) __atomic_sub_fetch (&(p_cls->n_cached), a_count,
+                                 __ATOMIC_RELAXED);
+    }
+}
+
+static void
+flush_thread_cache (void * ap_cache)
+{
+  slab_cache_t * p_cache = ap_cache;
+  size_t i = 0;
+
+  if (p_cache)
+    {
+      for (i = 0; i < g_slab.n_classes; ++i)
+        {
+          flush (p_cache, i, p_cache->counts[i]);
+        }
+      p_cache->registered = false;
+    }
+}
+
+OMX_ERRORTYPE
+tiz_slab_configure (const size_t * ap_sizes, const size_t a_nsizes)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  size_t i = 0;
+
+  assert (ap_sizes);
+
+  if (0 == a_nsizes || a_nsizes > TIZ_SLAB_MAX_CLASSES)
+    {
+      return OMX_ErrorBadParameter;
+    }
+
+  for (i = 0; i < a_nsizes; ++i)
+    {
+      if (0 == ap_sizes[i] || ap_sizes[i] % SLAB_ALIGN
+          || ap_sizes[i] > TIZ_SLAB_MAX_CLASS_SIZE
+          || (i > 0 && ap_sizes[i] <= ap_sizes[i - 1]))
+        {
+          return OMX_ErrorBadParameter;
+        }
+    }
+
+  (void) pthread_once (&g_slab_once, init_slab);
+
+  (void) tiz_mutex_lock (&(g_slab.mutex));
+  if (__atomic_load_n (&(g_slab.in_use), __ATOMIC_RELAXED))
+    {
+      rc = OMX_ErrorIncorrectStateOperation;
+    }
+  else
+    {
+      set_classes (ap_sizes, a_nsizes);
+    }
+  (void) tiz_mutex_unlock (&(g_slab.mutex));
+
+  return rc;
+}
+
+/*@null@*/ void *
+tiz_slab_alloc (size_t a_size)
+{
+  slab_cache_t * p_cache = &g_cache;
+  int32_t class = 0;
+
+  (void) pthread_once (&g_slab_once, init_slab);
+
+  if (a_size > g_slab.classes[g_slab.n_classes - 1].size)
+    {
+      slab_hdr_t * p_hdr = tiz_mem_alloc (SLAB_HDR_SZ + a_size);
+      if (!p_hdr)
+        {
+          return NULL;
+        }
+      (void) __atomic_add_fetch (&(g_slab.sys_allocs), 1, __ATOMIC_RELAXED);
+      (void) __atomic_add_fetch (&(g_slab.large_objects), 1,
+                                 __ATOMIC_RELAXED);
+      p_hdr->p_chunk = NULL;
+      p_hdr->size = a_size;
+      return get_usr_ptr (p_hdr);
+    }
+
+  class = g_slab.class_tbl[(a_size + SLAB_ALIGN - 1) / SLAB_ALIGN];
+  if (0 == p_cache->counts[class] && !refill (p_cache, class))
+    {
+      return NULL;
+    }
+
+  (void) __atomic_sub_fetch (&(g_slab.classes[class].n_cached), 1,
+                             __ATOMIC_RELAXED);
+  return p_cache->objs[class][--p_cache->counts[class]];
+}
+
+/*@null@*/ void *
+tiz_slab_calloc (size_t a_size)
+{
+  void * p_usr = tiz_slab_alloc (a_size);
+  if (p_usr)
+    {
+      (void) tiz_mem_set (p_usr, 0, a_size);
+    }
+  return p_usr;
+}
+
+void
+tiz_slab_free (void * ap_addr)
+{
+  slab_cache_t * p_cache = &g_cache;
+  slab_hdr_t * p_hdr = NULL;
+  int32_t class = 0;
+
+  if (!ap_addr)
+    {
+      return;
+    }
+
+  p_hdr = get_hdr_ptr (ap_addr);
+  if (!p_hdr->p_chunk)
+    {
+      (void) __atomic_sub_fetch (&(g_slab.large_objects), 1,
+                                 __ATOMIC_RELAXED);
+      tiz_mem_free (p_hdr);
+      return;
+    }
+
+  class = p_hdr->p_chunk->class;
+  if (SLAB_CACHE_SZ == p_cache->counts[class])
+    {
+      flush (p_cache, class, SLAB_CACHE_BATCH);
+    }
+  register_thread_cache ();
+  p_cache->objs[class][p_cache->counts[class]++] = ap_addr;
+  (void) __atomic_add_fetch (&(g_slab.classes[class].n_cached), 1,
+                             __ATOMIC_RELAXED);
+}
+
+void
+tiz_slab_trim (void)
+{
+  size_t i = 0;
+
+  (void) pthread_once (&g_slab_once, init_slab);
+
+  flush_thread_cache (&g_cache);
+  for (i = 0; i < g_slab.n_classes; ++i)
+    {
+      slab_class_t * p_cls = &(g_slab.classes[i]);
+      (void) tiz_mutex_lock (&(p_cls->mutex));
+      if (p_cls->p_spare)
+        {
+          tiz_mem_free (p_cls->p_spare);
+          p_cls->p_spare = NULL;
+          p_cls->n_chunks--;
+          (void) __atomic_add_fetch (&(g_slab.chunk_releases), 1,
+                                     __ATOMIC_RELAXED);
+        }
+      (void) tiz_mutex_unlock (&(p_cls->mutex));
+    }
+}
+
+void
+tiz_slab_info (tiz_slab_info_t * ap_info)
+{
+  size_t i = 0;
+
+  assert (ap_info);
+
+  (void) pthread_once (&g_slab_once, init_slab);
+  (void) tiz_mem_set (ap_info, 0, sizeof (tiz_slab_info_t));
+
+  ap_info->classes = g_slab.n_classes;
+  for (i = 0; i < g_slab.n_classes; ++i)
+    {
+      slab_class_t * p_cls = &(g_slab.classes[i]);
+      int32_t cached = 0;
+      (void) tiz_mutex_lock (&(p_cls->mutex));
+      cached = __atomic_load_n (&(p_cls->n_cached), __ATOMIC_RELAXED);
+      ap_info->sizes[i] = p_cls->size;
+      ap_info->slices[i] = p_cls->n_out - cached;
+      ap_info->chunks += p_cls->n_chunks;
+      ap_info->objects += p_cls->n_out - cached;
+      ap_info->cached += cached;
+      (void) tiz_mutex_unlock (&(p_cls->mutex));
+    }
+  ap_info->objects
+    += __atomic_load_n (&(g_slab.large_objects), __ATOMIC_RELAXED);
+  ap_info->sys_allocs
+    = __atomic_load_n (&(g_slab.sys_allocs), __ATOMIC_RELAXED);
+  ap_info->chunk_releases
+    = __atomic_load_n (&(g_slab.chunk_releases), __ATOMIC_RELAXED);
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "objects [%lld] chunks [%d] cached [%lld]",
+           (long long) ap_info->objects, ap_info->chunks,
+           (long long) ap_info->cached);
+}
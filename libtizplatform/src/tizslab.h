@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizslab.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia Platform - Thread-caching slab allocator
+ *
+ *
+ */
+
+#ifndef TIZSLAB_H
+#define TIZSLAB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @defgroup tizslab Slab allocator
+ *
+ * A process-wide, thread-safe allocator for small and medium sized objects.
+ * Objects are carved out of fixed-size chunks, one set of chunks per size
+ * class. Each thread keeps a small cache of free objects per class, so that
+ * in the steady state allocations and deallocations neither take a lock nor
+ * call into the system allocator. Chunks that become empty are returned to
+ * the system (one spare chunk per class is retained). Requests larger than
+ * the largest size class are served by tiz_mem_alloc.
+ *
+ * @ingroup libtizplatform
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+
+/**
+ * The maximum number of size classes.
+ * @ingroup tizslab
+ */
+#define TIZ_SLAB_MAX_CLASSES 16
+
+/**
+ * The largest size class allowed.
+ * @ingroup tizslab
+ */
+#define TIZ_SLAB_MAX_CLASS_SIZE 4096
+
+/**
+ * Replace the default size classes. Must be called before the first
+ * allocation.
+ *
+ * @ingroup tizslab
+ *
+ * @param ap_sizes The object sizes, in strictly increasing order. Each must
+ * be a multiple of 16 and no larger than TIZ_SLAB_MAX_CLASS_SIZE.
+ * @param a_nsizes The number of size classes (up to TIZ_SLAB_MAX_CLASSES).
+ * @return OMX_ErrorNone on success, OMX_ErrorBadParameter if the sizes are
+ * invalid, or OMX_ErrorIncorrectStateOperation if the allocator is already in
+ * use.
+ */
+OMX_ERRORTYPE
+tiz_slab_configure (const size_t * ap_sizes, const size_t a_nsizes);
+
+/**
+ * Allocate a (16-byte aligned) block of memory.
+ *
+ * @ingroup tizslab
+ */
+/*@null@ */ void *
+tiz_slab_alloc (size_t a_size);
+
+/**
+ * Allocate a block of memory, initialised to zero.
+ *
+ * @ingroup tizslab
+ */
+/*@null@ */ void *
+tiz_slab_calloc (size_t a_size);
+
+/**
+ * Release a block obtained from tiz_slab_alloc or tiz_slab_calloc. The block
+ * may be released from any thread.
+ *
+ * @ingroup tizslab
+ */
+void
+tiz_slab_free (/*@null@ */ void * ap_addr);
+
+/**
+ * Return the calling thread's cached objects to their chunks, and the empty
+ * chunks to the system. Thread caches are flushed automatically when a
+ * thread exits.
+ *
+ * @ingroup tizslab
+ */
+void
+tiz_slab_trim (void);
+
+typedef struct tiz_slab_info tiz_slab_info_t;
+struct tiz_slab_info
+{
+  /* Number of size classes */
+  int32_t classes;
+  /* Number of chunks currently held */
+  int32_t chunks;
+  /* Number of objects currently in use (slab objects and larger blocks) */
+  int64_t objects;
+  /* Number of free objects currently held in thread caches */
+  int64_t cached;
+  /* Number of calls made to the system allocator so far (chunks and larger
+     blocks) */
+  int64_t sys_allocs;
+  /* Number of chunks returned to the system so far */
+  int64_t chunk_releases;
+  /* The object size of each class */
+  size_t sizes[TIZ_SLAB_MAX_CLASSES];
+  /* Number of objects currently in use in each class */
+  int32_t slices[TIZ_SLAB_MAX_CLASSES];
+};
+
+/**
+ * Retrieve the allocator statistics.
+ *
+ * @ingroup tizslab
+ */
+void
+tiz_slab_info (tiz_slab_info_t * ap_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIZSLAB_H */
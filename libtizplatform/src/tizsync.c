@@ -137,6 +137,7 @@ tiz_sem_timedwait (tiz_sem_t * app_sem, OMX_U32 a_millis)
 
   if (SEM_SUCCESS != sem_timedwait (p_sem, &timeout))
     {
+      error = errno;
       if (ETIMEDOUT == error)
         {
           TIZ_LOG (TIZ_PRIORITY_NOTICE, "The wait time specified has passed");
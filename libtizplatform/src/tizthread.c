@@ -37,6 +37,7 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#include <time.h>
 #include <sys/syscall.h>
 #include <pthread.h>
 #include <assert.h>
@@ -212,3 +213,11 @@ tiz_sleep (OMX_U32 usec)
 
   return rc;
 }
+
+OMX_U64
+tiz_time_now_us (void)
+{
+  struct timespec now;
+  (void) clock_gettime (CLOCK_MONOTONIC, &now);
+  return (OMX_U64) now.tv_sec * 1000000 + (OMX_U64) now.tv_nsec / 1000;
+}
@@ -114,6 +114,16 @@ tiz_thread_id (void);
 OMX_S32
 tiz_sleep (OMX_U32 a_usec);
 
+/**
+ * Read a monotonic clock, for measuring intervals.
+ *
+ * @ingroup tizthread
+ *
+ * @return The current value of the clock, in micro seconds.
+ */
+OMX_U64
+tiz_time_now_us (void);
+
 #ifdef __cplusplus
 }
 #endif
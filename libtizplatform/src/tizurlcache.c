@@ -0,0 +1,936 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizurlcache.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia Platform - A cache of downloaded URL contents
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "tizmem.h"
+#include "tizlog.h"
+#include "tizmacros.h"
+#include "tizsync.h"
+#include "tizurlcache.h"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.platform.urlcache"
+#endif
+
+#define URLCACHE_DIR "tizonia/urlcache"
+#define URLCACHE_EXT ".cache"
+#define URLCACHE_MAGIC "TIZUC001"
+
+/* The in-memory store is shared by all the caches in the process. Its items
+   are immutable once committed; readers hold a reference, and an item that
+   is evicted while being read is freed by its last reader. */
+typedef struct mem_item mem_item_t;
+struct mem_item
+{
+  mem_item_t * p_prev;
+  mem_item_t * p_next;
+  char * p_key;
+  char * p_headers;
+  size_t headers_len;
+  unsigned char * p_body;
+  uint64_t size;
+  int refs;
+  bool linked;
+};
+
+typedef struct mem_store mem_store_t;
+struct mem_store
+{
+  tiz_mutex_t mutex;
+  mem_item_t * p_head; /* Most recently used */
+  mem_item_t * p_tail; /* Least recently used */
+  uint64_t total;
+};
+
+static mem_store_t g_mem;
+static pthread_once_t g_mem_once = PTHREAD_ONCE_INIT;
+
+/* Layout of a disk entry: this header, then the key, then the headers, then
+   the body. */
+typedef struct disk_hdr disk_hdr_t;
+struct disk_hdr
+{
+  char magic[8];
+  uint64_t size;
+  uint32_t headers_len;
+  uint32_t key_len;
+};
+
+struct tiz_urlcache
+{
+  tiz_urlcache_type_t type;
+  uint64_t max_bytes;
+  char * p_dir;
+};
+
+struct tiz_urlcache_entry
+{
+  tiz_urlcache_t * p_cache;
+  bool writing;
+  uint64_t size;
+  uint64_t pos; /* Read offset, or bytes written */
+  /* Memory backend */
+  mem_item_t * p_item;
+  /* Disk backend */
+  int fd;
+  char * p_path;
+  char * p_part_path;
+  char * p_headers;
+  size_t headers_len;
+};
+
+static void
+init_mem_store (void)
+{
+  (void) tiz_mutex_init (&(g_mem.mutex));
+  g_mem.p_head = NULL;
+  g_mem.p_tail = NULL;
+  g_mem.total = 0;
+}
+
+static void
+free_mem_item (mem_item_t * ap_item)
+{
+  if (ap_item)
+    {
+      tiz_mem_free (ap_item->p_key);
+      tiz_mem_free (ap_item->p_headers);
+      tiz_mem_free (ap_item->p_body);
+      tiz_mem_free (ap_item);
+    }
+}
+
+/* Called with the store's mutex held */
+static void
+unlink_mem_item (mem_item_t * ap_item)
+{
+  assert (ap_item);
+  assert (ap_item->linked);
+  if (ap_item->p_prev)
+    {
+      ap_item->p_prev->p_next = ap_item->p_next;
+    }
+  else
+    {
+      g_mem.p_head = ap_item->p_next;
+    }
+  if (ap_item->p_next)
+    {
+      ap_item->p_next->p_prev = ap_item->p_prev;
+    }
+  else
+    {
+      g_mem.p_tail = ap_item->p_prev;
+    }
+  ap_item->p_prev = ap_item->p_next = NULL;
+  ap_item->linked = false;
+  g_mem.total -= ap_item->size;
+}
+
+/* Called with the store's mutex held */
+static void
+link_mem_item (mem_item_t * ap_item)
+{
+  assert (ap_item);
+  assert (!ap_item->linked);
+  ap_item->p_prev = NULL;
+  ap_item->p_next = g_mem.p_head;
+  if (g_mem.p_head)
+    {
+      g_mem.p_head->p_prev = ap_item;
+    }
+  else
+    {
+      g_mem.p_tail = ap_item;
+    }
+  g_mem.p_head = ap_item;
+  ap_item->linked = true;
+  g_mem.total += ap_item->size;
+}
+
+/* Called with the store's mutex held */
+static void
+drop_mem_item (mem_item_t * ap_item)
+{
+  unlink_mem_item (ap_item);
+  if (0 == ap_item->refs)
+    {
+      free_mem_item (ap_item);
+    }
+}
+
+/* Called with the store's mutex held */
+static mem_item_t *
+find_mem_item (const char * ap_key)
+{
+  mem_item_t * p_item = g_mem.p_head;
+  while (p_item && 0 != strcmp (p_item->p_key, ap_key))
+    {
+      p_item = p_item->p_next;
+    }
+  return p_item;
+}
+
+static uint64_t
+fnv1a64 (const char * ap_str)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const unsigned char * p = (const unsigned char *) ap_str;
+  while (*p)
+    {
+      hash ^= *p++;
+      hash *= 0x100000001b3ULL;
+    }
+  return hash;
+}
+
+static char *
+disk_path (const tiz_urlcache_t * ap_cache, const char * ap_key)
+{
+  char * p_path = NULL;
+  const size_t len = strlen (ap_cache->p_dir) + 1 + 16 + sizeof (URLCACHE_EXT);
+  if ((p_path = tiz_mem_alloc (len)))
+    {
+      (void) snprintf (p_path, len, "%s/%016llx%s", ap_cache->p_dir,
+                       (unsigned long long) fnv1a64 (ap_key), URLCACHE_EXT);
+    }
+  return p_path;
+}
+
+static int
+make_dirs (char * ap_path)
+{
+  char * p = ap_path + 1;
+  for (; *p; ++p)
+    {
+      if ('/' == *p)
+        {
+          *p = '\0';
+          if (mkdir (ap_path, S_IRWXU) && EEXIST != errno)
+            {
+              *p = '/';
+              return -1;
+            }
+          *p = '/';
+        }
+    }
+  return (mkdir (ap_path, S_IRWXU) && EEXIST != errno) ? -1 : 0;
+}
+
+static char *
+create_disk_dir (void)
+{
+  const char * p_base = getenv ("XDG_CACHE_HOME");
+  const char * p_sub = URLCACHE_DIR;
+  char * p_dir = NULL;
+  size_t len = 0;
+
+  if (!p_base || '\0' == *p_base)
+    {
+      p_base = getenv ("HOME");
+      p_sub = ".cache/" URLCACHE_DIR;
+    }
+
+  if (!p_base)
+    {
+      return NULL;
+    }
+
+  len = strlen (p_base) + 1 + strlen (p_sub) + 1;
+  if (!(p_dir = tiz_mem_alloc (len)))
+    {
+      return NULL;
+    }
+  (void) snprintf (p_dir, len, "%s/%s", p_base, p_sub);
+
+  if (make_dirs (p_dir))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to create [%s] (%s)", p_dir,
+               strerror (errno));
+      tiz_mem_free (p_dir);
+      p_dir = NULL;
+    }
+  return p_dir;
+}
+
+static bool
+write_all (int a_fd, const void * ap_data, size_t a_nbytes)
+{
+  const unsigned char * p = ap_data;
+  while (a_nbytes > 0)
+    {
+      ssize_t n = write (a_fd, p, a_nbytes);
+      if (n < 0)
+        {
+          if (EINTR == errno)
+            {
+              continue;
+            }
+          return false;
+        }
+      p += n;
+      a_nbytes -= (size_t) n;
+    }
+  return true;
+}
+
+static bool
+read_all (int a_fd, void * ap_data, size_t a_nbytes)
+{
+  unsigned char * p = ap_data;
+  while (a_nbytes > 0)
+    {
+      ssize_t n = read (a_fd, p, a_nbytes);
+      if (n < 0 && EINTR == errno)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          return false;
+        }
+      p += n;
+      a_nbytes -= (size_t) n;
+    }
+  return true;
+}
+
+typedef struct disk_file disk_file_t;
+struct disk_file
+{
+  char * p_name;
+  off_t size;
+  time_t mtime;
+};
+
+static int
+cmp_disk_files (const void * ap_a, const void * ap_b)
+{
+  const disk_file_t * p_a = ap_a;
+  const disk_file_t * p_b = ap_b;
+  return (p_a->mtime > p_b->mtime) - (p_a->mtime < p_b->mtime);
+}
+
+/* Removes the least recently used files until the store fits in its
+   budget. The entry just committed is spared. */
+static void
+evict_disk_files (const tiz_urlcache_t * ap_cache, const char * ap_keep)
+{
+  DIR * p_dir = NULL;
+  struct dirent * p_ent = NULL;
+  disk_file_t * p_files = NULL;
+  size_t nfiles = 0;
+  size_t capacity = 0;
+  uint64_t total = 0;
+  size_t i = 0;
+
+  if (!(p_dir = opendir (ap_cache->p_dir)))
+    {
+      return;
+    }
+
+  while ((p_ent = readdir (p_dir)))
+    {
+      const size_t len = strlen (p_ent->d_name);
+      char path[PATH_MAX];
+      struct stat st;
+
+      if (len <= sizeof (URLCACHE_EXT) - 1
+          || 0 != strcmp (p_ent->d_name + len - (sizeof (URLCACHE_EXT) - 1),
+                          URLCACHE_EXT))
+        {
+          continue;
+        }
+
+      (void) snprintf (path, sizeof (path), "%s/%s", ap_cache->p_dir,
+                       p_ent->d_name);
+      if (stat (path, &st))
+        {
+          continue;
+        }
+
+      if (0 == strcmp (path, ap_keep))
+        {
+          /* The newest entry counts, but is not a candidate */
+          total += (uint64_t) st.st_size;
+          continue;
+        }
+
+      if (nfiles == capacity)
+        {
+          disk_file_t * p_new = NULL;
+          capacity = capacity ? capacity * 2 : 32;
+          if (!(p_new = tiz_mem_realloc (p_files,
+                                         capacity * sizeof (disk_file_t))))
+            {
+              break;
+            }
+          p_files = p_new;
+        }
+      p_files[nfiles].p_name = strdup (p_ent->d_name);
+      p_files[nfiles].size = st.st_size;
+      p_files[nfiles].mtime = st.st_mtime;
+      if (p_files[nfiles].p_name)
+        {
+          total += (uint64_t) st.st_size;
+          ++nfiles;
+        }
+    }
+  (void) closedir (p_dir);
+
+  if (nfiles > 0)
+    {
+      qsort (p_files, nfiles, sizeof (disk_file_t), cmp_disk_files);
+    }
+
+  for (i = 0; i < nfiles; ++i)
+    {
+      if (total > ap_cache->max_bytes)
+        {
+          char path[PATH_MAX];
+          (void) snprintf (path, sizeof (path), "%s/%s", ap_cache->p_dir,
+                           p_files[i].p_name);
+          if (0 == unlink (path))
+            {
+              total -= (uint64_t) p_files[i].size;
+              TIZ_LOG (TIZ_PRIORITY_TRACE, "evicted [%s]", path);
+            }
+        }
+      free (p_files[i].p_name);
+    }
+  tiz_mem_free (p_files);
+}
+
+static void
+free_entry (tiz_urlcache_entry_t * ap_entry)
+{
+  if (ap_entry)
+    {
+      if (ap_entry->fd >= 0)
+        {
+          (void) close (ap_entry->fd);
+        }
+      tiz_mem_free (ap_entry->p_path);
+      tiz_mem_free (ap_entry->p_part_path);
+      tiz_mem_free (ap_entry->p_headers);
+      tiz_mem_free (ap_entry);
+    }
+}
+
+static tiz_urlcache_entry_t *
+alloc_entry (tiz_urlcache_t * ap_cache, const bool a_writing)
+{
+  tiz_urlcache_entry_t * p_entry = tiz_mem_calloc (1, sizeof (*p_entry));
+  if (p_entry)
+    {
+      p_entry->p_cache = ap_cache;
+      p_entry->writing = a_writing;
+      p_entry->fd = -1;
+    }
+  return p_entry;
+}
+
+static tiz_urlcache_entry_t *
+open_mem_entry (tiz_urlcache_t * ap_cache, const char * ap_key)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+  mem_item_t * p_item = NULL;
+
+  if (!(p_entry = alloc_entry (ap_cache, false)))
+    {
+      return NULL;
+    }
+
+  (void) tiz_mutex_lock (&(g_mem.mutex));
+  if ((p_item = find_mem_item (ap_key)))
+    {
+      /* Move to the front of the LRU list */
+      unlink_mem_item (p_item);
+      link_mem_item (p_item);
+      ++(p_item->refs);
+    }
+  (void) tiz_mutex_unlock (&(g_mem.mutex));
+
+  if (!p_item)
+    {
+      free_entry (p_entry);
+      return NULL;
+    }
+
+  p_entry->p_item = p_item;
+  p_entry->size = p_item->size;
+  return p_entry;
+}
+
+static tiz_urlcache_entry_t *
+open_disk_entry (tiz_urlcache_t * ap_cache, const char * ap_key)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+  disk_hdr_t hdr;
+  struct stat st;
+  char * p_stored_key = NULL;
+  const size_t key_len = strlen (ap_key);
+  bool ok = false;
+
+  if (!(p_entry = alloc_entry (ap_cache, false)))
+    {
+      return NULL;
+    }
+
+  if (!(p_entry->p_path = disk_path (ap_cache, ap_key))
+      || (p_entry->fd = open (p_entry->p_path, O_RDONLY | O_CLOEXEC)) < 0)
+    {
+      free_entry (p_entry);
+      return NULL;
+    }
+
+  if (read_all (p_entry->fd, &hdr, sizeof (hdr))
+      && 0 == memcmp (hdr.magic, URLCACHE_MAGIC, sizeof (hdr.magic))
+      && hdr.key_len == key_len && 0 == fstat (p_entry->fd, &st)
+      && (uint64_t) st.st_size
+           == sizeof (hdr) + hdr.key_len + hdr.headers_len + hdr.size
+      && (p_stored_key = tiz_mem_alloc (key_len + 1))
+      && read_all (p_entry->fd, p_stored_key, key_len)
+      && 0 == memcmp (p_stored_key, ap_key, key_len)
+      && (p_entry->p_headers = tiz_mem_alloc (hdr.headers_len + 1))
+      && read_all (p_entry->fd, p_entry->p_headers, hdr.headers_len))
+    {
+      p_entry->p_headers[hdr.headers_len] = '\0';
+      p_entry->headers_len = hdr.headers_len;
+      p_entry->size = hdr.size;
+      /* The modification time records the last use */
+      (void) futimens (p_entry->fd, NULL);
+      ok = true;
+    }
+
+  tiz_mem_free (p_stored_key);
+  if (!ok)
+    {
+      TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s] does not hold [%s]", p_entry->p_path,
+               ap_key);
+      free_entry (p_entry);
+      p_entry = NULL;
+    }
+  return p_entry;
+}
+
+static tiz_urlcache_entry_t *
+create_mem_entry (tiz_urlcache_t * ap_cache, const char * ap_key,
+                  const char * ap_headers, const size_t a_headers_len,
+                  const uint64_t a_size)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+  mem_item_t * p_item = NULL;
+
+  if (!(p_entry = alloc_entry (ap_cache, true)))
+    {
+      return NULL;
+    }
+
+  if (!(p_item = tiz_mem_calloc (1, sizeof (mem_item_t)))
+      || !(p_item->p_key = strdup (ap_key))
+      || !(p_item->p_headers = tiz_mem_alloc (a_headers_len + 1))
+      || !(p_item->p_body = tiz_mem_alloc (a_size > 0 ? a_size : 1)))
+    {
+      free_mem_item (p_item);
+      free_entry (p_entry);
+      return NULL;
+    }
+
+  memcpy (p_item->p_headers, ap_headers, a_headers_len);
+  p_item->p_headers[a_headers_len] = '\0';
+  p_item->headers_len = a_headers_len;
+  p_item->size = a_size;
+  p_entry->p_item = p_item;
+  p_entry->size = a_size;
+  return p_entry;
+}
+
+static tiz_urlcache_entry_t *
+create_disk_entry (tiz_urlcache_t * ap_cache, const char * ap_key,
+                   const char * ap_headers, const size_t a_headers_len,
+                   const uint64_t a_size)
+{
+  static unsigned int counter = 0;
+  tiz_urlcache_entry_t * p_entry = NULL;
+  disk_hdr_t hdr;
+  size_t len = 0;
+
+  if (!(p_entry = alloc_entry (ap_cache, true)))
+    {
+      return NULL;
+    }
+
+  if (!(p_entry->p_path = disk_path (ap_cache, ap_key)))
+    {
+      free_entry (p_entry);
+      return NULL;
+    }
+
+  /* Written under a unique name, and renamed into place on commit */
+  len = strlen (p_entry->p_path) + 32;
+  if (!(p_entry->p_part_path = tiz_mem_alloc (len)))
+    {
+      free_entry (p_entry);
+      return NULL;
+    }
+  (void) snprintf (p_entry->p_part_path, len, "%s.%d.%u.part", p_entry->p_path,
+                   (int) getpid (),
+                   __atomic_add_fetch (&counter, 1, __ATOMIC_RELAXED));
+
+  memset (&hdr, 0, sizeof (hdr));
+  memcpy (hdr.magic, URLCACHE_MAGIC, sizeof (hdr.magic));
+  hdr.size = a_size;
+  hdr.headers_len = (uint32_t) a_headers_len;
+  hdr.key_len = (uint32_t) strlen (ap_key);
+
+  if ((p_entry->fd = open (p_entry->p_part_path,
+                           O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                           S_IRUSR | S_IWUSR))
+        < 0
+      || !write_all (p_entry->fd, &hdr, sizeof (hdr))
+      || !write_all (p_entry->fd, ap_key, hdr.key_len)
+      || !write_all (p_entry->fd, ap_headers, a_headers_len))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to write [%s] (%s)",
+               p_entry->p_part_path, strerror (errno));
+      tiz_urlcache_discard (p_entry);
+      return NULL;
+    }
+
+  p_entry->size = a_size;
+  return p_entry;
+}
+
+OMX_ERRORTYPE
+tiz_urlcache_init (tiz_urlcache_ptr_t * app_cache,
+                   const tiz_urlcache_type_t a_type, const size_t a_max_bytes)
+{
+  tiz_urlcache_t * p_cache = NULL;
+
+  assert (app_cache);
+  assert (a_type < ETIZUrlCacheTypeMax);
+
+  tiz_check_null_ret_oom ((p_cache = tiz_mem_calloc (1, sizeof (*p_cache))));
+
+  p_cache->type = a_type;
+  p_cache->max_bytes = a_max_bytes;
+
+  if (ETIZUrlCacheTypeMemory == a_type)
+    {
+      (void) pthread_once (&g_mem_once, init_mem_store);
+    }
+  else if (ETIZUrlCacheTypeDisk == a_type
+           && !(p_cache->p_dir = create_disk_dir ()))
+    {
+      /* Carry on without a cache */
+      p_cache->type = ETIZUrlCacheTypeNone;
+    }
+
+  *app_cache = p_cache;
+  return OMX_ErrorNone;
+}
+
+void
+tiz_urlcache_destroy (tiz_urlcache_t * ap_cache)
+{
+  if (ap_cache)
+    {
+      tiz_mem_free (ap_cache->p_dir);
+      tiz_mem_free (ap_cache);
+    }
+}
+
+tiz_urlcache_type_t
+tiz_urlcache_type_from_str (const char * ap_str)
+{
+  tiz_urlcache_type_t type = ETIZUrlCacheTypeNone;
+  if (ap_str)
+    {
+      if (0 == strcasecmp (ap_str, "memory"))
+        {
+          type = ETIZUrlCacheTypeMemory;
+        }
+      else if (0 == strcasecmp (ap_str, "disk"))
+        {
+          type = ETIZUrlCacheTypeDisk;
+        }
+    }
+  return type;
+}
+
+bool
+tiz_urlcache_contains (tiz_urlcache_t * ap_cache, const char * ap_key)
+{
+  tiz_urlcache_entry_t * p_entry = tiz_urlcache_open (ap_cache, ap_key);
+  tiz_urlcache_close (p_entry);
+  return (NULL != p_entry);
+}
+
+tiz_urlcache_entry_t *
+tiz_urlcache_open (tiz_urlcache_t * ap_cache, const char * ap_key)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+  if (ap_cache && ap_key)
+    {
+      if (ETIZUrlCacheTypeMemory == ap_cache->type)
+        {
+          p_entry = open_mem_entry (ap_cache, ap_key);
+        }
+      else if (ETIZUrlCacheTypeDisk == ap_cache->type)
+        {
+          p_entry = open_disk_entry (ap_cache, ap_key);
+        }
+    }
+  return p_entry;
+}
+
+size_t
+tiz_urlcache_read (tiz_urlcache_entry_t * ap_entry, void * ap_dst,
+                   const size_t a_nbytes)
+{
+  size_t nbytes = 0;
+
+  assert (ap_entry);
+  assert (!ap_entry->writing);
+  assert (ap_dst);
+
+  nbytes = MIN (a_nbytes, ap_entry->size - ap_entry->pos);
+  if (nbytes > 0)
+    {
+      if (ap_entry->p_item)
+        {
+          memcpy (ap_dst, ap_entry->p_item->p_body + ap_entry->pos, nbytes);
+        }
+      else if (!read_all (ap_entry->fd, ap_dst, nbytes))
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to read [%s]",
+                   ap_entry->p_path);
+          ap_entry->pos = ap_entry->size;
+          return 0;
+        }
+      ap_entry->pos += nbytes;
+    }
+  return nbytes;
+}
+
+const char *
+tiz_urlcache_headers (const tiz_urlcache_entry_t * ap_entry,
+                      size_t * ap_nbytes)
+{
+  assert (ap_entry);
+  assert (ap_nbytes);
+  if (ap_entry->p_item)
+    {
+      *ap_nbytes = ap_entry->p_item->headers_len;
+      return ap_entry->p_item->p_headers;
+    }
+  *ap_nbytes = ap_entry->headers_len;
+  return ap_entry->p_headers;
+}
+
+uint64_t
+tiz_urlcache_size (const tiz_urlcache_entry_t * ap_entry)
+{
+  assert (ap_entry);
+  return ap_entry->size;
+}
+
+void
+tiz_urlcache_close (tiz_urlcache_entry_t * ap_entry)
+{
+  if (ap_entry)
+    {
+      assert (!ap_entry->writing);
+      if (ap_entry->p_item)
+        {
+          mem_item_t * p_item = ap_entry->p_item;
+          bool release = false;
+          (void) tiz_mutex_lock (&(g_mem.mutex));
+          release = (0 == --(p_item->refs) && !p_item->linked);
+          (void) tiz_mutex_unlock (&(g_mem.mutex));
+          if (release)
+            {
+              free_mem_item (p_item);
+            }
+        }
+      free_entry (ap_entry);
+    }
+}
+
+tiz_urlcache_entry_t *
+tiz_urlcache_create (tiz_urlcache_t * ap_cache, const char * ap_key,
+                     const char * ap_headers, const size_t a_headers_len,
+                     const uint64_t a_size)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+
+  if (ap_cache && ap_key && (ap_headers || 0 == a_headers_len)
+      && a_size <= ap_cache->max_bytes)
+    {
+      if (ETIZUrlCacheTypeMemory == ap_cache->type)
+        {
+          p_entry = create_mem_entry (ap_cache, ap_key, ap_headers,
+                                      a_headers_len, a_size);
+        }
+      else if (ETIZUrlCacheTypeDisk == ap_cache->type)
+        {
+          p_entry = create_disk_entry (ap_cache, ap_key, ap_headers,
+                                       a_headers_len, a_size);
+        }
+    }
+  return p_entry;
+}
+
+OMX_ERRORTYPE
+tiz_urlcache_write (tiz_urlcache_entry_t * ap_entry, const void * ap_data,
+                    const size_t a_nbytes)
+{
+  assert (ap_entry);
+  assert (ap_entry->writing);
+  assert (ap_data || 0 == a_nbytes);
+
+  if (a_nbytes > ap_entry->size - ap_entry->pos)
+    {
+      return OMX_ErrorOverflow;
+    }
+
+  if (ap_entry->p_item)
+    {
+      memcpy (ap_entry->p_item->p_body + ap_entry->pos, ap_data, a_nbytes);
+    }
+  else if (!write_all (ap_entry->fd, ap_data, a_nbytes))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to write [%s] (%s)",
+               ap_entry->p_part_path, strerror (errno));
+      return OMX_ErrorInsufficientResources;
+    }
+  ap_entry->pos += a_nbytes;
+  return OMX_ErrorNone;
+}
+
+uint64_t
+tiz_urlcache_written (const tiz_urlcache_entry_t * ap_entry)
+{
+  assert (ap_entry);
+  assert (ap_entry->writing);
+  return ap_entry->pos;
+}
+
+OMX_ERRORTYPE
+tiz_urlcache_commit (tiz_urlcache_entry_t * ap_entry)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_entry);
+  assert (ap_entry->writing);
+
+  if (ap_entry->pos != ap_entry->size)
+    {
+      tiz_urlcache_discard (ap_entry);
+      return OMX_ErrorIncorrectStateOperation;
+    }
+
+  if (ap_entry->p_item)
+    {
+      mem_item_t * p_item = ap_entry->p_item;
+      mem_item_t * p_old = NULL;
+      const uint64_t max_bytes = ap_entry->p_cache->max_bytes;
+
+      (void) tiz_mutex_lock (&(g_mem.mutex));
+      if ((p_old = find_mem_item (p_item->p_key)))
+        {
+          drop_mem_item (p_old);
+        }
+      while (g_mem.p_tail && g_mem.total + p_item->size > max_bytes)
+        {
+          drop_mem_item (g_mem.p_tail);
+        }
+      link_mem_item (p_item);
+      (void) tiz_mutex_unlock (&(g_mem.mutex));
+
+      ap_entry->p_item = NULL;
+    }
+  else
+    {
+      const int err = close (ap_entry->fd);
+      ap_entry->fd = -1;
+      if (err || rename (ap_entry->p_part_path, ap_entry->p_path))
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR, "Unable to commit [%s] (%s)",
+                   ap_entry->p_path, strerror (errno));
+          (void) unlink (ap_entry->p_part_path);
+          rc = OMX_ErrorInsufficientResources;
+        }
+      else
+        {
+          evict_disk_files (ap_entry->p_cache, ap_entry->p_path);
+        }
+    }
+
+  free_entry (ap_entry);
+  return rc;
+}
+
+void
+tiz_urlcache_discard (tiz_urlcache_entry_t * ap_entry)
+{
+  if (ap_entry)
+    {
+      assert (ap_entry->writing);
+      free_mem_item (ap_entry->p_item);
+      ap_entry->p_item = NULL;
+      if (ap_entry->p_part_path)
+        {
+          if (ap_entry->fd >= 0)
+            {
+              (void) close (ap_entry->fd);
+              ap_entry->fd = -1;
+            }
+          (void) unlink (ap_entry->p_part_path);
+        }
+      free_entry (ap_entry);
+    }
+}
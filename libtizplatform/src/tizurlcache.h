@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizurlcache.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia Platform - A cache of downloaded URL contents
+ *
+ *
+ */
+
+#ifndef TIZURLCACHE_H
+#define TIZURLCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @defgroup tizurlcache URL contents cache
+ *
+ * A cache of the response headers and body of finite HTTP resources, keyed
+ * by URL (or by any other string that identifies the contents). Entries are
+ * written while they are being transferred and only become visible once the
+ * whole body has been stored. The memory store is shared by all the caches
+ * of the process; the disk store lives under $XDG_CACHE_HOME/tizonia/urlcache
+ * (or $HOME/.cache/tizonia/urlcache). Both are bounded in size, and the least
+ * recently used entries are evicted first.
+ *
+ * @ingroup libtizplatform
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+
+/**
+ * The storage backends available.
+ * @ingroup tizurlcache
+ */
+typedef enum tiz_urlcache_type {
+  ETIZUrlCacheTypeNone,   /**< Nothing is cached. */
+  ETIZUrlCacheTypeMemory, /**< Entries are kept in memory. */
+  ETIZUrlCacheTypeDisk,   /**< Entries are kept in files. */
+  ETIZUrlCacheTypeMax
+} tiz_urlcache_type_t;
+
+/**
+ * URL cache opaque handle.
+ * @ingroup tizurlcache
+ */
+typedef struct tiz_urlcache tiz_urlcache_t;
+typedef /*@null@ */ tiz_urlcache_t * tiz_urlcache_ptr_t;
+
+/**
+ * An entry being read from or written to the cache.
+ * @ingroup tizurlcache
+ */
+typedef struct tiz_urlcache_entry tiz_urlcache_entry_t;
+
+/**
+ * Create a new URL cache.
+ *
+ * @ingroup tizurlcache
+ * @param app_cache A cache handle to be initialised.
+ * @param a_type The storage backend.
+ * @param a_max_bytes The maximum size of the store.
+ * @return OMX_ErrorNone on success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_urlcache_init (tiz_urlcache_ptr_t * app_cache,
+                   const tiz_urlcache_type_t a_type, const size_t a_max_bytes);
+
+/**
+ * Destroy a URL cache. Any entries still open must have been closed.
+ *
+ * @ingroup tizurlcache
+ */
+void
+tiz_urlcache_destroy (tiz_urlcache_t * ap_cache);
+
+/**
+ * Find the storage backend named by a string ("none", "memory" or "disk").
+ *
+ * @ingroup tizurlcache
+ * @return The backend, or ETIZUrlCacheTypeNone if the name is unknown.
+ */
+tiz_urlcache_type_t
+tiz_urlcache_type_from_str (const char * ap_str);
+
+/**
+ * Find whether the complete contents of a key are in the cache.
+ *
+ * @ingroup tizurlcache
+ */
+bool
+tiz_urlcache_contains (tiz_urlcache_t * ap_cache, const char * ap_key);
+
+/**
+ * Open a complete entry for reading.
+ *
+ * @ingroup tizurlcache
+ * @return The entry, or NULL if the key is not in the cache.
+ */
+tiz_urlcache_entry_t *
+tiz_urlcache_open (tiz_urlcache_t * ap_cache, const char * ap_key);
+
+/**
+ * Read the next bytes of the body of an entry open for reading.
+ *
+ * @ingroup tizurlcache
+ * @return The number of bytes read, 0 at the end of the body.
+ */
+size_t
+tiz_urlcache_read (tiz_urlcache_entry_t * ap_entry, void * ap_dst,
+                   const size_t a_nbytes);
+
+/**
+ * Retrieve the response headers stored with an entry, as a sequence of
+ * CRLF-terminated lines.
+ *
+ * @ingroup tizurlcache
+ */
+const char *
+tiz_urlcache_headers (const tiz_urlcache_entry_t * ap_entry,
+                      size_t * ap_nbytes);
+
+/**
+ * Retrieve the size of the body of an entry.
+ *
+ * @ingroup tizurlcache
+ */
+uint64_t
+tiz_urlcache_size (const tiz_urlcache_entry_t * ap_entry);
+
+/**
+ * Close an entry open for reading.
+ *
+ * @ingroup tizurlcache
+ */
+void
+tiz_urlcache_close (tiz_urlcache_entry_t * ap_entry);
+
+/**
+ * Create a new entry to be written. The body must be written in order.
+ *
+ * @ingroup tizurlcache
+ * @param ap_cache The cache handle.
+ * @param ap_key The key.
+ * @param ap_headers The response headers (CRLF-terminated lines).
+ * @param a_headers_len The length of the headers.
+ * @param a_size The size of the body.
+ * @return The entry, or NULL if the body would not fit in the store.
+ */
+tiz_urlcache_entry_t *
+tiz_urlcache_create (tiz_urlcache_t * ap_cache, const char * ap_key,
+                     const char * ap_headers, const size_t a_headers_len,
+                     const uint64_t a_size);
+
+/**
+ * Append data to the body of an entry being written.
+ *
+ * @ingroup tizurlcache
+ * @return OMX_ErrorNone on success, OMX_ErrorOverflow if the data exceeds the
+ * size given on creation, or OMX_ErrorInsufficientResources.
+ */
+OMX_ERRORTYPE
+tiz_urlcache_write (tiz_urlcache_entry_t * ap_entry, const void * ap_data,
+                    const size_t a_nbytes);
+
+/**
+ * Retrieve the number of body bytes written so far to an entry.
+ *
+ * @ingroup tizurlcache
+ */
+uint64_t
+tiz_urlcache_written (const tiz_urlcache_entry_t * ap_entry);
+
+/**
+ * Close an entry being written. The entry is added to the cache if the whole
+ * body was written, and discarded otherwise.
+ *
+ * @ingroup tizurlcache
+ * @return OMX_ErrorNone if the entry was added to the cache.
+ */
+OMX_ERRORTYPE
+tiz_urlcache_commit (tiz_urlcache_entry_t * ap_entry);
+
+/**
+ * Close and discard an entry being written.
+ *
+ * @ingroup tizurlcache
+ */
+void
+tiz_urlcache_discard (tiz_urlcache_entry_t * ap_entry);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* TIZURLCACHE_H */
@@ -32,8 +32,10 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <curl/curl.h>
 
@@ -65,6 +67,26 @@ static inline OMX_ERRORTYPE
 stop_io_watcher (tiz_urltrans_t * ap_trans);
 static void
 report_connection_lost_event (tiz_urltrans_t * ap_trans);
+static void
+cancel_prefetch (tiz_urltrans_t * ap_trans);
+
+/* Number of consecutive attempts to resume an interrupted resource */
+#define URLTRANS_MAX_RESUME_ATTEMPTS 3
+/* Default size of the cache, in MiB */
+#define URLTRANS_DEFAULT_CACHE_SIZE_MB 128
+/* Cached contents are delivered in chunks of the size that curl uses */
+#define URLTRANS_REPLAY_CHUNK_SIZE CURL_MAX_WRITE_SIZE
+#define URLTRANS_REPLAY_CHUNKS_PER_EVENT 4
+#define URLTRANS_REPLAY_PERIOD 0.001
+
+/* Jitter buffer. The pre-roll target covers a base amount of playback plus a
+   multiple of the measured deviation of the arrival gaps, times a growth
+   factor that doubles after every underrun and decays when there are none */
+#define URLTRANS_JB_MIN_BYTES (4 * CURL_MAX_WRITE_SIZE)
+#define URLTRANS_JB_BASE_SECONDS 2.0
+#define URLTRANS_JB_DEV_FACTOR 4.0
+#define URLTRANS_JB_MAX_GROWTH 8
+#define URLTRANS_JB_GROWTH_DECAY_SECONDS 60.0
 
 /* These macros assume the existence of an "ap_trans" local variable */
 #define bail_on_curl_error(expr)                                           \
@@ -174,6 +196,17 @@ static const httpsrc_curl_state_id_str_t httpsrc_curl_state_id_str_tbl[]
      {ECurlStatePaused, (const OMX_STRING) "ECurlStatePaused"},
      {ECurlStateMax, (const OMX_STRING) "ECurlStateMax"}};
 
+/* What is known about the response being received on an easy handle */
+typedef struct urltrans_resp urltrans_resp_t;
+struct urltrans_resp
+{
+  long status;
+  curl_off_t length; /* -1 if unknown */
+  bool accept_ranges;
+  tiz_buffer_t * p_headers; /* The header lines of the last response */
+  tiz_urlcache_entry_t * p_writer; /* The body is being cached here */
+};
+
 struct tiz_urltrans
 {
   void * p_parent_;                        /* not owned */
@@ -197,7 +230,19 @@ struct tiz_urltrans
   bool awaiting_reconnect_timer_ev_;
   tiz_buffer_t * p_store_;
   int internal_buffer_size_;
-  int internal_buffer_size_initial_;
+  int internal_buffer_size_initial_; /* > 0 while pre-rolling */
+  /* Jitter buffer */
+  bool jb_enabled_;
+  int jb_byte_rate_;
+  OMX_U32 jb_low_watermark_;  /* min. pre-roll, % of the capacity */
+  OMX_U32 jb_high_watermark_; /* pause level, % of the capacity */
+  int jb_target_;
+  int jb_growth_;
+  double jb_last_arrival_; /* 0 if there is no reference */
+  double jb_gap_avg_;
+  double jb_gap_dev_;
+  double jb_last_change_; /* last time the growth factor changed */
+  unsigned int jb_underruns_;
   CURL * p_curl_;        /* curl easy */
   CURLM * p_curl_multi_; /* curl multi */
   struct curl_slist * p_http_ok_aliases_;
@@ -206,6 +251,32 @@ struct tiz_urltrans
   unsigned int curl_version_;
   char curl_err[CURL_ERROR_SIZE];
   bool handshake_error_found;
+  CURLcode curl_result_;
+  /* The resource being transferred */
+  urltrans_resp_t resp_;
+  curl_off_t content_length_; /* -1 if unknown */
+  bool accept_ranges_;
+  curl_off_t bytes_received_; /* body bytes delivered so far */
+  curl_off_t resume_from_; /* offset requested when resuming */
+  curl_off_t skip_bytes_; /* to drop when a server ignores the range */
+  bool resuming_;
+  int resume_attempts_;
+  /* Cache */
+  tiz_urlcache_type_t cache_type_;
+  tiz_urlcache_t * p_cache_;
+  char * p_cache_key_;
+  tiz_urlcache_entry_t * p_replay_; /* The resource is served from here */
+  unsigned char * p_replay_buf_;
+  size_t replay_len_; /* bytes in p_replay_buf_ not consumed yet */
+  tiz_event_timer_t * p_ev_replay_timer_;
+  bool awaiting_replay_timer_ev_;
+  /* Prefetch */
+  CURL * p_prefetch_curl_;
+  char * p_prefetch_key_;
+  urltrans_resp_t prefetch_resp_;
+  tiz_event_io_t * p_ev_prefetch_io_;
+  int prefetch_sockfd_;
+  tiz_event_io_event_t prefetch_io_type_;
 };
 
 /*@observer@*/ const char *
@@ -269,6 +340,7 @@ httpsrc_curl_state_to_str (const httpsrc_curl_state_id_t a_state)
         {                                                   \
           assert (ap_trans->awaiting_curl_timer_ev_         \
                   || ap_trans->awaiting_reconnect_timer_ev_ \
+                  || ap_trans->awaiting_replay_timer_ev_    \
                   || ap_trans->awaiting_io_ev_);            \
         }                                                   \
     }                                                       \
@@ -311,6 +383,125 @@ is_passed_buffer_high_watermark (tiz_urltrans_t * ap_trans)
           >= ap_trans->internal_buffer_size_initial_);
 }
 
+static inline double
+now_seconds (void)
+{
+  struct timespec ts;
+  (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* The fill level above which curl is paused */
+static inline int
+jb_pause_level (const tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  return (int) (((long long) ap_trans->internal_buffer_size_
+                 * ap_trans->jb_high_watermark_)
+                / 100);
+}
+
+static int
+jb_compute_target (const tiz_urltrans_t * ap_trans)
+{
+  int min_level = 0;
+  int max_level = 0;
+  int target = 0;
+  assert (ap_trans);
+
+  max_level = jb_pause_level (ap_trans);
+  if (!ap_trans->jb_enabled_)
+    {
+      return max_level;
+    }
+
+  min_level = MAX ((int) (((long long) ap_trans->internal_buffer_size_
+                           * ap_trans->jb_low_watermark_)
+                          / 100),
+                   URLTRANS_JB_MIN_BYTES);
+  if (ap_trans->jb_byte_rate_ > 0)
+    {
+      target = (int) (ap_trans->jb_byte_rate_
+                      * (URLTRANS_JB_BASE_SECONDS
+                         + URLTRANS_JB_DEV_FACTOR * ap_trans->jb_gap_dev_)
+                      * ap_trans->jb_growth_);
+    }
+  else
+    {
+      target = URLTRANS_JB_MIN_BYTES * ap_trans->jb_growth_;
+    }
+  return MIN (MAX (target, min_level), max_level);
+}
+
+/* Keeps running estimates of the mean and the mean deviation of the gaps
+   between arrivals (as TCP does with round-trip times) */
+static void
+jb_on_arrival (tiz_urltrans_t * ap_trans)
+{
+  double now = 0;
+  assert (ap_trans);
+
+  if (!ap_trans->jb_enabled_)
+    {
+      return;
+    }
+
+  now = now_seconds ();
+  if (ap_trans->jb_last_arrival_ > 0)
+    {
+      const double err
+        = (now - ap_trans->jb_last_arrival_) - ap_trans->jb_gap_avg_;
+      ap_trans->jb_gap_avg_ += err / 8;
+      ap_trans->jb_gap_dev_
+        += ((err < 0 ? -err : err) - ap_trans->jb_gap_dev_) / 4;
+    }
+  ap_trans->jb_last_arrival_ = now;
+
+  if (ap_trans->jb_growth_ > 1
+      && now - ap_trans->jb_last_change_ > URLTRANS_JB_GROWTH_DECAY_SECONDS)
+    {
+      ap_trans->jb_growth_ /= 2;
+      ap_trans->jb_last_change_ = now;
+    }
+  ap_trans->jb_target_ = jb_compute_target (ap_trans);
+}
+
+static void
+jb_on_underrun (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  ++(ap_trans->jb_underruns_);
+  ap_trans->jb_growth_
+    = MIN (ap_trans->jb_growth_ * 2, URLTRANS_JB_MAX_GROWTH);
+  ap_trans->jb_last_change_ = now_seconds ();
+  ap_trans->jb_target_ = jb_compute_target (ap_trans);
+  /* Pre-roll again */
+  ap_trans->internal_buffer_size_initial_ = ap_trans->jb_target_;
+  TIZ_LOG (TIZ_PRIORITY_NOTICE,
+           "[%s] : buffer underrun [%u] - pre-rolling [%d] bytes",
+           ap_trans->p_comp_name_, ap_trans->jb_underruns_,
+           ap_trans->jb_target_);
+}
+
+static OMX_ERRORTYPE
+configure_curl_multi (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  assert (ap_trans->p_curl_multi_);
+  /* Set the socket callback with CURLMOPT_SOCKETFUNCTION */
+  on_curl_multi_error_ret_omx_oom (curl_multi_setopt (
+    ap_trans->p_curl_multi_, CURLMOPT_SOCKETFUNCTION, curl_socket_cback));
+  on_curl_multi_error_ret_omx_oom (
+    curl_multi_setopt (ap_trans->p_curl_multi_, CURLMOPT_SOCKETDATA, ap_trans));
+  /* Set the timeout callback with CURLMOPT_TIMERFUNCTION, to get to know what
+     timeout value to use when waiting for socket activities. */
+  on_curl_multi_error_ret_omx_oom (curl_multi_setopt (
+    ap_trans->p_curl_multi_, CURLMOPT_TIMERFUNCTION, curl_timer_cback));
+  on_curl_multi_error_ret_omx_oom (
+    curl_multi_setopt (ap_trans->p_curl_multi_, CURLMOPT_TIMERDATA, ap_trans));
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 start_curl (tiz_urltrans_t * ap_trans)
 {
@@ -366,6 +557,11 @@ start_curl (tiz_urltrans_t * ap_trans)
   bail_on_curl_error (curl_easy_setopt (ap_trans->p_curl_, CURLOPT_HTTPHEADER,
                                         ap_trans->p_http_headers_));
 
+  /* Pick up an interrupted resource where it was left */
+  bail_on_curl_error (curl_easy_setopt (
+    ap_trans->p_curl_, CURLOPT_RESUME_FROM_LARGE,
+    (curl_off_t) (ap_trans->resuming_ ? ap_trans->resume_from_ : 0)));
+
   /* #ifdef _DEBUG */
   bail_on_curl_error (curl_easy_setopt (ap_trans->p_curl_, CURLOPT_VERBOSE, 1));
   bail_on_curl_error (
@@ -374,17 +570,8 @@ start_curl (tiz_urltrans_t * ap_trans)
     ap_trans->p_curl_, CURLOPT_DEBUGFUNCTION, curl_debug_cback));
   /* #endif */
 
-  /* Set the socket callback with CURLMOPT_SOCKETFUNCTION */
-  bail_on_curl_multi_error (curl_multi_setopt (
-    ap_trans->p_curl_multi_, CURLMOPT_SOCKETFUNCTION, curl_socket_cback));
-  bail_on_curl_multi_error (
-    curl_multi_setopt (ap_trans->p_curl_multi_, CURLMOPT_SOCKETDATA, ap_trans));
-  /* Set the timeout callback with CURLMOPT_TIMERFUNCTION, to get to know what
-     timeout value to use when waiting for socket activities. */
-  bail_on_curl_multi_error (curl_multi_setopt (
-    ap_trans->p_curl_multi_, CURLMOPT_TIMERFUNCTION, curl_timer_cback));
-  bail_on_curl_multi_error (
-    curl_multi_setopt (ap_trans->p_curl_multi_, CURLMOPT_TIMERDATA, ap_trans));
+  tiz_check_omx (configure_curl_multi (ap_trans));
+
   /* Add the easy handle to the multi */
   bail_on_curl_multi_error (
     curl_multi_add_handle (ap_trans->p_curl_multi_, ap_trans->p_curl_));
@@ -542,6 +729,138 @@ stop_reconnect_timer_watcher (tiz_urltrans_t * ap_trans)
   return rc;
 }
 
+static inline OMX_ERRORTYPE
+start_replay_timer_watcher (tiz_urltrans_t * ap_trans)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  assert (ap_trans);
+  assert (ap_trans->p_ev_replay_timer_);
+  assert (ap_trans->timer_cbacks_.pf_timer_start);
+  if (!ap_trans->awaiting_replay_timer_ev_)
+    {
+      ap_trans->awaiting_replay_timer_ev_ = true;
+      rc = ap_trans->timer_cbacks_.pf_timer_start (
+        ap_trans->p_parent_, ap_trans->p_ev_replay_timer_,
+        URLTRANS_REPLAY_PERIOD, 0.);
+    }
+  return rc;
+}
+
+static inline OMX_ERRORTYPE
+stop_replay_timer_watcher (tiz_urltrans_t * ap_trans)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  assert (ap_trans);
+  assert (ap_trans->timer_cbacks_.pf_timer_stop);
+  if (ap_trans->awaiting_replay_timer_ev_)
+    {
+      ap_trans->awaiting_replay_timer_ev_ = false;
+      if (ap_trans->p_ev_replay_timer_)
+        {
+          rc = ap_trans->timer_cbacks_.pf_timer_stop (
+            ap_trans->p_parent_, ap_trans->p_ev_replay_timer_);
+        }
+    }
+  return rc;
+}
+
+static inline void
+destroy_prefetch_io_watcher (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  assert (ap_trans->io_cbacks_.pf_io_stop);
+  assert (ap_trans->io_cbacks_.pf_io_destroy);
+  if (ap_trans->p_ev_prefetch_io_)
+    {
+      (void) ap_trans->io_cbacks_.pf_io_stop (ap_trans->p_parent_,
+                                              ap_trans->p_ev_prefetch_io_);
+      ap_trans->io_cbacks_.pf_io_destroy (ap_trans->p_parent_,
+                                          ap_trans->p_ev_prefetch_io_);
+      ap_trans->p_ev_prefetch_io_ = NULL;
+    }
+  ap_trans->prefetch_sockfd_ = -1;
+}
+
+static inline OMX_ERRORTYPE
+start_prefetch_io_watcher (tiz_urltrans_t * ap_trans, const int fd,
+                           const tiz_event_io_event_t io_type)
+{
+  assert (ap_trans);
+  assert (ap_trans->io_cbacks_.pf_io_init);
+  assert (ap_trans->io_cbacks_.pf_io_start);
+
+  if (fd != ap_trans->prefetch_sockfd_
+      || io_type != ap_trans->prefetch_io_type_)
+    {
+      destroy_prefetch_io_watcher (ap_trans);
+    }
+
+  if (!ap_trans->p_ev_prefetch_io_)
+    {
+      ap_trans->prefetch_sockfd_ = fd;
+      ap_trans->prefetch_io_type_ = io_type;
+      tiz_check_omx (ap_trans->io_cbacks_.pf_io_init (
+        ap_trans->p_parent_, &(ap_trans->p_ev_prefetch_io_),
+        ap_trans->prefetch_sockfd_, ap_trans->prefetch_io_type_, true));
+    }
+  return ap_trans->io_cbacks_.pf_io_start (ap_trans->p_parent_,
+                                           ap_trans->p_ev_prefetch_io_);
+}
+
+static void
+finish_prefetch (tiz_urltrans_t * ap_trans, const CURLcode a_result)
+{
+  urltrans_resp_t * p_resp = NULL;
+  assert (ap_trans);
+  p_resp = &(ap_trans->prefetch_resp_);
+  if (p_resp->p_writer)
+    {
+      /* This discards the entry if the body is incomplete */
+      if (OMX_ErrorNone == tiz_urlcache_commit (p_resp->p_writer))
+        {
+          TIZ_LOG (TIZ_PRIORITY_TRACE, "prefetched [%s]",
+                   ap_trans->p_prefetch_key_);
+        }
+      p_resp->p_writer = NULL;
+    }
+  if (CURLE_OK != a_result)
+    {
+      TIZ_LOG (TIZ_PRIORITY_NOTICE, "prefetch of [%s] failed (%s)",
+               ap_trans->p_prefetch_key_, curl_easy_strerror (a_result));
+    }
+  cancel_prefetch (ap_trans);
+}
+
+/* Collects the transfers that have completed. Returns true if the main
+   transfer is one of them. */
+static bool
+check_multi_info (tiz_urltrans_t * ap_trans)
+{
+  CURLMsg * p_msg = NULL;
+  int msgs_left = 0;
+  bool main_done = false;
+  assert (ap_trans);
+  while ((p_msg = curl_multi_info_read (ap_trans->p_curl_multi_, &msgs_left)))
+    {
+      if (CURLMSG_DONE == p_msg->msg)
+        {
+          /* The message is not valid once its handle is removed */
+          CURL * p_easy = p_msg->easy_handle;
+          const CURLcode result = p_msg->data.result;
+          if (p_easy == ap_trans->p_curl_)
+            {
+              ap_trans->curl_result_ = result;
+              main_done = true;
+            }
+          else if (p_easy && p_easy == ap_trans->p_prefetch_curl_)
+            {
+              finish_prefetch (ap_trans, result);
+            }
+        }
+    }
+  return main_done;
+}
+
 static OMX_ERRORTYPE
 kickstart_curl_socket (tiz_urltrans_t * ap_trans, int * ap_running_handles)
 {
@@ -552,7 +871,8 @@ kickstart_curl_socket (tiz_urltrans_t * ap_trans, int * ap_running_handles)
       on_curl_multi_error_ret_omx_oom (curl_multi_socket_action (
         ap_trans->p_curl_multi_, CURL_SOCKET_TIMEOUT, 0, ap_running_handles));
     }
-  while (0 == ap_trans->curl_timeout_);
+  /* Once the last transfer is done, curl may not update the timeout again */
+  while (0 == ap_trans->curl_timeout_ && *ap_running_handles > 0);
 
   return OMX_ErrorNone;
 }
@@ -562,6 +882,13 @@ resume_curl (tiz_urltrans_t * ap_trans)
 {
   assert (ap_trans);
 
+  if (is_transfer_paused (ap_trans) && ap_trans->p_replay_)
+    {
+      /* Being served from the cache */
+      set_curl_state (ap_trans, ECurlStateTransfering);
+      return start_replay_timer_watcher (ap_trans);
+    }
+
   if (is_transfer_paused (ap_trans))
     {
       int running_handles = 0;
@@ -588,7 +915,7 @@ resume_curl (tiz_urltrans_t * ap_trans)
             curl_multi_socket_all (ap_trans->p_curl_multi_, &running_handles));
         }
       tiz_check_omx (kickstart_curl_socket (ap_trans, &running_handles));
-      if (!running_handles)
+      if (check_multi_info (ap_trans))
         {
           report_connection_lost_event (ap_trans);
         }
@@ -632,11 +959,103 @@ send_from_internal_buffer (tiz_urltrans_t * p_trans)
   return OMX_ErrorNone;
 }
 
+/* With the jitter buffer on, data is held back while pre-rolling */
+static OMX_ERRORTYPE
+deliver_from_internal_buffer (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  if (ap_trans->jb_enabled_ && ap_trans->internal_buffer_size_initial_ > 0)
+    {
+      if (!is_passed_buffer_high_watermark (ap_trans))
+        {
+          return OMX_ErrorNone;
+        }
+      ap_trans->internal_buffer_size_initial_ = 0;
+    }
+  return send_from_internal_buffer (ap_trans);
+}
+
 static void
 reset_initial_buffer_size (tiz_urltrans_t * ap_trans)
 {
   assert (ap_trans);
-  ap_trans->internal_buffer_size_initial_ = ap_trans->internal_buffer_size_;
+  ap_trans->jb_last_arrival_ = 0;
+  ap_trans->jb_target_ = jb_compute_target (ap_trans);
+  ap_trans->internal_buffer_size_initial_ = ap_trans->jb_target_;
+}
+
+static void
+close_cache_entries (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  /* An entry still being written is incomplete */
+  tiz_urlcache_discard (ap_trans->resp_.p_writer);
+  ap_trans->resp_.p_writer = NULL;
+  tiz_urlcache_close (ap_trans->p_replay_);
+  ap_trans->p_replay_ = NULL;
+  ap_trans->replay_len_ = 0;
+  (void) stop_replay_timer_watcher (ap_trans);
+}
+
+static void
+reset_resource_state (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  close_cache_entries (ap_trans);
+  ap_trans->content_length_ = -1;
+  ap_trans->accept_ranges_ = false;
+  ap_trans->bytes_received_ = 0;
+  ap_trans->resume_from_ = 0;
+  ap_trans->skip_bytes_ = 0;
+  ap_trans->resuming_ = false;
+  ap_trans->resume_attempts_ = 0;
+  ap_trans->curl_result_ = CURLE_OK;
+}
+
+/* Transparently re-requests the rest of a resource of known length that was
+   interrupted. The client is not told about the reconnection. */
+static bool
+resume_transfer (tiz_urltrans_t * ap_trans)
+{
+  int running_handles = 0;
+  bool use_range = false;
+  assert (ap_trans);
+
+  if (ap_trans->p_replay_ || ap_trans->content_length_ <= 0
+      || ap_trans->bytes_received_ <= 0
+      || ap_trans->bytes_received_ >= ap_trans->content_length_
+      || ap_trans->resume_attempts_ >= URLTRANS_MAX_RESUME_ATTEMPTS
+      || CURLE_HTTP_RETURNED_ERROR == ap_trans->curl_result_
+      || CURLE_WRITE_ERROR == ap_trans->curl_result_
+      || CURLE_ABORTED_BY_CALLBACK == ap_trans->curl_result_)
+    {
+      return false;
+    }
+
+  /* If the server turns out not to honour ranges, curl fails with a range
+     error; then the resource is requested again and the part already
+     delivered is dropped */
+  use_range = ap_trans->accept_ranges_
+              && CURLE_RANGE_ERROR != ap_trans->curl_result_;
+  ap_trans->resuming_ = true;
+  ap_trans->resume_from_ = use_range ? ap_trans->bytes_received_ : 0;
+  ap_trans->skip_bytes_ = use_range ? 0 : ap_trans->bytes_received_;
+  ++(ap_trans->resume_attempts_);
+
+  TIZ_LOG (TIZ_PRIORITY_NOTICE,
+           "resuming [%s] at [%lld] of [%lld] bytes (%s) - attempt [%d]",
+           ap_trans->p_uri_param_->contentURI,
+           (long long) ap_trans->bytes_received_,
+           (long long) ap_trans->content_length_,
+           curl_easy_strerror (ap_trans->curl_result_),
+           ap_trans->resume_attempts_);
+
+  curl_multi_remove_handle (ap_trans->p_curl_multi_, ap_trans->p_curl_);
+  set_curl_state (ap_trans, ECurlStateStopped);
+  ap_trans->curl_result_ = CURLE_OK;
+  return (OMX_ErrorNone == start_curl (ap_trans)
+          && OMX_ErrorNone
+               == kickstart_curl_socket (ap_trans, &running_handles));
 }
 
 static void
@@ -644,10 +1063,15 @@ report_connection_lost_event (tiz_urltrans_t * ap_trans)
 {
   bool auto_reconnect = false;
   assert (ap_trans);
+  if (resume_transfer (ap_trans))
+    {
+      return;
+    }
   stop_curl_timer_watcher (ap_trans);
   assert (ap_trans->info_cbacks_.pf_connection_lost);
   set_curl_state (ap_trans, ECurlStateStopped);
   send_from_internal_buffer (ap_trans);
+  reset_resource_state (ap_trans);
   auto_reconnect
     = ap_trans->info_cbacks_.pf_connection_lost (ap_trans->p_parent_);
   reset_initial_buffer_size (ap_trans);
@@ -657,6 +1081,146 @@ report_connection_lost_event (tiz_urltrans_t * ap_trans)
     }
 }
 
+static inline const char *
+get_cache_key (const tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  return ap_trans->p_cache_key_
+           ? ap_trans->p_cache_key_
+           : (const char *) ap_trans->p_uri_param_->contentURI;
+}
+
+static bool
+header_has_name (const char * ap_line, const size_t a_len,
+                 const char * ap_name)
+{
+  const size_t name_len = strlen (ap_name);
+  return (a_len > name_len && 0 == strncasecmp (ap_line, ap_name, name_len));
+}
+
+/* Copies the value of a header line into a nul-terminated string */
+static const char *
+header_value (const char * ap_line, const size_t a_len, char * ap_dst,
+              const size_t a_dst_len)
+{
+  const char * p_colon = memchr (ap_line, ':', a_len);
+  size_t len = 0;
+  if (p_colon)
+    {
+      len = MIN (a_dst_len - 1, a_len - (size_t) (p_colon + 1 - ap_line));
+      memcpy (ap_dst, p_colon + 1, len);
+    }
+  ap_dst[len] = '\0';
+  return ap_dst;
+}
+
+/* Updates what is known about a response with a header line. Returns true if
+   the line is the one that ends the headers. */
+static bool
+parse_response_header (urltrans_resp_t * ap_resp, const char * ap_line,
+                       const size_t a_len)
+{
+  char value[64];
+
+  assert (ap_resp);
+  assert (ap_line);
+
+  if (header_has_name (ap_line, a_len, "HTTP/")
+      || header_has_name (ap_line, a_len, "ICY "))
+    {
+      /* A new response (e.g. after a redirection) */
+      const char * p_code = memchr (ap_line, ' ', a_len);
+      ap_resp->status = p_code ? strtol (p_code + 1, NULL, 10) : 0;
+      ap_resp->length = -1;
+      ap_resp->accept_ranges = false;
+      tiz_buffer_clear (ap_resp->p_headers);
+    }
+  else if (header_has_name (ap_line, a_len, "Content-Length:"))
+    {
+      ap_resp->length = strtoll (
+        header_value (ap_line, a_len, value, sizeof (value)), NULL, 10);
+    }
+  else if (header_has_name (ap_line, a_len, "Accept-Ranges:"))
+    {
+      ap_resp->accept_ranges
+        = (NULL
+           != strstr (header_value (ap_line, a_len, value, sizeof (value)),
+                      "bytes"));
+    }
+
+  (void) tiz_buffer_push (ap_resp->p_headers, ap_line, a_len);
+
+  return (a_len <= 2 && ('\r' == ap_line[0] || '\n' == ap_line[0]));
+}
+
+static inline bool
+is_final_response (const urltrans_resp_t * ap_resp)
+{
+  assert (ap_resp);
+  /* Neither informational nor a redirection */
+  return (ap_resp->status >= 200
+          && (ap_resp->status < 300 || ap_resp->status >= 400));
+}
+
+static void
+on_final_headers (tiz_urltrans_t * ap_trans)
+{
+  urltrans_resp_t * p_resp = NULL;
+  assert (ap_trans);
+  p_resp = &(ap_trans->resp_);
+
+  if (ap_trans->resuming_)
+    {
+      /* This is the rest of a resource the client already knows about */
+      ap_trans->resuming_ = false;
+      return;
+    }
+
+  ap_trans->content_length_ = (200 == p_resp->status) ? p_resp->length : -1;
+  ap_trans->accept_ranges_ = p_resp->accept_ranges;
+
+  if (ap_trans->content_length_ > 0 && !p_resp->p_writer)
+    {
+      p_resp->p_writer = tiz_urlcache_create (
+        ap_trans->p_cache_, get_cache_key (ap_trans),
+        (const char *) tiz_buffer_get (p_resp->p_headers),
+        tiz_buffer_available (p_resp->p_headers), ap_trans->content_length_);
+    }
+}
+
+static void
+record_received_data (tiz_urltrans_t * ap_trans, const void * ap_data,
+                      const size_t a_nbytes)
+{
+  urltrans_resp_t * p_resp = NULL;
+  assert (ap_trans);
+  p_resp = &(ap_trans->resp_);
+
+  if (ap_trans->p_replay_ || 0 == a_nbytes)
+    {
+      return;
+    }
+
+  ap_trans->bytes_received_ += a_nbytes;
+  ap_trans->resume_attempts_ = 0;
+
+  if (p_resp->p_writer)
+    {
+      if (OMX_ErrorNone
+          != tiz_urlcache_write (p_resp->p_writer, ap_data, a_nbytes))
+        {
+          tiz_urlcache_discard (p_resp->p_writer);
+          p_resp->p_writer = NULL;
+        }
+      else if (tiz_urlcache_written (p_resp->p_writer)
+               == (uint64_t) ap_trans->content_length_)
+        {
+          (void) tiz_urlcache_commit (p_resp->p_writer);
+          p_resp->p_writer = NULL;
+        }
+    }
+}
+
 /* This function gets called by libcurl as soon as it has received header
    data. The header callback will be called once for each header and only
    complete header lines are passed on to the callback. Parsing headers is very
@@ -672,11 +1236,21 @@ curl_header_cback (void * ptr, size_t size, size_t nmemb, void * userdata)
 {
   tiz_urltrans_t * p_trans = userdata;
   size_t nbytes = size * nmemb;
+  bool resuming = false;
   assert (p_trans);
   assert (p_trans->info_cbacks_.pf_header_avail);
   URLTRANS_LOG_CBACK_START (p_trans);
   stop_reconnect_timer_watcher (p_trans);
-  p_trans->info_cbacks_.pf_header_avail (p_trans->p_parent_, ptr, nbytes);
+  resuming = p_trans->resuming_;
+  if (parse_response_header (&(p_trans->resp_), ptr, nbytes)
+      && is_final_response (&(p_trans->resp_)))
+    {
+      on_final_headers (p_trans);
+    }
+  if (!resuming)
+    {
+      p_trans->info_cbacks_.pf_header_avail (p_trans->p_parent_, ptr, nbytes);
+    }
   URLTRANS_LOG_CBACK_END (p_trans);
   return nbytes;
 }
@@ -693,9 +1267,20 @@ curl_write_cback (void * ptr, size_t size, size_t nmemb, void * userdata)
   tiz_urltrans_t * p_trans = userdata;
   size_t nbytes = size * nmemb;
   size_t rc = nbytes;
+  size_t skip = 0;
+  void * p_data = NULL;
+  size_t data_len = 0;
   assert (p_trans);
   URLTRANS_LOG_CBACK_START (p_trans);
 
+  /* Drop what had been delivered before a resumption that restarted the
+     resource from the beginning */
+  skip = (size_t) MIN ((curl_off_t) nbytes, p_trans->skip_bytes_);
+  ptr = (char *) ptr + skip;
+  nbytes -= skip;
+  p_data = ptr;
+  data_len = nbytes;
+
   if (nbytes > 0)
     {
       set_curl_state (p_trans, ECurlStateTransfering);
@@ -711,13 +1296,18 @@ curl_write_cback (void * ptr, size_t size, size_t nmemb, void * userdata)
 
           rc = CURL_WRITEFUNC_PAUSE;
           set_curl_state (p_trans, ECurlStatePaused);
+          p_trans->jb_last_arrival_ = 0;
         }
       else
         {
+          if (!p_trans->p_replay_)
+            {
+              jb_on_arrival (p_trans);
+            }
 
           if (is_passed_buffer_high_watermark (p_trans))
             {
-              /* Reset the cache size */
+              /* Pre-roll complete */
               p_trans->internal_buffer_size_initial_ = 0;
 
               send_from_internal_buffer (p_trans);
@@ -739,14 +1329,18 @@ curl_write_cback (void * ptr, size_t size, size_t nmemb, void * userdata)
 
           if (nbytes > 0)
             {
-              if (tiz_buffer_available (p_trans->p_store_)
-                  > (p_trans->internal_buffer_size_))
+              /* curl delivers the whole chunk again after a pause, so
+                 pausing is only possible if none of it was consumed */
+              if (nbytes == data_len
+                  && tiz_buffer_available (p_trans->p_store_)
+                       > jb_pause_level (p_trans))
                 {
                   /* This is to pause curl */
                   TIZ_PRINTF_DBG_GRN ("Pausing curl - cache size [%d]",
                                       tiz_buffer_available (p_trans->p_store_));
                   rc = CURL_WRITEFUNC_PAUSE;
                   set_curl_state (p_trans, ECurlStatePaused);
+                  p_trans->jb_last_arrival_ = 0;
                   /* Also stop the watchers */
                   stop_io_watcher (p_trans);
                   stop_curl_timer_watcher (p_trans);
@@ -768,10 +1362,148 @@ curl_write_cback (void * ptr, size_t size, size_t nmemb, void * userdata)
         }
     }
 
+  if (CURL_WRITEFUNC_PAUSE != rc)
+    {
+      p_trans->skip_bytes_ -= skip;
+      record_received_data (p_trans, p_data, data_len);
+    }
+
   URLTRANS_LOG_CBACK_END (p_trans);
   return rc;
 }
 
+/* Serves the body of a cached resource as if it was being received */
+static OMX_ERRORTYPE
+replay_from_cache (tiz_urltrans_t * ap_trans)
+{
+  int nchunks = URLTRANS_REPLAY_CHUNKS_PER_EVENT;
+  assert (ap_trans);
+
+  while (ap_trans->p_replay_ && is_transfer_running (ap_trans)
+         && nchunks-- > 0)
+    {
+      if (0 == ap_trans->replay_len_)
+        {
+          ap_trans->replay_len_
+            = tiz_urlcache_read (ap_trans->p_replay_, ap_trans->p_replay_buf_,
+                                 URLTRANS_REPLAY_CHUNK_SIZE);
+        }
+      if (0 == ap_trans->replay_len_)
+        {
+          /* All the contents have been delivered */
+          report_connection_lost_event (ap_trans);
+          return OMX_ErrorNone;
+        }
+      /* The chunk is offered again later if it is not taken now */
+      if (CURL_WRITEFUNC_PAUSE
+          != curl_write_cback (ap_trans->p_replay_buf_, 1,
+                               ap_trans->replay_len_, ap_trans))
+        {
+          ap_trans->replay_len_ = 0;
+        }
+    }
+
+  if (ap_trans->p_replay_ && is_transfer_running (ap_trans))
+    {
+      deliver_from_internal_buffer (ap_trans);
+      return start_replay_timer_watcher (ap_trans);
+    }
+  return OMX_ErrorNone;
+}
+
+static bool
+start_replay (tiz_urltrans_t * ap_trans)
+{
+  const char * p_headers = NULL;
+  size_t headers_len = 0;
+  size_t offset = 0;
+
+  assert (ap_trans);
+  assert (!ap_trans->p_replay_);
+  assert (ap_trans->info_cbacks_.pf_header_avail);
+
+  if (!(ap_trans->p_replay_
+        = tiz_urlcache_open (ap_trans->p_cache_, get_cache_key (ap_trans))))
+    {
+      return false;
+    }
+
+  if (!ap_trans->p_replay_buf_
+      && !(ap_trans->p_replay_buf_
+           = tiz_mem_alloc (URLTRANS_REPLAY_CHUNK_SIZE)))
+    {
+      tiz_urlcache_close (ap_trans->p_replay_);
+      ap_trans->p_replay_ = NULL;
+      return false;
+    }
+
+  TIZ_LOG (TIZ_PRIORITY_NOTICE, "serving [%s] from the cache",
+           get_cache_key (ap_trans));
+
+  set_curl_state (ap_trans, ECurlStateTransfering);
+  ap_trans->replay_len_ = 0;
+  /* There is no network jitter to absorb */
+  ap_trans->internal_buffer_size_initial_ = 0;
+  ap_trans->content_length_ = tiz_urlcache_size (ap_trans->p_replay_);
+
+  /* The client sees the headers of the original response, one line at a
+     time */
+  p_headers = tiz_urlcache_headers (ap_trans->p_replay_, &headers_len);
+  while (offset < headers_len)
+    {
+      const char * p_eol
+        = memchr (p_headers + offset, '\n', headers_len - offset);
+      const size_t len = p_eol ? (size_t) (p_eol - (p_headers + offset)) + 1
+                               : headers_len - offset;
+      ap_trans->info_cbacks_.pf_header_avail (ap_trans->p_parent_,
+                                              p_headers + offset, len);
+      offset += len;
+    }
+
+  return (OMX_ErrorNone == start_replay_timer_watcher (ap_trans));
+}
+
+/* A prefetched resource is only cached if its length is known in advance */
+static size_t
+curl_prefetch_header_cback (void * ptr, size_t size, size_t nmemb,
+                            void * userdata)
+{
+  tiz_urltrans_t * p_trans = userdata;
+  const size_t nbytes = size * nmemb;
+  urltrans_resp_t * p_resp = NULL;
+  assert (p_trans);
+  p_resp = &(p_trans->prefetch_resp_);
+  if (parse_response_header (p_resp, ptr, nbytes)
+      && is_final_response (p_resp) && 200 == p_resp->status
+      && p_resp->length > 0 && !p_resp->p_writer)
+    {
+      p_resp->p_writer = tiz_urlcache_create (
+        p_trans->p_cache_, p_trans->p_prefetch_key_,
+        (const char *) tiz_buffer_get (p_resp->p_headers),
+        tiz_buffer_available (p_resp->p_headers), p_resp->length);
+    }
+  return nbytes;
+}
+
+/* The body of a prefetched resource only goes to the cache; the transfer is
+   aborted if it can not be stored */
+static size_t
+curl_prefetch_write_cback (void * ptr, size_t size, size_t nmemb,
+                           void * userdata)
+{
+  tiz_urltrans_t * p_trans = userdata;
+  const size_t nbytes = size * nmemb;
+  urltrans_resp_t * p_resp = NULL;
+  assert (p_trans);
+  p_resp = &(p_trans->prefetch_resp_);
+  if (!p_resp->p_writer
+      || OMX_ErrorNone != tiz_urlcache_write (p_resp->p_writer, ptr, nbytes))
+    {
+      return 0;
+    }
+  return nbytes;
+}
+
 /* #ifdef _DEBUG */
 /* Pass a pointer to a function that matches the following prototype: int
    curl_debug_callback (CURL *, curl_infotype, char *, size_t, void *);
@@ -854,7 +1586,24 @@ curl_socket_cback (CURL * easy, curl_socket_t s, int action, void * userp,
   TIZ_LOG (TIZ_PRIORITY_DEBUG,
            "socket [%d] action [%d] (1 READ, 2 WRITE, 3 READ/WRITE, 4 REMOVE)",
            s, action);
-  if (CURL_POLL_IN == action)
+  if (easy && easy == p_trans->p_prefetch_curl_)
+    {
+      /* The prefetch has a watcher of its own */
+      if (CURL_POLL_REMOVE == action)
+        {
+          destroy_prefetch_io_watcher (p_trans);
+        }
+      else if (CURL_POLL_NONE != action)
+        {
+          (void) start_prefetch_io_watcher (
+            p_trans, s,
+            CURL_POLL_OUT == action
+              ? TIZ_EVENT_WRITE
+              : (CURL_POLL_INOUT == action ? TIZ_EVENT_READ_OR_WRITE
+                                           : TIZ_EVENT_READ));
+        }
+    }
+  else if (CURL_POLL_IN == action)
     {
       (void) start_io_watcher (p_trans, s, TIZ_EVENT_READ);
     }
@@ -868,7 +1617,10 @@ curl_socket_cback (CURL * easy, curl_socket_t s, int action, void * userp,
       p_trans->io_cbacks_.pf_io_destroy (p_trans->p_parent_, p_trans->p_ev_io_);
       p_trans->p_ev_io_ = NULL;
       p_trans->sockfd_ = -1;
-      (void) stop_curl_timer_watcher (p_trans);
+      if (!p_trans->p_prefetch_curl_)
+        {
+          (void) stop_curl_timer_watcher (p_trans);
+        }
     }
   URLTRANS_LOG_CBACK_END (p_trans);
   return 0;
@@ -933,8 +1685,9 @@ allocate_temp_data_store (tiz_urltrans_t * ap_trans)
 {
   assert (ap_trans);
   assert (ap_trans->p_store_ == NULL);
-  tiz_check_omx (
-    tiz_buffer_init (&(ap_trans->p_store_), ap_trans->store_bytes_));
+  /* A ring store: the data waiting to be delivered is never moved */
+  tiz_check_omx (tiz_buffer_init_with_type (
+    &(ap_trans->p_store_), ap_trans->store_bytes_, ETIZBufferTypeRing));
   return OMX_ErrorNone;
 }
 
@@ -967,6 +1720,10 @@ allocate_events (tiz_urltrans_t * ap_trans)
   tiz_check_omx (ap_trans->timer_cbacks_.pf_timer_init (
     ap_trans->p_parent_, &(ap_trans->p_ev_curl_timer_)));
 
+  /* Allocate the timer event that paces the delivery of cached contents */
+  tiz_check_omx (ap_trans->timer_cbacks_.pf_timer_init (
+    ap_trans->p_parent_, &(ap_trans->p_ev_replay_timer_)));
+
   return OMX_ErrorNone;
 }
 
@@ -985,6 +1742,60 @@ destroy_events (tiz_urltrans_t * ap_trans)
   ap_trans->timer_cbacks_.pf_timer_destroy (ap_trans->p_parent_,
                                             ap_trans->p_ev_reconnect_timer_);
   ap_trans->p_ev_reconnect_timer_ = NULL;
+  ap_trans->timer_cbacks_.pf_timer_destroy (ap_trans->p_parent_,
+                                            ap_trans->p_ev_replay_timer_);
+  ap_trans->p_ev_replay_timer_ = NULL;
+  destroy_prefetch_io_watcher (ap_trans);
+}
+
+static OMX_ERRORTYPE
+allocate_cache (tiz_urltrans_t * ap_trans)
+{
+  char key[OMX_MAX_STRINGNAME_SIZE];
+  const char * p_value = NULL;
+  long size_mb = URLTRANS_DEFAULT_CACHE_SIZE_MB;
+
+  assert (ap_trans);
+  assert (!ap_trans->p_cache_);
+
+  /* e.g. OMX.Aratelia.audio_source.http.cache = disk */
+  (void) snprintf (key, sizeof (key), "%s.cache", ap_trans->p_comp_name_);
+  ap_trans->cache_type_ = tiz_urlcache_type_from_str (
+    tiz_rcfile_get_value (TIZ_RCFILE_PLUGINS_DATA_SECTION, key));
+
+  (void) snprintf (key, sizeof (key), "%s.cache_size", ap_trans->p_comp_name_);
+  if ((p_value = tiz_rcfile_get_value (TIZ_RCFILE_PLUGINS_DATA_SECTION, key))
+      && strtol (p_value, NULL, 10) > 0)
+    {
+      size_mb = strtol (p_value, NULL, 10);
+    }
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "cache [%d] size [%ld] MiB",
+           ap_trans->cache_type_, size_mb);
+
+  tiz_check_omx (tiz_urlcache_init (&(ap_trans->p_cache_),
+                                    ap_trans->cache_type_,
+                                    (size_t) size_mb * 1024 * 1024));
+  tiz_check_omx (tiz_buffer_init (&(ap_trans->resp_.p_headers), 1024));
+  tiz_check_omx (
+    tiz_buffer_init (&(ap_trans->prefetch_resp_.p_headers), 1024));
+  return OMX_ErrorNone;
+}
+
+static void
+destroy_cache (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  tiz_urlcache_destroy (ap_trans->p_cache_);
+  ap_trans->p_cache_ = NULL;
+  tiz_buffer_destroy (ap_trans->resp_.p_headers);
+  ap_trans->resp_.p_headers = NULL;
+  tiz_buffer_destroy (ap_trans->prefetch_resp_.p_headers);
+  ap_trans->prefetch_resp_.p_headers = NULL;
+  tiz_mem_free (ap_trans->p_replay_buf_);
+  ap_trans->p_replay_buf_ = NULL;
+  tiz_mem_free (ap_trans->p_cache_key_);
+  ap_trans->p_cache_key_ = NULL;
 }
 
 static OMX_ERRORTYPE
@@ -1097,6 +1908,17 @@ tiz_urltrans_init (tiz_urltrans_ptr_t * app_trans, void * ap_parent,
           p_trans->p_store_ = NULL;
           p_trans->internal_buffer_size_ = 0;
           p_trans->internal_buffer_size_initial_ = 0;
+          p_trans->jb_enabled_ = false;
+          p_trans->jb_byte_rate_ = 0;
+          p_trans->jb_low_watermark_ = 0;
+          p_trans->jb_high_watermark_ = 100;
+          p_trans->jb_target_ = 0;
+          p_trans->jb_growth_ = 1;
+          p_trans->jb_last_arrival_ = 0;
+          p_trans->jb_gap_avg_ = 0;
+          p_trans->jb_gap_dev_ = 0;
+          p_trans->jb_last_change_ = 0;
+          p_trans->jb_underruns_ = 0;
           p_trans->p_curl_ = NULL;
           p_trans->p_curl_multi_ = NULL;
           p_trans->p_http_ok_aliases_ = NULL;
@@ -1104,6 +1926,27 @@ tiz_urltrans_init (tiz_urltrans_ptr_t * app_trans, void * ap_parent,
           p_trans->curl_state_ = ECurlStateStopped;
           p_trans->curl_version_ = 0;
           p_trans->handshake_error_found = false;
+          p_trans->curl_result_ = CURLE_OK;
+          p_trans->content_length_ = -1;
+          p_trans->accept_ranges_ = false;
+          p_trans->bytes_received_ = 0;
+          p_trans->resume_from_ = 0;
+          p_trans->skip_bytes_ = 0;
+          p_trans->resuming_ = false;
+          p_trans->resume_attempts_ = 0;
+          p_trans->cache_type_ = ETIZUrlCacheTypeNone;
+          p_trans->p_cache_ = NULL;
+          p_trans->p_cache_key_ = NULL;
+          p_trans->p_replay_ = NULL;
+          p_trans->p_replay_buf_ = NULL;
+          p_trans->replay_len_ = 0;
+          p_trans->p_ev_replay_timer_ = NULL;
+          p_trans->awaiting_replay_timer_ev_ = false;
+          p_trans->p_prefetch_curl_ = NULL;
+          p_trans->p_prefetch_key_ = NULL;
+          p_trans->p_ev_prefetch_io_ = NULL;
+          p_trans->prefetch_sockfd_ = -1;
+          p_trans->prefetch_io_type_ = TIZ_EVENT_READ;
 
           rc = allocate_temp_data_store (p_trans);
           goto_end_on_omx_error (rc, "Unable to alloc the data store");
@@ -1113,6 +1956,9 @@ tiz_urltrans_init (tiz_urltrans_ptr_t * app_trans, void * ap_parent,
 
           rc = allocate_curl_resources (p_trans);
           goto_end_on_omx_error (rc, "Unable to alloc the timer events");
+
+          rc = allocate_cache (p_trans);
+          goto_end_on_omx_error (rc, "Unable to alloc the cache");
         }
 
     end:
@@ -1132,9 +1978,15 @@ tiz_urltrans_destroy (tiz_urltrans_t * ap_trans)
 {
   if (ap_trans)
     {
+      if (ap_trans->p_curl_multi_)
+        {
+          cancel_prefetch (ap_trans);
+        }
+      close_cache_entries (ap_trans);
       destroy_temp_data_store (ap_trans);
       destroy_events (ap_trans);
       destroy_curl_resources (ap_trans);
+      destroy_cache (ap_trans);
       curl_global_cleanup ();
     }
 }
@@ -1148,6 +2000,8 @@ tiz_urltrans_set_uri (tiz_urltrans_t * ap_trans,
   URLTRANS_LOG_API_START (ap_trans);
   ap_trans->p_uri_param_ = ap_uri_param;
   curl_multi_remove_handle (ap_trans->p_curl_multi_, ap_trans->p_curl_);
+  reset_resource_state (ap_trans);
+  tiz_urltrans_set_cache_key (ap_trans, NULL);
   bail_on_curl_error (curl_easy_setopt (ap_trans->p_curl_, CURLOPT_URL,
                                         ap_trans->p_uri_param_->contentURI));
   set_curl_state (ap_trans, ECurlStateStopped);
@@ -1158,6 +2012,113 @@ end:
   return;
 }
 
+void
+tiz_urltrans_set_cache_key (tiz_urltrans_t * ap_trans, const char * ap_key)
+{
+  assert (ap_trans);
+  tiz_mem_free (ap_trans->p_cache_key_);
+  ap_trans->p_cache_key_ = ap_key ? strdup (ap_key) : NULL;
+}
+
+static void
+cancel_prefetch (tiz_urltrans_t * ap_trans)
+{
+  assert (ap_trans);
+  if (ap_trans->p_prefetch_curl_)
+    {
+      if (ap_trans->p_curl_multi_)
+        {
+          curl_multi_remove_handle (ap_trans->p_curl_multi_,
+                                    ap_trans->p_prefetch_curl_);
+        }
+      curl_easy_cleanup (ap_trans->p_prefetch_curl_);
+      ap_trans->p_prefetch_curl_ = NULL;
+    }
+  destroy_prefetch_io_watcher (ap_trans);
+  tiz_urlcache_discard (ap_trans->prefetch_resp_.p_writer);
+  ap_trans->prefetch_resp_.p_writer = NULL;
+  tiz_mem_free (ap_trans->p_prefetch_key_);
+  ap_trans->p_prefetch_key_ = NULL;
+}
+
+OMX_ERRORTYPE
+tiz_urltrans_prefetch (tiz_urltrans_t * ap_trans, const char * ap_url,
+                       const char * ap_key)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
+  const char * p_key = ap_key ? ap_key : ap_url;
+  int running_handles = 0;
+  CURL * p_curl = NULL;
+
+  assert (ap_trans);
+  assert (ap_url);
+  URLTRANS_LOG_API_START (ap_trans);
+
+  if (ETIZUrlCacheTypeNone == ap_trans->cache_type_
+      || (ap_trans->p_prefetch_key_
+          && 0 == strcmp (ap_trans->p_prefetch_key_, p_key))
+      || tiz_urlcache_contains (ap_trans->p_cache_, p_key))
+    {
+      return OMX_ErrorNone;
+    }
+
+  cancel_prefetch (ap_trans);
+
+  bail_on_oom ((ap_trans->p_prefetch_key_ = strdup (p_key)));
+  bail_on_oom ((p_curl = ap_trans->p_prefetch_curl_ = curl_easy_init ()));
+  ap_trans->prefetch_resp_.status = 0;
+  ap_trans->prefetch_resp_.length = -1;
+  tiz_buffer_clear (ap_trans->prefetch_resp_.p_headers);
+
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_PRIVATE, ap_trans));
+  bail_on_curl_error (
+    curl_easy_setopt (p_curl, CURLOPT_USERAGENT, ap_trans->p_comp_name_));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_HEADERFUNCTION,
+                                        curl_prefetch_header_cback));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_WRITEHEADER, ap_trans));
+  bail_on_curl_error (
+    curl_easy_setopt (p_curl, CURLOPT_WRITEFUNCTION, curl_prefetch_write_cback));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_WRITEDATA, ap_trans));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_FOLLOWLOCATION, 1));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_NETRC, 1));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_MAXREDIRS, 5));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_FAILONERROR, 1));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_NOPROGRESS, 1));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_CONNECTTIMEOUT,
+                                        ap_trans->connect_timeout_));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_SSL_VERIFYHOST, 0));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_SSL_VERIFYPEER, 0));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_HTTPHEADER,
+                                        ap_trans->p_http_headers_));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_URL, ap_url));
+  /* A connection of its own, so that the main transfer never shares a socket
+     with it */
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_FRESH_CONNECT, 1));
+  bail_on_curl_error (curl_easy_setopt (p_curl, CURLOPT_FORBID_REUSE, 1));
+
+  goto_end_on_omx_error (configure_curl_multi (ap_trans),
+                         "Unable to configure curl multi");
+  bail_on_curl_multi_error (
+    curl_multi_add_handle (ap_trans->p_curl_multi_, p_curl));
+  goto_end_on_omx_error (kickstart_curl_socket (ap_trans, &running_handles),
+                         "Unable to start the prefetch");
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "prefetching [%s]", p_key);
+
+  /* all ok */
+  rc = OMX_ErrorNone;
+
+end:
+
+  if (OMX_ErrorNone != rc)
+    {
+      cancel_prefetch (ap_trans);
+    }
+
+  URLTRANS_LOG_API_END (ap_trans);
+  return rc;
+}
+
 void
 tiz_urltrans_set_connect_timeout (tiz_urltrans_t * ap_trans,
                                   const long a_connect_timeout)
@@ -1173,8 +2134,40 @@ tiz_urltrans_set_internal_buffer_size (tiz_urltrans_t * ap_trans,
   assert (ap_trans);
   assert (a_nbytes > 0);
   URLTRANS_LOG_API_START (ap_trans);
-  ap_trans->internal_buffer_size_ = ap_trans->internal_buffer_size_initial_
-    = a_nbytes;
+  ap_trans->internal_buffer_size_ = a_nbytes;
+  reset_initial_buffer_size (ap_trans);
+}
+
+void
+tiz_urltrans_set_streaming_buffer (tiz_urltrans_t * ap_trans,
+                                   const int a_byte_rate,
+                                   const OMX_U32 a_low_watermark,
+                                   const OMX_U32 a_high_watermark)
+{
+  assert (ap_trans);
+  URLTRANS_LOG_API_START (ap_trans);
+  ap_trans->jb_enabled_ = true;
+  ap_trans->jb_byte_rate_ = MAX (a_byte_rate, 0);
+  ap_trans->jb_high_watermark_
+    = (a_high_watermark > 0 && a_high_watermark <= 100) ? a_high_watermark
+                                                        : 100;
+  ap_trans->jb_low_watermark_
+    = MIN (a_low_watermark, ap_trans->jb_high_watermark_);
+  reset_initial_buffer_size (ap_trans);
+}
+
+void
+tiz_urltrans_get_buffer_status (const tiz_urltrans_t * ap_trans,
+                                tiz_urltrans_buffer_status_t * ap_status)
+{
+  assert (ap_trans);
+  assert (ap_status);
+  ap_status->capacity = jb_pause_level (ap_trans);
+  ap_status->fill
+    = ap_trans->p_store_ ? tiz_buffer_available (ap_trans->p_store_) : 0;
+  ap_status->target = ap_trans->jb_target_;
+  ap_status->underruns = ap_trans->jb_underruns_;
+  ap_status->buffering = (ap_trans->internal_buffer_size_initial_ > 0);
 }
 
 OMX_ERRORTYPE
@@ -1183,14 +2176,34 @@ tiz_urltrans_start (tiz_urltrans_t * ap_trans)
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (ap_trans);
   URLTRANS_LOG_API_START (ap_trans);
-  if (is_transfer_stopped (ap_trans) || is_transfer_paused (ap_trans))
+  if (is_transfer_stopped (ap_trans)
+      && ETIZUrlCacheTypeNone != ap_trans->cache_type_
+      && start_replay (ap_trans))
+    {
+      /* The resource is served from the cache */
+    }
+  else if (!ap_trans->p_replay_
+           && (is_transfer_stopped (ap_trans) || is_transfer_paused (ap_trans)))
     {
       int running_handles = 0;
+      ap_trans->jb_last_arrival_ = 0;
+      if (ap_trans->p_prefetch_key_
+          && 0 == strcmp (ap_trans->p_prefetch_key_, get_cache_key (ap_trans)))
+        {
+          /* This transfer caches the resource itself */
+          cancel_prefetch (ap_trans);
+        }
       tiz_check_omx (start_curl (ap_trans));
       assert (ap_trans->p_curl_multi_);
       ap_trans->handshake_error_found = false;
       /* Kickstart curl to get one or more callbacks called. */
       tiz_check_omx (kickstart_curl_socket (ap_trans, &running_handles));
+      if (check_multi_info (ap_trans))
+        {
+          /* A short resource on a reused connection may be complete
+             already */
+          report_connection_lost_event (ap_trans);
+        }
     }
   URLTRANS_LOG_API_END (ap_trans);
   ASSERT_ASYNC_EVENTS (ap_trans);
@@ -1205,7 +2218,9 @@ tiz_urltrans_pause (tiz_urltrans_t * ap_trans)
   URLTRANS_LOG_API_START (ap_trans);
   tiz_check_omx (stop_io_watcher (ap_trans));
   tiz_check_omx (stop_curl_timer_watcher (ap_trans));
+  tiz_check_omx (stop_replay_timer_watcher (ap_trans));
   rc = stop_reconnect_timer_watcher (ap_trans);
+  ap_trans->jb_last_arrival_ = 0;
   URLTRANS_LOG_API_END (ap_trans);
   return rc;
 }
@@ -1217,8 +2232,19 @@ tiz_urltrans_unpause (tiz_urltrans_t * ap_trans)
   int running_handles = 0;
   assert (ap_trans);
   URLTRANS_LOG_API_START (ap_trans);
-  tiz_check_omx (restart_curl_timer_watcher (ap_trans));
-  tiz_check_omx (kickstart_curl_socket (ap_trans, &running_handles));
+  ap_trans->jb_last_arrival_ = 0;
+  if (ap_trans->p_replay_)
+    {
+      if (is_transfer_running (ap_trans))
+        {
+          tiz_check_omx (start_replay_timer_watcher (ap_trans));
+        }
+    }
+  else
+    {
+      tiz_check_omx (restart_curl_timer_watcher (ap_trans));
+      tiz_check_omx (kickstart_curl_socket (ap_trans, &running_handles));
+    }
   URLTRANS_LOG_API_END (ap_trans);
   ASSERT_ASYNC_EVENTS (ap_trans);
   return rc;
@@ -1235,6 +2261,7 @@ tiz_urltrans_cancel (tiz_urltrans_t * ap_trans)
     {
       curl_multi_remove_handle (ap_trans->p_curl_multi_, ap_trans->p_curl_);
     }
+  reset_resource_state (ap_trans);
   ap_trans->sockfd_ = -1;
   ap_trans->awaiting_io_ev_ = false;
   ap_trans->awaiting_curl_timer_ev_ = false;
@@ -1260,11 +2287,19 @@ tiz_urltrans_on_buffers_ready (tiz_urltrans_t * ap_trans)
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (ap_trans);
   URLTRANS_LOG_API_START (ap_trans);
-  rc = send_from_internal_buffer (ap_trans);
+  if (ap_trans->jb_enabled_ && is_transfer_running (ap_trans)
+      && !ap_trans->p_replay_ && 0 == ap_trans->internal_buffer_size_initial_
+      && 0 == tiz_buffer_available (ap_trans->p_store_)
+      && ap_trans->buffer_cbacks_.pf_buf_emptied (ap_trans->p_parent_))
+    {
+      /* There are buffers waiting and no data to put in them */
+      jb_on_underrun (ap_trans);
+    }
+  rc = deliver_from_internal_buffer (ap_trans);
   if (is_transfer_paused (ap_trans))
     {
       if (tiz_buffer_available (ap_trans->p_store_)
-          <= ap_trans->internal_buffer_size_)
+          <= jb_pause_level (ap_trans))
         {
           rc = resume_curl (ap_trans);
         }
@@ -1276,6 +2311,21 @@ tiz_urltrans_on_buffers_ready (tiz_urltrans_t * ap_trans)
   return rc;
 }
 
+static inline int
+to_curl_select_bitmask (const int a_events)
+{
+  int curl_ev_bitmask = 0;
+  if (TIZ_EVENT_READ == a_events || TIZ_EVENT_READ_OR_WRITE == a_events)
+    {
+      curl_ev_bitmask |= CURL_CSELECT_IN;
+    }
+  if (TIZ_EVENT_WRITE == a_events || TIZ_EVENT_READ_OR_WRITE == a_events)
+    {
+      curl_ev_bitmask |= CURL_CSELECT_OUT;
+    }
+  return curl_ev_bitmask;
+}
+
 OMX_ERRORTYPE
 tiz_urltrans_on_io_ready (tiz_urltrans_t * ap_trans, tiz_event_io_t * ap_ev_io,
                           int a_fd, int a_events)
@@ -1286,15 +2336,7 @@ tiz_urltrans_on_io_ready (tiz_urltrans_t * ap_trans, tiz_event_io_t * ap_ev_io,
   if (a_fd == ap_trans->sockfd_)
     {
       int running_handles = 0;
-      int curl_ev_bitmask = 0;
-      if (TIZ_EVENT_READ == a_events || TIZ_EVENT_READ_OR_WRITE == a_events)
-        {
-          curl_ev_bitmask |= CURL_CSELECT_IN;
-        }
-      if (TIZ_EVENT_WRITE == a_events || TIZ_EVENT_READ_OR_WRITE == a_events)
-        {
-          curl_ev_bitmask |= CURL_CSELECT_OUT;
-        }
+      const int curl_ev_bitmask = to_curl_select_bitmask (a_events);
 
       do
         {
@@ -1302,9 +2344,9 @@ tiz_urltrans_on_io_ready (tiz_urltrans_t * ap_trans, tiz_event_io_t * ap_ev_io,
             ap_trans->p_curl_multi_, ap_trans->sockfd_, curl_ev_bitmask,
             &running_handles));
         }
-      while (0 == ap_trans->curl_timeout_);
+      while (0 == ap_trans->curl_timeout_ && running_handles > 0);
 
-      if (!running_handles)
+      if (check_multi_info (ap_trans))
         {
           report_connection_lost_event (ap_trans);
         }
@@ -1316,10 +2358,34 @@ tiz_urltrans_on_io_ready (tiz_urltrans_t * ap_trans, tiz_event_io_t * ap_ev_io,
                 {
                   tiz_check_omx (restart_io_watcher (ap_trans));
                 }
-              send_from_internal_buffer (ap_trans);
+              deliver_from_internal_buffer (ap_trans);
             }
         }
     }
+  else if (ap_trans->p_prefetch_curl_ && a_fd == ap_trans->prefetch_sockfd_)
+    {
+      int running_handles = 0;
+      const int curl_ev_bitmask = to_curl_select_bitmask (a_events);
+
+      do
+        {
+          on_curl_multi_error_ret_omx_oom (curl_multi_socket_action (
+            ap_trans->p_curl_multi_, ap_trans->prefetch_sockfd_,
+            curl_ev_bitmask, &running_handles));
+        }
+      while (0 == ap_trans->curl_timeout_ && running_handles > 0);
+
+      if (check_multi_info (ap_trans))
+        {
+          report_connection_lost_event (ap_trans);
+        }
+
+      if (ap_trans->p_prefetch_curl_ && ap_trans->p_ev_prefetch_io_)
+        {
+          tiz_check_omx (ap_trans->io_cbacks_.pf_io_start (
+            ap_trans->p_parent_, ap_trans->p_ev_prefetch_io_));
+        }
+    }
   URLTRANS_LOG_API_END (ap_trans);
   ASSERT_ASYNC_EVENTS (ap_trans);
   return rc;
@@ -1336,11 +2402,13 @@ tiz_urltrans_on_timer_ready (tiz_urltrans_t * ap_trans,
   if (ap_trans->awaiting_curl_timer_ev_
       && ap_ev_timer == ap_trans->p_ev_curl_timer_)
     {
-      if (is_transfer_running (ap_trans))
+      /* The timer belongs to the multi handle, which may be serving a
+         prefetch only */
+      if (is_transfer_running (ap_trans) || ap_trans->p_prefetch_curl_)
         {
           tiz_check_omx (
             kickstart_curl_socket (ap_trans, &running_handles));
-          if (!running_handles)
+          if (check_multi_info (ap_trans))
             {
               report_connection_lost_event (ap_trans);
             }
@@ -1348,11 +2416,17 @@ tiz_urltrans_on_timer_ready (tiz_urltrans_t * ap_trans,
             {
               if (is_transfer_running (ap_trans))
                 {
-                  send_from_internal_buffer (ap_trans);
+                  deliver_from_internal_buffer (ap_trans);
                 }
             }
         }
     }
+  else if (ap_trans->awaiting_replay_timer_ev_
+           && ap_ev_timer == ap_trans->p_ev_replay_timer_)
+    {
+      ap_trans->awaiting_replay_timer_ev_ = false;
+      rc = replay_from_cache (ap_trans);
+    }
   else if (ap_trans->awaiting_reconnect_timer_ev_
            && ap_ev_timer == ap_trans->p_ev_reconnect_timer_)
     {
@@ -40,6 +40,16 @@ extern "C" {
  * A URL file transfer API (based on libcurl) to be used in Tizonia processor
  * objects that need to access files over HTTP or FILE protocols.
  *
+ * Resources of known length that are interrupted are resumed with a byte
+ * range request. Optionally (see the '<component>.cache' key in tizonia.conf),
+ * finite resources are stored in a tiz_urlcache and served from it the next
+ * time they are requested.
+ *
+ * The internal buffer works as a jitter buffer: data is only handed out once
+ * it holds a target amount (pre-roll), and after running dry it pre-rolls
+ * again. The target follows the variation measured in the arrival of the
+ * data, and grows after underruns.
+ *
  * @ingroup libtizplatform
  */
 
@@ -148,6 +158,27 @@ struct tiz_urltrans_info_cbacks
   tiz_urltrans_connection_lost_f pf_connection_lost;
 };
 
+/**
+ * @brief Jitter buffer status (typedef).
+ * @ingroup tizurltransfer
+ */
+typedef struct tiz_urltrans_buffer_status tiz_urltrans_buffer_status_t;
+
+/**
+ * @brief Jitter buffer status.
+ *
+ * A snapshot of the internal buffer, see tiz_urltrans_get_buffer_status.
+ * @ingroup tizurltransfer
+ */
+struct tiz_urltrans_buffer_status
+{
+  int capacity;           /**< Bytes held before the transfer is paused. */
+  int fill;               /**< Bytes held now. */
+  int target;             /**< Bytes held before data is handed out. */
+  unsigned int underruns; /**< Times the buffer has run dry. */
+  bool buffering;         /**< True while pre-rolling. */
+};
+
 /**
  * @brief IO watcher init function (same as in tizservant.h).
  * @ingroup tizurltransfer
@@ -299,6 +330,37 @@ void
 tiz_urltrans_set_uri (tiz_urltrans_t * ap_trans,
                       OMX_PARAM_CONTENTURITYPE * ap_uri_param);
 
+/**
+ * Set the key under which the contents of the current URL are cached. By
+ * default, the URL itself is the key; this is useful when the URL of a
+ * resource changes every time it is obtained (e.g. because it carries an
+ * access token). The key is reset by tiz_urltrans_set_uri.
+ *
+ * @param ap_trans The URL file transfer object.
+ *
+ * @param ap_key The key, or NULL to use the URL.
+ */
+void
+tiz_urltrans_set_cache_key (tiz_urltrans_t * ap_trans, const char * ap_key);
+
+/**
+ * Download a URL into the cache in the background, on the same connection
+ * pool as the main transfer. Only one prefetch is active at any time; a new
+ * one replaces the previous. This does nothing if the cache is disabled or
+ * the key is already cached.
+ *
+ * @param ap_trans The URL file transfer object.
+ *
+ * @param ap_url The URL to prefetch.
+ *
+ * @param ap_key The cache key, or NULL to use the URL.
+ *
+ * @return OMX_ErrorNone if success, OMX_ErrorInsufficientResources otherwise.
+ */
+OMX_ERRORTYPE
+tiz_urltrans_prefetch (tiz_urltrans_t * ap_trans, const char * ap_url,
+                       const char * ap_key);
+
 void
 tiz_urltrans_set_connect_timeout (tiz_urltrans_t * ap_trans,
                                   const long a_connect_timeout);
@@ -307,6 +369,38 @@ void
 tiz_urltrans_set_internal_buffer_size (tiz_urltrans_t * ap_trans,
                                        const int a_nbytes);
 
+/**
+ * Configure the jitter buffer. The internal buffer size is its capacity.
+ *
+ * @param ap_trans The URL file transfer object.
+ *
+ * @param a_byte_rate The rate at which the data is consumed (e.g. the
+ * stream's bitrate), used to turn the measured jitter into a number of
+ * bytes; 0 if unknown.
+ *
+ * @param a_low_watermark The minimum pre-roll level, as a percentage of the
+ * capacity.
+ *
+ * @param a_high_watermark The fill level at which the transfer is paused, as
+ * a percentage of the capacity.
+ */
+void
+tiz_urltrans_set_streaming_buffer (tiz_urltrans_t * ap_trans,
+                                   const int a_byte_rate,
+                                   const OMX_U32 a_low_watermark,
+                                   const OMX_U32 a_high_watermark);
+
+/**
+ * Retrieve the current status of the jitter buffer.
+ *
+ * @param ap_trans The URL file transfer object.
+ *
+ * @param ap_status The status.
+ */
+void
+tiz_urltrans_get_buffer_status (const tiz_urltrans_t * ap_trans,
+                                tiz_urltrans_buffer_status_t * ap_status);
+
 OMX_ERRORTYPE
 tiz_urltrans_start (tiz_urltrans_t * ap_trans);
 
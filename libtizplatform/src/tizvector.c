@@ -45,6 +45,9 @@ struct tiz_vector
 {
   UT_array * p_uta;
   UT_icd * p_icd;
+  /* Both live in the vector struct, which is a single slab allocation */
+  UT_array uta;
+  UT_icd icd;
 };
 
 OMX_ERRORTYPE
@@ -56,19 +59,15 @@ tiz_vector_init (tiz_vector_t ** app_vector, size_t a_elem_size)
   assert (a_elem_size > 0);
 
   if (NULL
-      == (p_vec = (tiz_vector_t *) tiz_mem_calloc (1, sizeof (tiz_vector_t))))
+      == (p_vec = (tiz_vector_t *) tiz_slab_calloc (sizeof (tiz_vector_t))))
     {
       return OMX_ErrorInsufficientResources;
     }
 
-  if (NULL == (p_vec->p_icd = (UT_icd *) tiz_mem_calloc (1, sizeof (UT_icd))))
-    {
-      tiz_mem_free (p_vec);
-      return OMX_ErrorInsufficientResources;
-    }
-
+  p_vec->p_icd = &(p_vec->icd);
   p_vec->p_icd->sz = a_elem_size;
-  utarray_new (p_vec->p_uta, p_vec->p_icd);
+  p_vec->p_uta = &(p_vec->uta);
+  utarray_init (p_vec->p_uta, p_vec->p_icd);
   *app_vector = p_vec;
 
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Initializing vector [%p] with elem size [%d]",
@@ -83,9 +82,8 @@ tiz_vector_destroy (tiz_vector_t * p_vec)
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Destroying vector [%p]", p_vec);
   if (p_vec)
     {
-      utarray_free (p_vec->p_uta);
-      tiz_mem_free (p_vec->p_icd);
-      tiz_mem_free (p_vec);
+      utarray_done (p_vec->p_uta);
+      tiz_slab_free (p_vec);
     }
 }
 
@@ -0,0 +1,134 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_buffer.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Buffer API unit tests
+ *
+ *
+ */
+
+#define BUFFER_TEST_CHUNK 1000
+#define BUFFER_TEST_ITERATIONS 100
+
+static void
+check_buffer_fifo (const tiz_buffer_type_t a_type)
+{
+  tiz_buffer_t * p_buf = NULL;
+  unsigned char chunk[BUFFER_TEST_CHUNK];
+  unsigned char next_in = 0;
+  unsigned char next_out = 0;
+  int i = 0;
+  int j = 0;
+
+  fail_if (OMX_ErrorNone != tiz_buffer_init_with_type (&p_buf, 4096, a_type));
+
+  /* Keep roughly half the store filled, so that a ring wraps many times */
+  for (i = 0; i < BUFFER_TEST_ITERATIONS; ++i)
+    {
+      unsigned char * p_data = NULL;
+      int avail = 0;
+
+      for (j = 0; j < BUFFER_TEST_CHUNK; ++j)
+        {
+          chunk[j] = next_in++;
+        }
+      fail_if (BUFFER_TEST_CHUNK
+               != tiz_buffer_push (p_buf, chunk, BUFFER_TEST_CHUNK));
+
+      /* Consume a bit less than what was produced, and check that the data
+         available is contiguous and in order */
+      avail = tiz_buffer_available (p_buf);
+      p_data = tiz_buffer_get (p_buf);
+      for (j = 0; j < avail; ++j)
+        {
+          fail_if (p_data[j] != (unsigned char) (next_out + j));
+        }
+      fail_if ((BUFFER_TEST_CHUNK - 10)
+               != tiz_buffer_advance (p_buf, BUFFER_TEST_CHUNK - 10));
+      next_out += BUFFER_TEST_CHUNK - 10;
+    }
+
+  fail_if (BUFFER_TEST_ITERATIONS * 10 != tiz_buffer_available (p_buf));
+  tiz_buffer_destroy (p_buf);
+}
+
+START_TEST (test_buffer_heap_fifo)
+{
+  check_buffer_fifo (ETIZBufferTypeHeap);
+}
+END_TEST
+
+START_TEST (test_buffer_ring_fifo)
+{
+  check_buffer_fifo (ETIZBufferTypeRing);
+}
+END_TEST
+
+START_TEST (test_buffer_ring_reserve_commit_peek)
+{
+  tiz_buffer_t * p_buf = NULL;
+  unsigned char * p_space = NULL;
+  void * p_span = NULL;
+  int i = 0;
+
+  fail_if (OMX_ErrorNone
+           != tiz_buffer_init_with_type (&p_buf, 100, ETIZBufferTypeRing));
+
+  /* A ring does not keep consumed data */
+  if (ETIZBufferTypeRing == tiz_buffer_type (p_buf))
+    {
+      fail_if (-1 != tiz_buffer_seek_mode (p_buf, TIZ_BUFFER_SEEKABLE));
+    }
+
+  /* Write in place */
+  fail_if (NULL == (p_space = tiz_buffer_reserve (p_buf, 256)));
+  for (i = 0; i < 256; ++i)
+    {
+      p_space[i] = i;
+    }
+  fail_if (0 != tiz_buffer_available (p_buf));
+  fail_if (256 != tiz_buffer_commit (p_buf, 256));
+  fail_if (256 != tiz_buffer_available (p_buf));
+
+  /* Look without consuming */
+  fail_if (56 != tiz_buffer_peek (p_buf, 200, &p_span));
+  fail_if (200 != *((unsigned char *) p_span));
+  fail_if (0 != tiz_buffer_peek (p_buf, 256, &p_span));
+  fail_if (256 != tiz_buffer_available (p_buf));
+
+  /* Grow the store while there is data in it */
+  fail_if (128 != tiz_buffer_advance (p_buf, 128));
+  fail_if (NULL == (p_space = tiz_buffer_reserve (p_buf, 64 * 1024)));
+  fail_if (64 * 1024 != tiz_buffer_commit (p_buf, 64 * 1024));
+  fail_if (128 + 64 * 1024 != tiz_buffer_available (p_buf));
+  fail_if (128 != *((unsigned char *) tiz_buffer_get (p_buf)));
+
+  tiz_buffer_destroy (p_buf);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
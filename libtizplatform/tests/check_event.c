@@ -35,6 +35,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
 
 #define CHECK_IO_SERV_PORT 9877
 #define CHECK_IO_MAXLINE 4096
@@ -53,6 +54,8 @@ static int g_timeout_count = 5;
 static int g_restart_count = 2;
 static bool g_timer_restarted = false;
 static bool g_file_status_changed = false;
+static int g_bound_timer_count = 0;
+static pthread_t g_bound_timer_thread;
 
 static void
 check_event_io_cback (OMX_HANDLETYPE p_hdl, tiz_event_io_t * ap_ev_io, void *ap_arg1,
@@ -166,6 +169,16 @@ check_event_stat_cback (OMX_HANDLETYPE p_hdl, tiz_event_stat_t * ap_ev_stat,
   fail_if (OMX_ErrorNone != error);
 }
 
+static void
+check_event_bound_timer_cback (OMX_HANDLETYPE p_hdl,
+                               tiz_event_timer_t * ap_ev_timer, void *ap_arg,
+                               const uint32_t a_id)
+{
+  fail_if (NULL == ap_ev_timer);
+  g_bound_timer_thread = pthread_self ();
+  ++g_bound_timer_count;
+}
+
 /* TESTS */
 
 START_TEST (test_event_loop_init_and_destroy)
@@ -182,6 +195,108 @@ START_TEST (test_event_loop_init_and_destroy)
 }
 END_TEST
 
+START_TEST (test_event_loop_bound)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  tiz_event_loop_t * p_lp = NULL;
+  tiz_event_timer_t * p_ev_timer = NULL;
+  int affinity = 0;
+  int i = 0;
+
+  error = tiz_event_loop_init ();
+  fail_if (error != OMX_ErrorNone);
+
+  error = tiz_event_loop_bind (&affinity, &p_lp);
+  fail_if (error != OMX_ErrorNone);
+  fail_if (NULL == p_lp);
+
+  /* This watcher is served by the bound loop, i.e. by this thread */
+  error = tiz_event_timer_init (&p_ev_timer, &affinity,
+                                check_event_bound_timer_cback, NULL);
+  fail_if (error != OMX_ErrorNone);
+
+  tiz_event_timer_set (p_ev_timer, 0.05, 0.05);
+
+  error = tiz_event_timer_start (p_ev_timer, 1);
+  fail_if (error != OMX_ErrorNone);
+
+  while (g_bound_timer_count < 3 && ++i < 100)
+    {
+      tiz_event_loop_run_once (p_lp);
+    }
+
+  fail_if (g_bound_timer_count < 3);
+  fail_if (!pthread_equal (g_bound_timer_thread, pthread_self ()));
+
+  /* An explicit wake-up makes run_once return */
+  error = tiz_event_timer_stop (p_ev_timer);
+  fail_if (error != OMX_ErrorNone);
+  tiz_event_loop_wakeup (p_lp);
+  tiz_event_loop_run_once (p_lp);
+
+  tiz_event_timer_destroy (p_ev_timer);
+  tiz_event_loop_unbind (p_lp);
+
+  tiz_event_loop_destroy ();
+}
+END_TEST
+
+START_TEST (test_event_loop_batch)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  tiz_event_loop_t * p_lp = NULL;
+  tiz_event_timer_t * p_ev_timer = NULL;
+  int affinity = 0;
+  int i = 0;
+
+  g_bound_timer_count = 0;
+
+  error = tiz_event_loop_init ();
+  fail_if (error != OMX_ErrorNone);
+
+  error = tiz_event_loop_bind (&affinity, &p_lp);
+  fail_if (error != OMX_ErrorNone);
+
+  error = tiz_event_timer_init (&p_ev_timer, &affinity,
+                                check_event_bound_timer_cback, NULL);
+  fail_if (error != OMX_ErrorNone);
+
+  tiz_event_timer_set (p_ev_timer, 0.01, 0.);
+
+  /* Start, stop and start again: only the last start must survive */
+  tiz_event_loop_batch_begin ();
+  fail_if (OMX_ErrorNone != tiz_event_timer_start (p_ev_timer, 1));
+  fail_if (OMX_ErrorNone != tiz_event_timer_stop (p_ev_timer));
+  fail_if (OMX_ErrorNone != tiz_event_timer_start (p_ev_timer, 2));
+  error = tiz_event_loop_batch_commit ();
+  fail_if (error != OMX_ErrorNone);
+
+  while (g_bound_timer_count < 1 && ++i < 100)
+    {
+      tiz_event_loop_run_once (p_lp);
+    }
+  fail_if (1 != g_bound_timer_count);
+
+  /* Start and stop: the timer must never fire */
+  tiz_event_loop_batch_begin ();
+  fail_if (OMX_ErrorNone != tiz_event_timer_start (p_ev_timer, 3));
+  fail_if (OMX_ErrorNone != tiz_event_timer_stop (p_ev_timer));
+  error = tiz_event_loop_batch_commit ();
+  fail_if (error != OMX_ErrorNone);
+
+  tiz_event_loop_run_once (p_lp);
+  tiz_sleep (50000);
+  tiz_event_loop_wakeup (p_lp);
+  tiz_event_loop_run_once (p_lp);
+  fail_if (1 != g_bound_timer_count);
+
+  tiz_event_timer_destroy (p_ev_timer);
+  tiz_event_loop_unbind (p_lp);
+
+  tiz_event_loop_destroy ();
+}
+END_TEST
+
 START_TEST (test_event_io)
 {
   OMX_ERRORTYPE error = OMX_ErrorNone;
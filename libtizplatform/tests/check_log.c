@@ -0,0 +1,323 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_log.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Logging unit tests
+ *
+ * The messages are captured by an appender attached to a test category, so
+ * these tests do not depend on the log4crc in use.
+ *
+ */
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <string.h>
+
+#define CHECK_LOG_CATEGORY "tiz.platform.check.log"
+#define CHECK_LOG_MAX_MSGS 2048
+#define CHECK_LOG_RECORDS 1000
+#define CHECK_LOG_LARGE_LEN 400
+
+static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char * gp_log_msgs[CHECK_LOG_MAX_MSGS];
+static int g_log_nmsgs = 0;
+
+static int
+check_log_appender_open (log4c_appender_t * ap_appender)
+{
+  return 0;
+}
+
+static int
+check_log_appender_append (log4c_appender_t * ap_appender,
+                           const log4c_logging_event_t * ap_event)
+{
+  pthread_mutex_lock (&g_log_mutex);
+  if (g_log_nmsgs < CHECK_LOG_MAX_MSGS)
+    {
+      gp_log_msgs[g_log_nmsgs++] = strdup (ap_event->evt_msg);
+    }
+  pthread_mutex_unlock (&g_log_mutex);
+  return 0;
+}
+
+static int
+check_log_appender_close (log4c_appender_t * ap_appender)
+{
+  return 0;
+}
+
+static const log4c_appender_type_t check_log_appender_type = {
+  "tiz_check_appender", check_log_appender_open, check_log_appender_append,
+  check_log_appender_close,
+};
+
+/* To be called after each tiz_log_init, as log4c_fini drops the categories
+   and the appenders */
+static void
+check_log_capture (const int a_priority)
+{
+  log4c_category_t * p_cat = log4c_category_get (CHECK_LOG_CATEGORY);
+  log4c_appender_t * p_app = log4c_appender_get ("tiz_check_appender");
+  fail_if (NULL == p_cat);
+  fail_if (NULL == p_app);
+  (void) log4c_appender_type_set (&check_log_appender_type);
+  (void) log4c_appender_set_type (p_app, &check_log_appender_type);
+  (void) log4c_category_set_appender (p_cat, p_app);
+  (void) log4c_category_set_additivity (p_cat, 0);
+  (void) log4c_category_set_priority (p_cat, a_priority);
+}
+
+static int
+check_log_count (void)
+{
+  int count = 0;
+  pthread_mutex_lock (&g_log_mutex);
+  count = g_log_nmsgs;
+  pthread_mutex_unlock (&g_log_mutex);
+  return count;
+}
+
+static void
+check_log_clear (void)
+{
+  int i = 0;
+  pthread_mutex_lock (&g_log_mutex);
+  for (i = 0; i < g_log_nmsgs; ++i)
+    {
+      free (gp_log_msgs[i]);
+      gp_log_msgs[i] = NULL;
+    }
+  g_log_nmsgs = 0;
+  pthread_mutex_unlock (&g_log_mutex);
+}
+
+/* A single call site, so that every call goes through the same cached
+   site */
+static void
+check_log_site (const int a_value)
+{
+  TIZ_LOG_AT (TIZ_PRIORITY_TRACE, CHECK_LOG_CATEGORY, NULL, NULL, "site %d",
+              a_value);
+}
+
+static void
+check_log_record (const char * ap_tag, const int a_seq)
+{
+  TIZ_LOG_AT (TIZ_PRIORITY_TRACE, CHECK_LOG_CATEGORY, NULL, NULL, "%s %d",
+              ap_tag, a_seq);
+}
+
+static void *
+check_log_thread_func (void * ap_arg)
+{
+  int i = 0;
+  for (i = 0; i < CHECK_LOG_RECORDS; ++i)
+    {
+      check_log_record ("thread", i);
+    }
+  return NULL;
+}
+
+/* Checks that the messages with the given tag are all there, in order */
+static void
+check_log_sequence (const char * ap_tag, const int a_count)
+{
+  char expected[64];
+  int next = 0;
+  int i = 0;
+  const size_t tag_len = strlen (ap_tag);
+
+  pthread_mutex_lock (&g_log_mutex);
+  for (i = 0; i < g_log_nmsgs; ++i)
+    {
+      if (0 == strncmp (gp_log_msgs[i], ap_tag, tag_len)
+          && ' ' == gp_log_msgs[i][tag_len])
+        {
+          snprintf (expected, sizeof (expected), "%s %d", ap_tag, next++);
+          fail_if (0 != strcmp (expected, gp_log_msgs[i]));
+        }
+    }
+  pthread_mutex_unlock (&g_log_mutex);
+  fail_if (a_count != next);
+}
+
+START_TEST (test_log_site_cache_invalidation)
+{
+  /* Start from a known configuration */
+  (void) tiz_log_deinit ();
+  unsetenv ("TIZONIA_LOG_ASYNC");
+  fail_if (0 != tiz_log_init ());
+  check_log_capture (LOG4C_PRIORITY_ERROR);
+
+  /* The site caches the category's priority when first used... */
+  check_log_site (1);
+  fail_if (0 != check_log_count ());
+
+  /* ... and keeps it until the next tiz_log_init or tiz_log_deinit */
+  (void) log4c_category_set_priority (log4c_category_get (CHECK_LOG_CATEGORY),
+                                      LOG4C_PRIORITY_TRACE);
+  check_log_site (2);
+  fail_if (0 != check_log_count ());
+
+  /* A re-initialisation makes the site resolve its category again */
+  (void) tiz_log_deinit ();
+  fail_if (0 != tiz_log_init ());
+  check_log_capture (LOG4C_PRIORITY_TRACE);
+  check_log_site (3);
+  fail_if (1 != check_log_count ());
+  fail_if (0 != strcmp ("site 3", gp_log_msgs[0]));
+
+  /* Also when the new priority is lower than the cached one */
+  (void) tiz_log_deinit ();
+  fail_if (0 != tiz_log_init ());
+  check_log_capture (LOG4C_PRIORITY_ERROR);
+  check_log_site (4);
+  fail_if (1 != check_log_count ());
+
+  check_log_clear ();
+}
+END_TEST
+
+START_TEST (test_log_async)
+{
+  pthread_t thread;
+  char * p_large = NULL;
+  int i = 0;
+
+  (void) tiz_log_deinit ();
+  setenv ("TIZONIA_LOG_ASYNC", "1", 1);
+  fail_if (0 != tiz_log_init ());
+  check_log_capture (LOG4C_PRIORITY_TRACE);
+
+  /* A second thread logs through its own ring */
+  fail_if (0 != pthread_create (&thread, NULL, check_log_thread_func, NULL));
+
+  /* More records than a ring can hold, so that this thread also has to wait
+     for the writer */
+  for (i = 0; i < CHECK_LOG_RECORDS / 2; ++i)
+    {
+      check_log_record ("main", i);
+    }
+
+  /* Too large for a record: it is written synchronously, but only after the
+     records queued before it */
+  p_large = tiz_mem_alloc (CHECK_LOG_LARGE_LEN + 1);
+  fail_if (NULL == p_large);
+  memset (p_large, 'x', CHECK_LOG_LARGE_LEN);
+  p_large[CHECK_LOG_LARGE_LEN] = '\0';
+  check_log_record (p_large, 0);
+
+  for (i = CHECK_LOG_RECORDS / 2; i < CHECK_LOG_RECORDS; ++i)
+    {
+      check_log_record ("main", i);
+    }
+
+  fail_if (0 != pthread_join (thread, NULL));
+
+  /* Stopping the writer flushes whatever is still queued */
+  fail_if (0 != tiz_log_deinit ());
+  fail_if (2 * CHECK_LOG_RECORDS + 1 != check_log_count ());
+
+  check_log_sequence ("main", CHECK_LOG_RECORDS);
+  check_log_sequence ("thread", CHECK_LOG_RECORDS);
+
+  /* The large record sits between the two halves of this thread's ones */
+  {
+    int large_pos = -1;
+    int last_before = -1;
+    int first_after = -1;
+    char expected[64];
+    pthread_mutex_lock (&g_log_mutex);
+    for (i = 0; i < g_log_nmsgs; ++i)
+      {
+        if ('x' == gp_log_msgs[i][0])
+          {
+            fail_if (CHECK_LOG_LARGE_LEN + 2 != strlen (gp_log_msgs[i]));
+            large_pos = i;
+          }
+        snprintf (expected, sizeof (expected), "main %d",
+                  CHECK_LOG_RECORDS / 2 - 1);
+        if (0 == strcmp (expected, gp_log_msgs[i]))
+          {
+            last_before = i;
+          }
+        snprintf (expected, sizeof (expected), "main %d",
+                  CHECK_LOG_RECORDS / 2);
+        if (0 == strcmp (expected, gp_log_msgs[i]))
+          {
+            first_after = i;
+          }
+      }
+    pthread_mutex_unlock (&g_log_mutex);
+    fail_if (large_pos < 0);
+    fail_if (last_before > large_pos);
+    fail_if (first_after < large_pos);
+  }
+
+  tiz_mem_free (p_large);
+  check_log_clear ();
+
+  unsetenv ("TIZONIA_LOG_ASYNC");
+  fail_if (0 != tiz_log_init ());
+}
+END_TEST
+
+START_TEST (test_log_module_unload)
+{
+  void * p_module = NULL;
+  void (*pf_log) (const char *, const int) = NULL;
+  int i = 0;
+
+  (void) tiz_log_deinit ();
+  setenv ("TIZONIA_LOG_ASYNC", "1", 1);
+  fail_if (0 != tiz_log_init ());
+  check_log_capture (LOG4C_PRIORITY_TRACE);
+
+  p_module = dlopen (CHECK_LOG_MODULE, RTLD_NOW | RTLD_LOCAL);
+  fail_if (NULL == p_module);
+  *(void **) (&pf_log) = dlsym (p_module, "check_log_module_log");
+  fail_if (NULL == pf_log);
+
+  /* The queued records point to the module's strings... */
+  for (i = 0; i < CHECK_LOG_RECORDS; ++i)
+    {
+      pf_log ("module", i);
+    }
+
+  /* ... so they must have been written before it is unloaded */
+  tiz_log_flush ();
+  fail_if (CHECK_LOG_RECORDS != check_log_count ());
+  fail_if (0 != dlclose (p_module));
+  check_log_sequence ("module", CHECK_LOG_RECORDS);
+
+  /* The module's call site is gone, and re-initialising must not touch it */
+  fail_if (0 != tiz_log_deinit ());
+  unsetenv ("TIZONIA_LOG_ASYNC");
+  fail_if (0 != tiz_log_init ());
+  check_log_capture (LOG4C_PRIORITY_TRACE);
+  check_log_site (5);
+  fail_if (CHECK_LOG_RECORDS + 1 != check_log_count ());
+
+  check_log_clear ();
+}
+END_TEST
@@ -0,0 +1,41 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_log_module.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  A loadable module that logs, for the logging unit tests
+ *
+ * check_log.c loads and unloads it, the way the IL Core does with the
+ * components.
+ *
+ */
+
+#include "../src/tizplatform.h"
+
+void
+check_log_module_log (const char * ap_tag, const int a_seq);
+
+void
+check_log_module_log (const char * ap_tag, const int a_seq)
+{
+  TIZ_LOG_AT (TIZ_PRIORITY_TRACE, "tiz.platform.check.log", NULL, NULL,
+              "%s %d", ap_tag, a_seq);
+}
@@ -0,0 +1,472 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_pcm.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  PCM processing kernels unit tests
+ *
+ *
+ */
+
+/* Not a multiple of any vector width, so that the tails are exercised */
+#define PCM_TEST_SAMPLES 1155
+#define PCM_BENCH_SAMPLES (4096 * 2)
+#define PCM_BENCH_ITERATIONS 2000
+#define PCM_TEST_PLANES 3
+#define PCM_TEST_PLANE_SAMPLES (PCM_TEST_SAMPLES / PCM_TEST_PLANES)
+
+static int32_t pcm_test_ref[PCM_TEST_SAMPLES];
+static int32_t pcm_test_out[PCM_TEST_SAMPLES];
+static int32_t pcm_test_fixed[PCM_TEST_PLANES][PCM_TEST_PLANE_SAMPLES];
+static float pcm_test_float[PCM_TEST_PLANES][PCM_TEST_PLANE_SAMPLES];
+
+static int32_t
+check_pcm_s24 (const uint8_t * ap_sample)
+{
+  const int32_t v = ap_sample[0] | (ap_sample[1] << 8) | (ap_sample[2] << 16);
+  return (v ^ 0x800000) - 0x800000;
+}
+
+static void
+check_pcm_fill (void * ap_buf, const tiz_pcm_format_t a_fmt,
+                const size_t a_nsamples)
+{
+  uint32_t seed = 12345;
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      int32_t v = 0;
+      seed = seed * 1103515245 + 12345;
+      v = (int32_t) seed;
+      switch (a_fmt)
+        {
+          case ETIZPcmFormatS16:
+            ((int16_t *) ap_buf)[i] = (int16_t) (v >> 16);
+            break;
+          case ETIZPcmFormatS24:
+            memcpy ((uint8_t *) ap_buf + i * 3, &v, 3);
+            break;
+          case ETIZPcmFormatS32:
+            ((int32_t *) ap_buf)[i] = v;
+            break;
+          case ETIZPcmFormatFloat:
+            ((float *) ap_buf)[i] = (float) v / 2147483648.f;
+            break;
+          default:
+            break;
+        };
+    }
+}
+
+/* Samples may differ by one unit (integer formats) or by a tiny fraction
+   (float) when a ramp's gain is rounded differently */
+static bool
+check_pcm_equal (const void * ap_a, const void * ap_b,
+                 const tiz_pcm_format_t a_fmt, const size_t a_nsamples,
+                 const bool a_exact)
+{
+  size_t i = 0;
+  for (i = 0; i < a_nsamples; ++i)
+    {
+      double a = 0;
+      double b = 0;
+      double tolerance = a_exact ? 0 : 1;
+      switch (a_fmt)
+        {
+          case ETIZPcmFormatS16:
+            a = ((const int16_t *) ap_a)[i];
+            b = ((const int16_t *) ap_b)[i];
+            break;
+          case ETIZPcmFormatS24:
+            a = check_pcm_s24 ((const uint8_t *) ap_a + i * 3);
+            b = check_pcm_s24 ((const uint8_t *) ap_b + i * 3);
+            break;
+          case ETIZPcmFormatS32:
+            a = ((const int32_t *) ap_a)[i];
+            b = ((const int32_t *) ap_b)[i];
+            /* A 24-bit gain applied to a 32-bit sample */
+            tolerance = a_exact ? 0 : 512;
+            break;
+          case ETIZPcmFormatFloat:
+            a = ((const float *) ap_a)[i];
+            b = ((const float *) ap_b)[i];
+            tolerance = a_exact ? 0 : 1e-6;
+            break;
+          default:
+            break;
+        };
+      if (fabs (a - b) > tolerance)
+        {
+          fprintf (stderr, "sample %zu : %f != %f\n", i, a, b);
+          return false;
+        }
+    }
+  return true;
+}
+
+static void
+check_pcm_isa (const tiz_pcm_isa_t a_isa)
+{
+  const size_t channels[] = {1, 2, 3, 4, 6, 8};
+  int fmt = 0;
+  size_t c = 0;
+
+  for (fmt = 0; fmt < ETIZPcmFormatMax; ++fmt)
+    {
+      /* Gain: amplify (with saturation) and attenuate */
+      check_pcm_fill (pcm_test_ref, fmt, PCM_TEST_SAMPLES);
+      fail_if (OMX_ErrorNone != tiz_pcm_set_isa (ETIZPcmIsaScalar));
+      tiz_pcm_gain (pcm_test_ref, PCM_TEST_SAMPLES, fmt, 3.5f);
+      tiz_pcm_gain (pcm_test_ref, PCM_TEST_SAMPLES, fmt, 0.25f);
+
+      check_pcm_fill (pcm_test_out, fmt, PCM_TEST_SAMPLES);
+      fail_if (OMX_ErrorNone != tiz_pcm_set_isa (a_isa));
+      tiz_pcm_gain (pcm_test_out, PCM_TEST_SAMPLES, fmt, 3.5f);
+      tiz_pcm_gain (pcm_test_out, PCM_TEST_SAMPLES, fmt, 0.25f);
+      fail_if (!check_pcm_equal (pcm_test_ref, pcm_test_out, fmt,
+                                 PCM_TEST_SAMPLES, true));
+
+      /* Ramps, in two halves */
+      for (c = 0; c < sizeof (channels) / sizeof (channels[0]); ++c)
+        {
+          const size_t frames = PCM_TEST_SAMPLES / channels[c];
+          const size_t half = frames / 2;
+          const size_t size = tiz_pcm_sample_size (fmt);
+
+          check_pcm_fill (pcm_test_ref, fmt, PCM_TEST_SAMPLES);
+          fail_if (OMX_ErrorNone != tiz_pcm_set_isa (ETIZPcmIsaScalar));
+          tiz_pcm_ramp (pcm_test_ref, half, channels[c], fmt, 0.f, 0.5f);
+          tiz_pcm_ramp ((uint8_t *) pcm_test_ref + half * channels[c] * size,
+                        frames - half, channels[c], fmt, 0.5f, 1.f);
+
+          check_pcm_fill (pcm_test_out, fmt, PCM_TEST_SAMPLES);
+          fail_if (OMX_ErrorNone != tiz_pcm_set_isa (a_isa));
+          tiz_pcm_ramp (pcm_test_out, half, channels[c], fmt, 0.f, 0.5f);
+          tiz_pcm_ramp ((uint8_t *) pcm_test_out + half * channels[c] * size,
+                        frames - half, channels[c], fmt, 0.5f, 1.f);
+          fail_if (!check_pcm_equal (pcm_test_ref, pcm_test_out, fmt,
+                                     frames * channels[c], false));
+        }
+    }
+
+  /* A byte swap is its own inverse */
+  for (c = 2; c <= 4; ++c)
+    {
+      check_pcm_fill (pcm_test_ref, ETIZPcmFormatS32, PCM_TEST_SAMPLES);
+      memcpy (pcm_test_out, pcm_test_ref, sizeof (pcm_test_out));
+      tiz_pcm_swap (pcm_test_out, PCM_TEST_SAMPLES, c);
+      fail_if (0 == memcmp (pcm_test_ref, pcm_test_out, PCM_TEST_SAMPLES * c));
+      fail_if (((uint8_t *) pcm_test_ref)[0]
+               != ((uint8_t *) pcm_test_out)[c - 1]);
+      fail_if (((uint8_t *) pcm_test_ref)[(PCM_TEST_SAMPLES - 1) * c]
+               != ((uint8_t *) pcm_test_out)[PCM_TEST_SAMPLES * c - 1]);
+      tiz_pcm_swap (pcm_test_out, PCM_TEST_SAMPLES, c);
+      fail_if (0 != memcmp (pcm_test_ref, pcm_test_out, sizeof (pcm_test_out)));
+    }
+}
+
+/* Fixed-point samples with a_fracbits fractional bits, some of them beyond
+   [-1.0, 1.0); float samples in [-1.5, 1.5] */
+static void
+check_pcm_fill_planes (const unsigned int a_fracbits)
+{
+  size_t p = 0;
+  size_t i = 0;
+  for (p = 0; p < PCM_TEST_PLANES; ++p)
+    {
+      check_pcm_fill (pcm_test_fixed[p], ETIZPcmFormatS32,
+                      PCM_TEST_PLANE_SAMPLES);
+      check_pcm_fill (pcm_test_float[p], ETIZPcmFormatFloat,
+                      PCM_TEST_PLANE_SAMPLES);
+      for (i = 0; i < PCM_TEST_PLANE_SAMPLES; ++i)
+        {
+          pcm_test_fixed[p][i] = (pcm_test_fixed[p][i] >> (31 - a_fracbits))
+                                 + (int32_t) (i * p);
+          pcm_test_float[p][i] *= 1.5f;
+        }
+    }
+}
+
+static void
+check_pcm_convert_isa (const tiz_pcm_isa_t a_isa)
+{
+  /* libmad's, 16-bit and 24-bit FLAC's, and a shift of one */
+  const unsigned int fracbits[] = {28, 15, 23, 16};
+  const int32_t * fixed[PCM_TEST_PLANES]
+    = {pcm_test_fixed[0], pcm_test_fixed[1], pcm_test_fixed[2]};
+  const float * flt[PCM_TEST_PLANES]
+    = {pcm_test_float[0], pcm_test_float[1], pcm_test_float[2]};
+  size_t f = 0;
+  size_t planes = 0;
+  int fmt = 0;
+
+  for (f = 0; f < sizeof (fracbits) / sizeof (fracbits[0]); ++f)
+    {
+      check_pcm_fill_planes (fracbits[f]);
+      for (planes = 1; planes <= PCM_TEST_PLANES; ++planes)
+        {
+          for (fmt = 0; fmt < ETIZPcmFormatMax; ++fmt)
+            {
+              fail_if (OMX_ErrorNone != tiz_pcm_set_isa (ETIZPcmIsaScalar));
+              tiz_pcm_from_fixed (pcm_test_ref, fmt, fixed, planes,
+                                  PCM_TEST_PLANE_SAMPLES, fracbits[f]);
+              fail_if (OMX_ErrorNone != tiz_pcm_set_isa (a_isa));
+              tiz_pcm_from_fixed (pcm_test_out, fmt, fixed, planes,
+                                  PCM_TEST_PLANE_SAMPLES, fracbits[f]);
+              fail_if (!check_pcm_equal (pcm_test_ref, pcm_test_out, fmt,
+                                         PCM_TEST_PLANE_SAMPLES * planes,
+                                         true));
+
+              fail_if (OMX_ErrorNone != tiz_pcm_set_isa (ETIZPcmIsaScalar));
+              tiz_pcm_from_float (pcm_test_ref, fmt, flt, planes,
+                                  PCM_TEST_PLANE_SAMPLES, NULL);
+              fail_if (OMX_ErrorNone != tiz_pcm_set_isa (a_isa));
+              tiz_pcm_from_float (pcm_test_out, fmt, flt, planes,
+                                  PCM_TEST_PLANE_SAMPLES, NULL);
+              fail_if (!check_pcm_equal (pcm_test_ref, pcm_test_out, fmt,
+                                         PCM_TEST_PLANE_SAMPLES * planes,
+                                         true));
+            }
+        }
+    }
+}
+
+/* A constant quarter of an LSB comes out as an average of a quarter of an
+   LSB, one LSB at most away from it */
+static void
+check_pcm_dither (void)
+{
+  const float * flt[2] = {pcm_test_float[0], pcm_test_float[1]};
+  const int16_t * p_out = (const int16_t *) pcm_test_out;
+  tiz_pcm_dither_t dither;
+  double sum = 0;
+  size_t i = 0;
+  int n = 0;
+
+  for (i = 0; i < PCM_TEST_PLANE_SAMPLES; ++i)
+    {
+      pcm_test_float[0][i] = pcm_test_float[1][i] = 0.25f / 32768.f;
+    }
+  tiz_pcm_dither_init (&dither, 1);
+  for (n = 0; n < 100; ++n)
+    {
+      tiz_pcm_from_float (pcm_test_out, ETIZPcmFormatS16, flt, 2,
+                          PCM_TEST_PLANE_SAMPLES, &dither);
+      for (i = 0; i < PCM_TEST_PLANE_SAMPLES * 2; ++i)
+        {
+          fail_if (p_out[i] < -1 || p_out[i] > 1);
+          sum += p_out[i];
+        }
+    }
+  sum /= 100 * PCM_TEST_PLANE_SAMPLES * 2;
+  fail_if (fabs (sum - 0.25) > 0.05);
+}
+
+START_TEST (test_pcm_kernels)
+{
+  const tiz_pcm_isa_t best = tiz_pcm_isa ();
+  int16_t s16[4] = {1000, -1000, 32767, -32768};
+  int isa = 0;
+
+  /* Saturation */
+  tiz_pcm_gain (s16, 4, ETIZPcmFormatS16, 2.f);
+  fail_if (2000 != s16[0] || -2000 != s16[1]);
+  fail_if (32767 != s16[2] || -32768 != s16[3]);
+
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (ETIZPcmIsaScalar));
+  fail_if (OMX_ErrorUnsupportedSetting != tiz_pcm_set_isa (ETIZPcmIsaMax));
+
+  for (isa = ETIZPcmIsaScalar; isa < ETIZPcmIsaMax; ++isa)
+    {
+      if (OMX_ErrorNone == tiz_pcm_set_isa (isa))
+        {
+          check_pcm_isa (isa);
+          check_pcm_convert_isa (isa);
+          fail_if (OMX_ErrorNone != tiz_pcm_set_isa (isa));
+          check_pcm_dither ();
+        }
+    }
+
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (best));
+}
+END_TEST
+
+START_TEST (test_pcm_convert)
+{
+  /* libmad's 1.0, 0.5 and -1.0, stereo */
+  const int32_t fixed_l[3] = {0x10000000, 0x08000000, -0x10000000};
+  const int32_t fixed_r[3] = {0x00001000, -0x00001000, 0x00000FFF};
+  const int32_t * fixed[2] = {fixed_l, fixed_r};
+  const float flt_l[3] = {1.f, 0.5f, -1.f};
+  const float flt_r[3] = {-0.75f / 32768.f, 2.f, 1.49f / 32768.f};
+  const float * flt[2] = {flt_l, flt_r};
+  int16_t s16[6];
+  float f32[6];
+  OMX_AUDIO_PARAM_PCMMODETYPE pcmmode;
+  tiz_pcm_format_t fmt = ETIZPcmFormatMax;
+
+  tiz_pcm_from_fixed (s16, ETIZPcmFormatS16, fixed, 2, 3, 28);
+  fail_if (32767 != s16[0] || 1 != s16[1]);
+  fail_if (16384 != s16[2] || 0 != s16[3]);
+  fail_if (-32768 != s16[4] || 0 != s16[5]);
+
+  tiz_pcm_from_float (s16, ETIZPcmFormatS16, flt, 2, 3, NULL);
+  fail_if (32767 != s16[0] || -1 != s16[1]);
+  fail_if (16384 != s16[2] || 32767 != s16[3]);
+  fail_if (-32768 != s16[4] || 1 != s16[5]);
+
+  tiz_pcm_from_float (f32, ETIZPcmFormatFloat, flt, 2, 3, NULL);
+  fail_if (flt_l[1] != f32[2] || flt_r[1] != f32[3]);
+
+  pcmmode.nBitPerSample = 24;
+  fail_if (OMX_ErrorNone != tiz_pcm_format_from_pcmmode (&pcmmode, &fmt));
+  fail_if (ETIZPcmFormatS24 != fmt);
+  pcmmode.nBitPerSample = 32;
+  fail_if (OMX_ErrorNone != tiz_pcm_format_from_pcmmode (&pcmmode, &fmt));
+  fail_if (ETIZPcmFormatFloat != fmt);
+  pcmmode.nBitPerSample = 8;
+  fail_if (OMX_ErrorBadParameter
+           != tiz_pcm_format_from_pcmmode (&pcmmode, &fmt));
+
+  pcmmode.eEndian = OMX_EndianBig;
+  fail_if (tiz_pcm_needs_swap (&pcmmode)
+           == (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__));
+}
+END_TEST
+
+START_TEST (test_pcm_kernels_benchmark)
+{
+  const tiz_pcm_isa_t best = tiz_pcm_isa ();
+  static int32_t buf[PCM_BENCH_SAMPLES];
+  int isa = 0;
+
+  fprintf (stderr, "pcm kernels benchmark: %d stereo frames x %d buffers\n",
+           PCM_BENCH_SAMPLES / 2, PCM_BENCH_ITERATIONS);
+
+  for (isa = ETIZPcmIsaScalar; isa < ETIZPcmIsaMax; ++isa)
+    {
+      int fmt = 0;
+      if (OMX_ErrorNone != tiz_pcm_set_isa (isa))
+        {
+          continue;
+        }
+      for (fmt = 0; fmt < ETIZPcmFormatMax; ++fmt)
+        {
+          OMX_U64 start = 0;
+          double gain_ms = 0;
+          double ramp_ms = 0;
+          double swap_ms = 0;
+          int i = 0;
+
+          check_pcm_fill (buf, fmt, PCM_BENCH_SAMPLES);
+
+          start = tiz_time_now_us ();
+          for (i = 0; i < PCM_BENCH_ITERATIONS; ++i)
+            {
+              tiz_pcm_gain (buf, PCM_BENCH_SAMPLES, fmt, (i & 1) ? 0.5f : 2.f);
+            }
+          gain_ms = (tiz_time_now_us () - start) / 1000.0;
+
+          start = tiz_time_now_us ();
+          for (i = 0; i < PCM_BENCH_ITERATIONS; ++i)
+            {
+              /* Up and down, so that the samples do not decay to
+                 denormals */
+              tiz_pcm_ramp (buf, PCM_BENCH_SAMPLES / 2, 2, fmt,
+                            (i & 1) ? 1.1f : 0.9f, (i & 1) ? 0.9f : 1.1f);
+            }
+          ramp_ms = (tiz_time_now_us () - start) / 1000.0;
+
+          start = tiz_time_now_us ();
+          for (i = 0; i < PCM_BENCH_ITERATIONS; ++i)
+            {
+              tiz_pcm_swap (buf, PCM_BENCH_SAMPLES, tiz_pcm_sample_size (fmt));
+            }
+          swap_ms = (tiz_time_now_us () - start) / 1000.0;
+
+          fprintf (stderr,
+                   "  %-6s fmt %d : gain %8.2f ms  ramp %8.2f ms  "
+                   "swap %8.2f ms\n",
+                   tiz_pcm_isa_to_str (isa), fmt, gain_ms, ramp_ms, swap_ms);
+        }
+    }
+
+  fprintf (stderr, "pcm conversion benchmark: %d stereo frames x %d buffers\n",
+           PCM_TEST_PLANE_SAMPLES, PCM_BENCH_ITERATIONS * 8);
+
+  for (isa = ETIZPcmIsaScalar; isa < ETIZPcmIsaMax; ++isa)
+    {
+      const int32_t * fixed[2] = {pcm_test_fixed[0], pcm_test_fixed[1]};
+      const float * flt[2] = {pcm_test_float[0], pcm_test_float[1]};
+      tiz_pcm_dither_t dither;
+      OMX_U64 start = 0;
+      double fixed_ms = 0;
+      double float_ms = 0;
+      double dither_ms = 0;
+      int i = 0;
+
+      if (OMX_ErrorNone != tiz_pcm_set_isa (isa))
+        {
+          continue;
+        }
+
+      check_pcm_fill_planes (28);
+      start = tiz_time_now_us ();
+      for (i = 0; i < PCM_BENCH_ITERATIONS * 8; ++i)
+        {
+          tiz_pcm_from_fixed (buf, ETIZPcmFormatS16, fixed, 2,
+                              PCM_TEST_PLANE_SAMPLES, 28);
+        }
+      fixed_ms = (tiz_time_now_us () - start) / 1000.0;
+
+      start = tiz_time_now_us ();
+      for (i = 0; i < PCM_BENCH_ITERATIONS * 8; ++i)
+        {
+          tiz_pcm_from_float (buf, ETIZPcmFormatS16, flt, 2,
+                              PCM_TEST_PLANE_SAMPLES, NULL);
+        }
+      float_ms = (tiz_time_now_us () - start) / 1000.0;
+
+      tiz_pcm_dither_init (&dither, 1);
+      start = tiz_time_now_us ();
+      for (i = 0; i < PCM_BENCH_ITERATIONS * 8; ++i)
+        {
+          tiz_pcm_from_float (buf, ETIZPcmFormatS16, flt, 2,
+                              PCM_TEST_PLANE_SAMPLES, &dither);
+        }
+      dither_ms = (tiz_time_now_us () - start) / 1000.0;
+
+      fprintf (stderr,
+               "  %-6s s16 : fixed %8.2f ms  float %8.2f ms  "
+               "dithered %8.2f ms\n",
+               tiz_pcm_isa_to_str (isa), fixed_ms, float_ms, dither_ms);
+    }
+
+  fail_if (OMX_ErrorNone != tiz_pcm_set_isa (best));
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
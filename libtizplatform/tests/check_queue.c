@@ -85,6 +85,156 @@ START_TEST (test_queue_send_and_receive)
 }
 END_TEST
 
+START_TEST (test_queue_lockfree_send_and_receive)
+{
+
+  OMX_U32 i;
+  OMX_PTR p_received = NULL;
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  int *p_item = NULL;
+  tiz_queue_t *p_queue = NULL;;
+
+  error = tiz_queue_init_with_type (&p_queue, 10, ETIZQueueTypeLockFree);
+
+  fail_if (error != OMX_ErrorNone);
+  fail_if (10 != tiz_queue_capacity (p_queue));
+
+  for (i = 0; i < 10; i++)
+    {
+      p_item = (int *) tiz_mem_alloc (sizeof (int));
+      fail_if (p_item == NULL);
+      *p_item = i;
+      error = tiz_queue_send (p_queue, p_item);
+      fail_if (error != OMX_ErrorNone);
+    }
+
+  fail_if (10 != tiz_queue_length (p_queue));
+
+  for (i = 0; i < 10; i++)
+    {
+      error = tiz_queue_receive (p_queue, &p_received);
+      fail_if (error != OMX_ErrorNone);
+      fail_if (p_received == NULL);
+      p_item = (int *) p_received;
+      fail_if (*p_item != i);
+      tiz_mem_free (p_received);
+    }
+
+  fail_if (0 != tiz_queue_length (p_queue));
+
+  p_received = NULL;
+  error = tiz_queue_timed_receive (p_queue, &p_received, 10);
+  fail_if (error != OMX_ErrorTimeout);
+  fail_if (p_received != NULL);
+
+  tiz_queue_destroy (p_queue);
+
+}
+END_TEST
+
+#define QUEUE_BENCH_PRODUCERS 4
+#define QUEUE_BENCH_ITEMS_PER_PRODUCER 100000
+#define QUEUE_BENCH_CAPACITY 32
+
+typedef struct queue_bench_producer queue_bench_producer_t;
+struct queue_bench_producer
+{
+  tiz_queue_t *p_queue;
+  long id;
+};
+
+static void *
+queue_bench_producer_func (void *p_arg)
+{
+  queue_bench_producer_t *p_prod = p_arg;
+  long i;
+
+  for (i = 0; i < QUEUE_BENCH_ITEMS_PER_PRODUCER; ++i)
+    {
+      /* Encode producer id and sequence number; never NULL */
+      long item = (p_prod->id << 24) | (i + 1);
+      if (OMX_ErrorNone != tiz_queue_send (p_prod->p_queue, (OMX_PTR) item))
+        {
+          return NULL;
+        }
+    }
+
+  return p_prod;
+}
+
+static double
+queue_bench_run (tiz_queue_type_t type)
+{
+  OMX_ERRORTYPE error = OMX_ErrorNone;
+  tiz_queue_t *p_queue = NULL;
+  tiz_thread_t threads[QUEUE_BENCH_PRODUCERS];
+  queue_bench_producer_t producers[QUEUE_BENCH_PRODUCERS];
+  long last_seen[QUEUE_BENCH_PRODUCERS];
+  struct timespec start, end;
+  void *p_result = NULL;
+  OMX_PTR p_received = NULL;
+  long total = QUEUE_BENCH_PRODUCERS * QUEUE_BENCH_ITEMS_PER_PRODUCER;
+  long i;
+
+  error = tiz_queue_init_with_type (&p_queue, QUEUE_BENCH_CAPACITY, type);
+  fail_if (error != OMX_ErrorNone);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+
+  for (i = 0; i < QUEUE_BENCH_PRODUCERS; ++i)
+    {
+      last_seen[i] = 0;
+      producers[i].p_queue = p_queue;
+      producers[i].id = i;
+      error = tiz_thread_create (&threads[i], 0, 0, queue_bench_producer_func,
+                                 &producers[i]);
+      fail_if (error != OMX_ErrorNone);
+    }
+
+  for (i = 0; i < total; ++i)
+    {
+      long item, id, seq;
+      error = tiz_queue_receive (p_queue, &p_received);
+      fail_if (error != OMX_ErrorNone);
+      item = (long) p_received;
+      id = item >> 24;
+      seq = item & 0xFFFFFF;
+      fail_if (id < 0 || id >= QUEUE_BENCH_PRODUCERS);
+      /* Per-producer FIFO ordering must be preserved */
+      fail_if (seq != last_seen[id] + 1);
+      last_seen[id] = seq;
+    }
+
+  for (i = 0; i < QUEUE_BENCH_PRODUCERS; ++i)
+    {
+      error = tiz_thread_join (&threads[i], &p_result);
+      fail_if (error != OMX_ErrorNone);
+      fail_if (p_result == NULL);
+    }
+
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  fail_if (0 != tiz_queue_length (p_queue));
+  tiz_queue_destroy (p_queue);
+
+  return (end.tv_sec - start.tv_sec) * 1000.0
+    + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+START_TEST (test_queue_contention_benchmark)
+{
+  double mutex_ms = queue_bench_run (ETIZQueueTypeMutex);
+  double lockfree_ms = queue_bench_run (ETIZQueueTypeLockFree);
+
+  fprintf (stderr,
+           "queue contention benchmark: %d producers x %d items, capacity %d\n"
+           "  mutex     : %8.2f ms\n"
+           "  lock-free : %8.2f ms\n",
+           QUEUE_BENCH_PRODUCERS, QUEUE_BENCH_ITEMS_PER_PRODUCER,
+           QUEUE_BENCH_CAPACITY, mutex_ms, lockfree_ms);
+}
+END_TEST
+
 /* Local Variables: */
 /* c-default-style: gnu */
 /* fill-column: 79 */
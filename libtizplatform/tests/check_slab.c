@@ -0,0 +1,197 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_slab.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Slab allocator unit tests
+ *
+ *
+ */
+
+#include <pthread.h>
+
+#define SLAB_TEST_OBJS 1000
+#define SLAB_TEST_ROUNDS 4
+
+static OMX_S32
+check_slab_map_cmp_f (OMX_PTR ap_key1, OMX_PTR ap_key2)
+{
+  return *((int *) ap_key1) - *((int *) ap_key2);
+}
+
+static void
+check_slab_map_free_f (OMX_PTR ap_key, OMX_PTR ap_value)
+{
+  (void) ap_key;
+  (void) ap_value;
+}
+
+static OMX_S32
+check_slab_pqueue_cmp_f (OMX_PTR ap_left, OMX_PTR ap_right)
+{
+  return (ap_left == ap_right) ? 0 : 1;
+}
+
+static void *
+check_slab_alloc_thread (void * ap_arg)
+{
+  void ** pp_objs = ap_arg;
+  int i = 0;
+
+  for (i = 0; i < SLAB_TEST_OBJS; ++i)
+    {
+      pp_objs[i] = tiz_slab_alloc (24);
+    }
+
+  /* The rest of this thread's cache goes back on exit */
+  return NULL;
+}
+
+START_TEST (test_slab_basic_life_cycle)
+{
+  static void * objs[SLAB_TEST_OBJS];
+  tiz_slab_info_t before;
+  tiz_slab_info_t info;
+  int i = 0;
+
+  tiz_slab_info (&before);
+  fail_if (before.classes <= 0);
+
+  for (i = 0; i < SLAB_TEST_OBJS; ++i)
+    {
+      /* Up to 6000 bytes: the larger ones are not slab objects */
+      size_t size = 1 + (i * 6) % 6000;
+      fail_if (NULL == (objs[i] = tiz_slab_calloc (size)));
+      fail_if (0 != ((uintptr_t) objs[i] % sizeof (void *)));
+      memset (objs[i], 0xA5, size);
+    }
+
+  tiz_slab_info (&info);
+  fail_if (info.objects - before.objects != SLAB_TEST_OBJS);
+  fail_if (info.chunks <= before.chunks);
+
+  for (i = 0; i < SLAB_TEST_OBJS; ++i)
+    {
+      tiz_slab_free (objs[i]);
+    }
+
+  tiz_slab_info (&info);
+  fail_if (info.objects != before.objects);
+
+  /* All the empty chunks are reclaimed */
+  tiz_slab_trim ();
+  tiz_slab_info (&info);
+  fail_if (info.chunks > before.chunks);
+  fail_if (0 != info.cached);
+  fail_if (0 == info.chunk_releases);
+}
+END_TEST
+
+START_TEST (test_slab_cross_thread_free)
+{
+  static void * objs[SLAB_TEST_OBJS];
+  tiz_slab_info_t before;
+  tiz_slab_info_t info;
+  pthread_t thread;
+  int i = 0;
+
+  tiz_slab_info (&before);
+
+  fail_if (0 != pthread_create (&thread, NULL, check_slab_alloc_thread, objs));
+  fail_if (0 != pthread_join (thread, NULL));
+
+  tiz_slab_info (&info);
+  fail_if (info.objects - before.objects != SLAB_TEST_OBJS);
+
+  for (i = 0; i < SLAB_TEST_OBJS; ++i)
+    {
+      fail_if (NULL == objs[i]);
+      tiz_slab_free (objs[i]);
+    }
+
+  tiz_slab_trim ();
+  tiz_slab_info (&info);
+  fail_if (info.objects != before.objects);
+  fail_if (0 != info.cached);
+}
+END_TEST
+
+START_TEST (test_slab_steady_state)
+{
+  tiz_pqueue_t * p_pq = NULL;
+  tiz_vector_t * p_vec = NULL;
+  tiz_map_t * p_map = NULL;
+  tiz_slab_info_t info;
+  int64_t sys_allocs = 0;
+  int keys[64];
+  void * p_item = NULL;
+  int round = 0;
+  int i = 0;
+
+  fail_if (OMX_ErrorNone
+           != tiz_pqueue_init (&p_pq, 2, &check_slab_pqueue_cmp_f, NULL,
+                               "tizslab"));
+  fail_if (OMX_ErrorNone != tiz_vector_init (&p_vec, sizeof (int)));
+  fail_if (OMX_ErrorNone
+           != tiz_map_init (&p_map, check_slab_map_cmp_f,
+                            check_slab_map_free_f, NULL));
+
+  /* After the first round, a round of the same work must not need any more
+     memory from the system */
+  for (round = 0; round < SLAB_TEST_ROUNDS; ++round)
+    {
+      for (i = 0; i < 64; ++i)
+        {
+          OMX_U32 index = 0;
+          keys[i] = i;
+          fail_if (OMX_ErrorNone
+                   != tiz_pqueue_send (p_pq, &keys[i], i % 3));
+          fail_if (OMX_ErrorNone != tiz_vector_push_back (p_vec, &keys[i]));
+          fail_if (OMX_ErrorNone
+                   != tiz_map_insert (p_map, &keys[i], &keys[i], &index));
+        }
+      for (i = 0; i < 64; ++i)
+        {
+          fail_if (OMX_ErrorNone != tiz_pqueue_receive (p_pq, &p_item));
+          tiz_map_erase (p_map, &keys[i]);
+        }
+      tiz_vector_clear (p_vec);
+
+      tiz_slab_info (&info);
+      if (0 == round)
+        {
+          sys_allocs = info.sys_allocs;
+        }
+      fail_if (info.sys_allocs != sys_allocs);
+    }
+
+  tiz_map_destroy (p_map);
+  tiz_vector_destroy (p_vec);
+  tiz_pqueue_destroy (p_pq);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
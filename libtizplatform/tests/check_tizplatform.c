@@ -32,6 +32,8 @@
 #include <signal.h>
 #include <unistd.h>
 #include <linux/limits.h>
+#include <time.h>
+#include <math.h>
 #include "../src/tizplatform.h"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
@@ -46,13 +48,20 @@
 #include "./check_queue.c"
 #include "./check_pqueue.c"
 #include "./check_vector.c"
+#include "./check_buffer.c"
 #include "./check_rc.c"
 #include "./check_soa.c"
+#include "./check_slab.c"
+#include "./check_pcm.c"
 #include "./check_event.c"
 #include "./check_http_parser.c"
 #include "./check_map.c"
+#include "./check_urlcache.c"
+#include "./check_log.c"
 
 #define EVENT_API_TEST_TIMEOUT 100
+#define QUEUE_BENCH_TEST_TIMEOUT 60
+#define PCM_BENCH_TEST_TIMEOUT 60
 
 Suite *
 platform_mem_suite (void)
@@ -103,6 +112,13 @@ platform_queue_suite (void)
   tc_queue = tcase_create ("queue");
   tcase_add_test (tc_queue, test_queue_init_and_destroy);
   tcase_add_test (tc_queue, test_queue_send_and_receive);
+  tcase_add_test (tc_queue, test_queue_lockfree_send_and_receive);
+  suite_add_tcase (s, tc_queue);
+
+  /* queue contention microbenchmark */
+  tc_queue = tcase_create ("queue contention");
+  tcase_set_timeout (tc_queue, QUEUE_BENCH_TEST_TIMEOUT);
+  tcase_add_test (tc_queue, test_queue_contention_benchmark);
   suite_add_tcase (s, tc_queue);
 
   return s;
@@ -145,6 +161,22 @@ platform_vector_suite (void)
   return s;
 }
 
+Suite *
+platform_buffer_suite (void)
+{
+  TCase *tc_buffer = NULL;
+  Suite *s = suite_create ("Contiguous binary data buffer");
+
+  /* buffer API test cases */
+  tc_buffer = tcase_create ("buffer");
+  tcase_add_test (tc_buffer, test_buffer_heap_fifo);
+  tcase_add_test (tc_buffer, test_buffer_ring_fifo);
+  tcase_add_test (tc_buffer, test_buffer_ring_reserve_commit_peek);
+  suite_add_tcase (s, tc_buffer);
+
+  return s;
+}
+
 Suite *
 platform_rcfile_suite (void)
 {
@@ -178,6 +210,43 @@ platform_soa_suite (void)
   return s;
 }
 
+Suite *
+platform_slab_suite (void)
+{
+  TCase *tc_slab = NULL;
+  Suite *s = suite_create ("Slab allocation APIs");
+
+  /* slab allocation API test cases */
+  tc_slab = tcase_create ("slab");
+  tcase_add_test (tc_slab, test_slab_basic_life_cycle);
+  tcase_add_test (tc_slab, test_slab_cross_thread_free);
+  tcase_add_test (tc_slab, test_slab_steady_state);
+  suite_add_tcase (s, tc_slab);
+
+  return s;
+}
+
+Suite *
+platform_pcm_suite (void)
+{
+  TCase *tc_pcm = NULL;
+  Suite *s = suite_create ("PCM processing kernels");
+
+  /* pcm kernels test cases */
+  tc_pcm = tcase_create ("pcm");
+  tcase_add_test (tc_pcm, test_pcm_kernels);
+  tcase_add_test (tc_pcm, test_pcm_convert);
+  suite_add_tcase (s, tc_pcm);
+
+  /* pcm kernels microbenchmark */
+  tc_pcm = tcase_create ("pcm benchmark");
+  tcase_set_timeout (tc_pcm, PCM_BENCH_TEST_TIMEOUT);
+  tcase_add_test (tc_pcm, test_pcm_kernels_benchmark);
+  suite_add_tcase (s, tc_pcm);
+
+  return s;
+}
+
 Suite *
 platform_event_suite (void)
 {
@@ -196,6 +265,24 @@ platform_event_suite (void)
   return s;
 }
 
+Suite *
+platform_event_loop_suite (void)
+{
+  TCase  *tc_event;
+  Suite *s = suite_create ("event loops");
+
+  putenv(TIZ_PLATFORM_RC_FILE_ENV);
+
+  /* bound event loop test cases */
+  tc_event = tcase_create ("bound event loop");
+  tcase_set_timeout (tc_event, EVENT_API_TEST_TIMEOUT);
+  tcase_add_test (tc_event, test_event_loop_bound);
+  tcase_add_test (tc_event, test_event_loop_batch);
+  suite_add_tcase (s, tc_event);
+
+  return s;
+}
+
 Suite *
 platform_http_parser_suite (void)
 {
@@ -227,6 +314,38 @@ platform_map_suite (void)
 
 }
 
+Suite *
+platform_urlcache_suite (void)
+{
+  TCase *tc_urlcache = NULL;
+  Suite *s = suite_create ("URL cache");
+
+  /* url cache API test cases */
+  tc_urlcache = tcase_create ("urlcache");
+  tcase_add_test (tc_urlcache, test_urlcache_none);
+  tcase_add_test (tc_urlcache, test_urlcache_memory);
+  tcase_add_test (tc_urlcache, test_urlcache_disk);
+  suite_add_tcase (s, tc_urlcache);
+
+  return s;
+}
+
+Suite *
+platform_log_suite (void)
+{
+  TCase *tc_log = NULL;
+  Suite *s = suite_create ("Logging");
+
+  /* logging API test cases */
+  tc_log = tcase_create ("logging API");
+  tcase_add_test (tc_log, test_log_site_cache_invalidation);
+  tcase_add_test (tc_log, test_log_async);
+  tcase_add_test (tc_log, test_log_module_unload);
+  suite_add_tcase (s, tc_log);
+
+  return s;
+}
+
 int
 main (void)
 {
@@ -242,10 +361,16 @@ main (void)
   srunner_add_suite (sr, platform_queue_suite ());
   srunner_add_suite (sr, platform_pqueue_suite ());
   srunner_add_suite (sr, platform_vector_suite ());
+  srunner_add_suite (sr, platform_buffer_suite ());
   srunner_add_suite (sr, platform_rcfile_suite ());
   srunner_add_suite (sr, platform_soa_suite ());
+  srunner_add_suite (sr, platform_slab_suite ());
+  srunner_add_suite (sr, platform_pcm_suite ());
   srunner_add_suite (sr, platform_http_parser_suite ());
   srunner_add_suite (sr, platform_map_suite ());
+  srunner_add_suite (sr, platform_urlcache_suite ());
+  srunner_add_suite (sr, platform_event_loop_suite ());
+  srunner_add_suite (sr, platform_log_suite ());
 /*   srunner_add_suite (sr, platform_event_suite ()); */
   srunner_run_all (sr, CK_VERBOSE);
   number_failed = srunner_ntests_failed (sr);
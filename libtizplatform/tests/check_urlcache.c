@@ -0,0 +1,193 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_urlcache.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  URL cache unit tests
+ *
+ *
+ */
+
+#define URLCACHE_TEST_SIZE (64 * 1024)
+#define URLCACHE_TEST_HEADERS "Content-Type: audio/mpeg\r\n"
+
+static void
+check_urlcache_store (tiz_urlcache_t * ap_cache, const char * ap_key,
+                      const unsigned char a_seed)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+  unsigned char chunk[1000];
+  size_t written = 0;
+  size_t i = 0;
+
+  p_entry = tiz_urlcache_create (ap_cache, ap_key, URLCACHE_TEST_HEADERS,
+                                 strlen (URLCACHE_TEST_HEADERS),
+                                 URLCACHE_TEST_SIZE);
+  fail_if (NULL == p_entry);
+
+  while (written < URLCACHE_TEST_SIZE)
+    {
+      const size_t len = MIN (sizeof (chunk), URLCACHE_TEST_SIZE - written);
+      for (i = 0; i < len; ++i)
+        {
+          chunk[i] = (unsigned char) (a_seed + written + i);
+        }
+      fail_if (OMX_ErrorNone != tiz_urlcache_write (p_entry, chunk, len));
+      written += len;
+    }
+  fail_if (OMX_ErrorOverflow != tiz_urlcache_write (p_entry, chunk, 1));
+  fail_if (URLCACHE_TEST_SIZE != tiz_urlcache_written (p_entry));
+  fail_if (OMX_ErrorNone != tiz_urlcache_commit (p_entry));
+}
+
+static void
+check_urlcache_verify (tiz_urlcache_t * ap_cache, const char * ap_key,
+                       const unsigned char a_seed)
+{
+  tiz_urlcache_entry_t * p_entry = NULL;
+  unsigned char chunk[777];
+  const char * p_headers = NULL;
+  size_t headers_len = 0;
+  size_t total = 0;
+  size_t len = 0;
+  size_t i = 0;
+
+  p_entry = tiz_urlcache_open (ap_cache, ap_key);
+  fail_if (NULL == p_entry);
+  fail_if (URLCACHE_TEST_SIZE != tiz_urlcache_size (p_entry));
+
+  p_headers = tiz_urlcache_headers (p_entry, &headers_len);
+  fail_if (strlen (URLCACHE_TEST_HEADERS) != headers_len);
+  fail_if (0 != memcmp (p_headers, URLCACHE_TEST_HEADERS, headers_len));
+
+  while ((len = tiz_urlcache_read (p_entry, chunk, sizeof (chunk))) > 0)
+    {
+      for (i = 0; i < len; ++i)
+        {
+          fail_if (chunk[i] != (unsigned char) (a_seed + total + i));
+        }
+      total += len;
+    }
+  fail_if (URLCACHE_TEST_SIZE != total);
+  tiz_urlcache_close (p_entry);
+}
+
+static void
+check_urlcache_life_cycle (const tiz_urlcache_type_t a_type)
+{
+  tiz_urlcache_t * p_cache = NULL;
+  tiz_urlcache_entry_t * p_entry = NULL;
+
+  /* Room for two entries */
+  fail_if (OMX_ErrorNone
+           != tiz_urlcache_init (&p_cache, a_type,
+                                 2 * URLCACHE_TEST_SIZE + 4096));
+
+  fail_if (tiz_urlcache_contains (p_cache, "http://a"));
+  fail_if (NULL != tiz_urlcache_open (p_cache, "http://a"));
+
+  /* Incomplete entries are discarded */
+  p_entry = tiz_urlcache_create (p_cache, "http://a", "", 0, 10);
+  fail_if (NULL == p_entry);
+  fail_if (OMX_ErrorNone != tiz_urlcache_write (p_entry, "01234", 5));
+  /* Not visible until committed */
+  fail_if (tiz_urlcache_contains (p_cache, "http://a"));
+  fail_if (OMX_ErrorNone == tiz_urlcache_commit (p_entry));
+  fail_if (tiz_urlcache_contains (p_cache, "http://a"));
+
+  /* Entries larger than the store are not accepted */
+  fail_if (NULL
+           != tiz_urlcache_create (p_cache, "http://big", "", 0,
+                                   4 * URLCACHE_TEST_SIZE));
+
+  check_urlcache_store (p_cache, "http://a", 1);
+  check_urlcache_verify (p_cache, "http://a", 1);
+
+  /* Replacing an entry while it is being read */
+  p_entry = tiz_urlcache_open (p_cache, "http://a");
+  fail_if (NULL == p_entry);
+  check_urlcache_store (p_cache, "http://a", 2);
+  check_urlcache_verify (p_cache, "http://a", 2);
+  tiz_urlcache_close (p_entry);
+
+  check_urlcache_store (p_cache, "http://b", 3);
+
+  if (ETIZUrlCacheTypeDisk == a_type)
+    {
+      /* Eviction follows the modification times, which have a resolution of
+         one second on some file systems */
+      sleep (1);
+    }
+
+  /* Use "a" so that "b" becomes the least recently used */
+  check_urlcache_verify (p_cache, "http://a", 2);
+
+  if (ETIZUrlCacheTypeDisk == a_type)
+    {
+      sleep (1);
+    }
+
+  check_urlcache_store (p_cache, "http://c", 4);
+  fail_if (!tiz_urlcache_contains (p_cache, "http://a"));
+  fail_if (tiz_urlcache_contains (p_cache, "http://b"));
+  check_urlcache_verify (p_cache, "http://c", 4);
+
+  tiz_urlcache_destroy (p_cache);
+}
+
+START_TEST (test_urlcache_memory)
+{
+  check_urlcache_life_cycle (ETIZUrlCacheTypeMemory);
+}
+END_TEST
+
+START_TEST (test_urlcache_disk)
+{
+  char dir[] = "/tmp/check_urlcache.XXXXXX";
+  fail_if (NULL == mkdtemp (dir));
+  fail_if (0 != setenv ("XDG_CACHE_HOME", dir, 1));
+  check_urlcache_life_cycle (ETIZUrlCacheTypeDisk);
+}
+END_TEST
+
+START_TEST (test_urlcache_none)
+{
+  tiz_urlcache_t * p_cache = NULL;
+
+  fail_if (ETIZUrlCacheTypeNone != tiz_urlcache_type_from_str ("none"));
+  fail_if (ETIZUrlCacheTypeMemory != tiz_urlcache_type_from_str ("memory"));
+  fail_if (ETIZUrlCacheTypeDisk != tiz_urlcache_type_from_str ("disk"));
+  fail_if (ETIZUrlCacheTypeNone != tiz_urlcache_type_from_str ("bogus"));
+
+  fail_if (OMX_ErrorNone
+           != tiz_urlcache_init (&p_cache, ETIZUrlCacheTypeNone, 1024));
+  fail_if (NULL != tiz_urlcache_create (p_cache, "http://a", "", 0, 10));
+  fail_if (tiz_urlcache_contains (p_cache, "http://a"));
+  tiz_urlcache_destroy (p_cache);
+}
+END_TEST
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
@@ -57,7 +57,7 @@ graph::aacdecoder::aacdecoder ()
 {
 }
 
-graph::ops *graph::aacdecoder::do_init ()
+graph::ops *graph::aacdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.file_reader.binary");
@@ -69,7 +69,12 @@ graph::ops *graph::aacdecoder::do_init ()
   role_list.push_back ("audio_decoder.aac");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new aacdecops (this, comp_list, role_list);
+  return new aacdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::aacdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -34,6 +34,8 @@
 #include "tizgraphfsm.hpp"
 #include "tizgraphcmd.hpp"
 #include "tizgraphops.hpp"
+#include "tizgraphutil.hpp"
+#include "tizprobe.hpp"
 
 #include "tizdecgraph.hpp"
 
@@ -51,7 +53,9 @@ graph::decoder::decoder (const std::string &graph_name)
   : graph::graph (graph_name),
     fsm_ (new fsm (boost::msm::back::states_
                    << tiz::graph::fsm::configuring (&p_ops_)
-                   << tiz::graph::fsm::skipping (&p_ops_),
+                   << tiz::graph::fsm::skipping (&p_ops_)
+                   << tiz::graph::fsm::switching (&p_ops_)
+                   << tiz::graph::fsm::swapping (&p_ops_),
                    &p_ops_))
 {
 }
@@ -120,9 +124,58 @@ void graph::decops::do_disable_comp_ports (const int /* comp_id */,
   // configuring in tizgraphfsm.hpp.
 }
 
+void graph::decops::do_configure_comp (const int comp_id)
+{
+  // This is used during a gapless track switch, where only the source
+  // component goes back to Loaded and needs the uri of the next track.
+  if (last_op_succeeded () && 0 == comp_id)
+  {
+    assert (probe_ptr_);
+    G_OPS_BAIL_IF_ERROR (
+        util::set_content_uri (handles_[0], probe_ptr_->get_uri ()),
+        "Unable to set OMX_IndexParamContentURI");
+  }
+}
+
 bool graph::decops::is_disabled_evt_required () const
 {
   // It returns false because in the default case there is no video port to be
   // disabled in the graph. See comment in do_disable_comp_ports.
   return false;
 }
+
+OMX_ERRORTYPE
+graph::decops::switch_tunnel (const int tunnel_id,
+                              const OMX_COMMANDTYPE to_disabled_or_enabled)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  // The source <-> decoder tunnel is switched during gapless track changes,
+  // and the decoder <-> renderer tunnel during decoder swaps.
+  assert (0 == tunnel_id || 1 == tunnel_id);
+  assert (to_disabled_or_enabled == OMX_CommandPortDisable
+          || to_disabled_or_enabled == OMX_CommandPortEnable);
+
+  if (to_disabled_or_enabled == OMX_CommandPortDisable)
+  {
+    rc = tiz::graph::util::disable_tunnel (handles_, tunnel_id);
+  }
+  else
+  {
+    rc = tiz::graph::util::enable_tunnel (handles_, tunnel_id);
+  }
+
+  if (OMX_ErrorNone == rc)
+  {
+    clear_expected_port_transitions ();
+    const int output_index = tunnel_id;
+    const int output_port = (0 == tunnel_id ? 0 : 1);
+    add_expected_port_transition (handles_[output_index], output_port,
+                                  to_disabled_or_enabled);
+    const int input_index = tunnel_id + 1;
+    const int input_port = 0;
+    add_expected_port_transition (handles_[input_index], input_port,
+                                  to_disabled_or_enabled);
+  }
+  return rc;
+}
@@ -63,7 +63,12 @@ namespace tiz
 
     public:
       void do_disable_comp_ports (const int comp_id, const int port_id);
+      void do_configure_comp (const int comp_id);
       bool is_disabled_evt_required () const;
+
+    protected:
+      OMX_ERRORTYPE switch_tunnel (const int tunnel_id,
+                                   const OMX_COMMANDTYPE to_disabled_or_enabled);
     };
 
   }  // namespace graph
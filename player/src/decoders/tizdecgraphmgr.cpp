@@ -30,11 +30,17 @@
 #endif
 
 #include <boost/assign/list_of.hpp> // for 'list_of()'
+#include <boost/make_shared.hpp>
 
 #include <tizplatform.h>
 
+#include "tizgraph.hpp"
+#include "tizgraphconfig.hpp"
+#include "tizgraphfactory.hpp"
+#include "tizgraphmgrops.hpp"
 #include "tizgraphmgrcaps.hpp"
 #include "tizdecgraphmgr.hpp"
+#include "tizunidecgraph.hpp"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
 #undef TIZ_LOG_CATEGORY_NAME
@@ -46,7 +52,8 @@ namespace graphmgr = tiz::graphmgr;
 //
 // mgr
 //
-graphmgr::decodemgr::decodemgr () : graphmgr::mgr ()
+graphmgr::decodemgr::decodemgr (const bool gapless)
+  : graphmgr::mgr (), gapless_ (gapless)
 {
   TIZ_LOG (TIZ_PRIORITY_TRACE, "Constructing...");
 }
@@ -93,3 +100,90 @@ graphmgr::decodemgrops::decodemgrops (mgr *p_mgr,
   : tiz::graphmgr::ops (p_mgr, playlist, termination_cback)
 {
 }
+
+void graphmgr::decodemgrops::do_execute ()
+{
+  const uint32_t unused_buffer_seconds = 0; // this is not used here
+
+  assert (playlist_);
+  assert (next_playlist_);
+  assert (p_mgr_);
+
+  decodemgr *p_decodemgr = dynamic_cast< decodemgr * >(p_mgr_);
+  assert (p_decodemgr);
+
+  // Mixed-format playlists are played in full by the universal decoder graph,
+  // so the graph can loop over them just like over single-format ones.
+  next_playlist_->set_loop_playback (true);
+  graph_config_.reset ();
+  graph_config_ = boost::make_shared< tiz::graph::config > (
+      next_playlist_, unused_buffer_seconds, p_decodemgr->gapless_);
+
+  if (graph_config_)
+  {
+    GMGR_OPS_BAIL_IF_ERROR (p_managed_graph_,
+                            p_managed_graph_->execute (graph_config_),
+                            "Unable to execute the graph.");
+  }
+  else
+  {
+    GMGR_OPS_RECORD_ERROR (
+        OMX_ErrorInsufficientResources,
+        "Unable to allocate the graph configuration object.");
+  }
+}
+
+tizplaylist_ptr_t graphmgr::decodemgrops::find_next_sub_list () const
+{
+  assert (playlist_);
+  if (playlist_->single_format ())
+  {
+    return tiz::graphmgr::ops::find_next_sub_list ();
+  }
+  // The universal decoder graph swaps decoders between tracks, so a
+  // mixed-format playlist is no longer split into single-format sub-lists.
+  return boost::make_shared< tiz::playlist >(playlist_->get_uri_list ());
+}
+
+tizgraph_ptr_t graphmgr::decodemgrops::get_graph (const std::string &uri)
+{
+  assert (playlist_);
+  if (playlist_->single_format ())
+  {
+    return tiz::graphmgr::ops::get_graph (uri);
+  }
+
+  tizgraph_ptr_t g_ptr;
+  const std::string encoding (tiz::graph::factory::coding_type (uri));
+  if (encoding.empty ())
+  {
+    // The caller skips this uri and tries with the next one
+    return g_ptr;
+  }
+
+  const std::string unidec_key ("unidec");
+  tizgraph_ptr_map_t::const_iterator it = graph_registry_.find (unidec_key);
+  if (it == graph_registry_.end ())
+  {
+    g_ptr = boost::make_shared< tiz::graph::unidecoder >(encoding);
+    std::pair< tizgraph_ptr_map_t::iterator, bool > rc
+        = graph_registry_.insert (std::make_pair (unidec_key, g_ptr));
+    if (rc.second)
+    {
+      g_ptr->init ();
+      g_ptr->set_manager (p_mgr_);
+    }
+    else
+    {
+      g_ptr.reset ();
+      GMGR_OPS_RECORD_ERROR (OMX_ErrorInsufficientResources,
+                             "Unable to register a new graph.");
+    }
+  }
+  else
+  {
+    g_ptr = it->second;
+  }
+
+  return g_ptr;
+}
@@ -36,6 +36,7 @@ namespace tiz
 {
   namespace graphmgr
   {
+    class decodemgrops;
     class graphmgr_capabilities;
 
     /**
@@ -45,14 +46,19 @@ namespace tiz
      */
     class decodemgr : public mgr
     {
+      friend class decodemgrops;
+
     public:
-      decodemgr ();
+      explicit decodemgr (const bool gapless = false);
       virtual ~decodemgr ();
 
     protected:
       ops *do_init (const tizplaylist_ptr_t &playlist,
                     const termination_callback_t &termination_cback,
                     graphmgr_capabilities &graphmgr_caps);
+
+    private:
+      bool gapless_;
     };
 
     typedef boost::shared_ptr< decodemgr > decodemgr_ptr_t;
@@ -62,6 +68,12 @@ namespace tiz
     public:
       decodemgrops (mgr *p_mgr, const tizplaylist_ptr_t &playlist,
                     const termination_callback_t &termination_cback);
+
+      void do_execute ();
+      tizplaylist_ptr_t find_next_sub_list () const;
+
+    protected:
+      tizgraph_ptr_t get_graph (const std::string &uri);
     };
   }  // namespace graphmgr
 }  // namespace tiz
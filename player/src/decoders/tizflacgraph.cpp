@@ -58,7 +58,7 @@ graph::flacdecoder::flacdecoder ()
 {
 }
 
-graph::ops *graph::flacdecoder::do_init ()
+graph::ops *graph::flacdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.file_reader.binary");
@@ -70,7 +70,12 @@ graph::ops *graph::flacdecoder::do_init ()
   role_list.push_back ("audio_decoder.flac");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new flacdecops (this, comp_list, role_list);
+  return new flacdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::flacdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
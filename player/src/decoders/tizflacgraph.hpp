@@ -42,6 +42,8 @@ namespace tiz
     public:
       flacdecoder ();
 
+      static ops *create_ops (graph *p_graph);
+
     protected:
       ops *do_init ();
 
@@ -57,7 +57,7 @@ graph::mp3decoder::mp3decoder ()
 {
 }
 
-graph::ops *graph::mp3decoder::do_init ()
+graph::ops *graph::mp3decoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.file_reader.binary");
@@ -69,7 +69,12 @@ graph::ops *graph::mp3decoder::do_init ()
   role_list.push_back ("audio_decoder.mp3");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new mp3decops (this, comp_list, role_list);
+  return new mp3decops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::mp3decoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -102,6 +107,11 @@ bool graph::mp3decops::is_port_settings_evt_required () const
   return need_port_settings_changed_evt_;
 }
 
+bool graph::mp3decops::is_gapless_supported () const
+{
+  return true;
+}
+
 void graph::mp3decops::do_configure ()
 {
   if (last_op_succeeded ())
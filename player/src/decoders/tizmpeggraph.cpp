@@ -57,7 +57,7 @@ graph::mpegdecoder::mpegdecoder ()
 {
 }
 
-graph::ops *graph::mpegdecoder::do_init ()
+graph::ops *graph::mpegdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.file_reader.binary");
@@ -69,7 +69,12 @@ graph::ops *graph::mpegdecoder::do_init ()
   role_list.push_back ("audio_decoder.mp2");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new mpegdecops (this, comp_list, role_list);
+  return new mpegdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::mpegdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -96,6 +101,11 @@ bool graph::mpegdecops::is_port_settings_evt_required () const
   return need_port_settings_changed_evt_;
 }
 
+bool graph::mpegdecops::is_gapless_supported () const
+{
+  return true;
+}
+
 void graph::mpegdecops::do_configure ()
 {
   G_OPS_BAIL_IF_ERROR (
@@ -58,7 +58,7 @@ graph::oggflacdecoder::oggflacdecoder ()
 {
 }
 
-graph::ops *graph::oggflacdecoder::do_init ()
+graph::ops *graph::oggflacdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.container_demuxer.ogg");
@@ -70,7 +70,12 @@ graph::ops *graph::oggflacdecoder::do_init ()
   role_list.push_back ("audio_decoder.flac");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new oggflacdecops (this, comp_list, role_list);
+  return new oggflacdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::oggflacdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
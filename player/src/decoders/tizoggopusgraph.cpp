@@ -58,7 +58,7 @@ graph::oggopusdecoder::oggopusdecoder ()
 {
 }
 
-graph::ops *graph::oggopusdecoder::do_init ()
+graph::ops *graph::oggopusdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.file_reader.binary");
@@ -70,7 +70,12 @@ graph::ops *graph::oggopusdecoder::do_init ()
   role_list.push_back ("audio_decoder.opus");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new oggopusdecops (this, comp_list, role_list);
+  return new oggopusdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::oggopusdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -97,6 +102,11 @@ bool graph::oggopusdecops::is_port_settings_evt_required () const
   return need_port_settings_changed_evt_;
 }
 
+bool graph::oggopusdecops::is_gapless_supported () const
+{
+  return true;
+}
+
 void graph::oggopusdecops::do_configure ()
 {
   G_OPS_BAIL_IF_ERROR (
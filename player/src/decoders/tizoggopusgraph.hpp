@@ -42,6 +42,8 @@ namespace tiz
     public:
       oggopusdecoder ();
 
+      static ops *create_ops (graph *p_graph);
+
     protected:
       ops *do_init ();
 
@@ -56,6 +58,7 @@ namespace tiz
     public:
       void do_probe ();
       bool is_port_settings_evt_required () const;
+      bool is_gapless_supported () const;
       void do_configure ();
       void get_pcm_codec_info (OMX_AUDIO_PARAM_PCMMODETYPE &pcmtype);
 
@@ -58,7 +58,7 @@ graph::opusdecoder::opusdecoder ()
 {
 }
 
-graph::ops *graph::opusdecoder::do_init ()
+graph::ops *graph::opusdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.container_demuxer.ogg");
@@ -70,7 +70,12 @@ graph::ops *graph::opusdecoder::do_init ()
   role_list.push_back ("audio_decoder.opus");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new opusdecops (this, comp_list, role_list);
+  return new opusdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::opusdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -57,7 +57,7 @@ graph::pcmdecoder::pcmdecoder ()
 {
 }
 
-graph::ops *graph::pcmdecoder::do_init ()
+graph::ops *graph::pcmdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.file_reader.binary");
@@ -69,7 +69,12 @@ graph::ops *graph::pcmdecoder::do_init ()
   role_list.push_back ("audio_decoder.pcm");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new pcmdecops (this, comp_list, role_list);
+  return new pcmdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::pcmdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -96,6 +101,11 @@ bool graph::pcmdecops::is_port_settings_evt_required () const
   return need_port_settings_changed_evt_;
 }
 
+bool graph::pcmdecops::is_gapless_supported () const
+{
+  return true;
+}
+
 void graph::pcmdecops::do_configure ()
 {
   if (last_op_succeeded ())
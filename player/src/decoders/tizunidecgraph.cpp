@@ -0,0 +1,399 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizunidecgraph.cpp
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  OpenMAX IL universal decoder graph implementation
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <boost/make_shared.hpp>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <tizplatform.h>
+
+#include "tizgraphutil.hpp"
+#include "tizgraphcback.hpp"
+#include "tizgraphfactory.hpp"
+#include "tizprobe.hpp"
+#include "tizunidecgraph.hpp"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.play.graph.unidecoder"
+#endif
+
+namespace graph = tiz::graph;
+
+//
+// unidecoder
+//
+graph::unidecoder::unidecoder (const std::string &encoding)
+  : tiz::graph::decoder ("unidecgraph"), encoding_ (encoding)
+{
+}
+
+graph::ops *graph::unidecoder::do_init ()
+{
+  return new unidecops (this, encoding_);
+}
+
+//
+// unidecops
+//
+graph::unidecops::unidecops (graph *p_graph, const std::string &encoding)
+  : tiz::graph::decops (p_graph, omx_comp_name_lst_t (),
+                        omx_comp_role_lst_t ()),
+    encoding_ (encoding),
+    p_codec_ops_ (NULL),
+    codec_ops_ (),
+    spare_comps_ ()
+{
+  // The source and the decoder are those of the per-codec graph for the
+  // initial encoding. The renderer is common to all of them.
+  p_codec_ops_ = get_codec_ops (encoding_);
+  assert (p_codec_ops_);
+  const omx_comp_name_lst_t &comp_lst = p_codec_ops_->get_comp_list ();
+  const omx_comp_role_lst_t &role_lst = p_codec_ops_->get_role_list ();
+  assert (comp_lst.size () == 3 && role_lst.size () == 3);
+  comp_lst_.assign (comp_lst.begin (), comp_lst.begin () + 2);
+  role_lst_.assign (role_lst.begin (), role_lst.begin () + 2);
+  comp_lst_.push_back (tiz::graph::util::get_default_pcm_renderer ());
+  role_lst_.push_back ("audio_renderer.pcm");
+}
+
+graph::unidecops::~unidecops ()
+{
+  codec_ops_map_t::iterator it = codec_ops_.begin ();
+  for (; it != codec_ops_.end (); ++it)
+  {
+    delete it->second;
+  }
+}
+
+void graph::unidecops::do_disable_comp_ports (const int /* comp_id */,
+                                              const int /* port_id */)
+{
+  // The graph was loaded with the chain of the first track in the list, but
+  // that track may have been removed since.
+  (void)select_codec ();
+  clear_expected_port_transitions ();
+  if (last_op_succeeded () && !playlist_->empty ()
+      && p_codec_ops_->is_disabled_evt_required ())
+  {
+    const OMX_U32 demuxers_video_port = 1;
+    G_OPS_BAIL_IF_ERROR (
+        disable_port_if_enabled (0, demuxers_video_port, true),
+        "Unable to disable demuxer's video port.");
+  }
+}
+
+void graph::unidecops::do_probe ()
+{
+  if (last_op_succeeded () && !playlist_->empty ())
+  {
+    // This only swaps the chain when a track is skipped while configuring the
+    // graph. The components are in OMX_StateLoaded then, so the port commands
+    // are not waited for: they are processed before the transition to Idle.
+    if (select_codec () && !playlist_->empty ())
+    {
+      if (p_codec_ops_->is_disabled_evt_required ())
+      {
+        G_OPS_BAIL_IF_ERROR (disable_port_if_enabled (0, 1, false),
+                             "Unable to disable demuxer's video port.");
+      }
+      G_OPS_BAIL_IF_ERROR (enable_port_if_disabled (1, 1),
+                           "Unable to enable the decoder's output port.");
+    }
+
+    if (last_op_succeeded () && !playlist_->empty ())
+    {
+      lend_state (*p_codec_ops_);
+      p_codec_ops_->do_probe ();
+      reclaim_state (*p_codec_ops_);
+    }
+  }
+}
+
+void graph::unidecops::do_configure ()
+{
+  if (last_op_succeeded () && !playlist_->empty ())
+  {
+    lend_state (*p_codec_ops_);
+    p_codec_ops_->do_configure ();
+    reclaim_state (*p_codec_ops_);
+  }
+}
+
+void graph::unidecops::do_swap_decoder ()
+{
+  // The renderer's input port was disabled before it could report the EOS of
+  // any buffers still in flight.
+  stale_eos_count_ = 0;
+
+  (void)select_codec ();
+  clear_expected_port_transitions ();
+  if (last_op_succeeded () && !playlist_->empty ())
+  {
+    // The decoder's output port needs to be disabled, like the renderer's
+    // input port, before the tunnel between them can be enabled again.
+    const OMX_U32 decoders_output_port = 1;
+    G_OPS_BAIL_IF_ERROR (
+        disable_port_if_enabled (1, decoders_output_port, true),
+        "Unable to disable the decoder's output port.");
+    if (p_codec_ops_->is_disabled_evt_required ())
+    {
+      const OMX_U32 demuxers_video_port = 1;
+      G_OPS_BAIL_IF_ERROR (
+          disable_port_if_enabled (0, demuxers_video_port, true),
+          "Unable to disable demuxer's video port.");
+    }
+  }
+}
+
+void graph::unidecops::do_destroy_graph ()
+{
+  spare_comp_map_t::iterator it = spare_comps_.begin ();
+  for (; it != spare_comps_.end (); ++it)
+  {
+    OMX_FreeHandle (it->second);
+  }
+  spare_comps_.clear ();
+  tiz::graph::ops::do_destroy_graph ();
+}
+
+bool graph::unidecops::is_port_settings_evt_required () const
+{
+  return p_codec_ops_->is_port_settings_evt_required ();
+}
+
+bool graph::unidecops::is_disabled_evt_required () const
+{
+  return !expected_port_transitions_lst_.empty ();
+}
+
+bool graph::unidecops::is_gapless_supported () const
+{
+  // Gapless switches are only possible between tracks of the same format,
+  // see is_gapless_eos.
+  return p_codec_ops_->is_gapless_supported ();
+}
+
+bool graph::unidecops::is_decoder_swap_supported () const
+{
+  return true;
+}
+
+graph::ops *graph::unidecops::get_codec_ops (const std::string &encoding)
+{
+  ops *p_ops = NULL;
+  codec_ops_map_t::const_iterator it = codec_ops_.find (encoding);
+  if (it != codec_ops_.end ())
+  {
+    p_ops = it->second;
+  }
+  else
+  {
+    p_ops = tiz::graph::factory::create_ops (p_graph_, encoding);
+    if (p_ops)
+    {
+      codec_ops_.insert (std::make_pair (encoding, p_ops));
+    }
+  }
+  return p_ops;
+}
+
+bool graph::unidecops::select_codec ()
+{
+  bool swapped = false;
+  assert (playlist_);
+
+  while (last_op_succeeded () && !playlist_->empty ())
+  {
+    const int current_index = playlist_->current_index ();
+    const std::string uri = playlist_->get_current_uri ();
+
+    // The probe is kept so that probe_stream does not need to repeat it
+    if (!next_probe_ptr_ || next_probe_ptr_->get_uri () != uri)
+    {
+      const bool quiet_probing = true;
+      next_probe_ptr_ = boost::make_shared< tiz::probe >(uri, quiet_probing);
+    }
+
+    const std::string encoding
+        = tiz::graph::factory::coding_type (next_probe_ptr_);
+    if (encoding == encoding_)
+    {
+      break;
+    }
+
+    ops *p_codec_ops = encoding.empty () ? NULL : get_codec_ops (encoding);
+    if (p_codec_ops
+        && OMX_ErrorNone == swap_chain (encoding, p_codec_ops))
+    {
+      swapped = true;
+      break;
+    }
+
+    // No chain can play this uri. Remove it from the playlist so that we
+    // don't attempt its playback again.
+    tiz::graph::util::dump_graph_info ("Unknown format", "skipping", uri);
+    next_probe_ptr_.reset ();
+    playlist_->erase_uri (current_index);
+    playlist_->set_index (current_index);
+  }
+
+  return swapped;
+}
+
+OMX_ERRORTYPE
+graph::unidecops::swap_chain (const std::string &encoding,
+                              ops *p_codec_ops)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  const omx_comp_name_lst_t &comp_lst = p_codec_ops->get_comp_list ();
+  const omx_comp_role_lst_t &role_lst = p_codec_ops->get_role_list ();
+  assert (handles_.size () == 3);
+  assert (comp_lst.size () == 3 && role_lst.size () == 3);
+
+  TIZ_LOG (TIZ_PRIORITY_NOTICE, "Swapping chain [%s] -> [%s]",
+           encoding_.c_str (), encoding.c_str ());
+
+  // Acquire the new components before anything is torn down, so that a
+  // failure leaves the current chain intact.
+  OMX_HANDLETYPE new_handles[2] = {NULL, NULL};
+  for (int i = 0; i < 2 && OMX_ErrorNone == rc; ++i)
+  {
+    if (role_lst[i] != role_lst_[i])
+    {
+      rc = acquire_comp (comp_lst[i], role_lst[i], new_handles[i]);
+    }
+  }
+
+  if (OMX_ErrorNone != rc)
+  {
+    for (int i = 0; i < 2; ++i)
+    {
+      if (new_handles[i])
+      {
+        spare_comps_[role_lst[i]] = new_handles[i];
+        h2n_.erase (new_handles[i]);
+      }
+    }
+    return rc;
+  }
+
+  tiz_check_omx (tiz::graph::util::tear_down_tunnels (handles_));
+
+  for (int i = 0; i < 2; ++i)
+  {
+    if (new_handles[i])
+    {
+      // Park the old component, in OMX_StateLoaded, for later reuse
+      spare_comps_[role_lst_[i]] = handles_[i];
+      h2n_.erase (handles_[i]);
+      handles_[i] = new_handles[i];
+      comp_lst_[i] = comp_lst[i];
+      role_lst_[i] = role_lst[i];
+    }
+  }
+
+  tiz_check_omx (tiz::graph::util::setup_suppliers (handles_));
+  tiz_check_omx (tiz::graph::util::setup_tunnels (handles_));
+
+  encoding_ = encoding;
+  p_codec_ops_ = p_codec_ops;
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+graph::unidecops::acquire_comp (const std::string &comp_name,
+                                const std::string &comp_role,
+                                OMX_HANDLETYPE &handle)
+{
+  spare_comp_map_t::iterator it = spare_comps_.find (comp_role);
+  if (it != spare_comps_.end ())
+  {
+    handle = it->second;
+    spare_comps_.erase (it);
+    h2n_[handle] = comp_name;
+    return OMX_ErrorNone;
+  }
+
+  omx_comp_handle_lst_t hdl_list (1, OMX_HANDLETYPE (NULL));
+  tiz::graph::cbackhandler &cbacks = get_cback_handler ();
+  tiz_check_omx (tiz::graph::util::instantiate_component (
+      comp_name, 0, &(cbacks), cbacks.get_omx_cbacks (), hdl_list, h2n_));
+  handle = hdl_list[0];
+
+  const OMX_ERRORTYPE rc = tiz::graph::util::set_role (handle, comp_role);
+  if (OMX_ErrorNone != rc)
+  {
+    h2n_.erase (handle);
+    tiz::graph::util::destroy_list (hdl_list);
+    handle = NULL;
+  }
+  return rc;
+}
+
+OMX_ERRORTYPE
+graph::unidecops::disable_port_if_enabled (const int comp_id,
+                                           const OMX_U32 port_id,
+                                           const bool expect_event)
+{
+  if (is_port_enabled (comp_id, port_id))
+  {
+    tiz_check_omx (tiz::graph::util::disable_port (handles_[comp_id], port_id));
+    if (expect_event)
+    {
+      add_expected_port_transition (handles_[comp_id], port_id,
+                                    OMX_CommandPortDisable);
+    }
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+graph::unidecops::enable_port_if_disabled (const int comp_id,
+                                           const OMX_U32 port_id)
+{
+  if (!is_port_enabled (comp_id, port_id))
+  {
+    tiz_check_omx (tiz::graph::util::enable_port (handles_[comp_id], port_id));
+  }
+  return OMX_ErrorNone;
+}
+
+bool graph::unidecops::is_port_enabled (const int comp_id,
+                                        const OMX_U32 port_id) const
+{
+  OMX_PARAM_PORTDEFINITIONTYPE portdef;
+  TIZ_INIT_OMX_PORT_STRUCT (portdef, port_id);
+  return (OMX_ErrorNone == OMX_GetParameter (handles_[comp_id],
+                                             OMX_IndexParamPortDefinition,
+                                             &portdef)
+          && OMX_TRUE == portdef.bEnabled);
+}
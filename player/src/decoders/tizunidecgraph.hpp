@@ -0,0 +1,104 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizunidecgraph.hpp
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  OpenMAX IL universal decoder graph
+ *
+ * A decoder graph for mixed-format playlists. The source and the decoder are
+ * replaced between tracks of different formats while the renderer keeps
+ * running.
+ *
+ */
+
+#ifndef TIZUNIDECGRAPH_HPP
+#define TIZUNIDECGRAPH_HPP
+
+#include <map>
+#include <string>
+
+#include "tizdecgraph.hpp"
+#include "tizgraphops.hpp"
+
+namespace tiz
+{
+  namespace graph
+  {
+    class unidecoder : public decoder
+    {
+
+    public:
+      explicit unidecoder (const std::string &encoding);
+
+    protected:
+      ops *do_init ();
+
+    private:
+      std::string encoding_;
+    };
+
+    class unidecops : public decops
+    {
+    public:
+      unidecops (graph *p_graph, const std::string &encoding);
+      ~unidecops ();
+
+    public:
+      void do_disable_comp_ports (const int comp_id, const int port_id);
+      void do_probe ();
+      void do_configure ();
+      void do_swap_decoder ();
+      void do_destroy_graph ();
+
+      bool is_port_settings_evt_required () const;
+      bool is_disabled_evt_required () const;
+      bool is_gapless_supported () const;
+      bool is_decoder_swap_supported () const;
+
+    private:
+      ops *get_codec_ops (const std::string &encoding);
+      bool select_codec ();
+      OMX_ERRORTYPE swap_chain (const std::string &encoding,
+                                ops *p_codec_ops);
+      OMX_ERRORTYPE acquire_comp (const std::string &comp_name,
+                                  const std::string &comp_role,
+                                  OMX_HANDLETYPE &handle);
+      OMX_ERRORTYPE disable_port_if_enabled (const int comp_id,
+                                             const OMX_U32 port_id,
+                                             const bool expect_event);
+      OMX_ERRORTYPE enable_port_if_disabled (const int comp_id,
+                                             const OMX_U32 port_id);
+      bool is_port_enabled (const int comp_id, const OMX_U32 port_id) const;
+
+    private:
+      typedef std::map< std::string, ops * > codec_ops_map_t;
+      typedef std::map< std::string, OMX_HANDLETYPE > spare_comp_map_t;
+
+    private:
+      std::string encoding_;
+      ops *p_codec_ops_;            // Owned, via codec_ops_
+      codec_ops_map_t codec_ops_;   // encoding -> ops of a per-codec graph
+      spare_comp_map_t spare_comps_;  // role -> component in OMX_StateLoaded
+    };
+  }  // namespace graph
+}  // namespace tiz
+
+#endif  // TIZUNIDECGRAPH_HPP
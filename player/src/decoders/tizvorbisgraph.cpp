@@ -53,7 +53,7 @@ graph::vorbisdecoder::vorbisdecoder () : tiz::graph::decoder ("vorbisdecgraph")
 {
 }
 
-graph::ops *graph::vorbisdecoder::do_init ()
+graph::ops *graph::vorbisdecoder::create_ops (graph *p_graph)
 {
   omx_comp_name_lst_t comp_list;
   comp_list.push_back ("OMX.Aratelia.container_demuxer.ogg");
@@ -65,7 +65,12 @@ graph::ops *graph::vorbisdecoder::do_init ()
   role_list.push_back ("audio_decoder.vorbis");
   role_list.push_back ("audio_renderer.pcm");
 
-  return new vorbisdecops (this, comp_list, role_list);
+  return new vorbisdecops (p_graph, comp_list, role_list);
+}
+
+graph::ops *graph::vorbisdecoder::do_init ()
+{
+  return create_ops (this);
 }
 
 //
@@ -105,6 +110,11 @@ bool graph::vorbisdecops::is_port_settings_evt_required () const
   return need_port_settings_changed_evt_;
 }
 
+bool graph::vorbisdecops::is_gapless_supported () const
+{
+  return true;
+}
+
 bool graph::vorbisdecops::is_disabled_evt_required () const
 {
   return true;
@@ -42,6 +42,8 @@ namespace tiz
     public:
       vorbisdecoder ();
 
+      static ops *create_ops (graph *p_graph);
+
     protected:
       ops *do_init ();
     };
@@ -56,6 +58,7 @@ namespace tiz
       void do_disable_comp_ports (const int comp_id, const int port_id);
       void do_probe ();
       bool is_port_settings_evt_required () const;
+      bool is_gapless_supported () const;
       bool is_disabled_evt_required () const;
       void do_configure ();
 
@@ -151,8 +151,7 @@ graph::httpservops::configure_server ()
       = boost::dynamic_pointer_cast< httpservconfig >(config_);
   assert (srv_config);
   httpsrv.nListeningPort = srv_config->get_port ();
-  httpsrv.nMaxClients = 1;  // the http renderer component supports only one
-  // client, for now
+  // nMaxClients is left as configured in the component
 
   return OMX_SetParameter (
       handles_[1],
@@ -195,7 +194,6 @@ graph::httpservops::configure_station ()
            mount.nIcyMetadataPeriod);
 
   mount.eEncoding = OMX_AUDIO_CodingMP3;
-  mount.nMaxClients = 1;
   return OMX_SetParameter (
       handles_[1],
       static_cast< OMX_INDEXTYPE >(OMX_TizoniaIndexParamIcecastMountpoint),
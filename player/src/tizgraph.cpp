@@ -37,10 +37,10 @@
 #include <OMX_Core.h>
 #include <OMX_Component.h>
 
+#include "tizgraphfsm.hpp"
 #include "tizprogressdisplay.hpp"
 #include "tizgraphmgr.hpp"
 #include "tizgraphcmd.hpp"
-#include "tizgraphfsm.hpp"
 #include "tizgraph.hpp"
 
 #ifdef TIZ_LOG_CATEGORY_NAME
@@ -100,6 +100,45 @@ namespace tiz
       }
     };
 
+    struct do_probe_next
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_probe_next ();
+        }
+      }
+    };
+
+    struct do_record_gapless_switch
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_record_gapless_switch ();
+        }
+      }
+    };
+
+    struct do_discard_stale_eos
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_discard_stale_eos ();
+        }
+      }
+    };
+
     struct do_load
     {
       template < class FSM, class EVT, class SourceState, class TargetState >
@@ -459,6 +498,20 @@ namespace tiz
       }
     };
 
+    template<int tunnel_id>
+    struct do_exe2idle_tunnel
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const&, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_exe2idle_tunnel (tunnel_id);
+        }
+      }
+    };
+
     struct do_store_skip
     {
       template < class FSM, class EVT, class SourceState, class TargetState >
@@ -499,6 +552,33 @@ namespace tiz
       }
     };
 
+    template<int tunnel_id>
+    struct do_idle2loaded_tunnel
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const&, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_idle2loaded_tunnel (tunnel_id);
+        }
+      }
+    };
+
+    struct do_swap_decoder
+    {
+      template < class FSM, class EVT, class SourceState, class TargetState >
+      void operator()(EVT const&, FSM& fsm, SourceState&, TargetState&)
+      {
+        G_ACTION_LOG ();
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          (*(fsm.pp_ops_))->do_swap_decoder ();
+        }
+      }
+    };
+
     template<int comp_id, int port_id>
     struct do_disable_comp_ports
     {
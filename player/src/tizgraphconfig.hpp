@@ -44,8 +44,12 @@ namespace tiz
     {
 
     public:
-      explicit config (const tizplaylist_ptr_t &playlist, const uint32_t buffer_seconds)
-        : playlist_ (playlist), buffer_seconds_ (buffer_seconds)
+      explicit config (const tizplaylist_ptr_t &playlist,
+                       const uint32_t buffer_seconds,
+                       const bool gapless = false)
+        : playlist_ (playlist),
+          buffer_seconds_ (buffer_seconds),
+          gapless_ (gapless)
       {
       }
 
@@ -63,9 +67,15 @@ namespace tiz
         return buffer_seconds_;
       }
 
+      bool gapless () const
+      {
+        return gapless_;
+      }
+
     protected:
       tizplaylist_ptr_t playlist_;
       uint32_t buffer_seconds_;
+      bool gapless_;
     };
 
   }  // namespace graph
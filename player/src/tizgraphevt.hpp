@@ -103,6 +103,32 @@ namespace tiz
       }
     };
 
+    // Make this state convertible from any state (this event exits a
+    // sub-machine)
+    struct switched_evt
+    {
+      switched_evt ()
+      {
+      }
+      template < class Event >
+      switched_evt (Event const &)
+      {
+      }
+    };
+
+    // Make this state convertible from any state (this event exits a
+    // sub-machine)
+    struct swapped_evt
+    {
+      swapped_evt ()
+      {
+      }
+      template < class Event >
+      swapped_evt (Event const &)
+      {
+      }
+    };
+
     struct seek_evt
     {
     };
@@ -120,9 +120,14 @@ tizgraph_ptr_t graph::factory::create_graph (const std::string &uri)
 
 std::string graph::factory::coding_type (const std::string &uri)
 {
-  tizprobe_ptr_t p = boost::make_shared< tiz::probe >(uri,
-                                                      /* quiet = */ true);
-  tizgraph_ptr_t null_ptr;
+  return coding_type (boost::make_shared< tiz::probe >(uri,
+                                                       /* quiet = */ true));
+}
+
+std::string graph::factory::coding_type (const tizprobe_ptr_t &p)
+{
+  assert (p);
+  const std::string uri = p->get_uri ();
   TIZ_LOG (TIZ_PRIORITY_DEBUG, "uri : %s", uri.c_str ());
   TIZ_LOG (TIZ_PRIORITY_DEBUG, "domain : %s",
            tiz_domain_to_str (p->get_omx_domain ()));
@@ -174,3 +179,43 @@ std::string graph::factory::coding_type (const std::string &uri)
   }
   return std::string ();
 }
+
+graph::ops *graph::factory::create_ops (graph *p_graph,
+                                        const std::string &encoding)
+{
+  // These are the operations of the graphs created in create_graph, for use
+  // by graphs that can switch between formats.
+  if (encoding == "mp2")
+  {
+    return tiz::graph::mpegdecoder::create_ops (p_graph);
+  }
+  else if (encoding == "mp3")
+  {
+    return tiz::graph::mp3decoder::create_ops (p_graph);
+  }
+  else if (encoding == "aac")
+  {
+    return tiz::graph::aacdecoder::create_ops (p_graph);
+  }
+  else if (encoding == "opus")
+  {
+    return tiz::graph::oggopusdecoder::create_ops (p_graph);
+  }
+  else if (encoding == "oggflac")
+  {
+    return tiz::graph::oggflacdecoder::create_ops (p_graph);
+  }
+  else if (encoding == "flac")
+  {
+    return tiz::graph::flacdecoder::create_ops (p_graph);
+  }
+  else if (encoding == "vorbis")
+  {
+    return tiz::graph::vorbisdecoder::create_ops (p_graph);
+  }
+  else if (encoding == "pcm")
+  {
+    return tiz::graph::pcmdecoder::create_ops (p_graph);
+  }
+  return NULL;
+}
@@ -41,12 +41,18 @@ namespace tiz
 {
   namespace graph
   {
+    // Forward declarations
+    class graph;
+    class ops;
+
     class factory : boost::noncopyable
     {
 
     public:
       static tizgraph_ptr_t create_graph (const std::string &uri);
       static std::string coding_type (const std::string &uri);
+      static std::string coding_type (const tizprobe_ptr_t &probe);
+      static ops *create_ops (graph *p_graph, const std::string &encoding);
     };
   }  // namespace graph
 }  // namespace tiz
@@ -29,8 +29,8 @@
 #define TIZGRAPHFSM_HPP
 
 #define BOOST_MPL_CFG_NO_PREPROCESSED_HEADERS
-#define BOOST_MPL_LIMIT_VECTOR_SIZE 40
-#define FUSION_MAX_VECTOR_SIZE      20
+#define BOOST_MPL_LIMIT_VECTOR_SIZE 50
+#define FUSION_MAX_VECTOR_SIZE      30
 #define SPIRIT_ARGUMENTS_LIMIT      20
 
 #include <sys/time.h>
@@ -73,6 +73,8 @@ namespace tiz
                                                "configuring",
                                                "executing",
                                                "skipping",
+                                               "switching",
+                                               "swapping",
                                                "exe2pause",
                                                "pause",
                                                "pause2exe",
@@ -89,6 +91,8 @@ namespace tiz
     {
       // no need for exception handling
       typedef int no_exception_thrown;
+      // require deferred events capability
+      typedef int activate_deferred_events;
 
       // data members
       ops ** pp_ops_;
@@ -274,6 +278,270 @@ namespace tiz
       // typedef boost::msm::back::state_machine<skipping_, boost::msm::back::mpl_graph_fsm_check> skipping;
       typedef boost::msm::back::state_machine<skipping_> skipping;
 
+      /* 'switching' is a submachine */
+      struct switching_ : public boost::msm::front::state_machine_def<switching_>
+      {
+        // no need for exception handling
+        typedef int no_exception_thrown;
+        // require deferred events capability
+        typedef int activate_deferred_events;
+
+        // data members
+        ops ** pp_ops_;
+
+        switching_()
+          :
+          pp_ops_(NULL)
+        {}
+        switching_(ops **pp_ops)
+          :
+          pp_ops_(pp_ops)
+        {
+          assert (pp_ops);
+        }
+
+        // submachine states
+        struct switch_exit : public boost::msm::front::exit_pseudo_state<switched_evt>
+        {
+          template <class Event,class FSM>
+          void on_entry(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+        };
+
+        // the initial state. Must be defined
+        typedef disabling_tunnel initial_state;
+
+        // transition actions
+
+        // guard conditions
+
+        // Transition table for switching. Only the source component is taken
+        // back to Loaded; the decoder and the renderer remain in Executing.
+        struct transition_table : boost::mpl::vector<
+          //                       Start             Event                   Next               Action                                 Guard
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < disabling_tunnel  , skip_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < disabling_tunnel  , pause_evt             , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < disabling_tunnel  , stop_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < disabling_tunnel  , omx_port_disabled_evt , exe2idle         , do_exe2idle_comp<0>                  , is_port_disabling_complete >,
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < exe2idle          , skip_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < exe2idle          , pause_evt             , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < exe2idle          , stop_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < exe2idle          , omx_trans_evt         , idle2loaded      , do_idle2loaded_comp<0>               , is_trans_complete          >,
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < idle2loaded       , skip_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < idle2loaded       , pause_evt             , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < idle2loaded       , stop_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < idle2loaded       , omx_trans_evt         , config2idle      , boost::msm::front::ActionSequence_<
+                                                                                                    boost::mpl::vector<
+                                                                                                      do_skip,
+                                                                                                      do_probe,
+                                                                                                      do_configure_comp<0>,
+                                                                                                      do_loaded2idle_comp<0> > >    , is_trans_complete          >,
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < config2idle       , skip_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < config2idle       , pause_evt             , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < config2idle       , stop_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < config2idle       , omx_trans_evt         , idle2exe         , do_idle2exe_comp<0>                  , is_trans_complete          >,
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < idle2exe          , skip_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < idle2exe          , pause_evt             , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < idle2exe          , stop_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < idle2exe          , omx_trans_evt         , enabling_tunnel  , do_enable_tunnel<0>                  , is_trans_complete          >,
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < enabling_tunnel   , skip_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < enabling_tunnel   , pause_evt             , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < enabling_tunnel   , stop_evt              , boost::msm::front::none , boost::msm::front::Defer        >,
+          boost::msm::front::Row < enabling_tunnel   , omx_port_enabled_evt  , switch_exit      , boost::msm::front::none              , is_port_enabling_complete  >
+          //    +-----------------+------------------+-----------------------+------------------+--------------------------------------+----------------------------+
+          > {};
+
+        // Replaces the default no-transition response.
+        template <class FSM,class Event>
+        void no_transition(Event const& e, FSM&,int state)
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR, "no transition from state %d on event %s",
+                   state, typeid(e).name());
+        }
+
+      };
+      // typedef boost::msm::back::state_machine<switching_, boost::msm::back::mpl_graph_fsm_check> switching;
+      typedef boost::msm::back::state_machine<switching_> switching;
+
+      /* 'swapping' is a submachine */
+      struct swapping_ : public boost::msm::front::state_machine_def<swapping_>
+      {
+        // no need for exception handling
+        typedef int no_exception_thrown;
+        // require deferred events capability
+        typedef int activate_deferred_events;
+
+        // data members
+        ops ** pp_ops_;
+
+        swapping_()
+          :
+          pp_ops_(NULL)
+        {}
+        swapping_(ops **pp_ops)
+          :
+          pp_ops_(pp_ops)
+        {
+          assert (pp_ops);
+        }
+
+        // submachine states
+        struct selecting_decoder : public boost::msm::front::state<>
+        {
+          template <class Event,class FSM>
+          void on_entry(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+          template <class Event,class FSM>
+          void on_exit(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+        };
+
+        struct probing : public boost::msm::front::state<>
+        {
+          template <class Event,class FSM>
+          void on_entry(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+          template <class Event,class FSM>
+          void on_exit(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+        };
+
+        struct stopping_renderer : public boost::msm::front::state<>
+        {
+          template <class Event,class FSM>
+          void on_entry(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+          template <class Event,class FSM>
+          void on_exit(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+          OMX_STATETYPE target_omx_state () const
+          {
+            return OMX_StateIdle;
+          }
+        };
+
+        struct unloading_renderer : public boost::msm::front::state<>
+        {
+          template <class Event,class FSM>
+          void on_entry(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+          template <class Event,class FSM>
+          void on_exit(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+          OMX_STATETYPE target_omx_state () const
+          {
+            return OMX_StateLoaded;
+          }
+        };
+
+        struct swap_exit : public boost::msm::front::exit_pseudo_state<swapped_evt>
+        {
+          template <class Event,class FSM>
+          void on_entry(Event const & evt, FSM & fsm) {G_FSM_LOG();}
+        };
+
+        // the initial state. Must be defined
+        typedef disabling_tunnel initial_state;
+
+        // transition actions
+
+        // guard conditions
+
+        // Transition table for swapping. The renderer remains in Executing
+        // with its input port disabled, while the source and the decoder are
+        // taken back to Loaded and replaced with the ones the next track needs.
+        // The renderer is only stopped when the end of the playlist is reached.
+        struct transition_table : boost::mpl::vector<
+          //                       Start                       Event                   Next                        Action                                 Guard
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < disabling_tunnel            , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < disabling_tunnel            , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < disabling_tunnel            , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < disabling_tunnel            , omx_port_disabled_evt , exe2idle                  , do_exe2idle_tunnel<0>                , is_port_disabling_complete >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < exe2idle                    , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < exe2idle                    , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < exe2idle                    , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < exe2idle                    , omx_trans_evt         , idle2loaded               , do_idle2loaded_tunnel<0>             , is_trans_complete          >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < idle2loaded                 , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < idle2loaded                 , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < idle2loaded                 , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < idle2loaded                 , omx_trans_evt         , selecting_decoder         , boost::msm::front::ActionSequence_<
+                                                                                                                       boost::mpl::vector<
+                                                                                                                         do_skip,
+                                                                                                                         do_swap_decoder > >    , is_trans_complete          >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < selecting_decoder           , boost::msm::front::none , awaiting_port_disabled_evt , boost::msm::front::none           , is_disabled_evt_required   >,
+          boost::msm::front::Row < selecting_decoder           , boost::msm::front::none , probing                 , do_probe                             , boost::msm::front::euml::Not_<
+                                                                                                                                                              is_disabled_evt_required > >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < awaiting_port_disabled_evt  , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < awaiting_port_disabled_evt  , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < awaiting_port_disabled_evt  , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < awaiting_port_disabled_evt  , omx_port_disabled_evt , probing                   , do_probe                             , is_port_disabling_complete >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < probing                     , boost::msm::front::none , awaiting_port_settings_evt , boost::msm::front::none           , is_port_settings_evt_required >,
+          boost::msm::front::Row < probing                     , boost::msm::front::none , config2idle             , boost::msm::front::ActionSequence_<
+                                                                                                                       boost::mpl::vector<
+                                                                                                                         do_configure,
+                                                                                                                         do_loaded2idle_tunnel<0> > > , boost::msm::front::euml::Not_<
+                                                                                                                                                              is_port_settings_evt_required > >,
+          boost::msm::front::Row < probing                     , boost::msm::front::none , stopping_renderer       , do_exe2idle_comp<2>                  , is_end_of_play             >,
+          boost::msm::front::Row < probing                     , boost::msm::front::none , selecting_decoder       , boost::msm::front::ActionSequence_<
+                                                                                                                       boost::mpl::vector<
+                                                                                                                         do_reset_internal_error,
+                                                                                                                         do_skip,
+                                                                                                                         do_swap_decoder > >    , boost::msm::front::euml::And_<
+                                                                                                                                                              boost::msm::front::euml::Not_<
+                                                                                                                                                                is_end_of_play >,
+                                                                                                                                                              boost::msm::front::euml::Not_<
+                                                                                                                                                                is_probing_result_ok > > >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < stopping_renderer           , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < stopping_renderer           , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < stopping_renderer           , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < stopping_renderer           , omx_trans_evt         , unloading_renderer        , do_idle2loaded_comp<2>               , is_trans_complete          >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < unloading_renderer          , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < unloading_renderer          , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < unloading_renderer          , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < unloading_renderer          , omx_trans_evt         , swap_exit                 , boost::msm::front::none              , is_trans_complete          >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < awaiting_port_settings_evt  , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < awaiting_port_settings_evt  , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < awaiting_port_settings_evt  , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < awaiting_port_settings_evt  , omx_port_settings_evt , config2idle               , boost::msm::front::ActionSequence_<
+                                                                                                                       boost::mpl::vector<
+                                                                                                                         do_configure,
+                                                                                                                         do_loaded2idle_tunnel<0> > >             >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < config2idle                 , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < config2idle                 , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < config2idle                 , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < config2idle                 , omx_trans_evt         , idle2exe                  , do_idle2exe_tunnel<0>                , is_trans_complete          >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < idle2exe                    , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < idle2exe                    , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < idle2exe                    , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < idle2exe                    , omx_trans_evt         , enabling_tunnel           , do_enable_tunnel<1>                  , is_trans_complete          >,
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          boost::msm::front::Row < enabling_tunnel             , skip_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < enabling_tunnel             , pause_evt             , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < enabling_tunnel             , stop_evt              , boost::msm::front::none   , boost::msm::front::Defer             >,
+          boost::msm::front::Row < enabling_tunnel             , omx_port_enabled_evt  , swap_exit                 , boost::msm::front::none              , is_port_enabling_complete  >
+          //    +-----------------+----------------------------+-----------------------+---------------------------+--------------------------------------+----------------------------+
+          > {};
+
+        // Replaces the default no-transition response.
+        template <class FSM,class Event>
+        void no_transition(Event const& e, FSM&,int state)
+        {
+          TIZ_LOG (TIZ_PRIORITY_ERROR, "no transition from state %d on event %s",
+                   state, typeid(e).name());
+        }
+
+      };
+      // typedef boost::msm::back::state_machine<swapping_, boost::msm::back::mpl_graph_fsm_check> swapping;
+      typedef boost::msm::back::state_machine<swapping_> swapping;
+
       // The initial state of the SM. Must be defined
       typedef boost::mpl::vector<inited, AllOk> initial_state;
 
@@ -306,7 +574,8 @@ namespace tiz
                                                                                              boost::mpl::vector<
                                                                                                do_retrieve_metadata,
                                                                                                do_ack_execd,
-                                                                                               do_start_progress_display> >               >,
+                                                                                               do_start_progress_display,
+                                                                                               do_probe_next> >                           >,
         boost::msm::front::Row < configuring
                                  ::exit_pt
                                  <configuring_
@@ -316,7 +585,12 @@ namespace tiz
                                                                                                do_tear_down_tunnels,
                                                                                                do_destroy_graph> > , is_end_of_play       >,
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
-        boost::msm::front::Row < executing   , skip_evt        , skipping                , do_store_skip                                  >,
+        boost::msm::front::Row < executing   , skip_evt        , skipping                , do_store_skip           , boost::msm::front::euml::Not_<
+                                                                                                                       is_decoder_swap_supported> >,
+        boost::msm::front::Row < executing   , skip_evt        , swapping                , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_store_skip,
+                                                                                               do_disable_tunnel<1> > > , is_decoder_swap_supported >,
         boost::msm::front::Row < executing   , seek_evt        , boost::msm::front::none , do_seek                                        >,
         boost::msm::front::Row < executing   , volume_step_evt , boost::msm::front::none , do_volume_step                                 >,
         boost::msm::front::Row < executing   , volume_evt      , boost::msm::front::none , do_volume                                      >,
@@ -327,9 +601,31 @@ namespace tiz
                                                                                                do_record_destination < OMX_StateIdle >,
                                                                                                do_exe2idle> >                         >,
         boost::msm::front::Row < executing   , unload_evt      , exe2idle                , do_exe2idle                                >,
-        boost::msm::front::Row < executing   , omx_err_evt     , skipping                , boost::msm::front::none                        >,
+        boost::msm::front::Row < executing   , omx_err_evt     , skipping                , boost::msm::front::none , boost::msm::front::euml::Not_<
+                                                                                                                       is_decoder_swap_supported> >,
         boost::msm::front::Row < executing   , omx_err_evt     , skipping                , do_record_fatal_error   , is_fatal_error       >,
-        boost::msm::front::Row < executing   , omx_eos_evt     , skipping                , boost::msm::front::none , is_last_eos          >,
+        boost::msm::front::Row < executing   , omx_err_evt     , swapping                , do_disable_tunnel<1>    , boost::msm::front::euml::And_<
+                                                                                                                       boost::msm::front::euml::Not_<
+                                                                                                                         is_fatal_error>,
+                                                                                                                       is_decoder_swap_supported> >,
+        boost::msm::front::Row < executing   , omx_eos_evt     , skipping                , boost::msm::front::none , boost::msm::front::euml::And_<
+                                                                                                                       is_last_eos,
+                                                                                                                       boost::msm::front::euml::And_<
+                                                                                                                         boost::msm::front::euml::Not_<
+                                                                                                                           is_stale_eos>,
+                                                                                                                         boost::msm::front::euml::Not_<
+                                                                                                                           is_decoder_swap_supported> > > >,
+        boost::msm::front::Row < executing   , omx_eos_evt     , swapping                , do_disable_tunnel<1>    , boost::msm::front::euml::And_<
+                                                                                                                       is_last_eos,
+                                                                                                                       boost::msm::front::euml::And_<
+                                                                                                                         boost::msm::front::euml::Not_<
+                                                                                                                           is_stale_eos>,
+                                                                                                                         is_decoder_swap_supported> > >,
+        boost::msm::front::Row < executing   , omx_eos_evt     , boost::msm::front::none , do_discard_stale_eos    , is_stale_eos         >,
+        boost::msm::front::Row < executing   , omx_eos_evt     , switching               , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_record_gapless_switch,
+                                                                                               do_disable_tunnel<0> > > , is_gapless_eos  >,
         boost::msm::front::Row < executing   , timer_evt       , boost::msm::front::none , do_increase_progress_display                   >,
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
         boost::msm::front::Row < skipping
@@ -354,6 +650,48 @@ namespace tiz
                                   ::skip_exit>, skipped_evt    , configuring             , do_stop_progress_display , boost::msm::front::euml::Not_<
                                                                                                                        is_end_of_play>   >,
         //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
+        boost::msm::front::Row < switching   , omx_eos_evt     , boost::msm::front::none , do_discard_stale_eos    , is_stale_eos         >,
+        boost::msm::front::Row < switching   , omx_err_evt     , unloaded                , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_record_fatal_error,
+                                                                                               do_error,
+                                                                                               do_tear_down_tunnels,
+                                                                                               do_destroy_graph> > , is_fatal_error       >,
+        boost::msm::front::Row < switching
+                                 ::exit_pt
+                                 <switching_
+                                  ::switch_exit>, switched_evt , executing               , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_stop_progress_display,
+                                                                                               do_retrieve_metadata,
+                                                                                               do_start_progress_display,
+                                                                                               do_probe_next> >                           >,
+        //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
+        boost::msm::front::Row < swapping    , omx_err_evt     , unloaded                , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_record_fatal_error,
+                                                                                               do_error,
+                                                                                               do_tear_down_tunnels,
+                                                                                               do_destroy_graph> > , is_fatal_error       >,
+        boost::msm::front::Row < swapping
+                                 ::exit_pt
+                                 <swapping_
+                                  ::swap_exit>, swapped_evt    , executing               , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_stop_progress_display,
+                                                                                               do_retrieve_metadata,
+                                                                                               do_start_progress_display,
+                                                                                               do_probe_next> > , boost::msm::front::euml::Not_<
+                                                                                                                    is_end_of_play> >,
+        boost::msm::front::Row < swapping
+                                 ::exit_pt
+                                 <swapping_
+                                  ::swap_exit>, swapped_evt    , unloaded                , boost::msm::front::ActionSequence_<
+                                                                                             boost::mpl::vector<
+                                                                                               do_end_of_play,
+                                                                                               do_tear_down_tunnels,
+                                                                                               do_destroy_graph> > , is_end_of_play       >,
+        //    +------------------------------+-----------------+-------------------------+-------------------------+----------------------+
         boost::msm::front::Row < exe2pause   , omx_trans_evt   , pause                   , boost::msm::front::ActionSequence_<
                                                                                              boost::mpl::vector<
                                                                                                do_ack_paused,
@@ -220,6 +220,36 @@ namespace tiz
       }
     };
 
+    struct is_gapless_eos
+    {
+      template < class EVT, class FSM, class SourceState, class TargetState >
+      bool operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        bool rc = false;
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          rc = (*(fsm.pp_ops_))->is_gapless_eos (evt.handle_);
+        }
+        G_GUARD_LOG (rc);
+        return rc;
+      }
+    };
+
+    struct is_stale_eos
+    {
+      template < class EVT, class FSM, class SourceState, class TargetState >
+      bool operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        bool rc = false;
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          rc = (*(fsm.pp_ops_))->is_stale_eos (evt.handle_);
+        }
+        G_GUARD_LOG (rc);
+        return rc;
+      }
+    };
+
     struct is_internal_error
     {
       template < class EVT, class FSM, class SourceState, class TargetState >
@@ -351,6 +381,21 @@ namespace tiz
       }
     };
 
+    struct is_decoder_swap_supported
+    {
+      template < class EVT, class FSM, class SourceState, class TargetState >
+      bool operator()(EVT const& evt, FSM& fsm, SourceState&, TargetState&)
+      {
+        bool rc = false;
+        if (fsm.pp_ops_ && *(fsm.pp_ops_))
+        {
+          rc = (*(fsm.pp_ops_))->is_decoder_swap_supported ();
+        }
+        G_GUARD_LOG (rc);
+        return rc;
+      }
+    };
+
     struct is_skip_allowed
     {
       template < class EVT, class FSM, class SourceState, class TargetState >
@@ -113,7 +113,7 @@ namespace tiz
       OMX_ERRORTYPE internal_error () const;
       std::string internal_error_msg () const;
 
-      tizplaylist_ptr_t find_next_sub_list () const;
+      virtual tizplaylist_ptr_t find_next_sub_list () const;
 
     protected:
       virtual tizgraph_ptr_t get_graph (const std::string &uri);
@@ -67,6 +67,7 @@ graph::ops::ops (graph *p_graph, const omx_comp_name_lst_t &comp_lst,
                  const omx_comp_role_lst_t &role_lst)
   : p_graph_ (p_graph),
     probe_ptr_ (),
+    next_probe_ptr_ (),
     comp_lst_ (comp_lst),
     role_lst_ (role_lst),
     handles_ (),
@@ -76,10 +77,13 @@ graph::ops::ops (graph *p_graph, const omx_comp_name_lst_t &comp_lst,
     expected_port_transitions_lst_ (),
     playlist_ (),
     jump_ (SKIP_DEFAULT_VALUE),
+    stale_eos_count_ (0),
     destination_state_ (OMX_StateMax),
     metadata_ (),
     volume_ (80),
     duration_ (0),
+    perf_interval_ (util::get_perf_counters_interval ()),
+    perf_ticks_ (0),
     error_code_ (OMX_ErrorNone),
     error_msg_ ()
 {
@@ -402,6 +406,8 @@ void graph::ops::do_pause2idle ()
 
 void graph::ops::do_exe2idle ()
 {
+  // Any EOS still pending from the renderer will not be delivered now
+  stale_eos_count_ = 0;
   if (last_op_succeeded ())
   {
     G_OPS_BAIL_IF_ERROR (
@@ -440,6 +446,31 @@ void graph::ops::do_idle2loaded_comp (const int comp_id)
   }
 }
 
+void graph::ops::do_exe2idle_tunnel (const int tunnel_id)
+{
+  if (last_op_succeeded ())
+  {
+    G_OPS_BAIL_IF_ERROR (
+        transition_tunnel (tunnel_id, OMX_StateIdle, OMX_StateExecuting),
+        "Unable to transition tunnel from Exe->Idle");
+  }
+}
+
+void graph::ops::do_idle2loaded_tunnel (const int tunnel_id)
+{
+  if (last_op_succeeded ())
+  {
+    G_OPS_BAIL_IF_ERROR (
+        transition_tunnel (tunnel_id, OMX_StateLoaded, OMX_StateIdle),
+        "Unable to transition tunnel from Idle->Loaded");
+  }
+}
+
+void graph::ops::do_swap_decoder ()
+{
+  // This is a no-op in the base class.
+}
+
 void graph::ops::do_seek ()
 {
   // TODO
@@ -651,6 +682,17 @@ graph::ops::do_increase_progress_display(void *ap_arg1, const unsigned int a_id)
   if (last_op_succeeded () && p_graph_)
   {
     p_graph_->progress_display_increase ();
+    // The progress display ticks once per second
+    if (perf_interval_ > 0 && ++perf_ticks_ >= perf_interval_)
+    {
+      perf_ticks_ = 0;
+      for (size_t i = 0; i < handles_.size (); ++i)
+      {
+        util::dump_perf_counters (handles_[i], handle2name (handles_[i]));
+        util::dump_streaming_buffer_status (handles_[i],
+                                            handle2name (handles_[i]));
+      }
+    }
   }
 }
 
@@ -681,6 +723,40 @@ graph::ops::do_stop_progress_display()
   }
 }
 
+void graph::ops::do_probe_next ()
+{
+  next_probe_ptr_.reset ();
+  if (last_op_succeeded () && config_ && config_->gapless ()
+      && is_gapless_supported ())
+  {
+    assert (playlist_);
+    const std::string next_uri = playlist_->get_next_uri ();
+    if (!next_uri.empty ())
+    {
+      // Probe the next track now, while the current one is still playing, so
+      // that the switch to it can happen without stopping the renderer.
+      const bool quiet_probing = true;
+      next_probe_ptr_ = boost::make_shared< tiz::probe >(next_uri, quiet_probing);
+      (void)next_probe_ptr_->get_omx_domain ();
+    }
+  }
+}
+
+void graph::ops::do_record_gapless_switch ()
+{
+  // The renderer has not finished playing the current track yet; the EOS it
+  // will report for it must not end the playback.
+  ++stale_eos_count_;
+}
+
+void graph::ops::do_discard_stale_eos ()
+{
+  if (stale_eos_count_ > 0)
+  {
+    --stale_eos_count_;
+  }
+}
+
 bool graph::ops::is_port_settings_evt_required () const
 {
   // To be overriden in child classes when needed.
@@ -722,6 +798,20 @@ bool graph::ops::is_skip_allowed () const
   return true;
 }
 
+bool graph::ops::is_gapless_supported () const
+{
+  // To be overriden in child classes where the decoder restarts cleanly when
+  // its input port is re-enabled with a new stream.
+  return false;
+}
+
+bool graph::ops::is_decoder_swap_supported () const
+{
+  // To be overriden in child classes that can replace their decoder while the
+  // renderer remains in Executing.
+  return false;
+}
+
 OMX_ERRORTYPE
 graph::ops::internal_error () const
 {
@@ -856,6 +946,41 @@ bool graph::ops::is_probing_result_ok () const
   return rc;
 }
 
+bool graph::ops::is_gapless_eos (const OMX_HANDLETYPE handle) const
+{
+  bool rc = false;
+
+  // The switch to the next track may start once the component that feeds the
+  // renderer reports EOS, provided that the next track has been probed already
+  // and that the renderer can play it with its current settings.
+  if (config_ && config_->gapless () && is_gapless_supported ()
+      && handles_.size () > 2 && handles_[handles_.size () - 2] == handle
+      && probe_ptr_ && next_probe_ptr_ && SKIP_DEFAULT_VALUE == jump_)
+  {
+    assert (playlist_);
+    if (next_probe_ptr_->get_uri () == playlist_->get_next_uri ()
+        && next_probe_ptr_->get_audio_coding_type ()
+               == probe_ptr_->get_audio_coding_type ())
+    {
+      OMX_AUDIO_PARAM_PCMMODETYPE pcmtype;
+      OMX_AUDIO_PARAM_PCMMODETYPE next_pcmtype;
+      probe_ptr_->get_pcm_codec_info (pcmtype);
+      next_probe_ptr_->get_pcm_codec_info (next_pcmtype);
+      rc = (pcmtype.nChannels == next_pcmtype.nChannels
+            && pcmtype.nSamplingRate == next_pcmtype.nSamplingRate
+            && pcmtype.nBitPerSample == next_pcmtype.nBitPerSample);
+    }
+  }
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "is_gapless_eos [%s]...", rc ? "YES" : "NO");
+  return rc;
+}
+
+bool graph::ops::is_stale_eos (const OMX_HANDLETYPE handle) const
+{
+  return (stale_eos_count_ > 0 && is_last_component (handle));
+}
+
 std::string graph::ops::handle2name (const OMX_HANDLETYPE handle) const
 {
   const omx_hdl2name_map_t::const_iterator it = h2n_.find (handle);
@@ -866,6 +991,16 @@ std::string graph::ops::handle2name (const OMX_HANDLETYPE handle) const
   return "Unknown handle";
 }
 
+const omx_comp_name_lst_t &graph::ops::get_comp_list () const
+{
+  return comp_lst_;
+}
+
+const omx_comp_role_lst_t &graph::ops::get_role_list () const
+{
+  return role_lst_;
+}
+
 void graph::ops::record_error (const OMX_ERRORTYPE err_code,
                                const std::string &err_msg)
 {
@@ -959,10 +1094,18 @@ graph::ops::probe_stream (const OMX_PORTDOMAINTYPE omx_domain,
   const std::string &uri = playlist_->get_current_uri ();
   assert (!uri.empty ());
 
-  // Probe a new uri
+  // Probe a new uri, unless it was already probed ahead of time
   probe_ptr_.reset ();
-  const bool quiet_probing = true;
-  probe_ptr_ = boost::make_shared< tiz::probe >(uri, quiet_probing);
+  if (next_probe_ptr_ && next_probe_ptr_->get_uri () == uri)
+  {
+    probe_ptr_ = next_probe_ptr_;
+  }
+  else
+  {
+    const bool quiet_probing = true;
+    probe_ptr_ = boost::make_shared< tiz::probe >(uri, quiet_probing);
+  }
+  next_probe_ptr_.reset ();
 
   if (probe_ptr_)
   {
@@ -1191,3 +1334,27 @@ graph::cbackhandler &graph::ops::get_cback_handler () const
 {
   return p_graph_->cback_handler_;
 }
+
+void graph::ops::lend_state (ops &delegate) const
+{
+  // Hand over what an ops object acting on this graph's behalf needs to probe
+  // and configure the current track.
+  delegate.handles_ = handles_;
+  delegate.h2n_ = h2n_;
+  delegate.config_ = config_;
+  delegate.playlist_ = playlist_;
+  delegate.probe_ptr_ = probe_ptr_;
+  delegate.next_probe_ptr_ = next_probe_ptr_;
+  delegate.error_code_ = error_code_;
+  delegate.error_msg_ = error_msg_;
+}
+
+void graph::ops::reclaim_state (const ops &delegate)
+{
+  probe_ptr_ = delegate.probe_ptr_;
+  next_probe_ptr_ = delegate.next_probe_ptr_;
+  metadata_ = delegate.metadata_;
+  duration_ = delegate.duration_;
+  error_code_ = delegate.error_code_;
+  error_msg_ = delegate.error_msg_;
+}
@@ -131,6 +131,9 @@ namespace tiz
       virtual void do_exe2idle_comp (const int comp_id);
       virtual void do_idle2loaded ();
       virtual void do_idle2loaded_comp (const int comp_id);
+      virtual void do_exe2idle_tunnel (const int tunnel_id);
+      virtual void do_idle2loaded_tunnel (const int tunnel_id);
+      virtual void do_swap_decoder ();
       virtual void do_seek ();
       virtual void do_skip ();
       virtual void do_store_skip (const int jump);
@@ -157,6 +160,9 @@ namespace tiz
       virtual void do_pause_progress_display();
       virtual void do_resume_progress_display();
       virtual void do_stop_progress_display();
+      virtual void do_probe_next ();
+      virtual void do_record_gapless_switch ();
+      virtual void do_discard_stale_eos ();
 
       virtual bool is_port_settings_evt_required () const;
       virtual bool is_disabled_evt_required () const;
@@ -166,6 +172,8 @@ namespace tiz
                                       const OMX_U32 port_id,
                                       const OMX_INDEXTYPE index_id) const;
       virtual bool is_skip_allowed () const;
+      virtual bool is_gapless_supported () const;
+      virtual bool is_decoder_swap_supported () const;
 
       OMX_ERRORTYPE internal_error () const;
       std::string internal_error_msg () const;
@@ -185,8 +193,12 @@ namespace tiz
       bool last_op_succeeded () const;
       bool is_end_of_play () const;
       bool is_probing_result_ok () const;
+      bool is_gapless_eos (const OMX_HANDLETYPE handle) const;
+      bool is_stale_eos (const OMX_HANDLETYPE handle) const;
 
       std::string handle2name (const OMX_HANDLETYPE handle) const;
+      const omx_comp_name_lst_t &get_comp_list () const;
+      const omx_comp_role_lst_t &get_role_list () const;
 
     protected:
       virtual void record_error (const OMX_ERRORTYPE err_code,
@@ -234,9 +246,13 @@ namespace tiz
 
       cbackhandler &get_cback_handler () const;
 
+      void lend_state (ops &delegate) const;
+      void reclaim_state (const ops &delegate);
+
     protected:
       graph *p_graph_;
       tizprobe_ptr_t probe_ptr_;
+      tizprobe_ptr_t next_probe_ptr_;
       omx_comp_name_lst_t comp_lst_;
       omx_comp_role_lst_t role_lst_;
       omx_comp_handle_lst_t handles_;
@@ -246,10 +262,13 @@ namespace tiz
       omx_event_info_lst_t expected_port_transitions_lst_;
       tizplaylist_ptr_t playlist_;
       int jump_;
+      int stale_eos_count_;
       OMX_STATETYPE destination_state_;
       track_metadata_map_t metadata_;
       int volume_;
       unsigned long duration_;
+      unsigned int perf_interval_;
+      unsigned int perf_ticks_;
       OMX_ERRORTYPE error_code_;
       std::string error_msg_;
     };
@@ -29,6 +29,7 @@
 #include <config.h>
 #endif
 
+#include <stdlib.h>
 #include <boost/foreach.hpp>
 #include <string>
 
@@ -1114,6 +1115,82 @@ bool graph::util::is_mpris_enabled ()
   return is_enabled;
 }
 
+unsigned int graph::util::get_perf_counters_interval ()
+{
+  unsigned int interval = 0;
+  const char *p_interval
+      = tiz_rcfile_get_value ("tizonia", "perf-counters-interval");
+  if (p_interval)
+  {
+    interval = strtoul (p_interval, NULL, 10);
+  }
+  return interval;
+}
+
+void graph::util::dump_perf_counters (const OMX_HANDLETYPE handle,
+                                      const std::string &comp_name)
+{
+  OMX_INDEXTYPE index = OMX_IndexMax;
+  OMX_TIZONIA_PERFCOUNTERSTYPE perf;
+  TIZ_INIT_OMX_PORT_STRUCT (perf, OMX_ALL);
+
+  // Components that do not support the extension are silently skipped
+  if (OMX_ErrorNone
+          != OMX_GetExtensionIndex (
+                 handle, const_cast< OMX_STRING > (
+                             OMX_TIZONIA_INDEX_CONFIG_PERFCOUNTERS),
+                 &index)
+      || OMX_ErrorNone != OMX_GetConfig (handle, index, &perf))
+  {
+    return;
+  }
+
+  TIZ_PRINTF_C02 (
+      "[%s] : buffers %llu (%llu KiB) underruns %u queue max %u | "
+      "buffers_ready %llu avg %llu us max %u us | "
+      "messages %llu latency avg %llu us max %u us queue max %u",
+      comp_name.c_str (), (unsigned long long)perf.nBuffers,
+      (unsigned long long)(perf.nBytes / 1024), (unsigned int)perf.nUnderruns,
+      (unsigned int)perf.nQueueHighWaterMark,
+      (unsigned long long)perf.nBuffersReadyCalls,
+      (unsigned long long)(perf.nBuffersReadyCalls
+                               ? perf.nBuffersReadyTime / perf.nBuffersReadyCalls
+                               : 0),
+      (unsigned int)perf.nBuffersReadyMaxTime,
+      (unsigned long long)perf.nMessages,
+      (unsigned long long)(perf.nMessages
+                               ? perf.nDispatchLatency / perf.nMessages
+                               : 0),
+      (unsigned int)perf.nDispatchLatencyMax,
+      (unsigned int)perf.nMsgQueueHighWaterMark);
+}
+
+void graph::util::dump_streaming_buffer_status (const OMX_HANDLETYPE handle,
+                                                const std::string &comp_name)
+{
+  OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE status;
+  TIZ_INIT_OMX_PORT_STRUCT (status, 0);
+
+  // Only the http source components have a streaming buffer
+  if (OMX_ErrorNone
+      != OMX_GetConfig (
+             handle,
+             static_cast< OMX_INDEXTYPE > (
+                 OMX_TizoniaIndexConfigStreamingBufferStatus),
+             &status))
+  {
+    return;
+  }
+
+  TIZ_PRINTF_C02 (
+      "[%s] : streaming buffer %u/%u KiB target %u KiB underruns %u%s",
+      comp_name.c_str (), (unsigned int)(status.nFillLevel / 1024),
+      (unsigned int)(status.nCapacity / 1024),
+      (unsigned int)(status.nTargetLevel / 1024),
+      (unsigned int)status.nUnderruns,
+      OMX_TRUE == status.bBuffering ? " (buffering)" : "");
+}
+
 void graph::util::copy_omx_string (
     OMX_U8 *p_dest, const std::string &omx_string,
     const size_t max_length /*  = OMX_MAX_STRINGNAME_SIZE */
@@ -246,6 +246,14 @@ namespace tiz
 
       static bool is_mpris_enabled ();
 
+      static unsigned int get_perf_counters_interval ();
+
+      static void dump_perf_counters (const OMX_HANDLETYPE handle,
+                                      const std::string &comp_name);
+
+      static void dump_streaming_buffer_status (const OMX_HANDLETYPE handle,
+                                                const std::string &comp_name);
+
       static void copy_omx_string (OMX_U8 *p_dest,
                                    const std::string &omx_string,
                                    const size_t max_length
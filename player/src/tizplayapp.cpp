@@ -66,6 +66,7 @@
 #include "tizgraphmgr.hpp"
 #include "tizgraphtypes.hpp"
 #include "tizomxutil.hpp"
+#include "tizprobecache.hpp"
 #include <decoders/tizdecgraphmgr.hpp>
 #include <httpclnt/tizhttpclntmgr.hpp>
 #include <httpserv/tizhttpservconfig.hpp>
@@ -724,6 +725,7 @@ tiz::playapp::decode_local ()
   const uri_lst_t &uri_list = popts_.uri_list ();
   const bool shuffle = popts_.shuffle ();
   const bool recurse = popts_.recurse ();
+  const bool gapless = popts_.gapless ();
 
   uri_lst_t file_list;
   std::string error_msg;
@@ -764,9 +766,12 @@ tiz::playapp::decode_local ()
   assert (playlist);
   playlist->print_info ();
 
+  // Warm up the probe cache while the first tracks play
+  tiz::probecache::prefetch (file_list);
+
   // Instantiate the decode manager
   tiz::graphmgr::mgr_ptr_t p_mgr
-      = boost::make_shared< tiz::graphmgr::decodemgr > ();
+      = boost::make_shared< tiz::graphmgr::decodemgr > (gapless);
 
   // TODO: Check return codes
   p_mgr->init (playlist, graphmgr_termination_cback ());
@@ -779,6 +784,8 @@ tiz::playapp::decode_local ()
   p_mgr->quit ();
   p_mgr->deinit ();
 
+  tiz::probecache::stop_prefetch ();
+
   return rc;
 }
 
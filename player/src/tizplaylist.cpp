@@ -286,6 +286,20 @@ const std::string &tiz::playlist::get_current_uri () const
   return uri_list_[current_index_];
 }
 
+std::string tiz::playlist::get_next_uri () const
+{
+  // Returns the uri that a skip of +1 would move to, or an empty string if
+  // there is none.
+  const int list_size = uri_list_.size ();
+  int next_index = current_index_ + 1;
+  if (next_index >= list_size && loop_playback ())
+  {
+    next_index = 0;
+  }
+  return (next_index >= 0 && next_index < list_size) ? uri_list_[next_index]
+                                                     : std::string ();
+}
+
 tiz::playlist tiz::playlist::obtain_next_sub_playlist (
     const list_direction_t up_or_down)
 {
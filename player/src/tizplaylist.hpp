@@ -57,6 +57,7 @@ namespace tiz
     void skip (const int jump);
     playlist obtain_next_sub_playlist (const list_direction_t up_or_down);
     const std::string & get_current_uri () const;
+    std::string get_next_uri () const;
     uri_lst_t get_sublist (const int from, const int to) const;
     const uri_lst_t &get_uri_list () const;
     int current_index () const;
@@ -102,7 +102,6 @@ namespace  // unnamed
   }
 
   void obtain_stream_title_and_genre (MediaInfoLib::MediaInfo &mi,
-                                      const bool quiet,
                                       std::string &stream_title,
                                       std::string &stream_genre)
   {
@@ -111,8 +110,6 @@ namespace  // unnamed
     std::string title (mi_stream_general_info_to_std_string (mi, L"Track"));
     std::string album (mi_stream_general_info_to_std_string (mi, L"Album"));
     std::string genre (mi_stream_general_info_to_std_string (mi, L"Genre"));
-    std::string full_track_name (
-        mi_stream_general_info_to_std_string (mi, L"CompleteName"));
 
     stream_title.assign (artist);
     if (!album.empty ())
@@ -127,15 +124,6 @@ namespace  // unnamed
       stream_title.append (title);
     }
     stream_genre.assign (genre);
-
-    if (!quiet)
-    {
-      if (stream_title.empty ())
-      {
-        stream_title.assign (full_track_name);
-      }
-      boost::replace_all (stream_title, "_", " ");
-    }
   }
 
   OMX_AUDIO_CODINGTYPE obtain_codec_id (MediaInfoLib::MediaInfo &mi)
@@ -252,10 +240,12 @@ tiz::probe::probe (const std::string &uri, const bool quiet)
     vorbistype_ (),
     aactype_ (),
     vp8type_ (),
-    meta_file_ (uri.c_str ()),
+    meta_file_ (),
     stream_title_ (),
     stream_genre_ (),
-    stream_is_cbr_ (false)
+    stream_is_cbr_ (false),
+    meta_ (),
+    meta_cached_ (false)
 {
   // Defaults are the same as in the standard pcm renderer
   pcmtype_.nSize = sizeof(OMX_AUDIO_PARAM_PCMMODETYPE);
@@ -357,6 +347,17 @@ tiz::probe::probe (const std::string &uri, const bool quiet)
   vp8type_.eLevel = OMX_VIDEO_VP8Level_Version0;
   vp8type_.nDCTPartitions = 0; /* 1 DCP partitiion */
   vp8type_.bErrorResilientMode = OMX_FALSE;
+
+  // Files that have been seen before need not be opened at all
+  if (probecache::lookup (uri_, meta_))
+  {
+    meta_cached_ = true;
+    set_stream_info (meta_);
+  }
+  else
+  {
+    meta_file_ = TagLib::FileRef (uri_.c_str ());
+  }
 }
 
 std::string tiz::probe::get_uri () const
@@ -407,80 +408,126 @@ tiz::probe::get_container_type ()
 
 void tiz::probe::probe_stream ()
 {
-  MediaInfoLib::MediaInfo mi;
+  if (meta_cached_)
+  {
+    // Nothing more to learn from the file
+    return;
+  }
 
+  MediaInfoLib::MediaInfo mi;
   if (open_media (uri_, mi))
   {
-    OMX_U32 samplerate = 48000;
-    OMX_U32 bitrate = 0;
-    OMX_U32 nchannels = 2;
-    OMX_U32 bitdepth = 16;
-    OMX_ENDIANTYPE endianness = OMX_EndianLittle;
-    OMX_NUMERICALDATATYPE sign = OMX_NumericalDataSigned;
+    probecache::entry info;
 
     // Get an idea of the container format
-    container_type_ = obtain_container_format (mi);
+    info.container_type_ = obtain_container_format (mi);
 
     // Get the codec type
-    const OMX_AUDIO_CODINGTYPE codec_id = obtain_codec_id (mi);
+    info.audio_coding_type_ = obtain_codec_id (mi);
 
     // Get the stream title and genre
-    obtain_stream_title_and_genre (mi, quiet_, stream_title_, stream_genre_);
+    obtain_stream_title_and_genre (mi, info.stream_title_, info.stream_genre_);
 
-    TIZ_PRINTF_DBG_RED ("uri [%s] codec_id [%0x]\n", uri_.c_str (), codec_id);
+    TIZ_PRINTF_DBG_RED ("uri [%s] codec_id [%0x]\n", uri_.c_str (),
+                        info.audio_coding_type_);
 
     // Grab the sample rate, bitrate, num channels, and sample format (when
     // available), and cbr flag
-    obtain_stream_properties (mi, samplerate, bitrate, nchannels, bitdepth,
-                              endianness, sign, stream_is_cbr_);
+    obtain_stream_properties (mi, info.samplerate_, info.bitrate_,
+                              info.nchannels_, info.bitdepth_,
+                              info.endianness_, info.sign_,
+                              info.stream_is_cbr_);
 
-    if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingMP2)
-    {
-      set_mp2_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                          sign);
-    }
-    else if (codec_id == OMX_AUDIO_CodingMP3)
-    {
-      set_mp3_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                          sign);
-    }
-    else if (codec_id == OMX_AUDIO_CodingAAC)
-    {
-      set_aac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                          sign);
-    }
-    else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingFLAC)
-    {
-      set_flac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                           sign);
-    }
-    else if (codec_id == OMX_AUDIO_CodingVORBIS)
-    {
-      set_vorbis_codec_info (samplerate, bitrate, nchannels, bitdepth,
-                             endianness, sign);
-    }
-    else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingOPUS)
+    mi.Close ();
+
+    // Keep the tags and duration too, so that the cache can serve them
+    if (!meta_file_.isNull () && meta_file_.audioProperties ())
     {
-      set_opus_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
-                           sign);
+      info.length_ = meta_file_.audioProperties ()->length ();
     }
-    else if (is_pcm_codec (codec_id))
+    info.title_ = title ();
+    info.artist_ = artist ();
+    info.album_ = album ();
+    info.year_ = retrieve_meta_data_uint (&TagLib::Tag::year);
+    info.comment_ = comment ();
+    info.track_ = retrieve_meta_data_uint (&TagLib::Tag::track);
+    info.genre_ = genre ();
+
+    set_stream_info (info);
+    info.domain_ = domain_;
+    probecache::store (uri_, info);
+    meta_ = info;
+    meta_cached_ = true;
+  }
+  else
+  {
+    TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to open media file : %s", uri_.c_str());
+  }
+}
+
+void tiz::probe::set_stream_info (const probecache::entry &info)
+{
+  const OMX_AUDIO_CODINGTYPE codec_id = info.audio_coding_type_;
+  const OMX_U32 samplerate = info.samplerate_;
+  const OMX_U32 bitrate = info.bitrate_;
+  const OMX_U32 nchannels = info.nchannels_;
+  const OMX_U32 bitdepth = info.bitdepth_;
+  const OMX_ENDIANTYPE endianness = info.endianness_;
+  const OMX_NUMERICALDATATYPE sign = info.sign_;
+
+  container_type_ = info.container_type_;
+  stream_is_cbr_ = info.stream_is_cbr_;
+  stream_genre_ = info.stream_genre_;
+  stream_title_ = info.stream_title_;
+  if (!quiet_)
+  {
+    if (stream_title_.empty ())
     {
-      domain_ = OMX_PortDomainAudio;
-      audio_coding_type_
-          = static_cast< OMX_AUDIO_CODINGTYPE >(OMX_AUDIO_CodingPCM);
-      pcmtype_.nSamplingRate = samplerate;
-      pcmtype_.nChannels = nchannels;
-      pcmtype_.nBitPerSample = bitdepth;
-      pcmtype_.eEndian = endianness;
-      pcmtype_.eNumData = sign;
+      stream_title_.assign (uri_);
     }
+    boost::replace_all (stream_title_, "_", " ");
+  }
 
-    mi.Close ();
+  if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingMP2)
+  {
+    set_mp2_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                        sign);
   }
-  else
+  else if (codec_id == OMX_AUDIO_CodingMP3)
   {
-    TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to open media file : %s", uri_.c_str());
+    set_mp3_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                        sign);
+  }
+  else if (codec_id == OMX_AUDIO_CodingAAC)
+  {
+    set_aac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                        sign);
+  }
+  else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingFLAC)
+  {
+    set_flac_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                         sign);
+  }
+  else if (codec_id == OMX_AUDIO_CodingVORBIS)
+  {
+    set_vorbis_codec_info (samplerate, bitrate, nchannels, bitdepth,
+                           endianness, sign);
+  }
+  else if (codec_id == (OMX_AUDIO_CODINGTYPE)OMX_AUDIO_CodingOPUS)
+  {
+    set_opus_codec_info (samplerate, bitrate, nchannels, bitdepth, endianness,
+                         sign);
+  }
+  else if (is_pcm_codec (codec_id))
+  {
+    domain_ = OMX_PortDomainAudio;
+    audio_coding_type_
+        = static_cast< OMX_AUDIO_CODINGTYPE >(OMX_AUDIO_CodingPCM);
+    pcmtype_.nSamplingRate = samplerate;
+    pcmtype_.nChannels = nchannels;
+    pcmtype_.nBitPerSample = bitdepth;
+    pcmtype_.eEndian = endianness;
+    pcmtype_.eNumData = sign;
   }
 }
 
@@ -777,50 +824,78 @@ unsigned int tiz::probe::retrieve_meta_data_uint (
 
 std::string tiz::probe::title () const
 {
+  if (meta_cached_)
+  {
+    return meta_.title_;
+  }
   return retrieve_meta_data_str (&TagLib::Tag::title);
 }
 
 std::string tiz::probe::artist () const
 {
+  if (meta_cached_)
+  {
+    return meta_.artist_;
+  }
   return retrieve_meta_data_str (&TagLib::Tag::artist);
 }
 
 std::string tiz::probe::album () const
 {
+  if (meta_cached_)
+  {
+    return meta_.album_;
+  }
   return retrieve_meta_data_str (&TagLib::Tag::album);
 }
 
 std::string tiz::probe::year () const
 {
   return boost::lexical_cast< std::string >(
-      retrieve_meta_data_uint (&TagLib::Tag::year));
+      meta_cached_ ? meta_.year_
+                   : retrieve_meta_data_uint (&TagLib::Tag::year));
 }
 
 std::string tiz::probe::comment () const
 {
+  if (meta_cached_)
+  {
+    return meta_.comment_;
+  }
   return retrieve_meta_data_str (&TagLib::Tag::comment);
 }
 
 std::string tiz::probe::track () const
 {
   return boost::lexical_cast< std::string >(
-      retrieve_meta_data_uint (&TagLib::Tag::track));
+      meta_cached_ ? meta_.track_
+                   : retrieve_meta_data_uint (&TagLib::Tag::track));
 }
 
 std::string tiz::probe::genre () const
 {
+  if (meta_cached_)
+  {
+    return meta_.genre_;
+  }
   return retrieve_meta_data_str (&TagLib::Tag::genre);
 }
 
 std::string tiz::probe::stream_length () const
 {
   std::string length_str;
+  int length = meta_.length_;
+
+  if (!meta_cached_ && !meta_file_.isNull ()
+      && meta_file_.audioProperties ())
+  {
+    length = meta_file_.audioProperties ()->length ();
+  }
 
-  if (!meta_file_.isNull () && meta_file_.audioProperties ())
+  if (length >= 0)
   {
-    TagLib::AudioProperties *properties = meta_file_.audioProperties ();
-    int seconds = properties->length () % 60;
-    int minutes = (properties->length () - seconds) / 60;
+    int seconds = length % 60;
+    int minutes = (length - seconds) / 60;
     int hours = 0;
     if (minutes >= 60)
     {
@@ -41,6 +41,8 @@
 #include <OMX_Video.h>
 #include <OMX_TizoniaExt.h>
 
+#include "tizprobecache.hpp"
+
 namespace tiz
 {
   class probe
@@ -92,6 +94,7 @@ namespace tiz
 
   private:
     void probe_stream ();
+    void set_stream_info (const probecache::entry &info);
     void set_mp2_codec_info (const OMX_U32 samplerate, const OMX_U32 bitrate,
                              const OMX_U32 nchannels, const OMX_U32 bitdepth,
                              const OMX_ENDIANTYPE endianness,
@@ -141,6 +144,8 @@ namespace tiz
     std::string stream_title_;
     std::string stream_genre_;
     bool stream_is_cbr_;
+    probecache::entry meta_;
+    bool meta_cached_;
   };
 }  // namespace tiz
 
@@ -0,0 +1,436 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizprobecache.cpp
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  A persistent cache of media probing results
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <tizplatform.h>
+
+#include "tizprobe.hpp"
+#include "tizprobecache.hpp"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.play.probecache"
+#endif
+
+namespace bf = boost::filesystem;
+
+namespace  // unnamed
+{
+  const char *const CACHE_HEADER = "tizonia-probe-cache 1";
+  const size_t CACHE_FIELDS = 23;
+  const unsigned int MAX_PREFETCH_THREADS = 4;
+
+  struct record
+  {
+    std::time_t mtime_;
+    boost::uintmax_t size_;
+    tiz::probecache::entry entry_;
+  };
+
+  typedef std::map< std::string, record > record_map_t;
+
+  boost::mutex g_mutex;
+  record_map_t g_records;
+  bool g_loaded = false;
+  std::string g_cache_file;
+
+  boost::mutex g_prefetch_mutex;
+  boost::scoped_ptr< boost::thread_group > g_prefetch_threads;
+  uri_lst_t g_prefetch_list;
+  size_t g_prefetch_next = 0;
+  bool g_prefetch_stop = false;
+
+  std::string cache_file_path ()
+  {
+    std::string dir;
+    const char *p_xdg = std::getenv ("XDG_CACHE_HOME");
+    const char *p_home = std::getenv ("HOME");
+    if (p_xdg && *p_xdg)
+    {
+      dir.assign (p_xdg);
+    }
+    else if (p_home && *p_home)
+    {
+      dir.assign (p_home);
+      dir.append ("/.cache");
+    }
+    if (dir.empty ())
+    {
+      return dir;
+    }
+    return dir + "/tizonia/probe.cache";
+  }
+
+  bool file_key (const std::string &uri, std::time_t &mtime,
+                 boost::uintmax_t &size)
+  {
+    boost::system::error_code ec;
+    if (!bf::is_regular_file (uri, ec))
+    {
+      return false;
+    }
+    mtime = bf::last_write_time (uri, ec);
+    if (ec)
+    {
+      return false;
+    }
+    size = bf::file_size (uri, ec);
+    return !ec;
+  }
+
+  std::string sanitize (std::string str)
+  {
+    boost::replace_all (str, "\t", " ");
+    boost::replace_all (str, "\n", " ");
+    boost::replace_all (str, "\r", " ");
+    return str;
+  }
+
+  std::string serialize (const std::string &uri, const record &r)
+  {
+    const tiz::probecache::entry &e = r.entry_;
+    std::string line (sanitize (uri));
+#define TIZ_PROBECACHE_FIELD(f)                            \
+  line.append ("\t");                                      \
+  line.append (boost::lexical_cast< std::string >(f))
+    TIZ_PROBECACHE_FIELD (r.mtime_);
+    TIZ_PROBECACHE_FIELD (r.size_);
+    TIZ_PROBECACHE_FIELD (static_cast< int >(e.domain_));
+    TIZ_PROBECACHE_FIELD (static_cast< int >(e.audio_coding_type_));
+    TIZ_PROBECACHE_FIELD (static_cast< int >(e.container_type_));
+    TIZ_PROBECACHE_FIELD (e.samplerate_);
+    TIZ_PROBECACHE_FIELD (e.bitrate_);
+    TIZ_PROBECACHE_FIELD (e.nchannels_);
+    TIZ_PROBECACHE_FIELD (e.bitdepth_);
+    TIZ_PROBECACHE_FIELD (static_cast< int >(e.endianness_));
+    TIZ_PROBECACHE_FIELD (static_cast< int >(e.sign_));
+    TIZ_PROBECACHE_FIELD (e.stream_is_cbr_ ? 1 : 0);
+    TIZ_PROBECACHE_FIELD (e.length_);
+    TIZ_PROBECACHE_FIELD (e.year_);
+    TIZ_PROBECACHE_FIELD (e.track_);
+    TIZ_PROBECACHE_FIELD (sanitize (e.stream_title_));
+    TIZ_PROBECACHE_FIELD (sanitize (e.stream_genre_));
+    TIZ_PROBECACHE_FIELD (sanitize (e.title_));
+    TIZ_PROBECACHE_FIELD (sanitize (e.artist_));
+    TIZ_PROBECACHE_FIELD (sanitize (e.album_));
+    TIZ_PROBECACHE_FIELD (sanitize (e.comment_));
+    TIZ_PROBECACHE_FIELD (sanitize (e.genre_));
+#undef TIZ_PROBECACHE_FIELD
+    return line;
+  }
+
+  bool deserialize (const std::string &line, std::string &uri, record &r)
+  {
+    std::vector< std::string > f;
+    boost::split (f, line, boost::is_any_of ("\t"));
+    if (f.size () != CACHE_FIELDS)
+    {
+      return false;
+    }
+
+    try
+    {
+      tiz::probecache::entry &e = r.entry_;
+      uri = f[0];
+      r.mtime_ = boost::lexical_cast< std::time_t >(f[1]);
+      r.size_ = boost::lexical_cast< boost::uintmax_t >(f[2]);
+      e.domain_ = static_cast< OMX_PORTDOMAINTYPE >(
+          boost::lexical_cast< int >(f[3]));
+      e.audio_coding_type_ = static_cast< OMX_AUDIO_CODINGTYPE >(
+          boost::lexical_cast< int >(f[4]));
+      e.container_type_ = static_cast< OMX_MEDIACONTAINER_FORMATTYPE >(
+          boost::lexical_cast< int >(f[5]));
+      e.samplerate_ = boost::lexical_cast< OMX_U32 >(f[6]);
+      e.bitrate_ = boost::lexical_cast< OMX_U32 >(f[7]);
+      e.nchannels_ = boost::lexical_cast< OMX_U32 >(f[8]);
+      e.bitdepth_ = boost::lexical_cast< OMX_U32 >(f[9]);
+      e.endianness_ = static_cast< OMX_ENDIANTYPE >(
+          boost::lexical_cast< int >(f[10]));
+      e.sign_ = static_cast< OMX_NUMERICALDATATYPE >(
+          boost::lexical_cast< int >(f[11]));
+      e.stream_is_cbr_ = (boost::lexical_cast< int >(f[12]) != 0);
+      e.length_ = boost::lexical_cast< int >(f[13]);
+      e.year_ = boost::lexical_cast< unsigned int >(f[14]);
+      e.track_ = boost::lexical_cast< unsigned int >(f[15]);
+      e.stream_title_ = f[16];
+      e.stream_genre_ = f[17];
+      e.title_ = f[18];
+      e.artist_ = f[19];
+      e.album_ = f[20];
+      e.comment_ = f[21];
+      e.genre_ = f[22];
+    }
+    catch (const boost::bad_lexical_cast &)
+    {
+      return false;
+    }
+    return true;
+  }
+
+  void rewrite_cache_file ()
+  {
+    const std::string tmp_file (g_cache_file + ".tmp");
+    {
+      std::ofstream out (tmp_file.c_str (), std::ios::trunc);
+      if (!out)
+      {
+        return;
+      }
+      out << CACHE_HEADER << "\n";
+      for (record_map_t::const_iterator it = g_records.begin ();
+           it != g_records.end (); ++it)
+      {
+        out << serialize (it->first, it->second) << "\n";
+      }
+    }
+    boost::system::error_code ec;
+    bf::rename (tmp_file, g_cache_file, ec);
+  }
+
+  // Called with g_mutex held
+  void load_cache_file ()
+  {
+    if (g_loaded)
+    {
+      return;
+    }
+    g_loaded = true;
+    g_cache_file = cache_file_path ();
+    if (g_cache_file.empty ())
+    {
+      return;
+    }
+
+    std::ifstream in (g_cache_file.c_str ());
+    std::string line;
+    if (!in)
+    {
+      return;
+    }
+    if (!std::getline (in, line) || line.compare (CACHE_HEADER) != 0)
+    {
+      // Unknown format; start afresh
+      in.close ();
+      boost::system::error_code ec;
+      bf::remove (g_cache_file, ec);
+      return;
+    }
+
+    // The file is append-only; later lines supersede earlier ones
+    size_t nlines = 0;
+    while (std::getline (in, line))
+    {
+      std::string uri;
+      record r;
+      ++nlines;
+      if (deserialize (line, uri, r))
+      {
+        g_records[uri] = r;
+      }
+    }
+    in.close ();
+
+    TIZ_LOG (TIZ_PRIORITY_TRACE, "[%s] : %zu entries (%zu lines)",
+             g_cache_file.c_str (), g_records.size (), nlines);
+
+    if (nlines > 2 * g_records.size () + 64)
+    {
+      rewrite_cache_file ();
+    }
+  }
+
+  // Called with g_mutex held
+  void append_to_cache_file (const std::string &uri, const record &r)
+  {
+    if (g_cache_file.empty ())
+    {
+      return;
+    }
+
+    boost::system::error_code ec;
+    const bool is_new = !bf::exists (g_cache_file, ec);
+    if (is_new)
+    {
+      bf::create_directories (bf::path (g_cache_file).parent_path (), ec);
+    }
+
+    std::ofstream out (g_cache_file.c_str (), std::ios::app);
+    if (out)
+    {
+      if (is_new)
+      {
+        out << CACHE_HEADER << "\n";
+      }
+      out << serialize (uri, r) << "\n";
+    }
+  }
+
+  bool next_prefetch_uri (std::string &uri)
+  {
+    boost::lock_guard< boost::mutex > lock (g_prefetch_mutex);
+    if (g_prefetch_stop || g_prefetch_next >= g_prefetch_list.size ())
+    {
+      return false;
+    }
+    uri = g_prefetch_list[g_prefetch_next++];
+    return true;
+  }
+
+  void prefetch_worker ()
+  {
+    std::string uri;
+    while (next_prefetch_uri (uri))
+    {
+      tiz::probecache::entry e;
+      if (tiz::probecache::lookup (uri, e))
+      {
+        continue;
+      }
+
+      try
+      {
+        // Probing stores the results in the cache
+        tiz::probe p (uri, /* quiet = */ true);
+        (void)p.get_omx_domain ();
+      }
+      catch (...)
+      {
+        TIZ_LOG (TIZ_PRIORITY_NOTICE, "Unable to probe : %s", uri.c_str ());
+      }
+    }
+  }
+}
+
+tiz::probecache::entry::entry ()
+  : domain_ (OMX_PortDomainMax),
+    audio_coding_type_ (OMX_AUDIO_CodingUnused),
+    container_type_ (OMX_FORMATMax),
+    samplerate_ (48000),
+    bitrate_ (0),
+    nchannels_ (2),
+    bitdepth_ (16),
+    endianness_ (OMX_EndianLittle),
+    sign_ (OMX_NumericalDataSigned),
+    stream_is_cbr_ (false),
+    stream_title_ (),
+    stream_genre_ (),
+    length_ (-1),
+    title_ (),
+    artist_ (),
+    album_ (),
+    year_ (0),
+    comment_ (),
+    track_ (0),
+    genre_ ()
+{
+}
+
+bool tiz::probecache::lookup (const std::string &uri, entry &e)
+{
+  std::time_t mtime = 0;
+  boost::uintmax_t size = 0;
+  if (!file_key (uri, mtime, size))
+  {
+    return false;
+  }
+
+  boost::lock_guard< boost::mutex > lock (g_mutex);
+  load_cache_file ();
+  record_map_t::const_iterator it = g_records.find (uri);
+  if (it == g_records.end () || it->second.mtime_ != mtime
+      || it->second.size_ != size)
+  {
+    return false;
+  }
+  e = it->second.entry_;
+  return true;
+}
+
+void tiz::probecache::store (const std::string &uri, const entry &e)
+{
+  record r;
+  if (!file_key (uri, r.mtime_, r.size_))
+  {
+    return;
+  }
+  r.entry_ = e;
+
+  boost::lock_guard< boost::mutex > lock (g_mutex);
+  load_cache_file ();
+  g_records[uri] = r;
+  append_to_cache_file (uri, r);
+}
+
+void tiz::probecache::prefetch (const uri_lst_t &uri_list)
+{
+  stop_prefetch ();
+
+  unsigned int nthreads = boost::thread::hardware_concurrency ();
+  nthreads = std::max (1u, std::min (nthreads, MAX_PREFETCH_THREADS));
+
+  boost::lock_guard< boost::mutex > lock (g_prefetch_mutex);
+  g_prefetch_list = uri_list;
+  g_prefetch_next = 0;
+  g_prefetch_stop = false;
+  g_prefetch_threads.reset (new boost::thread_group ());
+  for (unsigned int i = 0; i < nthreads; ++i)
+  {
+    g_prefetch_threads->create_thread (&prefetch_worker);
+  }
+}
+
+void tiz::probecache::stop_prefetch ()
+{
+  {
+    boost::lock_guard< boost::mutex > lock (g_prefetch_mutex);
+    g_prefetch_stop = true;
+  }
+  if (g_prefetch_threads)
+  {
+    g_prefetch_threads->join_all ();
+    g_prefetch_threads.reset ();
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   tizprobecache.hpp
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  A persistent cache of media probing results
+ *
+ *
+ */
+
+#ifndef TIZPROBECACHE_HPP
+#define TIZPROBECACHE_HPP
+
+#include <string>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Audio.h>
+#include <OMX_TizoniaExt.h>
+
+#include "tizgraphtypes.hpp"
+
+namespace tiz
+{
+  /**
+   * Probing results are kept in memory and appended to
+   * $XDG_CACHE_HOME/tizonia/probe.cache (or $HOME/.cache/tizonia), keyed by
+   * path, modification time and size, so that a file is only opened with
+   * MediaInfo/TagLib again after it changes.
+   */
+  class probecache
+  {
+  public:
+    struct entry
+    {
+      entry ();
+
+      OMX_PORTDOMAINTYPE domain_;
+      OMX_AUDIO_CODINGTYPE audio_coding_type_;
+      OMX_MEDIACONTAINER_FORMATTYPE container_type_;
+      OMX_U32 samplerate_;
+      OMX_U32 bitrate_;
+      OMX_U32 nchannels_;
+      OMX_U32 bitdepth_;
+      OMX_ENDIANTYPE endianness_;
+      OMX_NUMERICALDATATYPE sign_;
+      bool stream_is_cbr_;
+      std::string stream_title_;
+      std::string stream_genre_;
+      int length_;  // seconds, or -1 if unknown
+      std::string title_;
+      std::string artist_;
+      std::string album_;
+      unsigned int year_;
+      std::string comment_;
+      unsigned int track_;
+      std::string genre_;
+    };
+
+  public:
+    static bool lookup (const std::string &uri, entry &e);
+    static void store (const std::string &uri, const entry &e);
+
+    /**
+     * Probe the given files in the background, in list order, using a small
+     * pool of threads. Probes of files that have already been visited are
+     * then served from the cache.
+     */
+    static void prefetch (const uri_lst_t &uri_list);
+    static void stop_prefetch ();
+  };
+}  // namespace tiz
+
+#endif  // TIZPROBECACHE_HPP
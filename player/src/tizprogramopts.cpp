@@ -331,6 +331,7 @@ tiz::programopts::programopts (int argc, char *argv[])
     help_option_ ("help"),
     recurse_ (false),
     shuffle_ (false),
+    gapless_ (false),
     daemon_ (false),
     chromecast_name_or_ip_ (),
     buffer_seconds_(0),
@@ -684,6 +685,11 @@ bool tiz::programopts::recurse () const
   return recurse_;
 }
 
+bool tiz::programopts::gapless () const
+{
+  return gapless_;
+}
+
 bool tiz::programopts::daemon () const
 {
   return daemon_;
@@ -1429,6 +1435,10 @@ void tiz::programopts::init_global_options ()
       ("shuffle,s", po::bool_switch (&shuffle_)->default_value (false),
        "Shuffle the playlist.")
       /* TIZ_CLASS_COMMENT: */
+      ("gapless", po::bool_switch (&gapless_)->default_value (false),
+       "Gapless playback of local media (the audio renderer is kept running "
+       "between tracks of the same format and audio parameters).")
+      /* TIZ_CLASS_COMMENT: */
       ("daemon,d", po::bool_switch (&daemon_)->default_value (false),
        "Run in the background.")
       /* TIZ_CLASS_COMMENT: */
@@ -1457,8 +1467,8 @@ void tiz::programopts::init_global_options ()
   // TODO: help and version are not included. These should be moved out of
   // "global" and into its own category: "info"
   all_global_options_
-      = boost::assign::list_of ("recurse") ("shuffle") ("daemon") ("cast") (
-            "buffer-seconds") ("proxy-server") ("proxy-user") ("proxy-password")
+      = boost::assign::list_of ("recurse") ("shuffle") ("gapless") ("daemon") (
+            "cast") ("buffer-seconds") ("proxy-server") ("proxy-user") ("proxy-password")
             .convert_to_container< std::vector< std::string > > ();
 
   // Even though --cast is a global option, we also initialise here a
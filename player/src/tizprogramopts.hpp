@@ -60,6 +60,7 @@ namespace tiz
 
     bool shuffle () const;
     bool recurse () const;
+    bool gapless () const;
     bool daemon () const;
     const std::string &chromecast_name_or_ip () const;
     const std::string &proxy_server () const;
@@ -193,6 +194,7 @@ namespace tiz
     std::string help_option_;
     bool recurse_;
     bool shuffle_;
+    bool gapless_;
     bool daemon_;
     std::string chromecast_name_or_ip_;
     uint32_t buffer_seconds_;
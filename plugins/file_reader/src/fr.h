@@ -47,6 +47,8 @@ extern "C" {
 #define ARATELIA_FILE_READER_PORT_NONCONTIGUOUS OMX_FALSE
 #define ARATELIA_FILE_READER_PORT_ALIGNMENT 0
 #define ARATELIA_FILE_READER_PORT_SUPPLIERPREF OMX_BufferSupplyInput
+#define ARATELIA_FILE_READER_DEFAULT_READ_MODE "stdio"
+#define ARATELIA_FILE_READER_READAHEAD_BUFFERS 8
 
 #ifdef __cplusplus
 }
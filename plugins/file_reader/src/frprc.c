@@ -35,6 +35,10 @@
 #include <errno.h>
 #include <limits.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <OMX_Core.h>
 
@@ -64,6 +68,17 @@ close_file (fr_prc_t * ap_prc)
       fclose (ap_prc->p_file_);
       ap_prc->p_file_ = NULL;
     }
+  if (ap_prc->p_map_)
+    {
+      (void) munmap (ap_prc->p_map_, ap_prc->map_len_);
+      ap_prc->p_map_ = NULL;
+      ap_prc->map_len_ = 0;
+    }
+  if (ap_prc->fd_ >= 0)
+    {
+      (void) close (ap_prc->fd_);
+      ap_prc->fd_ = -1;
+    }
 }
 
 static inline void
@@ -80,12 +95,153 @@ reset_stream_parameters (fr_prc_t * ap_prc)
   assert (ap_prc);
   ap_prc->counter_ = 0;
   ap_prc->eos_ = false;
+  ap_prc->offset_ = 0;
+  ap_prc->readahead_end_ = 0;
   if (ap_prc->p_file_)
     {
       rewind (ap_prc->p_file_);
     }
 }
 
+static fr_read_mode_t
+obtain_read_mode (fr_prc_t * ap_prc)
+{
+  const char * p_mode = tiz_rcfile_get_value (
+    TIZ_RCFILE_PLUGINS_DATA_SECTION, ARATELIA_FILE_READER_COMPONENT_NAME
+    ".read_mode");
+  fr_read_mode_t mode = EFrReadModeStdio;
+
+  assert (ap_prc);
+
+  if (!p_mode)
+    {
+      p_mode = ARATELIA_FILE_READER_DEFAULT_READ_MODE;
+    }
+
+  if (0 == strncmp (p_mode, "mmap", sizeof ("mmap")))
+    {
+      mode = EFrReadModeMmap;
+    }
+  else if (0 == strncmp (p_mode, "readahead", sizeof ("readahead")))
+    {
+      mode = EFrReadModeReadAhead;
+    }
+  else if (0 != strncmp (p_mode, "stdio", sizeof ("stdio")))
+    {
+      TIZ_WARN (handleOf (ap_prc), "Unknown read mode [%s]; using stdio",
+                p_mode);
+    }
+
+  TIZ_TRACE (handleOf (ap_prc), "read mode [%s]", p_mode);
+  return mode;
+}
+
+static OMX_ERRORTYPE
+open_file (fr_prc_t * ap_prc)
+{
+  const char * p_path = NULL;
+  struct stat st;
+
+  assert (ap_prc);
+  assert (ap_prc->p_uri_param_);
+
+  p_path = (const char *) ap_prc->p_uri_param_->contentURI;
+
+  if (EFrReadModeStdio == ap_prc->read_mode_)
+    {
+      if ((ap_prc->p_file_ = fopen (p_path, "r")) == 0)
+        {
+          TIZ_ERROR (handleOf (ap_prc), "Error opening file from URI (%s)",
+                     strerror (errno));
+          return OMX_ErrorInsufficientResources;
+        }
+      return OMX_ErrorNone;
+    }
+
+  if ((ap_prc->fd_ = open (p_path, O_RDONLY | O_CLOEXEC)) < 0)
+    {
+      TIZ_ERROR (handleOf (ap_prc), "Error opening file from URI (%s)",
+                 strerror (errno));
+      return OMX_ErrorInsufficientResources;
+    }
+
+  /* Let the kernel know that the file will be read once, front to back */
+  (void) posix_fadvise (ap_prc->fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  if (EFrReadModeMmap == ap_prc->read_mode_)
+    {
+      void * p_map = MAP_FAILED;
+      if (0 == fstat (ap_prc->fd_, &st) && S_ISREG (st.st_mode)
+          && st.st_size > 0)
+        {
+          p_map = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+                        ap_prc->fd_, 0);
+        }
+
+      if (MAP_FAILED == p_map)
+        {
+          /* Empty files, pipes, etc, can't be mapped */
+          TIZ_NOTICE (handleOf (ap_prc),
+                      "Unable to map the file (%s); using read-ahead instead",
+                      strerror (errno));
+          ap_prc->read_mode_ = EFrReadModeReadAhead;
+        }
+      else
+        {
+          ap_prc->p_map_ = p_map;
+          ap_prc->map_len_ = (size_t) st.st_size;
+          (void) madvise (ap_prc->p_map_, ap_prc->map_len_, MADV_SEQUENTIAL);
+        }
+    }
+
+  return OMX_ErrorNone;
+}
+
+/* Keep a window of buffers ahead of the read offset in flight, so that the
+   storage latency is hidden behind the consumption of the current buffers */
+static void
+read_ahead (fr_prc_t * ap_prc, const OMX_U32 a_buf_size)
+{
+  const off_t window
+    = (off_t) a_buf_size * ARATELIA_FILE_READER_READAHEAD_BUFFERS;
+
+  assert (ap_prc);
+
+  if (ap_prc->readahead_end_ - ap_prc->offset_ > window / 2)
+    {
+      return;
+    }
+
+  if (ap_prc->readahead_end_ < ap_prc->offset_)
+    {
+      ap_prc->readahead_end_ = ap_prc->offset_;
+    }
+
+  if (ap_prc->p_map_)
+    {
+      const long page_size = sysconf (_SC_PAGESIZE);
+      off_t start = ap_prc->readahead_end_ & ~((off_t) page_size - 1);
+      off_t end = ap_prc->offset_ + window;
+      if (end > (off_t) ap_prc->map_len_)
+        {
+          end = (off_t) ap_prc->map_len_;
+        }
+      if (end > start)
+        {
+          (void) madvise (ap_prc->p_map_ + start, (size_t) (end - start),
+                          MADV_WILLNEED);
+        }
+      ap_prc->readahead_end_ = end;
+    }
+  else
+    {
+      (void) posix_fadvise (ap_prc->fd_, ap_prc->readahead_end_,
+                            ap_prc->offset_ + window - ap_prc->readahead_end_,
+                            POSIX_FADV_WILLNEED);
+      ap_prc->readahead_end_ = ap_prc->offset_ + window;
+    }
+}
+
 static OMX_ERRORTYPE
 obtain_uri (fr_prc_t * ap_prc)
 {
@@ -129,32 +285,112 @@ obtain_uri (fr_prc_t * ap_prc)
   return rc;
 }
 
+static OMX_ERRORTYPE
+read_stdio (fr_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * p_hdr,
+            size_t * ap_bytes_read)
+{
+  assert (ap_prc);
+  assert (ap_bytes_read);
+
+  if (!(*ap_bytes_read
+        = fread (p_hdr->pBuffer, 1, p_hdr->nAllocLen, ap_prc->p_file_)))
+    {
+      if (!feof (ap_prc->p_file_))
+        {
+          TIZ_ERROR (handleOf (ap_prc), "An error occurred while reading");
+          return OMX_ErrorInsufficientResources;
+        }
+    }
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+read_mmap (fr_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * p_hdr,
+           size_t * ap_bytes_read)
+{
+  size_t remaining = 0;
+
+  assert (ap_prc);
+  assert (ap_prc->p_map_);
+  assert (ap_bytes_read);
+
+  remaining = ap_prc->map_len_ - (size_t) ap_prc->offset_;
+  *ap_bytes_read = MIN (remaining, p_hdr->nAllocLen);
+  if (*ap_bytes_read > 0)
+    {
+      memcpy (p_hdr->pBuffer, ap_prc->p_map_ + ap_prc->offset_,
+              *ap_bytes_read);
+    }
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+read_fd (fr_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * p_hdr,
+         size_t * ap_bytes_read)
+{
+  assert (ap_prc);
+  assert (ap_bytes_read);
+
+  *ap_bytes_read = 0;
+  while (*ap_bytes_read < p_hdr->nAllocLen)
+    {
+      ssize_t n = pread (ap_prc->fd_, p_hdr->pBuffer + *ap_bytes_read,
+                         p_hdr->nAllocLen - *ap_bytes_read,
+                         ap_prc->offset_ + (off_t) *ap_bytes_read);
+      if (n < 0 && EINTR == errno)
+        {
+          continue;
+        }
+      if (n < 0)
+        {
+          TIZ_ERROR (handleOf (ap_prc), "An error occurred while reading (%s)",
+                     strerror (errno));
+          return OMX_ErrorInsufficientResources;
+        }
+      if (0 == n)
+        {
+          break;
+        }
+      *ap_bytes_read += (size_t) n;
+    }
+  return OMX_ErrorNone;
+}
+
 static OMX_ERRORTYPE
 read_into_buffer (const void * ap_obj, OMX_BUFFERHEADERTYPE * p_hdr)
 {
   fr_prc_t * p_prc = (fr_prc_t *) ap_obj;
   assert (p_prc);
 
-  if (p_prc->p_file_ && !(p_prc->eos_))
+  if ((p_prc->p_file_ || p_prc->fd_ >= 0) && !(p_prc->eos_))
     {
-      int bytes_read = 0;
-      if (!(bytes_read
-            = fread (p_hdr->pBuffer, 1, p_hdr->nAllocLen, p_prc->p_file_)))
+      size_t bytes_read = 0;
+
+      if (EFrReadModeStdio == p_prc->read_mode_)
+        {
+          tiz_check_omx (read_stdio (p_prc, p_hdr, &bytes_read));
+        }
+      else
         {
-          if (feof (p_prc->p_file_))
+          read_ahead (p_prc, p_hdr->nAllocLen);
+          if (EFrReadModeMmap == p_prc->read_mode_)
             {
-              TIZ_NOTICE (
-                handleOf (p_prc),
-                "End of file reached bytes_read=[%d] EOS in HEADER [%p]",
-                bytes_read, p_hdr);
-              p_hdr->nFlags |= OMX_BUFFERFLAG_EOS;
-              p_prc->eos_ = true;
+              tiz_check_omx (read_mmap (p_prc, p_hdr, &bytes_read));
             }
           else
             {
-              TIZ_ERROR (handleOf (p_prc), "An error occurred while reading");
-              return OMX_ErrorInsufficientResources;
+              tiz_check_omx (read_fd (p_prc, p_hdr, &bytes_read));
             }
+          p_prc->offset_ += (off_t) bytes_read;
+        }
+
+      if (0 == bytes_read)
+        {
+          TIZ_NOTICE (handleOf (p_prc),
+                      "End of file reached bytes_read=[%zu] EOS in HEADER [%p]",
+                      bytes_read, p_hdr);
+          p_hdr->nFlags |= OMX_BUFFERFLAG_EOS;
+          p_prc->eos_ = true;
         }
 
       p_hdr->nFilledLen = bytes_read;
@@ -162,7 +398,7 @@ read_into_buffer (const void * ap_obj, OMX_BUFFERHEADERTYPE * p_hdr)
 
       TIZ_TRACE (handleOf (p_prc),
                  "Reading into HEADER [%p]...nFilledLen[%d] "
-                 "counter [%d] bytes_read[%d]",
+                 "counter [%d] bytes_read[%zu]",
                  p_hdr, p_hdr->nFilledLen, p_prc->counter_, bytes_read);
     }
 
@@ -178,7 +414,11 @@ fr_prc_ctor (void * ap_obj, va_list * app)
 {
   fr_prc_t * p_prc = super_ctor (typeOf (ap_obj, "frprc"), ap_obj, app);
   assert (p_prc);
+  p_prc->read_mode_ = EFrReadModeStdio;
   p_prc->p_file_ = NULL;
+  p_prc->fd_ = -1;
+  p_prc->p_map_ = NULL;
+  p_prc->map_len_ = 0;
   p_prc->p_uri_param_ = NULL;
   reset_stream_parameters (p_prc);
   return p_prc;
@@ -202,19 +442,11 @@ fr_prc_allocate_resources (void * ap_obj, OMX_U32 TIZ_UNUSED (a_pid))
   assert (p_prc);
   assert (NULL == p_prc->p_uri_param_);
   assert (NULL == p_prc->p_file_);
+  assert (p_prc->fd_ < 0);
 
   tiz_check_omx (obtain_uri (p_prc));
-
-  if ((p_prc->p_file_
-       = fopen ((const char *) p_prc->p_uri_param_->contentURI, "r"))
-      == 0)
-    {
-      TIZ_ERROR (handleOf (p_prc), "Error opening file from URI (%s)",
-                 strerror (errno));
-      return OMX_ErrorInsufficientResources;
-    }
-
-  return OMX_ErrorNone;
+  p_prc->read_mode_ = obtain_read_mode (p_prc);
+  return open_file (p_prc);
 }
 
 static OMX_ERRORTYPE
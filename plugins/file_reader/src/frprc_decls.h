@@ -34,15 +34,30 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <sys/types.h>
 
 #include <tizprc_decls.h>
 
+typedef enum fr_read_mode
+{
+  EFrReadModeStdio,     /* fread through a stdio stream */
+  EFrReadModeMmap,      /* copy from a read-only mapping of the file */
+  EFrReadModeReadAhead, /* read(2), with kernel read-ahead of a window of
+                           buffers */
+} fr_read_mode_t;
+
 typedef struct fr_prc fr_prc_t;
 struct fr_prc
 {
   /* Object */
   const tiz_prc_t _;
+  fr_read_mode_t read_mode_;
   FILE * p_file_;
+  int fd_;
+  OMX_U8 * p_map_;
+  size_t map_len_;
+  off_t offset_;
+  off_t readahead_end_;
   OMX_PARAM_CONTENTURITYPE * p_uri_param_;
   OMX_U32 counter_;
   bool eos_;
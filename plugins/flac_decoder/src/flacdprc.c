@@ -440,45 +440,6 @@ write_pcm_block_8 (uint8_t * ap_to, const FLAC__int32 * const ap_buffer[],
     }
 }
 
-static void
-write_pcm_block_16 (uint8_t * ap_to, const FLAC__int32 * const ap_buffer[],
-                    const unsigned int a_nsamples,
-                    const unsigned int a_nchannels)
-{
-  size_t i = 0;
-  size_t j = 0;
-  for (i = 0; i < a_nsamples; i += 2, ++j)
-    {
-      FLAC__int16 * out = (FLAC__int16 *) (ap_to) + i;
-      int k;
-      for (k = 0; k < a_nchannels; ++k)
-        {
-          out[k] = (FLAC__int16) ap_buffer[k][j];
-        }
-    }
-}
-
-static void
-write_pcm_block_24 (uint8_t * ap_to, const FLAC__int32 * const ap_buffer[],
-                    const unsigned int a_nsamples,
-                    const unsigned int a_nchannels)
-{
-  size_t i = 0;
-  size_t j = 0;
-  for (i = 0; i < a_nsamples; i += 2, ++j)
-    {
-      unsigned char * out = (unsigned char *) (ap_to) + (i * 3);
-      int k;
-      for (k = 0; k < a_nchannels; ++k)
-        {
-          unsigned long word32 = (unsigned long) ap_buffer[k][j];
-          *out++ = (unsigned char) (word32 >> 0);
-          *out++ = (unsigned char) (word32 >> 8);
-          *out++ = (unsigned char) (word32 >> 16);
-        }
-    }
-}
-
 static FLAC__StreamDecoderWriteStatus
 write_cb (const FLAC__StreamDecoder * ap_decoder, const FLAC__Frame * ap_frame,
           const FLAC__int32 * const ap_buffer[], void * ap_client_data)
@@ -517,6 +478,7 @@ write_cb (const FLAC__StreamDecoder * ap_decoder, const FLAC__Frame * ap_frame,
       if (nsamples * (p_prc->bps_ / 8) > p_out->nAllocLen)
         {
           nsamples = p_out->nAllocLen / (p_prc->bps_ / 8);
+          nsamples -= nsamples % ap_frame->header.channels;
         }
       assert (nsamples <= p_out->nAllocLen);
 
@@ -533,14 +495,16 @@ write_cb (const FLAC__StreamDecoder * ap_decoder, const FLAC__Frame * ap_frame,
               break;
             case 16:
               {
-                write_pcm_block_16 (p_to, ap_buffer, nsamples,
-                                    ap_frame->header.channels);
+                tiz_pcm_from_fixed (p_to, ETIZPcmFormatS16, ap_buffer,
+                                    ap_frame->header.channels,
+                                    nsamples / ap_frame->header.channels, 15);
               }
               break;
             case 24:
               {
-                write_pcm_block_24 (p_to, ap_buffer, nsamples,
-                                    ap_frame->header.channels);
+                tiz_pcm_from_fixed (p_to, ETIZPcmFormatS24, ap_buffer,
+                                    ap_frame->header.channels,
+                                    nsamples / ap_frame->header.channels, 23);
               }
               break;
             default:
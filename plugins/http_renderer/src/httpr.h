@@ -47,10 +47,12 @@ extern "C" {
 #define ARATELIA_HTTP_RENDERER_PORT_ALIGNMENT 0
 #define ARATELIA_HTTP_RENDERER_PORT_SUPPLIERPREF OMX_BufferSupplyInput
 #define ARATELIA_HTTP_RENDERER_DEFAULT_HTTP_SERVER_PORT 8010
+#define ARATELIA_HTTP_RENDERER_DEFAULT_MAX_CLIENTS 100
+#define ARATELIA_HTTP_RENDERER_DEFAULT_WORKER_THREADS 0
 
 #define ICE_DEFAULT_METADATA_INTERVAL 16000
 #define ICE_INITIAL_BURST_SIZE 128000
-#define ICE_MAX_CLIENTS_PER_MOUNTPOINT 10
+#define ICE_MAX_CLIENTS_PER_MOUNTPOINT ARATELIA_HTTP_RENDERER_DEFAULT_MAX_CLIENTS
 #define ICE_DEFAULT_HEADER_TIMEOUT 10
 #define ICE_LISTEN_QUEUE 5
 #define ICE_MIN_BURST_SIZE 1400
@@ -58,6 +60,14 @@ extern "C" {
 #define ICE_MAX_BURST_SIZE 4200    /* Not used for now */
 #define ICE_LISTENER_BUF_SIZE \
   (ICE_MAX_BURST_SIZE + OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE)
+#define ICE_RING_SIZE (512 * 1024) /* Default listener backlog */
+#define ICE_MIN_RING_SIZE (64 * 1024)
+#define ICE_METADATA_BLOCK_SIZE \
+  (1 + 16 * ((OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE + 15) / 16))
+#define ICE_MAX_IOVECS 8
+#define ICE_MAX_WORKER_THREADS 64
+#define ICE_MAX_EPOLL_EVENTS 256
+#define ICE_WORKER_STACK_SIZE (256 * 1024)
 
 #define ICE_SOCK_ERROR (int) -1
 
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <string.h>
 #include <limits.h>
+#include <stdlib.h>
 
 #include <tizplatform.h>
 
@@ -62,7 +63,18 @@ httpr_cfgport_ctor (void * ap_obj, va_list * app)
   p_obj->http_conf_.nVersion.nVersion = OMX_VERSION;
   p_obj->http_conf_.nListeningPort
     = ARATELIA_HTTP_RENDERER_DEFAULT_HTTP_SERVER_PORT;
-  p_obj->http_conf_.nMaxClients = 5;
+  p_obj->http_conf_.nMaxClients = ARATELIA_HTTP_RENDERER_DEFAULT_MAX_CLIENTS;
+
+  {
+    const char * p_max_clients
+      = tiz_rcfile_get_value (TIZ_RCFILE_PLUGINS_DATA_SECTION,
+                              ARATELIA_HTTP_RENDERER_COMPONENT_NAME
+                              ".max_clients");
+    if (p_max_clients && atoi (p_max_clients) > 0)
+      {
+        p_obj->http_conf_.nMaxClients = atoi (p_max_clients);
+      }
+  }
 
   return p_obj;
 }
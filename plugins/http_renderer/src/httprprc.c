@@ -33,6 +33,8 @@
 #endif
 
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include <OMX_Core.h>
 
@@ -148,6 +150,34 @@ retrieve_mountpoint_settings (const void * ap_prc,
   return OMX_ErrorNone;
 }
 
+static OMX_U32
+obtain_setting (httpr_prc_t * ap_prc, const char * ap_key,
+                const OMX_U32 a_default)
+{
+  char key[OMX_MAX_STRINGNAME_SIZE];
+  const char * p_value = NULL;
+  OMX_U32 value = a_default;
+
+  assert (ap_prc);
+  assert (ap_key);
+
+  snprintf (key, sizeof (key), "%s.%s", ARATELIA_HTTP_RENDERER_COMPONENT_NAME,
+            ap_key);
+  p_value = tiz_rcfile_get_value (TIZ_RCFILE_PLUGINS_DATA_SECTION, key);
+  if (p_value)
+    {
+      char * end = NULL;
+      long l = strtol (p_value, &end, 10);
+      if (p_value != end && l >= 0)
+        {
+          value = l;
+        }
+    }
+
+  TIZ_TRACE (handleOf (ap_prc), "%s = [%u]", key, (unsigned int) value);
+  return value;
+}
+
 /*
  * httprprc
  */
@@ -194,6 +224,9 @@ httpr_prc_allocate_resources (void * ap_prc, OMX_U32 a_pid)
                                                             * all
                                                             * interfaces. */
     p_prc->server_info_.nListeningPort, p_prc->server_info_.nMaxClients,
+    obtain_setting (p_prc, "listener_backlog", ICE_RING_SIZE),
+    obtain_setting (p_prc, "worker_threads",
+                    ARATELIA_HTTP_RENDERER_DEFAULT_WORKER_THREADS),
     buffer_emptied, buffer_needed, p_prc);
 }
 
@@ -299,7 +332,7 @@ httpr_prc_timer_ready (void * ap_prc, tiz_event_timer_t * ap_ev_timer,
   assert (p_prc);
   if (p_prc->p_server_)
     {
-      rc = httpr_srv_timer_event (p_prc->p_server_);
+      rc = httpr_srv_timer_event (p_prc->p_server_, ap_ev_timer);
     }
   return rc;
 }
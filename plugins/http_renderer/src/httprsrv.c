@@ -25,6 +25,16 @@
  *
  * NOTE: This is work in progress!!!!
  *
+ * The encoded stream is copied once into a ring that is shared by all the
+ * listeners of the mount point. Each listener only keeps a cursor into the
+ * ring, and its ICY metadata blocks are interleaved at send time.
+ *
+ * By default, everything runs on the component's thread, driven by its event
+ * loop. Alternatively, listeners may be served by a number of worker threads,
+ * each one with its own SO_REUSEPORT listening socket and edge-triggered
+ * epoll set. The component's thread then only fills the ring, when the
+ * workers ask for more data.
+ *
  * TODO: Better flow control
  *
  */
@@ -41,6 +51,8 @@
 #include <netinet/tcp.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
 #include <netdb.h>
 #include <string.h>
 #include <errno.h>
@@ -70,15 +82,22 @@ typedef struct httpr_connection httpr_connection_t;
 typedef struct httpr_listener httpr_listener_t;
 typedef struct httpr_listener_buffer httpr_listener_buffer_t;
 typedef struct httpr_mount httpr_mount_t;
+typedef struct httpr_ring httpr_ring_t;
+typedef struct httpr_worker httpr_worker_t;
 
 struct httpr_listener_buffer
 {
   unsigned int len;
-  unsigned int metadata_offset;
-  unsigned int metadata_bytes;
   char * p_data;
 };
 
+struct httpr_ring
+{
+  OMX_U8 * p_data;
+  size_t size;
+  uint64_t head; /* Stream position of the next byte to be written */
+};
+
 struct httpr_mount
 {
   OMX_U8 mount_name[OMX_MAX_STRINGNAME_SIZE];
@@ -107,20 +126,28 @@ struct httpr_connection
   unsigned short port;
   tiz_event_io_t * p_ev_io;
   tiz_event_timer_t * p_ev_timer;
+  double next_send; /* Worker threads only: time of the next burst */
+  bool blocked;     /* Worker threads only: waiting for EPOLLOUT */
 };
 
 struct httpr_listener
 {
   httpr_server_t * p_server;
+  httpr_worker_t * p_worker; /* NULL when served by the component's thread */
   httpr_connection_t * p_con;
   int respcode;
   long intro_offset;
-  unsigned long pos;
+  uint64_t cursor; /* Stream position of the next byte to be sent */
   httpr_listener_buffer_t buf;
   tiz_http_parser_t * p_parser;
   bool need_response;
   bool timer_started;
   bool want_metadata;
+  bool starved;
+  OMX_U8 metadata[ICE_METADATA_BLOCK_SIZE];
+  size_t to_metadata; /* Audio bytes left until the next metadata block */
+  unsigned int metadata_len;
+  unsigned int metadata_pos;
 };
 
 struct httpr_server
@@ -129,9 +156,9 @@ struct httpr_server
   int lstn_sockfd;
   char * p_ip;
   tiz_event_io_t * p_srv_ev_io;
-  OMX_U32 max_clients; /* In future, more than one will be allowed;
-                          only one allowed at the moment. */
+  OMX_U32 max_clients;
   tiz_map_t * p_lstnrs;
+  httpr_ring_t ring;
   OMX_BUFFERHEADERTYPE * p_hdr;
   httpr_srv_release_buffer_f pf_release_buf;
   httpr_srv_acquire_buffer_f pf_acquire_buf;
@@ -146,6 +173,27 @@ struct httpr_server
   double wait_time;
   double pkts_per_sec;
   httpr_mount_t mountpoint;
+  /* Worker threads */
+  OMX_U32 nworkers;
+  httpr_worker_t * p_workers;
+  tiz_mutex_t mutex;  /* Guards the ring, the client count and the title */
+  OMX_U32 nclients;
+  OMX_U32 title_gen;
+  int data_pipe[2];   /* Workers ask for more data through this pipe */
+};
+
+struct httpr_worker
+{
+  httpr_server_t * p_server;
+  OMX_U32 id;
+  int lstn_sockfd;
+  int epfd;
+  tiz_thread_t thread;
+  bool thread_started;
+  tiz_map_t * p_lstnrs;
+  uint64_t tail; /* Published under the server's mutex */
+  OMX_U32 title_gen;
+  OMX_U8 stream_title[OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE];
 };
 
 static void
@@ -216,6 +264,32 @@ srv_get_listeners_count (const httpr_server_t * ap_server)
   return rc;
 }
 
+static inline tiz_map_t *
+srv_get_listeners_map (const httpr_listener_t * ap_lstnr)
+{
+  assert (ap_lstnr);
+  return ap_lstnr->p_worker ? ap_lstnr->p_worker->p_lstnrs
+                            : ap_lstnr->p_server->p_lstnrs;
+}
+
+static OMX_U32
+srv_get_clients_count (httpr_server_t * ap_server)
+{
+  OMX_U32 nclients = 0;
+  assert (ap_server);
+  if (ap_server->nworkers > 0)
+    {
+      tiz_mutex_lock (&(ap_server->mutex));
+      nclients = ap_server->nclients;
+      tiz_mutex_unlock (&(ap_server->mutex));
+    }
+  else
+    {
+      nclients = srv_get_listeners_count (ap_server);
+    }
+  return nclients;
+}
+
 static httpr_listener_t *
 srv_get_first_listener (const httpr_server_t * ap_server)
 {
@@ -275,8 +349,9 @@ srv_set_keepalive (const int sock)
 }
 
 static int
-srv_accept_socket (httpr_server_t * ap_server, char * ap_ip,
-                   const size_t a_ip_len, unsigned short * ap_port)
+srv_accept_socket (httpr_server_t * ap_server, const int a_lstn_sockfd,
+                   char * ap_ip, const size_t a_ip_len,
+                   unsigned short * ap_port)
 {
 #define bail_on_accept_error(some_error, msg) \
   do                                          \
@@ -301,13 +376,17 @@ srv_accept_socket (httpr_server_t * ap_server, char * ap_ip,
   assert (ap_port);
   p_hdl = handleOf (ap_server->p_parent);
 
-  some_error = (!srv_is_valid_socket (ap_server->lstn_sockfd));
+  some_error = (!srv_is_valid_socket (a_lstn_sockfd));
   bail_on_accept_error (some_error, "Invalid server socket");
 
   errno = 0;
-  accepted_sockfd
-    = accept (ap_server->lstn_sockfd, (struct sockaddr *) &sa, &slen);
+  accepted_sockfd = accept (a_lstn_sockfd, (struct sockaddr *) &sa, &slen);
   some_error = (ICE_SOCK_ERROR == accepted_sockfd);
+  if (some_error && (EAGAIN == errno || EWOULDBLOCK == errno))
+    {
+      /* No more pending connections */
+      goto end;
+    }
   bail_on_accept_error (some_error, strerror (errno));
 
   if (0 != (err = getnameinfo ((struct sockaddr *) &sa, slen, ap_ip, a_ip_len,
@@ -347,7 +426,7 @@ end:
 
 static inline int
 srv_create_server_socket (httpr_server_t * ap_server, const int a_port,
-                          const char * a_interface)
+                          const char * a_interface, const bool a_reuse_port)
 {
   struct sockaddr_storage sa;
   struct addrinfo hints;
@@ -387,6 +466,15 @@ srv_create_server_socket (httpr_server_t * ap_server, const int a_port,
 
           setsockopt (sockfd, SOL_SOCKET, SO_REUSEADDR, (const void *) &on,
                       sizeof (on));
+#ifdef SO_REUSEPORT
+          if (a_reuse_port)
+            {
+              /* Let the kernel spread incoming connections over the
+                 workers' sockets */
+              setsockopt (sockfd, SOL_SOCKET, SO_REUSEPORT, (const void *) &on,
+                          sizeof (on));
+            }
+#endif
           on = 0;
 
           if (bind (sockfd, ai->ai_addr, ai->ai_addrlen) < 0)
@@ -420,7 +508,8 @@ srv_allocate_server_io_watcher (httpr_server_t * ap_server)
   assert (ap_server);
 
   rc = tiz_srv_io_watcher_init (
-    ap_server->p_parent, &(ap_server->p_srv_ev_io), ap_server->lstn_sockfd,
+    ap_server->p_parent, &(ap_server->p_srv_ev_io),
+    ap_server->nworkers > 0 ? ap_server->data_pipe[0] : ap_server->lstn_sockfd,
     TIZ_EVENT_READ, /* Interested in read events only */
     true            /* Only one event at a time */
     );
@@ -460,6 +549,12 @@ srv_start_listener_io_watcher (httpr_listener_t * ap_lstnr)
   assert (ap_lstnr);
   assert (ap_lstnr->p_server);
   assert (ap_lstnr->p_con);
+  if (ap_lstnr->p_worker)
+    {
+      /* The worker's epoll set tells when the socket is writable again */
+      ap_lstnr->p_con->blocked = true;
+      return OMX_ErrorNone;
+    }
   return tiz_srv_io_watcher_start (ap_lstnr->p_server->p_parent,
                                    ap_lstnr->p_con->p_ev_io);
 }
@@ -469,8 +564,11 @@ srv_stop_listener_io_watcher (httpr_listener_t * ap_lstnr)
 {
   assert (ap_lstnr);
   assert (ap_lstnr->p_con);
-  (void) tiz_srv_io_watcher_stop (ap_lstnr->p_server->p_parent,
-                                  ap_lstnr->p_con->p_ev_io);
+  if (!ap_lstnr->p_worker)
+    {
+      (void) tiz_srv_io_watcher_stop (ap_lstnr->p_server->p_parent,
+                                      ap_lstnr->p_con->p_ev_io);
+    }
 }
 
 static OMX_ERRORTYPE
@@ -479,7 +577,7 @@ srv_start_listener_timer_watcher (httpr_listener_t * ap_lstnr,
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (ap_lstnr);
-  if (!ap_lstnr->timer_started)
+  if (!ap_lstnr->timer_started && !ap_lstnr->p_worker)
     {
       assert (ap_lstnr->p_server);
       assert (ap_lstnr->p_con);
@@ -517,10 +615,17 @@ srv_destroy_connection (httpr_connection_t * ap_con)
       tiz_mem_free (ap_con->p_ip);
       tiz_mem_free (ap_con->p_host);
       assert (ap_con->p_lstnr && ap_con->p_lstnr->p_server);
-      tiz_srv_io_watcher_destroy (ap_con->p_lstnr->p_server->p_parent,
-                                  ap_con->p_ev_io);
-      tiz_srv_timer_watcher_destroy (ap_con->p_lstnr->p_server->p_parent,
-                                     ap_con->p_ev_timer);
+      /* NOTE: Worker threads' connections have no watchers */
+      if (ap_con->p_ev_io)
+        {
+          tiz_srv_io_watcher_destroy (ap_con->p_lstnr->p_server->p_parent,
+                                      ap_con->p_ev_io);
+        }
+      if (ap_con->p_ev_timer)
+        {
+          tiz_srv_timer_watcher_destroy (ap_con->p_lstnr->p_server->p_parent,
+                                         ap_con->p_ev_timer);
+        }
       tiz_mem_free (ap_con);
     }
 }
@@ -549,15 +654,22 @@ srv_remove_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
   assert (ap_server);
   assert (ap_lstnr);
 
-  nlstnrs = srv_get_listeners_count (ap_server);
+  nlstnrs = tiz_map_size (srv_get_listeners_map (ap_lstnr));
   assert (nlstnrs > 0);
 
   TIZ_LOG (TIZ_PRIORITY_TRACE,
            "Destroyed listener [%s] - [%d] listeners remaining",
            ap_lstnr->p_con->p_ip, nlstnrs - 1);
 
-  tiz_map_erase (ap_server->p_lstnrs, &ap_lstnr->p_con->sockfd);
-  assert (nlstnrs - 1 == srv_get_listeners_count (ap_server));
+  if (ap_lstnr->p_worker)
+    {
+      tiz_mutex_lock (&(ap_server->mutex));
+      assert (ap_server->nclients > 0);
+      ap_server->nclients--;
+      tiz_mutex_unlock (&(ap_server->mutex));
+    }
+
+  tiz_map_erase (srv_get_listeners_map (ap_lstnr), &ap_lstnr->p_con->sockfd);
 
   /* NOTE: No need to call srv_destroy_listener as this has been called already
    * by
@@ -594,6 +706,14 @@ srv_create_connection (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
   p_con->port = ap_port;
   p_con->p_ev_io = NULL;
   p_con->p_ev_timer = NULL;
+  p_con->next_send = 0;
+  p_con->blocked = false;
+
+  if (ap_lstnr->p_worker)
+    {
+      /* Worker threads use their own epoll sets instead */
+      goto end;
+    }
 
   /* We are interested in knowing when a listener socket is available for
    * writing */
@@ -615,9 +735,9 @@ end:
 }
 
 static OMX_ERRORTYPE
-srv_create_listener (httpr_server_t * ap_server, httpr_listener_t ** app_lstnr,
-                     const int a_connected_sockfd, char * ap_ip,
-                     const unsigned short ap_port)
+srv_create_listener (httpr_server_t * ap_server, httpr_worker_t * ap_worker,
+                     httpr_listener_t ** app_lstnr, const int a_connected_sockfd,
+                     char * ap_ip, const unsigned short ap_port)
 {
   OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
   httpr_listener_t * p_lstnr = NULL;
@@ -635,6 +755,7 @@ srv_create_listener (httpr_server_t * ap_server, httpr_listener_t ** app_lstnr,
   rc = p_lstnr ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
   goto_end_on_omx_error (rc, p_hdl, "Unable to alloc the listener structure");
 
+  p_lstnr->p_worker = ap_worker;
   p_con = srv_create_connection (ap_server, p_lstnr, a_connected_sockfd, ap_ip,
                                  ap_port, ap_server->wait_time);
   rc = p_con ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
@@ -644,14 +765,16 @@ srv_create_listener (httpr_server_t * ap_server, httpr_listener_t ** app_lstnr,
   p_lstnr->p_con = p_con;
   p_lstnr->respcode = 200;
   p_lstnr->intro_offset = 0;
-  p_lstnr->pos = 0;
+  p_lstnr->cursor = 0;
   p_lstnr->buf.len = ICE_LISTENER_BUF_SIZE;
-  p_lstnr->buf.metadata_offset = 0;
-  p_lstnr->buf.metadata_bytes = 0;
   p_lstnr->p_parser = NULL;
   p_lstnr->need_response = true;
   p_lstnr->timer_started = false;
   p_lstnr->want_metadata = false;
+  p_lstnr->starved = false;
+  p_lstnr->to_metadata = 0;
+  p_lstnr->metadata_len = 0;
+  p_lstnr->metadata_pos = 0;
 
   p_lstnr->buf.p_data = (char *) tiz_mem_alloc (ICE_LISTENER_BUF_SIZE);
   rc = p_lstnr->buf.p_data ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
@@ -927,7 +1050,7 @@ srv_handle_listeners_request (httpr_server_t * ap_server,
   assert (ap_lstnr->p_con);
   assert (ap_lstnr->p_parser);
 
-  some_error = (srv_get_listeners_count (ap_server) > ap_server->max_clients);
+  some_error = (srv_get_clients_count (ap_server) > ap_server->max_clients);
   bail_on_request_error (some_error, 400, "Client limit reached");
 
   /*   some_error */
@@ -1008,25 +1131,194 @@ srv_remove_existing_listener (OMX_PTR ap_key, OMX_PTR ap_value, OMX_PTR ap_arg)
 }
 
 inline static void
-srv_release_empty_buffer (httpr_server_t * ap_server,
-                          httpr_listener_t * ap_lstnr,
-                          OMX_BUFFERHEADERTYPE ** app_hdr)
+srv_release_empty_buffer (httpr_server_t * ap_server)
 {
   OMX_BUFFERHEADERTYPE * p_hdr = NULL;
 
   assert (ap_server);
-  assert (ap_lstnr);
-  assert (app_hdr);
+  assert (ap_server->p_hdr);
 
-  p_hdr = *app_hdr;
-
-  ap_lstnr->pos = 0;
+  p_hdr = ap_server->p_hdr;
   p_hdr->nFilledLen = 0;
   ap_server->pf_release_buf (p_hdr, ap_server->p_arg);
-  *app_hdr = NULL;
   ap_server->p_hdr = NULL;
 }
 
+static uint64_t
+srv_get_ring_tail (const httpr_server_t * ap_server)
+{
+  uint64_t tail = 0;
+  int nlstnrs = 0;
+  OMX_U32 i = 0;
+
+  assert (ap_server);
+
+  /* The tail is the oldest byte still referenced by a streaming listener;
+     everything before it may be overwritten. */
+  tail = ap_server->ring.head;
+  for (i = 0; i < ap_server->nworkers; ++i)
+    {
+      /* NOTE: Called with the server's mutex held */
+      tail = MIN (tail, ap_server->p_workers[i].tail);
+    }
+  nlstnrs = srv_get_listeners_count (ap_server);
+  for (i = 0; i < nlstnrs; ++i)
+    {
+      const httpr_listener_t * p_lstnr
+        = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+      if (!p_lstnr->need_response && p_lstnr->cursor < tail)
+        {
+          tail = p_lstnr->cursor;
+        }
+    }
+  return tail;
+}
+
+static uint64_t
+srv_get_burst_start (const httpr_server_t * ap_server)
+{
+  const httpr_ring_t * p_ring = NULL;
+  uint64_t burst = 0;
+
+  assert (ap_server);
+  p_ring = &(ap_server->ring);
+
+  /* A new listener's burst comes from data already in the ring. It is
+     limited to half the ring, so that the new listener does not become the
+     laggard the next time the ring is filled. */
+  burst = MIN (ap_server->mountpoint.initial_burst_size, p_ring->size / 2);
+  burst = MIN (burst, p_ring->head);
+  return p_ring->head - burst;
+}
+
+static void
+srv_remove_lagging_listeners (httpr_server_t * ap_server, const uint64_t a_tail)
+{
+  int i = 0;
+
+  assert (ap_server);
+
+  /* Iterate backwards, as removing a listener shifts the ones after it */
+  for (i = srv_get_listeners_count (ap_server) - 1; i >= 0; --i)
+    {
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+      if (!p_lstnr->need_response && p_lstnr->cursor == a_tail)
+        {
+          TIZ_NOTICE (handleOf (ap_server->p_parent),
+                      "Client [%s:%u] fd [%d] is too far behind. "
+                      "Will remove the listener",
+                      p_lstnr->p_con->p_ip, p_lstnr->p_con->port,
+                      p_lstnr->p_con->sockfd);
+          srv_remove_listener (ap_server, p_lstnr);
+        }
+    }
+}
+
+static OMX_ERRORTYPE
+srv_fill_ring (httpr_server_t * ap_server)
+{
+  httpr_ring_t * p_ring = NULL;
+  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
+  uint64_t tail = 0;
+  size_t to_copy = 0;
+  size_t offset = 0;
+  size_t first = 0;
+
+  assert (ap_server);
+  p_ring = &(ap_server->ring);
+  p_hdr = ap_server->p_hdr;
+
+  if (NULL == p_hdr)
+    {
+      if (NULL == (p_hdr = ap_server->pf_acquire_buf (ap_server->p_arg)))
+        {
+          /* no more buffers available at the moment */
+          ap_server->need_more_data = true;
+          return OMX_ErrorNoMore;
+        }
+      ap_server->need_more_data = false;
+      ap_server->p_hdr = p_hdr;
+    }
+
+  if (ap_server->nworkers > 0)
+    {
+      /* The workers read from the ring without holding the lock; their
+         published tails keep the copy below away from what they read. They
+         remove their own lagging listeners. */
+      tiz_mutex_lock (&(ap_server->mutex));
+    }
+
+  tail = srv_get_ring_tail (ap_server);
+  if (p_ring->head - tail >= p_ring->size && 0 == ap_server->nworkers)
+    {
+      /* The ring is full: the slowest listeners have fallen a whole ring
+         behind. Drop them rather than stall everybody else. */
+      srv_remove_lagging_listeners (ap_server, tail);
+      tail = srv_get_ring_tail (ap_server);
+    }
+
+  /* This is the only copy of the encoded data, no matter how many listeners
+     are connected. */
+  to_copy = MIN (p_ring->size - (size_t) (p_ring->head - tail),
+                 p_hdr->nFilledLen);
+  offset = p_ring->head % p_ring->size;
+  first = MIN (to_copy, p_ring->size - offset);
+  memcpy (p_ring->p_data + offset, p_hdr->pBuffer + p_hdr->nOffset, first);
+  memcpy (p_ring->p_data, p_hdr->pBuffer + p_hdr->nOffset + first,
+          to_copy - first);
+  p_ring->head += to_copy;
+  p_hdr->nFilledLen -= to_copy;
+  p_hdr->nOffset += to_copy;
+
+  if (ap_server->nworkers > 0)
+    {
+      tiz_mutex_unlock (&(ap_server->mutex));
+    }
+
+  if (0 == p_hdr->nFilledLen)
+    {
+      /* Buffer emptied */
+      srv_release_empty_buffer (ap_server);
+    }
+  else if (0 == to_copy)
+    {
+      /* The ring is full */
+      return OMX_ErrorNotReady;
+    }
+
+  return OMX_ErrorNone;
+}
+
+static void
+srv_start_streaming (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+{
+  assert (ap_server);
+  assert (ap_lstnr);
+
+  /* The request buffer is no longer needed; from now on the listener only
+     needs its position in the ring */
+  tiz_mem_free (ap_lstnr->buf.p_data);
+  ap_lstnr->buf.p_data = NULL;
+  ap_lstnr->buf.len = 0;
+  ap_lstnr->to_metadata = ap_server->mountpoint.metadata_period;
+
+  if (ap_lstnr->p_worker)
+    {
+      /* Publish the new cursor before the ring can move past it */
+      tiz_mutex_lock (&(ap_server->mutex));
+      ap_lstnr->cursor = srv_get_burst_start (ap_server);
+      ap_lstnr->p_worker->tail
+        = MIN (ap_lstnr->p_worker->tail, ap_lstnr->cursor);
+      tiz_mutex_unlock (&(ap_server->mutex));
+    }
+  else
+    {
+      ap_lstnr->cursor = srv_get_burst_start (ap_server);
+    }
+}
+
 static bool
 srv_is_listener_ready (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
 {
@@ -1057,202 +1349,90 @@ srv_is_listener_ready (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
             }
           lstnr_ready = false;
         }
+      else
+        {
+          srv_start_streaming (ap_server, ap_lstnr);
+        }
     }
   return lstnr_ready;
 }
 
 static inline bool
-srv_is_time_to_send_metadata (httpr_server_t * ap_server,
-                              httpr_listener_t * ap_lstnr)
-{
-  if (ap_lstnr->p_con->sent_total == 0)
-    {
-      return false;
-    }
-
-  if (((ap_lstnr->p_con->sent_total + ap_server->burst_size)
-       % ap_server->mountpoint.metadata_period)
-      <= ap_server->burst_size)
-    {
-      return true;
-    }
-
-  return false;
-}
-
-static inline size_t
-srv_get_metadata_offset (const httpr_server_t * ap_server,
-                         const httpr_listener_t * ap_lstnr)
-{
-  size_t offset = 0;
-  if (ap_lstnr->p_con->sent_total != 0)
-    {
-      offset = (ap_server->mountpoint.metadata_period
-                * ((ap_lstnr->p_con->sent_total + ap_server->burst_size)
-                   / ap_server->mountpoint.metadata_period))
-               - ap_lstnr->p_con->sent_total;
-    }
-
-  return offset;
-}
-
-static inline size_t
-srv_get_metadata_length (const httpr_server_t * ap_server,
-                         const httpr_listener_t * ap_lstnr)
+srv_is_metadata_listener (const httpr_server_t * ap_server,
+                          const httpr_listener_t * ap_lstnr)
 {
-  if (ap_lstnr->p_con->sent_total == 0 || ap_lstnr->p_con->metadata_delivered)
-    {
-      return 0;
-    }
-
-  return strnlen ((char *) ap_server->mountpoint.stream_title,
-                  OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE);
+  return ap_lstnr->want_metadata && ap_server->mountpoint.metadata_period > 0;
 }
 
-static void
-srv_arrange_metadata (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
-                      OMX_U8 ** app_buffer, size_t * ap_len)
+static size_t
+srv_build_metadata_block (const httpr_server_t * ap_server,
+                          httpr_listener_t * ap_lstnr)
 {
-  size_t len = 0;
-  httpr_listener_buffer_t * p_lstnr_buf = NULL;
+  const OMX_U8 * p_title = NULL;
+  size_t title_len = 0;
+  size_t nblocks = 0;
 
   assert (ap_server);
   assert (ap_lstnr);
-  assert (app_buffer);
-  assert (ap_len);
 
-  len = *ap_len;
-  p_lstnr_buf = &ap_lstnr->buf;
+  /* The stream title is sent once per change; in between, the block is just
+     a zero length byte */
+  /* Workers use their own copy of the title */
+  p_title = ap_lstnr->p_worker ? ap_lstnr->p_worker->stream_title
+                               : ap_server->mountpoint.stream_title;
 
-  if (0 == len || !ap_lstnr->want_metadata
-      || 0 == ap_server->mountpoint.metadata_period
-      || !srv_is_time_to_send_metadata (ap_server, ap_lstnr))
+  if (!ap_lstnr->p_con->metadata_delivered)
     {
-      /* p_lstnr_buf->metadata_bytes = 0; */
-      return;
+      title_len
+        = strnlen ((char *) p_title, OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE);
     }
 
-  {
-    OMX_U8 * p_buffer = *app_buffer;
-    size_t metadata_offset = srv_get_metadata_offset (ap_server, ap_lstnr);
-
-    if (metadata_offset < len && 0 == p_lstnr_buf->metadata_bytes)
-      {
-        OMX_U8 * p_dest = NULL;
-        OMX_U8 * p_src = NULL;
-        size_t metadata_len = srv_get_metadata_length (ap_server, ap_lstnr);
-        size_t metadata_total = 0;
-        size_t metadata_byte = 0;
-
-        if (metadata_len > 0)
-          {
-            metadata_byte = metadata_len / 16;
-            if (metadata_len % 16)
-              {
-                metadata_byte++;
-              }
-          }
-        else
-          {
-            metadata_byte = 0;
-          }
-
-        metadata_total = (metadata_byte * 16) + 1;
-        p_dest = p_buffer + metadata_offset + metadata_total;
-        p_src = p_buffer + metadata_offset;
-
-        /* Move content to make space for the metadata */
-        memmove (p_dest, p_src, len - metadata_offset);
-
-        p_lstnr_buf->metadata_bytes += metadata_total;
-        p_lstnr_buf->metadata_offset += metadata_offset;
-
-        if (metadata_len)
-          {
-            snprintf ((char *) p_src, metadata_total, "%c%s",
-                      (int) metadata_byte,
-                      (char *) ap_server->mountpoint.stream_title);
-            ap_lstnr->p_con->metadata_delivered = true;
-          }
-        else
-          {
-            p_src[0] = metadata_byte;
-          }
-
-        len += metadata_total;
-        p_lstnr_buf->len = len;
-
-        *ap_len = len;
-        *app_buffer = p_buffer;
-      }
-  }
+  nblocks = (title_len + 15) / 16;
+  assert (1 + nblocks * 16 <= ICE_METADATA_BLOCK_SIZE);
+  tiz_mem_set (ap_lstnr->metadata, 0, 1 + nblocks * 16);
+  ap_lstnr->metadata[0] = (OMX_U8) nblocks;
+  memcpy (ap_lstnr->metadata + 1, p_title, title_len);
+  return 1 + nblocks * 16;
 }
 
-static void
-srv_arrange_data (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
-                  OMX_U8 ** app_buffer, size_t * ap_len)
+static inline void
+srv_complete_metadata_block (httpr_listener_t * ap_lstnr)
 {
-  OMX_U8 * p_buffer = NULL;
-  size_t len = 0;
-  httpr_listener_buffer_t * p_lstnr_buf = NULL;
-  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
-
-  assert (ap_server);
   assert (ap_lstnr);
-  assert (app_buffer);
-  assert (ap_len);
-
-  p_lstnr_buf = &ap_lstnr->buf;
-  p_hdr = ap_server->p_hdr;
-
-  if (p_hdr && p_hdr->pBuffer && p_hdr->nFilledLen > 0)
+  if (ap_lstnr->metadata[0] > 0)
     {
-      int to_copy = 0;
-      if (ap_server->burst_size > p_lstnr_buf->len)
-        {
-          to_copy = ap_server->burst_size - p_lstnr_buf->len;
-        }
-      if (to_copy > p_hdr->nFilledLen)
-        {
-          to_copy = p_hdr->nFilledLen;
-        }
-      memcpy (p_lstnr_buf->p_data + p_lstnr_buf->len,
-              p_hdr->pBuffer + p_hdr->nOffset, to_copy);
-      p_lstnr_buf->len += to_copy;
-      p_hdr->nFilledLen -= to_copy;
-      p_hdr->nOffset += to_copy;
+      ap_lstnr->p_con->metadata_delivered = true;
     }
-
-  p_buffer = (OMX_U8 *) p_lstnr_buf->p_data;
-  len = p_lstnr_buf->len;
-
-  srv_arrange_metadata (ap_server, ap_lstnr, &p_buffer, &len);
-
-  *ap_len = len;
-  *app_buffer = p_buffer;
+  ap_lstnr->metadata_len = 0;
+  ap_lstnr->metadata_pos = 0;
 }
 
 static OMX_ERRORTYPE
 srv_write_to_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
-                       const void * ap_buffer, const size_t a_buf_len,
+                       struct iovec * ap_iov, const size_t a_iovlen,
                        int * a_bytes_written)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
-  int bytes = 0;
+  ssize_t bytes = 0;
   httpr_connection_t * p_con = NULL;
   int sock = ICE_SOCK_ERROR;
+  struct msghdr msg;
 
   assert (ap_server);
   assert (ap_lstnr);
-  assert (ap_buffer);
+  assert (ap_iov);
   assert (a_bytes_written);
 
   p_con = ap_lstnr->p_con;
   sock = p_con->sockfd;
   *a_bytes_written = 0;
-  errno = 0;
 
-  bytes = send (sock, (const void *) ap_buffer, a_buf_len, MSG_NOSIGNAL);
+  tiz_mem_set (&msg, 0, sizeof (msg));
+  msg.msg_iov = ap_iov;
+  msg.msg_iovlen = a_iovlen;
+
+  errno = 0;
+  bytes = sendmsg (sock, &msg, MSG_NOSIGNAL);
 
   if (bytes < 0)
     {
@@ -1282,148 +1462,217 @@ srv_write_to_listener (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
 }
 
 static OMX_ERRORTYPE
-srv_write_omx_buffer (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
+srv_write_ring_data (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr,
+                     const uint64_t a_head)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   httpr_connection_t * p_con = NULL;
-  int sock = ICE_SOCK_ERROR;
+  const httpr_ring_t * p_ring = NULL;
+  struct iovec iov[ICE_MAX_IOVECS];
+  bool is_metadata[ICE_MAX_IOVECS];
+  size_t niov = 0;
+  size_t len = 0;
+  size_t budget = 0;
+  size_t to_metadata = 0;
+  bool with_metadata = false;
+  size_t block_len = 0;
+  uint64_t pos = 0;
+  unsigned int audio_sent = 0;
+  int bytes = 0;
+  int remaining = 0;
+  size_t i = 0;
 
   assert (ap_server);
   assert (ap_lstnr);
   assert (ap_lstnr->p_con);
 
   p_con = ap_lstnr->p_con;
-  sock = p_con->sockfd;
-
+  p_ring = &(ap_server->ring);
   p_con->sent_last = 0;
 
-  if (!srv_is_valid_socket (sock))
+  if (!srv_is_valid_socket (p_con->sockfd))
     {
       TIZ_WARN (handleOf (ap_server->p_parent),
                 "Will destroy listener "
                 "(Invalid listener socket fd [%d])",
-                sock);
+                p_con->sockfd);
       /* The socket is not valid anymore. The listener will be removed. */
-      rc = OMX_ErrorNoMore;
+      return OMX_ErrorNoMore;
     }
-  else
-    {
-      httpr_listener_buffer_t * p_lstnr_buf = &ap_lstnr->buf;
-      OMX_U8 * p_buffer = NULL;
-      size_t len = 0;
-      int bytes = 0;
-
-      /* Obtain a pointer to the data and the amount of data to be written */
-      srv_arrange_data (ap_server, ap_lstnr, &p_buffer, &len);
 
-      if (len > 0)
-        {
-          int metadata_sent = 0;
-          tiz_check_omx (
-            srv_write_to_listener (ap_server, ap_lstnr, p_buffer, len, &bytes));
-          assert (bytes >= 0);
+  budget = p_con->initial_burst_bytes > 0
+             ? (size_t) p_con->initial_burst_bytes
+             : ap_server->burst_size - MIN (ap_server->burst_size,
+                                            p_con->burst_bytes);
 
-          p_lstnr_buf->len
-            = bytes > p_lstnr_buf->len ? 0 : (p_lstnr_buf->len - bytes);
+  /* Gather what is due to this listener straight from the ring: the rest of
+     a metadata block left over from a previous partial write, then audio up
+     to the budget, with at most one more metadata block interleaved at the
+     listener's next metadata boundary. */
+  if (ap_lstnr->metadata_pos < ap_lstnr->metadata_len)
+    {
+      iov[niov].iov_base = ap_lstnr->metadata + ap_lstnr->metadata_pos;
+      iov[niov].iov_len = ap_lstnr->metadata_len - ap_lstnr->metadata_pos;
+      is_metadata[niov++] = true;
+      len += iov[niov - 1].iov_len;
+      block_len = ap_lstnr->metadata_len;
+    }
 
-          if (p_lstnr_buf->len > 0)
-            {
-              memmove (p_lstnr_buf->p_data, p_lstnr_buf->p_data + bytes,
-                       p_lstnr_buf->len);
-            }
+  pos = ap_lstnr->cursor;
+  with_metadata = srv_is_metadata_listener (ap_server, ap_lstnr);
+  to_metadata = ap_lstnr->to_metadata;
+  while (budget > 0 && pos < a_head && niov < ICE_MAX_IOVECS - 1)
+    {
+      size_t offset = pos % p_ring->size;
+      size_t chunk = 0;
 
-          if (bytes > p_lstnr_buf->metadata_offset)
+      if (with_metadata && 0 == to_metadata)
+        {
+          if (block_len > 0)
             {
-              metadata_sent = MIN ((bytes - p_lstnr_buf->metadata_offset),
-                                   p_lstnr_buf->metadata_bytes);
+              /* Only one metadata block per write */
+              break;
             }
+          block_len = srv_build_metadata_block (ap_server, ap_lstnr);
+          iov[niov].iov_base = ap_lstnr->metadata;
+          iov[niov].iov_len = block_len;
+          is_metadata[niov++] = true;
+          len += block_len;
+          to_metadata = ap_server->mountpoint.metadata_period;
+          continue;
+        }
 
-          if (p_con->initial_burst_bytes > 0)
-            {
-              p_con->initial_burst_bytes -= (bytes - metadata_sent);
-            }
-          else
-            {
-              if (p_con->con_time == 0)
-                {
-                  p_con->con_time = time (NULL);
-                }
-            }
+      chunk = MIN (budget, (size_t) (a_head - pos));
+      chunk = MIN (chunk, p_ring->size - offset);
+      if (with_metadata)
+        {
+          chunk = MIN (chunk, to_metadata);
+          to_metadata -= chunk;
+        }
 
-          p_con->sent_total += (bytes - metadata_sent);
-          p_con->sent_last = (bytes - metadata_sent);
-          p_con->burst_bytes += (bytes - metadata_sent);
+      iov[niov].iov_base = p_ring->p_data + offset;
+      iov[niov].iov_len = chunk;
+      is_metadata[niov++] = false;
+      len += chunk;
+      pos += chunk;
+      budget -= chunk;
+    }
 
-          {
-            time_t t = time (NULL);
-            double d = difftime (t, p_con->con_time);
-            uint64_t rate = d ? p_con->sent_total / (uint64_t) d : 0;
-            TIZ_PRINTF_DBG_BLU (
-              "total [%lld] last [%d] burst [%d] time [%f] rate [%lld] "
-              "server burst [%d] bytes [%d]\n",
-              p_con->sent_total, p_con->sent_last, p_con->burst_bytes, d, rate,
-              ap_server->burst_size, bytes);
-          }
+  if (0 == niov)
+    {
+      return OMX_ErrorNone;
+    }
 
-          TIZ_PRINTF_DBG_GRN (
-            "metadata_bytes [%u] < metadata_offset [%u] metadata_sent [%u]\n",
-            p_lstnr_buf->metadata_bytes, p_lstnr_buf->metadata_offset,
-            metadata_sent);
+  tiz_check_omx (
+    srv_write_to_listener (ap_server, ap_lstnr, iov, niov, &bytes));
+  assert (bytes >= 0);
 
-          p_lstnr_buf->metadata_bytes -= metadata_sent;
-          if (p_lstnr_buf->metadata_offset > 0 && p_lstnr_buf->metadata_bytes)
-            {
-              p_lstnr_buf->metadata_offset -= ((unsigned int) bytes);
-            }
-          else
+  /* Now advance the listener's cursor and metadata state by what was
+     actually sent */
+  remaining = bytes;
+  for (i = 0; i < niov; ++i)
+    {
+      size_t sent = MIN ((size_t) remaining, iov[i].iov_len);
+      if (is_metadata[i])
+        {
+          if (iov[i].iov_base == ap_lstnr->metadata)
             {
-              p_lstnr_buf->metadata_offset = 0;
+              /* A new block, reached at a metadata boundary */
+              ap_lstnr->metadata_len = block_len;
+              ap_lstnr->metadata_pos = 0;
+              ap_lstnr->to_metadata = ap_server->mountpoint.metadata_period;
             }
-
-          if (bytes < len)
+          ap_lstnr->metadata_pos += sent;
+          if (ap_lstnr->metadata_pos == ap_lstnr->metadata_len)
             {
-              TIZ_PRINTF_DBG_RED (
-                "NEED TO STOP bytes [%d] < len [%u] p_lstnr_buf->len [%u]\n",
-                bytes, len, p_lstnr_buf->len);
-              (void) srv_start_listener_io_watcher (ap_lstnr);
-              srv_stop_listener_timer_watcher (ap_lstnr);
-              rc = OMX_ErrorNotReady;
+              srv_complete_metadata_block (ap_lstnr);
             }
-          else
+        }
+      else
+        {
+          ap_lstnr->cursor += sent;
+          audio_sent += sent;
+          if (with_metadata)
             {
-              if ((p_con->initial_burst_bytes <= 0)
-                  && (p_con->burst_bytes >= ap_server->burst_size))
-                {
-                  rc = srv_start_listener_timer_watcher (ap_lstnr,
-                                                         ap_server->wait_time);
-                }
+              ap_lstnr->to_metadata -= sent;
             }
         }
+      remaining -= sent;
+      if (sent < iov[i].iov_len)
+        {
+          /* Partial write */
+          break;
+        }
     }
 
-  return rc;
-}
-
-static OMX_ERRORTYPE
-srv_accept_connection (httpr_server_t * ap_server)
-{
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  char * p_ip = NULL;
-  httpr_listener_t * p_lstnr = NULL;
-  httpr_connection_t * p_con = NULL;
-  int connected_sockfd = ICE_SOCK_ERROR;
-  bool all_ok = false;
-  OMX_HANDLETYPE p_hdl = NULL;
-
-  assert (ap_server);
-  p_hdl = handleOf (ap_server->p_parent);
-
-  if (srv_get_listeners_count (ap_server) > 0)
+  if (p_con->initial_burst_bytes > 0)
     {
-      /* This is a simple solution to prevent more than one connection at
-       * a time. One day this could be a multi-client renderer */
-      tiz_map_for_each (ap_server->p_lstnrs, srv_remove_existing_listener,
-                        ap_server);
+      p_con->initial_burst_bytes -= audio_sent;
+    }
+  else
+    {
+      if (p_con->con_time == 0)
+        {
+          p_con->con_time = time (NULL);
+        }
+    }
+
+  p_con->sent_total += audio_sent;
+  p_con->sent_last = audio_sent;
+  p_con->burst_bytes += audio_sent;
+
+  {
+    time_t t = time (NULL);
+    double d = difftime (t, p_con->con_time);
+    uint64_t rate = d ? p_con->sent_total / (uint64_t) d : 0;
+    TIZ_PRINTF_DBG_BLU (
+      "total [%lld] last [%d] burst [%d] time [%f] rate [%lld] "
+      "server burst [%d] bytes [%d]\n",
+      p_con->sent_total, p_con->sent_last, p_con->burst_bytes, d, rate,
+      ap_server->burst_size, bytes);
+  }
+
+  if ((size_t) bytes < len)
+    {
+      TIZ_PRINTF_DBG_RED ("NEED TO STOP bytes [%d] < len [%u]\n", bytes,
+                          (unsigned int) len);
+      (void) srv_start_listener_io_watcher (ap_lstnr);
+      srv_stop_listener_timer_watcher (ap_lstnr);
+      rc = OMX_ErrorNotReady;
+    }
+  else
+    {
+      if ((p_con->initial_burst_bytes <= 0)
+          && (p_con->burst_bytes >= ap_server->burst_size))
+        {
+          rc = srv_start_listener_timer_watcher (ap_lstnr,
+                                                 ap_server->wait_time);
+        }
+    }
+
+  return rc;
+}
+
+static OMX_ERRORTYPE
+srv_accept_connection (httpr_server_t * ap_server)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  char * p_ip = NULL;
+  httpr_listener_t * p_lstnr = NULL;
+  httpr_connection_t * p_con = NULL;
+  int connected_sockfd = ICE_SOCK_ERROR;
+  bool all_ok = false;
+  OMX_HANDLETYPE p_hdl = NULL;
+
+  assert (ap_server);
+  p_hdl = handleOf (ap_server->p_parent);
+
+  if (ap_server->max_clients <= 1 && srv_get_listeners_count (ap_server) > 0)
+    {
+      /* When only one client is allowed, a new connection replaces the
+       * existing one */
+      tiz_map_for_each (ap_server->p_lstnrs, srv_remove_existing_listener,
+                        ap_server);
     }
 
   if ((p_ip = (char *) tiz_mem_alloc (ICE_RENDERER_MAX_ADDR_LEN)))
@@ -1432,12 +1681,13 @@ srv_accept_connection (httpr_server_t * ap_server)
       OMX_U32 index = 0;
 
       connected_sockfd
-        = srv_accept_socket (ap_server, p_ip, ICE_RENDERER_MAX_ADDR_LEN, &port);
+        = srv_accept_socket (ap_server, ap_server->lstn_sockfd, p_ip,
+                             ICE_RENDERER_MAX_ADDR_LEN, &port);
       goto_end_on_socket_error (connected_sockfd, p_hdl,
                                 "Unable to accept the connection");
 
-      rc = srv_create_listener (ap_server, &p_lstnr, connected_sockfd, p_ip,
-                                port);
+      rc = srv_create_listener (ap_server, NULL, &p_lstnr, connected_sockfd,
+                                p_ip, port);
       goto_end_on_omx_error (rc, p_hdl, "Unable to instantiate the listener");
 
       assert (p_lstnr);
@@ -1509,34 +1759,25 @@ end:
 }
 
 static OMX_ERRORTYPE
-srv_write (httpr_server_t * ap_server)
+srv_write (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
-  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
-  httpr_listener_t * p_lstnr = NULL;
   httpr_connection_t * p_con = NULL;
 
   assert (ap_server);
-
-  if (srv_get_listeners_count (ap_server) <= 0)
-    {
-      return OMX_ErrorNoMore;
-    }
-
-  /* Until support for multiple listeners gets implemented, there will only be
-     one listener in the map */
-  p_lstnr = srv_get_first_listener (ap_server);
-  assert (p_lstnr);
-  p_con = p_lstnr->p_con;
+  assert (ap_lstnr);
+  p_con = ap_lstnr->p_con;
   assert (p_con);
 
-  srv_stop_listener_io_watcher (p_lstnr);
-  if (!srv_is_listener_ready (ap_server, p_lstnr))
+  srv_stop_listener_io_watcher (ap_lstnr);
+  if (!srv_is_listener_ready (ap_server, ap_lstnr))
     {
+      /* NOTE: The listener may have been removed at this point */
       return OMX_ErrorNotReady;
     }
 
-  srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
+  ap_lstnr->starved = false;
+  srv_start_listener_timer_watcher (ap_lstnr, ap_server->wait_time);
 
   if (p_con->initial_burst_bytes <= 0)
     {
@@ -1545,25 +1786,24 @@ srv_write (httpr_server_t * ap_server)
 
   while (1)
     {
-      if (NULL == p_hdr)
+      if (ap_lstnr->cursor == ap_server->ring.head)
         {
-          if (NULL == (p_hdr = ap_server->pf_acquire_buf (ap_server->p_arg)))
+          /* This listener has caught up with the source */
+          if (OMX_ErrorNone != srv_fill_ring (ap_server))
             {
-              /* no more buffers available at the moment */
-              ap_server->need_more_data = true;
-              srv_stop_listener_timer_watcher (p_lstnr);
+              ap_lstnr->starved = true;
+              srv_stop_listener_timer_watcher (ap_lstnr);
               rc = OMX_ErrorNone;
               break;
             }
-          ap_server->need_more_data = false;
-          ap_server->p_hdr = p_hdr;
+          continue;
         }
 
-      rc = srv_write_omx_buffer (ap_server, p_lstnr);
+      rc = srv_write_ring_data (ap_server, ap_lstnr, ap_server->ring.head);
 
       if (OMX_ErrorNoMore == rc)
         {
-          srv_remove_listener (ap_server, p_lstnr);
+          srv_remove_listener (ap_server, ap_lstnr);
           break;
         }
 
@@ -1574,25 +1814,24 @@ srv_write (httpr_server_t * ap_server)
           rc = OMX_ErrorNotReady;
           break;
         }
-
-      /*       if (p_lstnr->pos == ap_server->p_hdr->nFilledLen) */
-      if (0 == ap_server->p_hdr->nFilledLen)
-        {
-          /* Buffer emptied */
-          (void) srv_release_empty_buffer (ap_server, p_lstnr, &p_hdr);
-        }
     };
 
   return rc;
 }
 
 static OMX_ERRORTYPE
-srv_stream_to_client (httpr_server_t * ap_server)
+srv_stream_to_client (httpr_server_t * ap_server, httpr_listener_t * ap_lstnr)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (ap_server);
 
-  rc = srv_write (ap_server);
+  if (!ap_lstnr)
+    {
+      /* No connected clients just yet */
+      return OMX_ErrorNone;
+    }
+
+  rc = srv_write (ap_server, ap_lstnr);
   switch (rc)
     {
       case OMX_ErrorNone:
@@ -1601,7 +1840,6 @@ srv_stream_to_client (httpr_server_t * ap_server)
          reached */
       case OMX_ErrorNotReady:
         {
-          /* No connected clients just yet */
           rc = OMX_ErrorNone;
         }
         break;
@@ -1617,11 +1855,516 @@ srv_stream_to_client (httpr_server_t * ap_server)
   return rc;
 }
 
+static OMX_ERRORTYPE
+srv_stream_to_starved_clients (httpr_server_t * ap_server)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  int i = 0;
+
+  assert (ap_server);
+
+  /* Iterate backwards, as listeners may be removed along the way */
+  for (i = srv_get_listeners_count (ap_server) - 1;
+       i >= 0 && OMX_ErrorNone == rc; --i)
+    {
+      httpr_listener_t * p_lstnr = NULL;
+      if (i >= srv_get_listeners_count (ap_server))
+        {
+          continue;
+        }
+      p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+      if (p_lstnr->starved)
+        {
+          rc = srv_stream_to_client (ap_server, p_lstnr);
+        }
+    }
+  return rc;
+}
+
+static httpr_listener_t *
+srv_find_listener_by_timer (const httpr_server_t * ap_server,
+                            const tiz_event_timer_t * ap_ev_timer)
+{
+  int nlstnrs = srv_get_listeners_count (ap_server);
+  int i = 0;
+  for (i = 0; i < nlstnrs; ++i)
+    {
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+      assert (p_lstnr);
+      if (p_lstnr->p_con->p_ev_timer == ap_ev_timer)
+        {
+          return p_lstnr;
+        }
+    }
+  return NULL;
+}
+
+/*                    */
+/* worker thread APIs */
+/*                    */
+
+static inline double
+srv_wkr_now (void)
+{
+  struct timespec ts;
+  (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void
+srv_wkr_request_data (httpr_worker_t * ap_wkr)
+{
+  const char req = 0;
+  assert (ap_wkr);
+  /* Errors are ignored; a full pipe means there are requests pending
+     already */
+  (void) write (ap_wkr->p_server->data_pipe[1], &req, 1);
+}
+
+static void
+srv_wkr_accept_connections (httpr_worker_t * ap_wkr)
+{
+  httpr_server_t * p_server = NULL;
+
+  assert (ap_wkr);
+  p_server = ap_wkr->p_server;
+
+  /* The listening socket is edge-triggered: accept until there are no more
+     pending connections */
+  while (1)
+    {
+      httpr_listener_t * p_lstnr = NULL;
+      struct epoll_event ev;
+      unsigned short port = 0;
+      OMX_U32 index = 0;
+      int sockfd = ICE_SOCK_ERROR;
+      char * p_ip = (char *) tiz_mem_alloc (ICE_RENDERER_MAX_ADDR_LEN);
+
+      if (!p_ip)
+        {
+          break;
+        }
+
+      sockfd = srv_accept_socket (p_server, ap_wkr->lstn_sockfd, p_ip,
+                                  ICE_RENDERER_MAX_ADDR_LEN, &port);
+      if (ICE_SOCK_ERROR == sockfd)
+        {
+          tiz_mem_free (p_ip);
+          break;
+        }
+
+      /* NOTE: On error, the listener has been destroyed already */
+      if (OMX_ErrorNone
+          != srv_create_listener (p_server, ap_wkr, &p_lstnr, sockfd, p_ip,
+                                  port))
+        {
+          break;
+        }
+
+      if (OMX_ErrorNone
+          != tiz_map_insert (ap_wkr->p_lstnrs, &(p_lstnr->p_con->sockfd),
+                             p_lstnr, &index))
+        {
+          srv_destroy_listener (p_lstnr);
+          break;
+        }
+
+      tiz_mutex_lock (&(p_server->mutex));
+      p_server->nclients++;
+      tiz_mutex_unlock (&(p_server->mutex));
+
+      tiz_mem_set (&ev, 0, sizeof (ev));
+      ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+      ev.data.fd = sockfd;
+      if (0 != epoll_ctl (ap_wkr->epfd, EPOLL_CTL_ADD, sockfd, &ev))
+        {
+          srv_remove_listener (p_server, p_lstnr);
+          continue;
+        }
+
+      TIZ_NOTICE (handleOf (p_server->p_parent),
+                  "Client [%s:%u] fd [%d] now connected (worker [%u])",
+                  p_lstnr->p_con->p_ip, p_lstnr->p_con->port, sockfd,
+                  ap_wkr->id);
+    }
+}
+
+static void
+srv_wkr_handle_request (httpr_worker_t * ap_wkr, httpr_listener_t * ap_lstnr)
+{
+  httpr_server_t * p_server = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (ap_wkr);
+  assert (ap_lstnr);
+  p_server = ap_wkr->p_server;
+
+  rc = srv_handle_listeners_request (p_server, ap_lstnr);
+  if (OMX_ErrorNone == rc)
+    {
+      srv_start_streaming (p_server, ap_lstnr);
+    }
+  else if (OMX_ErrorNotReady != rc)
+    {
+      TIZ_ERROR (handleOf (p_server->p_parent),
+                 "[%s] : while handling the "
+                 "listener's initial request. Will remove the listener",
+                 tiz_err_to_str (rc));
+      srv_remove_listener (p_server, ap_lstnr);
+    }
+  /* else: wait for the rest of the request */
+}
+
+static uint64_t
+srv_wkr_get_tail (const httpr_worker_t * ap_wkr, const uint64_t a_head)
+{
+  uint64_t tail = a_head;
+  int nlstnrs = tiz_map_size (ap_wkr->p_lstnrs);
+  int i = 0;
+  for (i = 0; i < nlstnrs; ++i)
+    {
+      const httpr_listener_t * p_lstnr
+        = tiz_map_value_at (ap_wkr->p_lstnrs, i);
+      assert (p_lstnr);
+      if (!p_lstnr->need_response && p_lstnr->cursor < tail)
+        {
+          tail = p_lstnr->cursor;
+        }
+    }
+  return tail;
+}
+
+static void
+srv_wkr_reset_metadata (httpr_worker_t * ap_wkr)
+{
+  httpr_server_t * p_server = ap_wkr->p_server;
+  int nlstnrs = tiz_map_size (ap_wkr->p_lstnrs);
+  int i = 0;
+  for (i = 0; i < nlstnrs; ++i)
+    {
+      httpr_listener_t * p_lstnr = tiz_map_value_at (ap_wkr->p_lstnrs, i);
+      assert (p_lstnr);
+      p_lstnr->p_con->metadata_delivered = false;
+      p_lstnr->p_con->initial_burst_bytes
+        = p_server->mountpoint.initial_burst_size * 0.1;
+    }
+}
+
+static bool
+srv_wkr_stream (httpr_worker_t * ap_wkr, httpr_listener_t * ap_lstnr,
+                const uint64_t a_head, const double a_now,
+                const double a_wait_time)
+{
+  httpr_server_t * p_server = NULL;
+  httpr_connection_t * p_con = NULL;
+  bool starved = false;
+
+  assert (ap_wkr);
+  assert (ap_lstnr);
+  p_server = ap_wkr->p_server;
+  p_con = ap_lstnr->p_con;
+
+  if (ap_lstnr->need_response || p_con->blocked || a_now < p_con->next_send)
+    {
+      return false;
+    }
+
+  if (p_con->initial_burst_bytes <= 0)
+    {
+      p_con->burst_bytes = 0;
+    }
+
+  while (1)
+    {
+      OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+      if (ap_lstnr->cursor == a_head)
+        {
+          /* This listener has caught up with the source */
+          starved = true;
+          break;
+        }
+
+      rc = srv_write_ring_data (p_server, ap_lstnr, a_head);
+
+      if (OMX_ErrorNoMore == rc)
+        {
+          srv_remove_listener (p_server, ap_lstnr);
+          break;
+        }
+
+      if (OMX_ErrorNotReady == rc)
+        {
+          /* Blocked until the next EPOLLOUT */
+          break;
+        }
+
+      if ((p_con->initial_burst_bytes <= 0)
+          && (p_con->burst_bytes >= p_server->burst_size))
+        {
+          p_con->next_send = a_now + a_wait_time;
+          break;
+        }
+    }
+
+  return starved;
+}
+
+static OMX_PTR
+srv_wkr_thread_func (OMX_PTR ap_arg)
+{
+  httpr_worker_t * p_wkr = ap_arg;
+  httpr_server_t * p_server = NULL;
+  struct epoll_event events[ICE_MAX_EPOLL_EVENTS];
+  double wait_time = 0;
+
+  assert (p_wkr);
+  p_server = p_wkr->p_server;
+  assert (p_server);
+
+  tiz_mutex_lock (&(p_server->mutex));
+  wait_time = p_server->wait_time;
+  tiz_mutex_unlock (&(p_server->mutex));
+
+  while (1)
+    {
+      uint64_t head = 0;
+      bool running = false;
+      bool title_changed = false;
+      bool starved = false;
+      double now = 0;
+      int nev = 0;
+      int i = 0;
+
+      nev = epoll_wait (p_wkr->epfd, events, ICE_MAX_EPOLL_EVENTS,
+                        MAX (1, (int) (wait_time * 1000)));
+
+      for (i = 0; i < nev; ++i)
+        {
+          int fd = events[i].data.fd;
+          httpr_listener_t * p_lstnr = NULL;
+
+          if (fd == p_wkr->lstn_sockfd)
+            {
+              srv_wkr_accept_connections (p_wkr);
+              continue;
+            }
+
+          if (!(p_lstnr = tiz_map_find (p_wkr->p_lstnrs, &fd)))
+            {
+              continue;
+            }
+
+          if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+              srv_remove_listener (p_server, p_lstnr);
+              continue;
+            }
+
+          if (events[i].events & EPOLLOUT)
+            {
+              p_lstnr->p_con->blocked = false;
+            }
+
+          if ((events[i].events & EPOLLIN) && p_lstnr->need_response)
+            {
+              srv_wkr_handle_request (p_wkr, p_lstnr);
+            }
+        }
+
+      /* Publish this worker's tail and pick up the latest state of the
+         stream */
+      tiz_mutex_lock (&(p_server->mutex));
+      running = p_server->running;
+      head = p_server->ring.head;
+      p_wkr->tail = srv_wkr_get_tail (p_wkr, head);
+      wait_time = p_server->wait_time;
+      if (p_wkr->title_gen != p_server->title_gen)
+        {
+          memcpy (p_wkr->stream_title, p_server->mountpoint.stream_title,
+                  sizeof (p_wkr->stream_title));
+          p_wkr->title_gen = p_server->title_gen;
+          title_changed = true;
+        }
+      tiz_mutex_unlock (&(p_server->mutex));
+
+      if (!running)
+        {
+          break;
+        }
+
+      if (title_changed)
+        {
+          srv_wkr_reset_metadata (p_wkr);
+        }
+
+      now = srv_wkr_now ();
+
+      /* Iterate backwards, as listeners may be removed along the way */
+      for (i = tiz_map_size (p_wkr->p_lstnrs) - 1; i >= 0; --i)
+        {
+          httpr_listener_t * p_lstnr = tiz_map_value_at (p_wkr->p_lstnrs, i);
+          assert (p_lstnr);
+          if (!p_lstnr->need_response
+              && head - p_lstnr->cursor >= p_server->ring.size)
+            {
+              /* The listener has fallen a whole ring behind */
+              TIZ_NOTICE (handleOf (p_server->p_parent),
+                          "Client [%s:%u] fd [%d] is too far behind. "
+                          "Will remove the listener",
+                          p_lstnr->p_con->p_ip, p_lstnr->p_con->port,
+                          p_lstnr->p_con->sockfd);
+              srv_remove_listener (p_server, p_lstnr);
+              continue;
+            }
+          if (srv_wkr_stream (p_wkr, p_lstnr, head, now, wait_time))
+            {
+              starved = true;
+            }
+        }
+
+      if (starved)
+        {
+          srv_wkr_request_data (p_wkr);
+        }
+    }
+
+  return NULL;
+}
+
+static void
+srv_wkr_destroy (httpr_worker_t * ap_wkr)
+{
+  assert (ap_wkr);
+  if (ap_wkr->p_lstnrs)
+    {
+      tiz_map_clear (ap_wkr->p_lstnrs);
+      tiz_map_destroy (ap_wkr->p_lstnrs);
+      ap_wkr->p_lstnrs = NULL;
+    }
+  if (ap_wkr->epfd >= 0)
+    {
+      close (ap_wkr->epfd);
+      ap_wkr->epfd = -1;
+    }
+  if (ICE_SOCK_ERROR != ap_wkr->lstn_sockfd)
+    {
+      close (ap_wkr->lstn_sockfd);
+      ap_wkr->lstn_sockfd = ICE_SOCK_ERROR;
+    }
+}
+
+static OMX_ERRORTYPE
+srv_wkr_init (httpr_server_t * ap_server, httpr_worker_t * ap_wkr,
+              const OMX_U32 a_id, const char * a_address, const int a_port)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorInsufficientResources;
+  OMX_HANDLETYPE p_hdl = NULL;
+
+  assert (ap_server);
+  assert (ap_wkr);
+  p_hdl = handleOf (ap_server->p_parent);
+
+  ap_wkr->p_server = ap_server;
+  ap_wkr->id = a_id;
+  ap_wkr->lstn_sockfd = ICE_SOCK_ERROR;
+  ap_wkr->epfd = -1;
+  ap_wkr->thread_started = false;
+  ap_wkr->p_lstnrs = NULL;
+  ap_wkr->tail = 0;
+  ap_wkr->title_gen = 0;
+  ap_wkr->stream_title[0] = '\0';
+
+  rc = tiz_map_init (&(ap_wkr->p_lstnrs), listeners_map_compare_func,
+                     listeners_map_free_func, NULL);
+  goto_end_on_omx_error (rc, p_hdl, "Unable to init the worker's listeners map");
+
+  rc = OMX_ErrorInsufficientResources;
+  ap_wkr->epfd = epoll_create1 (EPOLL_CLOEXEC);
+  goto_end_on_socket_error (ap_wkr->epfd, p_hdl,
+                            "Unable to create the worker's epoll set");
+
+  ap_wkr->lstn_sockfd
+    = srv_create_server_socket (ap_server, a_port, a_address, true);
+  goto_end_on_socket_error (ap_wkr->lstn_sockfd, p_hdl,
+                            "Unable to create the worker's server socket");
+
+  rc = OMX_ErrorNone;
+
+end:
+  return rc;
+}
+
+static OMX_ERRORTYPE
+srv_wkr_start (httpr_worker_t * ap_wkr)
+{
+  struct epoll_event ev;
+  char name[16];
+
+  assert (ap_wkr);
+
+  if (0 != listen (ap_wkr->lstn_sockfd, SOMAXCONN)
+      || 0 != srv_set_non_blocking (ap_wkr->lstn_sockfd))
+    {
+      return OMX_ErrorInsufficientResources;
+    }
+
+  tiz_mem_set (&ev, 0, sizeof (ev));
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.fd = ap_wkr->lstn_sockfd;
+  if (0 != epoll_ctl (ap_wkr->epfd, EPOLL_CTL_ADD, ap_wkr->lstn_sockfd, &ev)
+      && EEXIST != errno)
+    {
+      return OMX_ErrorInsufficientResources;
+    }
+
+  tiz_check_omx (tiz_thread_create (&(ap_wkr->thread),
+                                    ICE_WORKER_STACK_SIZE, 0,
+                                    srv_wkr_thread_func, ap_wkr));
+  ap_wkr->thread_started = true;
+  snprintf (name, sizeof (name), "tizhttpr-%u", (unsigned int) ap_wkr->id);
+  (void) tiz_thread_setname (&(ap_wkr->thread), name);
+  return OMX_ErrorNone;
+}
+
+static void
+srv_wkr_stop (httpr_worker_t * ap_wkr)
+{
+  assert (ap_wkr);
+  if (ap_wkr->thread_started)
+    {
+      void * p_result = NULL;
+      (void) tiz_thread_join (&(ap_wkr->thread), &p_result);
+      ap_wkr->thread_started = false;
+    }
+  /* The listeners go; the listening socket stays */
+  tiz_map_clear (ap_wkr->p_lstnrs);
+}
+
+static void
+srv_fill_ring_on_request (httpr_server_t * ap_server)
+{
+  char reqs[64];
+
+  assert (ap_server);
+
+  /* Drain the requests, and serve all of them with one buffer */
+  while (read (ap_server->data_pipe[0], reqs, sizeof (reqs)) > 0)
+    {
+    }
+
+  (void) srv_fill_ring (ap_server);
+}
+
 static int
 srv_get_descriptor (const httpr_server_t * ap_server)
 {
   assert (ap_server);
-  return ap_server->lstn_sockfd;
+  /* With worker threads, the component's thread only waits for requests for
+     more data */
+  return ap_server->nworkers > 0 ? ap_server->data_pipe[0]
+                                 : ap_server->lstn_sockfd;
 }
 
 /*               */
@@ -1633,6 +2376,7 @@ httpr_srv_destroy (httpr_server_t * ap_server)
 {
   if (ap_server)
     {
+      OMX_U32 i = 0;
       srv_destroy_server_io_watcher (ap_server);
       if (ICE_SOCK_ERROR != ap_server->lstn_sockfd)
         {
@@ -1645,6 +2389,23 @@ httpr_srv_destroy (httpr_server_t * ap_server)
           tiz_map_clear (ap_server->p_lstnrs);
           tiz_map_destroy (ap_server->p_lstnrs);
         }
+      if (ap_server->p_workers)
+        {
+          for (i = 0; i < ap_server->nworkers; ++i)
+            {
+              srv_wkr_destroy (&(ap_server->p_workers[i]));
+            }
+          tiz_mem_free (ap_server->p_workers);
+        }
+      for (i = 0; i < 2; ++i)
+        {
+          if (ap_server->data_pipe[i] >= 0)
+            {
+              close (ap_server->data_pipe[i]);
+            }
+        }
+      tiz_mutex_destroy (&(ap_server->mutex));
+      tiz_mem_free (ap_server->ring.p_data);
       tiz_mem_free (ap_server);
     }
 }
@@ -1652,12 +2413,14 @@ httpr_srv_destroy (httpr_server_t * ap_server)
 OMX_ERRORTYPE
 httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
                 OMX_STRING a_address, OMX_U32 a_port, OMX_U32 a_max_clients,
+                OMX_U32 a_listener_backlog, OMX_U32 a_nworkers,
                 httpr_srv_release_buffer_f a_pf_release_buf,
                 httpr_srv_acquire_buffer_f a_pf_acquire_buf, OMX_PTR ap_arg)
 {
   httpr_server_t * p_server = NULL;
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   bool all_ok = false;
+  OMX_U32 i = 0;
 
   assert (app_server);
   assert (ap_parent);
@@ -1669,12 +2432,29 @@ httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
   goto_end_on_omx_error (rc, handleOf (ap_parent),
                          "Unable to alloc the server struct");
 
+  if (OMX_ErrorNone != (rc = tiz_mutex_init (&(p_server->mutex))))
+    {
+      tiz_mem_free (p_server);
+      p_server = NULL;
+      goto end;
+    }
+
   p_server->p_parent = ap_parent;
   p_server->lstn_sockfd = ICE_SOCK_ERROR;
   p_server->p_ip = NULL;
   p_server->p_srv_ev_io = NULL;
   p_server->max_clients = a_max_clients;
   p_server->p_lstnrs = NULL;
+  p_server->ring.p_data = NULL;
+  /* The ring holds each listener's backlog */
+  p_server->ring.size = MAX (a_listener_backlog, ICE_MIN_RING_SIZE);
+  p_server->ring.head = 0;
+  p_server->nworkers = MIN (a_nworkers, ICE_MAX_WORKER_THREADS);
+  p_server->p_workers = NULL;
+  p_server->nclients = 0;
+  p_server->title_gen = 0;
+  p_server->data_pipe[0] = -1;
+  p_server->data_pipe[1] = -1;
   p_server->p_hdr = NULL;
   p_server->pf_release_buf = a_pf_release_buf;
   p_server->pf_acquire_buf = a_pf_acquire_buf;
@@ -1709,10 +2489,48 @@ httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
   goto_end_on_omx_error (rc, handleOf (ap_parent),
                          "Unable to init the listeners map");
 
-  p_server->lstn_sockfd
-    = srv_create_server_socket (p_server, a_port, a_address);
-  goto_end_on_socket_error (p_server->lstn_sockfd, handleOf (ap_parent),
-                            "Unable to create the server socket");
+  p_server->ring.p_data = (OMX_U8 *) tiz_mem_alloc (p_server->ring.size);
+  rc = p_server->ring.p_data ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+  goto_end_on_omx_error (rc, handleOf (ap_parent),
+                         "Unable to alloc the mount point's ring");
+
+  if (p_server->nworkers > 0)
+    {
+      p_server->p_workers = (httpr_worker_t *) tiz_mem_calloc (
+        p_server->nworkers, sizeof (httpr_worker_t));
+      rc = p_server->p_workers ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+      goto_end_on_omx_error (rc, handleOf (ap_parent),
+                             "Unable to alloc the worker threads");
+
+      for (i = 0; i < p_server->nworkers; ++i)
+        {
+          rc = srv_wkr_init (p_server, &(p_server->p_workers[i]), i, a_address,
+                             a_port);
+          goto_end_on_omx_error (rc, handleOf (ap_parent),
+                                 "Unable to init a worker thread");
+        }
+
+      goto_end_on_socket_error (pipe (p_server->data_pipe), handleOf (ap_parent),
+                                "Unable to create the data request pipe");
+      goto_end_on_socket_error (srv_set_non_blocking (p_server->data_pipe[0]),
+                                handleOf (ap_parent),
+                                "Unable to set the pipe as non-blocking");
+      goto_end_on_socket_error (srv_set_non_blocking (p_server->data_pipe[1]),
+                                handleOf (ap_parent),
+                                "Unable to set the pipe as non-blocking");
+
+      TIZ_NOTICE (handleOf (ap_parent),
+                  "Serving up to [%u] clients from [%u] worker threads",
+                  (unsigned int) a_max_clients,
+                  (unsigned int) p_server->nworkers);
+    }
+  else
+    {
+      p_server->lstn_sockfd
+        = srv_create_server_socket (p_server, a_port, a_address, false);
+      goto_end_on_socket_error (p_server->lstn_sockfd, handleOf (ap_parent),
+                                "Unable to create the server socket");
+    }
 
   rc = srv_allocate_server_io_watcher (p_server);
   goto_end_on_omx_error (rc, handleOf (ap_parent),
@@ -1744,18 +2562,39 @@ httpr_srv_start (httpr_server_t * ap_server)
   assert (ap_server);
   p_hdl = handleOf (ap_server->p_parent);
 
-  errno = 0;
-  listen_rc = listen (ap_server->lstn_sockfd, ICE_LISTEN_QUEUE);
-  goto_end_on_socket_error (listen_rc, p_hdl, strerror (errno));
+  if (ap_server->nworkers > 0)
+    {
+      OMX_U32 i = 0;
 
-  rc = srv_set_non_blocking (ap_server->lstn_sockfd);
-  goto_end_on_omx_error (rc, p_hdl, "Unable to set socket as non-blocking");
+      tiz_mutex_lock (&(ap_server->mutex));
+      ap_server->running = true;
+      tiz_mutex_unlock (&(ap_server->mutex));
+
+      for (i = 0; i < ap_server->nworkers; ++i)
+        {
+          ap_server->p_workers[i].tail = ap_server->ring.head;
+          rc = srv_wkr_start (&(ap_server->p_workers[i]));
+          goto_end_on_omx_error (rc, p_hdl, "Unable to start a worker thread");
+        }
+    }
+  else
+    {
+      errno = 0;
+      listen_rc = listen (ap_server->lstn_sockfd, ICE_LISTEN_QUEUE);
+      goto_end_on_socket_error (listen_rc, p_hdl, strerror (errno));
+
+      rc = srv_set_non_blocking (ap_server->lstn_sockfd);
+      goto_end_on_omx_error (rc, p_hdl,
+                             "Unable to set socket as non-blocking");
+    }
 
   rc = srv_start_server_io_watcher (ap_server);
   goto_end_on_omx_error (rc, p_hdl, "Unable to start the server io watcher");
 
   /* so far so good */
+  tiz_mutex_lock (&(ap_server->mutex));
   ap_server->running = true;
+  tiz_mutex_unlock (&(ap_server->mutex));
   all_ok = true;
 
 end:
@@ -1770,20 +2609,28 @@ OMX_ERRORTYPE
 httpr_srv_stop (httpr_server_t * ap_server)
 {
   httpr_listener_t * p_lstnr = NULL;
+  OMX_U32 i = 0;
   assert (ap_server);
   (void) srv_stop_server_io_watcher (ap_server);
-  if (ap_server->p_lstnrs)
+  if (ap_server->nworkers > 0)
     {
-      /* Until support for multiple listeners gets implemented, there will only
-         be one listener in the map */
-      p_lstnr = srv_get_first_listener (ap_server);
-      if (p_lstnr)
+      tiz_mutex_lock (&(ap_server->mutex));
+      ap_server->running = false;
+      tiz_mutex_unlock (&(ap_server->mutex));
+      for (i = 0; i < ap_server->nworkers; ++i)
         {
-          srv_stop_listener_io_watcher (p_lstnr);
-          srv_stop_listener_timer_watcher (p_lstnr);
-          srv_remove_listener (ap_server, p_lstnr);
+          srv_wkr_stop (&(ap_server->p_workers[i]));
         }
+      ap_server->nclients = 0;
+    }
+  while ((p_lstnr = srv_get_first_listener (ap_server)))
+    {
+      srv_stop_listener_io_watcher (p_lstnr);
+      srv_stop_listener_timer_watcher (p_lstnr);
+      srv_remove_listener (ap_server, p_lstnr);
     }
+  /* Stale data must not be served to the next listeners */
+  ap_server->ring.head = 0;
   ap_server->running = false;
   ap_server->need_more_data = false;
   return OMX_ErrorNone;
@@ -1808,6 +2655,9 @@ httpr_srv_set_mp3_settings (httpr_server_t * ap_server, const OMX_U32 a_bitrate,
 {
   assert (ap_server);
 
+  /* NOTE: Uncontended when there are no worker threads */
+  tiz_mutex_lock (&(ap_server->mutex));
+
   ap_server->bitrate = (a_bitrate != 0 ? a_bitrate : 448000);
   ap_server->num_channels = (a_num_channels != 0 ? a_num_channels : 2);
   ap_server->sample_rate = (a_sample_rate != 0 ? a_sample_rate : 44100);
@@ -1821,13 +2671,21 @@ httpr_srv_set_mp3_settings (httpr_server_t * ap_server, const OMX_U32 a_bitrate,
 
   ap_server->wait_time = (1 / ap_server->pkts_per_sec);
 
-  if (srv_get_listeners_count (ap_server) > 0)
-    {
-      httpr_listener_t * p_lstnr = srv_get_first_listener (ap_server);
-      assert (p_lstnr);
-      srv_stop_listener_timer_watcher (p_lstnr);
-      srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
-    }
+  tiz_mutex_unlock (&(ap_server->mutex));
+
+  {
+    int i = 0;
+    for (i = 0; i < srv_get_listeners_count (ap_server); ++i)
+      {
+        httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+        assert (p_lstnr);
+        if (!p_lstnr->starved)
+          {
+            srv_stop_listener_timer_watcher (p_lstnr);
+            srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
+          }
+      }
+  }
 
   TIZ_PRINTF_DBG_MAG (
     "burst [%d] sample rate [%u] bitrate [%u] "
@@ -1900,30 +2758,47 @@ httpr_srv_set_stream_title (httpr_server_t * ap_server,
 
   TIZ_PRINTF_DBG_YEL ("stream_title [%s]\n", ap_stream_title);
 
+  /* Worker threads pick up the new title on their next iteration */
+  tiz_mutex_lock (&(ap_server->mutex));
   strncpy ((char *) p_mount->stream_title, (char *) ap_stream_title,
            OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE);
   p_mount->stream_title[OMX_TIZONIA_MAX_SHOUTCAST_METADATA_SIZE - 1] = '\0';
+  ap_server->title_gen++;
+  tiz_mutex_unlock (&(ap_server->mutex));
 
-  if (srv_get_listeners_count (ap_server) > 0)
-    {
-      httpr_listener_t * p_lstnr = srv_get_first_listener (ap_server);
-      assert (p_lstnr);
-      assert (p_lstnr->p_con);
-      p_lstnr->p_con->metadata_delivered = false;
-      p_lstnr->p_con->initial_burst_bytes
-        = ap_server->mountpoint.initial_burst_size * 0.1;
-      srv_stop_listener_timer_watcher (p_lstnr);
-      srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
-    }
+  {
+    int i = 0;
+    for (i = 0; i < srv_get_listeners_count (ap_server); ++i)
+      {
+        httpr_listener_t * p_lstnr = tiz_map_value_at (ap_server->p_lstnrs, i);
+        assert (p_lstnr);
+        assert (p_lstnr->p_con);
+        p_lstnr->p_con->metadata_delivered = false;
+        p_lstnr->p_con->initial_burst_bytes
+          = ap_server->mountpoint.initial_burst_size * 0.1;
+        if (!p_lstnr->starved)
+          {
+            srv_stop_listener_timer_watcher (p_lstnr);
+            srv_start_listener_timer_watcher (p_lstnr, ap_server->wait_time);
+          }
+      }
+  }
 }
 
 OMX_ERRORTYPE
 httpr_srv_buffer_event (httpr_server_t * ap_server)
 {
   assert (ap_server);
-  return ((ap_server->running && ap_server->need_more_data)
-            ? srv_stream_to_client (ap_server)
-            : OMX_ErrorNone);
+  if (!ap_server->running || !ap_server->need_more_data)
+    {
+      return OMX_ErrorNone;
+    }
+  if (ap_server->nworkers > 0)
+    {
+      (void) srv_fill_ring (ap_server);
+      return OMX_ErrorNone;
+    }
+  return srv_stream_to_starved_clients (ap_server);
 }
 
 OMX_ERRORTYPE
@@ -1933,7 +2808,13 @@ httpr_srv_io_event (httpr_server_t * ap_server, const int a_fd)
   assert (ap_server);
   if (ap_server->running)
     {
-      if (a_fd == srv_get_descriptor (ap_server))
+      if (a_fd == srv_get_descriptor (ap_server) && ap_server->nworkers > 0)
+        {
+          /* The worker threads need more data */
+          srv_fill_ring_on_request (ap_server);
+          srv_start_server_io_watcher (ap_server);
+        }
+      else if (a_fd == srv_get_descriptor (ap_server))
         {
           /* A new connection event. Try to accept it */
           rc = srv_accept_connection (ap_server);
@@ -1945,15 +2826,21 @@ httpr_srv_io_event (httpr_server_t * ap_server, const int a_fd)
       else
         {
           /* The client socket is ready */
-          rc = srv_stream_to_client (ap_server);
+          int sockfd = a_fd;
+          rc = srv_stream_to_client (
+            ap_server, tiz_map_find (ap_server->p_lstnrs, &sockfd));
         }
     }
   return rc;
 }
 
 OMX_ERRORTYPE
-httpr_srv_timer_event (httpr_server_t * ap_server)
+httpr_srv_timer_event (httpr_server_t * ap_server,
+                       tiz_event_timer_t * ap_ev_timer)
 {
   assert (ap_server);
-  return ap_server->running ? srv_stream_to_client (ap_server) : OMX_ErrorNone;
+  return ap_server->running
+           ? srv_stream_to_client (
+             ap_server, srv_find_listener_by_timer (ap_server, ap_ev_timer))
+           : OMX_ErrorNone;
 }
@@ -36,6 +36,8 @@ extern "C" {
 #include <OMX_Core.h>
 #include <OMX_Types.h>
 
+#include <tizplatform.h>
+
 typedef struct httpr_server httpr_server_t;
 
 typedef void (*httpr_srv_release_buffer_f) (OMX_BUFFERHEADERTYPE * ap_hdr,
@@ -45,6 +47,7 @@ typedef OMX_BUFFERHEADERTYPE * (*httpr_srv_acquire_buffer_f) (OMX_PTR ap_arg);
 OMX_ERRORTYPE
 httpr_srv_init (httpr_server_t ** app_server, void * ap_parent,
                 OMX_STRING a_address, OMX_U32 a_port, OMX_U32 a_max_clients,
+                OMX_U32 a_listener_backlog, OMX_U32 a_nworkers,
                 httpr_srv_release_buffer_f a_pf_release_buf,
                 httpr_srv_acquire_buffer_f a_pf_acquire_buf, OMX_PTR ap_arg);
 
@@ -81,7 +84,8 @@ httpr_srv_buffer_event (httpr_server_t * ap_server);
 OMX_ERRORTYPE
 httpr_srv_io_event (httpr_server_t * ap_server, const int a_fd);
 OMX_ERRORTYPE
-httpr_srv_timer_event (httpr_server_t * ap_server);
+httpr_srv_timer_event (httpr_server_t * ap_server,
+                       tiz_event_timer_t * ap_ev_timer);
 
 #ifdef __cplusplus
 }
@@ -670,6 +670,24 @@ enqueue_playlist_items (gmusic_prc_t * ap_prc)
   return (rc == 0 ? OMX_ErrorNone : OMX_ErrorInsufficientResources);
 }
 
+static void
+update_buffer_status (gmusic_prc_t * ap_prc)
+{
+  tiz_urltrans_buffer_status_t status;
+  OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE bufferstatus;
+  assert (ap_prc);
+  tiz_urltrans_get_buffer_status (ap_prc->p_trans_, &status);
+  TIZ_INIT_OMX_PORT_STRUCT (bufferstatus, ARATELIA_HTTP_SOURCE_PORT_INDEX);
+  bufferstatus.nCapacity = status.capacity;
+  bufferstatus.nFillLevel = status.fill;
+  bufferstatus.nTargetLevel = status.target;
+  bufferstatus.nUnderruns = status.underruns;
+  bufferstatus.bBuffering = status.buffering ? OMX_TRUE : OMX_FALSE;
+  (void) tiz_krn_SetConfig_internal (
+    tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
+    OMX_TizoniaIndexConfigStreamingBufferStatus, &bufferstatus);
+}
+
 /*
  * gmusicprc
  */
@@ -755,6 +773,13 @@ gmusic_prc_allocate_resources (void * ap_obj, OMX_U32 a_pid)
                            p_prc->buffer_bytes_,
                            ARATELIA_HTTP_SOURCE_DEFAULT_RECONNECT_TIMEOUT,
                            buffer_cbacks, info_cbacks, io_cbacks, timer_cbacks);
+    if (OMX_ErrorNone == rc)
+      {
+        tiz_urltrans_set_streaming_buffer (
+          p_prc->p_trans_, (p_prc->bitrate_ * 1000) / 8,
+          p_prc->buffer_size_.nLowWaterMark,
+          p_prc->buffer_size_.nHighWaterMark);
+      }
   }
   return rc;
 }
@@ -818,8 +843,11 @@ static OMX_ERRORTYPE
 gmusic_prc_buffers_ready (const void * ap_prc)
 {
   gmusic_prc_t * p_prc = (gmusic_prc_t *) ap_prc;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (p_prc);
-  return tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  rc = tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  update_buffer_status (p_prc);
+  return rc;
 }
 
 static OMX_ERRORTYPE
@@ -58,6 +58,8 @@ httpsrc_port_ctor (void * ap_obj, va_list * app)
 
   tiz_check_omx_ret_null (
     tiz_port_register_index (p_obj, OMX_TizoniaIndexParamStreamingBuffer));
+  tiz_check_omx_ret_null (tiz_port_register_index (
+    p_obj, OMX_TizoniaIndexConfigStreamingBufferStatus));
   tiz_check_omx_ret_null (
     tiz_port_register_index (p_obj, OMX_IndexParamAudioMp3));
   tiz_check_omx_ret_null (
@@ -70,8 +72,18 @@ httpsrc_port_ctor (void * ap_obj, va_list * app)
   p_obj->buffertype_.nVersion.nVersion = OMX_VERSION;
   p_obj->buffertype_.nPortIndex = ARATELIA_HTTP_SOURCE_PORT_INDEX;
   p_obj->buffertype_.nCapacity = ARATELIA_HTTP_SOURCE_DEFAULT_BUFFER_SECONDS;
-  p_obj->buffertype_.nLowWaterMark = 90;
-  p_obj->buffertype_.nHighWaterMark = 10;
+  p_obj->buffertype_.nLowWaterMark = 0;
+  p_obj->buffertype_.nHighWaterMark = 100;
+
+  /* OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE */
+  p_obj->bufferstatus_.nSize = sizeof (OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE);
+  p_obj->bufferstatus_.nVersion.nVersion = OMX_VERSION;
+  p_obj->bufferstatus_.nPortIndex = ARATELIA_HTTP_SOURCE_PORT_INDEX;
+  p_obj->bufferstatus_.nCapacity = 0;
+  p_obj->bufferstatus_.nFillLevel = 0;
+  p_obj->bufferstatus_.nTargetLevel = 0;
+  p_obj->bufferstatus_.nUnderruns = 0;
+  p_obj->bufferstatus_.bBuffering = OMX_FALSE;
 
   /* OMX_AUDIO_PARAM_MP3TYPE */
   p_obj->mp3type_.nSize = sizeof (OMX_AUDIO_PARAM_MP3TYPE);
@@ -357,6 +369,67 @@ httpsrc_port_SetParameter (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
   return rc;
 }
 
+static OMX_ERRORTYPE
+httpsrc_port_GetConfig (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
+                        OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
+{
+  const httpsrc_port_t * p_obj = ap_obj;
+
+  assert (p_obj);
+
+  if (OMX_TizoniaIndexConfigStreamingBufferStatus == a_index)
+    {
+      OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE * p_bufferstatus
+        = (OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE *) ap_struct;
+      *p_bufferstatus = p_obj->bufferstatus_;
+      return OMX_ErrorNone;
+    }
+
+  /* Try the parent's indexes */
+  return super_GetConfig (typeOf (ap_obj, "httpsrcport"), ap_obj, ap_hdl,
+                          a_index, ap_struct);
+}
+
+static OMX_ERRORTYPE
+httpsrc_port_SetConfig (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
+                        OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
+{
+  assert (ap_obj);
+
+  if (OMX_TizoniaIndexConfigStreamingBufferStatus == a_index)
+    {
+      /* The status is read-only for the IL client */
+      return OMX_ErrorUnsupportedSetting;
+    }
+
+  /* Try the parent's indexes */
+  return super_SetConfig (typeOf (ap_obj, "httpsrcport"), ap_obj, ap_hdl,
+                          a_index, ap_struct);
+}
+
+static OMX_ERRORTYPE
+httpsrc_port_SetConfig_internal (const void * ap_obj, OMX_HANDLETYPE ap_hdl,
+                                 OMX_INDEXTYPE a_index, OMX_PTR ap_struct)
+{
+  httpsrc_port_t * p_obj = (httpsrc_port_t *) ap_obj;
+
+  assert (p_obj);
+
+  if (OMX_TizoniaIndexConfigStreamingBufferStatus == a_index)
+    {
+      const OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE * p_bufferstatus
+        = (OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE *) ap_struct;
+      p_obj->bufferstatus_.nCapacity = p_bufferstatus->nCapacity;
+      p_obj->bufferstatus_.nFillLevel = p_bufferstatus->nFillLevel;
+      p_obj->bufferstatus_.nTargetLevel = p_bufferstatus->nTargetLevel;
+      p_obj->bufferstatus_.nUnderruns = p_bufferstatus->nUnderruns;
+      p_obj->bufferstatus_.bBuffering = p_bufferstatus->bBuffering;
+      return OMX_ErrorNone;
+    }
+
+  return httpsrc_port_SetConfig (ap_obj, ap_hdl, a_index, ap_struct);
+}
+
 static bool
 httpsrc_port_check_tunnel_compat (const void * ap_obj,
                                   OMX_PARAM_PORTDEFINITIONTYPE * ap_this_def,
@@ -653,6 +726,12 @@ httpsrc_port_init (void * ap_tos, void * ap_hdl)
      /* TIZ_CLASS_COMMENT: */
      tiz_api_SetParameter, httpsrc_port_SetParameter,
      /* TIZ_CLASS_COMMENT: */
+     tiz_api_GetConfig, httpsrc_port_GetConfig,
+     /* TIZ_CLASS_COMMENT: */
+     tiz_api_SetConfig, httpsrc_port_SetConfig,
+     /* TIZ_CLASS_COMMENT: */
+     tiz_port_SetConfig_internal, httpsrc_port_SetConfig_internal,
+     /* TIZ_CLASS_COMMENT: */
      tiz_port_check_tunnel_compat, httpsrc_port_check_tunnel_compat,
      /* TIZ_CLASS_COMMENT: */
      tiz_port_apply_slaving_behaviour, httpsrc_port_apply_slaving_behaviour,
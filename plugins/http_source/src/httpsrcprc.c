@@ -390,6 +390,8 @@ update_cache_size (httpsrc_prc_t * ap_prc)
     {
       tiz_urltrans_set_internal_buffer_size (ap_prc->p_trans_,
                                              ap_prc->buffer_bytes_);
+      tiz_urltrans_set_streaming_buffer (
+        ap_prc->p_trans_, (ap_prc->bitrate_ * 1000) / 8, 0, 100);
     }
 }
 
@@ -732,6 +734,24 @@ prepare_for_port_auto_detection (httpsrc_prc_t * ap_prc)
   return OMX_ErrorNone;
 }
 
+static void
+update_buffer_status (httpsrc_prc_t * ap_prc)
+{
+  tiz_urltrans_buffer_status_t status;
+  OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE bufferstatus;
+  assert (ap_prc);
+  tiz_urltrans_get_buffer_status (ap_prc->p_trans_, &status);
+  TIZ_INIT_OMX_PORT_STRUCT (bufferstatus, ARATELIA_HTTP_SOURCE_PORT_INDEX);
+  bufferstatus.nCapacity = status.capacity;
+  bufferstatus.nFillLevel = status.fill;
+  bufferstatus.nTargetLevel = status.target;
+  bufferstatus.nUnderruns = status.underruns;
+  bufferstatus.bBuffering = status.buffering ? OMX_TRUE : OMX_FALSE;
+  (void) tiz_krn_SetConfig_internal (
+    tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
+    OMX_TizoniaIndexConfigStreamingBufferStatus, &bufferstatus);
+}
+
 /*
  * httpsrcprc
  */
@@ -795,6 +815,10 @@ httpsrc_prc_allocate_resources (void * ap_obj, OMX_U32 a_pid)
                            ARATELIA_HTTP_SOURCE_PORT_MIN_BUF_SIZE,
                            ARATELIA_HTTP_SOURCE_DEFAULT_RECONNECT_TIMEOUT,
                            buffer_cbacks, info_cbacks, io_cbacks, timer_cbacks);
+    if (OMX_ErrorNone == rc)
+      {
+        update_cache_size (p_prc);
+      }
   }
   return rc;
 }
@@ -857,8 +881,11 @@ static OMX_ERRORTYPE
 httpsrc_prc_buffers_ready (const void * ap_prc)
 {
   httpsrc_prc_t * p_prc = (httpsrc_prc_t *) ap_prc;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (p_prc);
-  return tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  rc = tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  update_buffer_status (p_prc);
+  return rc;
 }
 
 static OMX_ERRORTYPE
@@ -30,6 +30,7 @@
 #include <config.h>
 #endif
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <errno.h>
@@ -404,6 +405,23 @@ obtain_next_url (scloud_prc_t * ap_prc, int a_skip_value)
   return rc;
 }
 
+/* Stream URLs carry an expiring token; cache the audio under the track's
+   permalink instead */
+static void
+set_cache_key (scloud_prc_t * ap_prc)
+{
+  const char * p_permalink = NULL;
+  char key[PATH_MAX];
+  assert (ap_prc);
+  assert (ap_prc->p_trans_);
+  p_permalink = tiz_scloud_get_current_track_permalink (ap_prc->p_scloud_);
+  if (p_permalink)
+    {
+      (void) snprintf (key, sizeof (key), "soundcloud:%s", p_permalink);
+    }
+  tiz_urltrans_set_cache_key (ap_prc->p_trans_, p_permalink ? key : NULL);
+}
+
 static OMX_ERRORTYPE
 release_buffer (scloud_prc_t * ap_prc)
 {
@@ -646,6 +664,24 @@ enqueue_playlist_items (scloud_prc_t * ap_prc)
   return (rc == 0 ? OMX_ErrorNone : OMX_ErrorInsufficientResources);
 }
 
+static void
+update_buffer_status (scloud_prc_t * ap_prc)
+{
+  tiz_urltrans_buffer_status_t status;
+  OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE bufferstatus;
+  assert (ap_prc);
+  tiz_urltrans_get_buffer_status (ap_prc->p_trans_, &status);
+  TIZ_INIT_OMX_PORT_STRUCT (bufferstatus, ARATELIA_HTTP_SOURCE_PORT_INDEX);
+  bufferstatus.nCapacity = status.capacity;
+  bufferstatus.nFillLevel = status.fill;
+  bufferstatus.nTargetLevel = status.target;
+  bufferstatus.nUnderruns = status.underruns;
+  bufferstatus.bBuffering = status.buffering ? OMX_TRUE : OMX_FALSE;
+  (void) tiz_krn_SetConfig_internal (
+    tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
+    OMX_TizoniaIndexConfigStreamingBufferStatus, &bufferstatus);
+}
+
 /*
  * scloudprc
  */
@@ -722,6 +758,14 @@ scloud_prc_allocate_resources (void * ap_obj, OMX_U32 a_pid)
                            p_prc->buffer_bytes_,
                            ARATELIA_HTTP_SOURCE_DEFAULT_RECONNECT_TIMEOUT,
                            buffer_cbacks, info_cbacks, io_cbacks, timer_cbacks);
+    if (OMX_ErrorNone == rc)
+      {
+        tiz_urltrans_set_streaming_buffer (
+          p_prc->p_trans_, (p_prc->bitrate_ * 1000) / 8,
+          p_prc->buffer_size_.nLowWaterMark,
+          p_prc->buffer_size_.nHighWaterMark);
+        set_cache_key (p_prc);
+      }
   }
   return rc;
 }
@@ -784,8 +828,11 @@ static OMX_ERRORTYPE
 scloud_prc_buffers_ready (const void * ap_prc)
 {
   scloud_prc_t * p_prc = (scloud_prc_t *) ap_prc;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (p_prc);
-  return tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  rc = tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  update_buffer_status (p_prc);
+  return rc;
 }
 
 static OMX_ERRORTYPE
@@ -886,6 +933,7 @@ scloud_prc_config_change (void * ap_prc, OMX_U32 TIZ_UNUSED (a_pid),
       /* Changing the URL has the side effect of halting the current
          download */
       tiz_urltrans_set_uri (p_prc->p_trans_, p_prc->p_uri_param_);
+      set_cache_key (p_prc);
       if (p_prc->port_disabled_)
         {
           /* Record that the URI has changed, so that when the port is
@@ -30,6 +30,7 @@
 #include <config.h>
 #endif
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <errno.h>
@@ -467,6 +468,25 @@ obtain_next_url (youtube_prc_t * ap_prc, int a_skip_value)
   return rc;
 }
 
+/* Stream URLs carry an expiring signature; cache the audio under the video
+   id instead */
+static void
+set_cache_key (youtube_prc_t * ap_prc)
+{
+  const char * p_id = NULL;
+  char key[PATH_MAX];
+  assert (ap_prc);
+  assert (ap_prc->p_trans_);
+  p_id = tiz_youtube_get_current_audio_stream_video_id (ap_prc->p_youtube_);
+  if (p_id)
+    {
+      (void) snprintf (key, sizeof (key), "youtube:%s.%s", p_id,
+                       tiz_youtube_get_current_audio_stream_file_extension (
+                         ap_prc->p_youtube_));
+    }
+  tiz_urltrans_set_cache_key (ap_prc->p_trans_, p_id ? key : NULL);
+}
+
 static OMX_ERRORTYPE
 release_buffer (youtube_prc_t * ap_prc)
 {
@@ -730,6 +750,24 @@ enqueue_playlist_items (youtube_prc_t * ap_prc)
   return (rc == 0 ? OMX_ErrorNone : OMX_ErrorInsufficientResources);
 }
 
+static void
+update_buffer_status (youtube_prc_t * ap_prc)
+{
+  tiz_urltrans_buffer_status_t status;
+  OMX_TIZONIA_STREAMINGBUFFERSTATUSTYPE bufferstatus;
+  assert (ap_prc);
+  tiz_urltrans_get_buffer_status (ap_prc->p_trans_, &status);
+  TIZ_INIT_OMX_PORT_STRUCT (bufferstatus, ARATELIA_HTTP_SOURCE_PORT_INDEX);
+  bufferstatus.nCapacity = status.capacity;
+  bufferstatus.nFillLevel = status.fill;
+  bufferstatus.nTargetLevel = status.target;
+  bufferstatus.nUnderruns = status.underruns;
+  bufferstatus.bBuffering = status.buffering ? OMX_TRUE : OMX_FALSE;
+  (void) tiz_krn_SetConfig_internal (
+    tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
+    OMX_TizoniaIndexConfigStreamingBufferStatus, &bufferstatus);
+}
+
 /*
  * youtubeprc
  */
@@ -810,6 +848,14 @@ youtube_prc_allocate_resources (void * ap_obj, OMX_U32 a_pid)
                            p_prc->buffer_bytes_,
                            ARATELIA_HTTP_SOURCE_DEFAULT_RECONNECT_TIMEOUT,
                            buffer_cbacks, info_cbacks, io_cbacks, timer_cbacks);
+    if (OMX_ErrorNone == rc)
+      {
+        tiz_urltrans_set_streaming_buffer (
+          p_prc->p_trans_, (p_prc->bitrate_ * 1000) / 8,
+          p_prc->buffer_size_.nLowWaterMark,
+          p_prc->buffer_size_.nHighWaterMark);
+        set_cache_key (p_prc);
+      }
   }
   return rc;
 }
@@ -872,8 +918,11 @@ static OMX_ERRORTYPE
 youtube_prc_buffers_ready (const void * ap_prc)
 {
   youtube_prc_t * p_prc = (youtube_prc_t *) ap_prc;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (p_prc);
-  return tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  rc = tiz_urltrans_on_buffers_ready (p_prc->p_trans_);
+  update_buffer_status (p_prc);
+  return rc;
 }
 
 static OMX_ERRORTYPE
@@ -974,6 +1023,7 @@ youtube_prc_config_change (void * ap_prc, OMX_U32 TIZ_UNUSED (a_pid),
       /* Changing the URL has the side effect of halting the current
          download */
       tiz_urltrans_set_uri (p_prc->p_trans_, p_prc->p_uri_param_);
+      set_cache_key (p_prc);
       if (p_prc->port_disabled_)
         {
           /* Record that the URI has changed, so that when the port is
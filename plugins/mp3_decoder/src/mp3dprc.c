@@ -31,7 +31,6 @@
 #endif
 
 #include <assert.h>
-#include <limits.h>
 #include <string.h>
 
 #include <tizplatform.h>
@@ -280,46 +279,6 @@ store_stream_metadata (mp3d_prc_t * ap_prc, struct mad_header * Header)
              Emphasis, Header->samplerate);
 }
 
-static signed short
-mad_fixed_to_sshort (mad_fixed_t fixed)
-{
-  /* A fixed point number is formed of the following bit pattern:
-   *
-   * SWWWFFFFFFFFFFFFFFFFFFFFFFFFFFFF
-   * MSB                          LSB
-   * S ==> Sign (0 is positive, 1 is negative)
-   * W ==> Whole part bits
-   * F ==> Fractional part bits
-   *
-   * This pattern contains MAD_F_FRACBITS fractional bits, one
-   * should alway use this macro when working on the bits of a fixed
-   * point number. It is not guaranteed to be constant over the
-   * different platforms supported by libmad.
-   *
-   * The signed short value is formed, after clipping, by the least
-   * significant whole part bit, followed by the 15 most significant
-   * fractional part bits. Warning: this is a quick and dirty way to
-   * compute the 16-bit number, madplay includes much better
-   * algorithms.
-   */
-
-  /* Clipping */
-  if (fixed >= MAD_F_ONE)
-    {
-      return (SHRT_MAX);
-    }
-
-  if (fixed <= -MAD_F_ONE)
-    {
-      return (-SHRT_MAX);
-    }
-
-  /* Conversion. */
-  fixed = fixed >> (MAD_F_FRACBITS - 15);
-
-  return (signed short) fixed;
-}
-
 static size_t
 read_from_omx_buffer (const mp3d_prc_t * ap_prc, void * ap_dst, size_t bytes,
                       OMX_BUFFERHEADERTYPE * ap_hdr)
@@ -385,65 +344,80 @@ static int
 synthesize_samples (const void * ap_obj, int next_sample)
 {
   mp3d_prc_t * p_prc = (mp3d_prc_t *) ap_obj;
-  const unsigned char * p_bufend
-    = p_prc->p_outhdr_->pBuffer + p_prc->p_outhdr_->nAllocLen;
-  unsigned char * p_output
-    = p_prc->p_outhdr_->pBuffer + p_prc->p_outhdr_->nFilledLen;
-  bool buffer_full = (p_bufend == p_output);
-  int i;
-
-  for (i = next_sample; i < p_prc->synth_.pcm.length && !buffer_full; i++)
+  /* We're outputting two channels, also for mono streams. */
+  const OMX_U32 nchannels = 2;
+  const size_t sample_size = tiz_pcm_sample_size (p_prc->pcm_format_);
+  const size_t frame_size = nchannels * sample_size;
+  const OMX_U32 early_len
+    = (OMX_U32) (ARATELIA_MP3_DECODER_PORT_MIN_OUTPUT_BUF_SIZE * .2);
+  const mad_fixed_t * planes[2];
+  bool buffer_full = false;
+  int i = next_sample;
+
+  /* If the decoded stream is monophonic then the right output channel is
+   * the same as the left one. */
+  planes[0] = p_prc->synth_.pcm.samples[0];
+  planes[1] = p_prc->synth_.pcm.samples[0];
+  if (MAD_NCHANNELS (&p_prc->frame_.header) == 2)
     {
-      signed short sample;
+      planes[1] = p_prc->synth_.pcm.samples[1];
+    }
 
-      /* Left channel */
-      sample = mad_fixed_to_sshort (p_prc->synth_.pcm.samples[0][i]);
-      *(p_output++) = sample >> 8;
-      *(p_output++) = sample & 0xff;
+  if (i < p_prc->synth_.pcm.length
+      && (p_prc->frame_.header.samplerate != p_prc->pcmmode_.nSamplingRate
+          || p_prc->pcmmode_.nChannels < 2))
+    {
+      TIZ_PRINTF_DBG_GRN ("samplerate [%d] NCHANNELS [%d] channels [%d].",
+                          p_prc->frame_.header.samplerate,
+                          MAD_NCHANNELS (&p_prc->frame_.header),
+                          p_prc->synth_.pcm.channels);
+      store_stream_metadata (p_prc, &(p_prc->frame_.header));
+      (void) update_pcm_mode (p_prc, p_prc->synth_.pcm.samplerate, nchannels);
+    }
 
-      /* Right channel. If the decoded stream is monophonic then
-       * the right output channel is the same as the left one.
-       */
-      if (MAD_NCHANNELS (&p_prc->frame_.header) == 2)
+  while (i < p_prc->synth_.pcm.length && !buffer_full)
+    {
+      OMX_BUFFERHEADERTYPE * p_hdr = p_prc->p_outhdr_;
+      unsigned char * p_output = p_hdr->pBuffer + p_hdr->nFilledLen;
+      size_t nframes = (p_hdr->nAllocLen - p_hdr->nFilledLen) / frame_size;
+      const mad_fixed_t * from[2];
+
+      if (nframes > (size_t) (p_prc->synth_.pcm.length - i))
         {
-          sample = mad_fixed_to_sshort (p_prc->synth_.pcm.samples[1][i]);
+          nframes = p_prc->synth_.pcm.length - i;
         }
-      *(p_output++) = sample >> 8;
-      *(p_output++) = sample & 0xff;
 
-      p_prc->p_outhdr_->nFilledLen += 4;
+      /* At the early stages of the decoding, stop at the point where the
+         buffer is released */
+      if (p_prc->frame_count_ < 5 && p_hdr->nFilledLen < early_len
+          && nframes > (early_len - p_hdr->nFilledLen + frame_size - 1)
+                         / frame_size)
+        {
+          nframes = (early_len - p_hdr->nFilledLen + frame_size - 1)
+                    / frame_size;
+        }
 
-      if (p_prc->frame_.header.samplerate != p_prc->pcmmode_.nSamplingRate
-          || p_prc->pcmmode_.nChannels < 2)
+      from[0] = planes[0] + i;
+      from[1] = planes[1] + i;
+      tiz_pcm_from_fixed (p_output, p_prc->pcm_format_, from, nchannels,
+                          nframes, MAD_F_FRACBITS);
+      if (p_prc->pcm_swap_)
         {
-          /* We're outputting two channels, also for mono streams.
-           */
-          const OMX_U32 nchannels = 2;
-          TIZ_PRINTF_DBG_GRN ("samplerate [%d] NCHANNELS [%d] channels [%d].",
-                              p_prc->frame_.header.samplerate,
-                              MAD_NCHANNELS (&p_prc->frame_.header),
-                              p_prc->synth_.pcm.channels);
-          store_stream_metadata (p_prc, &(p_prc->frame_.header));
-          (void) update_pcm_mode (p_prc, p_prc->synth_.pcm.samplerate,
-                                  nchannels);
+          tiz_pcm_swap (p_output, nframes * nchannels, sample_size);
         }
+      p_hdr->nFilledLen += nframes * frame_size;
+      i += nframes;
 
-      /* release the output buffer if it is full, or if we are at the early stages
-         of the decoding */
-      if (p_output == p_bufend)
+      /* release the output buffer if it is full, or if we are at the early
+         stages of the decoding */
+      if (p_hdr->nAllocLen - p_hdr->nFilledLen < frame_size)
         {
-          p_output = p_prc->p_outhdr_->pBuffer;
-          p_prc->p_outhdr_->nFilledLen = p_prc->p_outhdr_->nAllocLen;
           (void) release_headers (p_prc,
                                   ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX);
           buffer_full = true;
         }
-      else if (p_prc->frame_count_ < 5
-               && p_prc->p_outhdr_->nFilledLen
-                    >= (int) (ARATELIA_MP3_DECODER_PORT_MIN_OUTPUT_BUF_SIZE
-                              * .2))
+      else if (p_prc->frame_count_ < 5 && p_hdr->nFilledLen >= early_len)
         {
-          p_output = p_prc->p_outhdr_->pBuffer;
           (void) release_headers (p_prc,
                                   ARATELIA_MP3_DECODER_OUTPUT_PORT_INDEX);
           buffer_full = true;
@@ -708,6 +682,8 @@ mp3d_proc_ctor (void * ap_obj, va_list * app)
   mp3d_prc_t * p_obj = super_ctor (typeOf (ap_obj, "mp3dprc"), ap_obj, app);
   p_obj->remaining_ = 0;
   p_obj->frame_count_ = 0;
+  p_obj->pcm_format_ = ETIZPcmFormatS16;
+  p_obj->pcm_swap_ = OMX_FALSE;
   p_obj->p_inhdr_ = 0;
   p_obj->p_outhdr_ = 0;
   p_obj->next_synth_sample_ = 0;
@@ -763,6 +739,9 @@ mp3d_proc_prepare_to_transfer (void * ap_obj, OMX_U32 a_pid)
   tiz_check_omx (tiz_api_GetParameter (tiz_get_krn (handleOf (p_prc)),
                                        handleOf (p_prc), OMX_IndexParamAudioPcm,
                                        &(p_prc->pcmmode_)));
+  tiz_check_omx (
+    tiz_pcm_format_from_pcmmode (&(p_prc->pcmmode_), &(p_prc->pcm_format_)));
+  p_prc->pcm_swap_ = tiz_pcm_needs_swap (&(p_prc->pcmmode_));
 
   TIZ_TRACE (handleOf (p_prc),
              "sample rate decoder = [%d] channels decoder = [%d]",
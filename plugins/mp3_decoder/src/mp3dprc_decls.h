@@ -38,6 +38,7 @@ extern "C" {
 
 #include <OMX_Core.h>
 
+#include <tizplatform.h>
 #include <tizprc_decls.h>
 
 #define INPUT_BUFFER_SIZE (5 * 8192)
@@ -49,6 +50,8 @@ struct mp3d_prc
   /* Object */
   const tiz_prc_t _;
   OMX_AUDIO_PARAM_PCMMODETYPE pcmmode_;
+  tiz_pcm_format_t pcm_format_;
+  OMX_BOOL pcm_swap_;
   struct mad_stream stream_;
   struct mad_frame frame_;
   struct mad_synth synth_;
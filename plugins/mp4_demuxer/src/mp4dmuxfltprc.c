@@ -23,6 +23,12 @@
  *
  * @brief  Tizonia - MP4 demuxer filter processor
  *
+ * The 'moov' box is parsed once into a sample index (see mp4index.h), and
+ * the samples are then copied out of the 'mdat' box as it streams past,
+ * through a window the size of the largest sample. An 'mdat' box that
+ * precedes the 'moov' box is kept in an unlinked temporary file until the
+ * index is available.
+ *
  * TODO: Seek support.
  *
  */
@@ -37,8 +43,6 @@
 #include <unistd.h>
 #include <limits.h>
 #include <string.h>
-#include <stdarg.h>
-#include <alloca.h>
 
 #include <OMX_TizoniaExt.h>
 
@@ -56,35 +60,15 @@
 #define TIZ_LOG_CATEGORY_NAME "tiz.mp4_demuxer.filter.prc"
 #endif
 
-static mp4dmuxflt_prc_t * gp_prc = NULL;
-
-#define FILE_SIZE 7747480
-#define MP4V2_INT_MAX_FAILED_ATTEMPTS 20
+/* The 'moov' box is held in memory until the sample index is built */
+#define MP4DMUX_MAX_MOOV_SIZE (64 * 1024 * 1024)
 
 /* Forward declarations */
 static OMX_ERRORTYPE
 mp4dmuxflt_prc_deallocate_resources (void *);
 static OMX_ERRORTYPE
-store_data (mp4dmuxflt_prc_t * ap_prc);
-static void
-reset_mp4v2_members (mp4dmuxflt_prc_t * ap_prc);
-static OMX_ERRORTYPE
 send_port_auto_detect_events (mp4dmuxflt_prc_t * ap_prc);
 
-#define on_nestegg_error_ret_omx_oom(expr)                            \
-  do                                                                  \
-    {                                                                 \
-      int nestegg_error = 0;                                          \
-      if (0 != (nestegg_error = (expr)))                              \
-        {                                                             \
-          TIZ_ERROR (handleOf (ap_prc),                               \
-                     "[OMX_ErrorInsufficientResources] : while using" \
-                     " libnestegg");                                  \
-          return OMX_ErrorInsufficientResources;                      \
-        }                                                             \
-    }                                                                 \
-  while (0)
-
 static inline OMX_BUFFERHEADERTYPE *
 get_mp4_hdr (mp4dmuxflt_prc_t * ap_prc)
 {
@@ -93,148 +77,12 @@ get_mp4_hdr (mp4dmuxflt_prc_t * ap_prc)
                                     ARATELIA_MP4_DEMUXER_FILTER_PORT_0_INDEX);
 }
 
-static void
-mp4_log_cback (MP4LogLevel loglevel, const char * fmt, va_list ap)
-{
-  #define MAX_ALLOCA_BUF 1024
-  char * buffer = alloca (MAX_ALLOCA_BUF);
-  vsnprintf (buffer, MAX_ALLOCA_BUF, fmt, ap);
-
-  /* typedef enum {
-     MP4_LOG_NONE = 0,
-     MP4_LOG_ERROR = 1,
-     MP4_LOG_WARNING = 2,
-     MP4_LOG_INFO = 3,
-     MP4_LOG_VERBOSE1 = 4,
-     MP4_LOG_VERBOSE2 = 5,
-     MP4_LOG_VERBOSE3 = 6,
-     MP4_LOG_VERBOSE4 = 7
-     }  MP4LogLevel;
-  */
-
-  switch(loglevel)
-    {
-    case MP4_LOG_ERROR:
-      {
-        TIZ_ERROR(handleOf(gp_prc), "%s", buffer);
-      }
-      break;
-    case MP4_LOG_INFO:
-      {
-        TIZ_NOTICE(handleOf(gp_prc), "%s", buffer);
-      }
-      break;
-    case MP4_LOG_WARNING:
-      {
-        TIZ_DEBUG(handleOf(gp_prc), "%s", buffer);
-      }
-      break;
-    default:
-      {
-        TIZ_TRACE(handleOf(gp_prc), "%s", buffer);
-      }
-      break;
-    };
-}
-
-static void *
-mp4_open_cback (const char * name, MP4FileMode mode)
+static inline OMX_U32
+track_pid (const mp4_track_kind_t a_kind)
 {
-  TIZ_TRACE(handleOf(gp_prc), "file name [%s]", name);
-  return gp_prc;
-}
-
-static int
-mp4_seek_cback (void * ap_handle, int64_t pos)
-{
-  mp4dmuxflt_prc_t * p_prc = ap_handle;
-  assert (gp_prc == ap_handle);
-  assert (p_prc);
-  TIZ_TRACE(handleOf(gp_prc), "pos [%lld]", pos);
-  (void)tiz_buffer_seek (p_prc->p_mp4_store_, pos, TIZ_BUFFER_SEEK_SET);
-  return 0;
-}
-
-static int
-mp4_read_cback (void * ap_handle, void * ap_buffer, int64_t a_size,
-                int64_t * ap_nin, int64_t a_maxChunkSize)
-{
-  mp4dmuxflt_prc_t * p_prc = ap_handle;
-  int retval = -1;
-
-  assert (gp_prc == ap_handle);
-  assert (p_prc);
-  assert (ap_buffer);
-  assert (ap_nin);
-
-  *ap_nin = 0;
-
-  if (tiz_filter_prc_is_eos (p_prc)
-      && tiz_buffer_available (p_prc->p_mp4_store_) == 0)
-    {
-      TIZ_DEBUG (handleOf (p_prc), "out of compressed data");
-      return 1;
-    }
-
-  (void) store_data (p_prc);
-
-  if (ap_buffer && a_size > 0)
-    {
-      if (tiz_buffer_available (p_prc->p_mp4_store_) >= a_size)
-        {
-          memcpy (ap_buffer, tiz_buffer_get (p_prc->p_mp4_store_), a_size);
-          tiz_buffer_advance (p_prc->p_mp4_store_, a_size);
-          *ap_nin = a_size;
-          retval = 0;
-        }
-      else
-        {
-          TIZ_DEBUG (handleOf (p_prc), "out of compressed data");
-          retval = 1;
-        }
-    }
-
-  TIZ_DEBUG (handleOf (p_prc), "a_size [%lld] nin [%lld]", a_size, *ap_nin);
-
-  return retval;
-}
-
-static int
-mp4_write_cback (void * handle, const void * buffer, int64_t size, int64_t * nout,
-           int64_t maxChunkSize)
-{
-  TIZ_TRACE(handleOf(gp_prc), "");
-  return 0;
-}
-
-static int
-mp4_close_cback (void * handle)
-{
-  TIZ_TRACE(handleOf(gp_prc), "");
-  return 0;
-}
-
-/* static int64_t */
-/* mp4_get_size (void * handle) */
-/* { */
-/*   TIZ_TRACE(handleOf(gp_prc), "FILE_SIZE"); */
-/*   return FILE_SIZE; */
-/* } */
-
-static void
-propagate_eos_if_required (mp4dmuxflt_prc_t * ap_prc,
-                           OMX_BUFFERHEADERTYPE * ap_out_hdr)
-{
-  assert (ap_prc);
-  assert (ap_out_hdr);
-
-  /* If EOS, propagate the flag to the next component */
-  if (tiz_filter_prc_is_eos (ap_prc)
-      && tiz_buffer_available (ap_prc->p_mp4_store_) == 0)
-    {
-      ap_out_hdr->nFlags |= OMX_BUFFERFLAG_EOS;
-      tiz_filter_prc_update_eos_flag (ap_prc, false);
-    }
+  return mp4_track_kind_audio == a_kind
+           ? ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX
+           : ARATELIA_MP4_DEMUXER_FILTER_PORT_2_INDEX;
 }
 
 /* TODO: move this functionality to tiz_filter_prc_t */
@@ -252,7 +100,7 @@ release_input_header (mp4dmuxflt_prc_t * ap_prc)
       if ((p_hdr->nFlags & OMX_BUFFERFLAG_EOS) > 0)
         {
           tiz_filter_prc_update_eos_flag (ap_prc, true);
-          p_hdr->nFlags &= ~(1 << OMX_BUFFERFLAG_EOS);
+          p_hdr->nFlags &= ~OMX_BUFFERFLAG_EOS;
         }
       rc = tiz_filter_prc_release_header (
         ap_prc, ARATELIA_MP4_DEMUXER_FILTER_PORT_0_INDEX);
@@ -273,163 +121,12 @@ release_output_header (mp4dmuxflt_prc_t * ap_prc, const OMX_U32 a_pid)
         {
           TIZ_DEBUG (handleOf (ap_prc), "p_hdr [%p] nFilledLen [%u]", p_hdr,
                      p_hdr->nFilledLen);
-          propagate_eos_if_required (ap_prc, p_hdr);
           rc = tiz_filter_prc_release_header (ap_prc, a_pid);
         }
     }
   return rc;
 }
 
-OMX_ERRORTYPE
-deliver_codec_metadata (mp4dmuxflt_prc_t * ap_prc, const OMX_U32 a_pid)
-{
-  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
-  bool * p_metadata_delivered = NULL;
-  tiz_buffer_t * p_out_store = NULL;
-  tiz_vector_t * p_header_lengths = NULL;
-
-  assert (ap_prc);
-
-  p_metadata_delivered = ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX == a_pid
-                           ? &(ap_prc->audio_metadata_delivered_)
-                           : &(ap_prc->video_metadata_delivered_);
-  assert (p_metadata_delivered);
-
-  p_out_store = ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX == a_pid
-                  ? ap_prc->p_aud_store_
-                  : ap_prc->p_vid_store_;
-  assert (p_out_store);
-
-  p_header_lengths = ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX == a_pid
-                       ? ap_prc->p_aud_header_lengths_
-                       : ap_prc->p_vid_header_lengths_;
-  assert (p_header_lengths);
-
-  if (tiz_vector_length (p_header_lengths) > 0)
-    {
-      if (tiz_buffer_available (p_out_store)
-          && (p_hdr = tiz_filter_prc_get_header (ap_prc, a_pid)))
-        {
-          size_t headerlen = 0;
-          size_t nbytes_to_copy = 0;
-          size_t * p_headerlen = tiz_vector_at (p_header_lengths, (OMX_S32) 0);
-          assert (p_headerlen);
-          headerlen = *p_headerlen;
-
-          /* Copy the data into the omx buffer */
-          nbytes_to_copy = MIN (TIZ_OMX_BUF_AVAIL (p_hdr), headerlen);
-          memcpy (TIZ_OMX_BUF_PTR (p_hdr) + p_hdr->nFilledLen,
-                  tiz_buffer_get (p_out_store), nbytes_to_copy);
-          tiz_buffer_advance (p_out_store, nbytes_to_copy);
-          p_hdr->nFilledLen += nbytes_to_copy;
-          tiz_vector_erase (p_header_lengths, (OMX_S32) 0, (OMX_S32) 1);
-          tiz_check_omx (release_output_header (ap_prc, a_pid));
-        }
-    }
-
-  if (0 == tiz_vector_length (p_header_lengths))
-    {
-      *p_metadata_delivered = true;
-    }
-
-  return OMX_ErrorNone;
-}
-
-/* static OMX_ERRORTYPE */
-/* store_audio_codec_metadata (mp4dmuxflt_prc_t * ap_prc, */
-/*                             unsigned char * ap_codec_data, size_t a_length) */
-/* { */
-/*   int pushed = 0; */
-/*   assert (ap_prc); */
-/*   assert (ap_codec_data); */
-/*   assert (a_length); */
-
-/*   pushed = tiz_buffer_push (ap_prc->p_aud_store_, ap_codec_data, a_length); */
-/*   tiz_check_true_ret_val ((pushed == a_length), OMX_ErrorInsufficientResources); */
-/*   tiz_check_omx ( */
-/*     tiz_vector_push_back (ap_prc->p_aud_header_lengths_, &a_length)); */
-
-/*   return OMX_ErrorNone; */
-/* } */
-
-/* static OMX_ERRORTYPE */
-/* store_video_codec_metadata (mp4dmuxflt_prc_t * ap_prc, */
-/*                             unsigned char * ap_codec_data, size_t a_length) */
-/* { */
-/*   int pushed = 0; */
-/*   assert (ap_prc); */
-/*   assert (ap_codec_data); */
-/*   assert (a_length); */
-
-/*   pushed = tiz_buffer_push (ap_prc->p_vid_store_, ap_codec_data, a_length); */
-/*   tiz_check_true_ret_val ((pushed == a_length), OMX_ErrorInsufficientResources); */
-/*   tiz_check_omx ( */
-/*     tiz_vector_push_back (ap_prc->p_vid_header_lengths_, &a_length)); */
-
-/*   return OMX_ErrorNone; */
-/* } */
-
-static mp4_track_type_t
-get_track_type (mp4dmuxflt_prc_t * ap_prc, const MP4FileHandle a_mp4hdl,
-                const MP4TrackId tid)
-{
-  char * p_track_type = NULL;
-  assert (ap_prc);
-  assert (a_mp4hdl != MP4_INVALID_FILE_HANDLE);
-  assert (MP4_INVALID_TRACK_ID != tid);
-
-  {
-    p_track_type = (char *) MP4GetTrackType (a_mp4hdl, tid);
-    if (p_track_type)
-      {
-        if (!strcmp (p_track_type, MP4_AUDIO_TRACK_TYPE))
-          {
-            ap_prc->track_type_ = mp4_track_audio;
-          }
-        else if (!strcmp (p_track_type, MP4_VIDEO_TRACK_TYPE))
-          {
-            ap_prc->track_type_ = mp4_track_video;
-          }
-        else if (!strcmp (p_track_type, MP4_HINT_TRACK_TYPE))
-          {
-            ap_prc->track_type_ = mp4_track_hint;
-          }
-        else if (strcmp (p_track_type, MP4_CNTL_TRACK_TYPE) == 0)
-          {
-            ap_prc->track_type_ = mp4_track_cntl;
-          }
-        else if (!strcmp (p_track_type, MP4_OD_TRACK_TYPE))
-          {
-            ap_prc->track_type_ = mp4_track_od;
-          }
-        else if (!strcmp (p_track_type, MP4_SCENE_TRACK_TYPE))
-          {
-            ap_prc->track_type_ = mp4_track_scene;
-          }
-        else
-          {
-            ap_prc->track_type_ = mp4_track_unknown;
-          }
-      }
-  }
-  return ap_prc->track_type_;
-}
-
-#ifndef NDEBUG
-static void
-print_track_info (mp4dmuxflt_prc_t * ap_prc, const MP4TrackId tid)
-{
-  assert (ap_prc);
-  assert (ap_prc->mp4v2_hdl_ != MP4_INVALID_FILE_HANDLE);
-  if (MP4_INVALID_TRACK_ID != tid)
-    {
-      char * p_track_nfo = MP4Info (ap_prc->mp4v2_hdl_, tid);
-      TIZ_DEBUG (handleOf (ap_prc), "track info: ", (p_track_nfo ? p_track_nfo : ""));
-      tiz_mem_free (p_track_nfo);
-    }
-}
-#endif
-
 static OMX_ERRORTYPE
 prepare_port_auto_detection (mp4dmuxflt_prc_t * ap_prc)
 {
@@ -458,326 +155,572 @@ prepare_port_auto_detection (mp4dmuxflt_prc_t * ap_prc)
 }
 
 static OMX_ERRORTYPE
-get_temp_file(mp4dmuxflt_prc_t * ap_prc)
+get_temp_file (mp4dmuxflt_prc_t * ap_prc)
 {
   OMX_ERRORTYPE rc = OMX_ErrorNone;
-  assert(ap_prc);
+  assert (ap_prc);
 
   static char template[] = "/tmp/tizonia-mp4dmux-XXXXXX";
-  if (!ap_prc->tmp_fd_1_)
+  if (-1 == ap_prc->tmp_fd_)
     {
       char fname[PATH_MAX];
-      strcpy(fname, template);
-      if ((ap_prc->tmp_fd_1_ = mkstemp (fname)) == -1)
+      strcpy (fname, template);
+      if (-1 == (ap_prc->tmp_fd_ = mkstemp (fname)))
         {
           TIZ_ERROR (handleOf (ap_prc), "Error creating temp file (%s)",
                      strerror (errno));
           rc = OMX_ErrorInsufficientResources;
         }
+      else
+        {
+          /* The file is only reachable through the descriptor from now on */
+          (void) unlink (fname);
+        }
     }
   return rc;
 }
 
-static OMX_ERRORTYPE
-store_data (mp4dmuxflt_prc_t * ap_prc)
+static void
+reset_window (mp4dmuxflt_prc_t * ap_prc)
 {
-  bool rc = OMX_ErrorNone;
   assert (ap_prc);
+  ap_prc->window_prefix_ = 0;
+  ap_prc->window_len_ = 0;
+  ap_prc->window_total_ = 0;
+  ap_prc->window_sent_ = 0;
+  ap_prc->sample_selected_ = false;
+  ap_prc->sample_offset_ = 0;
+  ap_prc->sample_size_ = 0;
+}
 
-  OMX_BUFFERHEADERTYPE * p_in = get_mp4_hdr (ap_prc);
-  if (p_in)
+static void
+reset_parser (mp4dmuxflt_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  ap_prc->box_state_ = mp4dmuxflt_box_header;
+  ap_prc->box_hdr_len_ = 0;
+  ap_prc->box_end_ = 0;
+  ap_prc->file_pos_ = 0;
+  tiz_mem_free (ap_prc->p_moov_);
+  ap_prc->p_moov_ = NULL;
+  ap_prc->moov_len_ = 0;
+  ap_prc->moov_size_ = 0;
+  mp4_index_destroy (ap_prc->p_index_);
+  ap_prc->p_index_ = NULL;
+  if (ap_prc->spill_end_ > ap_prc->spill_base_)
     {
-      const void *p_buf = p_in->pBuffer + p_in->nOffset;
-      const size_t count = p_in->nFilledLen;
-      tiz_check_omx (get_temp_file (ap_prc));
-      if (write (ap_prc->tmp_fd_1_, p_buf, count) != count)
-        {
-          TIZ_ERROR (handleOf (ap_prc),
-                     "Error writing to temp file (%s)",
-                     strerror (errno));
-        }
-      rc = release_input_header (ap_prc);
+      /* Give the disk space back */
+      (void) ftruncate (ap_prc->tmp_fd_, 0);
     }
-  return rc;
+  ap_prc->spill_base_ = 0;
+  ap_prc->spill_end_ = 0;
+  tiz_mem_free (ap_prc->p_window_);
+  ap_prc->p_window_ = NULL;
+  ap_prc->window_cap_ = 0;
+  reset_window (ap_prc);
+  ap_prc->samples_done_ = false;
+  ap_prc->eos_delivered_[mp4_track_kind_audio] = false;
+  ap_prc->eos_delivered_[mp4_track_kind_video] = false;
 }
 
-/* static OMX_ERRORTYPE */
-/* extract_track_data (mp4dmuxflt_prc_t * ap_prc, const unsigned int a_track, */
-/*                     const OMX_U32 a_pid) */
-/* { */
-/*   OMX_ERRORTYPE rc = OMX_ErrorNotReady; */
-/*   OMX_BUFFERHEADERTYPE * p_hdr = NULL; */
-
-/*   if (!tiz_filter_prc_is_port_disabled (ap_prc, a_pid)) */
-/*     { */
-/*       p_hdr = tiz_filter_prc_get_header (ap_prc, a_pid); */
-/*       if (p_hdr) */
-/*         { */
-/*           assert (ap_prc); */
-
-/*           /\* Extract a packet *\/ */
-
-/*           /\* Release the OMX buffer *\/ */
-/*           if (TIZ_OMX_BUF_FILL_LEN (p_hdr) > 0) */
-/*             { */
-/*               tiz_check_omx (release_output_header (ap_prc, a_pid)); */
-/*             } */
-/*         } /\* if (p_hdr) *\/ */
-/*     }     /\* if (!tiz_filter_prc_is_port_disabled (ap_prc, a_pid)) *\/ */
-
-/*   /\* Release the ne packet if all chunks have been processed *\/ */
-
-/*   return rc; */
-/* } */
-
-/* static OMX_ERRORTYPE */
-/* extract_track_audio_data (mp4dmuxflt_prc_t * ap_prc, */
-/*                           const unsigned int a_track) */
-/* { */
-/*   OMX_ERRORTYPE rc = OMX_ErrorNone; */
-/*   assert (ap_prc); */
-/*   rc = extract_track_data (ap_prc, a_track, */
-/*                            ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX); */
-/*   return rc; */
-/* } */
-
-/* static OMX_ERRORTYPE */
-/* extract_track_video_data (mp4dmuxflt_prc_t * ap_prc, */
-/*                           const unsigned int a_track) */
-/* { */
-/*   OMX_ERRORTYPE rc = OMX_ErrorNone; */
-/*   assert (ap_prc); */
-/*   rc = extract_track_data (ap_prc, a_track, */
-/*                            ARATELIA_MP4_DEMUXER_FILTER_PORT_2_INDEX); */
-/*   return rc; */
-/* } */
-
-/* static bool */
-/* able_to_demux (mp4dmuxflt_prc_t * ap_prc) */
-/* { */
-/*   bool rc = true; */
-/*   bool compressed_data_avail */
-/*     = (tiz_buffer_available (ap_prc->p_mp4_store_) > 0); */
-/*   bool enough_compressed_data_avail */
-/*     = compressed_data_avail */
-/*       && !(tiz_buffer_available (ap_prc->p_mp4_store_)); */
-
-/*   if (!compressed_data_avail && tiz_filter_prc_is_eos (ap_prc)) */
-/*     { */
-/*       release_output_header (ap_prc, ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX); */
-/*       release_output_header (ap_prc, ARATELIA_MP4_DEMUXER_FILTER_PORT_2_INDEX); */
-/*     } */
-
-/*   if (!compressed_data_avail || !enough_compressed_data_avail */
-/*       || (!tiz_filter_prc_output_headers_available (ap_prc))) */
-/*     { */
-/*       rc = false; */
-/*     } */
-
-/*   TIZ_DEBUG (handleOf (ap_prc), "able to demux - %s", rc ? "YES" : "NO"); */
-
-/*   return rc; */
-/* } */
-
-/* static OMX_ERRORTYPE */
-/* read_packet (mp4dmuxflt_prc_t * ap_prc) */
-/* { */
-/*   OMX_ERRORTYPE rc = OMX_ErrorNotReady; */
-
-/*   assert (ap_prc); */
-
-/*   return rc; */
-/* } */
-
-/* static OMX_ERRORTYPE */
-/* demux_stream (mp4dmuxflt_prc_t * ap_prc) */
-/* { */
-/*   OMX_ERRORTYPE rc = OMX_ErrorNotReady; */
-
-/*   assert (ap_prc); */
-
-/*   while (able_to_demux (ap_prc)) */
-/*     { */
-/*       rc = read_packet (ap_prc); */
-/*     } */
-
-/*   return rc; */
-/* } */
+static void
+reset_stream_parameters (mp4dmuxflt_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  TIZ_DEBUG (handleOf (ap_prc), "Resetting stream parameters");
+  ap_prc->audio_auto_detect_on_ = false;
+  ap_prc->audio_coding_type_ = OMX_AUDIO_CodingUnused;
+  ap_prc->video_auto_detect_on_ = false;
+  ap_prc->video_coding_type_ = OMX_VIDEO_CodingUnused;
+  reset_parser (ap_prc);
+  tiz_filter_prc_update_eos_flag (ap_prc, false);
+}
 
 static OMX_ERRORTYPE
-alloc_input_store (mp4dmuxflt_prc_t * ap_prc)
+on_index_ready (mp4dmuxflt_prc_t * ap_prc)
 {
-  OMX_PARAM_PORTDEFINITIONTYPE port_def;
   assert (ap_prc);
+  assert (ap_prc->p_index_);
+  assert (!ap_prc->p_window_);
+
+  /* Room for the largest sample plus an ADTS header */
+  ap_prc->window_cap_ = mp4_index_max_sample_size (ap_prc->p_index_) + 7;
+  tiz_check_null_ret_oom (
+    (ap_prc->p_window_ = tiz_mem_alloc (ap_prc->window_cap_)));
+
+  TIZ_DEBUG (handleOf (ap_prc),
+             "audio samples [%u] video samples [%u] window [%zu] spilled "
+             "[%llu]",
+             mp4_index_sample_count (ap_prc->p_index_, mp4_track_kind_audio),
+             mp4_index_sample_count (ap_prc->p_index_, mp4_track_kind_video),
+             ap_prc->window_cap_,
+             (unsigned long long) (ap_prc->spill_end_ - ap_prc->spill_base_));
+
+  return send_port_auto_detect_events (ap_prc);
+}
 
-  TIZ_INIT_OMX_PORT_STRUCT (port_def, ARATELIA_MP4_DEMUXER_FILTER_PORT_0_INDEX);
-  tiz_check_omx (
-    tiz_api_GetParameter (tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
-                          OMX_IndexParamPortDefinition, &port_def));
-
-  assert (ap_prc->p_mp4_store_ == NULL);
-  tiz_check_omx (
-    tiz_buffer_init (&(ap_prc->p_mp4_store_), port_def.nBufferSize * 4));
+static OMX_ERRORTYPE
+end_box (mp4dmuxflt_prc_t * ap_prc)
+{
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  assert (ap_prc);
 
-  /* Will need to seek on this buffer  */
-  return tiz_buffer_seek_mode (ap_prc->p_mp4_store_, TIZ_BUFFER_SEEKABLE);
+  if (mp4dmuxflt_box_moov == ap_prc->box_state_)
+    {
+      rc = mp4_index_init (&(ap_prc->p_index_), ap_prc->p_moov_,
+                           ap_prc->moov_len_);
+      tiz_mem_free (ap_prc->p_moov_);
+      ap_prc->p_moov_ = NULL;
+      ap_prc->moov_len_ = 0;
+      ap_prc->moov_size_ = 0;
+      if (OMX_ErrorNone == rc)
+        {
+          rc = on_index_ready (ap_prc);
+        }
+      else
+        {
+          TIZ_ERROR (handleOf (ap_prc), "[%s] : unable to index the moov box",
+                     tiz_err_to_str (rc));
+          rc = OMX_ErrorStreamCorruptFatal;
+        }
+    }
+  ap_prc->box_state_ = mp4dmuxflt_box_header;
+  return rc;
 }
 
 static OMX_ERRORTYPE
-alloc_output_stores (mp4dmuxflt_prc_t * ap_prc)
+begin_box (mp4dmuxflt_prc_t * ap_prc, const uint64_t a_start,
+           const uint64_t a_size, const uint32_t a_type, const size_t a_hdr_len)
 {
-  OMX_PARAM_PORTDEFINITIONTYPE aud_port_def;
-  OMX_PARAM_PORTDEFINITIONTYPE vid_port_def;
   assert (ap_prc);
 
-  TIZ_INIT_OMX_PORT_STRUCT (aud_port_def,
-                            ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX);
-  tiz_check_omx (
-    tiz_api_GetParameter (tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
-                          OMX_IndexParamPortDefinition, &aud_port_def));
+  if (a_size < a_hdr_len)
+    {
+      TIZ_ERROR (handleOf (ap_prc), "Invalid box size [%llu] at [%llu]",
+                 (unsigned long long) a_size, (unsigned long long) a_start);
+      return OMX_ErrorStreamCorruptFatal;
+    }
 
-  TIZ_INIT_OMX_PORT_STRUCT (vid_port_def,
-                            ARATELIA_MP4_DEMUXER_FILTER_PORT_2_INDEX);
-  tiz_check_omx (
-    tiz_api_GetParameter (tiz_get_krn (handleOf (ap_prc)), handleOf (ap_prc),
-                          OMX_IndexParamPortDefinition, &vid_port_def));
+  ap_prc->box_hdr_len_ = 0;
+  ap_prc->box_end_
+    = (MP4_BOX_SIZE_TO_EOF == a_size) ? MP4_BOX_SIZE_TO_EOF : a_start + a_size;
+  ap_prc->box_state_ = mp4dmuxflt_box_skip;
 
-  assert (!ap_prc->p_aud_store_);
-  tiz_check_omx (
-    tiz_buffer_init (&(ap_prc->p_aud_store_), aud_port_def.nBufferSize));
+  if (MP4_BOX_TYPE ('m', 'o', 'o', 'v') == a_type && !ap_prc->p_index_)
+    {
+      if (MP4_BOX_SIZE_TO_EOF == a_size
+          || a_size - a_hdr_len > MP4DMUX_MAX_MOOV_SIZE)
+        {
+          TIZ_ERROR (handleOf (ap_prc), "Unsupported moov box size [%llu]",
+                     (unsigned long long) a_size);
+          return OMX_ErrorStreamCorruptFatal;
+        }
+      ap_prc->moov_size_ = (size_t) (a_size - a_hdr_len);
+      ap_prc->moov_len_ = 0;
+      tiz_check_null_ret_oom (
+        (ap_prc->p_moov_ = tiz_mem_alloc (MAX (ap_prc->moov_size_, 1))));
+      ap_prc->box_state_ = mp4dmuxflt_box_moov;
+    }
+  else if (MP4_BOX_TYPE ('m', 'd', 'a', 't') == a_type)
+    {
+      if (ap_prc->p_index_)
+        {
+          ap_prc->box_state_ = mp4dmuxflt_box_mdat;
+        }
+      else if (ap_prc->spill_end_ == ap_prc->spill_base_)
+        {
+          /* The moov box comes later; keep the sample data aside until the
+             index is available */
+          tiz_check_omx (get_temp_file (ap_prc));
+          ap_prc->spill_base_ = a_start + a_hdr_len;
+          ap_prc->spill_end_ = ap_prc->spill_base_;
+          ap_prc->box_state_ = mp4dmuxflt_box_mdat;
+        }
+    }
+  else if (MP4_BOX_TYPE ('m', 'o', 'o', 'f') == a_type)
+    {
+      TIZ_NOTICE (handleOf (ap_prc), "Fragmented MP4 is not supported");
+    }
 
-  assert (!ap_prc->p_vid_store_);
-  tiz_check_omx (
-    tiz_buffer_init (&(ap_prc->p_vid_store_), vid_port_def.nBufferSize));
+  TIZ_TRACE (handleOf (ap_prc), "box [%c%c%c%c] start [%llu] size [%llu]",
+             (char) (a_type >> 24), (char) (a_type >> 16),
+             (char) (a_type >> 8), (char) a_type, (unsigned long long) a_start,
+             (unsigned long long) a_size);
 
-  assert (!ap_prc->p_aud_header_lengths_);
-  tiz_check_omx (
-    tiz_vector_init (&(ap_prc->p_aud_header_lengths_), sizeof (size_t)));
+  return (ap_prc->box_end_ == ap_prc->file_pos_) ? end_box (ap_prc)
+                                                 : OMX_ErrorNone;
+}
 
-  assert (!ap_prc->p_vid_header_lengths_);
-  tiz_check_omx (
-    tiz_vector_init (&(ap_prc->p_vid_header_lengths_), sizeof (size_t)));
+static OMX_ERRORTYPE
+read_box_header (mp4dmuxflt_prc_t * ap_prc, const uint8_t * ap_data,
+                 const size_t a_avail, size_t * ap_used)
+{
+  size_t need = 8;
+  uint64_t size = 0;
+  uint32_t type = 0;
+  size_t hdr_len = 0;
+  assert (ap_prc);
+  assert (ap_used);
+
+  if (ap_prc->box_hdr_len_ >= 4 && 0 == ap_prc->box_hdr_[0]
+      && 0 == ap_prc->box_hdr_[1] && 0 == ap_prc->box_hdr_[2]
+      && 1 == ap_prc->box_hdr_[3])
+    {
+      need = MP4_BOX_HEADER_MAX_LEN;
+    }
+
+  *ap_used = MIN (a_avail, need - ap_prc->box_hdr_len_);
+  memcpy (ap_prc->box_hdr_ + ap_prc->box_hdr_len_, ap_data, *ap_used);
+  ap_prc->box_hdr_len_ += *ap_used;
+  ap_prc->file_pos_ += *ap_used;
 
+  hdr_len = mp4_box_header (ap_prc->box_hdr_, ap_prc->box_hdr_len_, &size,
+                            &type);
+  if (hdr_len > 0)
+    {
+      return begin_box (ap_prc, ap_prc->file_pos_ - hdr_len, size, type,
+                        hdr_len);
+    }
   return OMX_ErrorNone;
 }
 
-static inline void
-dealloc_mp4v2 (
-  /*@special@ */ mp4dmuxflt_prc_t * ap_prc)
-/*@releases ap_prc->p_ne_@ */
-/*@ensures isnull ap_prc->p_ne_@ */
+static OMX_ERRORTYPE
+read_mdat (mp4dmuxflt_prc_t * ap_prc, const uint8_t * ap_data,
+           const size_t a_avail, size_t * ap_used)
 {
   assert (ap_prc);
-  if (MP4_IS_VALID_FILE_HANDLE (ap_prc->mp4v2_hdl_))
+  assert (ap_used);
+
+  *ap_used = 0;
+  if (!ap_prc->p_index_)
+    {
+      /* No index yet: spill */
+      const ssize_t written
+        = pwrite (ap_prc->tmp_fd_, ap_data, a_avail,
+                  (off_t) (ap_prc->file_pos_ - ap_prc->spill_base_));
+      if (written < 0 || (size_t) written != a_avail)
+        {
+          TIZ_ERROR (handleOf (ap_prc), "Error writing to temp file (%s)",
+                     strerror (errno));
+          return OMX_ErrorInsufficientResources;
+        }
+      *ap_used = a_avail;
+      ap_prc->spill_end_ += a_avail;
+    }
+  else if (ap_prc->samples_done_)
     {
-      MP4Close (ap_prc->mp4v2_hdl_, 0);
-      ap_prc->mp4v2_hdl_ = MP4_INVALID_FILE_HANDLE;
+      *ap_used = a_avail;
     }
+  else if (ap_prc->sample_selected_
+           && ap_prc->window_len_ < ap_prc->window_total_)
+    {
+      /* Skip to the sample, then copy it into the window */
+      const uint64_t next = ap_prc->sample_offset_ + ap_prc->window_len_
+                            - ap_prc->window_prefix_;
+      if (ap_prc->file_pos_ < next)
+        {
+          *ap_used = (size_t) MIN (a_avail, next - ap_prc->file_pos_);
+        }
+      else if (ap_prc->file_pos_ == next)
+        {
+          *ap_used
+            = MIN (a_avail, ap_prc->window_total_ - ap_prc->window_len_);
+          memcpy (ap_prc->p_window_ + ap_prc->window_len_, ap_data, *ap_used);
+          ap_prc->window_len_ += *ap_used;
+        }
+    }
+
+  ap_prc->file_pos_ += *ap_used;
+  return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
-alloc_mp4v2 (mp4dmuxflt_prc_t * ap_prc)
+consume_input (mp4dmuxflt_prc_t * ap_prc, bool * ap_progress)
 {
+  OMX_BUFFERHEADERTYPE * p_in = get_mp4_hdr (ap_prc);
   OMX_ERRORTYPE rc = OMX_ErrorNone;
+  size_t used = 0;
+
   assert (ap_prc);
-  TIZ_TRACE(handleOf(ap_prc), "");
-  if (!MP4_IS_VALID_FILE_HANDLE (ap_prc->mp4v2_hdl_))
+  assert (ap_progress);
+
+  if (!p_in)
+    {
+      return OMX_ErrorNone;
+    }
+
+  if (p_in->nFilledLen > 0)
     {
-/*       const MP4FileProvider provider */
-/*         = {mp4_open_cback, mp4_seek_cback, mp4_read_cback, mp4_write_cback, */
-/*            mp4_close_cback, mp4_get_size}; */
-      const MP4FileProvider provider
-        = {mp4_open_cback, mp4_seek_cback, mp4_read_cback, mp4_write_cback,
-           mp4_close_cback};
-      ap_prc->mp4v2_hdl_ = MP4ReadProvider ("Tizonia", &provider);
-      TIZ_TRACE(handleOf(ap_prc), "MP4ReadProvider");
-      if (!MP4_IS_VALID_FILE_HANDLE (ap_prc->mp4v2_hdl_))
+      const uint8_t * p_data = TIZ_OMX_BUF_PTR (p_in);
+      size_t avail = p_in->nFilledLen;
+
+      if (mp4dmuxflt_box_header != ap_prc->box_state_)
         {
-          /* We'll assume mp4v2 has not initialised correctly because there is
-             not enough input data yet... we'll wait for more data to arrive, but
-             we'll also give up after the max number of failed attempts. */
-          dealloc_mp4v2 (ap_prc);
-          reset_mp4v2_members (ap_prc);
-          tiz_buffer_seek (ap_prc->p_mp4_store_, 0, TIZ_BUFFER_SEEK_SET);
-          ap_prc->mp4v2_failed_init_count_ += 1;
-          rc = OMX_ErrorNotReady;
-          TIZ_ERROR (handleOf (ap_prc),
-                     "[OMX_ErrorNotReady] on MP4ReadProvider");
+          avail = (size_t) MIN (avail, ap_prc->box_end_ - ap_prc->file_pos_);
         }
-      else
+
+      switch (ap_prc->box_state_)
         {
-          rc = send_port_auto_detect_events (ap_prc);
-          ap_prc->mp4v2_inited_ = true;
+          case mp4dmuxflt_box_header:
+            {
+              rc = read_box_header (ap_prc, p_data, avail, &used);
+            }
+            break;
+          case mp4dmuxflt_box_moov:
+            {
+              used = MIN (avail, ap_prc->moov_size_ - ap_prc->moov_len_);
+              memcpy (ap_prc->p_moov_ + ap_prc->moov_len_, p_data, used);
+              ap_prc->moov_len_ += used;
+              ap_prc->file_pos_ += used;
+            }
+            break;
+          case mp4dmuxflt_box_mdat:
+            {
+              rc = read_mdat (ap_prc, p_data, avail, &used);
+            }
+            break;
+          case mp4dmuxflt_box_skip:
+          default:
+            {
+              used = avail;
+              ap_prc->file_pos_ += used;
+            }
+            break;
+        };
+
+      tiz_check_omx (rc);
+
+      p_in->nOffset += used;
+      p_in->nFilledLen -= used;
+      *ap_progress = *ap_progress || used > 0;
+
+      if (mp4dmuxflt_box_header != ap_prc->box_state_
+          && ap_prc->box_end_ == ap_prc->file_pos_)
+        {
+          tiz_check_omx (end_box (ap_prc));
         }
-      TIZ_DEBUG (handleOf (ap_prc), "mp4v2 inited = %s",
-                 (ap_prc->mp4v2_inited_ ? "TRUE" : "FALSE"));
     }
+
+  if (0 == p_in->nFilledLen)
+    {
+      *ap_progress = true;
+      rc = release_input_header (ap_prc);
+    }
+
   return rc;
 }
 
-static void
-reset_mp4v2_members (mp4dmuxflt_prc_t * ap_prc)
+static OMX_ERRORTYPE
+select_sample (mp4dmuxflt_prc_t * ap_prc, bool * ap_progress)
 {
+  mp4_track_kind_t kind = mp4_track_kind_max;
+  uint64_t offset = 0;
+  uint32_t size = 0;
+  int i = 0;
+
   assert (ap_prc);
-  assert (!MP4_IS_VALID_FILE_HANDLE (ap_prc->mp4v2_hdl_));
-  ap_prc->mp4v2_inited_ = false;
-  ap_prc->mp4v2_duration_ = 0;
-  ap_prc->track_type_ = mp4_track_unknown;
-  ap_prc->audio_type_ = mp4_audio_unknown;
-  ap_prc->video_type_ = mp4_video_unknown;
+  assert (ap_progress);
+
+  if (ap_prc->sample_selected_ && ap_prc->window_len_ < ap_prc->window_total_
+      && ap_prc->file_pos_ > ap_prc->sample_offset_ + ap_prc->window_len_
+                               - ap_prc->window_prefix_)
+    {
+      /* The sample was not entirely within an mdat box */
+      TIZ_DEBUG (handleOf (ap_prc), "Dropping sample at [%llu]",
+                 (unsigned long long) ap_prc->sample_offset_);
+      mp4_index_advance (ap_prc->p_index_, ap_prc->sample_kind_);
+      reset_window (ap_prc);
+      *ap_progress = true;
+    }
+
+  if (!ap_prc->p_index_ || ap_prc->sample_selected_ || ap_prc->samples_done_)
+    {
+      return OMX_ErrorNone;
+    }
+
+  /* Samples are taken in file order, across the tracks being output */
+  for (i = 0; i < mp4_track_kind_max; ++i)
+    {
+      uint64_t trk_offset = 0;
+      uint32_t trk_size = 0;
+      if (tiz_filter_prc_is_port_enabled (ap_prc, track_pid (i))
+          && mp4_index_peek (ap_prc->p_index_, i, &trk_offset, &trk_size)
+          && (mp4_track_kind_max == kind || trk_offset < offset))
+        {
+          kind = i;
+          offset = trk_offset;
+          size = trk_size;
+        }
+    }
+
+  *ap_progress = true;
+  if (mp4_track_kind_max == kind)
+    {
+      TIZ_DEBUG (handleOf (ap_prc), "No more samples");
+      ap_prc->samples_done_ = true;
+      return OMX_ErrorNone;
+    }
+
+  if (ap_prc->spill_end_ == ap_prc->spill_base_ && offset < ap_prc->file_pos_)
+    {
+      /* Already gone past this sample (e.g. it is not within an mdat box) */
+      TIZ_DEBUG (handleOf (ap_prc), "Skipping sample at [%llu]",
+                 (unsigned long long) offset);
+      mp4_index_advance (ap_prc->p_index_, kind);
+      return OMX_ErrorNone;
+    }
+
+  reset_window (ap_prc);
+  ap_prc->sample_selected_ = true;
+  ap_prc->sample_kind_ = kind;
+  ap_prc->sample_offset_ = offset;
+  ap_prc->sample_size_ = size;
+  if (mp4_track_kind_audio == kind
+      && mp4_index_adts_header (ap_prc->p_index_, size, ap_prc->p_window_))
+    {
+      ap_prc->window_prefix_ = 7;
+    }
+  ap_prc->window_len_ = ap_prc->window_prefix_;
+  ap_prc->window_total_ = ap_prc->window_prefix_ + size;
+  assert (ap_prc->window_total_ <= ap_prc->window_cap_);
+
+  if (ap_prc->spill_end_ > ap_prc->spill_base_)
+    {
+      ssize_t nread = -1;
+      if (offset < ap_prc->spill_base_ || offset + size > ap_prc->spill_end_)
+        {
+          TIZ_DEBUG (handleOf (ap_prc), "Skipping sample at [%llu]",
+                     (unsigned long long) offset);
+          reset_window (ap_prc);
+          mp4_index_advance (ap_prc->p_index_, kind);
+          return OMX_ErrorNone;
+        }
+      nread = pread (ap_prc->tmp_fd_, ap_prc->p_window_ + ap_prc->window_len_,
+                     size, (off_t) (offset - ap_prc->spill_base_));
+      if (nread < 0 || (size_t) nread != size)
+        {
+          TIZ_ERROR (handleOf (ap_prc), "Error reading from temp file (%s)",
+                     strerror (errno));
+          return OMX_ErrorInsufficientResources;
+        }
+      ap_prc->window_len_ += size;
+    }
+
+  return OMX_ErrorNone;
 }
 
-static void
-reset_stream_parameters (mp4dmuxflt_prc_t * ap_prc)
+static OMX_ERRORTYPE
+deliver_sample (mp4dmuxflt_prc_t * ap_prc, bool * ap_progress)
 {
+  OMX_BUFFERHEADERTYPE * p_hdr = NULL;
+  OMX_U32 pid = 0;
+  size_t nbytes = 0;
+
   assert (ap_prc);
-  TIZ_DEBUG (handleOf (ap_prc), "Resetting stream parameters");
-  ap_prc->audio_metadata_delivered_ = false;
-  ap_prc->video_metadata_delivered_ = false;
-  ap_prc->audio_auto_detect_on_ = false;
-  ap_prc->audio_coding_type_ = OMX_AUDIO_CodingUnused;
-  ap_prc->video_auto_detect_on_ = false;
-  ap_prc->video_coding_type_ = OMX_VIDEO_CodingUnused;
+  assert (ap_progress);
 
-  dealloc_mp4v2 (ap_prc);
-  reset_mp4v2_members (ap_prc);
-  ap_prc->mp4v2_failed_init_count_ = 0;
+  if (!ap_prc->sample_selected_
+      || ap_prc->window_len_ < ap_prc->window_total_)
+    {
+      return OMX_ErrorNone;
+    }
 
-  tiz_buffer_clear (ap_prc->p_mp4_store_);
-  tiz_buffer_clear (ap_prc->p_aud_store_);
-  tiz_buffer_clear (ap_prc->p_vid_store_);
-  tiz_vector_clear (ap_prc->p_aud_header_lengths_);
-  tiz_vector_clear (ap_prc->p_vid_header_lengths_);
+  pid = track_pid (ap_prc->sample_kind_);
+  if (tiz_filter_prc_is_port_enabled (ap_prc, pid))
+    {
+      if (!(p_hdr = tiz_filter_prc_get_header (ap_prc, pid))
+          || 0 == TIZ_OMX_BUF_AVAIL (p_hdr))
+        {
+          return OMX_ErrorNone;
+        }
 
-  tiz_filter_prc_update_eos_flag (ap_prc, false);
+      /* Samples larger than the buffer span several buffers */
+      nbytes = MIN (TIZ_OMX_BUF_AVAIL (p_hdr),
+                    ap_prc->window_total_ - ap_prc->window_sent_);
+      memcpy (TIZ_OMX_BUF_PTR (p_hdr) + p_hdr->nFilledLen,
+              ap_prc->p_window_ + ap_prc->window_sent_, nbytes);
+      p_hdr->nFilledLen += nbytes;
+      ap_prc->window_sent_ += nbytes;
+      tiz_check_omx (release_output_header (ap_prc, pid));
+    }
+  else
+    {
+      ap_prc->window_sent_ = ap_prc->window_total_;
+    }
+
+  if (ap_prc->window_sent_ == ap_prc->window_total_)
+    {
+      mp4_index_advance (ap_prc->p_index_, ap_prc->sample_kind_);
+      reset_window (ap_prc);
+    }
+
+  *ap_progress = true;
+  return OMX_ErrorNone;
 }
 
-static inline void
-dealloc_input_store (
-  /*@special@ */ mp4dmuxflt_prc_t * ap_prc)
-/*@releases ap_prc->p_mp4_store_@ */
-/*@ensures isnull ap_prc->p_mp4_store_@ */
+static OMX_ERRORTYPE
+deliver_eos (mp4dmuxflt_prc_t * ap_prc)
 {
+  bool done = true;
+  int i = 0;
   assert (ap_prc);
-  tiz_buffer_destroy (ap_prc->p_mp4_store_);
-  ap_prc->p_mp4_store_ = NULL;
+
+  if (!ap_prc->p_index_)
+    {
+      TIZ_ERROR (handleOf (ap_prc), "End of stream without a moov box");
+    }
+
+  for (i = 0; i < mp4_track_kind_max; ++i)
+    {
+      const OMX_U32 pid = track_pid (i);
+      if (tiz_filter_prc_is_port_enabled (ap_prc, pid)
+          && !ap_prc->eos_delivered_[i])
+        {
+          OMX_BUFFERHEADERTYPE * p_hdr = tiz_filter_prc_get_header (ap_prc, pid);
+          if (p_hdr)
+            {
+              p_hdr->nFlags |= OMX_BUFFERFLAG_EOS;
+              tiz_check_omx (tiz_filter_prc_release_header (ap_prc, pid));
+              ap_prc->eos_delivered_[i] = true;
+            }
+          else
+            {
+              done = false;
+            }
+        }
+    }
+
+  if (done)
+    {
+      /* Ready for the next stream */
+      tiz_filter_prc_update_eos_flag (ap_prc, false);
+      reset_parser (ap_prc);
+    }
+  return OMX_ErrorNone;
 }
 
-static inline void
-dealloc_output_stores (
-  /*@special@ */ mp4dmuxflt_prc_t * ap_prc)
-/*@releases ap_prc->p_mp4_store_@ */
-/*@ensures isnull ap_prc->p_mp4_store_@ */
+static OMX_ERRORTYPE
+demux_stream (mp4dmuxflt_prc_t * ap_prc)
 {
+  bool progress = true;
   assert (ap_prc);
-  tiz_buffer_destroy (ap_prc->p_aud_store_);
-  ap_prc->p_aud_store_ = NULL;
-  tiz_buffer_destroy (ap_prc->p_vid_store_);
-  ap_prc->p_vid_store_ = NULL;
-  tiz_vector_destroy (ap_prc->p_aud_header_lengths_);
-  ap_prc->p_aud_header_lengths_ = NULL;
-  tiz_vector_destroy (ap_prc->p_vid_header_lengths_);
-  ap_prc->p_vid_header_lengths_ = NULL;
+
+  while (progress)
+    {
+      progress = false;
+      tiz_check_omx (deliver_sample (ap_prc, &progress));
+      tiz_check_omx (select_sample (ap_prc, &progress));
+      tiz_check_omx (consume_input (ap_prc, &progress));
+    }
+
+  if (tiz_filter_prc_is_eos (ap_prc) && !get_mp4_hdr (ap_prc)
+      && !(ap_prc->sample_selected_
+           && ap_prc->window_len_ == ap_prc->window_total_))
+    {
+      tiz_check_omx (deliver_eos (ap_prc));
+    }
+
+  return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
@@ -825,100 +768,61 @@ set_video_coding_on_port (mp4dmuxflt_prc_t * ap_prc)
 }
 
 static OMX_ERRORTYPE
-read_audio_codec_metadata (mp4dmuxflt_prc_t * ap_prc,
-                           const MP4TrackId a_track_id,
-                           const int a_track_type)
+read_audio_codec_metadata (mp4dmuxflt_prc_t * ap_prc)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (ap_prc);
+  assert (ap_prc->p_index_);
 
-  if (mp4_track_audio == a_track_type)
+  switch (mp4_index_codec (ap_prc->p_index_, mp4_track_kind_audio))
     {
-      mp4_audio_type_t audio_type = mp4_audio_unknown;
-      uint32_t time_scale = 0;
-      MP4Duration track_duration = 0;
-      double ms_duration = .0;
-      uint32_t avg_bitrate = 0;
-      char * p_track_nfo = mp4_get_audio_info (
-        ap_prc->mp4v2_hdl_, a_track_id, &audio_type, &time_scale,
-        &track_duration, &ms_duration, &avg_bitrate);
-      tiz_mem_free(p_track_nfo);
-      p_track_nfo = NULL;
-
-      switch(audio_type)
+      case mp4_codec_mp3:
         {
-        case mp4_audio_mp3:
-          {
-            ap_prc->audio_coding_type_ = OMX_AUDIO_CodingMP3;
-          }
-          break;
-        case mp4_audio_aac:
-        case mp4_audio_aac_from_mov:
-          {
-            ap_prc->audio_coding_type_ = OMX_AUDIO_CodingAAC;
-          }
-          break;
-        case mp4_audio_amr:
-        case mp4_audio_amrwb:
-          {
-            ap_prc->audio_coding_type_ = OMX_AUDIO_CodingAMR;
-          }
-          break;
-        default:
-          ap_prc->audio_coding_type_ = OMX_AUDIO_CodingUnused;
-          break;
-        };
-
-      /* Do nothing if track type is not audio */
-      tiz_check_omx (set_audio_coding_on_port (ap_prc));
-    }
-  return rc;
-}
-
-static OMX_ERRORTYPE
-read_video_codec_metadata (mp4dmuxflt_prc_t * ap_prc,
-                           const unsigned int a_track_id,
-                           const int a_track_type)
-{
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  assert (ap_prc);
+          ap_prc->audio_coding_type_ = OMX_AUDIO_CodingMP3;
+        }
+        break;
+      case mp4_codec_aac:
+        {
+          ap_prc->audio_coding_type_ = OMX_AUDIO_CodingAAC;
+        }
+        break;
+      case mp4_codec_amr:
+      case mp4_codec_amrwb:
+        {
+          ap_prc->audio_coding_type_ = OMX_AUDIO_CodingAMR;
+        }
+        break;
+      default:
+        ap_prc->audio_coding_type_ = OMX_AUDIO_CodingUnused;
+        break;
+    };
 
-  /* Do nothing if track type is not video */
-  tiz_check_omx (set_video_coding_on_port (ap_prc));
-  return rc;
+  return set_audio_coding_on_port (ap_prc);
 }
 
 static OMX_ERRORTYPE
-obtain_track_info (mp4dmuxflt_prc_t * ap_prc)
+read_video_codec_metadata (mp4dmuxflt_prc_t * ap_prc)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  MP4TrackId track_id = MP4_INVALID_TRACK_ID;
-  uint32_t i = 0;
-  uint32_t ntracks = 0;
-
   assert (ap_prc);
-  assert (ap_prc->mp4v2_hdl_ != MP4_INVALID_FILE_HANDLE);
+  assert (ap_prc->p_index_);
 
-  /* Obtain the number of tracks */
-  ntracks = MP4GetNumberOfTracks (ap_prc->mp4v2_hdl_, NULL, 0);
-
-  for (i = 0; i < ntracks; ++i)
+  switch (mp4_index_codec (ap_prc->p_index_, mp4_track_kind_video))
     {
-      mp4_track_type_t track_type = mp4_track_unknown;
-
-      track_id = MP4FindTrackId (ap_prc->mp4v2_hdl_, i, NULL, 0);
-      track_type = get_track_type (ap_prc, ap_prc->mp4v2_hdl_, track_id);
-
-#ifndef NDEBUG
-      print_track_info (ap_prc, track_id);
-#endif
+      case mp4_codec_avc:
+        {
+          ap_prc->video_coding_type_ = OMX_VIDEO_CodingAVC;
+        }
+        break;
+      case mp4_codec_mpeg4:
+        {
+          ap_prc->video_coding_type_ = OMX_VIDEO_CodingMPEG4;
+        }
+        break;
+      default:
+        ap_prc->video_coding_type_ = OMX_VIDEO_CodingUnused;
+        break;
+    };
 
-      tiz_check_omx (
-        read_audio_codec_metadata (ap_prc, track_id, track_type));
-      tiz_check_omx (
-        read_video_codec_metadata (ap_prc, track_id, track_type));
-    }
-  return rc;
+  return set_video_coding_on_port (ap_prc);
 }
 
 static void
@@ -955,25 +859,26 @@ send_auto_detect_event (mp4dmuxflt_prc_t * ap_prc, OMX_S32 * ap_coding_type,
 static OMX_ERRORTYPE
 send_port_auto_detect_events (mp4dmuxflt_prc_t * ap_prc)
 {
-  OMX_ERRORTYPE rc = obtain_track_info (ap_prc);
-  if (OMX_ErrorNone == rc)
+  assert (ap_prc);
+  assert (ap_prc->p_index_);
+
+  if (mp4_index_has_track (ap_prc->p_index_, mp4_track_kind_audio))
     {
-      if (mp4_audio_unknown != ap_prc->audio_type_)
-        {
-          send_auto_detect_event (ap_prc, &(ap_prc->audio_coding_type_),
-                                  OMX_AUDIO_CodingUnused,
-                                  OMX_AUDIO_CodingAutoDetect,
-                                  ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX);
-        }
-      if (mp4_video_unknown != ap_prc->video_type_)
-        {
-          send_auto_detect_event (ap_prc, &(ap_prc->video_coding_type_),
-                                  OMX_VIDEO_CodingUnused,
-                                  OMX_VIDEO_CodingAutoDetect,
-                                  ARATELIA_MP4_DEMUXER_FILTER_PORT_2_INDEX);
-        }
+      tiz_check_omx (read_audio_codec_metadata (ap_prc));
+      send_auto_detect_event (ap_prc, &(ap_prc->audio_coding_type_),
+                              OMX_AUDIO_CodingUnused,
+                              OMX_AUDIO_CodingAutoDetect,
+                              ARATELIA_MP4_DEMUXER_FILTER_PORT_1_INDEX);
     }
-  return rc;
+  if (mp4_index_has_track (ap_prc->p_index_, mp4_track_kind_video))
+    {
+      tiz_check_omx (read_video_codec_metadata (ap_prc));
+      send_auto_detect_event (ap_prc, &(ap_prc->video_coding_type_),
+                              OMX_VIDEO_CodingUnused,
+                              OMX_VIDEO_CodingAutoDetect,
+                              ARATELIA_MP4_DEMUXER_FILTER_PORT_2_INDEX);
+    }
+  return OMX_ErrorNone;
 }
 
 static inline OMX_ERRORTYPE
@@ -998,19 +903,13 @@ mp4dmuxflt_prc_ctor (void * ap_prc, va_list * app)
   mp4dmuxflt_prc_t * p_prc
     = super_ctor (typeOf (ap_prc, "mp4dmuxfltprc"), ap_prc, app);
   assert (p_prc);
-  p_prc->tmp_fd_1_ = -1;
-  p_prc->tmp_fd_2_ = -1;
-  p_prc->mp4v2_hdl_ = MP4_INVALID_FILE_HANDLE;
-  p_prc->mp4v2_inited_ = false;
-  p_prc->mp4v2_duration_ = 0;
-  p_prc->p_mp4_store_ = NULL;
-  p_prc->p_aud_store_ = NULL;
-  p_prc->p_vid_store_ = NULL;
-  p_prc->p_aud_header_lengths_ = NULL;
-  p_prc->p_vid_header_lengths_ = NULL;
+  p_prc->p_moov_ = NULL;
+  p_prc->p_index_ = NULL;
+  p_prc->tmp_fd_ = -1;
+  p_prc->spill_base_ = 0;
+  p_prc->spill_end_ = 0;
+  p_prc->p_window_ = NULL;
   reset_stream_parameters (p_prc);
-  MP4SetLogCallback(mp4_log_cback);
-  gp_prc = ap_prc;
   return p_prc;
 }
 
@@ -1018,7 +917,6 @@ static void *
 mp4dmuxflt_prc_dtor (void * ap_obj)
 {
   (void) mp4dmuxflt_prc_deallocate_resources (ap_obj);
-  gp_prc = NULL;
   return super_dtor (typeOf (ap_obj, "mp4dmuxfltprc"), ap_obj);
 }
 
@@ -1029,12 +927,8 @@ mp4dmuxflt_prc_dtor (void * ap_obj)
 static OMX_ERRORTYPE
 mp4dmuxflt_prc_allocate_resources (void * ap_prc, OMX_U32 a_pid)
 {
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-  mp4dmuxflt_prc_t * p_prc = ap_prc;
-  assert (p_prc);
-  tiz_check_omx (alloc_input_store (p_prc));
-  tiz_check_omx (alloc_output_stores (p_prc));
-  return rc;
+  /* Nothing to allocate until the moov box arrives */
+  return OMX_ErrorNone;
 }
 
 static OMX_ERRORTYPE
@@ -1042,9 +936,12 @@ mp4dmuxflt_prc_deallocate_resources (void * ap_prc)
 {
   mp4dmuxflt_prc_t * p_prc = ap_prc;
   assert (p_prc);
-  dealloc_output_stores (p_prc);
-  dealloc_input_store (p_prc);
-  dealloc_mp4v2 (p_prc);
+  reset_parser (p_prc);
+  if (-1 != p_prc->tmp_fd_)
+    {
+      close (p_prc->tmp_fd_);
+      p_prc->tmp_fd_ = -1;
+    }
   return OMX_ErrorNone;
 }
 
@@ -1078,34 +975,9 @@ static OMX_ERRORTYPE
 mp4dmuxflt_prc_buffers_ready (const void * ap_prc)
 {
   mp4dmuxflt_prc_t * p_prc = (mp4dmuxflt_prc_t *) ap_prc;
-  OMX_ERRORTYPE rc = OMX_ErrorNone;
-
   assert (p_prc);
-
-  TIZ_TRACE(handleOf(ap_prc), "buffer ready");
-
-  tiz_check_omx (store_data (p_prc));
-
-  if (!p_prc->mp4v2_inited_)
-    {
-      rc = alloc_mp4v2 (p_prc);
-      if (OMX_ErrorNotReady == rc)
-        {
-          if (MP4V2_INT_MAX_FAILED_ATTEMPTS > p_prc->mp4v2_failed_init_count_)
-            {
-              /* Need to wait for more stream data to be able to initialise the
-                 mp4v2 object */
-              rc = OMX_ErrorNone;
-            }
-          else
-            {
-              /* It's time to give up */
-              rc = OMX_ErrorStreamCorruptFatal;
-            }
-        }
-    }
-
-  return rc;
+  TIZ_TRACE (handleOf (ap_prc), "buffer ready");
+  return demux_stream (p_prc);
 }
 
 static OMX_ERRORTYPE
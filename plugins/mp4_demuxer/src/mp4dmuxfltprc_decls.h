@@ -33,8 +33,7 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
-
-#include <mp4v2/mp4v2.h>
+#include <stdint.h>
 
 #include <OMX_Core.h>
 
@@ -43,29 +42,49 @@ extern "C" {
 #include <tizfilterprc.h>
 #include <tizfilterprc_decls.h>
 
-#include "mp4info.h"
+#include "mp4index.h"
+
+typedef enum mp4dmuxflt_box_state mp4dmuxflt_box_state_t;
+enum mp4dmuxflt_box_state
+{
+  mp4dmuxflt_box_header,
+  mp4dmuxflt_box_moov,
+  mp4dmuxflt_box_mdat,
+  mp4dmuxflt_box_skip
+};
 
 typedef struct mp4dmuxflt_prc mp4dmuxflt_prc_t;
 struct mp4dmuxflt_prc
 {
   /* Object */
   const tiz_filter_prc_t _;
-  int tmp_fd_1_;
-  int tmp_fd_2_;
-  MP4FileHandle mp4v2_hdl_;
-  bool mp4v2_inited_;
-  uint64_t mp4v2_duration_;
-  mp4_track_type_t track_type_;
-  mp4_audio_type_t audio_type_;
-  mp4_video_type_t video_type_;
-  int mp4v2_failed_init_count_;
-  tiz_buffer_t * p_mp4_store_;
-  tiz_buffer_t * p_aud_store_;
-  tiz_buffer_t * p_vid_store_;
-  tiz_vector_t * p_aud_header_lengths_;
-  tiz_vector_t * p_vid_header_lengths_;
-  bool audio_metadata_delivered_;
-  bool video_metadata_delivered_;
+  /* Container parsing */
+  mp4dmuxflt_box_state_t box_state_;
+  uint8_t box_hdr_[MP4_BOX_HEADER_MAX_LEN];
+  size_t box_hdr_len_;
+  uint64_t box_end_;
+  uint64_t file_pos_;
+  uint8_t * p_moov_;
+  size_t moov_len_;
+  size_t moov_size_;
+  mp4_index_t * p_index_;
+  /* 'mdat' data received before the 'moov' box */
+  int tmp_fd_;
+  uint64_t spill_base_;
+  uint64_t spill_end_;
+  /* Sample window */
+  uint8_t * p_window_;
+  size_t window_cap_;
+  size_t window_prefix_;
+  size_t window_len_;
+  size_t window_total_;
+  size_t window_sent_;
+  bool sample_selected_;
+  bool samples_done_;
+  mp4_track_kind_t sample_kind_;
+  uint64_t sample_offset_;
+  uint32_t sample_size_;
+  bool eos_delivered_[mp4_track_kind_max];
   bool audio_auto_detect_on_;
   OMX_S32 audio_coding_type_;
   bool video_auto_detect_on_;
@@ -58,21 +58,6 @@ release_buffer (mp4dmuxsrc_prc_t *);
 static OMX_ERRORTYPE
 prepare_for_port_auto_detection (mp4dmuxsrc_prc_t * ap_prc);
 
-#define on_mp4_error_ret_omx_oom(expr)                                   \
-  do                                                                         \
-    {                                                                        \
-      int mp4_error = 0;                                                 \
-      if (0 != (mp4_error = (expr)))                                     \
-        {                                                                    \
-          TIZ_ERROR (handleOf (p_prc),                                       \
-                     "[OMX_ErrorInsufficientResources] : error while using " \
-                     "libmp4v2");                                          \
-          return OMX_ErrorInsufficientResources;                             \
-        }                                                                    \
-    }                                                                        \
-  while (0)
-
-
 /* static inline OMX_BUFFERHEADERTYPE * */
 /* get_aud_hdr (mp4dmuxsrc_prc_t * ap_prc) */
 /* { */
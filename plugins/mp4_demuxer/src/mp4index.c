@@ -0,0 +1,810 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   mp4index.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia - MP4 box parsing and sample index
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <tizplatform.h>
+
+#include "mp4index.h"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.mp4_demuxer.index"
+#endif
+
+/* A run of chunks with the same number of samples ('stsc' entry) */
+typedef struct mp4_chunk_run mp4_chunk_run_t;
+struct mp4_chunk_run
+{
+  uint32_t first_chunk; /* 0-based */
+  uint32_t samples_per_chunk;
+};
+
+typedef struct mp4_track mp4_track_t;
+struct mp4_track
+{
+  bool present;
+  mp4_codec_t codec;
+  /* ADTS framing, AAC only */
+  bool adts_ok;
+  uint8_t adts_profile;
+  uint8_t adts_freq_idx;
+  uint8_t adts_channels;
+  /* Sample tables */
+  uint32_t nsamples;
+  uint32_t const_size; /* if non-zero, all the samples have this size */
+  uint32_t * p_sizes;
+  uint32_t max_size;
+  uint32_t nchunks;
+  uint64_t * p_chunk_offsets;
+  uint32_t nruns;
+  mp4_chunk_run_t * p_runs;
+  /* Cursor */
+  uint32_t sample;
+  uint32_t chunk;
+  uint32_t run;
+  uint32_t in_chunk;
+  uint64_t chunk_pos;
+};
+
+struct mp4_index
+{
+  mp4_track_t tracks[mp4_track_kind_max];
+};
+
+static inline uint16_t
+be16 (const uint8_t * p)
+{
+  return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t
+be32 (const uint8_t * p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16)
+         | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+static inline uint64_t
+be64 (const uint8_t * p)
+{
+  return ((uint64_t) be32 (p) << 32) | be32 (p + 4);
+}
+
+size_t
+mp4_box_header (const uint8_t * ap_data, const size_t a_len,
+                uint64_t * ap_size, uint32_t * ap_type)
+{
+  size_t hdr_len = 8;
+  assert (ap_data);
+  assert (ap_size);
+  assert (ap_type);
+
+  if (a_len < 8)
+    {
+      return 0;
+    }
+
+  *ap_size = be32 (ap_data);
+  *ap_type = be32 (ap_data + 4);
+  if (1 == *ap_size)
+    {
+      hdr_len = 16;
+      if (a_len < hdr_len)
+        {
+          return 0;
+        }
+      *ap_size = be64 (ap_data + 8);
+    }
+  else if (0 == *ap_size)
+    {
+      *ap_size = MP4_BOX_SIZE_TO_EOF;
+    }
+  return hdr_len;
+}
+
+/* Finds the payload of the first child box of the given type */
+static const uint8_t *
+find_box (const uint8_t * ap_data, const size_t a_len, const uint32_t a_type,
+          size_t * ap_box_len)
+{
+  size_t pos = 0;
+  assert (ap_box_len);
+
+  while (pos < a_len)
+    {
+      uint64_t size = 0;
+      uint32_t type = 0;
+      const size_t hdr_len
+        = mp4_box_header (ap_data + pos, a_len - pos, &size, &type);
+      if (0 == hdr_len)
+        {
+          break;
+        }
+      if (MP4_BOX_SIZE_TO_EOF == size)
+        {
+          size = a_len - pos;
+        }
+      if (size < hdr_len || size > a_len - pos)
+        {
+          break;
+        }
+      if (a_type == type)
+        {
+          *ap_box_len = (size_t) size - hdr_len;
+          return ap_data + pos + hdr_len;
+        }
+      pos += (size_t) size;
+    }
+  return NULL;
+}
+
+/* Reads an MPEG-4 descriptor's tag and length (ISO/IEC 14496-1) */
+static const uint8_t *
+read_descriptor (const uint8_t * p, const uint8_t * ap_end, uint8_t * ap_tag,
+                 size_t * ap_len)
+{
+  int i = 0;
+  assert (ap_tag);
+  assert (ap_len);
+
+  if (p >= ap_end)
+    {
+      return NULL;
+    }
+  *ap_tag = *p++;
+  *ap_len = 0;
+  for (i = 0; i < 4 && p < ap_end; ++i)
+    {
+      const uint8_t b = *p++;
+      *ap_len = (*ap_len << 7) | (b & 0x7F);
+      if (!(b & 0x80))
+        {
+          return (*ap_len <= (size_t) (ap_end - p)) ? p : NULL;
+        }
+    }
+  return NULL;
+}
+
+/* Reads the fields of an AudioSpecificConfig that ADTS can carry */
+static void
+parse_audio_specific_config (mp4_track_t * ap_track, const uint8_t * ap_asc,
+                             const size_t a_len)
+{
+  uint32_t bits = 0;
+  int nbits = 0;
+  uint32_t aot = 0;
+  uint32_t freq_idx = 0;
+  uint32_t channels = 0;
+  assert (ap_track);
+
+  if (a_len < 2)
+    {
+      return;
+    }
+
+  bits = be16 (ap_asc);
+  nbits = 16;
+  if (a_len > 2)
+    {
+      bits = (bits << 8) | ap_asc[2];
+      nbits += 8;
+    }
+
+#define ASC_BITS(n) ((bits >> (nbits -= (n))) & ((1u << (n)) - 1))
+  aot = ASC_BITS (5);
+  freq_idx = ASC_BITS (4);
+  channels = ASC_BITS (4);
+  if ((5 == aot || 29 == aot) && 15 != freq_idx && nbits >= 9)
+    {
+      /* HE-AAC, explicit signalling: ADTS carries the core AAC config */
+      (void) ASC_BITS (4);
+      aot = ASC_BITS (5);
+    }
+#undef ASC_BITS
+
+  if (aot >= 1 && aot <= 4 && freq_idx < 13 && channels >= 1 && channels <= 7)
+    {
+      ap_track->adts_ok = true;
+      ap_track->adts_profile = aot - 1;
+      ap_track->adts_freq_idx = freq_idx;
+      ap_track->adts_channels = channels;
+    }
+}
+
+static void
+parse_esds (mp4_track_t * ap_track, const uint8_t * ap_esds, const size_t a_len)
+{
+  const uint8_t * p = ap_esds + 4; /* version and flags */
+  const uint8_t * p_end = ap_esds + a_len;
+  uint8_t tag = 0;
+  size_t len = 0;
+  assert (ap_track);
+
+  if (a_len < 4 || !(p = read_descriptor (p, p_end, &tag, &len)) || 0x03 != tag
+      || len < 3)
+    {
+      return;
+    }
+
+  /* ES_Descriptor */
+  {
+    const uint8_t flags = p[2];
+    p += 3;
+    if (flags & 0x80)
+      {
+        p += 2;
+      }
+    if ((flags & 0x40) && p < p_end)
+      {
+        p += 1 + *p;
+      }
+    if (flags & 0x20)
+      {
+        p += 2;
+      }
+  }
+
+  /* DecoderConfigDescriptor */
+  if (!(p = read_descriptor (p, p_end, &tag, &len)) || 0x04 != tag || len < 13)
+    {
+      return;
+    }
+
+  switch (p[0])
+    {
+      case 0x40: /* MPEG-4 audio */
+      case 0x66: /* MPEG-2 AAC main */
+      case 0x67: /* MPEG-2 AAC LC */
+      case 0x68: /* MPEG-2 AAC SSR */
+        {
+          ap_track->codec = mp4_codec_aac;
+        }
+        break;
+      case 0x69: /* MPEG-2 audio */
+      case 0x6B: /* MPEG-1 audio */
+        {
+          ap_track->codec = mp4_codec_mp3;
+        }
+        break;
+      default:
+        break;
+    };
+
+  /* DecoderSpecificInfo */
+  p += 13;
+  if (mp4_codec_aac == ap_track->codec
+      && (p = read_descriptor (p, p_end, &tag, &len)) && 0x05 == tag)
+    {
+      parse_audio_specific_config (ap_track, p, len);
+    }
+}
+
+static void
+parse_stsd (mp4_track_t * ap_track, const mp4_track_kind_t a_kind,
+            const uint8_t * ap_stsd, const size_t a_len)
+{
+  uint64_t size = 0;
+  uint32_t type = 0;
+  size_t hdr_len = 0;
+  const uint8_t * p_entry = NULL;
+  size_t entry_len = 0;
+  assert (ap_track);
+
+  /* version/flags, entry count, then the first sample entry */
+  if (a_len < 8 || 0 == be32 (ap_stsd + 4)
+      || 0 == (hdr_len = mp4_box_header (ap_stsd + 8, a_len - 8, &size, &type))
+      || size < hdr_len || size > a_len - 8)
+    {
+      return;
+    }
+  p_entry = ap_stsd + 8 + hdr_len;
+  entry_len = (size_t) size - hdr_len;
+
+  if (mp4_track_kind_video == a_kind)
+    {
+      if (MP4_BOX_TYPE ('a', 'v', 'c', '1') == type
+          || MP4_BOX_TYPE ('a', 'v', 'c', '3') == type)
+        {
+          ap_track->codec = mp4_codec_avc;
+        }
+      else if (MP4_BOX_TYPE ('m', 'p', '4', 'v') == type)
+        {
+          ap_track->codec = mp4_codec_mpeg4;
+        }
+      return;
+    }
+
+  if (MP4_BOX_TYPE ('s', 'a', 'm', 'r') == type)
+    {
+      ap_track->codec = mp4_codec_amr;
+    }
+  else if (MP4_BOX_TYPE ('s', 'a', 'w', 'b') == type)
+    {
+      ap_track->codec = mp4_codec_amrwb;
+    }
+  else if (MP4_BOX_TYPE ('.', 'm', 'p', '3') == type)
+    {
+      ap_track->codec = mp4_codec_mp3;
+    }
+  else if (MP4_BOX_TYPE ('m', 'p', '4', 'a') == type && entry_len >= 28)
+    {
+      /* AudioSampleEntry; QuickTime sound descriptions v1 and v2 are
+         longer */
+      const uint16_t version = be16 (p_entry + 8);
+      const size_t fields_len = 28 + (1 == version ? 16 : 2 == version ? 36 : 0);
+      const uint8_t * p_esds = NULL;
+      size_t esds_len = 0;
+      if (entry_len >= fields_len)
+        {
+          const uint8_t * p_children = p_entry + fields_len;
+          const size_t children_len = entry_len - fields_len;
+          const uint8_t * p_wave = NULL;
+          size_t wave_len = 0;
+          if (!(p_esds = find_box (p_children, children_len,
+                                   MP4_BOX_TYPE ('e', 's', 'd', 's'),
+                                   &esds_len))
+              && (p_wave = find_box (p_children, children_len,
+                                     MP4_BOX_TYPE ('w', 'a', 'v', 'e'),
+                                     &wave_len)))
+            {
+              p_esds = find_box (p_wave, wave_len,
+                                 MP4_BOX_TYPE ('e', 's', 'd', 's'), &esds_len);
+            }
+        }
+      if (p_esds)
+        {
+          parse_esds (ap_track, p_esds, esds_len);
+        }
+    }
+}
+
+static OMX_ERRORTYPE
+parse_stsz (mp4_track_t * ap_track, const uint8_t * ap_stsz,
+            const size_t a_len)
+{
+  uint32_t i = 0;
+  assert (ap_track);
+
+  tiz_check_true_ret_val (a_len >= 12, OMX_ErrorStreamCorrupt);
+  ap_track->const_size = be32 (ap_stsz + 4);
+  ap_track->nsamples = be32 (ap_stsz + 8);
+  ap_track->max_size = ap_track->const_size;
+  if (0 == ap_track->const_size && ap_track->nsamples > 0)
+    {
+      tiz_check_true_ret_val ((a_len - 12) / 4 >= ap_track->nsamples,
+                              OMX_ErrorStreamCorrupt);
+      tiz_check_null_ret_oom (
+        (ap_track->p_sizes
+         = tiz_mem_alloc (ap_track->nsamples * sizeof (uint32_t))));
+      for (i = 0; i < ap_track->nsamples; ++i)
+        {
+          ap_track->p_sizes[i] = be32 (ap_stsz + 12 + i * 4);
+          ap_track->max_size = MAX (ap_track->max_size, ap_track->p_sizes[i]);
+        }
+    }
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+parse_stsc (mp4_track_t * ap_track, const uint8_t * ap_stsc,
+            const size_t a_len)
+{
+  uint32_t i = 0;
+  assert (ap_track);
+
+  tiz_check_true_ret_val (a_len >= 8, OMX_ErrorStreamCorrupt);
+  ap_track->nruns = be32 (ap_stsc + 4);
+  tiz_check_true_ret_val (ap_track->nruns > 0
+                            && (a_len - 8) / 12 >= ap_track->nruns,
+                          OMX_ErrorStreamCorrupt);
+  tiz_check_null_ret_oom (
+    (ap_track->p_runs
+     = tiz_mem_alloc (ap_track->nruns * sizeof (mp4_chunk_run_t))));
+  for (i = 0; i < ap_track->nruns; ++i)
+    {
+      const uint32_t first_chunk = be32 (ap_stsc + 8 + i * 12);
+      tiz_check_true_ret_val (first_chunk > 0
+                                && (0 == i
+                                    || first_chunk - 1
+                                         > ap_track->p_runs[i - 1].first_chunk),
+                              OMX_ErrorStreamCorrupt);
+      ap_track->p_runs[i].first_chunk = first_chunk - 1;
+      ap_track->p_runs[i].samples_per_chunk = be32 (ap_stsc + 12 + i * 12);
+    }
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+parse_chunk_offsets (mp4_track_t * ap_track, const uint8_t * ap_stco,
+                     const size_t a_len, const bool a_64bit)
+{
+  const size_t entry_len = a_64bit ? 8 : 4;
+  uint32_t i = 0;
+  assert (ap_track);
+
+  tiz_check_true_ret_val (a_len >= 8, OMX_ErrorStreamCorrupt);
+  ap_track->nchunks = be32 (ap_stco + 4);
+  tiz_check_true_ret_val ((a_len - 8) / entry_len >= ap_track->nchunks,
+                          OMX_ErrorStreamCorrupt);
+  if (ap_track->nchunks > 0)
+    {
+      tiz_check_null_ret_oom (
+        (ap_track->p_chunk_offsets
+         = tiz_mem_alloc (ap_track->nchunks * sizeof (uint64_t))));
+    }
+  for (i = 0; i < ap_track->nchunks; ++i)
+    {
+      const uint8_t * p = ap_stco + 8 + i * entry_len;
+      ap_track->p_chunk_offsets[i] = a_64bit ? be64 (p) : be32 (p);
+    }
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE
+parse_stbl (mp4_track_t * ap_track, const mp4_track_kind_t a_kind,
+            const uint8_t * ap_stbl, const size_t a_len)
+{
+  const uint8_t * p_box = NULL;
+  size_t box_len = 0;
+  bool co64 = false;
+  assert (ap_track);
+
+  if ((p_box = find_box (ap_stbl, a_len, MP4_BOX_TYPE ('s', 't', 's', 'd'),
+                         &box_len)))
+    {
+      parse_stsd (ap_track, a_kind, p_box, box_len);
+    }
+
+  p_box = find_box (ap_stbl, a_len, MP4_BOX_TYPE ('s', 't', 's', 'z'),
+                    &box_len);
+  tiz_check_true_ret_val (NULL != p_box, OMX_ErrorStreamCorrupt);
+  tiz_check_omx (parse_stsz (ap_track, p_box, box_len));
+
+  p_box = find_box (ap_stbl, a_len, MP4_BOX_TYPE ('s', 't', 's', 'c'),
+                    &box_len);
+  tiz_check_true_ret_val (NULL != p_box, OMX_ErrorStreamCorrupt);
+  tiz_check_omx (parse_stsc (ap_track, p_box, box_len));
+
+  if (!(p_box = find_box (ap_stbl, a_len, MP4_BOX_TYPE ('s', 't', 'c', 'o'),
+                          &box_len)))
+    {
+      co64 = true;
+      p_box = find_box (ap_stbl, a_len, MP4_BOX_TYPE ('c', 'o', '6', '4'),
+                        &box_len);
+      tiz_check_true_ret_val (NULL != p_box, OMX_ErrorStreamCorrupt);
+    }
+  return parse_chunk_offsets (ap_track, p_box, box_len, co64);
+}
+
+static void
+normalize_cursor (mp4_track_t * ap_track)
+{
+  assert (ap_track);
+  while (ap_track->chunk < ap_track->nchunks)
+    {
+      while (ap_track->run + 1 < ap_track->nruns
+             && ap_track->p_runs[ap_track->run + 1].first_chunk
+                  <= ap_track->chunk)
+        {
+          ++(ap_track->run);
+        }
+      if (ap_track->p_runs[ap_track->run].samples_per_chunk > 0)
+        {
+          break;
+        }
+      ++(ap_track->chunk);
+    }
+}
+
+static void
+rewind_track (mp4_track_t * ap_track)
+{
+  assert (ap_track);
+  ap_track->sample = 0;
+  ap_track->chunk = 0;
+  ap_track->run = 0;
+  ap_track->in_chunk = 0;
+  ap_track->chunk_pos = 0;
+  if (ap_track->present)
+    {
+      normalize_cursor (ap_track);
+    }
+}
+
+static void
+clear_track (mp4_track_t * ap_track)
+{
+  assert (ap_track);
+  tiz_mem_free (ap_track->p_sizes);
+  tiz_mem_free (ap_track->p_chunk_offsets);
+  tiz_mem_free (ap_track->p_runs);
+  tiz_mem_set (ap_track, 0, sizeof (mp4_track_t));
+}
+
+static OMX_ERRORTYPE
+parse_trak (mp4_index_t * ap_index, const uint8_t * ap_trak,
+            const size_t a_len)
+{
+  const uint8_t * p_mdia = NULL;
+  const uint8_t * p_hdlr = NULL;
+  const uint8_t * p_minf = NULL;
+  const uint8_t * p_stbl = NULL;
+  size_t mdia_len = 0;
+  size_t hdlr_len = 0;
+  size_t minf_len = 0;
+  size_t stbl_len = 0;
+  uint32_t handler = 0;
+  mp4_track_kind_t kind = mp4_track_kind_max;
+  mp4_track_t * p_track = NULL;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+  assert (ap_index);
+
+  if (!(p_mdia = find_box (ap_trak, a_len, MP4_BOX_TYPE ('m', 'd', 'i', 'a'),
+                           &mdia_len))
+      || !(p_hdlr = find_box (p_mdia, mdia_len,
+                              MP4_BOX_TYPE ('h', 'd', 'l', 'r'), &hdlr_len))
+      || hdlr_len < 12)
+    {
+      return OMX_ErrorNone;
+    }
+
+  /* version/flags, pre_defined, handler_type */
+  handler = be32 (p_hdlr + 8);
+  if (MP4_BOX_TYPE ('s', 'o', 'u', 'n') == handler)
+    {
+      kind = mp4_track_kind_audio;
+    }
+  else if (MP4_BOX_TYPE ('v', 'i', 'd', 'e') == handler)
+    {
+      kind = mp4_track_kind_video;
+    }
+
+  if (mp4_track_kind_max == kind || ap_index->tracks[kind].present
+      || !(p_minf = find_box (p_mdia, mdia_len,
+                              MP4_BOX_TYPE ('m', 'i', 'n', 'f'), &minf_len))
+      || !(p_stbl = find_box (p_minf, minf_len,
+                              MP4_BOX_TYPE ('s', 't', 'b', 'l'), &stbl_len)))
+    {
+      /* Only the first track of each kind is used */
+      return OMX_ErrorNone;
+    }
+
+  p_track = &(ap_index->tracks[kind]);
+  if (OMX_ErrorNone != (rc = parse_stbl (p_track, kind, p_stbl, stbl_len)))
+    {
+      TIZ_LOG (TIZ_PRIORITY_ERROR, "[%s] : malformed %s track sample tables",
+               tiz_err_to_str (rc),
+               mp4_track_kind_audio == kind ? "audio" : "video");
+      clear_track (p_track);
+      return (OMX_ErrorInsufficientResources == rc) ? rc : OMX_ErrorNone;
+    }
+
+  p_track->present = true;
+  rewind_track (p_track);
+  TIZ_LOG (TIZ_PRIORITY_TRACE,
+           "%s track : codec [%d] samples [%u] chunks [%u] max size [%u]",
+           mp4_track_kind_audio == kind ? "audio" : "video", p_track->codec,
+           p_track->nsamples, p_track->nchunks, p_track->max_size);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE
+mp4_index_init (mp4_index_t ** app_index, const uint8_t * ap_moov,
+                const size_t a_len)
+{
+  mp4_index_t * p_index = NULL;
+  size_t pos = 0;
+  OMX_ERRORTYPE rc = OMX_ErrorNone;
+
+  assert (app_index);
+  assert (ap_moov);
+
+  tiz_check_null_ret_oom ((p_index = tiz_mem_calloc (1, sizeof (mp4_index_t))));
+
+  while (OMX_ErrorNone == rc && pos < a_len)
+    {
+      uint64_t size = 0;
+      uint32_t type = 0;
+      const size_t hdr_len
+        = mp4_box_header (ap_moov + pos, a_len - pos, &size, &type);
+      if (MP4_BOX_SIZE_TO_EOF == size)
+        {
+          size = a_len - pos;
+        }
+      if (0 == hdr_len || size < hdr_len || size > a_len - pos)
+        {
+          break;
+        }
+      if (MP4_BOX_TYPE ('t', 'r', 'a', 'k') == type)
+        {
+          rc = parse_trak (p_index, ap_moov + pos + hdr_len,
+                           (size_t) size - hdr_len);
+        }
+      pos += (size_t) size;
+    }
+
+  if (OMX_ErrorNone == rc && !p_index->tracks[mp4_track_kind_audio].present
+      && !p_index->tracks[mp4_track_kind_video].present)
+    {
+      rc = OMX_ErrorStreamCorrupt;
+    }
+
+  if (OMX_ErrorNone != rc)
+    {
+      mp4_index_destroy (p_index);
+      p_index = NULL;
+    }
+
+  *app_index = p_index;
+  return rc;
+}
+
+void
+mp4_index_destroy (mp4_index_t * ap_index)
+{
+  if (ap_index)
+    {
+      int i = 0;
+      for (i = 0; i < mp4_track_kind_max; ++i)
+        {
+          clear_track (&(ap_index->tracks[i]));
+        }
+      tiz_mem_free (ap_index);
+    }
+}
+
+void
+mp4_index_rewind (mp4_index_t * ap_index)
+{
+  int i = 0;
+  assert (ap_index);
+  for (i = 0; i < mp4_track_kind_max; ++i)
+    {
+      rewind_track (&(ap_index->tracks[i]));
+    }
+}
+
+bool
+mp4_index_has_track (const mp4_index_t * ap_index,
+                     const mp4_track_kind_t a_kind)
+{
+  assert (ap_index);
+  assert (a_kind < mp4_track_kind_max);
+  return ap_index->tracks[a_kind].present;
+}
+
+mp4_codec_t
+mp4_index_codec (const mp4_index_t * ap_index, const mp4_track_kind_t a_kind)
+{
+  assert (ap_index);
+  assert (a_kind < mp4_track_kind_max);
+  return ap_index->tracks[a_kind].codec;
+}
+
+uint32_t
+mp4_index_sample_count (const mp4_index_t * ap_index,
+                        const mp4_track_kind_t a_kind)
+{
+  assert (ap_index);
+  assert (a_kind < mp4_track_kind_max);
+  return ap_index->tracks[a_kind].nsamples;
+}
+
+uint32_t
+mp4_index_max_sample_size (const mp4_index_t * ap_index)
+{
+  assert (ap_index);
+  return MAX (ap_index->tracks[mp4_track_kind_audio].max_size,
+              ap_index->tracks[mp4_track_kind_video].max_size);
+}
+
+bool
+mp4_index_peek (const mp4_index_t * ap_index, const mp4_track_kind_t a_kind,
+                uint64_t * ap_offset, uint32_t * ap_size)
+{
+  const mp4_track_t * p_track = NULL;
+  assert (ap_index);
+  assert (a_kind < mp4_track_kind_max);
+  assert (ap_offset);
+  assert (ap_size);
+
+  p_track = &(ap_index->tracks[a_kind]);
+  if (!p_track->present || p_track->sample >= p_track->nsamples
+      || p_track->chunk >= p_track->nchunks)
+    {
+      return false;
+    }
+
+  *ap_offset = p_track->p_chunk_offsets[p_track->chunk] + p_track->chunk_pos;
+  *ap_size = p_track->const_size ? p_track->const_size
+                                 : p_track->p_sizes[p_track->sample];
+  return true;
+}
+
+void
+mp4_index_advance (mp4_index_t * ap_index, const mp4_track_kind_t a_kind)
+{
+  mp4_track_t * p_track = NULL;
+  uint64_t offset = 0;
+  uint32_t size = 0;
+  assert (ap_index);
+  assert (a_kind < mp4_track_kind_max);
+
+  if (!mp4_index_peek (ap_index, a_kind, &offset, &size))
+    {
+      return;
+    }
+
+  p_track = &(ap_index->tracks[a_kind]);
+  p_track->chunk_pos += size;
+  ++(p_track->sample);
+  if (++(p_track->in_chunk)
+      >= p_track->p_runs[p_track->run].samples_per_chunk)
+    {
+      ++(p_track->chunk);
+      p_track->in_chunk = 0;
+      p_track->chunk_pos = 0;
+      normalize_cursor (p_track);
+    }
+}
+
+bool
+mp4_index_adts_header (const mp4_index_t * ap_index, const uint32_t a_size,
+                       uint8_t ap_header[7])
+{
+  const mp4_track_t * p_track = NULL;
+  uint32_t frame_len = a_size + 7;
+  assert (ap_index);
+  assert (ap_header);
+
+  p_track = &(ap_index->tracks[mp4_track_kind_audio]);
+  if (mp4_codec_aac != p_track->codec || !p_track->adts_ok
+      || frame_len > 0x1FFF)
+    {
+      return false;
+    }
+
+  /* MPEG-4, no CRC, single raw data block */
+  ap_header[0] = 0xFF;
+  ap_header[1] = 0xF1;
+  ap_header[2] = (uint8_t) ((p_track->adts_profile << 6)
+                            | (p_track->adts_freq_idx << 2)
+                            | (p_track->adts_channels >> 2));
+  ap_header[3]
+    = (uint8_t) (((p_track->adts_channels & 3) << 6) | (frame_len >> 11));
+  ap_header[4] = (uint8_t) ((frame_len >> 3) & 0xFF);
+  ap_header[5] = (uint8_t) (((frame_len & 7) << 5) | 0x1F);
+  ap_header[6] = 0xFC;
+  return true;
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   mp4index.h
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  Tizonia - MP4 box parsing and sample index
+ *
+ * The sample tables of the 'moov' box are kept in the compact form they have
+ * in the container (chunk offsets, sample-to-chunk runs and sample sizes),
+ * and walked with a cursor per track to obtain the location of each sample.
+ *
+ */
+
+#ifndef MP4INDEX_H
+#define MP4INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OMX_Core.h>
+
+#define MP4_BOX_TYPE(a, b, c, d)                                    \
+  (((uint32_t) (a) << 24) | ((uint32_t) (b) << 16) | ((uint32_t) (c) << 8) \
+   | (uint32_t) (d))
+
+/* A box that extends to the end of the file */
+#define MP4_BOX_SIZE_TO_EOF UINT64_MAX
+
+/* Max. size of a box header (64-bit 'largesize' form) */
+#define MP4_BOX_HEADER_MAX_LEN 16
+
+typedef enum mp4_track_kind mp4_track_kind_t;
+enum mp4_track_kind
+{
+  mp4_track_kind_audio,
+  mp4_track_kind_video,
+  mp4_track_kind_max
+};
+
+typedef enum mp4_codec mp4_codec_t;
+enum mp4_codec
+{
+  mp4_codec_unknown,
+  mp4_codec_aac,
+  mp4_codec_mp3,
+  mp4_codec_amr,
+  mp4_codec_amrwb,
+  mp4_codec_avc,
+  mp4_codec_mpeg4,
+};
+
+typedef struct mp4_index mp4_index_t;
+
+/**
+ * Parse a box header.
+ *
+ * @return The length of the header, or 0 if more than a_len bytes are needed.
+ * The box size includes the header, and is MP4_BOX_SIZE_TO_EOF for a box that
+ * extends to the end of the file.
+ */
+size_t
+mp4_box_header (const uint8_t * ap_data, const size_t a_len,
+                uint64_t * ap_size, uint32_t * ap_type);
+
+/**
+ * Build the index from the payload of a 'moov' box. The first audio track
+ * and the first video track are indexed.
+ *
+ * @return OMX_ErrorNone, OMX_ErrorStreamCorrupt if the box is malformed or
+ * has no usable track, or OMX_ErrorInsufficientResources.
+ */
+OMX_ERRORTYPE
+mp4_index_init (mp4_index_t ** app_index, const uint8_t * ap_moov,
+                const size_t a_len);
+
+void
+mp4_index_destroy (mp4_index_t * ap_index);
+
+/**
+ * Rewind all the tracks to their first sample.
+ */
+void
+mp4_index_rewind (mp4_index_t * ap_index);
+
+bool
+mp4_index_has_track (const mp4_index_t * ap_index,
+                     const mp4_track_kind_t a_kind);
+
+mp4_codec_t
+mp4_index_codec (const mp4_index_t * ap_index, const mp4_track_kind_t a_kind);
+
+uint32_t
+mp4_index_sample_count (const mp4_index_t * ap_index,
+                        const mp4_track_kind_t a_kind);
+
+/**
+ * The size of the largest sample in any of the tracks.
+ */
+uint32_t
+mp4_index_max_sample_size (const mp4_index_t * ap_index);
+
+/**
+ * Location of the track's next sample in the file.
+ *
+ * @return false if all the samples of the track have been consumed.
+ */
+bool
+mp4_index_peek (const mp4_index_t * ap_index, const mp4_track_kind_t a_kind,
+                uint64_t * ap_offset, uint32_t * ap_size);
+
+/**
+ * Move the track's cursor to the next sample.
+ */
+void
+mp4_index_advance (mp4_index_t * ap_index, const mp4_track_kind_t a_kind);
+
+/**
+ * Produce the ADTS header for an AAC frame of the audio track, as AAC
+ * decoders expect framed input.
+ *
+ * @return false if the audio track is not AAC or its configuration can not be
+ * expressed in ADTS.
+ */
+bool
+mp4_index_adts_header (const mp4_index_t * ap_index, const uint32_t a_size,
+                       uint8_t ap_header[7]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MP4INDEX_H */
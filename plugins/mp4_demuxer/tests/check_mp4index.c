@@ -0,0 +1,453 @@
+/**
+ * Copyright (C) 2011-2020 Aratelia Limited - Juan A. Rubio and contributors
+ *
+ * This file is part of Tizonia
+ *
+ * Tizonia is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Tizonia is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Tizonia.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file   check_mp4index.c
+ * @author Juan A. Rubio <juan.rubio@aratelia.com>
+ *
+ * @brief  MP4 sample index unit tests
+ *
+ * The fixtures are small MP4 files built in memory: an 'ftyp' box, and a
+ * 'moov' box describing one AAC track whose three samples are stored in two
+ * chunks of an 'mdat' box.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <check.h>
+
+#include <tizplatform.h>
+
+#include "mp4index.h"
+
+#ifdef TIZ_LOG_CATEGORY_NAME
+#undef TIZ_LOG_CATEGORY_NAME
+#define TIZ_LOG_CATEGORY_NAME "tiz.mp4_demuxer.check"
+#endif
+
+#define FIXTURE_MAX_LEN 1024
+#define FIXTURE_NSAMPLES 3
+
+static const uint32_t g_sample_sizes[FIXTURE_NSAMPLES] = { 10, 20, 30 };
+
+typedef struct fixture fixture_t;
+struct fixture
+{
+  uint8_t data[FIXTURE_MAX_LEN];
+  size_t len;
+  size_t stsc_pos;
+  /* Patched once the position of 'mdat' is known */
+  size_t stco_pos;
+  size_t mdat_payload_pos;
+};
+
+static void
+put32 (uint8_t * p, const uint32_t a_val)
+{
+  p[0] = (uint8_t) (a_val >> 24);
+  p[1] = (uint8_t) (a_val >> 16);
+  p[2] = (uint8_t) (a_val >> 8);
+  p[3] = (uint8_t) a_val;
+}
+
+static void
+append (fixture_t * ap_fx, const void * ap_data, const size_t a_len)
+{
+  fail_if (ap_fx->len + a_len > FIXTURE_MAX_LEN);
+  memcpy (ap_fx->data + ap_fx->len, ap_data, a_len);
+  ap_fx->len += a_len;
+}
+
+static void
+append32 (fixture_t * ap_fx, const uint32_t a_val)
+{
+  uint8_t buf[4];
+  put32 (buf, a_val);
+  append (ap_fx, buf, sizeof (buf));
+}
+
+/* Writes a box header with a placeholder size; returns the box position */
+static size_t
+open_box (fixture_t * ap_fx, const char * ap_type)
+{
+  const size_t pos = ap_fx->len;
+  append32 (ap_fx, 0);
+  append (ap_fx, ap_type, 4);
+  return pos;
+}
+
+static void
+close_box (fixture_t * ap_fx, const size_t a_pos)
+{
+  put32 (ap_fx->data + a_pos, (uint32_t) (ap_fx->len - a_pos));
+}
+
+static void
+append_esds (fixture_t * ap_fx)
+{
+  /* ES_Descriptor, DecoderConfigDescriptor (MPEG-4 audio) and an
+     AudioSpecificConfig for AAC LC, 44.1 kHz, stereo */
+  static const uint8_t descriptors[] = {
+    0x03, 25, 0x00, 0x01, 0x00,                   /* ES_Descriptor */
+    0x04, 17, 0x40, 0x15, 0x00, 0x00, 0x00, 0x00, /* DecoderConfig */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 2, 0x12, 0x10,                          /* DecoderSpecificInfo */
+    0x06, 1, 0x02                                 /* SLConfigDescriptor */
+  };
+  const size_t esds = open_box (ap_fx, "esds");
+  append32 (ap_fx, 0); /* version and flags */
+  append (ap_fx, descriptors, sizeof (descriptors));
+  close_box (ap_fx, esds);
+}
+
+static void
+append_stbl (fixture_t * ap_fx)
+{
+  static const uint8_t audio_sample_entry[28] = {
+    0, 0, 0, 0, 0, 0, 0, 1, /* reserved, data_reference_index */
+    0, 0, 0, 0, 0, 0, 0, 0, /* version, revision, vendor */
+    0, 2, 0, 16,            /* channels, sample size */
+    0, 0, 0, 0,             /* pre_defined, reserved */
+    0xAC, 0x44, 0, 0        /* sample rate (16.16) */
+  };
+  size_t stbl, stsd, mp4a, box;
+  int i;
+
+  stbl = open_box (ap_fx, "stbl");
+
+  stsd = open_box (ap_fx, "stsd");
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 1);
+  mp4a = open_box (ap_fx, "mp4a");
+  append (ap_fx, audio_sample_entry, sizeof (audio_sample_entry));
+  append_esds (ap_fx);
+  close_box (ap_fx, mp4a);
+  close_box (ap_fx, stsd);
+
+  box = open_box (ap_fx, "stsz");
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 0); /* samples have different sizes */
+  append32 (ap_fx, FIXTURE_NSAMPLES);
+  for (i = 0; i < FIXTURE_NSAMPLES; ++i)
+    {
+      append32 (ap_fx, g_sample_sizes[i]);
+    }
+  close_box (ap_fx, box);
+
+  /* Chunk #1 holds two samples, chunk #2 the last one */
+  box = open_box (ap_fx, "stsc");
+  ap_fx->stsc_pos = box;
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 2);
+  append32 (ap_fx, 1);
+  append32 (ap_fx, 2);
+  append32 (ap_fx, 1);
+  append32 (ap_fx, 2);
+  append32 (ap_fx, 1);
+  append32 (ap_fx, 1);
+  close_box (ap_fx, box);
+
+  box = open_box (ap_fx, "stco");
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 2);
+  ap_fx->stco_pos = ap_fx->len;
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 0);
+  close_box (ap_fx, box);
+
+  close_box (ap_fx, stbl);
+}
+
+static void
+append_moov (fixture_t * ap_fx)
+{
+  size_t moov, trak, mdia, hdlr, minf;
+
+  moov = open_box (ap_fx, "moov");
+  trak = open_box (ap_fx, "trak");
+  mdia = open_box (ap_fx, "mdia");
+
+  hdlr = open_box (ap_fx, "hdlr");
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 0);
+  append (ap_fx, "soun", 4);
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 0);
+  append32 (ap_fx, 0);
+  close_box (ap_fx, hdlr);
+
+  minf = open_box (ap_fx, "minf");
+  append_stbl (ap_fx);
+  close_box (ap_fx, minf);
+
+  close_box (ap_fx, mdia);
+  close_box (ap_fx, trak);
+  close_box (ap_fx, moov);
+}
+
+static void
+append_mdat (fixture_t * ap_fx)
+{
+  uint8_t sample[64];
+  size_t mdat;
+  int i;
+
+  mdat = open_box (ap_fx, "mdat");
+  ap_fx->mdat_payload_pos = ap_fx->len;
+  for (i = 0; i < FIXTURE_NSAMPLES; ++i)
+    {
+      /* Each sample is filled with its 1-based number */
+      memset (sample, i + 1, g_sample_sizes[i]);
+      append (ap_fx, sample, g_sample_sizes[i]);
+    }
+  close_box (ap_fx, mdat);
+}
+
+static void
+build_fixture (fixture_t * ap_fx, const bool a_moov_first)
+{
+  size_t ftyp;
+
+  memset (ap_fx, 0, sizeof (fixture_t));
+
+  ftyp = open_box (ap_fx, "ftyp");
+  append (ap_fx, "M4A ", 4);
+  append32 (ap_fx, 0);
+  append (ap_fx, "isom", 4);
+  close_box (ap_fx, ftyp);
+
+  if (a_moov_first)
+    {
+      append_moov (ap_fx);
+      append_mdat (ap_fx);
+    }
+  else
+    {
+      append_mdat (ap_fx);
+      append_moov (ap_fx);
+    }
+
+  put32 (ap_fx->data + ap_fx->stco_pos, (uint32_t) ap_fx->mdat_payload_pos);
+  put32 (ap_fx->data + ap_fx->stco_pos + 4,
+         (uint32_t) (ap_fx->mdat_payload_pos + g_sample_sizes[0]
+                     + g_sample_sizes[1]));
+}
+
+/* Walks the top-level boxes, as the demuxer does with its input */
+static const uint8_t *
+find_top_level_box (const uint8_t * ap_data, const size_t a_len,
+                    const uint32_t a_type, size_t * ap_payload_len)
+{
+  size_t pos = 0;
+  while (pos < a_len)
+    {
+      uint64_t size = 0;
+      uint32_t type = 0;
+      const size_t hdr_len
+        = mp4_box_header (ap_data + pos, a_len - pos, &size, &type);
+      if (0 == hdr_len || size < hdr_len || size > a_len - pos)
+        {
+          return NULL;
+        }
+      if (a_type == type)
+        {
+          *ap_payload_len = (size_t) size - hdr_len;
+          return ap_data + pos + hdr_len;
+        }
+      pos += (size_t) size;
+    }
+  return NULL;
+}
+
+static void
+check_index_against_fixture (const fixture_t * ap_fx)
+{
+  const uint8_t * p_moov = NULL;
+  size_t moov_len = 0;
+  mp4_index_t * p_index = NULL;
+  uint64_t offset = 0;
+  uint64_t expected_offset = ap_fx->mdat_payload_pos;
+  uint32_t size = 0;
+  uint8_t adts[7];
+  int i = 0;
+
+  p_moov = find_top_level_box (ap_fx->data, ap_fx->len,
+                               MP4_BOX_TYPE ('m', 'o', 'o', 'v'), &moov_len);
+  fail_if (NULL == p_moov);
+
+  fail_if (OMX_ErrorNone != mp4_index_init (&p_index, p_moov, moov_len));
+  fail_if (NULL == p_index);
+
+  fail_if (!mp4_index_has_track (p_index, mp4_track_kind_audio));
+  fail_if (mp4_index_has_track (p_index, mp4_track_kind_video));
+  fail_if (mp4_codec_aac != mp4_index_codec (p_index, mp4_track_kind_audio));
+  fail_if (FIXTURE_NSAMPLES
+           != mp4_index_sample_count (p_index, mp4_track_kind_audio));
+  fail_if (g_sample_sizes[FIXTURE_NSAMPLES - 1]
+           != mp4_index_max_sample_size (p_index));
+
+  for (i = 0; i < FIXTURE_NSAMPLES; ++i)
+    {
+      fail_if (!mp4_index_peek (p_index, mp4_track_kind_audio, &offset, &size));
+      fail_if (expected_offset != offset);
+      fail_if (g_sample_sizes[i] != size);
+      fail_if (offset + size > ap_fx->len);
+      fail_if (i + 1 != ap_fx->data[offset]);
+      fail_if (i + 1 != ap_fx->data[offset + size - 1]);
+      expected_offset += size;
+      mp4_index_advance (p_index, mp4_track_kind_audio);
+    }
+  fail_if (mp4_index_peek (p_index, mp4_track_kind_audio, &offset, &size));
+
+  /* After a rewind, the first sample comes out again */
+  mp4_index_rewind (p_index);
+  fail_if (!mp4_index_peek (p_index, mp4_track_kind_audio, &offset, &size));
+  fail_if (ap_fx->mdat_payload_pos != offset);
+
+  /* AAC LC (profile 1), 44.1 kHz (index 4), 2 channels, 17 bytes */
+  fail_if (!mp4_index_adts_header (p_index, g_sample_sizes[0], adts));
+  fail_if (0xFF != adts[0] || 0xF1 != adts[1]);
+  fail_if (((1 << 6) | (4 << 2)) != adts[2]);
+  fail_if ((2 << 6) != adts[3]);
+  fail_if ((g_sample_sizes[0] + 7) != (uint32_t) ((adts[4] << 3)
+                                                  | (adts[5] >> 5)));
+
+  mp4_index_destroy (p_index);
+}
+
+START_TEST (test_mp4index_moov_before_mdat)
+{
+  fixture_t fx;
+  build_fixture (&fx, true);
+  check_index_against_fixture (&fx);
+}
+END_TEST
+
+START_TEST (test_mp4index_mdat_before_moov)
+{
+  fixture_t fx;
+  build_fixture (&fx, false);
+  check_index_against_fixture (&fx);
+}
+END_TEST
+
+START_TEST (test_mp4index_truncated_and_corrupt_boxes)
+{
+  fixture_t fx;
+  const uint8_t * p_moov = NULL;
+  size_t moov_len = 0;
+  mp4_index_t * p_index = NULL;
+  uint64_t size = 0;
+  uint32_t type = 0;
+  static const uint8_t large_hdr[12]
+    = { 0, 0, 0, 1, 'm', 'd', 'a', 't', 0, 0, 0, 0 };
+
+  /* Box headers need 8 bytes, or 16 in the 'largesize' form */
+  build_fixture (&fx, true);
+  fail_if (0 != mp4_box_header (fx.data, 7, &size, &type));
+  fail_if (8 != mp4_box_header (fx.data, 8, &size, &type));
+  fail_if (MP4_BOX_TYPE ('f', 't', 'y', 'p') != type);
+  fail_if (0 != mp4_box_header (large_hdr, sizeof (large_hdr), &size, &type));
+
+  p_moov = find_top_level_box (fx.data, fx.len,
+                               MP4_BOX_TYPE ('m', 'o', 'o', 'v'), &moov_len);
+  fail_if (NULL == p_moov);
+
+  /* A 'moov' cut short loses its only track */
+  fail_if (OMX_ErrorStreamCorrupt
+           != mp4_index_init (&p_index, p_moov, moov_len / 2));
+  fail_if (NULL != p_index);
+
+  /* An empty 'moov' has no usable track */
+  fail_if (OMX_ErrorStreamCorrupt != mp4_index_init (&p_index, p_moov, 0));
+  fail_if (NULL != p_index);
+
+  /* The 'mdat' is not complete in a truncated file */
+  fail_if (NULL != find_top_level_box (fx.data, fx.len - 1,
+                                       MP4_BOX_TYPE ('m', 'd', 'a', 't'),
+                                       &moov_len));
+
+  /* 'stsc' chunk numbers are 1-based; a zero makes the track unusable */
+  build_fixture (&fx, true);
+  put32 (fx.data + fx.stsc_pos + 16, 0);
+  p_moov = find_top_level_box (fx.data, fx.len,
+                               MP4_BOX_TYPE ('m', 'o', 'o', 'v'), &moov_len);
+  fail_if (OMX_ErrorStreamCorrupt
+           != mp4_index_init (&p_index, p_moov, moov_len));
+  fail_if (NULL != p_index);
+
+  /* A box that claims to be larger than its parent is not followed */
+  build_fixture (&fx, true);
+  put32 (fx.data + fx.stsc_pos, 0x7FFFFFFF);
+  p_moov = find_top_level_box (fx.data, fx.len,
+                               MP4_BOX_TYPE ('m', 'o', 'o', 'v'), &moov_len);
+  fail_if (OMX_ErrorStreamCorrupt
+           != mp4_index_init (&p_index, p_moov, moov_len));
+  fail_if (NULL != p_index);
+}
+END_TEST
+
+Suite *
+mp4index_suite (void)
+{
+  TCase *tc_mp4index = NULL;
+  Suite *s = suite_create ("MP4 sample index");
+
+  /* mp4 index test cases */
+  tc_mp4index = tcase_create ("mp4index");
+  tcase_add_test (tc_mp4index, test_mp4index_moov_before_mdat);
+  tcase_add_test (tc_mp4index, test_mp4index_mdat_before_moov);
+  tcase_add_test (tc_mp4index, test_mp4index_truncated_and_corrupt_boxes);
+  suite_add_tcase (s, tc_mp4index);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed = 0;
+  SRunner *sr = NULL;
+
+  tiz_log_init ();
+
+  TIZ_LOG (TIZ_PRIORITY_TRACE, "Tizonia MP4 demuxer unit tests");
+
+  sr = srunner_create (mp4index_suite ());
+  srunner_run_all (sr, CK_VERBOSE);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  tiz_log_deinit ();
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Local Variables: */
+/* c-default-style: gnu */
+/* fill-column: 79 */
+/* indent-tabs-mode: nil */
+/* compile-command: "make check" */
+/* End: */
@@ -44,20 +44,6 @@
 #include "opusdprc.h"
 #include "opusdprc_decls.h"
 
-#ifdef HAVE_LRINTF
-#define float2int(x) lrintf (x)
-#else
-#define float2int(flt) ((int) (floor (.5 + flt)))
-#endif
-
-#ifndef HAVE_FMINF
-#define fminf(_x, _y) ((_x) < (_y) ? (_x) : (_y))
-#endif
-
-#ifndef HAVE_FMAXF
-#define fmaxf(_x, _y) ((_x) > (_y) ? (_x) : (_y))
-#endif
-
 #ifdef TIZ_LOG_CATEGORY_NAME
 #undef TIZ_LOG_CATEGORY_NAME
 #define TIZ_LOG_CATEGORY_NAME "tiz.opus_decoder.prc"
@@ -362,6 +348,10 @@ release_headers (opusd_prc_t * ap_prc, const OMX_U32 a_pid)
 {
   assert (ap_prc);
 
+  /* Any decoded output not delivered yet is dropped */
+  ap_prc->pending_frames_ = 0;
+  ap_prc->pending_offset_ = 0;
+
   if ((a_pid == ARATELIA_OPUS_DECODER_INPUT_PORT_INDEX || a_pid == OMX_ALL)
       && (ap_prc->p_in_hdr_))
     {
@@ -383,6 +373,70 @@ release_headers (opusd_prc_t * ap_prc, const OMX_U32 a_pid)
   return OMX_ErrorNone;
 }
 
+/* Converts as many of the pending frames as fit in the output buffer */
+static void
+write_pending_frames (opusd_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_out)
+{
+  const size_t sample_size = tiz_pcm_sample_size (ap_prc->pcm_format_);
+  const size_t frame_len = ap_prc->channels_ * sample_size;
+  const size_t room
+    = ap_out->nAllocLen - ap_out->nOffset - ap_out->nFilledLen;
+  const size_t nframes = MIN ((size_t) ap_prc->pending_frames_,
+                              frame_len > 0 ? room / frame_len : 0);
+  const float * p_from
+    = ap_prc->p_out_buf_ + ap_prc->channels_ * ap_prc->pending_offset_;
+  unsigned char * p_to
+    = ap_out->pBuffer + ap_out->nOffset + ap_out->nFilledLen;
+
+  assert (ap_prc->pending_frames_ >= 0);
+
+  if (nframes > 0)
+    {
+      tiz_pcm_from_float (p_to, ap_prc->pcm_format_, &p_from, 1,
+                          nframes * ap_prc->channels_, NULL);
+      if (ap_prc->pcm_swap_)
+        {
+          tiz_pcm_swap (p_to, nframes * ap_prc->channels_, sample_size);
+        }
+      ap_out->nFilledLen += nframes * frame_len;
+      ap_prc->pending_frames_ -= nframes;
+      ap_prc->pending_offset_ += nframes;
+    }
+  else if (ap_prc->pending_frames_ > 0)
+    {
+      /* Not even a frame fits, so there is nothing to carry over */
+      TIZ_ERROR (handleOf (ap_prc),
+                 "Output buffer too small [%u] - dropping [%d] frames",
+                 (unsigned int) ap_out->nAllocLen, ap_prc->pending_frames_);
+      ap_prc->pending_frames_ = 0;
+    }
+}
+
+/* Returns the output header. The input one, already consumed, is returned
+   too, unless some of its frames are still pending: it is kept, and its EOS
+   flag propagated, until the last of them has been written */
+static OMX_ERRORTYPE
+release_transformed_headers (opusd_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_in,
+                             OMX_BUFFERHEADERTYPE * ap_out)
+{
+  assert (ap_prc);
+  assert (ap_in);
+  assert (ap_out);
+
+  if (0 == ap_prc->pending_frames_)
+    {
+      if ((ap_in->nFlags & OMX_BUFFERFLAG_EOS) > 0)
+        {
+          /* Propagate EOS flag to output */
+          ap_out->nFlags |= OMX_BUFFERFLAG_EOS;
+          ap_in->nFlags &= ~(1 << OMX_BUFFERFLAG_EOS);
+        }
+      tiz_check_omx (
+        release_header (ap_prc, ARATELIA_OPUS_DECODER_INPUT_PORT_INDEX));
+    }
+  return release_header (ap_prc, ARATELIA_OPUS_DECODER_OUTPUT_PORT_INDEX);
+}
+
 static OMX_ERRORTYPE
 transform_buffer (opusd_prc_t * ap_prc)
 {
@@ -400,6 +454,13 @@ transform_buffer (opusd_prc_t * ap_prc)
       return OMX_ErrorNone;
     }
 
+  if (ap_prc->pending_frames_ > 0)
+    {
+      /* What did not fit in the previous output buffer goes first */
+      write_pending_frames (ap_prc, p_out);
+      return release_transformed_headers (ap_prc, p_in, p_out);
+    }
+
   if (0 == p_in->nFilledLen)
     {
       TIZ_TRACE (handleOf (ap_prc), "HEADER [%p] nFlags [%d] is empty", p_in,
@@ -421,10 +482,6 @@ transform_buffer (opusd_prc_t * ap_prc)
     const unsigned char * p_data = p_in->pBuffer + p_in->nOffset;
     opus_int32 len = p_in->nFilledLen;
     int fec = 0;
-    float * output = NULL;
-    short * out = NULL;
-    unsigned out_len = 0;
-    int i = 0;
     int tmp_skip = 0;
     int frame_size = opus_multistream_decode_float (ap_prc->p_opus_dec_, p_data,
                                                     len, ap_prc->p_out_buf_,
@@ -441,34 +498,19 @@ transform_buffer (opusd_prc_t * ap_prc)
         tmp_skip
           = (ap_prc->preskip_ > frame_size) ? frame_size : ap_prc->preskip_;
         ap_prc->preskip_ -= tmp_skip;
-        output = ap_prc->p_out_buf_ + ap_prc->channels_ * tmp_skip;
-        out_len = frame_size - tmp_skip;
-
-        /* Convert to short and save to output file */
-        out = (short *) (p_out->pBuffer + p_out->nOffset);
-        for (i = 0; i < (int) out_len * ap_prc->channels_; ++i)
-          {
-            out[i] = (short) float2int (
-              fmaxf (-32768, fminf (output[i] * 32768.f, 32767)));
-          }
-
-        if ((p_in->nFlags & OMX_BUFFERFLAG_EOS) > 0)
-          {
-            /* Propagate EOS flag to output */
-            p_out->nFlags |= OMX_BUFFERFLAG_EOS;
-            p_in->nFlags &= ~(1 << OMX_BUFFERFLAG_EOS);
-          }
-
-        p_out->nFilledLen = out_len * ap_prc->channels_ * 2;
+        ap_prc->pending_offset_ = tmp_skip;
+        ap_prc->pending_frames_ = frame_size - tmp_skip;
+
+        /* Convert to the output port's sample format */
+        write_pending_frames (ap_prc, p_out);
+
         TIZ_TRACE (handleOf (ap_prc),
-                   "frame_size [%d] len [%d] - error [%s] nFilledLen [%d]",
+                   "frame_size [%d] len [%d] - error [%s] nFilledLen [%d] "
+                   "pending [%d]",
                    frame_size, len, opus_strerror (frame_size),
-                   p_out->nFilledLen);
+                   p_out->nFilledLen, ap_prc->pending_frames_);
         p_in->nFilledLen = 0;
-        tiz_check_omx (
-          release_header (ap_prc, ARATELIA_OPUS_DECODER_INPUT_PORT_INDEX));
-        tiz_check_omx (
-          release_header (ap_prc, ARATELIA_OPUS_DECODER_OUTPUT_PORT_INDEX));
+        tiz_check_omx (release_transformed_headers (ap_prc, p_in, p_out));
       }
   }
   return OMX_ErrorNone;
@@ -522,6 +564,8 @@ reset_stream_parameters (opusd_prc_t * ap_prc)
   ap_prc->mapping_family_ = 0;
   ap_prc->channels_ = 0;
   ap_prc->preskip_ = 0;
+  ap_prc->pending_frames_ = 0;
+  ap_prc->pending_offset_ = 0;
   ap_prc->eos_ = false;
   ap_prc->opus_header_parsed_ = false;
   ap_prc->opus_comments_parsed_ = false;
@@ -548,6 +592,8 @@ opusd_prc_ctor (void * ap_obj, va_list * app)
   p_prc->p_in_hdr_ = NULL;
   p_prc->p_out_hdr_ = NULL;
   p_prc->p_out_buf_ = NULL;
+  p_prc->pcm_format_ = ETIZPcmFormatS16;
+  p_prc->pcm_swap_ = OMX_FALSE;
   reset_stream_parameters (p_prc);
   p_prc->in_port_disabled_ = false;
   p_prc->out_port_disabled_ = false;
@@ -596,6 +642,9 @@ opusd_prc_prepare_to_transfer (void * ap_obj, OMX_U32 a_pid)
   tiz_check_omx (tiz_api_GetParameter (tiz_get_krn (handleOf (p_prc)),
                                        handleOf (p_prc), OMX_IndexParamAudioPcm,
                                        &(p_prc->pcmmode_)));
+  tiz_check_omx (
+    tiz_pcm_format_from_pcmmode (&(p_prc->pcmmode_), &(p_prc->pcm_format_)));
+  p_prc->pcm_swap_ = tiz_pcm_needs_swap (&(p_prc->pcmmode_));
 
   TIZ_TRACE (handleOf (p_prc),
              "sample rate renderer = [%d] channels renderer = [%d]",
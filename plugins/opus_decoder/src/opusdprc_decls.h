@@ -37,6 +37,7 @@ extern "C" {
 #include <opus.h>
 #include <opus_multistream.h>
 
+#include <tizplatform.h>
 #include <tizprc_decls.h>
 
 typedef struct opusd_prc opusd_prc_t;
@@ -48,7 +49,11 @@ struct opusd_prc
   OMX_BUFFERHEADERTYPE * p_in_hdr_;
   OMX_BUFFERHEADERTYPE * p_out_hdr_;
   OMX_AUDIO_PARAM_PCMMODETYPE pcmmode_;
+  tiz_pcm_format_t pcm_format_;
+  OMX_BOOL pcm_swap_;
   float * p_out_buf_;
+  int pending_frames_; /* Decoded frames that did not fit in the output buffer */
+  int pending_offset_; /* Position of those frames in p_out_buf_ */
   opus_int64 packet_count_;
   int rate_;
   int mapping_family_;
@@ -171,6 +171,7 @@ read_cback (void * ap_private, unsigned char * ap_ptr, int a_nbytes)
 {
   opusfiled_prc_t * p_prc = ap_private;
   int bytes_read = 0;
+  void * p_span = NULL;
 
   (void) store_data (p_prc);
 
@@ -181,10 +182,13 @@ read_cback (void * ap_private, unsigned char * ap_ptr, int a_nbytes)
 
   if (tiz_buffer_available (p_prc->p_store_) > 0)
     {
-      bytes_read = MIN (a_nbytes, tiz_buffer_available (p_prc->p_store_)
-                                    - p_prc->store_offset_);
-      memcpy (ap_ptr, tiz_buffer_get (p_prc->p_store_) + p_prc->store_offset_,
-              bytes_read);
+      bytes_read = MIN (a_nbytes, tiz_buffer_peek (p_prc->p_store_,
+                                                   p_prc->store_offset_,
+                                                   &p_span));
+      if (bytes_read > 0)
+        {
+          memcpy (ap_ptr, p_span, bytes_read);
+        }
       if (p_prc->decoder_inited_)
         {
           tiz_buffer_advance (p_prc->p_store_, bytes_read);
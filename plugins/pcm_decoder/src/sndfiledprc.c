@@ -189,6 +189,7 @@ sf_io_read (void * ap_ptr, sf_count_t count, void * user_data)
 {
   sndfiled_prc_t * p_prc = (sndfiled_prc_t *) user_data;
   sf_count_t bytes_read = 0;
+  void * p_span = NULL;
 
   assert (ap_ptr);
   assert (p_prc);
@@ -200,10 +201,12 @@ sf_io_read (void * ap_ptr, sf_count_t count, void * user_data)
                  "count [%d] decoder_inited_ [%s] store bytes [%d] offset [%d]",
                  count, (p_prc->decoder_inited_ ? "YES" : "NO"),
                  tiz_buffer_available (p_prc->p_store_), p_prc->store_offset_);
-      bytes_read = MIN (
-        count, tiz_buffer_available (p_prc->p_store_) - p_prc->store_offset_);
-      memcpy (ap_ptr, tiz_buffer_get (p_prc->p_store_) + p_prc->store_offset_,
-              bytes_read);
+      bytes_read = MIN (count, tiz_buffer_peek (p_prc->p_store_,
+                                                p_prc->store_offset_, &p_span));
+      if (bytes_read > 0)
+        {
+          memcpy (ap_ptr, p_span, bytes_read);
+        }
       if (p_prc->decoder_inited_)
         {
           tiz_buffer_advance (p_prc->p_store_,
@@ -34,7 +34,6 @@
 #include <errno.h>
 #include <math.h>
 #include <string.h>
-#include <byteswap.h>
 
 #include <tizplatform.h>
 
@@ -370,6 +369,20 @@ get_alsa_mixer (ar_prc_t * ap_prc)
                                  : ARATELIA_AUDIO_RENDERER_DEFAULT_ALSA_MIXER;
 }
 
+static bool
+is_volume_ramp_enabled (ar_prc_t * ap_prc)
+{
+  const char * p_volume_ramp = tiz_rcfile_get_value (
+    TIZ_RCFILE_PLUGINS_DATA_SECTION,
+    "OMX.Aratelia.audio_renderer.alsa.pcm.volume_ramp");
+  const bool enabled
+    = (p_volume_ramp && 0 == strncmp (p_volume_ramp, "true", 4));
+  assert (ap_prc);
+  TIZ_TRACE (handleOf (ap_prc), "Start-up volume ramp [%s]",
+             enabled ? "ENABLED" : "DISABLED");
+  return enabled;
+}
+
 static bool
 using_null_alsa_device (ar_prc_t * ap_prc)
 {
@@ -436,83 +449,60 @@ do_flush (ar_prc_t * ap_prc)
   return release_header (ap_prc);
 }
 
-static float
-sint_to_float (const int a_sample)
-{
-  float f;
-  if (a_sample >= 0)
-    {
-      f = a_sample / 32767.0;
-    }
-  else
-    {
-      f = a_sample / 32768.0;
-    }
-  return f;
-}
-
-static int
-float_to_sint (const float a_sample)
+static tiz_pcm_format_t
+get_pcm_format (const ar_prc_t * ap_prc)
 {
-  float f;
-  f = a_sample * 32767;
-  if (f < -32768)
-    {
-      f = -32768;
-    }
-  if (f > 32767)
+  assert (ap_prc);
+  /* See retrieve_alsa_pcm_format_and_num_channels */
+  switch (ap_prc->pcmmode_.nBitPerSample)
     {
-      f = 32767;
-    }
-  return (int) f;
+      case 24:
+        return ETIZPcmFormatS24;
+      case 32:
+        return ETIZPcmFormatFloat;
+      default:
+        break;
+    };
+  return ETIZPcmFormatS16;
 }
 
 static void
-adjust_gain (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
-             const snd_pcm_uframes_t a_samples_per_channel)
+adjust_gain (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
 {
   assert (ap_prc);
   assert (ap_hdr);
 
   if (ARATELIA_AUDIO_RENDERER_DEFAULT_GAIN_VALUE != ap_prc->gain_)
     {
-      int i;
+      const tiz_pcm_format_t fmt = get_pcm_format (ap_prc);
       int gainadj = (int) (ap_prc->gain_ * 256.);
       float gain = pow (10., gainadj / 5120.);
-      /*       gain = 3.1f; */
-      /*       fprintf (stderr, "%f samples %ld\n", gain, a_samples_per_channel); */
-      OMX_S16 * pcm = (OMX_S16 *) (ap_hdr->pBuffer + ap_hdr->nOffset);
-      for (i = 0; i < a_samples_per_channel; i++)
-        {
-          float f = sint_to_float (*pcm);
-          f *= gain;
-          int v = float_to_sint (f);
-          *(pcm++) = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
-          f = sint_to_float (*pcm);
-          f *= gain;
-          v = float_to_sint (f);
-          *(pcm++) = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
-        }
+      tiz_pcm_gain (ap_hdr->pBuffer + ap_hdr->nOffset,
+                    ap_hdr->nFilledLen / tiz_pcm_sample_size (fmt), fmt, gain);
     }
 }
 
 static void
-swap_byte_order_s16 (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
-                     const int a_samples)
+apply_volume_ramp (ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
 {
   assert (ap_prc);
   assert (ap_hdr);
-  assert (ap_hdr->pBuffer);
 
-  {
-    OMX_S16 * p_pcm = (OMX_S16 *) (ap_hdr->pBuffer + ap_hdr->nOffset);
-    int i = 0;
-    for (i = 0; i < a_samples; ++i)
-      {
-        *p_pcm = bswap_16 (*p_pcm);
-        p_pcm++;
-      }
-  }
+  if (ap_prc->ramp_frames_ > 0)
+    {
+      const tiz_pcm_format_t fmt = get_pcm_format (ap_prc);
+      const long frames
+        = MIN (ap_prc->ramp_frames_,
+               ap_hdr->nFilledLen / (tiz_pcm_sample_size (fmt)
+                                     * ap_prc->pcmmode_.nChannels));
+      const float to = ap_prc->ramp_gain_
+                       + (1.f - ap_prc->ramp_gain_) * frames
+                           / (float) ap_prc->ramp_frames_;
+      tiz_pcm_ramp (ap_hdr->pBuffer + ap_hdr->nOffset, frames,
+                    ap_prc->pcmmode_.nChannels, fmt, ap_prc->ramp_gain_, to);
+      ap_prc->ramp_gain_ = to;
+      ap_prc->ramp_frames_ -= frames;
+    }
 }
 
 static void
@@ -521,7 +511,7 @@ swap_byte_order (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
   assert (ap_prc);
   assert (ap_hdr);
 
-  if (ap_prc->swap_byte_order_ && !ap_hdr->nOffset)
+  if (ap_prc->swap_byte_order_)
     {
       const int bytes_per_sample = ap_prc->pcmmode_.nBitPerSample / 8;
       const int samples = ap_hdr->nFilledLen / bytes_per_sample;
@@ -532,22 +522,22 @@ swap_byte_order (const ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
                  "nOffset = [%d]",
                  ap_prc->pcmmode_.nBitPerSample, ap_hdr->nFilledLen, samples,
                  ap_hdr->nOffset);
-
-      switch (ap_prc->pcmmode_.nBitPerSample)
-        {
-          case 16:
-            {
-              swap_byte_order_s16 (ap_prc, ap_hdr, samples);
-            }
-            break;
-          default:
-            {
-            }
-            break;
-        };
+      tiz_pcm_swap (ap_hdr->pBuffer + ap_hdr->nOffset, samples,
+                    bytes_per_sample);
     }
 }
 
+static void
+process_samples (ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
+{
+  assert (ap_prc);
+  assert (ap_hdr);
+  /* This is done once per header, before any of its data is rendered */
+  adjust_gain (ap_prc, ap_hdr);
+  apply_volume_ramp (ap_prc, ap_hdr);
+  swap_byte_order (ap_prc, ap_hdr);
+}
+
 static OMX_ERRORTYPE
 get_alsa_master_volume (ar_prc_t * ap_prc, long * ap_volume)
 {
@@ -713,39 +703,21 @@ prepare_volume_ramp (ar_prc_t * ap_prc)
   assert (ap_prc);
   if (ap_prc->ramp_enabled_)
     {
-      ap_prc->ramp_volume_ = ARATELIA_AUDIO_RENDERER_DEFAULT_VOLUME_VALUE;
-      ap_prc->ramp_step_count_
-        = ARATELIA_AUDIO_RENDERER_DEFAULT_RAMP_STEP_COUNT;
-      ap_prc->ramp_step_
-        = (double) ap_prc->ramp_volume_ / (double) ap_prc->ramp_step_count_;
+      /* The ramp is applied to the samples, from silence to the current
+         volume */
+      ap_prc->ramp_gain_ = 0.f;
+      ap_prc->ramp_frames_ = (long) ap_prc->pcmmode_.nSamplingRate
+                             * ARATELIA_AUDIO_RENDERER_DEFAULT_RAMP_DURATION_MS
+                             / 1000;
     }
 }
 
-static OMX_ERRORTYPE
-start_volume_ramp (ar_prc_t * ap_prc)
-{
-  assert (ap_prc);
-  if (ap_prc->ramp_enabled_)
-    {
-      assert (ap_prc->p_vol_ramp_timer_);
-      ap_prc->ramp_volume_ = 0;
-      tiz_check_omx (tiz_srv_timer_watcher_start (
-        ap_prc, ap_prc->p_vol_ramp_timer_, 0.2, 0.2));
-    }
-  return OMX_ErrorNone;
-}
-
 static void
 stop_volume_ramp (ar_prc_t * ap_prc)
 {
   assert (ap_prc);
-  if (ap_prc->ramp_enabled_)
-    {
-      if (ap_prc->p_vol_ramp_timer_)
-        {
-          (void) tiz_srv_timer_watcher_stop (ap_prc, ap_prc->p_vol_ramp_timer_);
-        }
-    }
+  ap_prc->ramp_gain_ = 1.f;
+  ap_prc->ramp_frames_ = 0;
 }
 
 static OMX_ERRORTYPE
@@ -780,25 +752,6 @@ stop_eos_timer (ar_prc_t * ap_prc)
     }
 }
 
-static OMX_ERRORTYPE
-apply_ramp_step (ar_prc_t * ap_prc)
-{
-  assert (ap_prc);
-  if (ap_prc->ramp_enabled_)
-    {
-      if (ap_prc->ramp_step_count_-- > 0)
-        {
-          ap_prc->ramp_volume_ += ap_prc->ramp_step_;
-          set_volume (ap_prc, ap_prc->ramp_volume_);
-        }
-      else
-        {
-          stop_volume_ramp (ap_prc);
-        }
-    }
-  return OMX_ErrorNone;
-}
-
 static OMX_ERRORTYPE
 arrange_samples_buffer (ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
                         unsigned long int a_sample_size,
@@ -816,26 +769,31 @@ arrange_samples_buffer (ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr,
 
   if (ap_prc->pcmmode_.nChannels < ap_prc->num_channels_supported_)
     {
+      const size_t frame_len = a_sample_size * ap_prc->num_channels_supported_;
+      const size_t nbytes = frame_len * a_samples_per_channel;
+      OMX_U8 * p_frames = NULL;
       snd_pcm_uframes_t i = 0;
       tiz_buffer_clear (ap_prc->p_sample_buf_);
+      /* The frames are written in place, rather than pushed one sample at a
+         time */
+      if (!(p_frames = tiz_buffer_reserve (ap_prc->p_sample_buf_, nbytes)))
+        {
+          TIZ_ERROR (handleOf (ap_prc),
+                     "Unable to copy all sample data into the buffer");
+          return OMX_ErrorInsufficientResources;
+        }
       while (i < a_samples_per_channel)
         {
           int j = 0;
           while (j < ap_prc->num_channels_supported_)
             {
-              if (a_sample_size
-                  != tiz_buffer_push (ap_prc->p_sample_buf_,
-                                      p_hdr_buf + (a_step * i), a_sample_size))
-                {
-                  TIZ_ERROR (handleOf (ap_prc),
-                             "Unable to copy all sample data into the buffer");
-                  /* Early return */
-                  return OMX_ErrorInsufficientResources;
-                }
+              memcpy (p_frames + (frame_len * i) + (a_sample_size * j),
+                      p_hdr_buf + (a_step * i), a_sample_size);
               j += 1;
             }
           i += 1;
         }
+      (void) tiz_buffer_commit (ap_prc->p_sample_buf_, nbytes);
       *app_buffer = tiz_buffer_get (ap_prc->p_sample_buf_);
       TIZ_DEBUG (
         handleOf (ap_prc),
@@ -867,9 +825,6 @@ render_buffer (ar_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
   assert (ap_hdr->nFilledLen > 0);
   samples_per_channel = ap_hdr->nFilledLen / step;
 
-  adjust_gain (ap_prc, ap_hdr, samples_per_channel);
-  swap_byte_order (ap_prc, ap_hdr);
-
   while (samples_per_channel > 0 && OMX_ErrorNone == rc)
     {
       const void * p_buffer = NULL;
@@ -926,6 +881,7 @@ get_header (ar_prc_t * ap_prc)
               TIZ_TRACE (handleOf (ap_prc),
                          "Claimed HEADER [%p]...nFilledLen [%d]",
                          ap_prc->p_inhdr_, ap_prc->p_inhdr_->nFilledLen);
+              process_samples (ap_prc, ap_prc->p_inhdr_);
             }
           else
             {
@@ -1010,7 +966,6 @@ ar_prc_ctor (void * ap_prc, va_list * app)
   p_prc->descriptor_count_ = 0;
   p_prc->p_fds_ = NULL;
   p_prc->p_ev_io_ = NULL;
-  p_prc->p_vol_ramp_timer_ = NULL;
   p_prc->p_eos_timer_ = NULL;
   p_prc->p_inhdr_ = NULL;
   p_prc->port_disabled_ = false;
@@ -1019,9 +974,8 @@ ar_prc_ctor (void * ap_prc, va_list * app)
   p_prc->gain_ = ARATELIA_AUDIO_RENDERER_DEFAULT_GAIN_VALUE;
   p_prc->volume_ = ARATELIA_AUDIO_RENDERER_DEFAULT_VOLUME_VALUE;
   p_prc->ramp_enabled_ = false;
-  p_prc->ramp_step_ = 0;
-  p_prc->ramp_step_count_ = ARATELIA_AUDIO_RENDERER_DEFAULT_RAMP_STEP_COUNT;
-  p_prc->ramp_volume_ = 0;
+  p_prc->ramp_gain_ = 1.f;
+  p_prc->ramp_frames_ = 0;
   return p_prc;
 }
 
@@ -1074,16 +1028,12 @@ ar_prc_allocate_resources (void * ap_prc, OMX_U32 TIZ_UNUSED (a_pid))
         = tiz_mem_alloc (sizeof (struct pollfd) * p_prc->descriptor_count_);
       tiz_check_null_ret_oom (p_prc->p_fds_);
 
-      /* This is to generate volume ramps when needed */
-      if (p_prc->ramp_enabled_)
-        {
-          tiz_check_omx (
-            tiz_srv_timer_watcher_init (p_prc, &(p_prc->p_vol_ramp_timer_)));
-        }
-
       /* This is to produce accurate EOS flag events */
       tiz_check_omx (
         tiz_srv_timer_watcher_init (p_prc, &(p_prc->p_eos_timer_)));
+
+      /* This is to fade in from silence when playback starts */
+      p_prc->ramp_enabled_ = is_volume_ramp_enabled (p_prc);
     }
 
   assert (p_prc->p_pcm_);
@@ -1157,8 +1107,6 @@ ar_prc_transfer_and_process (void * ap_prc, OMX_U32 TIZ_UNUSED (a_pid))
   assert (p_prc);
   log_alsa_pcm_state (p_prc);
   prepare_volume_ramp (p_prc);
-  tiz_check_omx (start_volume_ramp (p_prc));
-  tiz_check_omx (apply_ramp_step (p_prc));
   return OMX_ErrorNone;
 }
 
@@ -1180,12 +1128,6 @@ ar_prc_deallocate_resources (void * ap_prc)
   tiz_srv_timer_watcher_destroy (p_prc, p_prc->p_eos_timer_);
   p_prc->p_eos_timer_ = NULL;
 
-  if (p_prc->ramp_enabled_)
-    {
-      tiz_srv_timer_watcher_destroy (p_prc, p_prc->p_vol_ramp_timer_);
-      p_prc->p_vol_ramp_timer_ = NULL;
-    }
-
   p_prc->descriptor_count_ = 0;
   tiz_mem_free (p_prc->p_fds_);
   p_prc->p_fds_ = NULL;
@@ -1264,10 +1206,6 @@ ar_prc_timer_ready (void * ap_prc, tiz_event_timer_t * ap_ev_timer,
       tiz_srv_issue_event ((OMX_PTR) ap_prc, OMX_EventBufferFlag, 0,
                            p_prc->nflags_, NULL);
     }
-  else if (ap_ev_timer == p_prc->p_vol_ramp_timer_)
-    {
-      rc = apply_ramp_step (ap_prc);
-    }
   else
     {
       assert (0);
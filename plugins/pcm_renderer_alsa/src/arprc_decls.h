@@ -57,7 +57,6 @@ struct ar_prc
   int descriptor_count_;
   struct pollfd * p_fds_;
   tiz_event_io_t * p_ev_io_;
-  tiz_event_timer_t * p_vol_ramp_timer_;
   tiz_event_timer_t * p_eos_timer_;
   OMX_BUFFERHEADERTYPE * p_inhdr_;
   bool port_disabled_;
@@ -66,9 +65,8 @@ struct ar_prc
   float gain_;
   long volume_;
   bool ramp_enabled_;
-  long ramp_step_;
-  long ramp_step_count_;
-  long ramp_volume_;
+  float ramp_gain_;
+  long ramp_frames_;
 };
 
 typedef struct ar_prc_class ar_prc_class_t;
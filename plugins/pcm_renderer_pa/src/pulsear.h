@@ -52,7 +52,7 @@ extern "C"
 #define ARATELIA_PCM_RENDERER_MAX_VOLUME_VALUE        100
 #define ARATELIA_PCM_RENDERER_MIN_VOLUME_VALUE        0
 #define ARATELIA_PCM_RENDERER_DEFAULT_VOLUME_VALUE    75
-#define ARATELIA_PCM_RENDERER_DEFAULT_RAMP_STEP_COUNT 10
+#define ARATELIA_PCM_RENDERER_DEFAULT_RAMP_DURATION_MS 2000
 
 #define ARATELIA_PCM_RENDERER_PULSEAUDIO_APP_NAME    "Tizonia PulseAudio PCM Renderer"
 #define ARATELIA_PCM_RENDERER_PULSEAUDIO_STREAM_NAME "Tizonia Pulseadio PCM renderer (playback stream)"
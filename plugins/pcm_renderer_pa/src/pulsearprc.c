@@ -230,6 +230,47 @@ ready_to_process (pulsear_prc_t * ap_prc)
           && !ap_prc->port_disabled_ && !ap_prc->stopped_);
 }
 
+static tiz_pcm_format_t
+get_pcm_format (const pulsear_prc_t * ap_prc)
+{
+  assert (ap_prc);
+  /* See init_pulseaudio_stream */
+  switch (ap_prc->pcmmode_.nBitPerSample)
+    {
+      case 24:
+        return ETIZPcmFormatS24;
+      case 32:
+        return ETIZPcmFormatFloat;
+      default:
+        break;
+    };
+  return ETIZPcmFormatS16;
+}
+
+static void
+apply_volume_ramp (pulsear_prc_t * ap_prc, OMX_BUFFERHEADERTYPE * ap_hdr)
+{
+  assert (ap_prc);
+  assert (ap_hdr);
+
+  /* This is done once per header, before any of its data is written */
+  if (ap_prc->ramp_frames_ > 0)
+    {
+      const tiz_pcm_format_t fmt = get_pcm_format (ap_prc);
+      const long frames
+        = MIN (ap_prc->ramp_frames_,
+               ap_hdr->nFilledLen / (tiz_pcm_sample_size (fmt)
+                                     * ap_prc->pcmmode_.nChannels));
+      const float to = ap_prc->ramp_gain_
+                       + (1.f - ap_prc->ramp_gain_) * frames
+                           / (float) ap_prc->ramp_frames_;
+      tiz_pcm_ramp (ap_hdr->pBuffer + ap_hdr->nOffset, frames,
+                    ap_prc->pcmmode_.nChannels, fmt, ap_prc->ramp_gain_, to);
+      ap_prc->ramp_gain_ = to;
+      ap_prc->ramp_frames_ -= frames;
+    }
+}
+
 static OMX_BUFFERHEADERTYPE *
 get_header (pulsear_prc_t * ap_prc)
 {
@@ -248,6 +289,7 @@ get_header (pulsear_prc_t * ap_prc)
               TIZ_TRACE (handleOf (ap_prc),
                          "Claimed HEADER [%p]...nFilledLen [%d]",
                          ap_prc->p_inhdr_, ap_prc->p_inhdr_->nFilledLen);
+              apply_volume_ramp (ap_prc, ap_prc->p_inhdr_);
             }
         }
       p_hdr = ap_prc->p_inhdr_;
@@ -962,67 +1004,24 @@ prepare_volume_ramp (pulsear_prc_t * ap_prc)
       TIZ_DEBUG (handleOf (ap_prc), "pa_vol_.channels[%d]",
                  ap_prc->pa_vol_.channels);
 
-      ap_prc->ramp_volume_ = ARATELIA_PCM_RENDERER_DEFAULT_VOLUME_VALUE;
-      set_volume (ap_prc, ap_prc->ramp_volume_);
-      ap_prc->ramp_volume_ = ARATELIA_PCM_RENDERER_DEFAULT_VOLUME_VALUE;
-      ap_prc->ramp_step_count_ = ARATELIA_PCM_RENDERER_DEFAULT_RAMP_STEP_COUNT;
-      ap_prc->ramp_step_
-        = (double) ap_prc->ramp_volume_ / (double) ap_prc->ramp_step_count_;
-      TIZ_TRACE (handleOf (ap_prc), "ramp_step_ = [%d] ramp_step_count_ = [%d]",
-                 ap_prc->ramp_step_, ap_prc->ramp_step_count_);
-    }
-}
-
-static OMX_ERRORTYPE
-start_volume_ramp (pulsear_prc_t * ap_prc)
-{
-  assert (ap_prc);
-  if (ap_prc->ramp_enabled_)
-    {
-      if (ap_prc->p_ev_timer_)
-        {
-          ap_prc->ramp_volume_ = 0;
-          TIZ_TRACE (handleOf (ap_prc), "ramp_volume_ = [%d]",
-                     ap_prc->ramp_volume_);
-          tiz_check_omx (tiz_srv_timer_watcher_start (
-            ap_prc, ap_prc->p_ev_timer_, 0.2, 0.2));
-        }
+      /* The stream volume is set once; the ramp is applied to the samples,
+         from silence to that volume */
+      set_volume (ap_prc, ARATELIA_PCM_RENDERER_DEFAULT_VOLUME_VALUE);
+      ap_prc->ramp_gain_ = 0.f;
+      ap_prc->ramp_frames_ = (long) ap_prc->pcmmode_.nSamplingRate
+                             * ARATELIA_PCM_RENDERER_DEFAULT_RAMP_DURATION_MS
+                             / 1000;
+      TIZ_TRACE (handleOf (ap_prc), "ramp_frames_ = [%ld]",
+                 ap_prc->ramp_frames_);
     }
-  return OMX_ErrorNone;
 }
 
 static void
 stop_volume_ramp (pulsear_prc_t * ap_prc)
 {
   assert (ap_prc);
-  if (ap_prc->ramp_enabled_)
-    {
-      if (ap_prc->p_ev_timer_)
-        {
-          (void) tiz_srv_timer_watcher_stop (ap_prc, ap_prc->p_ev_timer_);
-        }
-    }
-}
-
-static OMX_ERRORTYPE
-apply_ramp_step (pulsear_prc_t * ap_prc)
-{
-  assert (ap_prc);
-  if (ap_prc->ramp_enabled_)
-    {
-      if (ap_prc->ramp_step_count_-- > 0)
-        {
-          ap_prc->ramp_volume_ += ap_prc->ramp_step_;
-          TIZ_TRACE (handleOf (ap_prc), "ramp_volume_ = [%d]",
-                     ap_prc->ramp_volume_);
-          set_volume (ap_prc, ap_prc->ramp_volume_);
-        }
-      else
-        {
-          stop_volume_ramp (ap_prc);
-        }
-    }
-  return OMX_ErrorNone;
+  ap_prc->ramp_gain_ = 1.f;
+  ap_prc->ramp_frames_ = 0;
 }
 
 /*
@@ -1048,9 +1047,8 @@ pulsear_prc_ctor (void * ap_prc, va_list * app)
   p_prc->volume_ = get_default_volume (ap_prc);
   p_prc->pending_volume_ = 0;
   p_prc->ramp_enabled_ = false;
-  p_prc->ramp_step_ = 0;
-  p_prc->ramp_step_count_ = ARATELIA_PCM_RENDERER_DEFAULT_RAMP_STEP_COUNT;
-  p_prc->ramp_volume_ = 0;
+  p_prc->ramp_gain_ = 1.f;
+  p_prc->ramp_frames_ = 0;
   (void)set_component_volume(p_prc);
   return p_prc;
 }
@@ -1105,9 +1103,8 @@ pulsear_prc_prepare_to_transfer (void * ap_prc, OMX_U32 a_pid)
 {
   pulsear_prc_t * p_prc = ap_prc;
   assert (p_prc);
-  p_prc->ramp_step_ = 0;
-  p_prc->ramp_step_count_ = ARATELIA_PCM_RENDERER_DEFAULT_RAMP_STEP_COUNT;
-  p_prc->ramp_volume_ = 0;
+  p_prc->ramp_gain_ = 1.f;
+  p_prc->ramp_frames_ = 0;
   return OMX_ErrorNone;
 }
 
@@ -1118,8 +1115,6 @@ pulsear_prc_transfer_and_process (void * ap_prc, OMX_U32 a_pid)
   assert (ap_prc);
   p_prc->stopped_ = false;
   prepare_volume_ramp (p_prc);
-  tiz_check_omx (start_volume_ramp (p_prc));
-  tiz_check_omx (apply_ramp_step (p_prc));
   return OMX_ErrorNone;
 }
 
@@ -1158,7 +1153,6 @@ pulsear_prc_timer_ready (void * ap_prc, tiz_event_timer_t * ap_ev_timer,
   OMX_ERRORTYPE rc = OMX_ErrorNone;
   assert (p_prc);
   TIZ_TRACE (handleOf (ap_prc), "Received timer event");
-  tiz_check_omx (apply_ramp_step (ap_prc));
   if (ready_to_process (p_prc))
     {
       rc = render_pcm_data (p_prc);
@@ -68,9 +68,8 @@ struct pulsear_prc
   long volume_;
   long pending_volume_;
   bool ramp_enabled_;
-  long ramp_step_;
-  long ramp_step_count_;
-  long ramp_volume_;
+  float ramp_gain_;
+  long ramp_frames_;
 };
 
 typedef struct pulsear_prc_class pulsear_prc_class_t;
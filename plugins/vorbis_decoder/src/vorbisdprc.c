@@ -127,17 +127,35 @@ get_store_offset_ptr (vorbisd_prc_t * ap_prc)
   return &(ap_prc->store_offset_);
 }
 
-static int
-store_data (vorbisd_prc_t * ap_prc, const OMX_U8 * ap_data, OMX_U32 a_nbytes)
+static void
+write_pcm (const vorbisd_prc_t * ap_prc, OMX_U8 * ap_dst, const float * ap_pcm,
+           const size_t a_nsamples)
+{
+  assert (ap_prc);
+  tiz_pcm_from_float (ap_dst, ap_prc->pcm_format_, &ap_pcm, 1, a_nsamples,
+                      NULL);
+  if (ap_prc->pcm_swap_)
+    {
+      tiz_pcm_swap (ap_dst, a_nsamples,
+                    tiz_pcm_sample_size (ap_prc->pcm_format_));
+    }
+}
+
+/* Stores the samples in the output port's sample format; returns the number
+   of samples that could not be stored */
+static size_t
+store_data (vorbisd_prc_t * ap_prc, const float * ap_pcm, size_t a_nsamples)
 {
   OMX_U8 ** pp_store = NULL;
   OMX_U32 * p_offset = NULL;
   OMX_U32 * p_size = NULL;
-  OMX_U32 nbytes_to_copy = 0;
+  const size_t sample_size = tiz_pcm_sample_size (ap_prc->pcm_format_);
+  const OMX_U32 nbytes = a_nsamples * sample_size;
+  size_t nsamples_to_copy = 0;
   OMX_U32 nbytes_avail = 0;
 
   assert (ap_prc);
-  assert (ap_data);
+  assert (ap_pcm);
 
   pp_store = get_store_ptr (ap_prc);
   p_size = get_store_size_ptr (ap_prc);
@@ -149,15 +167,15 @@ store_data (vorbisd_prc_t * ap_prc, const OMX_U8 * ap_data, OMX_U32 a_nbytes)
 
   nbytes_avail = *p_size - *p_offset;
 
-  if (a_nbytes > nbytes_avail)
+  if (nbytes > nbytes_avail)
     {
       /* need to re-alloc */
       OMX_U8 * p_new_store = NULL;
-      p_new_store = tiz_mem_realloc (*pp_store, *p_offset + a_nbytes);
+      p_new_store = tiz_mem_realloc (*pp_store, *p_offset + nbytes);
       if (p_new_store)
         {
           *pp_store = p_new_store;
-          *p_size = *p_offset + a_nbytes;
+          *p_size = *p_offset + nbytes;
           nbytes_avail = *p_size - *p_offset;
           TIZ_TRACE (handleOf (ap_prc),
                      "Realloc'd data store "
@@ -165,25 +183,13 @@ store_data (vorbisd_prc_t * ap_prc, const OMX_U8 * ap_data, OMX_U32 a_nbytes)
                      *p_size);
         }
     }
-  nbytes_to_copy = MIN (nbytes_avail, a_nbytes);
-  memcpy (*pp_store + *p_offset, ap_data, nbytes_to_copy);
-  *p_offset += nbytes_to_copy;
+  nsamples_to_copy = MIN (nbytes_avail / sample_size, a_nsamples);
+  write_pcm (ap_prc, *pp_store + *p_offset, ap_pcm, nsamples_to_copy);
+  *p_offset += nsamples_to_copy * sample_size;
 
   TIZ_TRACE (handleOf (ap_prc), "bytes currently stored [%d]", *p_offset);
 
-  return a_nbytes - nbytes_to_copy;
-}
-
-static inline void
-write_frame_float_ilv (float * to, const float * from, const int channels)
-{
-  int i = 0;
-  assert (to);
-  assert (from);
-  for (i = 0; i < channels; ++i)
-    {
-      to[i] = from[i];
-    }
+  return a_nsamples - nsamples_to_copy;
 }
 
 static OMX_ERRORTYPE
@@ -343,23 +349,17 @@ fishsound_decoded_callback (FishSound * ap_fsound, float * app_pcm[],
     }
 
   {
-    /* write decoded PCM samples */
-    size_t i = 0;
-    size_t frame_len = sizeof (float) * p_prc->fsinfo_.channels;
+    /* write decoded PCM samples, in the output port's sample format */
+    const float * p_pcm = (const float *) app_pcm;
+    const size_t channels = p_prc->fsinfo_.channels;
+    size_t frame_len = tiz_pcm_sample_size (p_prc->pcm_format_) * channels;
     size_t frames_alloc = ((p_out->nAllocLen - p_out->nOffset) / frame_len);
     size_t frames_to_write = (frames > frames_alloc) ? frames_alloc : frames;
     size_t bytes_to_write = frames_to_write * frame_len;
     assert (p_out);
 
-    for (i = 0; i < frames_to_write; ++i)
-      {
-        size_t frame_offset = i * frame_len;
-        size_t float_offset = i * p_prc->fsinfo_.channels;
-        float * out
-          = (float *) (p_out->pBuffer + p_out->nOffset + frame_offset);
-        write_frame_float_ilv (out, ((float *) app_pcm) + float_offset,
-                               p_prc->fsinfo_.channels);
-      }
+    write_pcm (p_prc, p_out->pBuffer + p_out->nOffset, p_pcm,
+               frames_to_write * channels);
     p_out->nFilledLen += bytes_to_write;
     p_out->nOffset += bytes_to_write;
 
@@ -370,9 +370,8 @@ fishsound_decoded_callback (FishSound * ap_fsound, float * app_pcm[],
         OMX_U32 nbytes_remaining = (frames - frames_to_write) * frame_len;
         TIZ_TRACE (handleOf (p_prc), "Need to store [%d] bytes",
                    nbytes_remaining);
-        nbytes_remaining = store_data (
-          p_prc, (OMX_U8 *) (app_pcm[frames_to_write * sizeof (float)]),
-          nbytes_remaining);
+        (void) store_data (p_prc, p_pcm + frames_to_write * channels,
+                           (frames - frames_to_write) * channels);
       }
 
     if (tiz_filter_prc_is_eos (p_prc))
@@ -580,6 +579,8 @@ vorbisd_prc_ctor (void * ap_obj, va_list * app)
     = super_ctor (typeOf (ap_obj, "vorbisdprc"), ap_obj, app);
   assert (p_prc);
   p_prc->p_fsnd_ = NULL;
+  p_prc->pcm_format_ = ETIZPcmFormatFloat;
+  p_prc->pcm_swap_ = OMX_FALSE;
   p_prc->started_ = false;
   p_prc->p_store_ = NULL;
   p_prc->store_size_ = 0;
@@ -629,6 +630,9 @@ vorbisd_prc_prepare_to_transfer (void * ap_obj, OMX_U32 a_pid)
   tiz_check_omx (tiz_api_GetParameter (tiz_get_krn (handleOf (p_prc)),
                                        handleOf (p_prc), OMX_IndexParamAudioPcm,
                                        &(p_prc->pcmmode_)));
+  tiz_check_omx (
+    tiz_pcm_format_from_pcmmode (&(p_prc->pcmmode_), &(p_prc->pcm_format_)));
+  p_prc->pcm_swap_ = tiz_pcm_needs_swap (&(p_prc->pcmmode_));
   TIZ_TRACE (handleOf (p_prc),
              "sample rate renderer = [%d] channels renderer = [%d]",
              p_prc->pcmmode_.nSamplingRate, p_prc->pcmmode_.nChannels);
@@ -36,6 +36,7 @@ extern "C" {
 #include <stdbool.h>
 #include <fishsound/fishsound.h>
 
+#include <tizplatform.h>
 #include <tizfilterprc.h>
 #include <tizfilterprc_decls.h>
 
@@ -47,6 +48,8 @@ struct vorbisd_prc
   FishSound * p_fsnd_;
   FishSoundInfo fsinfo_;
   OMX_AUDIO_PARAM_PCMMODETYPE pcmmode_;
+  tiz_pcm_format_t pcm_format_;
+  OMX_BOOL pcm_swap_;
   bool started_;
   OMX_U8 * p_store_;
   OMX_U32 store_size_;